@@ -0,0 +1,454 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Fast convolution with the FFT engine of fft1d_float_8.cl.
+ * Every kernel replication is a pipeline of kernels that are connected with channels:
+ *
+ *   fetch -> fft1d (forward) -> multiply -> ifft1d (inverse) [-> store for Xilinx]
+ *
+ * The multiply kernel multiplies the bit-reversed output of the forward FFT with the
+ * filter spectrum that is kept in an on-chip buffer and reorders the products into the
+ * input order of the inverse FFT. So the intermediate spectra never leave the chip and
+ * only the input signals and the convolved signals are transferred over global memory.
+ * The output of the inverse FFT is not normalized.
+ */
+
+// The code generator expects a list of the Log2 FFT sizes that should be synthesized.
+// Kernels for the size with index s are named with the offset s * num_total_replications.
+/* PY_CODE_GEN
+try:
+    log_fft_sizes
+except NameError:
+    log_fft_sizes = ["LOG_FFT_SIZE"]
+*/
+
+// The FFT engine uses the largest size to define its buffer types
+#define MAX_LOG_FFT_SIZE /*PY_CODE_GEN max(log_fft_sizes)*/
+
+// Include source code for an engine that produces 8 points each step
+#include "fft_8.cl"
+
+#include "parameters.h"
+
+// code generation expects an array of maps of size num_replications with the keys "in" and "out".
+// The value of the keys have to be strings containing the attributes that
+// have to be assigned to input and output buffers in global memory.
+// The filter spectrum is placed like the input.
+/* PY_CODE_GEN
+try:
+    kernel_param_attributes = generate_attributes(num_replications)
+except:
+    kernel_param_attributes = [{"in": "", "out": ""} for i in range(num_replications)]
+*/
+
+#define LOGPOINTS       3
+#define POINTS          (1 << LOGPOINTS)
+
+#ifdef INTEL_FPGA
+#pragma OPENCL EXTENSION cl_intel_channels : enable
+// PY_CODE_GEN block_start [replace(local_variables=locals()) for i in range(num_total_replications * len(log_fft_sizes))]
+channel float2 chanin/*PY_CODE_GEN i*/[POINTS] __attribute__((depth(POINTS)));
+channel float2 chanspectrum/*PY_CODE_GEN i*/[POINTS] __attribute__((depth(POINTS)));
+channel float2 chanproduct/*PY_CODE_GEN i*/[POINTS] __attribute__((depth(POINTS)));
+// PY_CODE_GEN block_end
+#endif
+#ifdef XILINX_FPGA
+#define XILINX_PIPE_DEPTH 16
+
+// Compiler states, that the pipe depth needs at least to be 16
+// PY_CODE_GEN block_start [replace(local_variables=locals()) for i in range(num_total_replications * len(log_fft_sizes))]
+pipe float2x8 chanin/*PY_CODE_GEN i*/ __attribute__((xcl_reqd_pipe_depth(XILINX_PIPE_DEPTH)));
+pipe float2x8 chanspectrum/*PY_CODE_GEN i*/ __attribute__((xcl_reqd_pipe_depth(XILINX_PIPE_DEPTH)));
+pipe float2x8 chanproduct/*PY_CODE_GEN i*/ __attribute__((xcl_reqd_pipe_depth(XILINX_PIPE_DEPTH)));
+pipe float2x8 chanout/*PY_CODE_GEN i*/ __attribute__((xcl_reqd_pipe_depth(XILINX_PIPE_DEPTH)));
+// PY_CODE_GEN block_end
+#endif
+
+// Bit reversal and the on-chip reordering of the output to natural order
+#include "fft_reorder.cl"
+
+float2 complex_mult(float2 a, float2 b) {
+  return (float2)(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+}
+
+// PY_CODE_GEN block_start [replace(local_variables=locals()) for i in range(num_total_replications * len(log_fft_sizes))]
+
+#undef LOGN
+#define LOGN /*PY_CODE_GEN log_fft_sizes[i // num_total_replications]*/
+
+/**
+Read the input signals from global memory and forward them in the input order of the FFT engine.
+This is the same implementation as the fetch kernel in fft1d_float_8.cl.
+ */
+__kernel
+__attribute__ ((max_global_work_dim(0), reqd_work_group_size(1,1,1)))
+void fetch/*PY_CODE_GEN i*/(__global /*PY_CODE_GEN kernel_param_attributes[i % num_total_replications]["in"]*/ float2 * restrict src, int iter) {
+
+  const int N = (1 << LOGN);
+
+  // Input buffer that can hold the data for two FFTs
+  float2 buf[2*N/POINTS][POINTS] __attribute__((numbanks(POINTS),xcl_array_partition(block, N/POINTS, 1), xcl_array_partition(complete, 2)));
+
+  // for iter iterations and one additional iteration to empty the last buffer
+  for(unsigned k = 0; k < (iter + 1) * (N / POINTS); k++){
+
+#ifdef INTEL_FPGA
+    if (k < iter * ( N / POINTS)) {
+#endif
+
+      float2 read_chunk[POINTS];
+
+      // Shift the data depending on the total FFT size to prevent mappings to the same bank
+      __attribute__((opencl_unroll_hint(POINTS)))
+      for(int j = 0; j < POINTS; j++){
+        unsigned shift = ((LOGN - LOGPOINTS - LOGPOINTS > 0) ? (k & (N/POINTS - 1)) >> (LOGN - LOGPOINTS - LOGPOINTS) : (k & (N/POINTS - 1)));
+        unsigned final_buffer_pos = (j + shift) & (POINTS - 1);
+        read_chunk[final_buffer_pos] = src[(k << LOGPOINTS) + j];
+      }
+
+      __attribute__((opencl_unroll_hint(POINTS)))
+      for(int j = 0; j < POINTS; j++){
+        unsigned local_i = k & (2 * N/POINTS - 1);
+        buf[local_i][j] = read_chunk[j];
+      }
+#ifdef INTEL_FPGA
+    }
+#endif
+    if (k >= ( N / POINTS)) {
+      float2x8 buf2x8;
+
+      unsigned offset = (((k >> (LOGN - LOGPOINTS)) & 1) == 0) ? (N / POINTS) : 0;
+
+      float2 write_chunk[POINTS];
+      __attribute__((opencl_unroll_hint(POINTS)))
+      for(int j = 0; j < POINTS; j++){
+        unsigned current_index = j * N/POINTS + (k & (N/POINTS - 1));
+        unsigned shift = ((LOGPOINTS - LOGN + LOGPOINTS > 0) ? j >> (LOGPOINTS - LOGN + LOGPOINTS) : j);
+        write_chunk[bit_reversed(j, LOGPOINTS)] = buf[offset + (current_index >> LOGPOINTS)][(current_index + shift) & (POINTS - 1)];
+      }
+#ifdef XILINX_FPGA
+      buf2x8.i0 = write_chunk[0];
+      buf2x8.i1 = write_chunk[1];
+      buf2x8.i2 = write_chunk[2];
+      buf2x8.i3 = write_chunk[3];
+      buf2x8.i4 = write_chunk[4];
+      buf2x8.i5 = write_chunk[5];
+      buf2x8.i6 = write_chunk[6];
+      buf2x8.i7 = write_chunk[7];
+
+      write_pipe_block(chanin/*PY_CODE_GEN i*/, &buf2x8);
+#endif
+#ifdef INTEL_FPGA
+      __attribute__((opencl_unroll_hint(POINTS)))
+      for(int j = 0; j < POINTS; j++){
+        write_channel_intel(chanin/*PY_CODE_GEN i*/[j], write_chunk[j]);
+      }
+#endif
+    }
+  }
+}
+
+/**
+Forward FFT of count signals. The spectra are forwarded in bit-reversed order to the multiply kernel.
+ */
+__attribute__ ((max_global_work_dim(0)))
+__attribute__((reqd_work_group_size(1,1,1)))
+kernel void fft1d/*PY_CODE_GEN i*/(int count) {
+
+  const int N = (1 << LOGN);
+
+  float2 fft_delay_elements[N + POINTS * (LOGN - 2)] __attribute__((xcl_array_partition(complete, 0)));
+
+  // The engine outputs are delayed by N / POINTS - 1 steps
+   __attribute__((xcl_pipeline_loop(1)))
+  for (unsigned i = 0; i < count * (N / POINTS) + N / POINTS - 1; i++) {
+
+    float2x8 data;
+    if (i < count * (N / POINTS)) {
+#ifdef INTEL_FPGA
+      data.i0 = read_channel_intel(chanin/*PY_CODE_GEN i*/[0]);
+      data.i1 = read_channel_intel(chanin/*PY_CODE_GEN i*/[1]);
+      data.i2 = read_channel_intel(chanin/*PY_CODE_GEN i*/[2]);
+      data.i3 = read_channel_intel(chanin/*PY_CODE_GEN i*/[3]);
+      data.i4 = read_channel_intel(chanin/*PY_CODE_GEN i*/[4]);
+      data.i5 = read_channel_intel(chanin/*PY_CODE_GEN i*/[5]);
+      data.i6 = read_channel_intel(chanin/*PY_CODE_GEN i*/[6]);
+      data.i7 = read_channel_intel(chanin/*PY_CODE_GEN i*/[7]);
+#endif
+#ifdef XILINX_FPGA
+      read_pipe_block(chanin/*PY_CODE_GEN i*/, &data);
+#endif
+    } else {
+      data.i0 = data.i1 = data.i2 = data.i3 =
+                data.i4 = data.i5 = data.i6 = data.i7 = 0;
+    }
+
+    data = fft_step(data, i % (N / POINTS), fft_delay_elements, 0, LOGN);
+
+    if (i >= N / POINTS - 1) {
+#ifdef INTEL_FPGA
+      write_channel_intel(chanspectrum/*PY_CODE_GEN i*/[0], data.i0);
+      write_channel_intel(chanspectrum/*PY_CODE_GEN i*/[1], data.i1);
+      write_channel_intel(chanspectrum/*PY_CODE_GEN i*/[2], data.i2);
+      write_channel_intel(chanspectrum/*PY_CODE_GEN i*/[3], data.i3);
+      write_channel_intel(chanspectrum/*PY_CODE_GEN i*/[4], data.i4);
+      write_channel_intel(chanspectrum/*PY_CODE_GEN i*/[5], data.i5);
+      write_channel_intel(chanspectrum/*PY_CODE_GEN i*/[6], data.i6);
+      write_channel_intel(chanspectrum/*PY_CODE_GEN i*/[7], data.i7);
+#endif
+#ifdef XILINX_FPGA
+      write_pipe_block(chanspectrum/*PY_CODE_GEN i*/, &data);
+#endif
+    }
+  }
+}
+
+/**
+Multiply the spectra with the filter spectrum and reorder the products for the inverse FFT.
+Output j of step s of the forward FFT has the natural index n = bit_reversed(POINTS * s + j, LOGN).
+Its upper LOGPOINTS bits are bit_reversed(j, LOGPOINTS) and its lower bits bit_reversed(s, LOGN - LOGPOINTS).
+The FFT engine expects the values with the natural indices bit_reversed(l, LOGPOINTS) * N / POINTS + k
+in step k and lane l. So the buffer is banked by the upper bits of the natural index and every step
+writes and reads a single row of the buffer without bank conflicts.
+
+@param filter The filter spectrum in the bit-reversed output order of the forward FFT
+@param count The number of signals
+ */
+__kernel
+__attribute__ ((max_global_work_dim(0), reqd_work_group_size(1,1,1)))
+void multiply/*PY_CODE_GEN i*/(__global /*PY_CODE_GEN kernel_param_attributes[i % num_total_replications]["in"]*/ float2 * restrict filter, int count) {
+
+  const int N = (1 << LOGN);
+
+  // The filter spectrum is loaded once and used for all signals
+  float2 filter_buf[N/POINTS][POINTS] __attribute__((numbanks(POINTS), xcl_array_partition(complete, 2)));
+  for (unsigned k = 0; k < N / POINTS; k++) {
+    __attribute__((opencl_unroll_hint(POINTS)))
+    for (int j = 0; j < POINTS; j++) {
+      filter_buf[k][j] = filter[(k << LOGPOINTS) + j];
+    }
+  }
+
+  // Buffer that can hold the products of two FFTs
+  float2 buf[2*N/POINTS][POINTS] __attribute__((numbanks(POINTS), xcl_array_partition(complete, 2)));
+
+  // for count iterations and one additional iteration to empty the last buffer
+  for (unsigned k = 0; k < (count + 1) * (N / POINTS); k++) {
+    if (k < count * (N / POINTS)) {
+      float2x8 data;
+#ifdef INTEL_FPGA
+      data.i0 = read_channel_intel(chanspectrum/*PY_CODE_GEN i*/[0]);
+      data.i1 = read_channel_intel(chanspectrum/*PY_CODE_GEN i*/[1]);
+      data.i2 = read_channel_intel(chanspectrum/*PY_CODE_GEN i*/[2]);
+      data.i3 = read_channel_intel(chanspectrum/*PY_CODE_GEN i*/[3]);
+      data.i4 = read_channel_intel(chanspectrum/*PY_CODE_GEN i*/[4]);
+      data.i5 = read_channel_intel(chanspectrum/*PY_CODE_GEN i*/[5]);
+      data.i6 = read_channel_intel(chanspectrum/*PY_CODE_GEN i*/[6]);
+      data.i7 = read_channel_intel(chanspectrum/*PY_CODE_GEN i*/[7]);
+#endif
+#ifdef XILINX_FPGA
+      read_pipe_block(chanspectrum/*PY_CODE_GEN i*/, &data);
+#endif
+      float2 values[POINTS] = {data.i0, data.i1, data.i2, data.i3, data.i4, data.i5, data.i6, data.i7};
+      unsigned step = k & (N / POINTS - 1);
+      unsigned offset = ((k >> (LOGN - LOGPOINTS)) & 1) * (N / POINTS);
+      unsigned row = bit_reversed(step, LOGN - LOGPOINTS);
+      __attribute__((opencl_unroll_hint(POINTS)))
+      for (int j = 0; j < POINTS; j++) {
+        buf[offset + row][bit_reversed(j, LOGPOINTS)] = complex_mult(values[j], filter_buf[step][j]);
+      }
+    }
+    // Forward the products of the previous FFT while the current one is written into the buffer
+    if (k >= N / POINTS) {
+      unsigned offset = (((k >> (LOGN - LOGPOINTS)) & 1) == 0) ? (N / POINTS) : 0;
+      float2 write_chunk[POINTS];
+      __attribute__((opencl_unroll_hint(POINTS)))
+      for (int l = 0; l < POINTS; l++) {
+        write_chunk[l] = buf[offset + (k & (N / POINTS - 1))][bit_reversed(l, LOGPOINTS)];
+      }
+#ifdef XILINX_FPGA
+      float2x8 buf2x8;
+      buf2x8.i0 = write_chunk[0];
+      buf2x8.i1 = write_chunk[1];
+      buf2x8.i2 = write_chunk[2];
+      buf2x8.i3 = write_chunk[3];
+      buf2x8.i4 = write_chunk[4];
+      buf2x8.i5 = write_chunk[5];
+      buf2x8.i6 = write_chunk[6];
+      buf2x8.i7 = write_chunk[7];
+      write_pipe_block(chanproduct/*PY_CODE_GEN i*/, &buf2x8);
+#endif
+#ifdef INTEL_FPGA
+      __attribute__((opencl_unroll_hint(POINTS)))
+      for (int l = 0; l < POINTS; l++) {
+        write_channel_intel(chanproduct/*PY_CODE_GEN i*/[l], write_chunk[l]);
+      }
+#endif
+    }
+  }
+}
+
+/**
+Inverse FFT of the products. The convolved signals are written to global memory in the same order
+as the output of the fft1d kernel in fft1d_float_8.cl.
+ */
+__attribute__ ((max_global_work_dim(0)))
+__attribute__((reqd_work_group_size(1,1,1)))
+kernel void ifft1d/*PY_CODE_GEN i*/(
+#ifdef INTEL_FPGA
+                __global /*PY_CODE_GEN kernel_param_attributes[i % num_total_replications]["out"]*/ float2 * restrict dest,
+#endif
+                int count) {
+
+  const int N = (1 << LOGN);
+
+  float2 fft_delay_elements[N + POINTS * (LOGN - 2)] __attribute__((xcl_array_partition(complete, 0)));
+
+#if defined(INTEL_FPGA) && defined(FFT_NATURAL_ORDER_OUTPUT)
+  // Buffer that holds two FFTs to reorder the output while the next FFT is calculated
+  float2 reorder_buf[2 * N / POINTS][POINTS] __attribute__((numbanks(POINTS)));
+  const int reorder_delay = N / POINTS;
+#else
+  const int reorder_delay = 0;
+#endif
+
+   __attribute__((xcl_pipeline_loop(1)))
+  for (unsigned i = 0; i < count * (N / POINTS) + N / POINTS - 1 + reorder_delay; i++) {
+
+    float2x8 data;
+    if (i < count * (N / POINTS)) {
+#ifdef INTEL_FPGA
+      data.i0 = read_channel_intel(chanproduct/*PY_CODE_GEN i*/[0]);
+      data.i1 = read_channel_intel(chanproduct/*PY_CODE_GEN i*/[1]);
+      data.i2 = read_channel_intel(chanproduct/*PY_CODE_GEN i*/[2]);
+      data.i3 = read_channel_intel(chanproduct/*PY_CODE_GEN i*/[3]);
+      data.i4 = read_channel_intel(chanproduct/*PY_CODE_GEN i*/[4]);
+      data.i5 = read_channel_intel(chanproduct/*PY_CODE_GEN i*/[5]);
+      data.i6 = read_channel_intel(chanproduct/*PY_CODE_GEN i*/[6]);
+      data.i7 = read_channel_intel(chanproduct/*PY_CODE_GEN i*/[7]);
+#endif
+#ifdef XILINX_FPGA
+      read_pipe_block(chanproduct/*PY_CODE_GEN i*/, &data);
+#endif
+    } else {
+      data.i0 = data.i1 = data.i2 = data.i3 =
+                data.i4 = data.i5 = data.i6 = data.i7 = 0;
+    }
+
+    data = fft_step(data, i % (N / POINTS), fft_delay_elements, 1, LOGN);
+
+#if defined(INTEL_FPGA) && defined(FFT_NATURAL_ORDER_OUTPUT)
+    unsigned out_step = i - (N / POINTS - 1);
+    if (i >= N / POINTS - 1 && out_step < count * (N / POINTS)) {
+      unsigned write_offset = ((out_step >> (LOGN - LOGPOINTS)) & 1) * (N / POINTS);
+      reorder_write(reorder_buf, data, out_step & (N / POINTS - 1), write_offset, LOGN);
+    }
+    if (i >= N / POINTS - 1 + N / POINTS) {
+      unsigned natural_step = out_step - N / POINTS;
+      unsigned read_offset = ((natural_step >> (LOGN - LOGPOINTS)) & 1) * (N / POINTS);
+      float2x8 natural_data = reorder_read(reorder_buf, natural_step & (N / POINTS - 1), read_offset, LOGN);
+      int base = POINTS * natural_step;
+
+      dest[base]     = natural_data.i0;
+      dest[base + 1] = natural_data.i1;
+      dest[base + 2] = natural_data.i2;
+      dest[base + 3] = natural_data.i3;
+      dest[base + 4] = natural_data.i4;
+      dest[base + 5] = natural_data.i5;
+      dest[base + 6] = natural_data.i6;
+      dest[base + 7] = natural_data.i7;
+    }
+#else
+    if (i >= N / POINTS - 1) {
+#ifdef INTEL_FPGA
+      int base = POINTS * (i - (N / POINTS - 1));
+
+      dest[base]     = data.i0;
+      dest[base + 1] = data.i1;
+      dest[base + 2] = data.i2;
+      dest[base + 3] = data.i3;
+      dest[base + 4] = data.i4;
+      dest[base + 5] = data.i5;
+      dest[base + 6] = data.i6;
+      dest[base + 7] = data.i7;
+#endif
+#ifdef XILINX_FPGA
+      write_pipe_block(chanout/*PY_CODE_GEN i*/, &data);
+#endif
+    }
+#endif
+  }
+}
+
+#ifdef XILINX_FPGA
+/**
+The store kernel just reads from the output channel and writes the data to the global memory.
+ */
+__kernel
+__attribute__ ((max_global_work_dim(0), reqd_work_group_size(1,1,1)))
+void store/*PY_CODE_GEN i*/(__global /*PY_CODE_GEN kernel_param_attributes[i % num_total_replications]["out"]*/ float2 * restrict dest, int iter) {
+
+  const int N = (1 << LOGN);
+
+#ifdef FFT_NATURAL_ORDER_OUTPUT
+  // Buffer that holds two FFTs to reorder the output while the next FFT is received
+  float2 reorder_buf[2 * N / POINTS][POINTS] __attribute__((xcl_array_partition(complete, 2)));
+
+  for(unsigned k = 0; k < (iter + 1) * (N / POINTS); k++){
+    if (k < iter * (N / POINTS)) {
+      float2x8 in2x8;
+      read_pipe_block(chanout/*PY_CODE_GEN i*/, &in2x8);
+      reorder_write(reorder_buf, in2x8, k & (N / POINTS - 1), ((k >> (LOGN - LOGPOINTS)) & 1) * (N / POINTS), LOGN);
+    }
+    if (k >= N / POINTS) {
+      unsigned natural_k = k - N / POINTS;
+      float2x8 buf2x8 = reorder_read(reorder_buf, natural_k & (N / POINTS - 1), ((natural_k >> (LOGN - LOGPOINTS)) & 1) * (N / POINTS), LOGN);
+
+      dest[(natural_k << LOGPOINTS)]     = buf2x8.i0;
+      dest[(natural_k << LOGPOINTS) + 1] = buf2x8.i1;
+      dest[(natural_k << LOGPOINTS) + 2] = buf2x8.i2;
+      dest[(natural_k << LOGPOINTS) + 3] = buf2x8.i3;
+      dest[(natural_k << LOGPOINTS) + 4] = buf2x8.i4;
+      dest[(natural_k << LOGPOINTS) + 5] = buf2x8.i5;
+      dest[(natural_k << LOGPOINTS) + 6] = buf2x8.i6;
+      dest[(natural_k << LOGPOINTS) + 7] = buf2x8.i7;
+    }
+  }
+#else
+  for(unsigned k = 0; k < iter * (N / POINTS); k++){
+      float2x8 buf2x8;
+      read_pipe_block(chanout/*PY_CODE_GEN i*/, &buf2x8);
+
+      dest[(k << LOGPOINTS)]     = buf2x8.i0;
+      dest[(k << LOGPOINTS) + 1] = buf2x8.i1;
+      dest[(k << LOGPOINTS) + 2] = buf2x8.i2;
+      dest[(k << LOGPOINTS) + 3] = buf2x8.i3;
+      dest[(k << LOGPOINTS) + 4] = buf2x8.i4;
+      dest[(k << LOGPOINTS) + 5] = buf2x8.i5;
+      dest[(k << LOGPOINTS) + 6] = buf2x8.i6;
+      dest[(k << LOGPOINTS) + 7] = buf2x8.i7;
+  }
+#endif
+}
+#endif
+
+//PY_CODE_GEN block_end
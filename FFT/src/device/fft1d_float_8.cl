@@ -41,8 +41,22 @@
  * engine. This argument has to be a compile time constant to ensure that the 
  * compiler can propagate it throughout the function body and generate 
  * efficient hardware.
+ * The kernels are replicated for every FFT size given in log_fft_sizes, so a
+ * single bitstream can contain multiple FFT sizes.
  */
 
+// The code generator expects a list of the Log2 FFT sizes that should be synthesized.
+// Kernels for the size with index s are named with the offset s * num_total_replications.
+/* PY_CODE_GEN 
+try:
+    log_fft_sizes
+except NameError:
+    log_fft_sizes = ["LOG_FFT_SIZE"]
+*/
+
+// The FFT engine uses the largest size to define its buffer types
+#define MAX_LOG_FFT_SIZE /*PY_CODE_GEN max(log_fft_sizes)*/
+
 // Include source code for an engine that produces 8 points each step
 #include "fft_8.cl"
 
@@ -61,15 +75,13 @@ except:
 
 #define min(a,b) (a<b?a:b)
 
-#define LOGN            LOG_FFT_SIZE
-
 #define LOGPOINTS       3
 #define POINTS          (1 << LOGPOINTS)
 
 // Need some depth to our channels to accommodate their bursty filling.
 #ifdef INTEL_FPGA
 #pragma OPENCL EXTENSION cl_intel_channels : enable
-// PY_CODE_GEN block_start [replace(local_variables=locals()) for i in range(num_total_replications)]
+// PY_CODE_GEN block_start [replace(local_variables=locals()) for i in range(num_total_replications * len(log_fft_sizes))]
 channel float2 chanin/*PY_CODE_GEN i*/[POINTS] __attribute__((depth(POINTS)));
 // PY_CODE_GEN block_end
 #endif
@@ -78,29 +90,23 @@ channel float2 chanin/*PY_CODE_GEN i*/[POINTS] __attribute__((depth(POINTS)));
 //#define XILINX_PIPE_DEPTH ((1 << (LOGN - LOGPOINTS) < 16) ? 16 : (1 << (LOGN - LOGPOINTS)))
 
 // Compiler states, that the pipe depth needs at least to be 16
-// PY_CODE_GEN block_start [replace(local_variables=locals()) for i in range(num_total_replications)]
+// PY_CODE_GEN block_start [replace(local_variables=locals()) for i in range(num_total_replications * len(log_fft_sizes))]
 pipe float2x8 chanin/*PY_CODE_GEN i*/ __attribute__((xcl_reqd_pipe_depth(XILINX_PIPE_DEPTH)));
 pipe float2x8 chanout/*PY_CODE_GEN i*/ __attribute__((xcl_reqd_pipe_depth(XILINX_PIPE_DEPTH)));
 // PY_CODE_GEN block_end
 #endif
 
-uint bit_reversed(uint x, uint bits) {
-  uint y = 0;
-__attribute__((opencl_unroll_hint()))
-  for (uint i = 0; i < bits; i++) {
-    y <<= 1;
-    y |= x & 1;
-    x >>= 1;
-  }
-  y &= ((1 << bits) - 1);
-  return y;
-}
+// Bit reversal and the on-chip reordering of the output to natural order
+#include "fft_reorder.cl"
+
+// PY_CODE_GEN block_start [replace(local_variables=locals()) for i in range(num_total_replications * len(log_fft_sizes))]
 
-// PY_CODE_GEN block_start [replace(local_variables=locals()) for i in range(num_total_replications)]
+#undef LOGN
+#define LOGN /*PY_CODE_GEN log_fft_sizes[i // num_total_replications]*/
 
 __kernel
 __attribute__ ((max_global_work_dim(0), reqd_work_group_size(1,1,1)))
-void fetch/*PY_CODE_GEN i*/(__global /*PY_CODE_GEN kernel_param_attributes[i]["in"]*/ float2 * restrict src, int iter) {
+void fetch/*PY_CODE_GEN i*/(__global /*PY_CODE_GEN kernel_param_attributes[i % num_total_replications]["in"]*/ float2 * restrict src, int iter) {
 
   const int N = (1 << LOGN);
 
@@ -196,7 +202,7 @@ __attribute__((reqd_work_group_size(1,1,1)))
 kernel void fft1d/*PY_CODE_GEN i*/(
 #ifdef INTEL_FPGA
                 // Intel does not need a store kernel and directly writes back the result to global memory
-                __global /*PY_CODE_GEN kernel_param_attributes[i]["out"]*/ float2 * restrict dest,
+                __global /*PY_CODE_GEN kernel_param_attributes[i % num_total_replications]["out"]*/ float2 * restrict dest,
 #endif
                 int count, int inverse) {
 
@@ -210,16 +216,27 @@ kernel void fft1d/*PY_CODE_GEN i*/(
 
   float2 fft_delay_elements[N + POINTS * (LOGN - 2)] __attribute__((xcl_array_partition(complete, 0)));
 
+#if defined(INTEL_FPGA) && defined(FFT_NATURAL_ORDER_OUTPUT)
+  // Buffer that holds two FFTs to reorder the output while the next FFT is calculated
+  float2 reorder_buf[2 * N / POINTS][POINTS] __attribute__((numbanks(POINTS)));
+  // The reorder buffer delays the output by one FFT
+  const int reorder_delay = N / POINTS;
+#else
+  const int reorder_delay = 0;
+#endif
+
   /* This is the main loop. It runs 'count' back-to-back FFT transforms
    * In addition to the 'count * (N / 8)' iterations, it runs 'N / 8 - 1'
    * additional iterations to drain the last outputs 
    * (see comments attached to the FFT engine)
+   * If the output is reordered on the device, another 'N / 8' iterations
+   * are needed to empty the reorder buffer
    *
    * The compiler leverages pipeline parallelism by overlapping the 
    * iterations of this loop - launching one iteration every clock cycle
    */
    __attribute__((xcl_pipeline_loop(1)))
-  for (unsigned i = 0; i < count * (N / POINTS) + N / POINTS - 1; i++) {
+  for (unsigned i = 0; i < count * (N / POINTS) + N / POINTS - 1 + reorder_delay; i++) {
 
     /* As required by the FFT engine, gather input data from 8 distinct 
      * segments of the input buffer; for simplicity, this implementation 
@@ -258,6 +275,31 @@ kernel void fft1d/*PY_CODE_GEN i*/(
     /* Store data back to memory. FFT engine outputs are delayed by 
      * N / 8 - 1 steps, hence gate writes accordingly
      */
+#if defined(INTEL_FPGA) && defined(FFT_NATURAL_ORDER_OUTPUT)
+    unsigned out_step = i - (N / POINTS - 1);
+    if (i >= N / POINTS - 1 && out_step < count * (N / POINTS)) {
+      // Alternate between the two halves of the buffer for every FFT
+      unsigned write_offset = ((out_step >> (LOGN - LOGPOINTS)) & 1) * (N / POINTS);
+      reorder_write(reorder_buf, data, out_step & (N / POINTS - 1), write_offset, LOGN);
+    }
+    // Write the previous FFT in natural order, while the current FFT is written into the buffer
+    if (i >= N / POINTS - 1 + N / POINTS) {
+      unsigned natural_step = out_step - N / POINTS;
+      unsigned read_offset = ((natural_step >> (LOGN - LOGPOINTS)) & 1) * (N / POINTS);
+      float2x8 natural_data = reorder_read(reorder_buf, natural_step & (N / POINTS - 1), read_offset, LOGN);
+      int base = POINTS * natural_step;
+
+      // These consecutive accesses will be coalesced by the compiler
+      dest[base]     = natural_data.i0;
+      dest[base + 1] = natural_data.i1;
+      dest[base + 2] = natural_data.i2;
+      dest[base + 3] = natural_data.i3;
+      dest[base + 4] = natural_data.i4;
+      dest[base + 5] = natural_data.i5;
+      dest[base + 6] = natural_data.i6;
+      dest[base + 7] = natural_data.i7;
+    }
+#else
     if (i >= N / POINTS - 1) {
 #ifdef INTEL_FPGA
       int base = POINTS * (i - (N / POINTS - 1));
@@ -277,6 +319,7 @@ kernel void fft1d/*PY_CODE_GEN i*/(
       write_pipe_block(chanout/*PY_CODE_GEN i*/, &data);
 #endif
     }
+#endif
   }
 }
 
@@ -287,10 +330,36 @@ This kernel works without conditional branches which enables memory bursts.
  */
 __kernel
 __attribute__ ((max_global_work_dim(0), reqd_work_group_size(1,1,1)))
-void store/*PY_CODE_GEN i*/(__global /*PY_CODE_GEN kernel_param_attributes[i]["out"]*/ float2 * restrict dest, int iter) {
+void store/*PY_CODE_GEN i*/(__global /*PY_CODE_GEN kernel_param_attributes[i % num_total_replications]["out"]*/ float2 * restrict dest, int iter) {
 
   const int N = (1 << LOGN);
 
+#ifdef FFT_NATURAL_ORDER_OUTPUT
+  // Buffer that holds two FFTs to reorder the output while the next FFT is received
+  float2 reorder_buf[2 * N / POINTS][POINTS] __attribute__((xcl_array_partition(complete, 2)));
+
+  // for iter iterations and one additional iteration to empty the reorder buffer
+  for(unsigned k = 0; k < (iter + 1) * (N / POINTS); k++){ 
+    if (k < iter * (N / POINTS)) {
+      float2x8 in2x8;
+      read_pipe_block(chanout/*PY_CODE_GEN i*/, &in2x8);
+      reorder_write(reorder_buf, in2x8, k & (N / POINTS - 1), ((k >> (LOGN - LOGPOINTS)) & 1) * (N / POINTS), LOGN);
+    }
+    if (k >= N / POINTS) {
+      unsigned natural_k = k - N / POINTS;
+      float2x8 buf2x8 = reorder_read(reorder_buf, natural_k & (N / POINTS - 1), ((natural_k >> (LOGN - LOGPOINTS)) & 1) * (N / POINTS), LOGN);
+
+      dest[(natural_k << LOGPOINTS)]     = buf2x8.i0;
+      dest[(natural_k << LOGPOINTS) + 1] = buf2x8.i1;
+      dest[(natural_k << LOGPOINTS) + 2] = buf2x8.i2;
+      dest[(natural_k << LOGPOINTS) + 3] = buf2x8.i3;
+      dest[(natural_k << LOGPOINTS) + 4] = buf2x8.i4;
+      dest[(natural_k << LOGPOINTS) + 5] = buf2x8.i5;
+      dest[(natural_k << LOGPOINTS) + 6] = buf2x8.i6;
+      dest[(natural_k << LOGPOINTS) + 7] = buf2x8.i7;
+    }
+  }
+#else
   // write the data back to global memory using memory bursts
   for(unsigned k = 0; k < iter * (N / POINTS); k++){ 
       float2x8 buf2x8;
@@ -305,6 +374,7 @@ void store/*PY_CODE_GEN i*/(__global /*PY_CODE_GEN kernel_param_attributes[i]["o
       dest[(k << LOGPOINTS) + 6] = buf2x8.i6; 
       dest[(k << LOGPOINTS) + 7] = buf2x8.i7;    
   }
+#endif
 }
 #endif
 
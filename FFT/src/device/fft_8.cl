@@ -46,6 +46,11 @@
 
 #include "parameters.h"
 
+// Largest FFT size the engine is used with. It defines the size of the sliding window type
+#ifndef MAX_LOG_FFT_SIZE
+#define MAX_LOG_FFT_SIZE LOG_FFT_SIZE
+#endif
+
 // Convenience struct representing the 8 data points processed each step
 // Each member is a float2 representing a complex number
 typedef struct {
@@ -140,7 +145,7 @@ float2x8 swap(float2x8 data) {
 // Input 'data' from invocation N would be returned in invocation N + depth
 // The 'shift_reg' sliding window is shifted by 1 element at every invocation 
 __attribute__((always_inline))
-float2 delay(float2 data, const int depth, float2 shift_reg[(1 << LOG_FFT_SIZE) + 8 * (LOG_FFT_SIZE - 2)], unsigned offset) {
+float2 delay(float2 data, const int depth, float2 shift_reg[(1 << MAX_LOG_FFT_SIZE) + 8 * (MAX_LOG_FFT_SIZE - 2)], unsigned offset) {
    shift_reg[offset + depth] = data;
    return shift_reg[offset];
 }
@@ -151,7 +156,7 @@ float2 delay(float2 data, const int depth, float2 shift_reg[(1 << LOG_FFT_SIZE)
 // data.i0         : GECA...   ---->      DBCA...
 // data.i1         : HFDB...   ---->      HFGE...
 __attribute__((always_inline))
-float2x8 reorder_data(float2x8 data, const int depth, float2 shift_reg[(1 << LOG_FFT_SIZE) + 8 * (LOG_FFT_SIZE - 2)], unsigned head_index, bool toggle) {
+float2x8 reorder_data(float2x8 data, const int depth, float2 shift_reg[(1 << MAX_LOG_FFT_SIZE) + 8 * (MAX_LOG_FFT_SIZE - 2)], unsigned head_index, bool toggle) {
    // Use disconnected segments of length 'depth + 1' elements starting at 
    // 'shift_reg' to implement the delay elements. At the end of each FFT step, 
    // the contents of the entire buffer is shifted by 1 element
@@ -265,7 +270,7 @@ float2x8 complex_rotate(float2x8 data, int index, int stage, int size) {
 //        propagated throughout the code to achieve efficient hardware
 //
 __attribute__((always_inline))
-float2x8 fft_step(float2x8 data, int step, float2 fft_delay_elements[(1 << LOG_FFT_SIZE) + 8 * (LOG_FFT_SIZE - 2)], 
+float2x8 fft_step(float2x8 data, int step, float2 fft_delay_elements[(1 << MAX_LOG_FFT_SIZE) + 8 * (MAX_LOG_FFT_SIZE - 2)], 
                   bool inverse, const int logN) {
 
     const int size = 1 << logN;
@@ -289,7 +294,7 @@ float2x8 fft_step(float2x8 data, int step, float2 fft_delay_elements[(1 << LOG_F
     // the loop to increase the  amount of pipeline parallelism and allow feed 
     // forward execution
 
-   __attribute__((opencl_unroll_hint(LOG_FFT_SIZE - 3)))
+   __attribute__((opencl_unroll_hint(MAX_LOG_FFT_SIZE - 3)))
     for (int stage = 2; stage < logN - 1; stage++) {
         bool complex_stage = stage & 1; // stages 3, 5, ...
 
@@ -0,0 +1,111 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Helper functions to reorder the data streams of the FFT engine.
+ * They expect LOGPOINTS and POINTS to be defined and the float2x8 type of the engine.
+ */
+
+uint bit_reversed(uint x, uint bits) {
+  uint y = 0;
+__attribute__((opencl_unroll_hint()))
+  for (uint i = 0; i < bits; i++) {
+    y <<= 1;
+    y |= x & 1;
+    x >>= 1;
+  }
+  y &= ((1 << bits) - 1);
+  return y;
+}
+
+#ifdef FFT_NATURAL_ORDER_OUTPUT
+/**
+Bank of the output with the natural index n in the on-chip reorder buffer. The row within the bank is n / POINTS.
+The POINTS outputs of a step of the FFT engine and POINTS consecutive outputs in natural order are always
+mapped to different banks, so the buffer can be written and read once every clock cycle without conflicts.
+ */
+uint reorder_bank(uint n, uint logn) {
+  uint shift = (logn < 2 * LOGPOINTS) ? (2 * LOGPOINTS - logn) : 0;
+  uint high = n >> (logn - LOGPOINTS);
+  uint low = n & ((1 << (logn - LOGPOINTS)) - 1);
+  return (high + (low << shift)) & (POINTS - 1);
+}
+
+/**
+Write the outputs of a step of the FFT engine into the reorder buffer.
+The output j of step s has the natural index bit_reversed(POINTS * s + j, logn).
+The outputs are first sorted by bank, so every bank is accessed with a constant index.
+
+@param buf The reorder buffer that can hold two FFTs
+@param data The outputs of the FFT engine
+@param step The step of the FFT engine within the current FFT
+@param offset The first row of the current FFT in the buffer
+@param logn Log2 of the FFT size
+ */
+void reorder_write(float2 buf[][POINTS], float2x8 data, uint step, uint offset, uint logn) {
+  float2 values[POINTS] = {data.i0, data.i1, data.i2, data.i3, data.i4, data.i5, data.i6, data.i7};
+  float2 banked_values[POINTS];
+  uint banked_rows[POINTS];
+  __attribute__((opencl_unroll_hint(POINTS)))
+  for (uint j = 0; j < POINTS; j++) {
+    uint n = bit_reversed(step * POINTS + j, logn);
+    uint bank = reorder_bank(n, logn);
+    banked_values[bank] = values[j];
+    banked_rows[bank] = n >> LOGPOINTS;
+  }
+  __attribute__((opencl_unroll_hint(POINTS)))
+  for (uint b = 0; b < POINTS; b++) {
+    buf[offset + banked_rows[b]][b] = banked_values[b];
+  }
+}
+
+/**
+Read POINTS consecutive outputs in natural order from the reorder buffer.
+
+@param buf The reorder buffer that can hold two FFTs
+@param step The index of the outputs divided by POINTS within the FFT
+@param offset The first row of the FFT in the buffer
+@param logn Log2 of the FFT size
+@return the outputs with the natural indices POINTS * step to POINTS * step + POINTS - 1
+ */
+float2x8 reorder_read(float2 buf[][POINTS], uint step, uint offset, uint logn) {
+  float2 banked_values[POINTS];
+  float2 values[POINTS];
+  __attribute__((opencl_unroll_hint(POINTS)))
+  for (uint b = 0; b < POINTS; b++) {
+    banked_values[b] = buf[offset + step][b];
+  }
+  __attribute__((opencl_unroll_hint(POINTS)))
+  for (uint j = 0; j < POINTS; j++) {
+    values[j] = banked_values[reorder_bank(step * POINTS + j, logn)];
+  }
+  float2x8 data;
+  data.i0 = values[0];
+  data.i1 = values[1];
+  data.i2 = values[2];
+  data.i3 = values[3];
+  data.i4 = values[4];
+  data.i5 = values[5];
+  data.i6 = values[6];
+  data.i7 = values[7];
+  return data;
+}
+#endif
@@ -48,6 +48,36 @@ simple exchange of the different calculation methods.
     std::unique_ptr<fft::FFTExecutionTimings>
     calculate(hpcc_base::ExecutionSettings<fft::FFTProgramSettings> const& config, std::complex<HOST_DATA_TYPE>* data, std::complex<HOST_DATA_TYPE>* data_out, unsigned iterations, bool inverse);
 
+/**
+Calculate the fast convolution of the signals with a filter spectrum on the FPGA.
+The forward FFT, the multiplication with the filter spectrum and the inverse FFT are chained on the device,
+so only the signals and the convolved signals are transferred. The transfers are part of the measured time.
+
+@param config struct that contains all necessary information to execute the kernel on the FPGA
+@param data The input signals
+@param filter The filter spectrum in natural order. It is used for all signals
+@param data_out The convolved signals in the output order of the FFT kernels. They are not normalized
+@param iterations Number of signals
+
+@return The measured execution times
+*/
+    std::unique_ptr<fft::FFTExecutionTimings>
+    calculateConvolution(hpcc_base::ExecutionSettings<fft::FFTProgramSettings> const& config, std::complex<HOST_DATA_TYPE>* data,
+                            std::complex<HOST_DATA_TYPE> const* filter, std::complex<HOST_DATA_TYPE>* data_out, unsigned iterations);
+
+namespace cpu {
+
+/**
+Calculate the FFTs on the host CPU. FFTW is used if it was found, otherwise a radix-2 implementation
+parallelized over the iterations with OpenMP. The output is stored in the same order as the output of the FPGA kernel.
+
+@copydoc bm_execution::calculate()
+*/
+    std::unique_ptr<fft::FFTExecutionTimings>
+    calculate(hpcc_base::ExecutionSettings<fft::FFTProgramSettings> const& config, std::complex<HOST_DATA_TYPE>* data, std::complex<HOST_DATA_TYPE>* data_out, unsigned iterations, bool inverse);
+
+}  // namespace cpu
+
 }  // namespace bm_execution
 
 #endif  // SRC_HOST_EXECUTION_H_
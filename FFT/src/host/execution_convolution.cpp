@@ -0,0 +1,234 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "execution.h"
+
+/* C++ standard library headers */
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include <chrono>
+
+/* External library headers */
+#ifdef INTEL_FPGA
+#ifdef USE_HBM
+// CL_HETEROGENEOUS_INTELFPGA is defined here
+#include "CL/cl_ext_intelfpga.h"
+#endif
+#endif
+
+namespace bm_execution {
+
+    /*
+    Implementation for the convolution kernels of fft1d_convolution_float_8.cl.
+     @copydoc bm_execution::calculateConvolution()
+    */
+    std::unique_ptr<fft::FFTExecutionTimings>
+    calculateConvolution(hpcc_base::ExecutionSettings<fft::FFTProgramSettings> const& config,
+            std::complex<HOST_DATA_TYPE>* data,
+            std::complex<HOST_DATA_TYPE> const* filter,
+            std::complex<HOST_DATA_TYPE>* data_out,
+            unsigned iterations) {
+
+        int err;
+
+        std::vector<cl::Buffer> inBuffers;
+        std::vector<cl::Buffer> outBuffers;
+        std::vector<cl::Buffer> filterBuffers;
+        std::vector<cl::Kernel> fetchKernels;
+        std::vector<cl::Kernel> fftKernels;
+        std::vector<cl::Kernel> multiplyKernels;
+        std::vector<cl::Kernel> ifftKernels;
+        std::vector<cl::Kernel> storeKernels;
+        std::vector<cl::CommandQueue> fetchQueues;
+        std::vector<cl::CommandQueue> fftQueues;
+        std::vector<cl::CommandQueue> multiplyQueues;
+        std::vector<cl::CommandQueue> ifftQueues;
+        std::vector<cl::CommandQueue> storeQueues;
+
+        unsigned iterations_per_kernel = iterations / config.programSettings->kernelReplications;
+
+        const uint log_size = config.programSettings->logFFTSize;
+        size_t bytes_per_kernel = (1 << log_size) * static_cast<size_t>(iterations_per_kernel) * 2 * sizeof(HOST_DATA_TYPE);
+        // The kernels for the FFT size with index s in LOG_FFT_SIZES are named with the offset s * NUM_REPLICATIONS
+        std::vector<uint> available_sizes LOG_FFT_SIZES;
+        unsigned kernel_offset = std::distance(available_sizes.begin(),
+                                                std::find(available_sizes.begin(), available_sizes.end(), log_size)) * NUM_REPLICATIONS;
+
+        // The multiply kernel expects the filter spectrum in the bit-reversed output order of the forward FFT
+        std::vector<std::complex<HOST_DATA_TYPE>> filter_engine_order(filter, filter + (1 << log_size));
+        fft::bit_reverse(filter_engine_order.data(), 1, log_size);
+
+        for (int r=0; r < config.programSettings->kernelReplications; r++) {
+                // Input, output and filter buffer
+                cl_mem_flags memory_bank_info[3] = {0};
+#ifdef INTEL_FPGA
+#ifdef USE_HBM
+                for (cl_mem_flags& v : memory_bank_info) {
+                         v = CL_MEM_HETEROGENEOUS_INTELFPGA;
+                }
+#else
+                if (!config.programSettings->useMemoryInterleaving) {
+                        for (int k = 0; k < 3; k++) {
+                                memory_bank_info[k] = hpcc_base::memory_placement::getBankFlags(config.programSettings->memoryPlacement, r, k, 3,
+                                                                                        config.programSettings->memoryBanks);
+                        }
+                }
+#endif
+#endif
+                inBuffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[0], bytes_per_kernel, NULL, &err));
+                ASSERT_CL(err)
+                outBuffers.push_back(cl::Buffer(*config.context, CL_MEM_WRITE_ONLY | memory_bank_info[1], bytes_per_kernel, NULL, &err));
+                ASSERT_CL(err)
+                filterBuffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[2], (1 << log_size) * 2 * sizeof(HOST_DATA_TYPE), NULL, &err));
+                ASSERT_CL(err)
+
+                auto kernel_name = [&](std::string const& base) {
+                        std::string name = base + std::to_string(kernel_offset + r);
+#ifdef XILINX_FPGA
+                        name += ":{" + name + "_1}";
+#endif
+                        return name;
+                };
+                cl::Kernel fetchKernel(*config.program, kernel_name(FETCH_KERNEL_NAME).c_str(), &err);
+                ASSERT_CL(err)
+                cl::Kernel fftKernel(*config.program, kernel_name(FFT_KERNEL_NAME).c_str(), &err);
+                ASSERT_CL(err)
+                cl::Kernel multiplyKernel(*config.program, kernel_name(MULTIPLY_KERNEL_NAME).c_str(), &err);
+                ASSERT_CL(err)
+                cl::Kernel ifftKernel(*config.program, kernel_name(INVERSE_FFT_KERNEL_NAME).c_str(), &err);
+                ASSERT_CL(err)
+
+                err = fetchKernel.setArg(0, inBuffers[r]);
+                ASSERT_CL(err)
+                err = fetchKernel.setArg(1, iterations_per_kernel);
+                ASSERT_CL(err)
+                err = fftKernel.setArg(0, iterations_per_kernel);
+                ASSERT_CL(err)
+                err = multiplyKernel.setArg(0, filterBuffers[r]);
+                ASSERT_CL(err)
+                err = multiplyKernel.setArg(1, iterations_per_kernel);
+                ASSERT_CL(err)
+        #ifdef INTEL_FPGA
+                err = ifftKernel.setArg(0, outBuffers[r]);
+                ASSERT_CL(err)
+                err = ifftKernel.setArg(1, iterations_per_kernel);
+                ASSERT_CL(err)
+        #endif
+        #ifdef XILINX_FPGA
+                err = ifftKernel.setArg(0, iterations_per_kernel);
+                ASSERT_CL(err)
+                cl::Kernel storeKernel(*config.program, kernel_name(STORE_KERNEL_NAME).c_str(), &err);
+                ASSERT_CL(err)
+                err = storeKernel.setArg(0, outBuffers[r]);
+                ASSERT_CL(err)
+                err = storeKernel.setArg(1, iterations_per_kernel);
+                ASSERT_CL(err)
+                storeQueues.push_back(cl::CommandQueue(*config.context, config.getDevice(r), config.profiler->getQueueProperties(), &err));
+                ASSERT_CL(err)
+                storeKernels.push_back(storeKernel);
+        #endif
+
+                // All kernels of a replication are running concurrently, so every kernel needs its own queue
+                fetchQueues.push_back(cl::CommandQueue(*config.context, config.getDevice(r), config.profiler->getQueueProperties(), &err));
+                ASSERT_CL(err)
+                fftQueues.push_back(cl::CommandQueue(*config.context, config.getDevice(r), config.profiler->getQueueProperties(), &err));
+                ASSERT_CL(err)
+                multiplyQueues.push_back(cl::CommandQueue(*config.context, config.getDevice(r), config.profiler->getQueueProperties(), &err));
+                ASSERT_CL(err)
+                ifftQueues.push_back(cl::CommandQueue(*config.context, config.getDevice(r), config.profiler->getQueueProperties(), &err));
+                ASSERT_CL(err)
+
+                fetchKernels.push_back(fetchKernel);
+                fftKernels.push_back(fftKernel);
+                multiplyKernels.push_back(multiplyKernel);
+                ifftKernels.push_back(ifftKernel);
+
+                // The filter is the same for all repetitions, so it is not part of the measurement
+                err = multiplyQueues[r].enqueueWriteBuffer(filterBuffers[r], CL_TRUE, 0, (1 << log_size) * 2 * sizeof(HOST_DATA_TYPE), filter_engine_order.data(),
+                                                        nullptr, config.profiler->event("write_filter"));
+                ASSERT_CL(err)
+        }
+
+        std::vector<double> calculationTimings;
+        std::vector<std::vector<double>> deviceTimings;
+        config.repetitions->start(*config.programSettings);
+        for (uint rep = 0; config.repetitions->next(calculationTimings); rep++) {
+            // The input signals are transferred to and the convolved signals from the device in every repetition,
+            // so the measured time is host to host
+            auto startCalculation = std::chrono::high_resolution_clock::now();
+            for (int r=0; r < config.programSettings->kernelReplications; r++) {
+#ifdef XILINX_FPGA
+                cl::CommandQueue& outQueue = storeQueues[r];
+#else
+                cl::CommandQueue& outQueue = ifftQueues[r];
+#endif
+                err = fetchQueues[r].enqueueWriteBuffer(inBuffers[r], CL_FALSE, 0, bytes_per_kernel, &data[r * (1 << log_size) * iterations_per_kernel],
+                                                        nullptr, config.profiler->event("write_data"));
+                ASSERT_CL(err)
+                fetchQueues[r].enqueueNDRangeKernel(fetchKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1), nullptr, config.profiler->event("fetch"));
+                fftQueues[r].enqueueNDRangeKernel(fftKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1), nullptr, config.profiler->event("fft"));
+                multiplyQueues[r].enqueueNDRangeKernel(multiplyKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1), nullptr, config.profiler->event("multiply"));
+                ifftQueues[r].enqueueNDRangeKernel(ifftKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1), nullptr, config.profiler->event("ifft"));
+#ifdef XILINX_FPGA
+                storeQueues[r].enqueueNDRangeKernel(storeKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1), nullptr, config.profiler->event("store"));
+#endif
+                err = outQueue.enqueueReadBuffer(outBuffers[r], CL_FALSE, 0, bytes_per_kernel, &data_out[r * (1 << log_size) * iterations_per_kernel],
+                                                nullptr, config.profiler->event("read_data_out"));
+                ASSERT_CL(err)
+            }
+            size_t num_devices = config.devices.size();
+            auto deviceTimes = hpcc_base::multi_device::waitForDevices(num_devices, startCalculation, [&](size_t d) {
+                for (size_t r=d; r < static_cast<size_t>(config.programSettings->kernelReplications); r += num_devices) {
+                    fetchQueues[r].finish();
+                    fftQueues[r].finish();
+                    multiplyQueues[r].finish();
+                    ifftQueues[r].finish();
+#ifdef XILINX_FPGA
+                    storeQueues[r].finish();
+#endif
+                }
+            });
+            auto endCalculation = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> calculationTime =
+                    std::chrono::duration_cast<std::chrono::duration<double>>
+                            (endCalculation - startCalculation);
+            calculationTimings.push_back(calculationTime.count());
+            deviceTimings.resize(num_devices);
+            for (size_t d = 0; d < num_devices; d++) {
+                deviceTimings[d].push_back(deviceTimes[d]);
+            }
+        }
+        config.repetitions->discardWarmup(calculationTimings);
+        for (auto& t : deviceTimings) {
+            config.repetitions->discardWarmup(t);
+        }
+        std::unique_ptr<fft::FFTExecutionTimings> result(new fft::FFTExecutionTimings{
+                calculationTimings,
+                deviceTimings
+        });
+        return result;
+    }
+
+}  // namespace bm_execution
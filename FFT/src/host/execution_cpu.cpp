@@ -0,0 +1,121 @@
+/*
+Copyright (c) 2021 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "execution.h"
+
+/* C++ standard library headers */
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <vector>
+
+/* External library headers */
+#ifdef _USE_FFTW_
+#include "fftw3.h"
+#endif
+
+namespace bm_execution {
+namespace cpu {
+
+    /*
+    Implementation of the FFT for the host CPU.
+     @copydoc bm_execution::cpu::calculate()
+    */
+    std::unique_ptr<fft::FFTExecutionTimings>
+    calculate(hpcc_base::ExecutionSettings<fft::FFTProgramSettings> const&  config,
+            std::complex<HOST_DATA_TYPE>* data,
+            std::complex<HOST_DATA_TYPE>* data_out,
+            unsigned iterations,
+            bool inverse) {
+
+        const int fft_size = (1 << config.programSettings->logFFTSize);
+
+#ifdef _USE_FFTW_
+        static_assert(sizeof(HOST_DATA_TYPE) == sizeof(float), "FFTW is only used for single precision FFTs");
+        // A single plan is executed on the data of every iteration. The plan can be used by multiple threads with new arrays.
+        fftwf_plan plan = fftwf_plan_dft_1d(fft_size, reinterpret_cast<fftwf_complex*>(data), reinterpret_cast<fftwf_complex*>(data_out),
+                                            inverse ? FFTW_BACKWARD : FFTW_FORWARD, FFTW_ESTIMATE | FFTW_UNALIGNED);
+#else
+        // Twiddle factors for the radix-2 decimation in frequency
+        std::vector<std::complex<HOST_DATA_TYPE>> twiddles(fft_size / 2);
+        for (int k = 0; k < fft_size / 2; k++) {
+            double angle = (inverse ? 2.0 : -2.0) * M_PI * k / fft_size;
+            twiddles[k] = std::complex<HOST_DATA_TYPE>(std::cos(angle), std::sin(angle));
+        }
+#endif
+
+        std::vector<double> calculationTimings;
+        config.repetitions->start(*config.programSettings);
+        for (uint r = 0; config.repetitions->next(calculationTimings); r++) {
+            auto startCalculation = std::chrono::high_resolution_clock::now();
+            #pragma omp parallel for
+            for (int i = 0; i < static_cast<int>(iterations); i++) {
+                std::complex<HOST_DATA_TYPE>* in = &data[static_cast<size_t>(i) * fft_size];
+                std::complex<HOST_DATA_TYPE>* out = &data_out[static_cast<size_t>(i) * fft_size];
+#ifdef _USE_FFTW_
+                fftwf_execute_dft(plan, reinterpret_cast<fftwf_complex*>(in), reinterpret_cast<fftwf_complex*>(out));
+#else
+                for (int j = 0; j < fft_size; j++) {
+                    out[j] = in[j];
+                }
+                // The decimation in frequency leaves the result in bit-reversed order
+                for (int len = fft_size; len >= 2; len >>= 1) {
+                    int half = len / 2;
+                    int stride = fft_size / len;
+                    for (int start = 0; start < fft_size; start += len) {
+                        #pragma omp simd
+                        for (int k = 0; k < half; k++) {
+                            std::complex<HOST_DATA_TYPE> u = out[start + k];
+                            std::complex<HOST_DATA_TYPE> v = out[start + k + half];
+                            out[start + k] = u + v;
+                            out[start + k + half] = (u - v) * twiddles[k * stride];
+                        }
+                    }
+                }
+#endif
+            }
+            auto endCalculation = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> calculationTime =
+                    std::chrono::duration_cast<std::chrono::duration<double>>(endCalculation - startCalculation);
+            calculationTimings.push_back(calculationTime.count());
+        }
+        config.repetitions->discardWarmup(calculationTimings);
+
+#ifdef _USE_FFTW_
+        fftwf_destroy_plan(plan);
+#endif
+#if defined(_USE_FFTW_) != defined(FFT_NATURAL_ORDER_OUTPUT)
+        // FFTW returns the result in natural order and the radix-2 implementation in bit-reversed order,
+        // so it is reordered like the output of the FPGA kernel. This is not included in the measured time.
+        fft::bit_reverse(data_out, iterations, config.programSettings->logFFTSize);
+#endif
+
+        std::unique_ptr<fft::FFTExecutionTimings> result(new fft::FFTExecutionTimings{
+                calculationTimings, std::vector<std::vector<double>>()
+        });
+        return result;
+    }
+
+}  // namespace cpu
+}  // namespace bm_execution
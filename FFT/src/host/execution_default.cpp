@@ -24,6 +24,7 @@ SOFTWARE.
 #include "execution.h"
 
 /* C++ standard library headers */
+#include <algorithm>
 #include <memory>
 #include <vector>
 #include <chrono>
@@ -63,16 +64,29 @@ namespace bm_execution {
         std::vector<cl::CommandQueue> storeQueues;
 
         unsigned iterations_per_kernel = iterations / config.programSettings->kernelReplications;
+        // In streaming mode the buffers only hold one chunk and two of them are used alternately per replication
+        unsigned stream_chunk = config.programSettings->streamChunk;
+        unsigned buffer_iterations = (stream_chunk > 0) ? stream_chunk : iterations_per_kernel;
+        std::vector<cl::Buffer> inBuffersPong;
+        std::vector<cl::Buffer> outBuffersPong;
+        std::vector<cl::CommandQueue> writeQueues;
+        std::vector<cl::CommandQueue> readQueues;
+
+        const uint log_size = config.programSettings->logFFTSize;
+        // The kernels for the FFT size with index s in LOG_FFT_SIZES are named with the offset s * NUM_REPLICATIONS
+        std::vector<uint> available_sizes LOG_FFT_SIZES;
+        unsigned kernel_offset = std::distance(available_sizes.begin(),
+                                                std::find(available_sizes.begin(), available_sizes.end(), log_size)) * NUM_REPLICATIONS;
 
         for (int r=0; r < config.programSettings->kernelReplications; r++) {
                 // Array of flags for each buffer that is allocated in this benchmark
                 // The content of the flags will be changed according to the used compiler flags
                 // to support different kinds of devices
-                int memory_bank_info[2] = {0};
+                cl_mem_flags memory_bank_info[2] = {0};
 #ifdef INTEL_FPGA
 #ifdef USE_HBM
                 // For Intel HBM the buffers have to be created with a special flag
-                for (int& v : memory_bank_info) {
+                for (cl_mem_flags& v : memory_bank_info) {
                          v = CL_MEM_HETEROGENEOUS_INTELFPGA;
                 }
 #else
@@ -82,20 +96,32 @@ namespace bm_execution {
                 // For boards with HBM, the selection of memory banks is done in the kernel code.
                 if (!config.programSettings->useMemoryInterleaving) {
                         for (int k = 0; k < 2; k++) {
-                                memory_bank_info[k] = (((2 * r) + 1 + k) << 16);
+                                memory_bank_info[k] = hpcc_base::memory_placement::getBankFlags(config.programSettings->memoryPlacement, r, k, 2,
+                                                                                        config.programSettings->memoryBanks);
                         }
                 }
 #endif
 #endif
-                inBuffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[0], (1 << LOG_FFT_SIZE) * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), NULL, &err));
+                inBuffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[0], (1 << log_size) * buffer_iterations * 2 * sizeof(HOST_DATA_TYPE), NULL, &err));
                 ASSERT_CL(err)
-                outBuffers.push_back(cl::Buffer(*config.context, CL_MEM_WRITE_ONLY | memory_bank_info[1], (1 << LOG_FFT_SIZE) * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), NULL, &err));
+                outBuffers.push_back(cl::Buffer(*config.context, CL_MEM_WRITE_ONLY | memory_bank_info[1], (1 << log_size) * buffer_iterations * 2 * sizeof(HOST_DATA_TYPE), NULL, &err));
                 ASSERT_CL(err)
+                if (stream_chunk > 0) {
+                        inBuffersPong.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[0], (1 << log_size) * buffer_iterations * 2 * sizeof(HOST_DATA_TYPE), NULL, &err));
+                        ASSERT_CL(err)
+                        outBuffersPong.push_back(cl::Buffer(*config.context, CL_MEM_WRITE_ONLY | memory_bank_info[1], (1 << log_size) * buffer_iterations * 2 * sizeof(HOST_DATA_TYPE), NULL, &err));
+                        ASSERT_CL(err)
+                        // Separate queues for the host transfers, so they can overlap with the kernels of the other buffer
+                        writeQueues.push_back(cl::CommandQueue(*config.context, config.getDevice(r), config.profiler->getQueueProperties(), &err));
+                        ASSERT_CL(err)
+                        readQueues.push_back(cl::CommandQueue(*config.context, config.getDevice(r), config.profiler->getQueueProperties(), &err));
+                        ASSERT_CL(err)
+                }
 
         #ifdef INTEL_FPGA
-                cl::Kernel fetchKernel(*config.program, (FETCH_KERNEL_NAME + std::to_string(r)).c_str(), &err);
+                cl::Kernel fetchKernel(*config.program, (FETCH_KERNEL_NAME + std::to_string(kernel_offset + r)).c_str(), &err);
                 ASSERT_CL(err)
-                cl::Kernel fftKernel(*config.program, (FFT_KERNEL_NAME + std::to_string(r)).c_str(), &err);
+                cl::Kernel fftKernel(*config.program, (FFT_KERNEL_NAME + std::to_string(kernel_offset + r)).c_str(), &err);
                 ASSERT_CL(err)
         #ifdef USE_SVM
                 err = clSetKernelArgSVMPointer(fetchKernel(), 0,
@@ -117,11 +143,11 @@ namespace bm_execution {
         #endif
 
         #ifdef XILINX_FPGA
-                cl::Kernel fetchKernel(*config.program, (std::string(FETCH_KERNEL_NAME) + std::to_string(r) + ":{" + FETCH_KERNEL_NAME + std::to_string(r) + "_1"  + "}").c_str(), &err);
+                cl::Kernel fetchKernel(*config.program, (std::string(FETCH_KERNEL_NAME) + std::to_string(kernel_offset + r) + ":{" + FETCH_KERNEL_NAME + std::to_string(kernel_offset + r) + "_1"  + "}").c_str(), &err);
                 ASSERT_CL(err)
-                cl::Kernel fftKernel(*config.program, (std::string(FFT_KERNEL_NAME) + std::to_string(r) + ":{" + FFT_KERNEL_NAME + std::to_string(r) + "_1" + "}").c_str(), &err);
+                cl::Kernel fftKernel(*config.program, (std::string(FFT_KERNEL_NAME) + std::to_string(kernel_offset + r) + ":{" + FFT_KERNEL_NAME + std::to_string(kernel_offset + r) + "_1" + "}").c_str(), &err);
                 ASSERT_CL(err)
-                cl::Kernel storeKernel(*config.program, (std::string(STORE_KERNEL_NAME) + std::to_string(r) + ":{" + STORE_KERNEL_NAME + std::to_string(r) + "_1" + "}").c_str(), &err);
+                cl::Kernel storeKernel(*config.program, (std::string(STORE_KERNEL_NAME) + std::to_string(kernel_offset + r) + ":{" + STORE_KERNEL_NAME + std::to_string(kernel_offset + r) + "_1" + "}").c_str(), &err);
                 ASSERT_CL(err)
                 err = storeKernel.setArg(0, outBuffers[r]);
                 ASSERT_CL(err)
@@ -136,7 +162,7 @@ namespace bm_execution {
                 err = fftKernel.setArg(1, static_cast<cl_int>(inverse));
                 ASSERT_CL(err)
 
-                storeQueues.push_back(cl::CommandQueue(*config.context, *config.device, 0, &err));
+                storeQueues.push_back(cl::CommandQueue(*config.context, config.getDevice(r), config.profiler->getQueueProperties(), &err));
                 ASSERT_CL(err)
 
                 storeKernels.push_back(storeKernel);
@@ -145,9 +171,9 @@ namespace bm_execution {
                 err = fetchKernel.setArg(1, iterations_per_kernel);
                 ASSERT_CL(err)
 
-                fetchQueues.push_back(cl::CommandQueue(*config.context, *config.device, 0, &err));
+                fetchQueues.push_back(cl::CommandQueue(*config.context, config.getDevice(r), config.profiler->getQueueProperties(), &err));
                 ASSERT_CL(err)
-                fftQueues.push_back(cl::CommandQueue(*config.context, *config.device, 0, &err));
+                fftQueues.push_back(cl::CommandQueue(*config.context, config.getDevice(r), config.profiler->getQueueProperties(), &err));
                 ASSERT_CL(err)
 
                 fetchKernels.push_back(fetchKernel);
@@ -156,62 +182,237 @@ namespace bm_execution {
 #ifdef USE_SVM
                 err = clEnqueueSVMMap(fetchQueues[r](), CL_TRUE,
                                 CL_MAP_READ,
-                                reinterpret_cast<void *>(&data[r * (1 << LOG_FFT_SIZE) * iterations_per_kernel]),
-                                (1 << LOG_FFT_SIZE) * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), 0,
+                                reinterpret_cast<void *>(&data[r * (1 << log_size) * iterations_per_kernel]),
+                                (1 << log_size) * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), 0,
                                 NULL, NULL);
                 ASSERT_CL(err)
                 err = clEnqueueSVMMap(fftQueues[r](), CL_TRUE,
                                 CL_MAP_WRITE,
-                                reinterpret_cast<void *>(&data_out[r * (1 << LOG_FFT_SIZE) * iterations_per_kernel]),
-                                (1 << LOG_FFT_SIZE) * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), 0,
+                                reinterpret_cast<void *>(&data_out[r * (1 << log_size) * iterations_per_kernel]),
+                                (1 << log_size) * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), 0,
                                 NULL, NULL);
                 ASSERT_CL(err)
 #else
-                err = fetchQueues[r].enqueueWriteBuffer(inBuffers[r],CL_TRUE,0, (1 << LOG_FFT_SIZE) * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), &data[r * (1 << LOG_FFT_SIZE) * iterations_per_kernel]);
-                ASSERT_CL(err)
+                if (stream_chunk == 0) {
+                        err = fetchQueues[r].enqueueWriteBuffer(inBuffers[r],CL_TRUE,0, (1 << log_size) * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), &data[r * (1 << log_size) * iterations_per_kernel],
+                                                                nullptr, config.profiler->event("write_data"));
+                        ASSERT_CL(err)
+                }
 #endif
         }
 
         std::vector<double> calculationTimings;
-        for (uint r =0; r < config.programSettings->numRepetitions; r++) {
+        std::vector<std::vector<double>> deviceTimings;
+#ifndef USE_SVM
+        if (config.programSettings->dimensions > 1) {
+            // Multi-dimensional FFT: Every pass calculates the 1D FFTs along the last axis of the local slab
+            // and rotates the axes with a global transpose. Host transfers and communication are measured as well.
+            size_t local_size = (1 << log_size) * static_cast<size_t>(iterations);
+            size_t bytes_per_kernel = (1 << log_size) * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE);
+            std::vector<std::complex<HOST_DATA_TYPE>> pass_data(local_size);
+            config.repetitions->start(*config.programSettings);
+            for (uint rep = 0; config.repetitions->next(calculationTimings); rep++) {
+                auto startCalculation = std::chrono::high_resolution_clock::now();
+                std::copy(data, data + local_size, pass_data.begin());
+                for (uint d = 0; d < config.programSettings->dimensions; d++) {
+                    for (int r=0; r < config.programSettings->kernelReplications; r++) {
+#ifdef XILINX_FPGA
+                        cl::CommandQueue& outQueue = storeQueues[r];
+#else
+                        cl::CommandQueue& outQueue = fftQueues[r];
+#endif
+                        err = fetchQueues[r].enqueueWriteBuffer(inBuffers[r], CL_FALSE, 0, bytes_per_kernel, &pass_data[r * (1 << log_size) * iterations_per_kernel],
+                                                                nullptr, config.profiler->event("write_data"));
+                        ASSERT_CL(err)
+                        fetchQueues[r].enqueueNDRangeKernel(fetchKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1), nullptr, config.profiler->event("fetch"));
+                        fftQueues[r].enqueueNDRangeKernel(fftKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1), nullptr, config.profiler->event("fft"));
+#ifdef XILINX_FPGA
+                        storeQueues[r].enqueueNDRangeKernel(storeKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1), nullptr, config.profiler->event("store"));
+#endif
+                        err = outQueue.enqueueReadBuffer(outBuffers[r], CL_FALSE, 0, bytes_per_kernel, &data_out[r * (1 << log_size) * iterations_per_kernel],
+                                                        nullptr, config.profiler->event("read_data_out"));
+                        ASSERT_CL(err)
+                    }
+                    for (int r=0; r < config.programSettings->kernelReplications; r++) {
+                        fetchQueues[r].finish();
+                        fftQueues[r].finish();
+#ifdef XILINX_FPGA
+                        storeQueues[r].finish();
+#endif
+                    }
+                    fft::rotate_axes(data_out, pass_data.data(), log_size, config.programSettings->dimensions);
+                }
+                auto endCalculation = std::chrono::high_resolution_clock::now();
+                std::chrono::duration<double> calculationTime =
+                        std::chrono::duration_cast<std::chrono::duration<double>>
+                                (endCalculation - startCalculation);
+                calculationTimings.push_back(calculationTime.count());
+            }
+            config.repetitions->discardWarmup(calculationTimings);
+            // After one pass per dimension, the axes are back in their original order
+            std::copy(pass_data.begin(), pass_data.end(), data_out);
+            std::unique_ptr<fft::FFTExecutionTimings> result(new fft::FFTExecutionTimings{
+                    calculationTimings,
+                    deviceTimings
+            });
+            return result;
+        }
+        if (stream_chunk > 0) {
+            // Streaming mode: The data of every replication is transferred in chunks through two buffers.
+            // While the kernels work on one buffer, the results of the previous chunk are read back and the next chunk is written
+            // to the other buffer. Host transfers are part of the measured time.
+            unsigned num_chunks = iterations_per_kernel / stream_chunk;
+            size_t bytes_per_chunk = (1 << log_size) * stream_chunk * 2 * sizeof(HOST_DATA_TYPE);
+            config.repetitions->start(*config.programSettings);
+            for (uint rep = 0; config.repetitions->next(calculationTimings); rep++) {
+                std::vector<std::vector<cl::Event>> write_events(config.programSettings->kernelReplications, std::vector<cl::Event>(num_chunks));
+                std::vector<std::vector<cl::Event>> fetch_events(config.programSettings->kernelReplications, std::vector<cl::Event>(num_chunks));
+                std::vector<std::vector<cl::Event>> out_events(config.programSettings->kernelReplications, std::vector<cl::Event>(num_chunks));
+                std::vector<std::vector<cl::Event>> read_events(config.programSettings->kernelReplications, std::vector<cl::Event>(num_chunks));
+                auto startCalculation = std::chrono::high_resolution_clock::now();
+                // The commands are only enqueued and synchronized with events, so all replications are working concurrently
+                for (unsigned c = 0; c < num_chunks; c++) {
+                    for (int r=0; r < config.programSettings->kernelReplications; r++) {
+                        cl::Buffer& inBuffer = (c % 2 == 0) ? inBuffers[r] : inBuffersPong[r];
+                        cl::Buffer& outBuffer = (c % 2 == 0) ? outBuffers[r] : outBuffersPong[r];
+                        size_t offset = (1 << log_size) * (static_cast<size_t>(r) * iterations_per_kernel + static_cast<size_t>(c) * stream_chunk);
+
+                        // The input buffer can be overwritten as soon as the fetch kernel two chunks before is done
+                        std::vector<cl::Event> write_dependencies;
+                        if (c >= 2) {
+                            write_dependencies.push_back(fetch_events[r][c - 2]);
+                        }
+                        err = writeQueues[r].enqueueWriteBuffer(inBuffer, CL_FALSE, 0, bytes_per_chunk, &data[offset],
+                                                                &write_dependencies, &write_events[r][c]);
+                        ASSERT_CL(err)
+                        config.profiler->addEvent("write_data", write_events[r][c]);
+
+                        ASSERT_CL(fetchKernels[r].setArg(0, inBuffer));
+                        ASSERT_CL(fetchKernels[r].setArg(1, stream_chunk));
+                        std::vector<cl::Event> fetch_dependencies{write_events[r][c]};
+                        err = fetchQueues[r].enqueueNDRangeKernel(fetchKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1),
+                                                                &fetch_dependencies, &fetch_events[r][c]);
+                        ASSERT_CL(err)
+                        config.profiler->addEvent("fetch", fetch_events[r][c]);
+
+                        // The kernel writing the output buffer has to wait until the results of two chunks before are read back
+                        std::vector<cl::Event> out_dependencies;
+                        if (c >= 2) {
+                            out_dependencies.push_back(read_events[r][c - 2]);
+                        }
+#ifdef INTEL_FPGA
+                        ASSERT_CL(fftKernels[r].setArg(0, outBuffer));
+                        ASSERT_CL(fftKernels[r].setArg(1, stream_chunk));
+                        err = fftQueues[r].enqueueNDRangeKernel(fftKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1),
+                                                                &out_dependencies, &out_events[r][c]);
+                        ASSERT_CL(err)
+                        config.profiler->addEvent("fft", out_events[r][c]);
+#endif
+#ifdef XILINX_FPGA
+                        ASSERT_CL(fftKernels[r].setArg(0, stream_chunk));
+                        err = fftQueues[r].enqueueNDRangeKernel(fftKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1), nullptr, config.profiler->event("fft"));
+                        ASSERT_CL(err)
+                        ASSERT_CL(storeKernels[r].setArg(0, outBuffer));
+                        ASSERT_CL(storeKernels[r].setArg(1, stream_chunk));
+                        err = storeQueues[r].enqueueNDRangeKernel(storeKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1),
+                                                                &out_dependencies, &out_events[r][c]);
+                        ASSERT_CL(err)
+                        config.profiler->addEvent("store", out_events[r][c]);
+#endif
+
+                        std::vector<cl::Event> read_dependencies{out_events[r][c]};
+                        err = readQueues[r].enqueueReadBuffer(outBuffer, CL_FALSE, 0, bytes_per_chunk, &data_out[offset],
+                                                                &read_dependencies, &read_events[r][c]);
+                        ASSERT_CL(err)
+                        config.profiler->addEvent("read_data_out", read_events[r][c]);
+                    }
+                }
+                size_t num_devices = config.devices.size();
+                auto deviceTimes = hpcc_base::multi_device::waitForDevices(num_devices, startCalculation, [&](size_t d) {
+                    for (size_t r=d; r < static_cast<size_t>(config.programSettings->kernelReplications); r += num_devices) {
+                        writeQueues[r].finish();
+                        fetchQueues[r].finish();
+                        fftQueues[r].finish();
+#ifdef XILINX_FPGA
+                        storeQueues[r].finish();
+#endif
+                        readQueues[r].finish();
+                    }
+                });
+                auto endCalculation = std::chrono::high_resolution_clock::now();
+                std::chrono::duration<double> calculationTime =
+                        std::chrono::duration_cast<std::chrono::duration<double>>
+                                (endCalculation - startCalculation);
+                calculationTimings.push_back(calculationTime.count());
+                deviceTimings.resize(num_devices);
+                for (size_t d = 0; d < num_devices; d++) {
+                    deviceTimings[d].push_back(deviceTimes[d]);
+                }
+            }
+            config.repetitions->discardWarmup(calculationTimings);
+            for (auto& t : deviceTimings) {
+                config.repetitions->discardWarmup(t);
+            }
+            std::unique_ptr<fft::FFTExecutionTimings> result(new fft::FFTExecutionTimings{
+                    calculationTimings,
+                    deviceTimings
+            });
+            return result;
+        }
+#endif
+        config.repetitions->start(*config.programSettings);
+        for (uint r =0; config.repetitions->next(calculationTimings); r++) {
             auto startCalculation = std::chrono::high_resolution_clock::now();
             for (int r=0; r < config.programSettings->kernelReplications; r++) {
-                fetchQueues[r].enqueueNDRangeKernel(fetchKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1));
-                fftQueues[r].enqueueNDRangeKernel(fftKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1));
+                fetchQueues[r].enqueueNDRangeKernel(fetchKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1), nullptr, config.profiler->event("fetch"));
+                fftQueues[r].enqueueNDRangeKernel(fftKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1), nullptr, config.profiler->event("fft"));
         #ifdef XILINX_FPGA
-                storeQueues[r].enqueueNDRangeKernel(storeKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1));
+                storeQueues[r].enqueueNDRangeKernel(storeKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1), nullptr, config.profiler->event("store"));
         #endif
             }
-            for (int r=0; r < config.programSettings->kernelReplications; r++) {
-                fetchQueues[r].finish();
-                fftQueues[r].finish();
+            size_t num_devices = config.devices.size();
+            auto deviceTimes = hpcc_base::multi_device::waitForDevices(num_devices, startCalculation, [&](size_t d) {
+                for (size_t r=d; r < static_cast<size_t>(config.programSettings->kernelReplications); r += num_devices) {
+                    fetchQueues[r].finish();
+                    fftQueues[r].finish();
 #ifdef XILINX_FPGA
-                storeQueues[r].finish();
+                    storeQueues[r].finish();
 #endif
-            }
+                }
+            });
             auto endCalculation = std::chrono::high_resolution_clock::now();
             std::chrono::duration<double> calculationTime =
                     std::chrono::duration_cast<std::chrono::duration<double>>
                             (endCalculation - startCalculation);
             calculationTimings.push_back(calculationTime.count());
+            deviceTimings.resize(num_devices);
+            for (size_t d = 0; d < num_devices; d++) {
+                deviceTimings[d].push_back(deviceTimes[d]);
+            }
+        }
+        config.repetitions->discardWarmup(calculationTimings);
+        for (auto& t : deviceTimings) {
+            config.repetitions->discardWarmup(t);
         }
         for (int r=0; r < config.programSettings->kernelReplications; r++) {
 #ifdef USE_SVM
                 err = clEnqueueSVMUnmap(fetchQueues[r](),
-                                        reinterpret_cast<void *>(&data[r * (1 << LOG_FFT_SIZE) * iterations_per_kernel]), 0,
+                                        reinterpret_cast<void *>(&data[r * (1 << log_size) * iterations_per_kernel]), 0,
                                         NULL, NULL);
                 ASSERT_CL(err)
                 err = clEnqueueSVMUnmap(fftQueues[r](),
-                                        reinterpret_cast<void *>(&data_out[r * (1 << LOG_FFT_SIZE) * iterations_per_kernel]), 0,
+                                        reinterpret_cast<void *>(&data_out[r * (1 << log_size) * iterations_per_kernel]), 0,
                                         NULL, NULL);
                 ASSERT_CL(err)
 #else
-                err = fetchQueues[r].enqueueReadBuffer(outBuffers[r],CL_TRUE,0, (1 << LOG_FFT_SIZE) * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), &data_out[r * (1 << LOG_FFT_SIZE) * iterations_per_kernel]);
+                err = fetchQueues[r].enqueueReadBuffer(outBuffers[r],CL_TRUE,0, (1 << log_size) * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), &data_out[r * (1 << log_size) * iterations_per_kernel],
+                                                        nullptr, config.profiler->event("read_data_out"));
                 ASSERT_CL(err)
 #endif
         }
         std::unique_ptr<fft::FFTExecutionTimings> result(new fft::FFTExecutionTimings{
-                calculationTimings
+                calculationTimings,
+                deviceTimings
         });
         return result;
     }
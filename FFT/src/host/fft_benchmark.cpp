@@ -27,39 +27,82 @@ SOFTWARE.
 #include "fft_benchmark.hpp"
 
 /* C++ standard library headers */
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <random>
+#include <vector>
+
+/* External library headers */
+#ifdef _USE_FFTW_REFERENCE_
+#include "fftw3.h"
+#endif
 
 /* Project's headers */
 #include "execution.h"
+#include "hpcc_suite.hpp"
 #include "parameters.h"
 
 fft::FFTProgramSettings::FFTProgramSettings(cxxopts::ParseResult &results) : hpcc_base::BaseSettings(results),
-    iterations(results["b"].as<uint>()), inverse(results.count("inverse")), kernelReplications(results["r"].as<uint>()) {
-
+    iterations(results["b"].as<uint>()), inverse(results.count("inverse")), kernelReplications(results["r"].as<uint>()),
+    logFFTSize(results["log-size"].as<uint>()), dimensions(results["dimensions"].as<uint>()),
+    streamChunk(results["stream-chunk"].as<uint>()), realSignals(results.count("real")), convolution(results.count("convolution")),
+    memoryPlacement(hpcc_base::memory_placement::retrievePolicy(results["placement"].as<std::string>())),
+    memoryBanks(results["banks"].as<uint>()) {
+    if (memoryBanks == 0 || memoryBanks > hpcc_base::memory_placement::MAX_BANKS) {
+        throw std::runtime_error("Number of memory banks has to be between 1 and " + std::to_string(hpcc_base::memory_placement::MAX_BANKS) + "!");
+    }
 }
 
 std::map<std::string, std::string>
 fft::FFTProgramSettings::getSettingsMap() {
         auto map = hpcc_base::BaseSettings::getSettingsMap();
-        map["FFT Size"] = std::to_string(1 << LOG_FFT_SIZE);
-        map["Batch Size"] = std::to_string(iterations);
+        map["FFT Size"] = std::to_string(1 << logFFTSize);
+        map["FFT Dimensions"] = std::to_string(dimensions);
+        if (dimensions == 1) {
+            map["Batch Size"] = std::to_string(iterations);
+        }
         map["Kernel Replications"] = std::to_string(kernelReplications);
+        map["Stream Chunk Size"] = (streamChunk > 0) ? std::to_string(streamChunk) : "disabled";
+#ifdef FFT_NATURAL_ORDER_OUTPUT
+        map["Output Order"] = "natural";
+#else
+        map["Output Order"] = "bit-reversed";
+#endif
+#ifdef USE_HBM
+        map["Memory Placement"] = "kernel attributes (HBM)";
+#else
+        map["Memory Placement"] = useMemoryInterleaving ? "interleaved" :
+                    hpcc_base::memory_placement::policyToString(memoryPlacement) + ", " + std::to_string(memoryBanks) + " banks";
+#endif
+        map["Real Signals"] = realSignals ? (inverse ? "C2R, 2 per FFT" : "R2C, 2 per FFT") : "no";
+        map["Convolution"] = convolution ? "FFT, multiply, iFFT on device" : "no";
         return map;
 }
 
-fft::FFTData::FFTData(cl::Context context, uint iterations) : context(context) {
+fft::FFTData::FFTData(cl::Context context, uint iterations, uint logFFTSize, bool realSignals, bool convolution) : spectra(nullptr), filter(nullptr), context(context) {
 #ifdef USE_SVM
     data = reinterpret_cast<std::complex<HOST_DATA_TYPE>*>(
                         clSVMAlloc(context(), 0 ,
-                        iterations * (1 << LOG_FFT_SIZE) * sizeof(std::complex<HOST_DATA_TYPE>), 1024));
+                        iterations * (1 << logFFTSize) * sizeof(std::complex<HOST_DATA_TYPE>), 1024));
     data_out = reinterpret_cast<std::complex<HOST_DATA_TYPE>*>(
                         clSVMAlloc(context(), 0 ,
-                        iterations * (1 << LOG_FFT_SIZE) * sizeof(std::complex<HOST_DATA_TYPE>), 1024));
+                        iterations * (1 << logFFTSize) * sizeof(std::complex<HOST_DATA_TYPE>), 1024));
 #else
-    posix_memalign(reinterpret_cast<void**>(&data), 64, iterations * (1 << LOG_FFT_SIZE) * sizeof(std::complex<HOST_DATA_TYPE>));
-    posix_memalign(reinterpret_cast<void**>(&data_out), 64, iterations * (1 << LOG_FFT_SIZE) * sizeof(std::complex<HOST_DATA_TYPE>));
+    data = hpcc_base::host_memory::allocate<std::complex<HOST_DATA_TYPE>>(iterations * (1 << logFFTSize));
+    data_out = hpcc_base::host_memory::allocate<std::complex<HOST_DATA_TYPE>>(iterations * (1 << logFFTSize));
 #endif
+    if (realSignals) {
+        // The spectra are only used on the host, so they are never allocated as SVM
+        spectra = hpcc_base::host_memory::allocate<std::complex<HOST_DATA_TYPE>>(iterations * ((1 << logFFTSize) + 2));
+    }
+    if (convolution) {
+        // The filter is copied into the device buffers, so it is never allocated as SVM
+        filter = hpcc_base::host_memory::allocate<std::complex<HOST_DATA_TYPE>>(1 << logFFTSize);
+    }
 }
 
 fft::FFTData::~FFTData() {
@@ -67,9 +110,15 @@ fft::FFTData::~FFTData() {
     clSVMFree(context(), reinterpret_cast<void*>(data));
     clSVMFree(context(), reinterpret_cast<void*>(data_out));
 #else
-    free(data);
-    free(data_out);
+    hpcc_base::host_memory::release(data);
+    hpcc_base::host_memory::release(data_out);
 #endif
+    if (spectra != nullptr) {
+        hpcc_base::host_memory::release(spectra);
+    }
+    if (filter != nullptr) {
+        hpcc_base::host_memory::release(filter);
+    }
 }
 
 fft::FFTBenchmark::FFTBenchmark(int argc, char* argv[]) : HpccFpgaBenchmark(argc, argv) {
@@ -78,23 +127,90 @@ fft::FFTBenchmark::FFTBenchmark(int argc, char* argv[]) : HpccFpgaBenchmark(argc
 
 fft::FFTBenchmark::FFTBenchmark() {}
 
+hpcc_base::suite::BenchmarkResult
+fft::runSuiteBenchmark(int argc, char* argv[]) {
+    return hpcc_base::suite::runBenchmark<fft::FFTBenchmark>(argc, argv);
+}
+
 void
 fft::FFTBenchmark::addAdditionalParseOptions(cxxopts::Options &options) {
     options.add_options()
             ("b", "Number of batched FFT calculations (iterations)",
              cxxopts::value<uint>()->default_value(std::to_string(DEFAULT_ITERATIONS)))
-            ("inverse", "If set, the inverse FFT is calculated instead");
+            ("inverse", "If set, the inverse FFT is calculated instead")
+            ("log-size", "Log2 of the FFT size. Has to be one of the sizes available in the bitstream",
+             cxxopts::value<uint>()->default_value(std::to_string(LOG_FFT_SIZE)))
+            ("dimensions", "Number of dimensions of the FFT. For 2 or 3 dimensions, a single distributed FFT of size (2^log-size)^dimensions is calculated and the batch size is ignored",
+             cxxopts::value<uint>()->default_value("1"))
+            ("real", "If set, every FFT transforms two real signals packed into the real and imaginary part (R2C). Combined with --inverse, two Hermitian spectra are transformed to two real signals (C2R)")
+            ("convolution", "If set, the batch of signals is convolved with a filter by a forward FFT, a multiplication with the filter spectrum and an inverse FFT chained on the device. "\
+             "Requires a bitstream of fft1d_convolution_float_8 and host transfers are included in the measurement")
+            ("stream-chunk", "Number of FFTs per kernel replication in a chunk. If set, the data is streamed in chunks through double buffers and host transfers are included in the measurement",
+             cxxopts::value<uint>()->default_value("0"))
+            ("placement", "Placement of the device buffers in the memory banks if memory interleaving is not used. "\
+             "BUFFER places every buffer of a replication in its own bank, REPLICATION all buffers of a replication in the same bank, "\
+             "STRIPED distributes the buffers of all replications round-robin over the banks and INTERLEAVED does not select a bank",
+             cxxopts::value<std::string>()->default_value("STRIPED"))
+            ("banks", "Number of memory banks the buffers are distributed over by the placement policy",
+             cxxopts::value<uint>()->default_value("4"));
 }
 
 std::unique_ptr<fft::FFTExecutionTimings>
 fft::FFTBenchmark::executeKernel(FFTData &data) {
-    return bm_execution::calculate(*executionSettings, data.data, data.data_out, executionSettings->programSettings->iterations,
+    std::unique_ptr<fft::FFTExecutionTimings> timings;
+    switch (executionSettings->programSettings->communicationType) {
+        case hpcc_base::CommunicationType::cpu_only: timings = bm_execution::cpu::calculate(*executionSettings, data.data, data.data_out, getLocalIterations(),
+                                         executionSettings->programSettings->inverse); break;
+        case hpcc_base::CommunicationType::unsupported:
+            if (executionSettings->programSettings->convolution) {
+                timings = bm_execution::calculateConvolution(*executionSettings, data.data, data.filter, data.data_out, getLocalIterations());
+            }
+            else {
+                timings = bm_execution::calculate(*executionSettings, data.data, data.data_out, getLocalIterations(),
                                          executionSettings->programSettings->inverse);
+            }
+            break;
+        default: throw std::runtime_error("Selected Communication type not supported: " + hpcc_base::commToString(executionSettings->programSettings->communicationType));
+    }
+    if (executionSettings->programSettings->realSignals && !executionSettings->programSettings->inverse) {
+        // Separate the spectra of the two real signals of every FFT. For C2R, the real signals are already
+        // the real and imaginary part of the output
+#ifdef FFT_NATURAL_ORDER_OUTPUT
+        bool bit_reversed = false;
+#else
+        bool bit_reversed = true;
+#endif
+        fft::unpack_real_spectra(data.data_out, data.spectra, getLocalIterations(), executionSettings->programSettings->logFFTSize, bit_reversed);
+    }
+    return timings;
 }
 
 void
 fft::FFTBenchmark::collectAndPrintResults(const fft::FFTExecutionTimings &output) {
-    double gflop = static_cast<double>(5 * (1 << LOG_FFT_SIZE) * LOG_FFT_SIZE) * executionSettings->programSettings->iterations * 1.0e-9 * mpi_comm_size;
+    uint log_size = executionSettings->programSettings->logFFTSize;
+    double gflop = static_cast<double>(5 * (1 << log_size) * log_size) * executionSettings->programSettings->iterations * 1.0e-9 * mpi_comm_size;
+    double ffts_per_execution = executionSettings->programSettings->iterations * executionSettings->programSettings->kernelReplications;
+    uint dimensions = executionSettings->programSettings->dimensions;
+    if (dimensions > 1) {
+        // A single distributed FFT of size n^d is calculated with 5 n^d ld(n^d) FLOP
+        gflop = 5.0 * std::pow(2.0, log_size * dimensions) * log_size * dimensions * 1.0e-9;
+        ffts_per_execution = 1;
+    }
+    if (executionSettings->programSettings->realSignals) {
+        // Every complex FFT transforms two real signals. A real FFT is counted with 2.5 n ld(n) FLOP,
+        // so only the number of FFTs changes
+        ffts_per_execution *= 2;
+    }
+    bool convolution = executionSettings->programSettings->convolution;
+    if (convolution) {
+        // Every convolution consists of a forward and an inverse FFT and a complex multiplication with 6 FLOP per value.
+        // The time per FFT is reported as time per convolution
+        gflop = (2.0 * 5 * (1 << log_size) * log_size + 6.0 * (1 << log_size)) * executionSettings->programSettings->iterations * 1.0e-9 * mpi_comm_size;
+    }
+    // The time includes the transfer of the input and the output over PCIe
+    bool report_host = executionSettings->programSettings->streamChunk > 0 || convolution;
+
+    rawTimings["execution"] = output.timings;
 
     uint number_measurements = output.timings.size();
     std::vector<double> avg_measures(number_measurements);
@@ -110,50 +226,285 @@ fft::FFTBenchmark::collectAndPrintResults(const fft::FFTExecutionTimings &output
         double minTime = *min_element(avg_measures.begin(), avg_measures.end());
         double avgTime = accumulate(avg_measures.begin(), avg_measures.end(), 0.0) / avg_measures.size();
 
+        derivedMetrics["avg time per FFT [s]"] = avgTime / ffts_per_execution;
+        derivedMetrics["best time per FFT [s]"] = minTime / ffts_per_execution;
+        derivedMetrics["avg GFLOPS"] = gflop / avgTime;
+        derivedMetrics["best GFLOPS"] = gflop / minTime;
+        if (report_host) {
+            double gbytes = 2.0 * sizeof(std::complex<HOST_DATA_TYPE>) * (1 << log_size) * executionSettings->programSettings->iterations * mpi_comm_size * 1.0e-9;
+            derivedMetrics["avg host-to-host GB/s"] = gbytes / avgTime;
+            derivedMetrics["best host-to-host GB/s"] = gbytes / minTime;
+        }
+
+        // Every FFT of the batch reads its input from and writes its output to global memory once
+        bool report_memory = dimensions == 1 && !convolution && executionSettings->programSettings->communicationType != hpcc_base::CommunicationType::cpu_only;
+        if (report_memory) {
+            double gbytes = 2.0 * sizeof(std::complex<HOST_DATA_TYPE>) * (1 << log_size) * executionSettings->programSettings->iterations * mpi_comm_size * 1.0e-9;
+            derivedMetrics["avg global memory GB/s"] = gbytes / avgTime;
+            derivedMetrics["best global memory GB/s"] = gbytes / minTime;
+        }
+        if (convolution) {
+            double convolutions = static_cast<double>(executionSettings->programSettings->iterations) * mpi_comm_size;
+            derivedMetrics["avg convolutions/s"] = convolutions / avgTime;
+            derivedMetrics["best convolutions/s"] = convolutions / minTime;
+        }
+
         std::cout << std::setw(ENTRY_SPACE) << " " << std::setw(ENTRY_SPACE) << "avg"
                 << std::setw(ENTRY_SPACE) << "best" << std::endl;
-        std::cout << std::setw(ENTRY_SPACE) << "Time in s:" << std::setw(ENTRY_SPACE) << avgTime / (executionSettings->programSettings->iterations * executionSettings->programSettings->kernelReplications)
-                    << std::setw(ENTRY_SPACE) << minTime / (executionSettings->programSettings->iterations * executionSettings->programSettings->kernelReplications) << std::endl;
+        std::cout << std::setw(ENTRY_SPACE) << "Time in s:" << std::setw(ENTRY_SPACE) << avgTime / ffts_per_execution
+                    << std::setw(ENTRY_SPACE) << minTime / ffts_per_execution << std::endl;
         std::cout << std::setw(ENTRY_SPACE) << "GFLOPS:" << std::setw(ENTRY_SPACE) << gflop / avgTime
                     << std::setw(ENTRY_SPACE) << gflop / minTime << std::endl;
+        if (report_memory) {
+            std::cout << std::setw(ENTRY_SPACE) << "Mem GB/s:" << std::setw(ENTRY_SPACE) << derivedMetrics["avg global memory GB/s"]
+                        << std::setw(ENTRY_SPACE) << derivedMetrics["best global memory GB/s"] << std::endl;
+        }
+        if (convolution) {
+            std::cout << std::setw(ENTRY_SPACE) << "Conv/s:" << std::setw(ENTRY_SPACE) << derivedMetrics["avg convolutions/s"]
+                        << std::setw(ENTRY_SPACE) << derivedMetrics["best convolutions/s"] << std::endl;
+        }
+        if (report_host) {
+            std::cout << std::setw(ENTRY_SPACE) << "Host GB/s:" << std::setw(ENTRY_SPACE) << derivedMetrics["avg host-to-host GB/s"]
+                        << std::setw(ENTRY_SPACE) << derivedMetrics["best host-to-host GB/s"] << std::endl;
+        }
+        printTimingStatistics({{"execution", avg_measures}});
+        printDeviceResults("execution", output.deviceTimings, gflop / mpi_comm_size, "GFLOPS");
+        if (report_memory) {
+            // Every kernel replication processes FFT_UNROLL points per cycle, so a FFT takes 2^log_size / FFT_UNROLL cycles.
+            // The input and output of every FFT are transferred once from and to global memory.
+            hpcc_base::Roofline roofline{mpi_comm_size * executionSettings->programSettings->kernelReplications * getKernelFrequency() * FFT_UNROLL * 5.0 * log_size,
+                                        mpi_comm_size * getMemoryPeak(), 2.0 * sizeof(std::complex<HOST_DATA_TYPE>) / (5.0 * log_size)};
+            printEfficiency({{"execution", {gflop / minTime, roofline}}}, "GFLOPS", 1.0e-9);
+        }
     }
 }
 
+bool
+fft::FFTBenchmark::checkInputParameters() {
+    bool validationResult = true;
+    uint dimensions = executionSettings->programSettings->dimensions;
+    // The CPU implementation supports every FFT size, the FPGA only the sizes that are synthesized into the bitstream
+    std::vector<uint> available_sizes LOG_FFT_SIZES;
+    if (executionSettings->programSettings->communicationType != hpcc_base::CommunicationType::cpu_only &&
+            std::find(available_sizes.begin(), available_sizes.end(), executionSettings->programSettings->logFFTSize) == available_sizes.end()) {
+        std::cerr << "ERROR: FFT size 2^" << executionSettings->programSettings->logFFTSize << " is not available in the bitstream! Available Log2 sizes:";
+        for (auto s : available_sizes) {
+            std::cerr << " " << s;
+        }
+        std::cerr << std::endl;
+        validationResult = false;
+    }
+    if (dimensions < 1 || dimensions > 3) {
+        std::cerr << "ERROR: Only 1D, 2D and 3D FFTs are supported!" << std::endl;
+        validationResult = false;
+    }
+    if (dimensions > 1) {
+#ifdef USE_SVM
+        std::cerr << "ERROR: Multi-dimensional FFTs are not supported with SVM!" << std::endl;
+        validationResult = false;
+#endif
+        if (executionSettings->programSettings->communicationType == hpcc_base::CommunicationType::cpu_only) {
+            std::cerr << "ERROR: Multi-dimensional FFTs are only supported by the FPGA implementation!" << std::endl;
+            validationResult = false;
+        }
+        // The data is distributed in slabs along the first axis
+        if ((1 << executionSettings->programSettings->logFFTSize) % mpi_comm_size != 0) {
+            std::cerr << "ERROR: The FFT size has to be divisible by the number of MPI ranks for multi-dimensional FFTs!" << std::endl;
+            validationResult = false;
+        }
+        else if (getLocalIterations() % executionSettings->programSettings->kernelReplications != 0) {
+            std::cerr << "ERROR: The local slab of " << getLocalIterations() << " rows can not be split between the kernel replications!" << std::endl;
+            validationResult = false;
+        }
+    }
+    if (executionSettings->programSettings->realSignals && dimensions > 1) {
+        std::cerr << "ERROR: Real signals are only supported for 1D FFTs!" << std::endl;
+        validationResult = false;
+    }
+    if (executionSettings->programSettings->convolution) {
+#ifdef USE_SVM
+        std::cerr << "ERROR: Convolution is not supported with SVM!" << std::endl;
+        validationResult = false;
+#endif
+        if (executionSettings->programSettings->communicationType == hpcc_base::CommunicationType::cpu_only) {
+            std::cerr << "ERROR: Convolution is only supported by the FPGA implementation!" << std::endl;
+            validationResult = false;
+        }
+        if (dimensions > 1 || executionSettings->programSettings->realSignals || executionSettings->programSettings->inverse
+                || executionSettings->programSettings->streamChunk > 0) {
+            std::cerr << "ERROR: Convolution can not be combined with multi-dimensional FFTs, real signals, the inverse FFT or streaming!" << std::endl;
+            validationResult = false;
+        }
+    }
+    uint stream_chunk = executionSettings->programSettings->streamChunk;
+    if (stream_chunk > 0) {
+#ifdef USE_SVM
+        std::cerr << "ERROR: Streaming is not supported with SVM!" << std::endl;
+        validationResult = false;
+#endif
+        if (executionSettings->programSettings->communicationType == hpcc_base::CommunicationType::cpu_only) {
+            std::cerr << "ERROR: Streaming is only supported by the FPGA implementation!" << std::endl;
+            validationResult = false;
+        }
+        if (dimensions > 1) {
+            std::cerr << "ERROR: Streaming is not supported for multi-dimensional FFTs!" << std::endl;
+            validationResult = false;
+        }
+        else if ((executionSettings->programSettings->iterations / executionSettings->programSettings->kernelReplications) % stream_chunk != 0) {
+            std::cerr << "ERROR: The " << executionSettings->programSettings->iterations / executionSettings->programSettings->kernelReplications
+                      << " FFTs per kernel replication can not be split into chunks of " << stream_chunk << " FFTs!" << std::endl;
+            validationResult = false;
+        }
+    }
+    return validationResult;
+}
+
+bool
+fft::FFTBenchmark::setAutomaticSize(hpcc_base::MemoryLimits const& limits) {
+    auto& settings = *executionSettings->programSettings;
+    if (settings.dimensions != 1 || settings.streamChunk > 0 || settings.convolution
+            || settings.communicationType == hpcc_base::CommunicationType::cpu_only) {
+        return false;
+    }
+    double fft_bytes = static_cast<double>(1 << settings.logFFTSize) * sizeof(std::complex<HOST_DATA_TYPE>);
+    // Every replication uses an input and an output buffer for its part of the batch
+    double max_iterations = std::min(limits.totalMemory / (2.0 * fft_bytes),
+                                settings.kernelReplications * limits.maxBufferSize / fft_bytes);
+    // The buffer sizes are calculated with 32 bit integers
+    max_iterations = std::min(max_iterations, static_cast<double>(std::numeric_limits<uint>::max() >> settings.logFFTSize));
+    uint64_t iterations = hpcc_base::largestMultiple(max_iterations, settings.kernelReplications);
+    if (iterations == 0) {
+        return false;
+    }
+    settings.iterations = static_cast<uint>(iterations);
+    return true;
+}
+
+uint
+fft::FFTBenchmark::getLocalIterations() {
+    uint dimensions = executionSettings->programSettings->dimensions;
+    if (dimensions <= 1) {
+        return executionSettings->programSettings->iterations;
+    }
+    // Every rank holds a slab of n / ranks planes of the first axis. Every row of a plane is a 1D FFT
+    return (static_cast<size_t>(1) << (executionSettings->programSettings->logFFTSize * (dimensions - 1))) / mpi_comm_size;
+}
+
 std::unique_ptr<fft::FFTData>
 fft::FFTBenchmark::generateInputData() {
-    auto d = std::unique_ptr<fft::FFTData>(new fft::FFTData(*executionSettings->context, executionSettings->programSettings->iterations));
+    auto d = std::unique_ptr<fft::FFTData>(new fft::FFTData(*executionSettings->context, getLocalIterations(),
+                                                                    executionSettings->programSettings->logFFTSize,
+                                                                    executionSettings->programSettings->realSignals,
+                                                                    executionSettings->programSettings->convolution);
     std::mt19937 gen(0);
     auto dis = std::uniform_real_distribution<HOST_DATA_TYPE>(-1.0, 1.0);
-    for (int i=0; i< executionSettings->programSettings->iterations * (1 << LOG_FFT_SIZE); i++) {
+    for (size_t i=0; i< static_cast<size_t>(getLocalIterations()) * (1 << executionSettings->programSettings->logFFTSize); i++) {
         d->data[i].real(dis(gen));
         d->data[i].imag(dis(gen));
         d->data_out[i].real(0.0);
         d->data_out[i].imag(0.0);
     }
+    if (executionSettings->programSettings->realSignals) {
+        // For R2C, the random real and imaginary parts are the two real signals.
+        // For C2R, random Hermitian spectra are generated and packed into the input
+        const size_t half = (1 << (executionSettings->programSettings->logFFTSize - 1)) + 1;
+        for (size_t i=0; i < 2 * static_cast<size_t>(getLocalIterations()) * half; i++) {
+            d->spectra[i] = std::complex<HOST_DATA_TYPE>(0.0, 0.0);
+            if (executionSettings->programSettings->inverse) {
+                // The first and the last bin of a real signal's spectrum are real
+                bool real_bin = (i % half == 0) || (i % half == half - 1);
+                d->spectra[i] = std::complex<HOST_DATA_TYPE>(dis(gen), real_bin ? 0.0 : dis(gen));
+            }
+        }
+        if (executionSettings->programSettings->inverse) {
+            fft::pack_real_spectra(d->spectra, d->data, getLocalIterations(), executionSettings->programSettings->logFFTSize);
+        }
+    }
+    if (executionSettings->programSettings->convolution) {
+        for (size_t i=0; i < (static_cast<size_t>(1) << executionSettings->programSettings->logFFTSize); i++) {
+            d->filter[i] = std::complex<HOST_DATA_TYPE>(dis(gen), dis(gen));
+        }
+    }
     return d;
 }
 
 bool  
 fft::FFTBenchmark::validateOutputAndPrintError(fft::FFTData &data) {
+    const uint log_size = executionSettings->programSettings->logFFTSize;
     double residual_max = 0;
-    for (int i = 0; i < executionSettings->programSettings->iterations; i++) {
-        // we have to bit reverse the output data of the FPGA kernel, since it will be provided in bit-reversed order.
+    std::vector<size_t> checked_batches;
+    if (executionSettings->programSettings->validationMode == hpcc_base::ValidationMode::sampled) {
+        // Only spot-check randomly selected FFTs
+        checked_batches = hpcc_base::validation::sampleIndices(executionSettings->programSettings->validationErrorBound,
+                                                                executionSettings->programSettings->iterations, mpi_comm_rank);
+        // Remove duplicates, since the bit reversal is done in place
+        std::sort(checked_batches.begin(), checked_batches.end());
+        checked_batches.erase(std::unique(checked_batches.begin(), checked_batches.end()), checked_batches.end());
+    }
+    else {
+        for (size_t i = 0; i < executionSettings->programSettings->iterations; i++) {
+            checked_batches.push_back(i);
+        }
+    }
+    uint dimensions = executionSettings->programSettings->dimensions;
+    if (dimensions > 1) {
+        // The multi-dimensional FFT is reverted on the host with the same passes and axis rotations that are used
+        // by the FPGA implementation. This requires the whole distributed data, so sampling is not possible.
+        checked_batches.clear();
+        size_t local_size = static_cast<size_t>(getLocalIterations()) << log_size;
+        std::vector<std::complex<HOST_DATA_TYPE>> rotated(local_size);
+        for (uint d = 0; d < dimensions; d++) {
+            fft::output_to_natural_order(data.data_out, getLocalIterations(), log_size);
+            fft::fourier_transform_gold(!executionSettings->programSettings->inverse, log_size, data.data_out, getLocalIterations());
+            fft::rotate_axes(data.data_out, rotated.data(), log_size, dimensions);
+            std::copy(rotated.begin(), rotated.end(), data.data_out);
+        }
+        double normalization = std::pow(2.0, log_size * dimensions);
+        for (size_t j = 0; j < local_size; j++) {
+            double tmp_error =  std::abs(std::complex<double>(data.data[j]) - std::complex<double>(data.data_out[j]) / normalization);
+            residual_max = residual_max > tmp_error ? residual_max : tmp_error;
+        }
+    }
+    // The FFTs are checked in parallel. The reference FFT of a single batch is then calculated by a single thread.
+    #pragma omp parallel for reduction(max:residual_max)
+    for (int b = 0; b < static_cast<int>(checked_batches.size()); b++) {
+        size_t i = checked_batches[b];
+        if (executionSettings->programSettings->convolution) {
+            // Compare with the reference convolution. Both are not normalized by the inverse FFT
+            fft::output_to_natural_order(&data.data_out[i * (1 << log_size)], 1, log_size);
+            std::vector<std::complex<HOST_DATA_TYPE>> reference(&data.data[i * (1 << log_size)], &data.data[(i + 1) * (1 << log_size)]);
+            fft::convolution_gold(log_size, reference.data(), data.filter);
+            for (int j = 0; j < (1 << log_size); j++) {
+                double tmp_error = std::abs(data.data_out[i * (1 << log_size) + j] - reference[j]) / (1 << log_size);
+                residual_max = residual_max > tmp_error ? residual_max : tmp_error;
+            }
+            continue;
+        }
+        // we have to bit reverse the output data of the FPGA kernel, if it is provided in bit-reversed order.
         // Directly applying iFFT on the data would thus not form the identity function we want to have for verification.
-        // TODO: This might need to be changed for other FPGA implementations that return the data in correct order
-        fft::bit_reverse(&data.data_out[i * (1 << LOG_FFT_SIZE)], 1);
-        fft::fourier_transform_gold(true, LOG_FFT_SIZE, &data.data_out[i * (1 << LOG_FFT_SIZE)]);
+        if (executionSettings->programSettings->realSignals && !executionSettings->programSettings->inverse) {
+            // Validate the unpacked spectra of the real signals by packing them again in natural order
+            fft::pack_real_spectra(&data.spectra[i * ((1 << log_size) + 2)], &data.data_out[i * (1 << log_size)], 1, log_size);
+        }
+        else {
+            fft::output_to_natural_order(&data.data_out[i * (1 << log_size)], 1, log_size);
+        }
+        // Applying the transform of the other direction and normalizing forms the identity function
+        fft::fourier_transform_gold(!executionSettings->programSettings->inverse, log_size, &data.data_out[i * (1 << log_size)]);
 
         // Normalize the data after applying iFFT
-        for (int j = 0; j < (1 << LOG_FFT_SIZE); j++) {
-            data.data_out[i * (1 << LOG_FFT_SIZE) + j] /= (1 << LOG_FFT_SIZE);
+        for (int j = 0; j < (1 << log_size); j++) {
+            data.data_out[i * (1 << log_size) + j] /= (1 << log_size);
         }
-        for (int j = 0; j < (1 << LOG_FFT_SIZE); j++) {
-            double tmp_error =  std::abs(data.data[i * (1 << LOG_FFT_SIZE) + j] - data.data_out[i * (1 << LOG_FFT_SIZE) + j]);
+        for (int j = 0; j < (1 << log_size); j++) {
+            double tmp_error =  std::abs(data.data[i * (1 << log_size) + j] - data.data_out[i * (1 << log_size) + j]);
             residual_max = residual_max > tmp_error ? residual_max : tmp_error;
         }
     }
+    // A convolution consists of two FFTs
+    uint transforms = executionSettings->programSettings->convolution ? 2 : dimensions;
     double error = residual_max /
-                   (std::numeric_limits<HOST_DATA_TYPE>::epsilon() * LOG_FFT_SIZE);
+                   (std::numeric_limits<HOST_DATA_TYPE>::epsilon() * log_size * transforms);
 
     std::cout << std::setw(ENTRY_SPACE) << "res. error" << std::setw(ENTRY_SPACE) << "mach. eps" << std::endl;
     std::cout << std::setw(ENTRY_SPACE) << error << std::setw(ENTRY_SPACE)
@@ -163,111 +514,310 @@ fft::FFTBenchmark::validateOutputAndPrintError(fft::FFTData &data) {
     return error < 1.0;
 }
 
-void 
-fft::bit_reverse(std::complex<HOST_DATA_TYPE> *data, unsigned iterations) {
-    auto *tmp = new std::complex<HOST_DATA_TYPE>[(1 << LOG_FFT_SIZE)];
-    for (int k=0; k < iterations; k++) {
-        for (int i = 0; i < (1 << LOG_FFT_SIZE); i++) {
-            int fwd = i;
-            int bit_rev = 0;
-            for (int j = 0; j < LOG_FFT_SIZE; j++) {
-                bit_rev <<= 1;
-                bit_rev |= fwd & 1;
-                fwd >>= 1;
+void
+fft::rotate_axes(std::complex<HOST_DATA_TYPE> const* in, std::complex<HOST_DATA_TYPE>* out, unsigned logFFTSize, unsigned dimensions) {
+    int num_ranks = 1;
+#ifdef _USE_MPI_
+    MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+#endif
+    const size_t n = static_cast<size_t>(1) << logFFTSize;
+    // Length of the local slab along the first axis and the size of the axes between the first and last axis
+    const size_t slab = n / num_ranks;
+    const size_t middle = static_cast<size_t>(1) << (logFFTSize * (dimensions - 2));
+    // Number of elements that are sent to every rank
+    const size_t chunk = slab * middle * slab;
+
+    // Pack the parts of the last axis that belong to the same rank after the rotation
+    std::vector<std::complex<HOST_DATA_TYPE>> send_buffer(chunk * num_ranks);
+    #pragma omp parallel for
+    for (int row = 0; row < static_cast<int>(slab * middle); row++) {
+        for (size_t q = 0; q < static_cast<size_t>(num_ranks); q++) {
+            for (size_t k = 0; k < slab; k++) {
+                send_buffer[q * chunk + row * slab + k] = in[row * n + q * slab + k];
             }
-            tmp[i] = data[bit_rev];
         }
-        for (int i = 0; i < (1 << LOG_FFT_SIZE); i++) {
-            data[k * (1 << LOG_FFT_SIZE) + i] = tmp[i];
+    }
+#ifdef _USE_MPI_
+    static_assert(sizeof(HOST_DATA_TYPE) == sizeof(float), "The global transpose sends the data as MPI_FLOAT");
+    std::vector<std::complex<HOST_DATA_TYPE>> recv_buffer(chunk * num_ranks);
+    MPI_Alltoall(send_buffer.data(), 2 * chunk, MPI_FLOAT, recv_buffer.data(), 2 * chunk, MPI_FLOAT, MPI_COMM_WORLD);
+#else
+    std::vector<std::complex<HOST_DATA_TYPE>>& recv_buffer = send_buffer;
+#endif
+    // The chunk of rank p contains the rows p * slab to (p + 1) * slab of the first axis
+    #pragma omp parallel for
+    for (int k = 0; k < static_cast<int>(slab); k++) {
+        for (size_t p = 0; p < static_cast<size_t>(num_ranks); p++) {
+            for (size_t row = 0; row < slab * middle; row++) {
+                out[(k * n + p * slab) * middle + row] = recv_buffer[p * chunk + row * slab + k];
+            }
         }
     }
-    delete [] tmp;
 }
 
-// The function definitions and implementations below this comment are taken from the
-// FFT1D example implementation of the Intel FPGA SDK for OpenCL 19.4
-// They are licensed under the following conditions:
-//
-// Copyright (C) 2013-2019 Altera Corporation, San Jose, California, USA. All rights reserved.
-// Permission is hereby granted, free of charge, to any person obtaining a copy of this
-// software and associated documentation files (the "Software"), to deal in the Software
-// without restriction, including without limitation the rights to use, copy, modify, merge,
-// publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to
-// whom the Software is furnished to do so, subject to the following conditions:
-// The above copyright notice and this permission notice shall be included in all copies or
-// substantial portions of the Software.
-//
-// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
-// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
-// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
-// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
-// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
-// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
-// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
-// OTHER DEALINGS IN THE SOFTWARE.
-//
-// This agreement shall be governed in all respects by the laws of the State of California and
-// by the laws of the United States of America.
-
+namespace {
+
+/**
+ * @brief Precomputed tables that are shared between all reference FFTs of the same size
+ * 
+ */
+struct ReferenceTables {
+
+    /**
+     * @brief Twiddle factors exp(-2 pi i m / n) for m in [0, n)
+     * 
+     */
+    std::vector<std::complex<double>> twiddles;
+
+    /**
+     * @brief The bit-reversed index for every index of the FFT
+     * 
+     */
+    std::vector<unsigned> bitReversal;
+
+#ifdef _USE_FFTW_REFERENCE_
+    /**
+     * @brief FFTW plans for the forward and inverse FFT that can be executed on new arrays
+     * 
+     */
+    fftw_plan forwardPlan;
+    fftw_plan inversePlan;
+#endif
+};
+
+/**
+ * @brief Get the reference tables for the given FFT size. The tables are created with the first call for a size.
+ *          This function is thread-safe.
+ * 
+ * @param logFFTSize Log2 of the FFT size
+ * @return ReferenceTables const& The tables for the FFT size
+ */
+ReferenceTables const&
+getReferenceTables(unsigned logFFTSize) {
+    static std::mutex tables_mutex;
+    static std::map<unsigned, std::unique_ptr<ReferenceTables>> tables;
+    std::lock_guard<std::mutex> lock(tables_mutex);
+    std::unique_ptr<ReferenceTables>& t = tables[logFFTSize];
+    if (!t) {
+        const size_t n = static_cast<size_t>(1) << logFFTSize;
+        t = std::unique_ptr<ReferenceTables>(new ReferenceTables());
+        t->twiddles.resize(n);
+        t->bitReversal.resize(n);
+        for (size_t m = 0; m < n; m++) {
+            double angle = -2.0 * M_PI * m / n;
+            t->twiddles[m] = std::complex<double>(std::cos(angle), std::sin(angle));
+            unsigned fwd = m;
+            unsigned bit_rev = 0;
+            for (unsigned j = 0; j < logFFTSize; j++) {
+                bit_rev = (bit_rev << 1) | (fwd & 1);
+                fwd >>= 1;
+            }
+            t->bitReversal[m] = bit_rev;
+        }
+#ifdef _USE_FFTW_REFERENCE_
+        std::vector<fftw_complex> scratch(n);
+        t->forwardPlan = fftw_plan_dft_1d(n, scratch.data(), scratch.data(), FFTW_FORWARD, FFTW_ESTIMATE | FFTW_UNALIGNED);
+        t->inversePlan = fftw_plan_dft_1d(n, scratch.data(), scratch.data(), FFTW_BACKWARD, FFTW_ESTIMATE | FFTW_UNALIGNED);
+#endif
+    }
+    return *t;
+}
 
-void 
-fft::fourier_transform_gold(bool inverse, const int lognr_points, std::complex<HOST_DATA_TYPE> *data_sp) {
-    const int nr_points = 1 << lognr_points;
+/**
+ * @brief Calculate a single FFT in place with an iterative radix-4 decimation in time.
+ *          A radix-2 stage is used first if the Log2 of the FFT size is odd.
+ * 
+ * @param inverse if true, the inverse FFT is calculated
+ * @param logFFTSize Log2 of the FFT size
+ * @param tables The precomputed tables for the FFT size
+ * @param data The input data in bit-reversed order. Will contain the result in natural order.
+ */
+void
+iterativeFFT(bool inverse, unsigned logFFTSize, ReferenceTables const& tables, std::complex<double>* data) {
+    const size_t n = static_cast<size_t>(1) << logFFTSize;
+    size_t length = 1;
+    if (logFFTSize & 1) {
+        for (size_t i = 0; i < n; i += 2) {
+            std::complex<double> a = data[i];
+            std::complex<double> b = data[i + 1];
+            data[i] = a + b;
+            data[i + 1] = a - b;
+        }
+        length = 2;
+    }
+    // Multiplication with -i for the FFT and i for the iFFT
+    const std::complex<double> rot(0.0, inverse ? 1.0 : -1.0);
+    for (length *= 4; length <= n; length *= 4) {
+        const size_t quarter = length / 4;
+        const size_t stride = n / length;
+        for (size_t start = 0; start < n; start += length) {
+            for (size_t k = 0; k < quarter; k++) {
+                std::complex<double> w1 = tables.twiddles[k * stride];
+                std::complex<double> w2 = tables.twiddles[2 * k * stride];
+                std::complex<double> w3 = tables.twiddles[3 * k * stride];
+                if (inverse) {
+                    w1 = std::conj(w1);
+                    w2 = std::conj(w2);
+                    w3 = std::conj(w3);
+                }
+                // Because of the bit-reversed input order, the second quarter contains the sub-FFT of the
+                // elements 4j+2 and the third quarter the sub-FFT of the elements 4j+1
+                std::complex<double> t0 = data[start + k];
+                std::complex<double> t2 = w2 * data[start + quarter + k];
+                std::complex<double> t1 = w1 * data[start + 2 * quarter + k];
+                std::complex<double> t3 = w3 * data[start + 3 * quarter + k];
+                std::complex<double> s02 = t0 + t2;
+                std::complex<double> d02 = t0 - t2;
+                std::complex<double> s13 = t1 + t3;
+                std::complex<double> d13 = rot * (t1 - t3);
+                data[start + k] = s02 + s13;
+                data[start + quarter + k] = d02 + d13;
+                data[start + 2 * quarter + k] = s02 - s13;
+                data[start + 3 * quarter + k] = d02 - d13;
+            }
+        }
+    }
+}
 
-    auto *data = new std::complex<double>[nr_points];
+}  // namespace
 
-    for (int i=0; i < nr_points; i++) {
-        data[i] = data_sp[i];
+void 
+fft::bit_reverse(std::complex<HOST_DATA_TYPE> *data, unsigned iterations, unsigned logFFTSize) {
+    const size_t n = static_cast<size_t>(1) << logFFTSize;
+    ReferenceTables const& tables = getReferenceTables(logFFTSize);
+    #pragma omp parallel
+    {
+        std::vector<std::complex<HOST_DATA_TYPE>> tmp(n);
+        #pragma omp for
+        for (int k = 0; k < static_cast<int>(iterations); k++) {
+            std::complex<HOST_DATA_TYPE>* fft_data = &data[k * n];
+            for (size_t i = 0; i < n; i++) {
+                tmp[i] = fft_data[tables.bitReversal[i]];
+            }
+            std::copy(tmp.begin(), tmp.end(), fft_data);
+        }
     }
+}
 
-    // The inverse requires swapping the real and imaginary component
+void
+fft::output_to_natural_order(std::complex<HOST_DATA_TYPE> *data, unsigned iterations, unsigned logFFTSize) {
+#ifndef FFT_NATURAL_ORDER_OUTPUT
+    fft::bit_reverse(data, iterations, logFFTSize);
+#endif
+}
 
-    if (inverse) {
-        for (int i = 0; i < nr_points; i++) {
-            double tmp = data[i].imag();
-            data[i].imag(data[i].real());
-            data[i].real(tmp);
+void
+fft::unpack_real_spectra(std::complex<HOST_DATA_TYPE> const* packed, std::complex<HOST_DATA_TYPE>* spectra, unsigned iterations, unsigned logFFTSize,
+                            bool bitReversed) {
+    const size_t n = static_cast<size_t>(1) << logFFTSize;
+    const size_t half = n / 2 + 1;
+    ReferenceTables const& tables = getReferenceTables(logFFTSize);
+    #pragma omp parallel for
+    for (int i = 0; i < static_cast<int>(iterations); i++) {
+        std::complex<HOST_DATA_TYPE> const* z = &packed[i * n];
+        std::complex<HOST_DATA_TYPE>* x = &spectra[i * 2 * half];
+        std::complex<HOST_DATA_TYPE>* y = &spectra[i * 2 * half + half];
+        for (size_t k = 0; k < half; k++) {
+            size_t nk = (n - k) % n;
+            std::complex<HOST_DATA_TYPE> zk = z[bitReversed ? tables.bitReversal[k] : k];
+            std::complex<HOST_DATA_TYPE> znk = std::conj(z[bitReversed ? tables.bitReversal[nk] : nk]);
+            x[k] = static_cast<HOST_DATA_TYPE>(0.5) * (zk + znk);
+            // Division by 2i
+            y[k] = std::complex<HOST_DATA_TYPE>(0.0, -0.5) * (zk - znk);
         }
     }
-    // Do a FT recursively
-    fft::fourier_stage(lognr_points, data);
+}
 
-    // The inverse requires swapping the real and imaginary component
-    if (inverse) {
-        for (int i = 0; i < nr_points; i++) {
-            double tmp = data[i].real();
-            data[i].real(data[i].imag());
-            data[i].imag(tmp);
+void
+fft::pack_real_spectra(std::complex<HOST_DATA_TYPE> const* spectra, std::complex<HOST_DATA_TYPE>* packed, unsigned iterations, unsigned logFFTSize) {
+    const size_t n = static_cast<size_t>(1) << logFFTSize;
+    const size_t half = n / 2 + 1;
+    const std::complex<HOST_DATA_TYPE> imag_unit(0.0, 1.0);
+    #pragma omp parallel for
+    for (int i = 0; i < static_cast<int>(iterations); i++) {
+        std::complex<HOST_DATA_TYPE> const* x = &spectra[i * 2 * half];
+        std::complex<HOST_DATA_TYPE> const* y = &spectra[i * 2 * half + half];
+        for (size_t k = 0; k < n; k++) {
+            // The upper half of the spectrum of a real signal is the conjugate of the lower half
+            std::complex<HOST_DATA_TYPE> xk = (k < half) ? x[k] : std::conj(x[n - k]);
+            std::complex<HOST_DATA_TYPE> yk = (k < half) ? y[k] : std::conj(y[n - k]);
+            packed[i * n + k] = xk + imag_unit * yk;
         }
     }
+}
 
-    // Do the bit reversal
-    for (int i = 0; i < nr_points; i++) {
-        data_sp[i] = data[i];
+void 
+fft::fourier_transform_gold(bool inverse, const int lognr_points, std::complex<HOST_DATA_TYPE> *data_sp, unsigned iterations) {
+    const size_t nr_points = static_cast<size_t>(1) << lognr_points;
+    ReferenceTables const& tables = getReferenceTables(lognr_points);
+
+    #pragma omp parallel
+    {
+        // The FFT is calculated in double precision to get an accurate reference
+        std::vector<std::complex<double>> data(nr_points);
+        #pragma omp for
+        for (int k = 0; k < static_cast<int>(iterations); k++) {
+            std::complex<HOST_DATA_TYPE>* fft_data = &data_sp[k * nr_points];
+#ifdef _USE_FFTW_REFERENCE_
+            for (size_t i = 0; i < nr_points; i++) {
+                data[i] = fft_data[i];
+            }
+            fftw_execute_dft(inverse ? tables.inversePlan : tables.forwardPlan, reinterpret_cast<fftw_complex*>(data.data()),
+                                reinterpret_cast<fftw_complex*>(data.data()));
+#else
+            for (size_t i = 0; i < nr_points; i++) {
+                data[i] = fft_data[tables.bitReversal[i]];
+            }
+            iterativeFFT(inverse, lognr_points, tables, data.data());
+#endif
+            for (size_t i = 0; i < nr_points; i++) {
+                fft_data[i] = data[i];
+            }
+        }
     }
-
-    delete [] data;
 }
 
-void 
-fft::fourier_stage(int lognr_points, std::complex<double> *data) {
-    int nr_points = 1 << lognr_points;
-    if (nr_points == 1) return;
-    auto *half1 = new std::complex<double>[nr_points / 2];
-    auto *half2 = new std::complex<double>[nr_points / 2];
-    for (int i = 0; i < nr_points / 2; i++) {
-        half1[i] = data[2 * i];
-        half2[i] = data[2 * i + 1];
-    }
-    fourier_stage(lognr_points - 1, half1);
-    fourier_stage(lognr_points - 1, half2);
-    for (int i = 0; i < nr_points / 2; i++) {
-        data[i].real(half1[i].real() + cos (2 * M_PI * i / nr_points) * half2[i].real() + sin (2 * M_PI * i / nr_points) * half2[i].imag());
-        data[i].imag(half1[i].imag() - sin (2 * M_PI * i / nr_points) * half2[i].real() + cos (2 * M_PI * i / nr_points) * half2[i].imag());
-        data[i + nr_points / 2].real(half1[i].real() - cos (2 * M_PI * i / nr_points) * half2[i].real() - sin (2 * M_PI * i / nr_points) * half2[i].imag());
-        data[i + nr_points / 2].imag(half1[i].imag() + sin (2 * M_PI * i / nr_points) * half2[i].real() - cos (2 * M_PI * i / nr_points) * half2[i].imag());
-    }
-
-    delete [] half1;
-    delete [] half2;
+void
+fft::convolution_gold(const int lognr_points, std::complex<HOST_DATA_TYPE> *data_sp, std::complex<HOST_DATA_TYPE> const* filter, unsigned iterations) {
+    const size_t nr_points = static_cast<size_t>(1) << lognr_points;
+    ReferenceTables const& tables = getReferenceTables(lognr_points);
+
+    #pragma omp parallel
+    {
+        // The spectra are kept in double precision between the two FFTs
+        std::vector<std::complex<double>> data(nr_points);
+#ifndef _USE_FFTW_REFERENCE_
+        std::vector<std::complex<double>> spectrum(nr_points);
+#endif
+        #pragma omp for
+        for (int k = 0; k < static_cast<int>(iterations); k++) {
+            std::complex<HOST_DATA_TYPE>* fft_data = &data_sp[k * nr_points];
+#ifdef _USE_FFTW_REFERENCE_
+            for (size_t i = 0; i < nr_points; i++) {
+                data[i] = fft_data[i];
+            }
+            // The plans are created for in-place transforms
+            fftw_execute_dft(tables.forwardPlan, reinterpret_cast<fftw_complex*>(data.data()),
+                                reinterpret_cast<fftw_complex*>(data.data()));
+            for (size_t i = 0; i < nr_points; i++) {
+                data[i] *= std::complex<double>(filter[i]);
+            }
+            fftw_execute_dft(tables.inversePlan, reinterpret_cast<fftw_complex*>(data.data()),
+                                reinterpret_cast<fftw_complex*>(data.data()));
+#else
+            for (size_t i = 0; i < nr_points; i++) {
+                spectrum[i] = fft_data[tables.bitReversal[i]];
+            }
+            iterativeFFT(false, lognr_points, tables, spectrum.data());
+            // The iterative FFT expects its input in bit-reversed order
+            for (size_t i = 0; i < nr_points; i++) {
+                data[i] = spectrum[tables.bitReversal[i]] * std::complex<double>(filter[tables.bitReversal[i]]);
+            }
+            iterativeFFT(true, lognr_points, tables, data.data());
+#endif
+            for (size_t i = 0; i < nr_points; i++) {
+                fft_data[i] = data[i];
+            }
+        }
+    }
 }
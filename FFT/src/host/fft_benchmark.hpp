@@ -29,6 +29,7 @@ SOFTWARE.
 
 /* Project's headers */
 #include "hpcc_benchmark.hpp"
+#include "memory_placement.hpp"
 #include "parameters.h"
 
 /**
@@ -61,6 +62,52 @@ public:
      */
     uint kernelReplications;
 
+    /**
+     * @brief Log2 of the used FFT size. Has to be one of the sizes in LOG_FFT_SIZES for the FPGA kernels
+     * 
+     */
+    uint logFFTSize;
+
+    /**
+     * @brief Number of dimensions of the FFT. For more than one dimension a single distributed
+     *          multi-dimensional FFT of size (2^logFFTSize)^dimensions is calculated instead of a batch of 1D FFTs
+     * 
+     */
+    uint dimensions;
+
+    /**
+     * @brief Number of FFTs per kernel replication that are transferred and calculated at once in streaming mode.
+     *          If 0, the whole input is written to the device before the measurement and streaming is disabled
+     * 
+     */
+    uint streamChunk;
+
+    /**
+     * @brief If true, every complex FFT transforms two real signals that are packed into the real and imaginary part (R2C).
+     *          With inverse, two Hermitian spectra are packed into a single complex spectrum and transformed to two real signals (C2R)
+     * 
+     */
+    bool realSignals;
+
+    /**
+     * @brief If true, the signals are convolved with a filter by a forward FFT, a multiplication with the filter spectrum
+     *          and an inverse FFT that are chained on the device. Requires the kernels of fft1d_convolution_float_8.cl
+     * 
+     */
+    bool convolution;
+
+    /**
+     * @brief Placement policy for the device buffers of the kernel replications
+     * 
+     */
+    hpcc_base::memory_placement::Policy memoryPlacement;
+
+    /**
+     * @brief Number of memory banks the buffers are distributed over by the placement policy
+     * 
+     */
+    uint memoryBanks;
+
     /**
      * @brief Construct a new FFT Program Settings object
      * 
@@ -97,6 +144,20 @@ public:
      */
     std::complex<HOST_DATA_TYPE>* data_out;
 
+    /**
+     * @brief The half spectra with 2^(logFFTSize - 1) + 1 bins of the two real signals of every FFT for R2C and C2R.
+     *          They are the output of the R2C and the input of the C2R transform. nullptr if real signals are not used.
+     * 
+     */
+    std::complex<HOST_DATA_TYPE>* spectra;
+
+    /**
+     * @brief The filter spectrum with 2^logFFTSize bins in natural order that is used for all signals in convolution mode.
+     *          nullptr if the convolution is not used.
+     * 
+     */
+    std::complex<HOST_DATA_TYPE>* filter;
+
     /**
      * @brief The context that is used to allocate memory in SVM mode
      * 
@@ -108,8 +169,11 @@ public:
      * 
      * @param context The OpenCL context used to allocate memory in SVM mode
      * @param iterations Number of FFT data that will be stored sequentially in the array
+     * @param logFFTSize Log2 of the FFT size
+     * @param realSignals If true, the array for the half spectra of the real signals is allocated
+     * @param convolution If true, the array for the filter spectrum is allocated
      */
-    FFTData(cl::Context context, uint iterations);
+    FFTData(cl::Context context, uint iterations, uint logFFTSize, bool realSignals = false, bool convolution = false);
 
     /**
      * @brief Destroy the FFT Data object. Free the allocated memory
@@ -131,6 +195,12 @@ public:
      */
     std::vector<double> timings;
 
+    /**
+     * @brief The timings of all repetitions for every device used by the rank
+     * 
+     */
+    std::vector<std::vector<double>> deviceTimings;
+
 };
 
 /**
@@ -186,6 +256,33 @@ public:
     void
     collectAndPrintResults(const FFTExecutionTimings &output) override;
 
+    /**
+     * @brief Check if the selected FFT size is available in the bitstream
+     * 
+     * @return true if the validation is successful, false otherwise
+     */
+    bool
+    checkInputParameters() override;
+
+    /**
+     * @brief Select the largest batch size for 1D FFTs that fits into the device memory.
+     *          The size of the FFT is fixed by the bitstream, so only the batch size is changed.
+     * 
+     * @param limits The memory limits of the device
+     * @return true if a valid batch size was found, false for all other FFT types
+     */
+    bool
+    setAutomaticSize(hpcc_base::MemoryLimits const& limits) override;
+
+    /**
+     * @brief Get the number of 1D FFTs that are calculated by this rank in a single pass.
+     *          This is the batch size for 1D FFTs or the number of rows in the local slab for multi-dimensional FFTs
+     * 
+     * @return uint number of 1D FFTs per pass
+     */
+    uint
+    getLocalIterations();
+
     /**
      * @brief Construct a new FFT Benchmark object
      * 
@@ -202,55 +299,84 @@ public:
 };
 
 /**
- * Bit reverses the order of the given FFT data in place
+ * Bit reverses the order of the given FFT data in place using a precomputed lookup table.
+ * The FFTs are processed in parallel with OpenMP.
  *
  * @param data Array of complex numbers that will be sorted in bit reversed order
  * @param iterations Length of the data array will be calculated with iterations * FFT Size
+ * @param logFFTSize Log2 of the FFT size
  */
-void bit_reverse(std::complex<HOST_DATA_TYPE> *data, unsigned iterations);
-
-// The function definitions and implementations below this comment are taken from the
-// FFT1D example implementation of the Intel FPGA SDK for OpenCL 19.4
-// They are licensed under the following conditions:
-//
-// Copyright (C) 2013-2019 Altera Corporation, San Jose, California, USA. All rights reserved.
-// Permission is hereby granted, free of charge, to any person obtaining a copy of this
-// software and associated documentation files (the "Software"), to deal in the Software
-// without restriction, including without limitation the rights to use, copy, modify, merge,
-// publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to
-// whom the Software is furnished to do so, subject to the following conditions:
-// The above copyright notice and this permission notice shall be included in all copies or
-// substantial portions of the Software.
-//
-// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
-// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
-// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
-// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
-// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
-// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
-// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
-// OTHER DEALINGS IN THE SOFTWARE.
-//
-// This agreement shall be governed in all respects by the laws of the State of California and
-// by the laws of the United States of America.
+void bit_reverse(std::complex<HOST_DATA_TYPE> *data, unsigned iterations, unsigned logFFTSize = LOG_FFT_SIZE);
 
 /**
- * @brief Do a FFT with a reference implementation on the CPU
- * 
- * @param inverse if false, the FFT will be calculated, else the iFFT
- * @param lognr_points The log2 of the FFT size that should be calculated 
- * @param data The input data for the FFT
+ * Bring the output of the FFT kernels into natural order. The data is bit reversed in place, if the kernels
+ * write their output in bit-reversed order. Nothing is done if the output is already reordered by the kernels
+ * (FFT_NATURAL_ORDER_OUTPUT).
+ *
+ * @param data Array of complex numbers in the output order of the kernels
+ * @param iterations Length of the data array will be calculated with iterations * FFT Size
+ * @param logFFTSize Log2 of the FFT size
+ */
+void output_to_natural_order(std::complex<HOST_DATA_TYPE> *data, unsigned iterations, unsigned logFFTSize = LOG_FFT_SIZE);
+
+/**
+ * @brief Rotate the axes of the distributed multi-dimensional FFT data, so the last axis becomes the first one.
+ *          The data is distributed over the MPI ranks in slabs along the first axis, so this is an all-to-all
+ *          global transpose. After dimensions rotations, the data is in its original order again.
+ *
+ * @param in Local slab of the data with the layout [first axis][middle axes][last axis]
+ * @param out Local slab of the rotated data with the layout [last axis][first axis][middle axes]
+ * @param logFFTSize Log2 of the size of every axis
+ * @param dimensions Number of dimensions of the data. Has to be at least 2.
+ */
+void rotate_axes(std::complex<HOST_DATA_TYPE> const* in, std::complex<HOST_DATA_TYPE>* out, unsigned logFFTSize, unsigned dimensions);
+
+/**
+ * @brief Unpack the half spectra of the two real signals x and y from the FFT of z = x + iy.
+ *          The spectra are calculated with X[k] = (Z[k] + conj(Z[n-k])) / 2 and Y[k] = (Z[k] - conj(Z[n-k])) / 2i.
+ *
+ * @param packed The FFT results of the packed signals
+ * @param spectra The half spectra with n/2 + 1 bins. First the spectrum of x, then the one of y for every FFT
+ * @param iterations Number of FFTs that are stored sequentially in packed
+ * @param logFFTSize Log2 of the FFT size
+ * @param bitReversed If true, packed is in bit-reversed order, otherwise in natural order
  */
-void fourier_transform_gold(bool inverse, const int lognr_points, std::complex<HOST_DATA_TYPE> *data);
+void unpack_real_spectra(std::complex<HOST_DATA_TYPE> const* packed, std::complex<HOST_DATA_TYPE>* spectra, unsigned iterations, unsigned logFFTSize,
+                            bool bitReversed = true);
 
 /**
- * @brief Calculate a single stage of the whole FFT calculation.
- *          This function will mainly be used by fourier_transform_gold() to calculate the FFT.
+ * @brief Pack the two Hermitian spectra X and Y into the single spectrum Z = X + iY, so the iFFT of Z is x + iy.
+ *          This is the inverse of unpack_real_spectra, but the result is stored in natural order.
+ *
+ * @param spectra The half spectra with n/2 + 1 bins. First the spectrum of x, then the one of y for every FFT
+ * @param packed The packed spectra in natural order
+ * @param iterations Number of FFTs that are stored sequentially in packed
+ * @param logFFTSize Log2 of the FFT size
+ */
+void pack_real_spectra(std::complex<HOST_DATA_TYPE> const* spectra, std::complex<HOST_DATA_TYPE>* packed, unsigned iterations, unsigned logFFTSize);
+
+/**
+ * @brief Calculate the fast convolution of a batch of signals with a reference implementation on the CPU.
+ *          Like the FPGA kernels, the inverse FFT is not normalized, so the result is 2^lognr_points times the convolution.
+ *
+ * @param lognr_points The log2 of the FFT size
+ * @param data The signals. Will be overwritten with the convolved signals in natural order.
+ * @param filter The filter spectrum in natural order that is used for all signals
+ * @param iterations Number of signals that are stored sequentially in data
+ */
+void convolution_gold(const int lognr_points, std::complex<HOST_DATA_TYPE> *data, std::complex<HOST_DATA_TYPE> const* filter, unsigned iterations = 1);
+
+/**
+ * @brief Do a batch of FFTs with a reference implementation on the CPU.
+ *          It uses FFTW in double precision if available or an iterative radix-4 FFT otherwise.
+ *          The FFTs of the batch are calculated in parallel with OpenMP.
  * 
+ * @param inverse if false, the FFT will be calculated, else the iFFT
  * @param lognr_points The log2 of the FFT size that should be calculated 
- * @param data The input data for the FFT stage
+ * @param data The input data for the FFT. Will be overwritten with the result in natural order.
+ * @param iterations Number of FFTs that are stored sequentially in data
  */
-void fourier_stage(int lognr_points, std::complex<double> *data);
+void fourier_transform_gold(bool inverse, const int lognr_points, std::complex<HOST_DATA_TYPE> *data, unsigned iterations = 1);
 
 } // namespace fft
 
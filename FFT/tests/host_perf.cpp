@@ -0,0 +1,62 @@
+//
+// Micro-benchmarks for the host code of the FFT benchmark
+//
+#include <cmath>
+#include <complex>
+
+#include "benchmark/benchmark.h"
+#include "host_perf_fixture.hpp"
+#include "fft_benchmark.hpp"
+#include "parameters.h"
+
+/**
+ * The range gives the number of FFTs
+ */
+class FFTHostPerf : public hpcc_base::HostPerfFixture<fft::FFTBenchmark> {
+protected:
+    void
+    setDataSize(benchmark::State& state) override {
+        auto& settings = *getBenchmark().getExecutionSettings().programSettings;
+        settings.iterations = state.range(0);
+        settings.inverse = false;
+    }
+
+    size_t
+    getInputDataBytes(benchmark::State& state) override {
+        return state.range(0) * (1 << getBenchmark().getExecutionSettings().programSettings->logFFTSize) * sizeof(std::complex<HOST_DATA_TYPE>);
+    }
+};
+
+BENCHMARK_DEFINE_F(FFTHostPerf, GenerateInputData)(benchmark::State& state) {
+    measureInputDataGeneration(state);
+}
+BENCHMARK_REGISTER_F(FFTHostPerf, GenerateInputData)->RangeMultiplier(4)->Range(1, 1024)->Unit(benchmark::kMillisecond);
+
+/**
+ * Reference FFT that is used for the validation
+ */
+BENCHMARK_DEFINE_F(FFTHostPerf, FourierTransformGold)(benchmark::State& state) {
+    auto data = generateData(state);
+    unsigned log_size = getBenchmark().getExecutionSettings().programSettings->logFFTSize;
+    for (auto _ : state) {
+        fft::fourier_transform_gold(false, log_size, data->data, state.range(0));
+        benchmark::ClobberMemory();
+    }
+    double size = 1 << log_size;
+    state.counters["FLOPS"] = benchmark::Counter(5.0 * size * std::log2(size) * state.range(0) * state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK_REGISTER_F(FFTHostPerf, FourierTransformGold)->RangeMultiplier(4)->Range(1, 1024)->Unit(benchmark::kMillisecond);
+
+/**
+ * Bit reversal of the input data
+ */
+BENCHMARK_DEFINE_F(FFTHostPerf, BitReverse)(benchmark::State& state) {
+    auto data = generateData(state);
+    unsigned log_size = getBenchmark().getExecutionSettings().programSettings->logFFTSize;
+    for (auto _ : state) {
+        fft::bit_reverse(data->data, state.range(0), log_size);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * (1 << log_size) * sizeof(std::complex<HOST_DATA_TYPE>));
+}
+BENCHMARK_REGISTER_F(FFTHostPerf, BitReverse)->RangeMultiplier(4)->Range(1, 1024)->Unit(benchmark::kMicrosecond);
@@ -2,6 +2,7 @@
 // Created by Marius Meyer on 04.12.19.
 //
 #include <memory>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "fft_benchmark.hpp"
@@ -127,7 +128,7 @@ TEST_F(FFTKernelTest, FFTandiFFTProduceResultCloseToSource) {
     }
 
     // Need to again bit reverse input for iFFT
-    fft::bit_reverse(data->data_out, 1);
+    fft::output_to_natural_order(data->data_out, 1);
 
     // Copy to input buffer for iFFT
     for (int i=0; i<(1 << LOG_FFT_SIZE); i++) {
@@ -137,7 +138,7 @@ TEST_F(FFTKernelTest, FFTandiFFTProduceResultCloseToSource) {
     bm->getExecutionSettings().programSettings->inverse = true;
     auto result2 = bm->executeKernel(*data);
     // Since data was already sorted by iFFT the bit reversal of the kernel has t be undone
-    fft::bit_reverse(data->data_out, 1);
+    fft::output_to_natural_order(data->data_out, 1);
 
     for (int i=1; i < (1 << LOG_FFT_SIZE); i++) {
         EXPECT_NEAR(std::abs(data->data_out[i]), std::abs(verify_data->data[i]), 0.001);
@@ -153,7 +154,7 @@ TEST_F(FFTKernelTest, FPGAFFTAndCPUFFTGiveSameResults) {
     auto result = bm->executeKernel(*data);
 
     fft::fourier_transform_gold(false,LOG_FFT_SIZE,verify_data->data);
-    fft::bit_reverse(verify_data->data, 1);
+    fft::output_to_natural_order(data->data_out, 1);
 
     // Normalize iFFT result
     for (int i=0; i<(1 << LOG_FFT_SIZE); i++) {
@@ -174,7 +175,7 @@ TEST_F(FFTKernelTest, FPGAiFFTAndCPUiFFTGiveSameResults) {
     auto result = bm->executeKernel(*data);
 
     fft::fourier_transform_gold(true,LOG_FFT_SIZE,verify_data->data);
-    fft::bit_reverse(verify_data->data, 1);
+    fft::output_to_natural_order(data->data_out, 1);
 
     // Normalize iFFT result
     for (int i=0; i<(1 << LOG_FFT_SIZE); i++) {
@@ -184,3 +185,92 @@ TEST_F(FFTKernelTest, FPGAiFFTAndCPUiFFTGiveSameResults) {
         EXPECT_NEAR(std::abs(data->data_out[i]), 0.0, 0.001);
     }
 }
+
+/**
+ * Check if the CPU backend returns the FFT in the same order as the FPGA kernel
+ */
+TEST_F(FFTKernelTest, CPUBackendAndCPUFFTGiveSameResults) {
+    auto verify_data = bm->generateInputData();
+
+    bm->getExecutionSettings().programSettings->communicationType = hpcc_base::CommunicationType::cpu_only;
+    auto result = bm->executeKernel(*data);
+
+    fft::fourier_transform_gold(false,LOG_FFT_SIZE,verify_data->data);
+    fft::output_to_natural_order(data->data_out, 1);
+
+    for (int i=0; i<(1 << LOG_FFT_SIZE); i++) {
+        data->data_out[i] -= verify_data->data[i];
+    }
+    for (int i=0; i < (1 << LOG_FFT_SIZE); i++) {
+        EXPECT_NEAR(std::abs(data->data_out[i]), 0.0, 0.001);
+    }
+}
+
+/**
+ * Check if the CPU backend calculates an FFT size that differs from the default size
+ */
+TEST_F(FFTKernelTest, CPUBackendValidatesForOtherFFTSize) {
+    bm->getExecutionSettings().programSettings->communicationType = hpcc_base::CommunicationType::cpu_only;
+    bm->getExecutionSettings().programSettings->logFFTSize = LOG_FFT_SIZE - 1;
+    data = bm->generateInputData();
+    auto result = bm->executeKernel(*data);
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+/**
+ * Check if FFT sizes that are not available in the bitstream are rejected
+ */
+TEST_F(FFTKernelTest, UnavailableFFTSizeIsRejected) {
+    bm->getExecutionSettings().programSettings->logFFTSize = LOG_FFT_SIZE + 100;
+    EXPECT_FALSE(bm->checkInputParameters());
+}
+
+/**
+ * Check if the streamed FFT gives the same results as the FFT with the whole data on the device
+ */
+TEST_F(FFTKernelTest, StreamedFFTGivesSameResults) {
+    bm->getExecutionSettings().programSettings->iterations = 4 * bm->getExecutionSettings().programSettings->kernelReplications;
+    data = bm->generateInputData();
+    auto result = bm->executeKernel(*data);
+    std::vector<std::complex<HOST_DATA_TYPE>> reference(data->data_out, data->data_out + 4 * bm->getExecutionSettings().programSettings->kernelReplications * (1 << LOG_FFT_SIZE));
+    bm->getExecutionSettings().programSettings->streamChunk = 1;
+    result = bm->executeKernel(*data);
+    for (size_t i=0; i < reference.size(); i++) {
+        EXPECT_NEAR(std::abs(data->data_out[i] - reference[i]), 0.0, 0.001);
+    }
+}
+
+/**
+ * Check if chunk sizes that do not divide the FFTs per kernel replication are rejected
+ */
+TEST_F(FFTKernelTest, IndivisibleStreamChunkIsRejected) {
+    bm->getExecutionSettings().programSettings->iterations = 3 * bm->getExecutionSettings().programSettings->kernelReplications;
+    bm->getExecutionSettings().programSettings->streamChunk = 2;
+    EXPECT_FALSE(bm->checkInputParameters());
+}
+
+/**
+ * Check if the R2C and C2R transforms validate
+ */
+TEST_F(FFTKernelTest, RealSignalsValidate) {
+    bm->getExecutionSettings().programSettings->realSignals = true;
+    data = bm->generateInputData();
+    auto result = bm->executeKernel(*data);
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+    bm->getExecutionSettings().programSettings->inverse = true;
+    data = bm->generateInputData();
+    result = bm->executeKernel(*data);
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+/**
+ * Check if the convolution is rejected in combination with the inverse FFT and real signals
+ */
+TEST_F(FFTKernelTest, ConvolutionWithInverseOrRealSignalsIsRejected) {
+    bm->getExecutionSettings().programSettings->convolution = true;
+    bm->getExecutionSettings().programSettings->inverse = true;
+    EXPECT_FALSE(bm->checkInputParameters());
+    bm->getExecutionSettings().programSettings->inverse = false;
+    bm->getExecutionSettings().programSettings->realSignals = true;
+    EXPECT_FALSE(bm->checkInputParameters());
+}
@@ -2,6 +2,9 @@
 // Created by Marius Meyer on 20.01.20.
 //
 
+#include <cmath>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "fft_benchmark.hpp"
 #include "parameters.h"
@@ -119,4 +122,126 @@ TEST_F(FFTHostTest, FFTandiFFTProduceResultCloseToSource) {
     for (int i=1; i < (1 << LOG_FFT_SIZE); i++) {
         EXPECT_NEAR(std::abs(data->data[i]), std::abs(verify_data->data[i]), 0.001);
     }
-}
\ No newline at end of file
+}
+/**
+ * Check if the axis rotation of 2D data is a transpose on a single rank
+ */
+TEST_F(FFTHostTest, RotateAxesTransposes2DData) {
+    const int log_size = 4;
+    const int n = (1 << log_size);
+    std::vector<std::complex<HOST_DATA_TYPE>> in(n * n);
+    std::vector<std::complex<HOST_DATA_TYPE>> out(n * n);
+    for (int i=0; i < n * n; i++) {
+        in[i].real(i);
+        in[i].imag(-i);
+    }
+    fft::rotate_axes(in.data(), out.data(), log_size, 2);
+    for (int i=0; i < n; i++) {
+        for (int j=0; j < n; j++) {
+            EXPECT_FLOAT_EQ(out[j * n + i].real(), in[i * n + j].real());
+            EXPECT_FLOAT_EQ(out[j * n + i].imag(), in[i * n + j].imag());
+        }
+    }
+}
+
+/**
+ * Check if the rotation of 3D data returns the original data after three rotations
+ */
+TEST_F(FFTHostTest, RotateAxesIsIdentityAfterThreeRotations3D) {
+    const int log_size = 3;
+    const int size = (1 << (3 * log_size));
+    std::vector<std::complex<HOST_DATA_TYPE>> in(size);
+    std::vector<std::complex<HOST_DATA_TYPE>> tmp(size);
+    std::vector<std::complex<HOST_DATA_TYPE>> out(size);
+    for (int i=0; i < size; i++) {
+        in[i].real(i);
+    }
+    fft::rotate_axes(in.data(), tmp.data(), log_size, 3);
+    fft::rotate_axes(tmp.data(), out.data(), log_size, 3);
+    fft::rotate_axes(out.data(), tmp.data(), log_size, 3);
+    for (int i=0; i < size; i++) {
+        EXPECT_FLOAT_EQ(tmp[i].real(), in[i].real());
+    }
+}
+
+/**
+ * Check if the batched reference FFT gives the same results as single FFTs
+ */
+TEST_F(FFTHostTest, BatchedFFTEqualsSingleFFTs) {
+    const int batch = 4;
+    std::vector<std::complex<HOST_DATA_TYPE>> batched((1 << LOG_FFT_SIZE) * batch);
+    std::vector<std::complex<HOST_DATA_TYPE>> single((1 << LOG_FFT_SIZE) * batch);
+    for (int i=0; i < (1 << LOG_FFT_SIZE) * batch; i++) {
+        batched[i] = std::complex<HOST_DATA_TYPE>(std::sin(i), std::cos(3 * i));
+        single[i] = batched[i];
+    }
+    fft::fourier_transform_gold(false, LOG_FFT_SIZE, batched.data(), batch);
+    for (int b=0; b < batch; b++) {
+        fft::fourier_transform_gold(false, LOG_FFT_SIZE, &single[b * (1 << LOG_FFT_SIZE)]);
+    }
+    for (int i=0; i < (1 << LOG_FFT_SIZE) * batch; i++) {
+        EXPECT_FLOAT_EQ(batched[i].real(), single[i].real());
+        EXPECT_FLOAT_EQ(batched[i].imag(), single[i].imag());
+    }
+}
+
+/**
+ * Check if the unpacked spectra of two packed real signals equal the FFTs of the single signals
+ */
+TEST_F(FFTHostTest, UnpackedRealSpectraEqualSingleFFTs) {
+    const int n = 1 << LOG_FFT_SIZE;
+    std::vector<std::complex<HOST_DATA_TYPE>> packed(n);
+    std::vector<std::complex<HOST_DATA_TYPE>> x(n);
+    std::vector<std::complex<HOST_DATA_TYPE>> y(n);
+    std::vector<std::complex<HOST_DATA_TYPE>> spectra(n + 2);
+    for (int i=0; i < n; i++) {
+        x[i] = std::complex<HOST_DATA_TYPE>(std::sin(i), 0.0);
+        y[i] = std::complex<HOST_DATA_TYPE>(std::cos(3 * i), 0.0);
+        packed[i] = std::complex<HOST_DATA_TYPE>(x[i].real(), y[i].real());
+    }
+    fft::fourier_transform_gold(false, LOG_FFT_SIZE, x.data());
+    fft::fourier_transform_gold(false, LOG_FFT_SIZE, y.data());
+    // The kernel returns the packed FFT in bit-reversed order
+    fft::fourier_transform_gold(false, LOG_FFT_SIZE, packed.data());
+    fft::bit_reverse(packed.data(), 1);
+    fft::unpack_real_spectra(packed.data(), spectra.data(), 1, LOG_FFT_SIZE);
+    for (int k=0; k <= n / 2; k++) {
+        EXPECT_NEAR(std::abs(spectra[k] - x[k]), 0.0, 0.001);
+        EXPECT_NEAR(std::abs(spectra[n / 2 + 1 + k] - y[k]), 0.0, 0.001);
+    }
+}
+
+/**
+ * Check if packing the unpacked real spectra gives the natural ordered FFT of the packed signals
+ */
+TEST_F(FFTHostTest, PackedRealSpectraEqualPackedFFT) {
+    const int n = 1 << LOG_FFT_SIZE;
+    std::vector<std::complex<HOST_DATA_TYPE>> bit_reversed(data->data, data->data + n);
+    std::vector<std::complex<HOST_DATA_TYPE>> spectra(n + 2);
+    std::vector<std::complex<HOST_DATA_TYPE>> packed(n);
+    fft::fourier_transform_gold(false, LOG_FFT_SIZE, bit_reversed.data());
+    std::vector<std::complex<HOST_DATA_TYPE>> reference(bit_reversed);
+    fft::bit_reverse(bit_reversed.data(), 1);
+    fft::unpack_real_spectra(bit_reversed.data(), spectra.data(), 1, LOG_FFT_SIZE);
+    fft::pack_real_spectra(spectra.data(), packed.data(), 1, LOG_FFT_SIZE);
+    for (int k=0; k < n; k++) {
+        EXPECT_NEAR(std::abs(packed[k] - reference[k]), 0.0, 0.001);
+    }
+}
+
+/**
+ * Check if the reference convolution with a shifting filter rotates the signal
+ */
+TEST_F(FFTHostTest, ConvolutionWithShiftFilterRotatesSignal) {
+    const int n = 1 << LOG_FFT_SIZE;
+    std::vector<std::complex<HOST_DATA_TYPE>> convolved(data->data, data->data + n);
+    // The spectrum of the impulse at index 1 shifts the signal by one value
+    std::vector<std::complex<HOST_DATA_TYPE>> filter(n);
+    for (int k=0; k < n; k++) {
+        filter[k] = std::polar(static_cast<HOST_DATA_TYPE>(1.0), static_cast<HOST_DATA_TYPE>(-2.0 * M_PI * k / n));
+    }
+    fft::convolution_gold(LOG_FFT_SIZE, convolved.data(), filter.data());
+    for (int i=0; i < n; i++) {
+        EXPECT_NEAR(std::abs(convolved[(i + 1) % n] / static_cast<HOST_DATA_TYPE>(n) - data->data[i]), 0.0, 0.001);
+    }
+}
@@ -30,6 +30,17 @@ SOFTWARE.
 #pragma OPENCL EXTENSION cl_khr_fp16 : enable
 #endif
 
+#ifdef ENABLE_BFLOAT16
+// OpenCL has no bfloat16 type, so the upper 16 bits of the single precision values are stored instead.
+// The host only generates values that are representable in bfloat16, so cutting off the lower bits is exact.
+// The product of two bfloat16 values is also exact in single precision.
+#define TO_ACCUM_TYPE(x) as_float(((uint)(x)) << 16)
+#define TO_DEVICE_TYPE(x) ((ushort)(as_uint(x) >> 16))
+#else
+#define TO_ACCUM_TYPE(x) ((DEVICE_ACCUM_DATA_TYPE)(x))
+#define TO_DEVICE_TYPE(x) ((DEVICE_DATA_TYPE)(x))
+#endif
+
 // code generation expects an array of maps of size num_replications with the keys a,b,c,out.
 // The value of the keys have to be strings containing the attributes that
 // have to be assigned to input and output buffers in global memory
@@ -48,14 +59,16 @@ do_acc false: c = a * b
 
 where a,b,c are matrices of size GEMM_BLOCK.
 Calculation itself is fully unrolled.
+The products are accumulated with DEVICE_ACCUM_DATA_TYPE, which is wider than
+DEVICE_DATA_TYPE for bfloat16 and int8.
  */
  __attribute__((always_inline))
 void register_gemm(const DEVICE_DATA_TYPE a[GEMM_BLOCK][GEMM_BLOCK],
                     const DEVICE_DATA_TYPE b[GEMM_BLOCK][GEMM_BLOCK],
 #ifdef INTEL_FPGA
-                    DEVICE_DATA_TYPE c_out[INTEL_MUL_SHIFT_REG + 1][GEMM_BLOCK][GEMM_BLOCK],
+                    DEVICE_ACCUM_DATA_TYPE c_out[INTEL_MUL_SHIFT_REG + 1][GEMM_BLOCK][GEMM_BLOCK],
 #else
-                    DEVICE_DATA_TYPE c_out[GEMM_BLOCK][GEMM_BLOCK],
+                    DEVICE_ACCUM_DATA_TYPE c_out[GEMM_BLOCK][GEMM_BLOCK],
 #endif
                     const bool do_acc) {
 #ifdef INTEL_FPGA
@@ -68,7 +81,7 @@ void register_gemm(const DEVICE_DATA_TYPE a[GEMM_BLOCK][GEMM_BLOCK],
 
     DEVICE_DATA_TYPE a_block[GEMM_BLOCK][GEMM_BLOCK + 1];
     DEVICE_DATA_TYPE b_block[GEMM_BLOCK + 1][GEMM_BLOCK];
-    DEVICE_DATA_TYPE c_block[GEMM_BLOCK][GEMM_BLOCK];
+    DEVICE_ACCUM_DATA_TYPE c_block[GEMM_BLOCK][GEMM_BLOCK];
 
     // Load block of matrix A and B and init C and reorder values
 __attribute__((opencl_unroll_hint(GEMM_BLOCK)))
@@ -94,7 +107,7 @@ __attribute__((opencl_unroll_hint(GEMM_BLOCK)))
         for(int y=0; y < GEMM_BLOCK; y++) {
             __attribute__((opencl_unroll_hint(GEMM_BLOCK)))
             for (int x=0; x<GEMM_BLOCK;x++) {
-                c_block[y][x] += a_block[y][x] * b_block[y][x];
+                c_block[y][x] += TO_ACCUM_TYPE(a_block[y][x]) * TO_ACCUM_TYPE(b_block[y][x]);
                 a_block[y][x] = a_block[y][x + 1];
                 b_block[y][x] = b_block[y + 1][x];
             }
@@ -112,7 +125,7 @@ __attribute__((opencl_unroll_hint(GEMM_BLOCK)))
 #else
     DEVICE_DATA_TYPE a_block[GEMM_BLOCK][GEMM_BLOCK]; // automatically in regs
     DEVICE_DATA_TYPE b_block[GEMM_BLOCK][GEMM_BLOCK]; // automatically in regs
-    DEVICE_DATA_TYPE c_block[GEMM_BLOCK][GEMM_BLOCK]; // automatically in regs
+    DEVICE_ACCUM_DATA_TYPE c_block[GEMM_BLOCK][GEMM_BLOCK]; // automatically in regs
 
     // Load block of matrix A and B from BRAM to registers
     __attribute__((opencl_unroll_hint(GEMM_BLOCK)))
@@ -129,10 +142,10 @@ __attribute__((opencl_unroll_hint(GEMM_BLOCK)))
     for (int y=0; y<GEMM_BLOCK; y++) {
         __attribute__((opencl_unroll_hint(GEMM_BLOCK)))
         for (int x=0; x<GEMM_BLOCK; x++) {
-            DEVICE_DATA_TYPE sum = do_acc ? c_out[y][x]  : 0.f;
+            DEVICE_ACCUM_DATA_TYPE sum = do_acc ? c_out[y][x]  : 0;
             __attribute__((opencl_unroll_hint(GEMM_BLOCK)))
             for (int i=0; i<GEMM_BLOCK; i++) {
-                sum += a_block[y][i] * b_block[i][x];
+                sum += TO_ACCUM_TYPE(a_block[y][i]) * TO_ACCUM_TYPE(b_block[i][x]);
             }
             c_block[y][x] = sum;
         }
@@ -163,7 +176,7 @@ local_gemm(const DEVICE_DATA_TYPE a_block[BLOCK_SIZE / GEMM_BLOCK][BLOCK_SIZE /
                                         [GEMM_BLOCK][GEMM_BLOCK],
            const DEVICE_DATA_TYPE b_block[BLOCK_SIZE / GEMM_BLOCK][BLOCK_SIZE / GEMM_BLOCK]
                                             [GEMM_BLOCK][GEMM_BLOCK],
-           DEVICE_DATA_TYPE c_block[BLOCK_SIZE / GEMM_BLOCK][BLOCK_SIZE / GEMM_BLOCK]
+           DEVICE_ACCUM_DATA_TYPE c_block[BLOCK_SIZE / GEMM_BLOCK][BLOCK_SIZE / GEMM_BLOCK]
                                         [GEMM_BLOCK][GEMM_BLOCK],
            const bool do_acc) {
 /**
@@ -184,7 +197,7 @@ to BRAM.
         for (int j = 0; j < BLOCK_SIZE / GEMM_BLOCK; j++) {
             // For Intel FPGA accumulate all partial results in registers
             // tmp_mul and only write back to BRAM once 
-            DEVICE_DATA_TYPE tmp_mul[INTEL_MUL_SHIFT_REG+1][GEMM_BLOCK][GEMM_BLOCK];
+            DEVICE_ACCUM_DATA_TYPE tmp_mul[INTEL_MUL_SHIFT_REG+1][GEMM_BLOCK][GEMM_BLOCK];
             __attribute__((opencl_unroll_hint(INTEL_MUL_SHIFT_REG + 1)))
             for (int kk = 0; kk <= INTEL_MUL_SHIFT_REG; kk++) {
                 __attribute__((opencl_unroll_hint(GEMM_BLOCK)))
@@ -215,7 +228,7 @@ to BRAM.
 #endif
             }
 #if INTEL_MUL_SHIFT_REG > 0
-            DEVICE_DATA_TYPE tmp_mul_sum[GEMM_BLOCK][GEMM_BLOCK];
+            DEVICE_ACCUM_DATA_TYPE tmp_mul_sum[GEMM_BLOCK][GEMM_BLOCK];
             __attribute__((opencl_unroll_hint(INTEL_MUL_SHIFT_REG)))
             for (int kk = 0; kk < INTEL_MUL_SHIFT_REG; kk++) {
                 __attribute__((opencl_unroll_hint(GEMM_BLOCK)))
@@ -265,7 +278,7 @@ to BRAM.
 /**
 Two level blocked GEMM kernel
 
-calculates C_OUT = alpha * A.dot(B) + beta * C
+calculates C_OUT = alpha * op(A).dot(op(B)) + beta * C
 
 @param a The data array representing the whole matrix a in global memory
 @param b The data array representing the whole matrix b in global memory
@@ -273,7 +286,15 @@ calculates C_OUT = alpha * A.dot(B) + beta * C
 @param c_out The data array that will used as output of the result
 @param alpha The alpha scalar value
 @param beta The beta scalar value
-@param a_size the x and y size of the matrix in blocks
+@param m_size Number of rows of op(A) and C in blocks
+@param out_offset First row of blocks of the matrix that is calculated. c_out only contains the calculated rows.
+@param max_block Row of blocks after the last calculated row
+@param descriptors Two values for every matrix of a batch: the offset of the matrix in the buffers and its size, both in blocks
+@param batch_count Number of matrices in the batch. If 0, the descriptors are not used and a single matrix of
+                    size m_size x n_size is calculated.
+@param n_size Number of columns of op(B) and C in blocks
+@param k_size Number of columns of op(A) and rows of op(B) in blocks
+@param transpose Bit 0 is set if A is stored transposed, bit 1 if B is stored transposed
 */
 __attribute__((uses_global_work_offset(0)))
 __kernel
@@ -288,18 +309,45 @@ void gemm/*PY_CODE_GEN i*/(
           const float alpha,
           const float beta,
 #else
-            __global /*PY_CODE_GEN kernel_param_attributes[i]["a"]*/ const DEVICE_DATA_TYPE* restrict a,
-          __global /*PY_CODE_GEN kernel_param_attributes[i]["b"]*/ const DEVICE_DATA_TYPE* restrict b,
-          __global /*PY_CODE_GEN kernel_param_attributes[i]["c"]*/ const DEVICE_DATA_TYPE* restrict c,
-          __global /*PY_CODE_GEN kernel_param_attributes[i]["out"]*/ DEVICE_DATA_TYPE* restrict c_out,
-          const DEVICE_DATA_TYPE alpha,
-          const DEVICE_DATA_TYPE beta,
+        // For bfloat16 and int8 the matrices are passed with the accumulation type
+        // and A and B are converted while they are loaded into local memory
+            __global /*PY_CODE_GEN kernel_param_attributes[i]["a"]*/ const DEVICE_ACCUM_DATA_TYPE* restrict a,
+          __global /*PY_CODE_GEN kernel_param_attributes[i]["b"]*/ const DEVICE_ACCUM_DATA_TYPE* restrict b,
+          __global /*PY_CODE_GEN kernel_param_attributes[i]["c"]*/ const DEVICE_ACCUM_DATA_TYPE* restrict c,
+          __global /*PY_CODE_GEN kernel_param_attributes[i]["out"]*/ DEVICE_ACCUM_DATA_TYPE* restrict c_out,
+          const DEVICE_ACCUM_DATA_TYPE alpha,
+          const DEVICE_ACCUM_DATA_TYPE beta,
 #endif
-          const uint a_size,
+          const uint m_size,
           const uint out_offset,
-          const uint max_block) {
-
-    const unsigned size = a_size * BLOCK_SIZE;
+          const uint max_block,
+          __global const uint* restrict descriptors,
+          const uint batch_count,
+          const uint n_size,
+          const uint k_size,
+          const uint transpose) {
+
+    // A batch is calculated with a single kernel execution to avoid the overhead of a kernel launch per matrix
+    const unsigned matrices = (batch_count > 0) ? batch_count : 1;
+#ifdef INTEL_FPGA
+#pragma disable_loop_pipelining
+#endif
+    for (unsigned matrix = 0; matrix < matrices; matrix++) {
+    const ulong matrix_offset = (batch_count > 0) ? (ulong)descriptors[2 * matrix] * BLOCK_SIZE * BLOCK_SIZE : 0;
+    // The matrices of a batch are square
+    const unsigned m_blocks = (batch_count > 0) ? descriptors[2 * matrix + 1] : m_size;
+    const unsigned n_blocks = (batch_count > 0) ? m_blocks : n_size;
+    const unsigned k_blocks = (batch_count > 0) ? m_blocks : k_size;
+    const unsigned first_block = (batch_count > 0) ? 0 : out_offset;
+    const unsigned last_block = (batch_count > 0) ? m_blocks : max_block;
+
+    // Row pitch of the matrices in global memory. Transposed matrices are stored with swapped dimensions.
+    const unsigned size_n = n_blocks * BLOCK_SIZE;
+    const unsigned size_k = k_blocks * BLOCK_SIZE;
+    const bool transpose_a = (transpose & 1) != 0;
+    const bool transpose_b = (transpose & 2) != 0;
+    const unsigned pitch_a = transpose_a ? m_blocks * BLOCK_SIZE : size_k;
+    const unsigned pitch_b = transpose_b ? size_k : size_n;
 
     // Level 1 Matrix Multiplication
 #ifdef INTEL_FPGA
@@ -310,22 +358,28 @@ void gemm/*PY_CODE_GEN i*/(
 // These two loops will not be coalesced, but should not produce much overhead because the outer loop does 
 // not do a lot of iterations
 #endif
-    for (unsigned y_block = out_offset; y_block < max_block; y_block++) {
+    for (unsigned y_block = first_block; y_block < last_block; y_block++) {
 #ifdef INTEL_FPGA
 #pragma disable_loop_pipelining
 #endif
-        for (unsigned x_block = 0; x_block < a_size; x_block++) {
-            DEVICE_DATA_TYPE c_block[BLOCK_SIZE / GEMM_BLOCK][BLOCK_SIZE / GEMM_BLOCK]
+        for (unsigned x_block = 0; x_block < n_blocks; x_block++) {
+            DEVICE_ACCUM_DATA_TYPE c_block[BLOCK_SIZE / GEMM_BLOCK][BLOCK_SIZE / GEMM_BLOCK]
             [GEMM_BLOCK][GEMM_BLOCK]  __attribute((numbanks(GEMM_BLOCK * GEMM_BLOCK),xcl_array_partition(complete, 3),xcl_array_partition(complete, 4)));
 #ifdef INTEL_FPGA
 #pragma disable_loop_pipelining
 #endif
-            for (unsigned diagonal_block=0; diagonal_block < a_size; diagonal_block++) {
+            for (unsigned diagonal_block=0; diagonal_block < k_blocks; diagonal_block++) {
                 DEVICE_DATA_TYPE a_block[BLOCK_SIZE / GEMM_BLOCK][BLOCK_SIZE / GEMM_BLOCK]
                                         [GEMM_BLOCK][GEMM_BLOCK]  __attribute((numbanks(GEMM_BLOCK * GEMM_BLOCK),xcl_array_partition(complete, 3),xcl_array_partition(complete, 4)));
                 DEVICE_DATA_TYPE b_block[BLOCK_SIZE / GEMM_BLOCK][BLOCK_SIZE / GEMM_BLOCK]
                                         [GEMM_BLOCK][GEMM_BLOCK]  __attribute((numbanks(GEMM_BLOCK * GEMM_BLOCK),xcl_array_partition(complete, 3),xcl_array_partition(complete, 4)));
-                // Load all needed level 1 blocks
+                // Load all needed level 1 blocks.
+                // The blocks are always read row by row in the order they are stored in global memory to keep the memory bursts.
+                // Blocks of transposed matrices are transposed while they are written to the local memory.
+                const unsigned a_block_offset = transpose_a ? (diagonal_block * pitch_a + y_block) * BLOCK_SIZE
+                                                            : (y_block * pitch_a + diagonal_block) * BLOCK_SIZE;
+                const unsigned b_block_offset = transpose_b ? (x_block * pitch_b + diagonal_block) * BLOCK_SIZE
+                                                            : (diagonal_block * pitch_b + x_block) * BLOCK_SIZE;
 
 #ifdef INTEL_FPGA
 // Coalesce both loops to generate single loop
@@ -356,26 +410,44 @@ __attribute__((xcl_pipeline_loop(1)))
                         float a_reorder_buffer[GLOBAL_MEM_UNROLL];
                         float b_reorder_buffer[GLOBAL_MEM_UNROLL];
 #else
-                        DEVICE_DATA_TYPE a_reorder_buffer[GLOBAL_MEM_UNROLL];
-                        DEVICE_DATA_TYPE b_reorder_buffer[GLOBAL_MEM_UNROLL];
+                        DEVICE_ACCUM_DATA_TYPE a_reorder_buffer[GLOBAL_MEM_UNROLL];
+                        DEVICE_ACCUM_DATA_TYPE b_reorder_buffer[GLOBAL_MEM_UNROLL];
 #endif
 __attribute__((opencl_unroll_hint(GLOBAL_MEM_UNROLL)))
                         for (unsigned u = 0; u < GLOBAL_MEM_UNROLL; u++) {
-                            a_reorder_buffer[u] = a[(y_block * size + diagonal_block) * BLOCK_SIZE +
-                                j + u + i * size];
-                            b_reorder_buffer[u] = b[(diagonal_block * size + x_block) * BLOCK_SIZE +
-                                                          j + u + i * size];
+                            a_reorder_buffer[u] = a[matrix_offset + a_block_offset + j + u + i * pitch_a];
+                            b_reorder_buffer[u] = b[matrix_offset + b_block_offset + j + u + i * pitch_b];
                         }
 __attribute__((opencl_unroll_hint(GLOBAL_MEM_UNROLL/GEMM_BLOCK)))
                         for (unsigned b = 0; b < GLOBAL_MEM_UNROLL/GEMM_BLOCK; b++) {
 __attribute__((opencl_unroll_hint(GEMM_BLOCK)))
                             for (unsigned u = 0; u < GEMM_BLOCK; u++) {
 #ifdef ENABLE_MIXED_PRECISION
-                                vstore_half(a_reorder_buffer[b * GEMM_BLOCK + u], u, &a_block[i / GEMM_BLOCK][j / GEMM_BLOCK + b][i & (GEMM_BLOCK - 1)][0]);
-                                vstore_half(b_reorder_buffer[b * GEMM_BLOCK + u], u , &b_block[i / GEMM_BLOCK][j / GEMM_BLOCK + b][i & (GEMM_BLOCK - 1)][0]);
+                                if (transpose_a) {
+                                    vstore_half(a_reorder_buffer[b * GEMM_BLOCK + u], 0, &a_block[j / GEMM_BLOCK + b][i / GEMM_BLOCK][u][i & (GEMM_BLOCK - 1)]);
+                                }
+                                else {
+                                    vstore_half(a_reorder_buffer[b * GEMM_BLOCK + u], u, &a_block[i / GEMM_BLOCK][j / GEMM_BLOCK + b][i & (GEMM_BLOCK - 1)][0]);
+                                }
+                                if (transpose_b) {
+                                    vstore_half(b_reorder_buffer[b * GEMM_BLOCK + u], 0, &b_block[j / GEMM_BLOCK + b][i / GEMM_BLOCK][u][i & (GEMM_BLOCK - 1)]);
+                                }
+                                else {
+                                    vstore_half(b_reorder_buffer[b * GEMM_BLOCK + u], u , &b_block[i / GEMM_BLOCK][j / GEMM_BLOCK + b][i & (GEMM_BLOCK - 1)][0]);
+                                }
 #else
-                                a_block[i / GEMM_BLOCK][j / GEMM_BLOCK + b][i & (GEMM_BLOCK - 1)][u] = a_reorder_buffer[b * GEMM_BLOCK + u];
-                                b_block[i / GEMM_BLOCK][j / GEMM_BLOCK + b][i & (GEMM_BLOCK - 1)][u] = b_reorder_buffer[b * GEMM_BLOCK + u];
+                                if (transpose_a) {
+                                    a_block[j / GEMM_BLOCK + b][i / GEMM_BLOCK][u][i & (GEMM_BLOCK - 1)] = TO_DEVICE_TYPE(a_reorder_buffer[b * GEMM_BLOCK + u]);
+                                }
+                                else {
+                                    a_block[i / GEMM_BLOCK][j / GEMM_BLOCK + b][i & (GEMM_BLOCK - 1)][u] = TO_DEVICE_TYPE(a_reorder_buffer[b * GEMM_BLOCK + u]);
+                                }
+                                if (transpose_b) {
+                                    b_block[j / GEMM_BLOCK + b][i / GEMM_BLOCK][u][i & (GEMM_BLOCK - 1)] = TO_DEVICE_TYPE(b_reorder_buffer[b * GEMM_BLOCK + u]);
+                                }
+                                else {
+                                    b_block[i / GEMM_BLOCK][j / GEMM_BLOCK + b][i & (GEMM_BLOCK - 1)][u] = TO_DEVICE_TYPE(b_reorder_buffer[b * GEMM_BLOCK + u]);
+                                }
 #endif
                             }
                         }
@@ -385,7 +457,7 @@ __attribute__((opencl_unroll_hint(GEMM_BLOCK)))
                 local_gemm(a_block, b_block, c_block, diagonal_block);
             }
 
-    unsigned moved_y_block = y_block - out_offset;
+    unsigned moved_y_block = y_block - first_block;
 
 #ifdef INTEL_FPGA
 #pragma loop_coalesce
@@ -418,24 +490,24 @@ __attribute__((xcl_pipeline_loop(1)))
                     float matrix_block_part[GLOBAL_MEM_UNROLL];
                     __attribute__((opencl_unroll_hint(GLOBAL_MEM_UNROLL)))
                     for (unsigned u = 0; u < GLOBAL_MEM_UNROLL; u++) {
-                        c_reorder_buffer[u] = c[(y_block * size + x_block) * BLOCK_SIZE + j * GLOBAL_MEM_UNROLL + i * size + u];
+                        c_reorder_buffer[u] = c[matrix_offset + (y_block * size_n + x_block) * BLOCK_SIZE + j * GLOBAL_MEM_UNROLL + i * size_n + u];
                         matrix_block_part[u] = vload_half(0, &c_block[i/GEMM_BLOCK][(j * GLOBAL_MEM_UNROLL + u)/GEMM_BLOCK][i & (GEMM_BLOCK - 1)][u & (GEMM_BLOCK - 1)]);
                     }
 __attribute__((opencl_unroll_hint(GLOBAL_MEM_UNROLL)))
                     for (unsigned u = 0; u < GLOBAL_MEM_UNROLL; u++) {
-                        c_out[(moved_y_block * size + x_block) * BLOCK_SIZE + j * GLOBAL_MEM_UNROLL + u
-                                + i * size] = beta * c_reorder_buffer[u] + alpha * c_block[i/GEMM_BLOCK][j * GLOBAL_MEM_UNROLL/ GEMM_BLOCK][i & (GEMM_BLOCK - 1)][u];
+                        c_out[matrix_offset + (moved_y_block * size_n + x_block) * BLOCK_SIZE + j * GLOBAL_MEM_UNROLL + u
+                                + i * size_n] = beta * c_reorder_buffer[u] + alpha * c_block[i/GEMM_BLOCK][j * GLOBAL_MEM_UNROLL/ GEMM_BLOCK][i & (GEMM_BLOCK - 1)][u];
                     }
 #else
-                    DEVICE_DATA_TYPE c_reorder_buffer[GLOBAL_MEM_UNROLL];
+                    DEVICE_ACCUM_DATA_TYPE c_reorder_buffer[GLOBAL_MEM_UNROLL];
 __attribute__((opencl_unroll_hint(GLOBAL_MEM_UNROLL)))
                     for (unsigned u = 0; u < GLOBAL_MEM_UNROLL; u++) {
-                        c_reorder_buffer[u] = c[(y_block * size + x_block) * BLOCK_SIZE + j * GLOBAL_MEM_UNROLL + i * size + u];
+                        c_reorder_buffer[u] = c[matrix_offset + (y_block * size_n + x_block) * BLOCK_SIZE + j * GLOBAL_MEM_UNROLL + i * size_n + u];
                     }
 __attribute__((opencl_unroll_hint(GLOBAL_MEM_UNROLL)))
                     for (unsigned u = 0; u < GLOBAL_MEM_UNROLL; u++) {
-                        c_out[(moved_y_block * size + x_block) * BLOCK_SIZE + j * GLOBAL_MEM_UNROLL + u
-                                + i * size] = beta * c_reorder_buffer[u] +
+                        c_out[matrix_offset + (moved_y_block * size_n + x_block) * BLOCK_SIZE + j * GLOBAL_MEM_UNROLL + u
+                                + i * size_n] = beta * c_reorder_buffer[u] +
                                 alpha * c_block[i/GEMM_BLOCK][(j * GLOBAL_MEM_UNROLL + u)/GEMM_BLOCK][i & (GEMM_BLOCK - 1)][(j * GLOBAL_MEM_UNROLL + u) & (GEMM_BLOCK - 1)];
                     }
 #endif
@@ -443,6 +515,7 @@ __attribute__((opencl_unroll_hint(GLOBAL_MEM_UNROLL)))
             }
         }
     }
+    }
 }
 
 // PY_CODE_GEN block_end
@@ -53,6 +53,81 @@ simple exchange of the different calculation methods.
 std::unique_ptr<gemm::GEMMExecutionTimings>
 calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings> const& config, HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
         HOST_DATA_TYPE* c_out, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta);
+
+namespace cpu {
+
+/**
+Execute the matrix multiplication on the host CPU. BLAS is used if it was found,
+otherwise the blocked OpenMP implementation of gemm::gemm_ref().
+
+@copydoc bm_execution::calculate()
+*/
+std::unique_ptr<gemm::GEMMExecutionTimings>
+calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings> const& config, HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
+        HOST_DATA_TYPE* c_out, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta);
+
+}  // namespace cpu
+
+namespace tiled {
+
+/**
+Execute the matrix multiplication for matrices that do not fit into the device memory.
+The output matrix is split into tiles that are distributed over the kernel replications.
+For every output tile, the tiles of A and B are streamed through double-buffered device buffers,
+so the transfers overlap with the kernel executions. The partial results stay on the device.
+
+@copydoc bm_execution::calculate()
+*/
+std::unique_ptr<gemm::GEMMExecutionTimings>
+calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings> const& config, HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
+        HOST_DATA_TYPE* c_out, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta);
+
+}  // namespace tiled
+
+namespace pcie {
+
+/**
+Calculate the size of the square tiles the local matrices are split into for the distributed execution.
+The tiles are the largest ones that evenly divide the local matrices of all ranks, which is the global
+matrix size divided by the least common multiple of the torus width and height.
+
+@param matrixSize Size of the global matrix in one dimension
+@param torusWidth Width of the torus in number of ranks
+@param torusHeight Height of the torus in number of ranks
+
+@return The width of a tile in number of values
+*/
+uint
+gridTileSize(uint matrixSize, uint torusWidth, uint torusHeight);
+
+/**
+Execute the multiplication of matrices that are distributed over a two dimensional torus of MPI ranks
+with the SUMMA algorithm. The panels of A are broadcasted within the torus rows and the panels of B
+within the torus columns. The next panels are broadcasted while the kernels calculate the partial results
+for the current ones. The input and output pointers point to the local part of the matrices.
+
+@copydoc bm_execution::calculate()
+*/
+std::unique_ptr<gemm::GEMMExecutionTimings>
+calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings> const& config, HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
+        HOST_DATA_TYPE* c_out, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta);
+
+}  // namespace pcie
+
+namespace batched {
+
+/**
+Calculate a batch of independent small matrix multiplications. The matrices of the batch are stored
+consecutively in the input and output arrays. Every kernel replication calculates a contiguous range of the batch
+with a single kernel execution, so the kernel launch overhead is only paid once per replication and not per matrix.
+
+@copydoc bm_execution::calculate()
+*/
+std::unique_ptr<gemm::GEMMExecutionTimings>
+calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings> const& config, HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
+        HOST_DATA_TYPE* c_out, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta);
+
+}  // namespace batched
 }  // namespace bm_execution
 
 #endif  // SRC_HOST_EXECUTION_H_
@@ -0,0 +1,193 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "execution.h"
+
+/* C++ standard library headers */
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+/* External library headers */
+#ifdef INTEL_FPGA
+#include "CL/cl_ext_intelfpga.h"
+#endif
+
+namespace bm_execution {
+namespace batched {
+
+/*
+ Calculate a batch of matrix multiplications with a single kernel execution per replication
+
+ @copydoc bm_execution::batched::calculate()
+*/
+std::unique_ptr<gemm::GEMMExecutionTimings>
+calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings> const& config, HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c, HOST_DATA_TYPE* c_out,
+        HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta) {
+#ifdef USE_SVM
+    throw std::runtime_error("The batched execution is not supported in combination with SVM!");
+#endif
+    int err;
+
+    const size_t matrix_elements = static_cast<size_t>(config.programSettings->matrixSize) * config.programSettings->matrixSize;
+    const cl_uint size_in_blocks = config.programSettings->matrixSize / config.programSettings->blockSize;
+    const uint replications = config.programSettings->kernelReplications;
+    // The batch is split into contiguous ranges of matrices, one for every kernel replication
+    const size_t matrices_per_kernel = (config.programSettings->batchSize + replications - 1) / replications;
+
+    std::vector<cl::CommandQueue> compute_queues;
+    std::vector<cl::Buffer> a_buffers;
+    std::vector<cl::Buffer> b_buffers;
+    std::vector<cl::Buffer> c_buffers;
+    std::vector<cl::Buffer> out_buffers;
+    std::vector<cl::Buffer> descriptor_buffers;
+    std::vector<size_t> first_matrix;
+    std::vector<size_t> matrix_count;
+    std::vector<cl::Kernel> gemmkernels;
+
+    for (uint r = 0; r < replications; r++) {
+        size_t first = std::min<size_t>(r * matrices_per_kernel, config.programSettings->batchSize);
+        size_t count = std::min<size_t>(matrices_per_kernel, config.programSettings->batchSize - first);
+        if (count == 0) {
+            // Small batches do not need all kernel replications
+            break;
+        }
+        first_matrix.push_back(first);
+        matrix_count.push_back(count);
+        compute_queues.push_back(cl::CommandQueue(*config.context, config.getDevice(r), config.profiler->getQueueProperties(), &err));
+        ASSERT_CL(err)
+        cl_mem_flags memory_bank_info[4] = {0};
+#ifdef INTEL_FPGA
+#ifdef USE_HBM
+        for (cl_mem_flags& v : memory_bank_info) {
+                    v = CL_MEM_HETEROGENEOUS_INTELFPGA;
+        }
+#else
+        if (!config.programSettings->useMemoryInterleaving) {
+                for (int k = 0; k < 4; k++) {
+                    memory_bank_info[k] = hpcc_base::memory_placement::getBankFlags(config.programSettings->memoryPlacement, r, k, 4,
+                                                                            config.programSettings->memoryBanks);
+                }
+        }
+#endif
+#endif
+        size_t buffer_bytes = sizeof(HOST_DATA_TYPE) * matrix_elements * count;
+        a_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[0], buffer_bytes, NULL, &err));
+        ASSERT_CL(err)
+        b_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[1], buffer_bytes, NULL, &err));
+        ASSERT_CL(err)
+        c_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[2], buffer_bytes, NULL, &err));
+        ASSERT_CL(err)
+        out_buffers.push_back(cl::Buffer(*config.context, CL_MEM_WRITE_ONLY | memory_bank_info[3], buffer_bytes, NULL, &err));
+        ASSERT_CL(err)
+
+        // Every matrix is described by its offset in the buffers of the replication and its size, both in blocks
+        std::vector<cl_uint> descriptors;
+        for (size_t m = 0; m < count; m++) {
+            descriptors.push_back(static_cast<cl_uint>(m * size_in_blocks * size_in_blocks));
+            descriptors.push_back(size_in_blocks);
+        }
+        descriptor_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY, sizeof(cl_uint) * descriptors.size(), NULL, &err));
+        ASSERT_CL(err)
+        err = compute_queues[r].enqueueWriteBuffer(descriptor_buffers[r], CL_TRUE, 0, sizeof(cl_uint) * descriptors.size(), descriptors.data());
+        ASSERT_CL(err)
+
+#ifdef INTEL_FPGA
+        cl::Kernel gemmkernel(*config.program, (KERNEL_NAME + std::to_string(r)).c_str(), &err);
+        ASSERT_CL(err);
+#endif
+#ifdef XILINX_FPGA
+        cl::Kernel gemmkernel(*config.program, (std::string(KERNEL_NAME) + "0:{" + KERNEL_NAME + "0_" +  std::to_string(r + 1) + "}").c_str(), &err);
+        ASSERT_CL(err);
+#endif
+        ASSERT_CL(gemmkernel.setArg(0, a_buffers[r]));
+        ASSERT_CL(gemmkernel.setArg(1, b_buffers[r]));
+        ASSERT_CL(gemmkernel.setArg(2, c_buffers[r]));
+        ASSERT_CL(gemmkernel.setArg(3, out_buffers[r]));
+        ASSERT_CL(gemmkernel.setArg(4, alpha));
+        ASSERT_CL(gemmkernel.setArg(5, beta));
+        // The size and row range of a single matrix are replaced by the descriptors
+        ASSERT_CL(gemmkernel.setArg(6, size_in_blocks));
+        ASSERT_CL(gemmkernel.setArg(7, static_cast<cl_uint>(0)));
+        ASSERT_CL(gemmkernel.setArg(8, size_in_blocks));
+        ASSERT_CL(gemmkernel.setArg(9, descriptor_buffers[r]));
+        ASSERT_CL(gemmkernel.setArg(10, static_cast<cl_uint>(count)));
+        ASSERT_CL(gemmkernel.setArg(11, size_in_blocks));
+        ASSERT_CL(gemmkernel.setArg(12, size_in_blocks));
+        ASSERT_CL(gemmkernel.setArg(13, static_cast<cl_uint>(0)));
+        gemmkernels.push_back(gemmkernel);
+    }
+
+    /* --- Execute actual benchmark kernels --- */
+
+    std::vector<double> executionTimes;
+    std::vector<std::vector<double>> deviceTimings;
+    config.repetitions->start(*config.programSettings);
+    for (int i = 0; config.repetitions->next(executionTimes); i++) {
+        for (size_t r = 0; r < gemmkernels.size(); r++) {
+            size_t offset = first_matrix[r] * matrix_elements;
+            size_t bytes = sizeof(HOST_DATA_TYPE) * matrix_elements * matrix_count[r];
+            err = compute_queues[r].enqueueWriteBuffer(a_buffers[r], CL_FALSE, 0, bytes, &a[offset], nullptr, config.profiler->event("write_A"));
+            ASSERT_CL(err)
+            err = compute_queues[r].enqueueWriteBuffer(b_buffers[r], CL_FALSE, 0, bytes, &b[offset], nullptr, config.profiler->event("write_B"));
+            ASSERT_CL(err)
+            err = compute_queues[r].enqueueWriteBuffer(c_buffers[r], CL_FALSE, 0, bytes, &c[offset], nullptr, config.profiler->event("write_C"));
+            ASSERT_CL(err)
+        }
+        for (auto& q : compute_queues) {
+            ASSERT_CL(q.finish());
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (size_t r = 0; r < gemmkernels.size(); r++) {
+            err = compute_queues[r].enqueueNDRangeKernel(gemmkernels[r], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, config.profiler->event("gemm"));
+            ASSERT_CL(err)
+        }
+        auto deviceTimes = hpcc_base::multi_device::finishQueues(compute_queues, config.devices.size(), t1);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> timespan = t2 - t1;
+        executionTimes.push_back(timespan.count());
+        deviceTimings.resize(deviceTimes.size());
+        for (size_t d = 0; d < deviceTimes.size(); d++) {
+            deviceTimings[d].push_back(deviceTimes[d]);
+        }
+    }
+    config.repetitions->discardWarmup(executionTimes);
+    for (auto& t : deviceTimings) {
+        config.repetitions->discardWarmup(t);
+    }
+
+    /* --- Read back results from Device --- */
+    for (size_t r = 0; r < gemmkernels.size(); r++) {
+        err = compute_queues[r].enqueueReadBuffer(out_buffers[r], CL_TRUE, 0, sizeof(HOST_DATA_TYPE) * matrix_elements * matrix_count[r],
+                                    &c_out[first_matrix[r] * matrix_elements], nullptr, config.profiler->event("read_C_out"));
+        ASSERT_CL(err)
+    }
+
+    std::unique_ptr<gemm::GEMMExecutionTimings> results(
+                    new gemm::GEMMExecutionTimings{executionTimes, deviceTimings});
+    return results;
+}
+
+}  // namespace batched
+}  // namespace bm_execution
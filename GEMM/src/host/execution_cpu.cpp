@@ -0,0 +1,69 @@
+/*
+Copyright (c) 2021 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "execution.h"
+
+/* C++ standard library headers */
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace bm_execution {
+namespace cpu {
+
+/*
+ Execute the matrix multiplication on the host CPU
+
+ @copydoc bm_execution::cpu::calculate()
+*/
+std::unique_ptr<gemm::GEMMExecutionTimings>
+calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings> const& config, HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c, HOST_DATA_TYPE* c_out,
+        HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta) {
+
+    size_t matrix_elements = static_cast<size_t>(config.programSettings->getM()) * config.programSettings->getN();
+
+    std::vector<double> executionTimes;
+    config.repetitions->start(*config.programSettings);
+    for (int i = 0; config.repetitions->next(executionTimes); i++) {
+        // C is used as input in every repetition, so the calculation is done on a copy
+        #pragma omp parallel for simd
+        for (size_t j = 0; j < matrix_elements; j++) {
+            c_out[j] = c[j];
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        gemm::gemm_ref(a, b, c_out, config.programSettings->getM(), config.programSettings->getN(), config.programSettings->getK(),
+                        config.programSettings->transposeA, config.programSettings->transposeB, alpha, beta);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> timespan = t2 - t1;
+        executionTimes.push_back(timespan.count());
+    }
+    config.repetitions->discardWarmup(executionTimes);
+
+    std::unique_ptr<gemm::GEMMExecutionTimings> results(
+                    new gemm::GEMMExecutionTimings{executionTimes, std::vector<std::vector<double>>()});
+    return results;
+}
+
+}  // namespace cpu
+}  // namespace bm_execution
@@ -25,8 +25,10 @@ SOFTWARE.
 
 /* C++ standard library headers */
 #include <chrono>
+#include <deque>
 #include <fstream>
 #include <memory>
+#include <thread>
 #include <vector>
 
 /* External library headers */
@@ -48,17 +50,38 @@ calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings> const& config,
 
     int err;
 
+    // With dynamic scheduling, the rows of C are calculated in chunks that are issued to the replication that finishes first.
+    // The kernel execution times are needed for the utilization of the replications, so profiling is enabled for the queues.
+    bool dynamic_scheduling = config.programSettings->chunkSize > 0;
+#ifdef USE_SVM
+    if (dynamic_scheduling) {
+        throw std::runtime_error("The dynamic scheduling is not supported in combination with SVM!");
+    }
+#endif
+
     // Create Command queue
     std::vector<cl::CommandQueue> compute_queues;
     for (int i=0; i < config.programSettings->kernelReplications; i++) {
-        compute_queues.push_back(cl::CommandQueue(*config.context, *config.device, 0, &err));
+        compute_queues.push_back(cl::CommandQueue(*config.context, config.getDevice(i),
+                                    config.profiler->getQueueProperties() | (dynamic_scheduling ? CL_QUEUE_PROFILING_ENABLE : 0), &err));
         ASSERT_CL(err)
     }
 
-    cl_int size_in_blocks = config.programSettings->matrixSize / config.programSettings->blockSize;
-    size_t number_blocks_per_kernel = ((size_in_blocks + config.programSettings->kernelReplications - 1)/(config.programSettings->kernelReplications));
-    size_t out_buffer_size = config.programSettings->matrixSize * 
-                                (number_blocks_per_kernel) * config.programSettings->blockSize;
+    // The rows of blocks of C are distributed over the kernel replications
+    cl_uint m_blocks = config.programSettings->getM() / config.programSettings->blockSize;
+    cl_uint n_blocks = config.programSettings->getN() / config.programSettings->blockSize;
+    cl_uint k_blocks = config.programSettings->getK() / config.programSettings->blockSize;
+    cl_uint transpose = (config.programSettings->transposeA ? 1 : 0) | (config.programSettings->transposeB ? 2 : 0);
+    size_t a_elements = static_cast<size_t>(config.programSettings->getM()) * config.programSettings->getK();
+    size_t b_elements = static_cast<size_t>(config.programSettings->getK()) * config.programSettings->getN();
+    size_t c_elements = static_cast<size_t>(config.programSettings->getM()) * config.programSettings->getN();
+    size_t number_blocks_per_kernel = ((m_blocks + config.programSettings->kernelReplications - 1)/(config.programSettings->kernelReplications));
+    // Number of values in a row of blocks of C
+    size_t block_row_elements = static_cast<size_t>(config.programSettings->getN()) * config.programSettings->blockSize;
+    // With dynamic scheduling, every replication may calculate every row of C, so its output buffer has the size of C
+    size_t out_buffer_size = dynamic_scheduling ? c_elements : block_row_elements * number_blocks_per_kernel;
+    size_t chunk_rows = config.programSettings->chunkSize;
+    size_t num_chunks = dynamic_scheduling ? (m_blocks + chunk_rows - 1) / chunk_rows : 0;
 
     std::vector<cl::Buffer> a_buffers;
     std::vector<cl::Buffer> b_buffers;
@@ -71,11 +94,11 @@ calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings> const& config,
         // Array of flags for each buffer that is allocated in this benchmark
         // The content of the flags will be changed according to the used compiler flags
         // to support different kinds of devices
-        int memory_bank_info[4] = {0};
+        cl_mem_flags memory_bank_info[4] = {0};
 #ifdef INTEL_FPGA
 #ifdef USE_HBM
         // For Intel HBM the buffers have to be created with a special flag
-        for (int& v : memory_bank_info) {
+        for (cl_mem_flags& v : memory_bank_info) {
                     v = CL_MEM_HETEROGENEOUS_INTELFPGA;
         }
 #else
@@ -85,20 +108,21 @@ calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings> const& config,
         // For boards with HBM, the selection of memory banks is done in the kernel code.
         if (!config.programSettings->useMemoryInterleaving) {
                 for (int k = 0; k < 4; k++) {
-                    memory_bank_info[k] = ((1 + k) << 16);
+                    memory_bank_info[k] = hpcc_base::memory_placement::getBankFlags(config.programSettings->memoryPlacement, i, k, 4,
+                                                                            config.programSettings->memoryBanks);
                 }
         }
 #endif
 #endif
         if (i == 0 || config.programSettings->replicateInputBuffers) {
             a_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[0],
-                                sizeof(HOST_DATA_TYPE) *config.programSettings->matrixSize*config.programSettings->matrixSize, NULL, &err));
+                                sizeof(HOST_DATA_TYPE) * a_elements, NULL, &err));
             ASSERT_CL(err)
             b_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[1],
-                                sizeof(HOST_DATA_TYPE) *config.programSettings->matrixSize*config.programSettings->matrixSize, NULL, &err));
+                                sizeof(HOST_DATA_TYPE) * b_elements, NULL, &err));
             ASSERT_CL(err)
             c_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[2],
-                                sizeof(HOST_DATA_TYPE) *config.programSettings->matrixSize*config.programSettings->matrixSize, NULL, &err));
+                                sizeof(HOST_DATA_TYPE) * c_elements, NULL, &err));
             ASSERT_CL(err)
         }
         out_buffers.push_back(cl::Buffer(*config.context, CL_MEM_WRITE_ONLY | memory_bank_info[3],
@@ -151,61 +175,162 @@ calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings> const& config,
         ASSERT_CL(err);
         err = gemmkernel.setArg(5, beta);
         ASSERT_CL(err);
-        err = gemmkernel.setArg(6, size_in_blocks);
+        err = gemmkernel.setArg(6, m_blocks);
         ASSERT_CL(err);
         err = gemmkernel.setArg(7, static_cast<cl_uint>(i * number_blocks_per_kernel));
         ASSERT_CL(err);
-        err = gemmkernel.setArg(8, static_cast<cl_uint>(std::min<cl_uint>(i * number_blocks_per_kernel + number_blocks_per_kernel, size_in_blocks)));
+        err = gemmkernel.setArg(8, static_cast<cl_uint>(std::min<cl_uint>(i * number_blocks_per_kernel + number_blocks_per_kernel, m_blocks)));
+        ASSERT_CL(err);
+        // A single matrix is calculated, so no batch descriptors are needed
+        err = gemmkernel.setArg(9, cl::Buffer());
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(10, static_cast<cl_uint>(0));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(11, n_blocks);
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(12, k_blocks);
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(13, transpose);
         ASSERT_CL(err);
 
         gemmkernels.push_back(gemmkernel);
     }
 
+    // The kernel writes its rows to the beginning of the output buffer, so every chunk is calculated into a sub-buffer
+    // that starts at the first row of the chunk
+    std::vector<std::vector<cl::Buffer>> chunk_buffers(dynamic_scheduling ? config.programSettings->kernelReplications : 0);
+    for (int i=0; i < chunk_buffers.size(); i++) {
+        cl_uint base_address_align = config.getDevice(i).getInfo<CL_DEVICE_MEM_BASE_ADDR_ALIGN>();
+        if ((sizeof(HOST_DATA_TYPE) * block_row_elements * chunk_rows * 8) % base_address_align != 0) {
+            throw std::runtime_error("The chunk size does not fulfill the alignment requirements of the device for sub-buffers!");
+        }
+        for (size_t ch = 0; ch < num_chunks; ch++) {
+            size_t rows = std::min(chunk_rows, m_blocks - ch * chunk_rows);
+            cl_buffer_region region{sizeof(HOST_DATA_TYPE) * block_row_elements * ch * chunk_rows,
+                                    sizeof(HOST_DATA_TYPE) * block_row_elements * rows};
+            chunk_buffers[i].push_back(out_buffers[i].createSubBuffer(CL_MEM_WRITE_ONLY, CL_BUFFER_CREATE_TYPE_REGION, &region, &err));
+            ASSERT_CL(err)
+        }
+    }
+
+    // The replication that calculated every chunk in the last repetition. It is used to read back the result.
+    std::vector<uint> chunk_owners(num_chunks);
+    std::vector<std::vector<double>> replicationUtilization(chunk_buffers.size());
+    std::vector<std::vector<double>> replicationBlockRows(chunk_buffers.size());
+
+    // Issue the chunks to the replications until all rows are calculated. Every replication has two chunks in its queue,
+    // so it does not idle while the host issues the next chunk after the completion of the previous one.
+    auto schedule_chunks = [&](std::chrono::high_resolution_clock::time_point start) {
+        uint replications = config.programSettings->kernelReplications;
+        size_t next_chunk = 0;
+        std::vector<std::deque<cl::Event>> issued_chunks(replications);
+        std::vector<double> busy_time(replications, 0.0);
+        std::vector<double> block_rows(replications, 0.0);
+        auto issue_chunk = [&](uint r) {
+            cl_uint first_row = next_chunk * chunk_rows;
+            cl_uint last_row = std::min<cl_uint>(first_row + chunk_rows, m_blocks);
+            err = gemmkernels[r].setArg(3, chunk_buffers[r][next_chunk]);
+            ASSERT_CL(err);
+            err = gemmkernels[r].setArg(7, first_row);
+            ASSERT_CL(err);
+            err = gemmkernels[r].setArg(8, last_row);
+            ASSERT_CL(err);
+            issued_chunks[r].emplace_back();
+            err = compute_queues[r].enqueueNDRangeKernel(gemmkernels[r], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, &issued_chunks[r].back());
+            ASSERT_CL(err);
+            compute_queues[r].flush();
+            chunk_owners[next_chunk] = r;
+            block_rows[r] += last_row - first_row;
+            next_chunk++;
+        };
+        for (int depth = 0; depth < 2; depth++) {
+            for (uint r = 0; r < replications && next_chunk < num_chunks; r++) {
+                issue_chunk(r);
+            }
+        }
+        bool chunks_pending = true;
+        while (chunks_pending) {
+            chunks_pending = false;
+            for (uint r = 0; r < replications; r++) {
+                while (!issued_chunks[r].empty()) {
+                    cl::Event& event = issued_chunks[r].front();
+                    cl_int status = event.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>();
+                    if (status < 0) {
+                        throw std::runtime_error("A chunk of the matrix multiplication failed with error " + std::to_string(status) + "!");
+                    }
+                    if (status != CL_COMPLETE) {
+                        break;
+                    }
+                    busy_time[r] += (event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - event.getProfilingInfo<CL_PROFILING_COMMAND_START>()) * 1.0e-9;
+                    config.profiler->addEvent("gemm", event);
+                    issued_chunks[r].pop_front();
+                    if (next_chunk < num_chunks) {
+                        issue_chunk(r);
+                    }
+                }
+                chunks_pending |= !issued_chunks[r].empty();
+            }
+            if (chunks_pending) {
+                std::this_thread::yield();
+            }
+        }
+        std::chrono::duration<double> wall_time = std::chrono::high_resolution_clock::now() - start;
+        for (uint r = 0; r < replications; r++) {
+            replicationUtilization[r].push_back(busy_time[r] / wall_time.count());
+            replicationBlockRows[r].push_back(block_rows[r]);
+        }
+    };
+
     /* --- Execute actual benchmark kernels --- */
 
     double t;
     std::vector<double> executionTimes;
-    for (int i = 0; i < config.programSettings->numRepetitions; i++) {
+    std::vector<std::vector<double>> deviceTimings;
+    config.repetitions->start(*config.programSettings);
+    for (int i = 0; config.repetitions->next(executionTimes); i++) {
 #ifdef USE_SVM
         err = clEnqueueSVMMap(compute_queues[0](), CL_TRUE,
                         CL_MAP_READ,
                         reinterpret_cast<void *>(a),
                         sizeof(HOST_DATA_TYPE) *
-                        (config.programSettings->matrixSize * config.programSettings->matrixSize), 0,
+                        a_elements, 0,
                         NULL, NULL);
         ASSERT_CL(err)
         err = clEnqueueSVMMap(compute_queues[0](), CL_TRUE,
                         CL_MAP_READ,
                         reinterpret_cast<void *>(b),
                         sizeof(HOST_DATA_TYPE) *
-                        (config.programSettings->matrixSize * config.programSettings->matrixSize), 0,
+                        b_elements, 0,
                         NULL, NULL);
         ASSERT_CL(err)
         err = clEnqueueSVMMap(compute_queues[0](), CL_TRUE,
                         CL_MAP_READ,
                         reinterpret_cast<void *>(c),
                         sizeof(HOST_DATA_TYPE) *
-                        (config.programSettings->matrixSize * config.programSettings->matrixSize), 0,
+                        c_elements, 0,
                         NULL, NULL);
         ASSERT_CL(err)
         err = clEnqueueSVMMap(compute_queues[0](), CL_TRUE,
                         CL_MAP_WRITE,
                         reinterpret_cast<void *>(c_out),
                         sizeof(HOST_DATA_TYPE) *
-                        (config.programSettings->matrixSize * config.programSettings->matrixSize), 0,
+                        c_elements, 0,
                         NULL, NULL);
         ASSERT_CL(err)
 #else
 
         for (int i=0; i < (config.programSettings->replicateInputBuffers ? config.programSettings->kernelReplications : 1); i++) {
             err = compute_queues[i].enqueueWriteBuffer(a_buffers[i], CL_TRUE, 0,
-                                        sizeof(HOST_DATA_TYPE)*config.programSettings->matrixSize*config.programSettings->matrixSize, a);
+                                        sizeof(HOST_DATA_TYPE) * a_elements, a,
+                                        nullptr, config.profiler->event("write_A"));
             ASSERT_CL(err)
             err = compute_queues[i].enqueueWriteBuffer(b_buffers[i], CL_TRUE, 0,
-                                        sizeof(HOST_DATA_TYPE)*config.programSettings->matrixSize*config.programSettings->matrixSize, b);
+                                        sizeof(HOST_DATA_TYPE) * b_elements, b,
+                                        nullptr, config.profiler->event("write_B"));
             ASSERT_CL(err)
             err = compute_queues[i].enqueueWriteBuffer(c_buffers[i], CL_TRUE, 0,
-                                        sizeof(HOST_DATA_TYPE)*config.programSettings->matrixSize*config.programSettings->matrixSize, c);
+                                        sizeof(HOST_DATA_TYPE) * c_elements, c,
+                                        nullptr, config.profiler->event("write_C"));
             ASSERT_CL(err)
         }
         for (int i=0; i < config.programSettings->kernelReplications; i++) {
@@ -213,15 +338,30 @@ calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings> const& config,
         }
 #endif
         auto t1 = std::chrono::high_resolution_clock::now();
-        for (int i=0; i < config.programSettings->kernelReplications; i++) {
-            compute_queues[i].enqueueNDRangeKernel(gemmkernels[i], cl::NullRange, cl::NDRange(1));
+        if (dynamic_scheduling) {
+            schedule_chunks(t1);
         }
-        for (int i=0; i < config.programSettings->kernelReplications; i++) {
-            compute_queues[i].finish();
+        else {
+            for (int i=0; i < config.programSettings->kernelReplications; i++) {
+                compute_queues[i].enqueueNDRangeKernel(gemmkernels[i], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, config.profiler->event("gemm"));
+            }
         }
+        auto deviceTimes = hpcc_base::multi_device::finishQueues(compute_queues, config.devices.size(), t1);
         auto t2 = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double> timespan = t2 - t1;
         executionTimes.push_back(timespan.count());
+        deviceTimings.resize(deviceTimes.size());
+        for (size_t d = 0; d < deviceTimes.size(); d++) {
+            deviceTimings[d].push_back(deviceTimes[d]);
+        }
+    }
+    config.repetitions->discardWarmup(executionTimes);
+    for (auto& t : deviceTimings) {
+        config.repetitions->discardWarmup(t);
+    }
+    for (size_t r = 0; r < replicationUtilization.size(); r++) {
+        config.repetitions->discardWarmup(replicationUtilization[r]);
+        config.repetitions->discardWarmup(replicationBlockRows[r]);
     }
 
     /* --- Read back results from Device --- */
@@ -243,15 +383,24 @@ calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings> const& config,
                                 NULL, NULL);
             ASSERT_CL(err)
 #else
+    // Every chunk is read from the output buffer of the replication that calculated it
+    for (size_t ch = 0; ch < num_chunks; ch++) {
+        size_t offset = block_row_elements * ch * chunk_rows;
+        size_t rows = std::min(chunk_rows, m_blocks - ch * chunk_rows);
+        err = compute_queues[0].enqueueReadBuffer(out_buffers[chunk_owners[ch]], CL_TRUE, sizeof(HOST_DATA_TYPE) * offset,
+                                sizeof(HOST_DATA_TYPE) * block_row_elements * rows,
+                                        &c_out[offset], nullptr, config.profiler->event("read_C_out"));
+        ASSERT_CL(err)
+    }
         // The last buffer might only contain a little bit less data 
-    for (int i=0; i < config.programSettings->kernelReplications; i++) {
-        long max_bytes_to_read = (static_cast<long>(sizeof(HOST_DATA_TYPE)*config.programSettings->matrixSize*config.programSettings->matrixSize))
+    for (int i=0; i < (dynamic_scheduling ? 0 : config.programSettings->kernelReplications); i++) {
+        long max_bytes_to_read = (static_cast<long>(sizeof(HOST_DATA_TYPE) * c_elements))
                                             - i * sizeof(HOST_DATA_TYPE) *  out_buffer_size;
         long bytes_to_read = std::min(max_bytes_to_read, static_cast<long>(sizeof(HOST_DATA_TYPE) * out_buffer_size));
         if (bytes_to_read > 0) {
             err = compute_queues[0].enqueueReadBuffer(out_buffers[i], CL_TRUE, 0,
                                     bytes_to_read, 
-                                            &c_out[i * out_buffer_size]);
+                                            &c_out[i * out_buffer_size], nullptr, config.profiler->event("read_C_out"));
             ASSERT_CL(err)
         }
     }
@@ -259,7 +408,7 @@ calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings> const& config,
 
 
     std::unique_ptr<gemm::GEMMExecutionTimings> results(
-                    new gemm::GEMMExecutionTimings{executionTimes});
+                    new gemm::GEMMExecutionTimings{executionTimes, deviceTimings, {}, replicationUtilization, replicationBlockRows});
     return results;
 }
 
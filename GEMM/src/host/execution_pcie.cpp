@@ -0,0 +1,361 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/* Related header files */
+#include "execution.h"
+
+/* C++ standard library headers */
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+/* External library headers */
+#ifdef INTEL_FPGA
+#include "CL/cl_ext_intelfpga.h"
+#endif
+#ifdef _USE_MPI_
+#include "mpi.h"
+#endif
+
+namespace bm_execution {
+namespace pcie {
+
+#ifndef USE_DEPRECATED_HPP_HEADER
+typedef cl::array<size_t,3> rect_t;
+#else
+typedef cl::size_t<3> rect_t;
+#endif
+
+/**
+ * @brief Create the offset or region of a rectangular buffer transfer
+ */
+static rect_t
+make_rect(size_t x, size_t y, size_t z) {
+    rect_t r;
+    r[0] = x;
+    r[1] = y;
+    r[2] = z;
+    return r;
+}
+
+uint
+gridTileSize(uint matrixSize, uint torusWidth, uint torusHeight) {
+    uint a = torusWidth;
+    uint b = torusHeight;
+    while (b != 0) {
+        uint t = a % b;
+        a = b;
+        b = t;
+    }
+    uint lcm = torusWidth / a * torusHeight;
+    return matrixSize / lcm;
+}
+
+/*
+ Multiply the matrices distributed over the torus with panel broadcasts between the MPI ranks
+
+ @copydoc bm_execution::pcie::calculate()
+*/
+std::unique_ptr<gemm::GEMMExecutionTimings>
+calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings> const& config, HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c, HOST_DATA_TYPE* c_out,
+        HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta) {
+#ifdef USE_SVM
+    throw std::runtime_error("The PCIE communication type is not supported with SVM!");
+#endif
+    int err;
+
+    const size_t n = config.programSettings->matrixSize;
+    const size_t torus_width = config.programSettings->torus_width;
+    const size_t torus_height = config.programSettings->torus_height;
+    const size_t tile_size = gridTileSize(n, torus_width, torus_height);
+    // The local matrices consist of tiles_per_row x tiles_per_col square tiles
+    const size_t tiles_per_row = n / torus_width / tile_size;
+    const size_t tiles_per_col = n / torus_height / tile_size;
+    const size_t local_width = tiles_per_row * tile_size;
+    const size_t local_height = tiles_per_col * tile_size;
+    // Number of panels of width tile_size in the inner dimension of the global matrices
+    const size_t panels = n / tile_size;
+    const size_t local_tiles = tiles_per_row * tiles_per_col;
+    const size_t tile_bytes = sizeof(HOST_DATA_TYPE) * tile_size * tile_size;
+    const uint replications = config.programSettings->kernelReplications;
+    const HOST_DATA_TYPE one = OPTIONAL_CAST(1.0);
+
+    const rect_t device_origin = make_rect(0, 0, 0);
+    const rect_t region = make_rect(sizeof(HOST_DATA_TYPE) * tile_size, tile_size, 1);
+    auto host_origin = [&](size_t row_tile, size_t col_tile) {
+        return make_rect(sizeof(HOST_DATA_TYPE) * col_tile * tile_size, row_tile * tile_size, 0);
+    };
+
+#ifdef _USE_MPI_
+    // The panels of A are broadcasted within the rows of the torus, the panels of B within the columns
+    MPI_Comm row_communicator;
+    MPI_Comm_split(MPI_COMM_WORLD, config.programSettings->torus_row, 0, &row_communicator);
+    MPI_Comm col_communicator;
+    MPI_Comm_split(MPI_COMM_WORLD, config.programSettings->torus_col, 0, &col_communicator);
+#endif
+
+    // The local tiles of C are distributed round robin over the kernel replications
+    auto tile_replication = [&](size_t row_tile, size_t col_tile) {
+        return (row_tile * tiles_per_row + col_tile) % replications;
+    };
+
+    std::vector<cl::CommandQueue> compute_queues;
+    std::vector<cl::CommandQueue> transfer_queues;
+    // Two slots for the tiles of the current A and B panel, so the next panel can be transferred during the kernel executions
+    std::vector<std::vector<std::vector<cl::Buffer>>> a_tiles(replications, std::vector<std::vector<cl::Buffer>>(2));
+    std::vector<std::vector<std::vector<cl::Buffer>>> b_tiles(replications, std::vector<std::vector<cl::Buffer>>(2));
+    // The tiles of C and two buffers per tile for the partial results, which are used alternately as input and output of the kernel
+    std::vector<cl::Buffer> c_tiles;
+    std::vector<std::vector<cl::Buffer>> acc_tiles(local_tiles);
+    std::vector<cl::Kernel> gemmkernels;
+
+    // Memory flags of the buffer k of the given replication. The tiles of C belong to the replication that calculates them.
+    auto memory_bank_info = [&](uint r, int k) -> cl_mem_flags {
+#ifdef INTEL_FPGA
+#ifdef USE_HBM
+        return CL_MEM_HETEROGENEOUS_INTELFPGA;
+#else
+        if (!config.programSettings->useMemoryInterleaving) {
+            return hpcc_base::memory_placement::getBankFlags(config.programSettings->memoryPlacement, r, k, 4, config.programSettings->memoryBanks);
+        }
+#endif
+#endif
+        return 0;
+    };
+
+    for (uint r = 0; r < replications; r++) {
+        compute_queues.push_back(cl::CommandQueue(*config.context, config.getDevice(r), config.profiler->getQueueProperties(), &err));
+        ASSERT_CL(err)
+        transfer_queues.push_back(cl::CommandQueue(*config.context, config.getDevice(r), config.profiler->getQueueProperties(), &err));
+        ASSERT_CL(err)
+        // Only the tiles of the panels that are used by the local tiles of C of this replication are allocated
+        for (int s = 0; s < 2; s++) {
+            for (size_t i = 0; i < tiles_per_col; i++) {
+                bool used = false;
+                for (size_t j = 0; j < tiles_per_row; j++) {
+                    used = used || tile_replication(i, j) == r;
+                }
+                a_tiles[r][s].push_back(used ? cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info(r, 0), tile_bytes, NULL, &err) : cl::Buffer());
+                ASSERT_CL(err)
+            }
+            for (size_t j = 0; j < tiles_per_row; j++) {
+                bool used = false;
+                for (size_t i = 0; i < tiles_per_col; i++) {
+                    used = used || tile_replication(i, j) == r;
+                }
+                b_tiles[r][s].push_back(used ? cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info(r, 1), tile_bytes, NULL, &err) : cl::Buffer());
+                ASSERT_CL(err)
+            }
+        }
+#ifdef INTEL_FPGA
+        cl::Kernel gemmkernel(*config.program, (KERNEL_NAME + std::to_string(r)).c_str(), &err);
+        ASSERT_CL(err);
+#endif
+#ifdef XILINX_FPGA
+        cl::Kernel gemmkernel(*config.program, (std::string(KERNEL_NAME) + "0:{" + KERNEL_NAME + "0_" +  std::to_string(r + 1) + "}").c_str(), &err);
+        ASSERT_CL(err);
+#endif
+        // Every kernel execution calculates a whole tile
+        err = gemmkernel.setArg(4, alpha);
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(6, static_cast<cl_uint>(tile_size / config.programSettings->blockSize));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(7, static_cast<cl_uint>(0));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(8, static_cast<cl_uint>(tile_size / config.programSettings->blockSize));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(9, cl::Buffer());
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(10, static_cast<cl_uint>(0));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(11, static_cast<cl_uint>(tile_size / config.programSettings->blockSize));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(12, static_cast<cl_uint>(tile_size / config.programSettings->blockSize));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(13, static_cast<cl_uint>(0));
+        ASSERT_CL(err);
+        gemmkernels.push_back(gemmkernel);
+    }
+    for (size_t t = 0; t < local_tiles; t++) {
+        c_tiles.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info(tile_replication(t / tiles_per_row, t % tiles_per_row), 2), tile_bytes, NULL, &err));
+        ASSERT_CL(err)
+        for (int s = 0; s < 2; s++) {
+            acc_tiles[t].push_back(cl::Buffer(*config.context, CL_MEM_READ_WRITE | memory_bank_info(tile_replication(t / tiles_per_row, t % tiles_per_row), 3), tile_bytes, NULL, &err));
+            ASSERT_CL(err)
+        }
+    }
+
+    // Host buffers for the panels that are received from the other ranks
+    std::vector<std::vector<HOST_DATA_TYPE>> a_panels(2, std::vector<HOST_DATA_TYPE>(local_height * tile_size));
+    std::vector<std::vector<HOST_DATA_TYPE>> b_panels(2, std::vector<HOST_DATA_TYPE>(tile_size * local_width));
+
+    /* --- Execute actual benchmark kernels --- */
+
+    std::vector<double> executionTimes;
+    config.repetitions->start(*config.programSettings);
+    for (int i = 0; config.repetitions->next(executionTimes); i++) {
+        // Transfers of the panels in a slot. The host buffer of the slot can only be reused when they are done.
+        std::vector<std::vector<cl::Event>> panel_write_events(2);
+        // Last kernel event of every replication for both slots. The device buffers of the slot can only be reused when it is done.
+        std::vector<std::vector<cl::Event>> last_kernel_events(2, std::vector<cl::Event>(replications));
+        std::vector<cl::Event> c_write_events(local_tiles);
+#ifdef _USE_MPI_
+        std::vector<std::vector<MPI_Request>> panel_requests(2, std::vector<MPI_Request>(2));
+        MPI_Barrier(MPI_COMM_WORLD);
+#endif
+
+        // Copy the local part of a panel into the panel buffer and start its broadcast
+        auto start_panel_broadcast = [&](size_t k, int slot) {
+            size_t a_root = k / tiles_per_row;
+            size_t b_root = k / tiles_per_col;
+            if (a_root == static_cast<size_t>(config.programSettings->torus_col)) {
+                size_t local_col = (k % tiles_per_row) * tile_size;
+                for (size_t row = 0; row < local_height; row++) {
+                    std::memcpy(&a_panels[slot][row * tile_size], &a[row * local_width + local_col], sizeof(HOST_DATA_TYPE) * tile_size);
+                }
+            }
+            if (b_root == static_cast<size_t>(config.programSettings->torus_row)) {
+                size_t local_row = (k % tiles_per_col) * tile_size;
+                std::memcpy(b_panels[slot].data(), &b[local_row * local_width], sizeof(HOST_DATA_TYPE) * tile_size * local_width);
+            }
+#ifdef _USE_MPI_
+            MPI_Ibcast(a_panels[slot].data(), static_cast<int>(sizeof(HOST_DATA_TYPE) * a_panels[slot].size()), MPI_BYTE, a_root, row_communicator, &panel_requests[slot][0]);
+            MPI_Ibcast(b_panels[slot].data(), static_cast<int>(sizeof(HOST_DATA_TYPE) * b_panels[slot].size()), MPI_BYTE, b_root, col_communicator, &panel_requests[slot][1]);
+#endif
+        };
+
+        auto t1 = std::chrono::high_resolution_clock::now();
+        start_panel_broadcast(0, 0);
+
+        // The tiles of C are transferred while the first panels are broadcasted
+        for (size_t row_tile = 0; row_tile < tiles_per_col; row_tile++) {
+            for (size_t col_tile = 0; col_tile < tiles_per_row; col_tile++) {
+                size_t t = row_tile * tiles_per_row + col_tile;
+                err = transfer_queues[tile_replication(row_tile, col_tile)].enqueueWriteBufferRect(c_tiles[t], CL_FALSE, device_origin,
+                                                host_origin(row_tile, col_tile), region, sizeof(HOST_DATA_TYPE) * tile_size, 0,
+                                                sizeof(HOST_DATA_TYPE) * local_width, 0, c, nullptr, &c_write_events[t]);
+                ASSERT_CL(err)
+            }
+        }
+
+        for (size_t k = 0; k < panels; k++) {
+            int slot = k % 2;
+#ifdef _USE_MPI_
+            MPI_Waitall(2, panel_requests[slot].data(), MPI_STATUSES_IGNORE);
+#endif
+            // The next panels are broadcasted during the kernel executions on the current panels
+            if (k + 1 < panels) {
+                if (!panel_write_events[1 - slot].empty()) {
+                    ASSERT_CL(cl::Event::waitForEvents(panel_write_events[1 - slot]));
+                }
+                start_panel_broadcast(k + 1, 1 - slot);
+            }
+
+            panel_write_events[slot].clear();
+            std::vector<std::vector<cl::Event>> a_write_events(replications, std::vector<cl::Event>(tiles_per_col));
+            std::vector<std::vector<cl::Event>> b_write_events(replications, std::vector<cl::Event>(tiles_per_row));
+            for (uint r = 0; r < replications; r++) {
+                // The tiles of a slot can be overwritten as soon as the kernels of the panel two steps before are done
+                std::vector<cl::Event> write_dependencies;
+                if (k >= 2) {
+                    write_dependencies.push_back(last_kernel_events[slot][r]);
+                }
+                for (size_t row_tile = 0; row_tile < tiles_per_col; row_tile++) {
+                    if (a_tiles[r][slot][row_tile]() == nullptr) {
+                        continue;
+                    }
+                    // The rows of a tile of the A panel are stored consecutively
+                    err = transfer_queues[r].enqueueWriteBuffer(a_tiles[r][slot][row_tile], CL_FALSE, 0, tile_bytes,
+                                                &a_panels[slot][row_tile * tile_size * tile_size], &write_dependencies, &a_write_events[r][row_tile]);
+                    ASSERT_CL(err)
+                    config.profiler->addEvent("write_A", a_write_events[r][row_tile]);
+                    panel_write_events[slot].push_back(a_write_events[r][row_tile]);
+                }
+                for (size_t col_tile = 0; col_tile < tiles_per_row; col_tile++) {
+                    if (b_tiles[r][slot][col_tile]() == nullptr) {
+                        continue;
+                    }
+                    err = transfer_queues[r].enqueueWriteBufferRect(b_tiles[r][slot][col_tile], CL_FALSE, device_origin, host_origin(0, col_tile), region,
+                                                sizeof(HOST_DATA_TYPE) * tile_size, 0, sizeof(HOST_DATA_TYPE) * local_width, 0, b_panels[slot].data(),
+                                                &write_dependencies, &b_write_events[r][col_tile]);
+                    ASSERT_CL(err)
+                    config.profiler->addEvent("write_B", b_write_events[r][col_tile]);
+                    panel_write_events[slot].push_back(b_write_events[r][col_tile]);
+                }
+            }
+
+            // The first kernel of a tile scales C with beta, the following kernels add to the partial result
+            for (size_t row_tile = 0; row_tile < tiles_per_col; row_tile++) {
+                for (size_t col_tile = 0; col_tile < tiles_per_row; col_tile++) {
+                    size_t t = row_tile * tiles_per_row + col_tile;
+                    uint r = tile_replication(row_tile, col_tile);
+                    ASSERT_CL(gemmkernels[r].setArg(0, a_tiles[r][slot][row_tile]));
+                    ASSERT_CL(gemmkernels[r].setArg(1, b_tiles[r][slot][col_tile]));
+                    ASSERT_CL(gemmkernels[r].setArg(2, (k == 0) ? c_tiles[t] : acc_tiles[t][(k - 1) % 2]));
+                    ASSERT_CL(gemmkernels[r].setArg(3, acc_tiles[t][k % 2]));
+                    ASSERT_CL(gemmkernels[r].setArg(5, (k == 0) ? beta : one));
+                    std::vector<cl::Event> kernel_dependencies{a_write_events[r][row_tile], b_write_events[r][col_tile]};
+                    if (k == 0) {
+                        kernel_dependencies.push_back(c_write_events[t]);
+                    }
+                    err = compute_queues[r].enqueueNDRangeKernel(gemmkernels[r], cl::NullRange, cl::NDRange(1), cl::NullRange,
+                                                &kernel_dependencies, &last_kernel_events[slot][r]);
+                    ASSERT_CL(err)
+                    config.profiler->addEvent("gemm", last_kernel_events[slot][r]);
+                }
+            }
+        }
+
+        for (size_t row_tile = 0; row_tile < tiles_per_col; row_tile++) {
+            for (size_t col_tile = 0; col_tile < tiles_per_row; col_tile++) {
+                size_t t = row_tile * tiles_per_row + col_tile;
+                err = compute_queues[tile_replication(row_tile, col_tile)].enqueueReadBufferRect(acc_tiles[t][(panels - 1) % 2], CL_FALSE,
+                                                device_origin, host_origin(row_tile, col_tile), region, sizeof(HOST_DATA_TYPE) * tile_size, 0,
+                                                sizeof(HOST_DATA_TYPE) * local_width, 0, c_out, nullptr, config.profiler->event("read_C_out"));
+                ASSERT_CL(err)
+            }
+        }
+        for (uint r = 0; r < replications; r++) {
+            ASSERT_CL(compute_queues[r].finish());
+            ASSERT_CL(transfer_queues[r].finish());
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> timespan = t2 - t1;
+        executionTimes.push_back(timespan.count());
+    }
+    config.repetitions->discardWarmup(executionTimes);
+
+#ifdef _USE_MPI_
+    MPI_Comm_free(&row_communicator);
+    MPI_Comm_free(&col_communicator);
+#endif
+
+    std::unique_ptr<gemm::GEMMExecutionTimings> results(
+                    new gemm::GEMMExecutionTimings{executionTimes, std::vector<std::vector<double>>(), std::vector<double>()});
+    return results;
+}
+
+}  // namespace pcie
+}  // namespace bm_execution
@@ -0,0 +1,254 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "execution.h"
+
+/* C++ standard library headers */
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+/* External library headers */
+#ifdef INTEL_FPGA
+#include "CL/cl_ext_intelfpga.h"
+#endif
+
+namespace bm_execution {
+namespace tiled {
+
+#ifndef USE_DEPRECATED_HPP_HEADER
+typedef cl::array<size_t,3> rect_t;
+#else
+typedef cl::size_t<3> rect_t;
+#endif
+
+/**
+ * @brief Create the offset or region of a rectangular buffer transfer
+ */
+static rect_t
+make_rect(size_t x, size_t y, size_t z) {
+    rect_t r;
+    r[0] = x;
+    r[1] = y;
+    r[2] = z;
+    return r;
+}
+
+/*
+ Stream tiles of the matrices through the device and execute the kernel on every pair of tiles
+
+ @copydoc bm_execution::tiled::calculate()
+*/
+std::unique_ptr<gemm::GEMMExecutionTimings>
+calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings> const& config, HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c, HOST_DATA_TYPE* c_out,
+        HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta) {
+#ifdef USE_SVM
+    throw std::runtime_error("The tiled execution is not supported in combination with SVM!");
+#endif
+    int err;
+
+    const size_t n = config.programSettings->matrixSize;
+    const size_t tile_size = static_cast<size_t>(config.programSettings->tileSize) * config.programSettings->blockSize;
+    const size_t tiles_per_dim = n / tile_size;
+    const size_t tile_bytes = sizeof(HOST_DATA_TYPE) * tile_size * tile_size;
+    const uint replications = config.programSettings->kernelReplications;
+    const HOST_DATA_TYPE one = OPTIONAL_CAST(1.0);
+
+    // Every tile of the host matrices is transferred with a rectangular copy, so no additional packing on the host is needed
+    const rect_t device_origin = make_rect(0, 0, 0);
+    const rect_t region = make_rect(sizeof(HOST_DATA_TYPE) * tile_size, tile_size, 1);
+    auto host_origin = [&](size_t row_tile, size_t col_tile) {
+        return make_rect(sizeof(HOST_DATA_TYPE) * col_tile * tile_size, row_tile * tile_size, 0);
+    };
+
+    // The kernel execution times are needed for the device-resident performance, so profiling is always enabled for the compute queues
+    std::vector<cl::CommandQueue> compute_queues;
+    std::vector<cl::CommandQueue> transfer_queues;
+    // Two tiles of A, B and C per replication, so the next tiles can be transferred during the kernel execution
+    std::vector<std::vector<cl::Buffer>> a_tiles(replications);
+    std::vector<std::vector<cl::Buffer>> b_tiles(replications);
+    std::vector<std::vector<cl::Buffer>> c_tiles(replications);
+    // Partial results of the current output tile, used alternately as input and output of the kernel
+    std::vector<std::vector<cl::Buffer>> acc_tiles(replications);
+    std::vector<cl::Kernel> gemmkernels;
+
+    for (uint r = 0; r < replications; r++) {
+        compute_queues.push_back(cl::CommandQueue(*config.context, config.getDevice(r), config.profiler->getQueueProperties() | CL_QUEUE_PROFILING_ENABLE, &err));
+        ASSERT_CL(err)
+        transfer_queues.push_back(cl::CommandQueue(*config.context, config.getDevice(r), config.profiler->getQueueProperties(), &err));
+        ASSERT_CL(err)
+        cl_mem_flags memory_bank_info[4] = {0};
+#ifdef INTEL_FPGA
+#ifdef USE_HBM
+        for (cl_mem_flags& v : memory_bank_info) {
+                    v = CL_MEM_HETEROGENEOUS_INTELFPGA;
+        }
+#else
+        if (!config.programSettings->useMemoryInterleaving) {
+                for (int k = 0; k < 4; k++) {
+                    memory_bank_info[k] = hpcc_base::memory_placement::getBankFlags(config.programSettings->memoryPlacement, r, k, 4,
+                                                                            config.programSettings->memoryBanks);
+                }
+        }
+#endif
+#endif
+        for (int s = 0; s < 2; s++) {
+            a_tiles[r].push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[0], tile_bytes, NULL, &err));
+            ASSERT_CL(err)
+            b_tiles[r].push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[1], tile_bytes, NULL, &err));
+            ASSERT_CL(err)
+            c_tiles[r].push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[2], tile_bytes, NULL, &err));
+            ASSERT_CL(err)
+            acc_tiles[r].push_back(cl::Buffer(*config.context, CL_MEM_READ_WRITE | memory_bank_info[3], tile_bytes, NULL, &err));
+            ASSERT_CL(err)
+        }
+#ifdef INTEL_FPGA
+        cl::Kernel gemmkernel(*config.program, (KERNEL_NAME + std::to_string(r)).c_str(), &err);
+        ASSERT_CL(err);
+#endif
+#ifdef XILINX_FPGA
+        cl::Kernel gemmkernel(*config.program, (std::string(KERNEL_NAME) + "0:{" + KERNEL_NAME + "0_" +  std::to_string(r + 1) + "}").c_str(), &err);
+        ASSERT_CL(err);
+#endif
+        // Every kernel execution calculates a whole tile
+        err = gemmkernel.setArg(4, alpha);
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(6, static_cast<cl_uint>(config.programSettings->tileSize));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(7, static_cast<cl_uint>(0));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(8, static_cast<cl_uint>(config.programSettings->tileSize));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(9, cl::Buffer());
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(10, static_cast<cl_uint>(0));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(11, static_cast<cl_uint>(config.programSettings->tileSize));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(12, static_cast<cl_uint>(config.programSettings->tileSize));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(13, static_cast<cl_uint>(0));
+        ASSERT_CL(err);
+        gemmkernels.push_back(gemmkernel);
+    }
+
+    // The output tiles are distributed round robin over the kernel replications.
+    // Every output tile needs one kernel execution for every tile in the inner dimension.
+    const size_t output_tiles = tiles_per_dim * tiles_per_dim;
+    const size_t max_steps = (output_tiles + replications - 1) / replications * tiles_per_dim;
+
+    /* --- Execute actual benchmark kernels --- */
+
+    std::vector<double> executionTimes;
+    std::vector<double> deviceResidentTimes;
+    config.repetitions->start(*config.programSettings);
+    for (int i = 0; config.repetitions->next(executionTimes); i++) {
+        std::vector<std::vector<cl::Event>> write_events(replications, std::vector<cl::Event>(max_steps));
+        std::vector<std::vector<cl::Event>> kernel_events(replications, std::vector<cl::Event>(max_steps));
+        std::vector<size_t> executed_steps(replications, 0);
+
+        auto t1 = std::chrono::high_resolution_clock::now();
+        // The commands are only enqueued and synchronized with events, so all replications are working concurrently
+        for (size_t step = 0; step < max_steps; step++) {
+            for (uint r = 0; r < replications; r++) {
+                size_t tile = (step / tiles_per_dim) * replications + r;
+                if (tile >= output_tiles) {
+                    continue;
+                }
+                size_t row_tile = tile / tiles_per_dim;
+                size_t col_tile = tile % tiles_per_dim;
+                size_t k = step % tiles_per_dim;
+                int slot = step % 2;
+
+                // The tiles of a slot can be overwritten as soon as the kernel two steps before is done
+                std::vector<cl::Event> write_dependencies;
+                if (step >= 2) {
+                    write_dependencies.push_back(kernel_events[r][step - 2]);
+                }
+                err = transfer_queues[r].enqueueWriteBufferRect(a_tiles[r][slot], CL_FALSE, device_origin, host_origin(row_tile, k), region,
+                                                sizeof(HOST_DATA_TYPE) * tile_size, 0, sizeof(HOST_DATA_TYPE) * n, 0, a,
+                                                &write_dependencies, config.profiler->event("write_A"));
+                ASSERT_CL(err)
+                err = transfer_queues[r].enqueueWriteBufferRect(b_tiles[r][slot], CL_FALSE, device_origin, host_origin(k, col_tile), region,
+                                                sizeof(HOST_DATA_TYPE) * tile_size, 0, sizeof(HOST_DATA_TYPE) * n, 0, b,
+                                                nullptr, (k == 0) ? config.profiler->event("write_B") : &write_events[r][step]);
+                ASSERT_CL(err)
+                if (k == 0) {
+                    err = transfer_queues[r].enqueueWriteBufferRect(c_tiles[r][slot], CL_FALSE, device_origin, host_origin(row_tile, col_tile), region,
+                                                sizeof(HOST_DATA_TYPE) * tile_size, 0, sizeof(HOST_DATA_TYPE) * n, 0, c,
+                                                nullptr, &write_events[r][step]);
+                    ASSERT_CL(err)
+                }
+
+                // The first kernel of an output tile scales C with beta, the following kernels add to the partial result
+                ASSERT_CL(gemmkernels[r].setArg(0, a_tiles[r][slot]));
+                ASSERT_CL(gemmkernels[r].setArg(1, b_tiles[r][slot]));
+                ASSERT_CL(gemmkernels[r].setArg(2, (k == 0) ? c_tiles[r][slot] : acc_tiles[r][(k - 1) % 2]));
+                ASSERT_CL(gemmkernels[r].setArg(3, acc_tiles[r][k % 2]));
+                ASSERT_CL(gemmkernels[r].setArg(5, (k == 0) ? beta : one));
+                std::vector<cl::Event> kernel_dependencies{write_events[r][step]};
+                err = compute_queues[r].enqueueNDRangeKernel(gemmkernels[r], cl::NullRange, cl::NDRange(1), cl::NullRange,
+                                                &kernel_dependencies, &kernel_events[r][step]);
+                ASSERT_CL(err)
+                config.profiler->addEvent("gemm", kernel_events[r][step]);
+                executed_steps[r]++;
+
+                if (k == tiles_per_dim - 1) {
+                    err = compute_queues[r].enqueueReadBufferRect(acc_tiles[r][k % 2], CL_FALSE, device_origin, host_origin(row_tile, col_tile), region,
+                                                sizeof(HOST_DATA_TYPE) * tile_size, 0, sizeof(HOST_DATA_TYPE) * n, 0, c_out,
+                                                nullptr, config.profiler->event("read_C_out"));
+                    ASSERT_CL(err)
+                }
+            }
+        }
+        for (uint r = 0; r < replications; r++) {
+            ASSERT_CL(compute_queues[r].finish());
+            ASSERT_CL(transfer_queues[r].finish());
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> timespan = t2 - t1;
+        executionTimes.push_back(timespan.count());
+
+        // The device-resident time is the time the busiest replication spent in the kernel
+        double device_time = 0.0;
+        for (uint r = 0; r < replications; r++) {
+            double replication_time = 0.0;
+            for (size_t s = 0; s < executed_steps[r]; s++) {
+                replication_time += (kernel_events[r][s].getProfilingInfo<CL_PROFILING_COMMAND_END>()
+                                        - kernel_events[r][s].getProfilingInfo<CL_PROFILING_COMMAND_START>()) * 1.0e-9;
+            }
+            device_time = std::max(device_time, replication_time);
+        }
+        deviceResidentTimes.push_back(device_time);
+    }
+    config.repetitions->discardWarmup(executionTimes);
+    config.repetitions->discardWarmup(deviceResidentTimes);
+
+    std::unique_ptr<gemm::GEMMExecutionTimings> results(
+                    new gemm::GEMMExecutionTimings{executionTimes, std::vector<std::vector<double>>(), deviceResidentTimes});
+    return results;
+}
+
+}  // namespace tiled
+}  // namespace bm_execution
@@ -27,17 +27,43 @@ SOFTWARE.
 #include "gemm_benchmark.hpp"
 
 /* C++ standard library headers */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <memory>
-#include <random>
+#include <array>
 
 /* Project's headers */
 #include "execution.h"
+#include "hpcc_suite.hpp"
 #include "parameters.h"
 
 gemm::GEMMProgramSettings::GEMMProgramSettings(cxxopts::ParseResult &results) : hpcc_base::BaseSettings(results),
     matrixSize(results["b"].as<uint>() * results["m"].as<uint>()), blockSize(results["b"].as<uint>()), kernelReplications(results["r"].as<uint>()),
-    replicateInputBuffers(results["replicate-inputs"].count() > 0) {
-
+    replicateInputBuffers(results["replicate-inputs"].count() > 0), tileSize(results["tile"].as<uint>()),
+    batchSize(results["batch"].as<uint>()), chunkSize(results["chunk"].as<uint>()),
+    memoryPlacement(hpcc_base::memory_placement::retrievePolicy(results["placement"].as<std::string>())),
+    memoryBanks(results["banks"].as<uint>()),
+    sizeM(results["b"].as<uint>() * results["size-m"].as<uint>()), sizeN(results["b"].as<uint>() * results["size-n"].as<uint>()),
+    sizeK(results["b"].as<uint>() * results["size-k"].as<uint>()),
+    transposeA(results["transpose-a"].count() > 0), transposeB(results["transpose-b"].count() > 0),
+    torus_row(0), torus_col(0), torus_width(results["p"].as<uint>()), torus_height(1) {
+    if (memoryBanks == 0 || memoryBanks > hpcc_base::memory_placement::MAX_BANKS) {
+        throw std::runtime_error("Number of memory banks has to be between 1 and " + std::to_string(hpcc_base::memory_placement::MAX_BANKS) + "!");
+    }
+#ifdef _USE_MPI_
+    int mpi_comm_rank;
+    int mpi_comm_size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_comm_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_comm_size);
+    // calculate the row and column of the MPI rank in the torus
+    if (mpi_comm_size % torus_width != 0) {
+        throw std::runtime_error("MPI size not dividable by P=" + std::to_string(torus_width) + "!");
+    }
+    torus_height = mpi_comm_size / torus_width;
+    torus_row = (mpi_comm_rank / torus_width);
+    torus_col = (mpi_comm_rank % torus_width);
+#endif
 }
 
 std::map<std::string, std::string>
@@ -46,28 +72,78 @@ gemm::GEMMProgramSettings::getSettingsMap() {
         map["Matrix Size"] = std::to_string(matrixSize);
         map["Kernel Replications"] = std::to_string(kernelReplications);
         map["Replicate Inputs"] = replicateInputBuffers ? "Yes" : "No";
+        map["Tile Size"] = (tileSize > 0) ? std::to_string(tileSize * blockSize) : "disabled";
+        map["Batch Size"] = (batchSize > 0) ? std::to_string(batchSize) : "disabled";
+#ifdef USE_HBM
+        map["Memory Placement"] = "kernel attributes (HBM)";
+#else
+        map["Memory Placement"] = useMemoryInterleaving ? "interleaved" :
+                    hpcc_base::memory_placement::policyToString(memoryPlacement) + ", " + std::to_string(memoryBanks) + " banks";
+#endif
+        map["Scheduling"] = (chunkSize > 0) ? "dynamic, " + std::to_string(chunkSize) + " block rows per chunk" : "static";
+        if (!isSquare()) {
+            map["Shape (MxNxK)"] = std::to_string(getM()) + "x" + std::to_string(getN()) + "x" + std::to_string(getK())
+                                    + " op(A)=" + (transposeA ? "T" : "N") + " op(B)=" + (transposeB ? "T" : "N");
+        }
+        if (communicationType == hpcc_base::CommunicationType::pcie_mpi) {
+            map["FPGA Torus"] = "P=" + std::to_string(torus_width) + ", Q=" + std::to_string(torus_height);
+        }
         return map;
 }
 
-gemm::GEMMData::GEMMData(cl::Context context, uint size) : normtotal(0.0), alpha(0.5), beta(2.0), context(context) {
+uint
+gemm::GEMMProgramSettings::getM() const {
+    return (sizeM > 0) ? sizeM : matrixSize;
+}
+
+uint
+gemm::GEMMProgramSettings::getN() const {
+    return (sizeN > 0) ? sizeN : matrixSize;
+}
+
+uint
+gemm::GEMMProgramSettings::getK() const {
+    return (sizeK > 0) ? sizeK : matrixSize;
+}
+
+bool
+gemm::GEMMProgramSettings::isSquare() const {
+    return getM() == matrixSize && getN() == matrixSize && getK() == matrixSize && !transposeA && !transposeB;
+}
+
+gemm::GEMMData::GEMMData(cl::Context context, uint size) : GEMMData(context, size, size) {}
+
+gemm::GEMMData::GEMMData(cl::Context context, uint width, uint height) : normtotal(0.0), alpha(DEFAULT_ALPHA), beta(DEFAULT_BETA), context(context),
+    matrix_width(width), matrix_height(height) {
+    size_t size = static_cast<size_t>(width) * height;
+    allocateMatrices(size, size, size);
+}
+
+gemm::GEMMData::GEMMData(cl::Context context, uint m, uint n, uint k) : normtotal(0.0), alpha(DEFAULT_ALPHA), beta(DEFAULT_BETA), context(context),
+    matrix_width(n), matrix_height(m) {
+    allocateMatrices(static_cast<size_t>(m) * k, static_cast<size_t>(k) * n, static_cast<size_t>(m) * n);
+}
+
+void
+gemm::GEMMData::allocateMatrices(size_t a_elements, size_t b_elements, size_t c_elements) {
 #ifdef USE_SVM
     A = reinterpret_cast<HOST_DATA_TYPE*>(
                         clSVMAlloc(context(), 0 ,
-                        size * size * sizeof(HOST_DATA_TYPE), 1024));
+                        a_elements * sizeof(HOST_DATA_TYPE), 1024));
     B = reinterpret_cast<HOST_DATA_TYPE*>(
                         clSVMAlloc(context(), 0 ,
-                        size * size * sizeof(HOST_DATA_TYPE), 1024));
+                        b_elements * sizeof(HOST_DATA_TYPE), 1024));
     C = reinterpret_cast<HOST_DATA_TYPE*>(
                         clSVMAlloc(context(), 0 ,
-                        size * size * sizeof(HOST_DATA_TYPE), 1024));
+                        c_elements * sizeof(HOST_DATA_TYPE), 1024));
     C_out = reinterpret_cast<HOST_DATA_TYPE*>(
                         clSVMAlloc(context(), 0 ,
-                        size * size * sizeof(HOST_DATA_TYPE), 1024));
+                        c_elements * sizeof(HOST_DATA_TYPE), 1024));
 #else
-    posix_memalign(reinterpret_cast<void**>(&A), 4096, size * size * sizeof(HOST_DATA_TYPE));
-    posix_memalign(reinterpret_cast<void**>(&B), 4096, size * size * sizeof(HOST_DATA_TYPE));
-    posix_memalign(reinterpret_cast<void**>(&C), 4096, size * size * sizeof(HOST_DATA_TYPE));
-    posix_memalign(reinterpret_cast<void**>(&C_out), 4096, size * size * sizeof(HOST_DATA_TYPE));
+    A = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(a_elements);
+    B = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(b_elements);
+    C = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(c_elements);
+    C_out = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(c_elements);
 #endif
 }
 
@@ -78,10 +154,10 @@ gemm::GEMMData::~GEMMData() {
     clSVMFree(context(), reinterpret_cast<void**>(C));
     clSVMFree(context(), reinterpret_cast<void**>(C_out));
 #else
-    free(A);
-    free(B);
-    free(C);
-    free(C_out);
+    hpcc_base::host_memory::release(A);
+    hpcc_base::host_memory::release(B);
+    hpcc_base::host_memory::release(C);
+    hpcc_base::host_memory::release(C_out);
 #endif
 }
 
@@ -89,6 +165,11 @@ gemm::GEMMBenchmark::GEMMBenchmark(int argc, char* argv[]) : HpccFpgaBenchmark(a
     setupBenchmark(argc, argv);
 }
 
+hpcc_base::suite::BenchmarkResult
+gemm::runSuiteBenchmark(int argc, char* argv[]) {
+    return hpcc_base::suite::runBenchmark<gemm::GEMMBenchmark>(argc, argv);
+}
+
 void
 gemm::GEMMBenchmark::addAdditionalParseOptions(cxxopts::Options &options) {
     options.add_options()
@@ -96,39 +177,99 @@ gemm::GEMMBenchmark::addAdditionalParseOptions(cxxopts::Options &options) {
              cxxopts::value<cl_uint>()->default_value(std::to_string(DEFAULT_MATRIX_SIZE)))
             ("b", "Block size in number of values in one dimension",
              cxxopts::value<cl_uint>()->default_value(std::to_string(BLOCK_SIZE)))
-            ("replicate-inputs", "Also replicates the input buffer for each kernel");
+            ("replicate-inputs", "Also replicates the input buffer for each kernel")
+            ("tile", "Size of the tiles in number of blocks. The matrices are streamed through the device in tiles, "\
+             "so they do not have to fit into the device memory. 0 stores the whole matrices on the device",
+             cxxopts::value<cl_uint>()->default_value("0"))
+            ("batch", "Number of independent matrix multiplications that are calculated with a single kernel execution. "\
+             "Every matrix has the size given by m and b. 0 calculates a single matrix",
+             cxxopts::value<cl_uint>()->default_value("0"))
+            ("chunk", "Number of rows of blocks of C that are calculated by a single kernel execution. The chunks are issued to "\
+             "the kernel replication that finishes its previous chunk first. 0 calculates a fixed range of rows per replication",
+             cxxopts::value<cl_uint>()->default_value("0"))
+            ("placement", "Placement of the device buffers in the memory banks if memory interleaving is not used. "\
+             "BUFFER places every buffer of a replication in its own bank, REPLICATION all buffers of a replication in the same bank, "\
+             "STRIPED distributes the buffers of all replications round-robin over the banks and INTERLEAVED does not select a bank",
+             cxxopts::value<std::string>()->default_value("BUFFER"))
+            ("banks", "Number of memory banks the buffers are distributed over by the placement policy",
+             cxxopts::value<uint>()->default_value("4"))
+            ("size-m", "Number of rows of op(A) and C in number of blocks. 0 uses the matrix size given by m",
+             cxxopts::value<cl_uint>()->default_value("0"))
+            ("size-n", "Number of columns of op(B) and C in number of blocks. 0 uses the matrix size given by m",
+             cxxopts::value<cl_uint>()->default_value("0"))
+            ("size-k", "Size of the inner dimension of the multiplication in number of blocks. 0 uses the matrix size given by m",
+             cxxopts::value<cl_uint>()->default_value("0"))
+            ("transpose-a", "A is stored transposed, so op(A) is the transpose of A")
+            ("transpose-b", "B is stored transposed, so op(B) is the transpose of B")
+            ("p", "Width of the FPGA grid for the distributed execution with the PCIE communication type. "\
+             "The heigth (Q) will be calculated from mpi_size / P.",
+             cxxopts::value<cl_uint>()->default_value("1"));
 }
 
 std::unique_ptr<gemm::GEMMExecutionTimings>
 gemm::GEMMBenchmark::executeKernel(GEMMData &data) {
-    return bm_execution::calculate(*executionSettings, data.A, data.B, data.C, data.C_out, data.alpha, data.beta);
+    switch (executionSettings->programSettings->communicationType) {
+        case hpcc_base::CommunicationType::cpu_only: return bm_execution::cpu::calculate(*executionSettings, data.A, data.B, data.C, data.C_out, data.alpha, data.beta);
+        case hpcc_base::CommunicationType::unsupported:
+            if (executionSettings->programSettings->tileSize > 0) {
+                return bm_execution::tiled::calculate(*executionSettings, data.A, data.B, data.C, data.C_out, data.alpha, data.beta);
+            }
+            if (executionSettings->programSettings->batchSize > 0) {
+                return bm_execution::batched::calculate(*executionSettings, data.A, data.B, data.C, data.C_out, data.alpha, data.beta);
+            }
+            return bm_execution::calculate(*executionSettings, data.A, data.B, data.C, data.C_out, data.alpha, data.beta);
+        case hpcc_base::CommunicationType::pcie_mpi: return bm_execution::pcie::calculate(*executionSettings, data.A, data.B, data.C, data.C_out, data.alpha, data.beta);
+        default: throw std::runtime_error("Selected Communication type not supported: " + hpcc_base::commToString(executionSettings->programSettings->communicationType));
+    }
 }
 
 void
 gemm::GEMMBenchmark::collectAndPrintResults(const gemm::GEMMExecutionTimings &output) {
 
+    rawTimings["execution"] = output.timings;
+
+    // In the distributed execution, all ranks calculate a single matrix multiplication, so the slowest rank defines the runtime.
+    // Otherwise, every rank calculates its own matrix multiplication.
+    bool distributed = executionSettings->programSettings->communicationType == hpcc_base::CommunicationType::pcie_mpi;
+    double independent_multiplications = distributed ? 1.0 : mpi_comm_size;
+
     uint number_measurements = output.timings.size();
     std::vector<double> avg_measures(number_measurements);
 #ifdef _USE_MPI_
     // Copy the object variable to a local variable to make it accessible to the lambda function
     int mpi_size = mpi_comm_size;
-    MPI_Reduce(output.timings.data(), avg_measures.data(), number_measurements, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
-    std::for_each(avg_measures.begin(),avg_measures.end(), [mpi_size](double& x) {x /= mpi_size;});
+    if (distributed) {
+        MPI_Reduce(output.timings.data(), avg_measures.data(), number_measurements, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    }
+    else {
+        MPI_Reduce(output.timings.data(), avg_measures.data(), number_measurements, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        std::for_each(avg_measures.begin(),avg_measures.end(), [mpi_size](double& x) {x /= mpi_size;});
+    }
 #else
     std::copy(output.timings.begin(), output.timings.end(), avg_measures.begin());
 #endif
     if (mpi_comm_rank == 0) {
         std::cout << std::setw(ENTRY_SPACE)
                 << "best" << std::setw(ENTRY_SPACE) << "mean"
-                << std::setw(ENTRY_SPACE) << "GFLOPS" << std::endl;
+                << std::setw(ENTRY_SPACE) << "GFLOPS" << std::setw(ENTRY_SPACE) << "Mem [B/s]" << std::endl;
 
         // Calculate performance for kernel execution
         double tmean = 0;
         double tmin = std::numeric_limits<double>::max();
 
-        double gflops = mpi_comm_size * 2.0 * (static_cast<double>(executionSettings->programSettings->matrixSize)
-                            *static_cast<double>(executionSettings->programSettings->matrixSize)
-                            *static_cast<double>(executionSettings->programSettings->matrixSize))/1.0e9;
+        // In the batched execution, every rank calculates all matrices of the batch
+        double batch_matrices = std::max(1u, executionSettings->programSettings->batchSize);
+        double gflops = independent_multiplications * batch_matrices * 2.0 * (static_cast<double>(executionSettings->programSettings->getM())
+                            *static_cast<double>(executionSettings->programSettings->getN())
+                            *static_cast<double>(executionSettings->programSettings->getK()))/1.0e9;
+        // For every block of C, the kernel loads a row of blocks of op(A) and a column of blocks of op(B) from global memory.
+        // Additionally, C is read and the result is written once.
+        double global_memory_bytes = independent_multiplications * batch_matrices * sizeof(HOST_DATA_TYPE)
+                            * (2.0 * static_cast<double>(executionSettings->programSettings->getM())
+                                    * static_cast<double>(executionSettings->programSettings->getN())
+                                    * static_cast<double>(executionSettings->programSettings->getK()) / executionSettings->programSettings->blockSize
+                                + 2.0 * static_cast<double>(executionSettings->programSettings->getM())
+                                    * static_cast<double>(executionSettings->programSettings->getN()));
         for (double currentTime : avg_measures) {
             tmean +=  currentTime;
             if (currentTime < tmin) {
@@ -137,57 +278,582 @@ gemm::GEMMBenchmark::collectAndPrintResults(const gemm::GEMMExecutionTimings &ou
         }
         tmean = tmean / avg_measures.size();
 
+        derivedMetrics["best [s]"] = tmin;
+        derivedMetrics["mean [s]"] = tmean;
+        derivedMetrics["GFLOPS"] = gflops / tmin;
+        derivedMetrics["Mem [B/s]"] = global_memory_bytes / tmin;
+
         std::cout << std::setw(ENTRY_SPACE)
                 << tmin << std::setw(ENTRY_SPACE) << tmean
                 << std::setw(ENTRY_SPACE) << gflops / tmin
+                << std::setw(ENTRY_SPACE) << global_memory_bytes / tmin
                 << std::endl;
+        if (executionSettings->programSettings->batchSize > 0) {
+            // The kernel replications calculate their ranges of the batch in parallel, so the latency of a single
+            // matrix is given by the number of matrices calculated by a single replication
+            double matrices_per_kernel = std::ceil(batch_matrices / executionSettings->programSettings->kernelReplications);
+            derivedMetrics["matrix latency [s]"] = tmin / matrices_per_kernel;
+            std::cout << "Latency per matrix: " << tmin / matrices_per_kernel << " s" << std::endl;
+        }
+        printTimingStatistics({{"execution", avg_measures}});
+        printDeviceResults("execution", output.deviceTimings, gflops / independent_multiplications, "GFLOPS");
+        // The register GEMM of every kernel replication calculates GEMM_BLOCK^3 multiply-add operations per cycle
+        hpcc_base::Roofline roofline{mpi_comm_size * executionSettings->programSettings->kernelReplications * 2.0 * GEMM_BLOCK * GEMM_BLOCK * GEMM_BLOCK * getKernelFrequency(),
+                                    mpi_comm_size * getMemoryPeak(), global_memory_bytes / (gflops * 1.0e9)};
+        printEfficiency({{"execution", {gflops / tmin, roofline}}}, "GFLOPS", 1.0e-9);
+    }
+
+    if (!output.deviceResidentTimings.empty()) {
+        // For the tiled execution, the timings above contain the transfers of the tiles.
+        // Additionally report the performance of the kernel executions only.
+        rawTimings["device-resident"] = output.deviceResidentTimings;
+        std::vector<double> avg_device(output.deviceResidentTimings.size());
+#ifdef _USE_MPI_
+        MPI_Reduce(output.deviceResidentTimings.data(), avg_device.data(), avg_device.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        std::for_each(avg_device.begin(),avg_device.end(), [mpi_size](double& x) {x /= mpi_size;});
+#else
+        std::copy(output.deviceResidentTimings.begin(), output.deviceResidentTimings.end(), avg_device.begin());
+#endif
+        if (mpi_comm_rank == 0) {
+            double gflops = mpi_comm_size * 2.0 * (static_cast<double>(executionSettings->programSettings->matrixSize)
+                                *static_cast<double>(executionSettings->programSettings->matrixSize)
+                                *static_cast<double>(executionSettings->programSettings->matrixSize))/1.0e9;
+            double tmin = *std::min_element(avg_device.begin(), avg_device.end());
+            derivedMetrics["device-resident best [s]"] = tmin;
+            derivedMetrics["device-resident GFLOPS"] = gflops / tmin;
+            std::cout << "Device-resident (kernel executions only):" << std::endl;
+            std::cout << std::setw(ENTRY_SPACE) << tmin << std::setw(ENTRY_SPACE) << ""
+                    << std::setw(ENTRY_SPACE) << gflops / tmin << std::endl;
+        }
+    }
+
+    if (!output.replicationUtilization.empty()) {
+        // Report the mean utilization and share of the rows of every kernel replication over all ranks and repetitions,
+        // so an imbalance between the replications becomes visible
+        uint replications = output.replicationUtilization.size();
+        std::vector<double> replication_means(2 * replications);
+        for (uint r = 0; r < replications; r++) {
+            for (size_t m = 0; m < output.replicationUtilization[r].size(); m++) {
+                replication_means[r] += output.replicationUtilization[r][m] / output.replicationUtilization[r].size();
+                replication_means[replications + r] += output.replicationBlockRows[r][m] / output.replicationBlockRows[r].size();
+            }
+        }
+#ifdef _USE_MPI_
+        std::vector<double> local_means(replication_means);
+        MPI_Reduce(local_means.data(), replication_means.data(), replication_means.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        std::for_each(replication_means.begin(),replication_means.end(), [mpi_size](double& x) {x /= mpi_size;});
+#endif
+        if (mpi_comm_rank == 0) {
+            std::cout << std::setw(ENTRY_SPACE) << "replication" << std::setw(ENTRY_SPACE) << "utilization"
+                    << std::setw(ENTRY_SPACE) << "block rows" << std::endl;
+            for (uint r = 0; r < replications; r++) {
+                derivedMetrics["utilization replication " + std::to_string(r)] = replication_means[r];
+                derivedMetrics["block rows replication " + std::to_string(r)] = replication_means[replications + r];
+                std::cout << std::setw(ENTRY_SPACE) << r << std::setw(ENTRY_SPACE) << replication_means[r]
+                        << std::setw(ENTRY_SPACE) << replication_means[replications + r] << std::endl;
+            }
+        }
+    }
+}
+
+bool
+gemm::GEMMBenchmark::checkInputParameters() {
+    bool validationResult = true;
+    if (executionSettings->programSettings->tileSize > 0 &&
+            (executionSettings->programSettings->matrixSize % (executionSettings->programSettings->tileSize * executionSettings->programSettings->blockSize)) != 0) {
+        std::cerr << "ERROR: The matrix size has to be a multiple of the tile size!" << std::endl;
+        validationResult = false;
+    }
+    if ((executionSettings->programSettings->getM() % executionSettings->programSettings->blockSize) != 0 ||
+            (executionSettings->programSettings->getN() % executionSettings->programSettings->blockSize) != 0 ||
+            (executionSettings->programSettings->getK() % executionSettings->programSettings->blockSize) != 0) {
+        std::cerr << "ERROR: The matrix sizes have to be a multiple of the block size!" << std::endl;
+        validationResult = false;
+    }
+    if (!executionSettings->programSettings->isSquare() &&
+            (executionSettings->programSettings->tileSize > 0 || executionSettings->programSettings->batchSize > 0 ||
+                executionSettings->programSettings->communicationType == hpcc_base::CommunicationType::pcie_mpi)) {
+        std::cerr << "ERROR: Rectangular or transposed matrices are not supported by the tiled, batched and distributed execution!" << std::endl;
+        validationResult = false;
+    }
+    if (executionSettings->programSettings->batchSize > 0 &&
+            (executionSettings->programSettings->tileSize > 0 ||
+                executionSettings->programSettings->communicationType != hpcc_base::CommunicationType::unsupported)) {
+        std::cerr << "ERROR: The batched execution can not be combined with the tiled execution or another communication type!" << std::endl;
+        validationResult = false;
+    }
+    if (executionSettings->programSettings->chunkSize > 0 &&
+            (executionSettings->programSettings->tileSize > 0 || executionSettings->programSettings->batchSize > 0 ||
+                executionSettings->programSettings->communicationType != hpcc_base::CommunicationType::unsupported)) {
+        std::cerr << "ERROR: The dynamic scheduling can not be combined with the tiled or batched execution or another communication type!" << std::endl;
+        validationResult = false;
+    }
+    if (executionSettings->programSettings->communicationType == hpcc_base::CommunicationType::pcie_mpi) {
+        uint tile_size = bm_execution::pcie::gridTileSize(executionSettings->programSettings->matrixSize,
+                                executionSettings->programSettings->torus_width, executionSettings->programSettings->torus_height);
+        if (tile_size == 0 || (tile_size % executionSettings->programSettings->blockSize) != 0 ||
+                (executionSettings->programSettings->matrixSize % tile_size) != 0) {
+            std::cerr << "ERROR: The matrix size in blocks has to be a multiple of the least common multiple of P and Q!" << std::endl;
+            validationResult = false;
+        }
+        if (executionSettings->programSettings->tileSize > 0) {
+            std::cerr << "ERROR: The tiled execution can not be combined with the PCIE communication type!" << std::endl;
+            validationResult = false;
+        }
+    }
+    return validationResult;
+}
+
+bool
+gemm::GEMMBenchmark::setAutomaticSize(hpcc_base::MemoryLimits const& limits) {
+    auto& settings = *executionSettings->programSettings;
+    if (!settings.isSquare() || settings.tileSize > 0
+            || settings.communicationType != hpcc_base::CommunicationType::unsupported) {
+        return false;
+    }
+    double matrices;
+    double matrices_per_buffer;
+    if (settings.batchSize > 0) {
+        // Every replication stores A, B, C and the result for its range of the batch
+        double matrices_per_kernel = std::ceil(static_cast<double>(settings.batchSize) / settings.kernelReplications);
+        matrices = 4.0 * matrices_per_kernel * settings.kernelReplications;
+        matrices_per_buffer = matrices_per_kernel;
+    }
+    else {
+        // With dynamic scheduling, every replication needs an output buffer of the size of C
+        double inputs = settings.replicateInputBuffers ? 3.0 * settings.kernelReplications : 3.0;
+        matrices = inputs + ((settings.chunkSize > 0) ? settings.kernelReplications : 1.0);
+        matrices_per_buffer = 1.0;
+    }
+    double max_elements = std::min(limits.totalMemory / matrices, limits.maxBufferSize / matrices_per_buffer) / sizeof(HOST_DATA_TYPE);
+    uint64_t size = hpcc_base::largestMultiple(std::sqrt(max_elements), settings.blockSize);
+    if (size == 0) {
+        return false;
+    }
+    settings.matrixSize = static_cast<uint>(size);
+    return true;
+}
+
+namespace {
+
+/**
+ * @brief Seed of the counter-based generator used for the input matrices
+ */
+const uint64_t input_seed = 7;
+
+#ifdef ENABLE_BFLOAT16
+/**
+ * @brief Round a single precision value to the nearest value that is representable in bfloat16
+ * 
+ * @param value The single precision value
+ * @return float The rounded value. Only the upper 16 bits are set.
+ */
+inline float
+roundToBfloat16(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    // Round to nearest even by adding half of the cut off range
+    bits = (bits + 0x7fffu + ((bits >> 16) & 1u)) & 0xffff0000u;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+#endif
+
+/**
+ * @brief Generate a value of the input matrices with the counter-based generator.
+ *          A, B and C use different random numbers of the same counter.
+ * 
+ * @param bits The random numbers for the position of the value
+ * @param matrix 0 for A, 1 for B and 2 for C
+ * @return HOST_DATA_TYPE The value in [-1, 1). For int8 an integer in [-128, 127].
+ */
+inline HOST_DATA_TYPE
+inputValue(std::array<uint32_t, 4> const& bits, int matrix) {
+#ifdef ENABLE_INT8
+    return static_cast<HOST_DATA_TYPE>(static_cast<int8_t>(bits[matrix] >> 24));
+#elif defined(ENABLE_BFLOAT16)
+    // A and B are converted to bfloat16 on the device
+    float value = hpcc_base::rng::toUniformSigned(bits[matrix]);
+    return (matrix < 2) ? roundToBfloat16(value) : value;
+#else
+    return OPTIONAL_CAST(hpcc_base::rng::toUniformSigned(bits[matrix]));
+#endif
+}
+
+/**
+ * @brief Get the machine epsilon of the calculation that is used to normalize the residuals.
+ *          The integer calculation has to be exact, so the epsilon is 0 in this case.
+ * 
+ * @return double The machine epsilon
+ */
+inline double
+validationEpsilon() {
+    return std::numeric_limits<HOST_DATA_TYPE>::epsilon();
+}
+
+/**
+ * @brief Normalize the residual of the validation
+ * 
+ * @param resid The residual
+ * @param scale The maximum residual that is expected for an epsilon of 1
+ * @return double The normalized residual, which is below 1 for a correct result
+ */
+inline double
+normalizeResidual(double resid, double scale) {
+    // Prevents the division by zero for exact results, which are always expected for integers
+    return (resid == 0.0) ? 0.0 : resid / (scale * validationEpsilon());
+}
+
+/**
+ * @brief Fill the local part of the input matrices. Every value is calculated from its position in the global matrices,
+ *          so the values do not depend on the distribution of the matrices over the ranks or the number of threads.
+ * 
+ * @param d The data object with the local matrices
+ * @param n Size of the global matrices
+ * @param row_offset First row of the global matrices that is stored in the local matrices
+ * @param col_offset First column of the global matrices that is stored in the local matrices
+ */
+void
+fillInputMatrices(gemm::GEMMData &d, uint n, uint row_offset, uint col_offset) {
+    double normtotal = 0.0;
+    #pragma omp parallel for reduction(max:normtotal)
+    for (int i = 0; i < static_cast<int>(d.matrix_height); i++) {
+        for (uint j = 0; j < d.matrix_width; j++) {
+            auto bits = hpcc_base::rng::randomBits(static_cast<uint64_t>(row_offset + i) * n + col_offset + j, input_seed);
+            size_t index = static_cast<size_t>(i) * d.matrix_width + j;
+            d.A[index] = inputValue(bits, 0);
+            d.B[index] = inputValue(bits, 1);
+            d.C[index] = inputValue(bits, 2);
+            d.C_out[index] = OPTIONAL_CAST(0.0);
+            normtotal = std::max(normtotal, static_cast<double>(std::max(std::max(d.A[index], d.B[index]), d.C[index])));
+        }
     }
+    d.normtotal = OPTIONAL_CAST(normtotal);
+}
+
+/**
+ * @brief Fill a single rectangular input matrix. This is used if the matrices have different shapes,
+ *          so the values can not be generated with a single loop for all matrices.
+ * 
+ * @param values Array for the values of the matrix
+ * @param rows Number of rows of the matrix
+ * @param cols Number of columns of the matrix
+ * @param row_offset First row of the generated values. The matrices of a batch are stored as consecutive rows.
+ * @param matrix 0 for A, 1 for B and 2 for C
+ * @return double The maximum generated value
+ */
+double
+fillMatrix(HOST_DATA_TYPE* values, uint rows, uint cols, uint row_offset, int matrix) {
+    double max_value = 0.0;
+    #pragma omp parallel for reduction(max:max_value)
+    for (int i = 0; i < static_cast<int>(rows); i++) {
+        for (uint j = 0; j < cols; j++) {
+            size_t index = static_cast<size_t>(i) * cols + j;
+            values[index] = inputValue(hpcc_base::rng::randomBits(static_cast<uint64_t>(row_offset + i) * cols + j, input_seed), matrix);
+            max_value = std::max(max_value, static_cast<double>(values[index]));
+        }
+    }
+    return max_value;
+}
+
+/**
+ * @brief Fill the rectangular input matrices of the given shape
+ * 
+ * @param d The data object with the matrices
+ * @param settings The settings containing the shape of the multiplication
+ */
+void
+fillRectangularMatrices(gemm::GEMMData &d, gemm::GEMMProgramSettings const& settings) {
+    uint m = settings.getM();
+    uint n = settings.getN();
+    uint k = settings.getK();
+    // Transposed matrices are stored with swapped dimensions
+    double normtotal = fillMatrix(d.A, settings.transposeA ? k : m, settings.transposeA ? m : k, 0, 0);
+    normtotal = std::max(normtotal, fillMatrix(d.B, settings.transposeB ? n : k, settings.transposeB ? k : n, 0, 1));
+    normtotal = std::max(normtotal, fillMatrix(d.C, m, n, 0, 2));
+    std::fill(d.C_out, d.C_out + static_cast<size_t>(m) * n, OPTIONAL_CAST(0.0));
+    d.normtotal = OPTIONAL_CAST(normtotal);
+}
+
+/**
+ * @brief Regenerate the input matrix C. This is the only input matrix that is overwritten by the reference implementation.
+ * 
+ * @param c Array for the values of C
+ * @param rows Number of rows of the matrix
+ * @param cols Number of columns of the matrix
+ * @param row_offset First row of the generated matrix. The matrices of a batch are stored as consecutive rows.
+ */
+void
+generateMatrixC(HOST_DATA_TYPE* c, uint rows, uint cols, uint row_offset) {
+    fillMatrix(c, rows, cols, row_offset, 2);
+}
+
+/**
+ * @brief Check C_out = alpha * op(A) * op(B) + beta * C with the algorithm of Freivalds.
+ *          A and B are accessed with functions, so their values can also be regenerated instead of being read from memory.
+ * 
+ * @tparam TA Function returning the value of op(A) in row i and column p as double
+ * @tparam TB Function returning the value of op(B) in row p and column j as double
+ * @param a_value Access to op(A)
+ * @param b_value Access to op(B)
+ * @param c The matrix C with m x n values
+ * @param c_out The calculated result that should be checked
+ * @param m Number of rows of op(A) and C
+ * @param n Number of columns of op(B) and C
+ * @param k Number of columns of op(A) and rows of op(B)
+ * @param alpha Scalar value used to scale op(A) * op(B)
+ * @param beta Scalar value used to scale C
+ * @param errorBound Maximum probability that a wrong result is not detected
+ * @return double The maximum normalized residual
+ */
+template<typename TA, typename TB>
+double
+freivaldsResidual(TA a_value, TB b_value, HOST_DATA_TYPE const* c, HOST_DATA_TYPE const* c_out, int m, int n, int k,
+                    HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta, double errorBound) {
+    std::vector<double> vectors = hpcc_base::validation::freivaldsVectors(errorBound, n, 7);
+    const int trials = vectors.size() / n;
+    // Interleave the random vectors, so the inner loops over the trials access contiguous memory
+    std::vector<double> x(vectors.size());
+    for (int t = 0; t < trials; t++) {
+        for (int j = 0; j < n; j++) {
+            x[static_cast<size_t>(j) * trials + t] = vectors[static_cast<size_t>(t) * n + j];
+        }
+    }
+    const double alpha_d = static_cast<double>(alpha);
+    const double beta_d = static_cast<double>(beta);
+    const double eps = validationEpsilon();
+
+    // Products of op(B) with all random vectors and absolute row sums of op(B)
+    std::vector<double> bx(static_cast<size_t>(k) * trials, 0.0);
+    std::vector<double> b_row_abs(k, 0.0);
+    #pragma omp parallel for
+    for (int p = 0; p < k; p++) {
+        double* bx_p = &bx[static_cast<size_t>(p) * trials];
+        for (int j = 0; j < n; j++) {
+            double b_pj = b_value(p, j);
+            b_row_abs[p] += std::abs(b_pj);
+            double const* x_j = &x[static_cast<size_t>(j) * trials];
+            #pragma omp simd
+            for (int t = 0; t < trials; t++) {
+                bx_p[t] += b_pj * x_j[t];
+            }
+        }
+    }
+
+    double max_residn = 0.0;
+    #pragma omp parallel for reduction(max:max_residn)
+    for (int i = 0; i < m; i++) {
+        std::vector<double> abx(trials, 0.0);
+        std::vector<double> cx(trials, 0.0);
+        std::vector<double> outx(trials, 0.0);
+        // Sum of the absolute values of all terms that are added up to calculate a value of row i
+        double row_bound = 0.0;
+        for (int p = 0; p < k; p++) {
+            double a_ip = a_value(i, p);
+            row_bound += std::abs(alpha_d * a_ip) * b_row_abs[p];
+            double const* bx_p = &bx[static_cast<size_t>(p) * trials];
+            #pragma omp simd
+            for (int t = 0; t < trials; t++) {
+                abx[t] += a_ip * bx_p[t];
+            }
+        }
+        for (int j = 0; j < n; j++) {
+            double c_ij = static_cast<double>(c[static_cast<size_t>(i) * n + j]);
+            double out_ij = static_cast<double>(c_out[static_cast<size_t>(i) * n + j]);
+            row_bound += std::abs(beta_d * c_ij);
+            double const* x_j = &x[static_cast<size_t>(j) * trials];
+            #pragma omp simd
+            for (int t = 0; t < trials; t++) {
+                cx[t] += c_ij * x_j[t];
+                outx[t] += out_ij * x_j[t];
+            }
+        }
+        // Probabilistic bound of the rounding error of the dot products, which grows with sqrt(n) instead of n
+        double tolerance = std::sqrt(static_cast<double>(std::max(n, k))) * eps * row_bound + std::numeric_limits<double>::min();
+        for (int t = 0; t < trials; t++) {
+            max_residn = std::max(max_residn, std::abs(outx[t] - alpha_d * abx[t] - beta_d * cx[t]) / tolerance);
+        }
+    }
+    return max_residn;
+}
+
 }
 
 std::unique_ptr<gemm::GEMMData>
 gemm::GEMMBenchmark::generateInputData() {
-    auto d = std::unique_ptr<gemm::GEMMData>(new gemm::GEMMData(*executionSettings->context, executionSettings->programSettings->matrixSize));
-    std::mt19937 gen(7);
-    std::uniform_real_distribution<> dis(-1.0, 1.0);
-    for (int j = 0; j < executionSettings->programSettings->matrixSize; j++) {
-        for (int i = 0; i < executionSettings->programSettings->matrixSize; i++) {
-            d->A[executionSettings->programSettings->matrixSize*i+j] = OPTIONAL_CAST(static_cast<double>(dis(gen)));
-            d->B[executionSettings->programSettings->matrixSize*i+j] = OPTIONAL_CAST(static_cast<double>(dis(gen)));
-            d->C[executionSettings->programSettings->matrixSize*i+j] = OPTIONAL_CAST(static_cast<double>(dis(gen)));
-            d->C_out[executionSettings->programSettings->matrixSize*i+j] = OPTIONAL_CAST(0.0);
-            d->normtotal = std::max(std::max(d->normtotal, d->A[executionSettings->programSettings->matrixSize*i+j]), 
-                                        std::max(d->B[executionSettings->programSettings->matrixSize*i+j], 
-                                        d->C[executionSettings->programSettings->matrixSize*i+j]));
-        }
+    uint n = executionSettings->programSettings->matrixSize;
+    std::unique_ptr<gemm::GEMMData> d;
+    if (executionSettings->programSettings->communicationType == hpcc_base::CommunicationType::pcie_mpi) {
+        // Every rank only stores its block of the matrices distributed over the torus
+        uint width = n / executionSettings->programSettings->torus_width;
+        uint height = n / executionSettings->programSettings->torus_height;
+        d = std::unique_ptr<gemm::GEMMData>(new gemm::GEMMData(*executionSettings->context, width, height));
+        fillInputMatrices(*d, n, executionSettings->programSettings->torus_row * height, executionSettings->programSettings->torus_col * width);
+    }
+    else if (!executionSettings->programSettings->isSquare()) {
+        d = std::unique_ptr<gemm::GEMMData>(new gemm::GEMMData(*executionSettings->context, executionSettings->programSettings->getM(),
+                                            executionSettings->programSettings->getN(), executionSettings->programSettings->getK()));
+        fillRectangularMatrices(*d, *executionSettings->programSettings);
+    }
+    else {
+        // The matrices of a batch are stored consecutively, so they are generated like a single matrix with more rows
+        uint matrices = std::max(1u, executionSettings->programSettings->batchSize);
+        d = std::unique_ptr<gemm::GEMMData>(new gemm::GEMMData(*executionSettings->context, n, n * matrices));
+        fillInputMatrices(*d, n, 0, 0);
     }
     return d;
 }
 
+std::unique_ptr<gemm::GEMMData>
+gemm::GEMMBenchmark::gatherGlobalData(gemm::GEMMData &data) {
+    uint n = executionSettings->programSettings->matrixSize;
+    size_t local_size = static_cast<size_t>(data.matrix_width) * data.matrix_height;
+    std::unique_ptr<gemm::GEMMData> global_data;
+    std::vector<HOST_DATA_TYPE> gathered;
+    if (mpi_comm_rank == 0) {
+        global_data = std::unique_ptr<gemm::GEMMData>(new gemm::GEMMData(*executionSettings->context, n));
+        fillInputMatrices(*global_data, n, 0, 0);
+        gathered.resize(local_size * mpi_comm_size);
+    }
+#ifdef _USE_MPI_
+    // Gather the blocks row-wise with a derived datatype, so the count does not overflow for large blocks
+    MPI_Datatype matrix_row;
+    MPI_Type_contiguous(static_cast<int>(sizeof(HOST_DATA_TYPE) * data.matrix_width), MPI_BYTE, &matrix_row);
+    MPI_Type_commit(&matrix_row);
+    MPI_Gather(data.C_out, static_cast<int>(data.matrix_height), matrix_row,
+                gathered.data(), static_cast<int>(data.matrix_height), matrix_row, 0, MPI_COMM_WORLD);
+    MPI_Type_free(&matrix_row);
+#else
+    std::copy(data.C_out, data.C_out + local_size, gathered.begin());
+#endif
+    if (mpi_comm_rank == 0) {
+        // Copy the blocks of all ranks to their position in the global matrix
+        for (int rank = 0; rank < mpi_comm_size; rank++) {
+            size_t row_offset = static_cast<size_t>(rank / executionSettings->programSettings->torus_width) * data.matrix_height;
+            size_t col_offset = static_cast<size_t>(rank % executionSettings->programSettings->torus_width) * data.matrix_width;
+            for (size_t i = 0; i < data.matrix_height; i++) {
+                std::copy(&gathered[rank * local_size + i * data.matrix_width], &gathered[rank * local_size + (i + 1) * data.matrix_width],
+                            &global_data->C_out[(row_offset + i) * n + col_offset]);
+            }
+        }
+    }
+    return global_data;
+}
+
+bool
+gemm::GEMMBenchmark::validateDistributedSampled(gemm::GEMMData &data) {
+    const uint n = executionSettings->programSettings->matrixSize;
+    const uint row_offset = executionSettings->programSettings->torus_row * data.matrix_height;
+    const uint col_offset = executionSettings->programSettings->torus_col * data.matrix_width;
+    // The local block of C only depends on the rows of A and the columns of B of the rank.
+    // They are regenerated from their global position, so only the local block of C is needed on every rank.
+    auto a_value = [n, row_offset](int i, int p) {
+        return static_cast<double>(inputValue(hpcc_base::rng::randomBits(static_cast<uint64_t>(row_offset + i) * n + p, input_seed), 0));
+    };
+    auto b_value = [n, col_offset](int p, int j) {
+        return static_cast<double>(inputValue(hpcc_base::rng::randomBits(static_cast<uint64_t>(p) * n + col_offset + j, input_seed), 1));
+    };
+    double residn = freivaldsResidual(a_value, b_value, data.C, data.C_out, data.matrix_height, data.matrix_width, n,
+                                        data.alpha, data.beta, executionSettings->programSettings->validationErrorBound);
+#ifdef _USE_MPI_
+    double max_residn = 0.0;
+    MPI_Reduce(&residn, &max_residn, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    residn = max_residn;
+#endif
+    if (mpi_comm_rank == 0) {
+        std::cout << "  norm. resid        Freivalds trials" << std::endl;
+        std::cout << std::setw(ENTRY_SPACE) << residn << std::setw(ENTRY_SPACE)
+                << hpcc_base::validation::freivaldsTrials(executionSettings->programSettings->validationErrorBound)
+                << std::endl;
+        return residn < 1.0;
+    }
+    return true;
+}
+
 bool  
 gemm::GEMMBenchmark::validateOutputAndPrintError(gemm::GEMMData &data) {
-    auto ref_data = generateInputData();
+    bool distributed = executionSettings->programSettings->communicationType == hpcc_base::CommunicationType::pcie_mpi;
+    if (distributed && executionSettings->programSettings->validationMode == hpcc_base::ValidationMode::sampled) {
+        return validateDistributedSampled(data);
+    }
+    gemm::GEMMData* validation_data = &data;
+    std::unique_ptr<gemm::GEMMData> global_data;
+    if (distributed) {
+        // The distributed matrices are validated on rank 0 only
+        global_data = gatherGlobalData(data);
+        if (mpi_comm_rank != 0) {
+            return true;
+        }
+        validation_data = global_data.get();
+    }
 
-    gemm_ref(ref_data->A, ref_data->B, ref_data->C, executionSettings->programSettings->matrixSize, OPTIONAL_CAST(0.5), OPTIONAL_CAST(2.0));
+    uint m = executionSettings->programSettings->getM();
+    uint n = executionSettings->programSettings->getN();
+    uint k = executionSettings->programSettings->getK();
+    bool transpose_a = executionSettings->programSettings->transposeA;
+    bool transpose_b = executionSettings->programSettings->transposeB;
+    size_t a_elements = static_cast<size_t>(m) * k;
+    size_t b_elements = static_cast<size_t>(k) * n;
+    size_t matrix_elements = static_cast<size_t>(m) * n;
+    // Validate every matrix of a batch on its own
+    uint matrices = distributed ? 1 : std::max(1u, executionSettings->programSettings->batchSize);
+
+    if (executionSettings->programSettings->validationMode == hpcc_base::ValidationMode::sampled) {
+        double residn = 0.0;
+        for (uint matrix = 0; matrix < matrices; matrix++) {
+            size_t offset = matrix * matrix_elements;
+            residn = std::max(residn, freivalds_residual(&validation_data->A[matrix * a_elements], &validation_data->B[matrix * b_elements],
+                                            &validation_data->C[offset], &validation_data->C_out[offset], m, n, k, transpose_a, transpose_b,
+                                            data.alpha, data.beta, executionSettings->programSettings->validationErrorBound));
+        }
+#ifdef _USE_MPI_
+        double max_residn = 0.0;
+        MPI_Reduce(&residn, &max_residn, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+        residn = max_residn;
+#endif
+        if (mpi_comm_rank == 0) {
+            std::cout << "  norm. resid        Freivalds trials" << std::endl;
+            std::cout << std::setw(ENTRY_SPACE) << residn << std::setw(ENTRY_SPACE)
+                    << hpcc_base::validation::freivaldsTrials(executionSettings->programSettings->validationErrorBound)
+                    << std::endl;
+            return residn < 1.0;
+        }
+        return true;
+    }
+
+    // The kernel does not modify A and B, so only C has to be regenerated for the reference implementation
+    std::unique_ptr<HOST_DATA_TYPE[]> c_ref(new HOST_DATA_TYPE[matrix_elements]);
 
     double resid = OPTIONAL_CAST(0.0);
     double normx = OPTIONAL_CAST(0.0);
 
-    for (int i = 0; i < executionSettings->programSettings->matrixSize * executionSettings->programSettings->matrixSize; i++) {
-        resid = (resid > fabs(data.C_out[i] - ref_data->C[i])) ? resid : fabs(data.C_out[i] - ref_data->C[i]);
-        normx = (normx > fabs(data.C_out[i])) ? normx : fabs(data.C_out[i]);
+    for (uint matrix = 0; matrix < matrices; matrix++) {
+        size_t offset = matrix * matrix_elements;
+        generateMatrixC(c_ref.get(), m, n, matrix * m);
+
+        gemm_ref(&validation_data->A[matrix * a_elements], &validation_data->B[matrix * b_elements], c_ref.get(), m, n, k,
+                    transpose_a, transpose_b, data.alpha, data.beta);
+
+        HOST_DATA_TYPE* c_out = &validation_data->C_out[offset];
+        for (size_t i = 0; i < matrix_elements; i++) {
+            resid = (resid > fabs(c_out[i] - c_ref[i])) ? resid : fabs(c_out[i] - c_ref[i]);
+            normx = (normx > fabs(c_out[i])) ? normx : fabs(c_out[i]);
+        }
     }
 
 #ifdef _USE_MPI_
-    double max_resid = 0.0;
-    MPI_Reduce(&resid, &max_resid, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
-    resid = max_resid;
+    if (!distributed) {
+        double max_resid = 0.0;
+        MPI_Reduce(&resid, &max_resid, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+        resid = max_resid;
+    }
 #endif
 
     // Calculate the overall error only on rank 0
     if (mpi_comm_rank == 0) {
         // Calculate the residual error normalized to the total matrix size, input values and machine epsilon
-        double eps = std::numeric_limits<HOST_DATA_TYPE>::epsilon();
-        double residn = resid / (executionSettings->programSettings->matrixSize*executionSettings->programSettings->matrixSize*ref_data->normtotal*normx*eps);
+        double eps = validationEpsilon();
+        double residn = normalizeResidual(resid, static_cast<double>(matrix_elements)*validation_data->normtotal*normx);
 
         std::cout << "  norm. resid        resid       "\
                     "machep" << std::endl;
@@ -202,72 +868,296 @@ gemm::GEMMBenchmark::validateOutputAndPrintError(gemm::GEMMData &data) {
     return true;
 }
 
-void 
-gemm::gemm_ref(HOST_DATA_TYPE* a,HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
-                                int n, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta) {
-#ifdef _USE_BLAS_
-    char ta = 'N';
-    char tb = 'N';
-#endif
-#if (defined(_USE_BLAS_) && DATA_TYPE_SIZE == 2) 
-        // convert matrices to single precision to allow the use of BLAS routine
-        std::unique_ptr<float[]> temp_a = std::unique_ptr<float[]>(new float[n * n]);
-        std::unique_ptr<float[]> temp_b = std::unique_ptr<float[]>(new float[n * n]);
-        std::unique_ptr<float[]> temp_c = std::unique_ptr<float[]>(new float[n * n]);
-        for (int i=0; i < n; i++) {
-            for (int j=0; j < n; j++) {
-                temp_a[i * n + j] = half_float::half_cast<float, half_float::half>(a[i*n + j]);
-                temp_b[i * n + j] = half_float::half_cast<float, half_float::half>(b[i*n + j]);
-                temp_c[i * n + j] = half_float::half_cast<float, half_float::half>(c[i*n + j]);
+namespace {
+
+/**
+ * @brief Size of the tiles of C that are accumulated in registers by the micro kernel of gemm_packed().
+ *          A row of a tile fills 64 bytes, which is one AVX-512 or two AVX2 registers.
+ */
+template<typename T>
+struct MicroTile {
+    static const int rows = 6;
+    static const int cols = 64 / sizeof(T);
+};
+
+/**
+ * @brief Sizes of the packed blocks in the inner dimension, the rows of A and the columns of B.
+ *          They are chosen so a strip of packed B fits into the L1 cache and a packed block of A into the L2 cache.
+ */
+const int PACKED_BLOCK_K = 256;
+const int PACKED_BLOCK_M = 96;
+const int PACKED_BLOCK_N = 4096;
+
+/**
+ * @brief Multiply a packed strip of A with a packed strip of B and add the result to a tile of C.
+ *          The accumulators have a fixed size, so the compiler keeps them in vector registers.
+ * 
+ * @param kc Size of the strips in the inner dimension
+ * @param ap Packed strip of A with MicroTile::rows values per step in the inner dimension
+ * @param bp Packed strip of B with MicroTile::cols values per step in the inner dimension
+ * @param c First value of the tile of C
+ * @param ldc Row pitch of C
+ * @param mr Number of valid rows of the tile
+ * @param nr Number of valid columns of the tile
+ */
+template<typename T>
+inline void
+micro_kernel(int kc, T const* ap, T const* bp, T* c, int ldc, int mr, int nr) {
+    const int MR = MicroTile<T>::rows;
+    const int NR = MicroTile<T>::cols;
+    T acc[MR][NR] = {};
+    for (int k = 0; k < kc; k++) {
+        for (int r = 0; r < MR; r++) {
+            T a_rk = ap[k * MR + r];
+            #pragma omp simd
+            for (int x = 0; x < NR; x++) {
+                acc[r][x] += a_rk * bp[k * NR + x];
             }
         }
-        float alpha_sp = half_float::half_cast<float, half_float::half>(alpha);
-        float beta_sp = half_float::half_cast<float, half_float::half>(beta);
-        // Use single precision for validation
-        sgemm_(&ta, &tb, &n, &n, &n, &alpha_sp, temp_b.get(), &n, temp_a.get(), &n, &beta_sp, temp_c.get(), &n);
-        // convert the result back to half precision
-        for (int i=0; i < n; i++) {
-            for (int j=0; j < n; j++) {
-                c[i * n + j] = half_float::half_cast<half_float::half, float>(temp_c[i*n + j]);
-            }
+    }
+    for (int r = 0; r < mr; r++) {
+        for (int x = 0; x < nr; x++) {
+            c[static_cast<size_t>(r) * ldc + x] += acc[r][x];
         }
-#endif
-#if (defined(_USE_BLAS_) && DATA_TYPE_SIZE == 4) 
-        // Use single precision for validation
-        sgemm_(&ta, &tb, &n, &n, &n, &alpha, b, &n, a, &n, &beta, c, &n);
-#endif
-#if (defined(_USE_BLAS_) && DATA_TYPE_SIZE == 8) 
-        // use double precision for validation
-        dgemm_(&ta, &tb, &n, &n, &n, &alpha, b, &n, a, &n, &beta, c, &n);
-#endif
-#if (!defined(_USE_BLAS_) || (DATA_TYPE_SIZE != 2 && DATA_TYPE_SIZE != 4 && DATA_TYPE_SIZE != 8)) 
-        // Caclulate manually. Thisi s the default, if BLAS is not found
-        #pragma omp parallel
-        {
-        #pragma omp for
-        for (int i=0; i < n; i++) {
-            for (int j=0; j < n; j++) {
-                c[i * n + j] = beta * c[i*n + j];
-            }
+    }
+}
+
+/**
+ * @brief Calculate C = alpha * op(A) * op(B) + beta * C with packed blocks of A and B.
+ *          Transposed matrices are handled while the blocks are packed, so the micro kernel is the same for all shapes.
+ * 
+ * @copydoc gemm::gemm_packed(float const*, float const*, float*, int, int, int, bool, bool, float, float)
+ */
+template<typename T>
+void
+packed_gemm(T const* a, T const* b, T* c, int m, int n, int k, bool transposeA, bool transposeB, T alpha, T beta) {
+    const int MR = MicroTile<T>::rows;
+    const int NR = MicroTile<T>::cols;
+    const int max_b_strips = (PACKED_BLOCK_N + NR - 1) / NR;
+    // The packed block of B is shared by all threads
+    std::vector<T> b_packed(static_cast<size_t>(max_b_strips) * NR * PACKED_BLOCK_K);
+
+    #pragma omp parallel
+    {
+    #pragma omp for
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) {
+            c[static_cast<size_t>(i) * n + j] *= beta;
         }
+    }
+    // Every thread packs its own block of A that is scaled with alpha
+    std::vector<T> a_packed(static_cast<size_t>((PACKED_BLOCK_M + MR - 1) / MR) * MR * PACKED_BLOCK_K);
 
-#define HOST_MM_BLOCK_SIZE 256
-
-        #pragma omp for collapse(2)
-        for (int i=0; i < n; i+=HOST_MM_BLOCK_SIZE) {
-            for (int j=0; j < n; j+=HOST_MM_BLOCK_SIZE) {
-                for (int k=0; k < n; k+=HOST_MM_BLOCK_SIZE) {
-                     for (int ii=i; ii < std::min(i + HOST_MM_BLOCK_SIZE, n); ii++) {
-                        for (int kk=k; kk < std::min(k + HOST_MM_BLOCK_SIZE, n); kk++) {  
-                            HOST_DATA_TYPE scaled_a =  alpha * a[ii*n + kk];
-                            for (int jj=j; jj < std::min(j + HOST_MM_BLOCK_SIZE, n); jj++) {   
-                                c[ii*n + jj] += scaled_a * b[kk*n + jj];
-                            }
+    for (int jc = 0; jc < n; jc += PACKED_BLOCK_N) {
+        int nc = std::min(PACKED_BLOCK_N, n - jc);
+        int nc_strips = (nc + NR - 1) / NR;
+        for (int pc = 0; pc < k; pc += PACKED_BLOCK_K) {
+            int kc = std::min(PACKED_BLOCK_K, k - pc);
+            // Pack B into strips of NR columns. Missing columns at the border are filled with zeros.
+            #pragma omp for
+            for (int s = 0; s < nc_strips; s++) {
+                for (int p = 0; p < kc; p++) {
+                    for (int x = 0; x < NR; x++) {
+                        int col = jc + s * NR + x;
+                        size_t index = transposeB ? static_cast<size_t>(col) * k + pc + p : static_cast<size_t>(pc + p) * n + col;
+                        b_packed[(static_cast<size_t>(s) * kc + p) * NR + x] = (col < n) ? b[index] : T(0);
+                    }
+                }
+            }
+            #pragma omp for schedule(dynamic)
+            for (int ic = 0; ic < m; ic += PACKED_BLOCK_M) {
+                int mc = std::min(PACKED_BLOCK_M, m - ic);
+                int mc_strips = (mc + MR - 1) / MR;
+                // Pack A into strips of MR rows
+                for (int s = 0; s < mc_strips; s++) {
+                    for (int p = 0; p < kc; p++) {
+                        for (int r = 0; r < MR; r++) {
+                            int row = ic + s * MR + r;
+                            size_t index = transposeA ? static_cast<size_t>(pc + p) * m + row : static_cast<size_t>(row) * k + pc + p;
+                            a_packed[(static_cast<size_t>(s) * kc + p) * MR + r] = (row < m) ? alpha * a[index] : T(0);
                         }
-                     }
+                    }
+                }
+                for (int js = 0; js < nc_strips; js++) {
+                    for (int is = 0; is < mc_strips; is++) {
+                        micro_kernel(kc, &a_packed[static_cast<size_t>(is) * kc * MR], &b_packed[static_cast<size_t>(js) * kc * NR],
+                                        &c[static_cast<size_t>(ic + is * MR) * n + jc + js * NR], n,
+                                        std::min(MR, mc - is * MR), std::min(NR, nc - js * NR));
+                    }
                 }
             }
         }
+    }
+    }
+}
+
+/**
+ * @brief Use BLAS if it is available and the packed implementation otherwise.
+ *          The matrices are stored row major, so A and B are swapped for the column major BLAS routine.
+ */
+void
+gemm_single(float* a, float* b, float* c, int m, int n, int k, bool transposeA, bool transposeB, float alpha, float beta) {
+#ifdef _USE_BLAS_
+    char ta = transposeA ? 'T' : 'N';
+    char tb = transposeB ? 'T' : 'N';
+    int lda = transposeA ? m : k;
+    int ldb = transposeB ? k : n;
+    sgemm_(&tb, &ta, &n, &m, &k, &alpha, b, &ldb, a, &lda, &beta, c, &n);
+#else
+    gemm::gemm_packed(a, b, c, m, n, k, transposeA, transposeB, alpha, beta);
+#endif
+}
+
+/**
+ * @copydoc gemm_single()
+ */
+void
+gemm_single(double* a, double* b, double* c, int m, int n, int k, bool transposeA, bool transposeB, double alpha, double beta) {
+#ifdef _USE_BLAS_
+    char ta = transposeA ? 'T' : 'N';
+    char tb = transposeB ? 'T' : 'N';
+    int lda = transposeA ? m : k;
+    int ldb = transposeB ? k : n;
+    dgemm_(&tb, &ta, &n, &m, &k, &alpha, b, &ldb, a, &lda, &beta, c, &n);
+#else
+    gemm::gemm_packed(a, b, c, m, n, k, transposeA, transposeB, alpha, beta);
+#endif
+}
+
+#ifdef ENABLE_INT8
+/**
+ * @brief Multiply integer matrices with the packed implementation. There is no BLAS routine for integers.
+ *          The products are accumulated with the matrix type, so the result is exact as long as there is no overflow.
+ */
+void
+gemm_single(cl_int* a, cl_int* b, cl_int* c, int m, int n, int k, bool transposeA, bool transposeB, cl_int alpha, cl_int beta) {
+    packed_gemm<cl_int>(a, b, c, m, n, k, transposeA, transposeB, alpha, beta);
+}
+#endif
+
+#if DATA_TYPE_SIZE == 2 && !defined(ENABLE_MIXED_PRECISION)
+static_assert(sizeof(half_float::half) == sizeof(uint16_t), "Half precision values have to be stored in 16 bits");
+
+/**
+ * @brief Convert an array of half precision values to single precision. F16C instructions are used if they are available.
+ * 
+ * @param in The half precision values
+ * @param out Array for the single precision values
+ * @param count Number of values
+ */
+void
+halfToSingle(half_float::half const* in, float* out, size_t count) {
+    #pragma omp parallel for
+    for (size_t i = 0; i < count / 8; i++) {
+#ifdef __F16C__
+        __m128i h;
+        std::memcpy(&h, &in[i * 8], sizeof(h));
+        _mm256_storeu_ps(&out[i * 8], _mm256_cvtph_ps(h));
+#else
+        for (size_t j = i * 8; j < i * 8 + 8; j++) {
+            out[j] = half_float::half_cast<float, half_float::half>(in[j]);
+        }
+#endif
+    }
+    for (size_t j = count / 8 * 8; j < count; j++) {
+        out[j] = half_float::half_cast<float, half_float::half>(in[j]);
+    }
+}
+
+/**
+ * @brief Convert an array of single precision values to half precision. F16C instructions are used if they are available.
+ * 
+ * @param in The single precision values
+ * @param out Array for the half precision values
+ * @param count Number of values
+ */
+void
+singleToHalf(float const* in, half_float::half* out, size_t count) {
+    #pragma omp parallel for
+    for (size_t i = 0; i < count / 8; i++) {
+#ifdef __F16C__
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(&in[i * 8]), _MM_FROUND_TO_NEAREST_INT);
+        std::memcpy(&out[i * 8], &h, sizeof(h));
+#else
+        for (size_t j = i * 8; j < i * 8 + 8; j++) {
+            out[j] = half_float::half_cast<half_float::half, float>(in[j]);
         }
 #endif
+    }
+    for (size_t j = count / 8 * 8; j < count; j++) {
+        out[j] = half_float::half_cast<half_float::half, float>(in[j]);
+    }
+}
+#endif
+
+}
+
+void
+gemm::gemm_packed(float const* a, float const* b, float* c, int n, float alpha, float beta) {
+    packed_gemm(a, b, c, n, n, n, false, false, alpha, beta);
+}
+
+void
+gemm::gemm_packed(double const* a, double const* b, double* c, int n, double alpha, double beta) {
+    packed_gemm(a, b, c, n, n, n, false, false, alpha, beta);
+}
+
+void
+gemm::gemm_packed(float const* a, float const* b, float* c, int m, int n, int k, bool transposeA, bool transposeB, float alpha, float beta) {
+    packed_gemm(a, b, c, m, n, k, transposeA, transposeB, alpha, beta);
+}
+
+void
+gemm::gemm_packed(double const* a, double const* b, double* c, int m, int n, int k, bool transposeA, bool transposeB, double alpha, double beta) {
+    packed_gemm(a, b, c, m, n, k, transposeA, transposeB, alpha, beta);
+}
+
+void 
+gemm::gemm_ref(HOST_DATA_TYPE* a,HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
+                                int n, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta) {
+    gemm_ref(a, b, c, n, n, n, false, false, alpha, beta);
+}
+
+void 
+gemm::gemm_ref(HOST_DATA_TYPE* a,HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
+                                int m, int n, int k, bool transposeA, bool transposeB, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta) {
+#if DATA_TYPE_SIZE == 2 && !defined(ENABLE_MIXED_PRECISION)
+    // There is neither a BLAS routine nor fast host arithmetic for half precision,
+    // so the matrices are converted to single precision for the calculation
+    size_t a_elements = static_cast<size_t>(m) * k;
+    size_t b_elements = static_cast<size_t>(k) * n;
+    size_t c_elements = static_cast<size_t>(m) * n;
+    std::vector<float> temp_a(a_elements);
+    std::vector<float> temp_b(b_elements);
+    std::vector<float> temp_c(c_elements);
+    halfToSingle(a, temp_a.data(), a_elements);
+    halfToSingle(b, temp_b.data(), b_elements);
+    halfToSingle(c, temp_c.data(), c_elements);
+    float alpha_sp = half_float::half_cast<float, half_float::half>(alpha);
+    float beta_sp = half_float::half_cast<float, half_float::half>(beta);
+    gemm_single(temp_a.data(), temp_b.data(), temp_c.data(), m, n, k, transposeA, transposeB, alpha_sp, beta_sp);
+    // convert the result back to half precision
+    singleToHalf(temp_c.data(), c, c_elements);
+#else
+    gemm_single(a, b, c, m, n, k, transposeA, transposeB, alpha, beta);
+#endif
+}
+
+double
+gemm::freivalds_residual(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c, HOST_DATA_TYPE* c_out,
+                                int n, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta, double errorBound) {
+    return freivalds_residual(a, b, c, c_out, n, n, n, false, false, alpha, beta, errorBound);
+}
+
+double
+gemm::freivalds_residual(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c, HOST_DATA_TYPE* c_out,
+                                int m, int n, int k, bool transposeA, bool transposeB,
+                                HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta, double errorBound) {
+    auto a_value = [a, m, k, transposeA](int i, int p) {
+        return static_cast<double>(a[transposeA ? static_cast<size_t>(p) * m + i : static_cast<size_t>(i) * k + p]);
+    };
+    auto b_value = [b, n, k, transposeB](int p, int j) {
+        return static_cast<double>(b[transposeB ? static_cast<size_t>(j) * k + p : static_cast<size_t>(p) * n + j]);
+    };
+    return freivaldsResidual(a_value, b_value, c, c_out, m, n, k, alpha, beta, errorBound);
 }
@@ -29,8 +29,13 @@ SOFTWARE.
 
 /* Project's headers */
 #include "hpcc_benchmark.hpp"
+#include "memory_placement.hpp"
 #include "parameters.h"
 
+// half.hpp uses the F16C intrinsics if they are available, but only includes their header after checking for them
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
 #include "half.hpp"
 
 #if DATA_TYPE_SIZE == 2
@@ -39,6 +44,14 @@ SOFTWARE.
 #define OPTIONAL_CAST(x) x
 #endif
 
+#ifdef ENABLE_INT8
+// Integer matrices are scaled with integers, so the results stay exact
+#define DEFAULT_ALPHA 1
+#else
+#define DEFAULT_ALPHA 0.5
+#endif
+#define DEFAULT_BETA 2.0
+
 #ifdef _USE_BLAS_
 
 extern "C" void sgemm_(char*, char*, int*, int*,int*, float*, float*, int*, float*, int*, float*, float*, int*);
@@ -82,6 +95,79 @@ public:
      */
     bool replicateInputBuffers;
 
+    /**
+     * @brief Size of the tiles in number of blocks for the out-of-core execution. 0 if the matrices are stored on the device.
+     */
+    uint tileSize;
+
+    /**
+     * @brief Number of matrices of size matrixSize that are calculated as a batch. 0 if a single matrix is calculated.
+     */
+    uint batchSize;
+
+    /**
+     * @brief Number of rows of blocks of C that are calculated by a single kernel execution if the rows are scheduled dynamically
+     *          over the kernel replications. 0 if every replication calculates a fixed range of rows with a single kernel execution.
+     */
+    uint chunkSize;
+
+    /**
+     * @brief Placement policy for the device buffers of the kernel replications
+     * 
+     */
+    hpcc_base::memory_placement::Policy memoryPlacement;
+
+    /**
+     * @brief Number of memory banks the buffers are distributed over by the placement policy
+     * 
+     */
+    uint memoryBanks;
+
+    /**
+     * @brief Number of rows of op(A) and C. 0 if matrixSize is used.
+     */
+    uint sizeM;
+
+    /**
+     * @brief Number of columns of op(B) and C. 0 if matrixSize is used.
+     */
+    uint sizeN;
+
+    /**
+     * @brief Number of columns of op(A) and rows of op(B). 0 if matrixSize is used.
+     */
+    uint sizeK;
+
+    /**
+     * @brief If True, A is stored transposed, so op(A) = A^T
+     */
+    bool transposeA;
+
+    /**
+     * @brief If True, B is stored transposed, so op(B) = B^T
+     */
+    bool transposeB;
+
+    /**
+     * @brief The row position of this MPI rank in the torus. Only used for the distributed execution with the PCIE communication type.
+     */
+    int torus_row;
+
+    /**
+     * @brief The column position of this MPI rank in the torus
+     */
+    int torus_col;
+
+    /**
+     * @brief Width of the torus in number of ranks
+     */
+    int torus_width;
+
+    /**
+     * @brief Height of the torus in number of ranks
+     */
+    int torus_height;
+
     /**
      * @brief Construct a new GEMM Program Settings object
      * 
@@ -96,6 +182,34 @@ public:
      */
     std::map<std::string, std::string> getSettingsMap() override;
 
+    /**
+     * @brief Get the number of rows of op(A) and C
+     * 
+     * @return uint sizeM or matrixSize if no size was given
+     */
+    uint getM() const;
+
+    /**
+     * @brief Get the number of columns of op(B) and C
+     * 
+     * @return uint sizeN or matrixSize if no size was given
+     */
+    uint getN() const;
+
+    /**
+     * @brief Get the inner dimension of the multiplication
+     * 
+     * @return uint sizeK or matrixSize if no size was given
+     */
+    uint getK() const;
+
+    /**
+     * @brief Check, if square matrices are multiplied without transposition
+     * 
+     * @return true if M, N and K are equal to matrixSize and no matrix is transposed
+     */
+    bool isSquare() const;
+
 };
 
 /**
@@ -154,6 +268,18 @@ public:
      */
     HOST_DATA_TYPE beta;
 
+    /**
+     * @brief Width of the local matrices. For rectangular matrices the width of C.
+     * 
+     */
+    uint matrix_width;
+
+    /**
+     * @brief Height of the local matrices. For rectangular matrices the height of C.
+     * 
+     */
+    uint matrix_height;
+
     /**
      * @brief Construct a new GEMM Data object
      * 
@@ -162,12 +288,41 @@ public:
      */
     GEMMData(cl::Context context, uint size);
 
+    /**
+     * @brief Construct a new GEMM Data object for the local part of distributed matrices
+     * 
+     * @param context The OpenCL context used to allocate memory in SVM mode
+     * @param width Width of the allocated matrices
+     * @param height Height of the allocated matrices
+     */
+    GEMMData(cl::Context context, uint width, uint height);
+
+    /**
+     * @brief Construct a new GEMM Data object for rectangular matrices
+     * 
+     * @param context The OpenCL context used to allocate memory in SVM mode
+     * @param m Number of rows of op(A) and C
+     * @param n Number of columns of op(B) and C
+     * @param k Number of columns of op(A) and rows of op(B)
+     */
+    GEMMData(cl::Context context, uint m, uint n, uint k);
+
     /**
      * @brief Destroy the GEMM Data object. Free the allocated memory
      * 
      */
     ~GEMMData();
 
+private:
+    /**
+     * @brief Allocate the memory for the matrices
+     * 
+     * @param a_elements Number of values of A
+     * @param b_elements Number of values of B
+     * @param c_elements Number of values of C and C_out
+     */
+    void allocateMatrices(size_t a_elements, size_t b_elements, size_t c_elements);
+
 };
 
 /**
@@ -182,6 +337,33 @@ public:
      */
     std::vector<double> timings;
 
+    /**
+     * @brief The timings of all repetitions for every device used by the rank
+     * 
+     */
+    std::vector<std::vector<double>> deviceTimings;
+
+    /**
+     * @brief The summed kernel execution times of the busiest kernel replication for all repetitions.
+     *          Only measured for the tiled execution, where the timings contain the transfers of the tiles.
+     * 
+     */
+    std::vector<double> deviceResidentTimings;
+
+    /**
+     * @brief The fraction of the execution time every kernel replication was busy for all repetitions.
+     *          Only measured if the rows of C are scheduled dynamically.
+     * 
+     */
+    std::vector<std::vector<double>> replicationUtilization;
+
+    /**
+     * @brief The number of rows of blocks of C calculated by every kernel replication for all repetitions.
+     *          Only measured if the rows of C are scheduled dynamically.
+     * 
+     */
+    std::vector<std::vector<double>> replicationBlockRows;
+
 };
 
 /**
@@ -192,6 +374,25 @@ class GEMMBenchmark : public hpcc_base::HpccFpgaBenchmark<GEMMProgramSettings, G
 
 protected:
 
+    /**
+     * @brief Gather the local output matrices of all ranks of the torus on rank 0 and regenerate the global input matrices there
+     * 
+     * @param data The local data of this rank
+     * @return std::unique_ptr<GEMMData> The global matrices on rank 0, nullptr on all other ranks
+     */
+    std::unique_ptr<GEMMData>
+    gatherGlobalData(GEMMData &data);
+
+    /**
+     * @brief Validate the local block of C of every rank of the torus with the algorithm of Freivalds.
+     *          The needed rows of A and columns of B are regenerated on every rank, so no matrix has to be gathered.
+     * 
+     * @param data The local matrices of this rank
+     * @return true if the residual of all ranks is below 1 on rank 0, true on all other ranks
+     */
+    bool
+    validateDistributedSampled(GEMMData &data);
+
     /**
      * @brief Additional input parameters of the GEMM benchmark
      * 
@@ -237,6 +438,25 @@ public:
     void
     collectAndPrintResults(const GEMMExecutionTimings &output) override;
 
+    /**
+     * @brief Check the given benchmark configuration and its validity
+     * 
+     * @return true if the validation is successful, false otherwise
+     */
+    bool
+    checkInputParameters() override;
+
+    /**
+     * @brief Select the largest square matrix size that fits into the device memory.
+     *          Only supported for the default and the batched execution. The tiled and distributed executions
+     *          only keep tiles of the matrices on the device, so their size is not limited by the device memory.
+     * 
+     * @param limits The memory limits of the device
+     * @return true if a valid matrix size was found, false otherwise
+     */
+    bool
+    setAutomaticSize(hpcc_base::MemoryLimits const& limits) override;
+
     /**
      * @brief Construct a new GEMM Benchmark object
      * 
@@ -267,6 +487,105 @@ C = alpha * A * B + beta * C
 void gemm_ref( HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
                                 int n, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta);
 
+/**
+Multiply rectangular matrices that may be stored transposed.
+
+C = alpha * op(A) * op(B) + beta * C
+
+@param a matrix A with k x m values if transposed, m x k values otherwise
+@param b matrix B with n x k values if transposed, k x n values otherwise
+@param c matrix C with m x n values that will also be the result matrix
+@param m number of rows of op(A) and C
+@param n number of columns of op(B) and C
+@param k number of columns of op(A) and rows of op(B)
+@param transposeA true, if op(A) is the transpose of A
+@param transposeB true, if op(B) is the transpose of B
+@param alpha scalar value used to scale op(A) * op(B)
+@param beta scalar value used to scale C
+*/
+void gemm_ref( HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
+                                int m, int n, int k, bool transposeA, bool transposeB, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta);
+
+/**
+ * @brief Multiply matrices on the host CPU without BLAS. Blocks of A and B are packed so they stay in the caches
+ *          and the products are accumulated in register tiles by a vectorized micro kernel.
+ *          The blocks of rows of C are distributed over the OpenMP threads.
+ *          This implementation is used by gemm_ref() if no BLAS library was found.
+ * 
+ * @param a matrix A
+ * @param b matrix B
+ * @param c matrix C that will also be the result matrix
+ * @param n size of all quadratic matrices
+ * @param alpha scalar value used to scale A * B
+ * @param beta scalar value used to scale C
+ */
+void gemm_packed(float const* a, float const* b, float* c, int n, float alpha, float beta);
+
+/**
+ * @copydoc gemm_packed()
+ */
+void gemm_packed(double const* a, double const* b, double* c, int n, double alpha, double beta);
+
+/**
+ * @brief Multiply rectangular matrices with the packed implementation. Transposed matrices are transposed while packing.
+ * 
+ * @param a matrix A with k x m values if transposed, m x k values otherwise
+ * @param b matrix B with n x k values if transposed, k x n values otherwise
+ * @param c matrix C with m x n values that will also be the result matrix
+ * @param m number of rows of op(A) and C
+ * @param n number of columns of op(B) and C
+ * @param k number of columns of op(A) and rows of op(B)
+ * @param transposeA true, if op(A) is the transpose of A
+ * @param transposeB true, if op(B) is the transpose of B
+ * @param alpha scalar value used to scale op(A) * op(B)
+ * @param beta scalar value used to scale C
+ */
+void gemm_packed(float const* a, float const* b, float* c, int m, int n, int k, bool transposeA, bool transposeB, float alpha, float beta);
+
+/**
+ * @copydoc gemm_packed(float const*, float const*, float*, int, int, int, bool, bool, float, float)
+ */
+void gemm_packed(double const* a, double const* b, double* c, int m, int n, int k, bool transposeA, bool transposeB, double alpha, double beta);
+
+/**
+ * @brief Check the result of C_out = alpha * A * B + beta * C with the algorithm of Freivalds.
+ *          The matrix products are replaced by products with random vectors of +1 and -1, so only O(n^2) operations are required.
+ *          The differences are normalized with a probabilistic bound of the rounding error of the dot products, so the result should be below 1 for a correct result.
+ * 
+ * @param a The matrix A
+ * @param b The matrix B
+ * @param c The matrix C
+ * @param c_out The calculated result that should be checked
+ * @param n Width of the matrices
+ * @param alpha Scalar value used to scale A * B
+ * @param beta Scalar value used to scale C
+ * @param errorBound Maximum probability that a wrong result is not detected. Used to calculate the number of random vectors.
+ * @return double The maximum normalized residual
+ */
+double freivalds_residual(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c, HOST_DATA_TYPE* c_out,
+                                int n, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta, double errorBound);
+
+/**
+ * @brief Check the result of C_out = alpha * op(A) * op(B) + beta * C for rectangular matrices with the algorithm of Freivalds
+ * 
+ * @param a The matrix A with k x m values if transposed, m x k values otherwise
+ * @param b The matrix B with n x k values if transposed, k x n values otherwise
+ * @param c The matrix C with m x n values
+ * @param c_out The calculated result that should be checked
+ * @param m Number of rows of op(A) and C
+ * @param n Number of columns of op(B) and C
+ * @param k Number of columns of op(A) and rows of op(B)
+ * @param transposeA True, if op(A) is the transpose of A
+ * @param transposeB True, if op(B) is the transpose of B
+ * @param alpha Scalar value used to scale op(A) * op(B)
+ * @param beta Scalar value used to scale C
+ * @param errorBound Maximum probability that a wrong result is not detected. Used to calculate the number of random vectors.
+ * @return double The maximum normalized residual
+ */
+double freivalds_residual(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c, HOST_DATA_TYPE* c_out,
+                                int m, int n, int k, bool transposeA, bool transposeB,
+                                HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta, double errorBound);
+
 } // namespace gemm
 
 
@@ -0,0 +1,42 @@
+//
+// Micro-benchmarks for the host code of the GEMM benchmark
+//
+#include "benchmark/benchmark.h"
+#include "host_perf_fixture.hpp"
+#include "gemm_benchmark.hpp"
+#include "parameters.h"
+
+/**
+ * The range gives the matrix size
+ */
+class GEMMHostPerf : public hpcc_base::HostPerfFixture<gemm::GEMMBenchmark> {
+protected:
+    void
+    setDataSize(benchmark::State& state) override {
+        getBenchmark().getExecutionSettings().programSettings->matrixSize = state.range(0);
+    }
+
+    size_t
+    getInputDataBytes(benchmark::State& state) override {
+        return 3 * state.range(0) * state.range(0) * sizeof(HOST_DATA_TYPE);
+    }
+};
+
+BENCHMARK_DEFINE_F(GEMMHostPerf, GenerateInputData)(benchmark::State& state) {
+    measureInputDataGeneration(state);
+}
+BENCHMARK_REGISTER_F(GEMMHostPerf, GenerateInputData)->RangeMultiplier(2)->Range(256, 4096)->Unit(benchmark::kMillisecond);
+
+/**
+ * Reference matrix multiplication that is used for the validation
+ */
+BENCHMARK_DEFINE_F(GEMMHostPerf, GemmRef)(benchmark::State& state) {
+    auto data = generateData(state);
+    int n = state.range(0);
+    for (auto _ : state) {
+        gemm::gemm_ref(data->A, data->B, data->C, n, OPTIONAL_CAST(0.5), OPTIONAL_CAST(2.0));
+        benchmark::ClobberMemory();
+    }
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * n * n * n * state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK_REGISTER_F(GEMMHostPerf, GemmRef)->RangeMultiplier(2)->Range(256, 2048)->Unit(benchmark::kMillisecond);
@@ -2,6 +2,7 @@
 // Created by Marius Meyer on 04.12.19.
 //
 #include <memory>
+#include <cstring>
 
 #include "gtest/gtest.h"
 #include "gemm_benchmark.hpp"
@@ -171,7 +172,7 @@ TEST_P(GEMMKernelTest, FPGACorrectbetaCplusalphaAB) {
            c_ref_out[i * matrix_size + j] = data->C[i * matrix_size + j];
         }
     }
-    gemm::gemm_ref(data->A,data->B,c_ref_out,matrix_size,OPTIONAL_CAST(0.5),OPTIONAL_CAST(2.0));
+    gemm::gemm_ref(data->A,data->B,c_ref_out,matrix_size,data->alpha,data->beta);
     for (int i = 0; i < matrix_size; i++) {
         for (int j = 0; j < matrix_size; j++) {
             EXPECT_NEAR(data->C_out[i * matrix_size + j], c_ref_out[i * matrix_size + j], std::numeric_limits<HOST_DATA_TYPE>::epsilon() * matrix_size * matrix_size);
@@ -179,6 +180,247 @@ TEST_P(GEMMKernelTest, FPGACorrectbetaCplusalphaAB) {
     }
 }
 
+/**
+ * Tests full multiply add with the tiled execution, where every tile is a single block
+ */
+TEST_P(GEMMKernelTest, FPGATiledCorrectbetaCplusalphaAB) {
+    std::vector<HOST_DATA_TYPE> c_ref_out(data->C, data->C + matrix_size * matrix_size);
+    bm->getExecutionSettings().programSettings->tileSize = 1;
+    bm->getExecutionSettings().programSettings->numRepetitions = 1;
+    auto result = bm->executeKernel(*data);
+    EXPECT_EQ(result->deviceResidentTimings.size(), 1);
+    gemm::gemm_ref(data->A,data->B,c_ref_out.data(),matrix_size,data->alpha,data->beta);
+    for (int i = 0; i < matrix_size; i++) {
+        for (int j = 0; j < matrix_size; j++) {
+            EXPECT_NEAR(data->C_out[i * matrix_size + j], c_ref_out[i * matrix_size + j], std::numeric_limits<HOST_DATA_TYPE>::epsilon() * matrix_size * matrix_size);
+        }
+    }
+}
+
+/**
+ * Tests full multiply add with the dynamic scheduling, where every row of blocks is calculated by its own kernel execution
+ */
+TEST_P(GEMMKernelTest, FPGADynamicSchedulingCorrectbetaCplusalphaAB) {
+    std::vector<HOST_DATA_TYPE> c_ref_out(data->C, data->C + matrix_size * matrix_size);
+    bm->getExecutionSettings().programSettings->chunkSize = 1;
+    bm->getExecutionSettings().programSettings->numRepetitions = 1;
+    auto result = bm->executeKernel(*data);
+    ASSERT_EQ(result->replicationBlockRows.size(), bm->getExecutionSettings().programSettings->kernelReplications);
+    double block_rows = 0.0;
+    for (auto const& rows : result->replicationBlockRows) {
+        block_rows += rows[0];
+    }
+    EXPECT_DOUBLE_EQ(block_rows, matrix_size / bm->getExecutionSettings().programSettings->blockSize);
+    gemm::gemm_ref(data->A,data->B,c_ref_out.data(),matrix_size,data->alpha,data->beta);
+    for (int i = 0; i < matrix_size; i++) {
+        for (int j = 0; j < matrix_size; j++) {
+            EXPECT_NEAR(data->C_out[i * matrix_size + j], c_ref_out[i * matrix_size + j], std::numeric_limits<HOST_DATA_TYPE>::epsilon() * matrix_size * matrix_size);
+        }
+    }
+}
+
+/**
+ * Tests full multiply add with the distributed execution on the torus of all ranks
+ */
+TEST_P(GEMMKernelTest, FPGADistributedCorrectbetaCplusalphaAB) {
+    bm->getExecutionSettings().programSettings->communicationType = hpcc_base::CommunicationType::pcie_mpi;
+    bm->getExecutionSettings().programSettings->numRepetitions = 1;
+    data = bm->generateInputData();
+    auto result = bm->executeKernel(*data);
+    EXPECT_EQ(result->timings.size(), 1);
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+/**
+ * Tests full multiply add with the batched execution, where every matrix of the batch uses different input values
+ */
+TEST_P(GEMMKernelTest, FPGABatchedCorrectbetaCplusalphaAB) {
+    bm->getExecutionSettings().programSettings->batchSize = 3;
+    bm->getExecutionSettings().programSettings->numRepetitions = 1;
+    data = bm->generateInputData();
+    auto result = bm->executeKernel(*data);
+    EXPECT_EQ(result->timings.size(), 1);
+    size_t matrix_elements = static_cast<size_t>(matrix_size) * matrix_size;
+    for (int m = 0; m < 3; m++) {
+        std::vector<HOST_DATA_TYPE> c_ref_out(data->C + m * matrix_elements, data->C + (m + 1) * matrix_elements);
+        gemm::gemm_ref(data->A + m * matrix_elements, data->B + m * matrix_elements, c_ref_out.data(), matrix_size, data->alpha, data->beta);
+        for (size_t i = 0; i < matrix_elements; i++) {
+            EXPECT_NEAR(data->C_out[m * matrix_elements + i], c_ref_out[i], std::numeric_limits<HOST_DATA_TYPE>::epsilon() * matrix_size * matrix_size);
+        }
+    }
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+/**
+ * The packed host implementation calculates the same result as a naive implementation for sizes that are not a multiple of its blocks
+ */
+TEST(GEMMPackedTest, PackedMatchesNaiveImplementation) {
+    for (int n : {1, 37, 300}) {
+        std::vector<float> a(n * n), b(n * n), c(n * n);
+        for (int i = 0; i < n * n; i++) {
+            a[i] = static_cast<float>((i * 7) % 13) / 13.0f - 0.5f;
+            b[i] = static_cast<float>((i * 5) % 11) / 11.0f - 0.5f;
+            c[i] = static_cast<float>((i * 3) % 7) / 7.0f - 0.5f;
+        }
+        std::vector<double> ref(c.begin(), c.end());
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                double sum = 0.0;
+                for (int k = 0; k < n; k++) {
+                    sum += static_cast<double>(a[i * n + k]) * b[k * n + j];
+                }
+                ref[i * n + j] = 0.5 * sum + 2.0 * ref[i * n + j];
+            }
+        }
+        gemm::gemm_packed(a.data(), b.data(), c.data(), n, 0.5f, 2.0f);
+        for (int i = 0; i < n * n; i++) {
+            EXPECT_NEAR(c[i], ref[i], 1.0e-4 * n);
+        }
+    }
+}
+
+/**
+ * Tests full multiply add with the CPU backend
+ */
+/**
+ * The packed host implementation handles rectangular and transposed matrices
+ */
+TEST(GEMMPackedTest, PackedMatchesNaiveImplementationRectangularTransposed) {
+    const int m = 37;
+    const int n = 70;
+    const int k = 300;
+    for (int transpose = 0; transpose < 4; transpose++) {
+        bool ta = (transpose & 1) != 0;
+        bool tb = (transpose & 2) != 0;
+        std::vector<float> a(m * k), b(k * n), c(m * n);
+        for (int i = 0; i < m * k; i++) {
+            a[i] = static_cast<float>((i * 7) % 13) / 13.0f - 0.5f;
+        }
+        for (int i = 0; i < k * n; i++) {
+            b[i] = static_cast<float>((i * 5) % 11) / 11.0f - 0.5f;
+        }
+        for (int i = 0; i < m * n; i++) {
+            c[i] = static_cast<float>((i * 3) % 7) / 7.0f - 0.5f;
+        }
+        std::vector<double> ref(c.begin(), c.end());
+        for (int i = 0; i < m; i++) {
+            for (int j = 0; j < n; j++) {
+                double sum = 0.0;
+                for (int p = 0; p < k; p++) {
+                    sum += static_cast<double>(ta ? a[p * m + i] : a[i * k + p]) * (tb ? b[j * k + p] : b[p * n + j]);
+                }
+                ref[i * n + j] = 0.5 * sum + 2.0 * ref[i * n + j];
+            }
+        }
+        gemm::gemm_packed(a.data(), b.data(), c.data(), m, n, k, ta, tb, 0.5f, 2.0f);
+        for (int i = 0; i < m * n; i++) {
+            EXPECT_NEAR(c[i], ref[i], 1.0e-4 * k);
+        }
+    }
+}
+
+/**
+ * Tests full multiply add with rectangular matrices that are both stored transposed
+ */
+TEST_P(GEMMKernelTest, FPGARectangularTransposedCorrectbetaCplusalphaAB) {
+    auto& settings = *bm->getExecutionSettings().programSettings;
+    settings.sizeN = 2 * BLOCK_SIZE;
+    settings.sizeK = 3 * BLOCK_SIZE;
+    settings.transposeA = true;
+    settings.transposeB = true;
+    settings.numRepetitions = 1;
+    data = bm->generateInputData();
+    std::vector<HOST_DATA_TYPE> c_ref_out(data->C, data->C + matrix_size * settings.sizeN);
+    auto result = bm->executeKernel(*data);
+    gemm::gemm_ref(data->A, data->B, c_ref_out.data(), matrix_size, settings.sizeN, settings.sizeK, true, true, data->alpha, data->beta);
+    for (size_t i = 0; i < c_ref_out.size(); i++) {
+        EXPECT_NEAR(data->C_out[i], c_ref_out[i], std::numeric_limits<HOST_DATA_TYPE>::epsilon() * settings.sizeK * settings.sizeK);
+    }
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+/**
+ * Tests the host execution and both validation modes with rectangular matrices
+ */
+TEST_P(GEMMKernelTest, CPURectangularCorrectbetaCplusalphaAB) {
+    auto& settings = *bm->getExecutionSettings().programSettings;
+    settings.communicationType = hpcc_base::CommunicationType::cpu_only;
+    settings.sizeM = 3 * BLOCK_SIZE;
+    settings.sizeK = BLOCK_SIZE;
+    settings.transposeB = true;
+    data = bm->generateInputData();
+    auto result = bm->executeKernel(*data);
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+    settings.validationMode = hpcc_base::ValidationMode::sampled;
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+    data->C_out[matrix_size + 1] += 1.0;
+    EXPECT_FALSE(bm->validateOutputAndPrintError(*data));
+}
+
+TEST_P(GEMMKernelTest, CPUCorrectbetaCplusalphaAB) {
+    std::vector<HOST_DATA_TYPE> c_ref_out(data->C, data->C + matrix_size * matrix_size);
+    bm->getExecutionSettings().programSettings->communicationType = hpcc_base::CommunicationType::cpu_only;
+    auto result = bm->executeKernel(*data);
+    gemm::gemm_ref(data->A,data->B,c_ref_out.data(),matrix_size,data->alpha,data->beta);
+    for (int i = 0; i < matrix_size; i++) {
+        for (int j = 0; j < matrix_size; j++) {
+            EXPECT_NEAR(data->C_out[i * matrix_size + j], c_ref_out[i * matrix_size + j], std::numeric_limits<HOST_DATA_TYPE>::epsilon() * matrix_size * matrix_size);
+        }
+    }
+}
+
+/**
+ * Tests if the sampled validation accepts a correct result and detects a single wrong value
+ */
+TEST_P(GEMMKernelTest, FreivaldsDetectsWrongValue) {
+    std::copy(data->C, data->C + matrix_size * matrix_size, data->C_out);
+    gemm::gemm_ref(data->A,data->B,data->C_out,matrix_size,data->alpha,data->beta);
+    EXPECT_LT(gemm::freivalds_residual(data->A, data->B, data->C, data->C_out, matrix_size, data->alpha, data->beta, 1.0e-6), 1.0);
+    data->C_out[matrix_size + 1] += OPTIONAL_CAST(1.0);
+    EXPECT_GE(gemm::freivalds_residual(data->A, data->B, data->C, data->C_out, matrix_size, data->alpha, data->beta, 1.0e-6), 1.0);
+}
+
+/**
+ * The sampled validation of the distributed execution regenerates the input matrices on every rank and detects a wrong value
+ */
+TEST_P(GEMMKernelTest, DistributedFreivaldsDetectsWrongValue) {
+    auto& settings = *bm->getExecutionSettings().programSettings;
+    if (settings.torus_width * settings.torus_height > 1) {
+        // The reference result is calculated from the local matrices, which requires a single rank
+        GTEST_SKIP() << "Only supported with a single rank";
+    }
+    settings.communicationType = hpcc_base::CommunicationType::pcie_mpi;
+    settings.validationMode = hpcc_base::ValidationMode::sampled;
+    data = bm->generateInputData();
+    std::copy(data->C, data->C + matrix_size * matrix_size, data->C_out);
+    gemm::gemm_ref(data->A,data->B,data->C_out,matrix_size,data->alpha,data->beta);
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+    data->C_out[matrix_size + 1] += OPTIONAL_CAST(1.0);
+    EXPECT_FALSE(bm->validateOutputAndPrintError(*data));
+}
+
+#if defined(ENABLE_BFLOAT16) || defined(ENABLE_INT8)
+/**
+ * The generated values of A and B can be converted to the low precision data type on the device without rounding
+ */
+TEST_P(GEMMKernelTest, InputValuesRepresentableInDeviceDataType) {
+    for (size_t i = 0; i < static_cast<size_t>(matrix_size) * matrix_size; i++) {
+#ifdef ENABLE_INT8
+        EXPECT_GE(data->A[i], -128);
+        EXPECT_LE(data->A[i], 127);
+        EXPECT_GE(data->B[i], -128);
+        EXPECT_LE(data->B[i], 127);
+#else
+        uint32_t a_bits, b_bits;
+        std::memcpy(&a_bits, &data->A[i], sizeof(a_bits));
+        std::memcpy(&b_bits, &data->B[i], sizeof(b_bits));
+        EXPECT_EQ(a_bits & 0xffffu, 0u);
+        EXPECT_EQ(b_bits & 0xffffu, 0u);
+#endif
+    }
+}
+#endif
+
 INSTANTIATE_TEST_CASE_P(Default, GEMMKernelTest,
          testing::Values(1,2));
 
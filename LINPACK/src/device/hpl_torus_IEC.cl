@@ -384,10 +384,16 @@ update_block(const DEVICE_DATA_TYPE a[GEMM_BLOCK][GEMM_BLOCK],
 	}
 }
 
+/**
+Calculate the LU factorization of a single block and send its rows and columns to the network kernels.
+
+is_factorized: if true, the block was already factorized by the host with partial pivoting and is only sent
+ */
 __attribute__((uses_global_work_offset(0)))
 __kernel
 void
 lu(__global DEVICE_DATA_TYPE* restrict a, 
+				const uint is_factorized,
 				const uint block_col,
 				const uint block_row,
 				const uint blocks_per_row) {
@@ -421,130 +427,133 @@ lu(__global DEVICE_DATA_TYPE* restrict a,
 		int k = gk / GEMM_BLOCK;
 		int kk = gk & (GEMM_BLOCK - 1);
 
-		// Read in current LU block
-		DEVICE_DATA_TYPE lu_a_buffer_in[GEMM_BLOCK][GEMM_BLOCK];
-		__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
-		for (int ii =0; ii < GEMM_BLOCK; ii++) {
+		// A block that was factorized by the host already contains its final values, so they are only sent
+		if (!is_factorized) {
+			// Read in current LU block
+			DEVICE_DATA_TYPE lu_a_buffer_in[GEMM_BLOCK][GEMM_BLOCK];
 			__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
-			for (int jj =0; jj < GEMM_BLOCK; jj++) {
-				lu_a_buffer_in[ii][jj] = a_buffer[k][k][ii][jj];
+			for (int ii =0; ii < GEMM_BLOCK; ii++) {
+				__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
+				for (int jj =0; jj < GEMM_BLOCK; jj++) {
+					lu_a_buffer_in[ii][jj] = a_buffer[k][k][ii][jj];
+				}
 			}
-		}
 
-		DEVICE_DATA_TYPE lu_a_buffer_out[GEMM_BLOCK][GEMM_BLOCK];
-		DEVICE_DATA_TYPE lu_a_buffer_out_row[GEMM_BLOCK];
-		DEVICE_DATA_TYPE lu_a_buffer_out_col[GEMM_BLOCK];
-		// Calculate next row and column of LU factorization and store in local memory buffer
-		lu_block(lu_a_buffer_in, kk, lu_a_buffer_out);
-		__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
-		for (int ii =0; ii < GEMM_BLOCK; ii++) {
+			DEVICE_DATA_TYPE lu_a_buffer_out[GEMM_BLOCK][GEMM_BLOCK];
+			DEVICE_DATA_TYPE lu_a_buffer_out_row[GEMM_BLOCK];
+			DEVICE_DATA_TYPE lu_a_buffer_out_col[GEMM_BLOCK];
+			// Calculate next row and column of LU factorization and store in local memory buffer
+			lu_block(lu_a_buffer_in, kk, lu_a_buffer_out);
+			__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
+			for (int ii =0; ii < GEMM_BLOCK; ii++) {
+				__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
+				for (int jj =0; jj < GEMM_BLOCK; jj++) {
+					a_buffer[k][k][ii][jj] = lu_a_buffer_out[ii][jj];
+				}
+			}
 			__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
 			for (int jj =0; jj < GEMM_BLOCK; jj++) {
-				a_buffer[k][k][ii][jj] = lu_a_buffer_out[ii][jj];
+				lu_a_buffer_out_row[jj] = lu_a_buffer_out[kk][jj];
 			}
-		}
-		__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
-		for (int jj =0; jj < GEMM_BLOCK; jj++) {
-			lu_a_buffer_out_row[jj] = lu_a_buffer_out[kk][jj];
-		}
-		__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
-		for (int jj =0; jj < GEMM_BLOCK; jj++) {
-			lu_a_buffer_out_col[jj] = lu_a_buffer_out[jj][kk];
-		}
-
-		// The update pipeline does not need to be executed for the last
-		// row of blocks
-		if (gk < BLOCK_SIZE - GEMM_BLOCK) {
-
-			// Update all other blocks with the new calculated row and column
-			#pragma ivdep safelen(BLOCK_SIZE/GEMM_BLOCK)
-			for (int ttj = 0; ttj < (BLOCK_SIZE/GEMM_BLOCK - k) * BLOCK_SIZE/GEMM_BLOCK; ttj++) {
-
-				int j = (ttj) & (BLOCK_SIZE/GEMM_BLOCK - 1);
-				int ti = (ttj + (k * BLOCK_SIZE/GEMM_BLOCK)) / (BLOCK_SIZE/GEMM_BLOCK);
-				// always execute the pipeline for whole rows of matrix blocks.
-				// Only execute update for blocks that are required.
-				// This helps to keep constant latencies between data dependencies of the pipeline stages
-				if (ti >= k && j >= k) {
-					/*
-					Update order of block is:
-					First the block below the LU block
-					Then the row of blocks right of LU block
-					This way the left block of the next column will always be calculated in advance 
-					because it will be needed as input for the subsequent blocks.
-					*/
-					int i = (j == k) ? ti + 1 : ti;
-
-					// The last left block will be out of bounds because of the update strategy described above
-					// Skip it
-					if (i < BLOCK_SIZE/GEMM_BLOCK) {
-
-						// TODO Split this up into three different styles to reduce logic usage?
+			__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
+			for (int jj =0; jj < GEMM_BLOCK; jj++) {
+				lu_a_buffer_out_col[jj] = lu_a_buffer_out[jj][kk];
+			}
+
+			// The update pipeline does not need to be executed for the last
+			// row of blocks
+			if (gk < BLOCK_SIZE - GEMM_BLOCK) {
+
+				// Update all other blocks with the new calculated row and column
+				#pragma ivdep safelen(BLOCK_SIZE/GEMM_BLOCK)
+				for (int ttj = 0; ttj < (BLOCK_SIZE/GEMM_BLOCK - k) * BLOCK_SIZE/GEMM_BLOCK; ttj++) {
+
+					int j = (ttj) & (BLOCK_SIZE/GEMM_BLOCK - 1);
+					int ti = (ttj + (k * BLOCK_SIZE/GEMM_BLOCK)) / (BLOCK_SIZE/GEMM_BLOCK);
+					// always execute the pipeline for whole rows of matrix blocks.
+					// Only execute update for blocks that are required.
+					// This helps to keep constant latencies between data dependencies of the pipeline stages
+					if (ti >= k && j >= k) {
+						/*
+						Update order of block is:
+						First the block below the LU block
+						Then the row of blocks right of LU block
+						This way the left block of the next column will always be calculated in advance 
+						because it will be needed as input for the subsequent blocks.
+						*/
+						int i = (j == k) ? ti + 1 : ti;
+
+						// The last left block will be out of bounds because of the update strategy described above
+						// Skip it
+						if (i < BLOCK_SIZE/GEMM_BLOCK) {
+
+							// TODO Split this up into three different styles to reduce logic usage?
 						
-						// copy the correct block in the second input buffer
-						// this depends on the operations that has to be executed
-						DEVICE_DATA_TYPE second_input[GEMM_BLOCK];
-						if (j == k) {
-							// left matrix block will be calculated
-							__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
-							for (int jj =0; jj < GEMM_BLOCK; jj++) {
-								second_input[jj] = __fpga_reg(lu_a_buffer_out_row[jj]);
+							// copy the correct block in the second input buffer
+							// this depends on the operations that has to be executed
+							DEVICE_DATA_TYPE second_input[GEMM_BLOCK];
+							if (j == k) {
+								// left matrix block will be calculated
+								__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
+								for (int jj =0; jj < GEMM_BLOCK; jj++) {
+									second_input[jj] = __fpga_reg(lu_a_buffer_out_row[jj]);
+								}
 							}
-						}
-						else if (i == k) {
-							// top matrix block will be calculated
-							__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
-							for (int jj =0; jj < GEMM_BLOCK; jj++) {
-								second_input[jj] = __fpga_reg(lu_a_buffer_out_col[jj]);
+							else if (i == k) {
+								// top matrix block will be calculated
+								__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
+								for (int jj =0; jj < GEMM_BLOCK; jj++) {
+									second_input[jj] = __fpga_reg(lu_a_buffer_out_col[jj]);
+								}
 							}
-						}
-						else {
-							// inner block will be calculated
-							__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
-							for (int jj =0; jj < GEMM_BLOCK; jj++) {
-								second_input[jj] = __fpga_reg(left_buffer[ti & 1][jj]);
+							else {
+								// inner block will be calculated
+								__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
+								for (int jj =0; jj < GEMM_BLOCK; jj++) {
+									second_input[jj] = __fpga_reg(left_buffer[ti & 1][jj]);
+								}
 							}
-						}
-						DEVICE_DATA_TYPE a_input[GEMM_BLOCK][GEMM_BLOCK];
-						__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
-						for (int ii =0; ii < GEMM_BLOCK; ii++) {
+							DEVICE_DATA_TYPE a_input[GEMM_BLOCK][GEMM_BLOCK];
 							__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
-							for (int jj = 0; jj < GEMM_BLOCK; jj++) {
-								a_input[ii][jj] = __fpga_reg(a_buffer[i][j][ii][jj]);
+							for (int ii =0; ii < GEMM_BLOCK; ii++) {
+								__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
+								for (int jj = 0; jj < GEMM_BLOCK; jj++) {
+									a_input[ii][jj] = __fpga_reg(a_buffer[i][j][ii][jj]);
+								}
 							}
-						}
-						DEVICE_DATA_TYPE top_input[GEMM_BLOCK];
-						if (ttj >= BLOCK_SIZE/GEMM_BLOCK) {
-							__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
-							for (int jj =0; jj < GEMM_BLOCK; jj++) {
-								top_input[jj] = __fpga_reg(top_buffer[j][jj]);
+							DEVICE_DATA_TYPE top_input[GEMM_BLOCK];
+							if (ttj >= BLOCK_SIZE/GEMM_BLOCK) {
+								__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
+								for (int jj =0; jj < GEMM_BLOCK; jj++) {
+									top_input[jj] = __fpga_reg(top_buffer[j][jj]);
+								}
 							}
-						}
-						DEVICE_DATA_TYPE out[GEMM_BLOCK][GEMM_BLOCK] __attribute__((register));
-						update_block(a_input, 
-										top_input, 
-										second_input, 
-										out,
-										kk,
-										(i == k) ? 0 : ((j == k) ? 1 : 2));
-						if (ttj < BLOCK_SIZE/GEMM_BLOCK) {
-							// only update in the first row
-							__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
-							for (int jj =0; jj < GEMM_BLOCK; jj++) {
-								top_buffer[ttj][jj] = __fpga_reg(out[kk][jj]);
+							DEVICE_DATA_TYPE out[GEMM_BLOCK][GEMM_BLOCK] __attribute__((register));
+							update_block(a_input, 
+											top_input, 
+											second_input, 
+											out,
+											kk,
+											(i == k) ? 0 : ((j == k) ? 1 : 2));
+							if (ttj < BLOCK_SIZE/GEMM_BLOCK) {
+								// only update in the first row
+								__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
+								for (int jj =0; jj < GEMM_BLOCK; jj++) {
+									top_buffer[ttj][jj] = __fpga_reg(out[kk][jj]);
+								}
 							}
-						}
-						if (i > k && j == k) {
-							__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
-							for (int ii =0; ii < GEMM_BLOCK; ii++) {
-								left_buffer[(ti + 1) & 1][ii] = __fpga_reg(out[ii][kk]);
+							if (i > k && j == k) {
+								__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
+								for (int ii =0; ii < GEMM_BLOCK; ii++) {
+									left_buffer[(ti + 1) & 1][ii] = __fpga_reg(out[ii][kk]);
+								}
 							}
-						}
-						__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
-						for (int ii =0; ii < GEMM_BLOCK; ii++) {
 							__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
-							for (int jj = 0; jj < GEMM_BLOCK; jj++) {
-								a_buffer[i][j][ii][jj] = __fpga_reg(out[ii][jj]);
+							for (int ii =0; ii < GEMM_BLOCK; ii++) {
+								__attribute__((opencl_unroll_hint(GEMM_BLOCK)))
+								for (int jj = 0; jj < GEMM_BLOCK; jj++) {
+									a_buffer[i][j][ii][jj] = __fpga_reg(out[ii][jj]);
+								}
 							}
 						}
 					}
@@ -582,12 +591,15 @@ lu(__global DEVICE_DATA_TYPE* restrict a,
 /**
 Update the blocks to the right of the current LU block
 
+is_factorized: if true, the block was already calculated by the host. The LU block is still received,
+			   but the rows are forwarded without any update
  */
  __attribute__((uses_global_work_offset(0)))
 __kernel
 void top_update(__global DEVICE_DATA_TYPE* restrict a, 
 				__global DEVICE_DATA_TYPE* restrict lu_global_buffer,
 				const uint is_first_block,
+				const uint is_factorized,
 				const uint block_col,
 				const uint block_row,
 				const uint blocks_per_row) {
@@ -650,7 +662,7 @@ void top_update(__global DEVICE_DATA_TYPE* restrict a,
 					}
 				}
 				if (col == 0) {
-					current_scale = col_in.data[kk];
+					current_scale = (is_factorized) ? 1.0 : col_in.data[kk];
 				}
 				#pragma unroll
 				for (int i =0; i < GEMM_BLOCK; i++) {
@@ -684,21 +696,23 @@ void top_update(__global DEVICE_DATA_TYPE* restrict a,
 			}
 		}
 
-		// Update all remaining rows
-		#pragma loop_coalesce
-		for (int row = 0; row < BLOCK_SIZE/GEMM_BLOCK - k; row++) {
-			// Update whole rows!
-			for (int curr_col = 0; curr_col < BLOCK_SIZE/GEMM_BLOCK; curr_col++) {
-				DEVICE_DATA_TYPE colbuf[GEMM_BLOCK];
-				#pragma unroll
-				for (int j=0; j < GEMM_BLOCK; j++) {
-					colbuf[j] = current_lu_col[row][j];
-				}	
-				#pragma unroll
-				for (int i = 0; i < GEMM_BLOCK; i++) {
+		if (!is_factorized) {
+			// Update all remaining rows
+			#pragma loop_coalesce
+			for (int row = 0; row < BLOCK_SIZE/GEMM_BLOCK - k; row++) {
+				// Update whole rows!
+				for (int curr_col = 0; curr_col < BLOCK_SIZE/GEMM_BLOCK; curr_col++) {
+					DEVICE_DATA_TYPE colbuf[GEMM_BLOCK];
 					#pragma unroll
 					for (int j=0; j < GEMM_BLOCK; j++) {
-						a_buffer[row + k][curr_col][i][j] += colbuf[i] * current_row[curr_col][j];
+						colbuf[j] = current_lu_col[row][j];
+					}	
+					#pragma unroll
+					for (int i = 0; i < GEMM_BLOCK; i++) {
+						#pragma unroll
+						for (int j=0; j < GEMM_BLOCK; j++) {
+							a_buffer[row + k][curr_col][i][j] += colbuf[i] * current_row[curr_col][j];
+						}
 					}
 				}
 			}
@@ -28,6 +28,8 @@ SOFTWARE.
 #include <memory>
 #include <vector>
 #include <list>
+#include <map>
+#include <string>
 
 /* External library headers */
 #if QUARTUS_MAJOR_VERSION > 18
@@ -53,7 +55,22 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
     uint blocks_per_row = data.matrix_width / config.programSettings->blockSize;
     uint blocks_per_col = data.matrix_height / config.programSettings->blockSize;
 
-    cl::CommandQueue buffer_queue(*config.context, *config.device, 0, &err);
+    // Without diagonal dominance, the panels are factorized on the host with partial pivoting over the whole column.
+    // The communicators are used to search the pivots and to exchange the rows.
+    bool use_pivoting = !config.programSettings->isDiagonallyDominant;
+    MPI_Comm row_communicator;
+    MPI_Comm col_communicator;
+
+    MPI_Comm_split(MPI_COMM_WORLD, config.programSettings->torus_row, 0, &row_communicator);
+    MPI_Comm_split(MPI_COMM_WORLD, config.programSettings->torus_col, 0, &col_communicator);
+
+    std::vector<HOST_DATA_TYPE> panel;
+    std::vector<cl_int> panel_pivots(config.programSettings->blockSize);
+    if (use_pivoting) {
+        panel.resize(config.programSettings->blockSize * data.matrix_width);
+    }
+
+    cl::CommandQueue buffer_queue(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
     ASSERT_CL(err)
 
     // Create Buffers for input and output
@@ -61,8 +78,6 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                                         sizeof(HOST_DATA_TYPE)*data.matrix_width*data.matrix_height);
     cl::Buffer Buffer_b(*config.context, CL_MEM_READ_WRITE,
                                         sizeof(HOST_DATA_TYPE)*data.matrix_width);
-    cl::Buffer Buffer_pivot(*config.context, CL_MEM_READ_WRITE,
-                                        sizeof(cl_int)*data.matrix_height);
 
     // Buffers only used to store data received over the network layer
     // The content will not be modified by the host
@@ -77,13 +92,44 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
     cl::Buffer Buffer_network_scaling(*config.context, CL_MEM_READ_WRITE,
                                         sizeof(HOST_DATA_TYPE)*(config.programSettings->blockSize));
 
+    // Create every kernel only once. The kernels are reused for every block by updating their arguments
+    // before each enqueue, since the arguments are captured by the runtime when the kernel is enqueued.
+    std::map<std::string, cl::Kernel> kernel_pool;
+    for (std::string name : {"lu", "top_update", "left_update", "network_layer_bottomright", "network_layer_top", "network_layer_left"}) {
+        kernel_pool.emplace(name, cl::Kernel(*config.program, name.c_str(), &err));
+        ASSERT_CL(err)
+    }
+    for (uint rep = 0; rep < config.programSettings->kernelReplications; rep++) {
+        std::string name = "inner_update_mm" + std::to_string(rep);
+        kernel_pool.emplace(name, cl::Kernel(*config.program, name.c_str(), &err));
+        ASSERT_CL(err)
+    }
+
+    // Ring of event lists used to express the dependencies between the blocks. Every kernel waits for the
+    // events of the previous list and signals into the current list. The final synchronization needs the last
+    // torus_width lists, so the lists are reused instead of allocating two new lists for every block row.
+    std::vector<std::vector<cl::Event>> all_events(config.programSettings->torus_width + 2);
+    uint event_list_count = 0;
+    auto current_events = [&]() -> std::vector<cl::Event>& { return all_events[event_list_count % all_events.size()]; };
+    auto previous_events = [&]() -> std::vector<cl::Event>& { return all_events[(event_list_count - 1) % all_events.size()]; };
+    auto next_events = [&](bool keep_events) {
+        event_list_count++;
+        if (keep_events) {
+            current_events().assign(previous_events().begin(), previous_events().end());
+        }
+        else {
+            current_events().clear();
+        }
+    };
+
     /* --- Execute actual benchmark kernels --- */
 
     double t;
     std::vector<double> gefaExecutionTimes;
     std::vector<double> geslExecutionTimes;
     std::vector<double> gefaWaitTimes;
-    for (int i = 0; i < config.programSettings->numRepetitions; i++) {
+    config.repetitions->start(*config.programSettings);
+    for (int i = 0; config.repetitions->next(gefaExecutionTimes); i++) {
 
         err = buffer_queue.enqueueWriteBuffer(Buffer_a, CL_TRUE, 0,
                                     sizeof(HOST_DATA_TYPE)*data.matrix_width*data.matrix_height, data.A);
@@ -105,22 +151,19 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
         std::vector<std::vector<cl::Buffer>> left_buffers;
         std::vector<std::vector<cl::Buffer>> top_buffers;
         std::vector<std::vector<cl::CommandQueue>> inner_queues;
-        std::vector<std::vector<cl::Kernel>> kernels;
 
         // User event that is used to start actual execution of benchmark kernels
         cl::UserEvent start_event(*config.context, &err);
         ASSERT_CL(err);
-        std::vector<std::vector<cl::Event>> all_events;
-        all_events.emplace_back();
-        all_events.back().emplace_back(start_event);
-        all_events.emplace_back();
+        event_list_count = 0;
+        current_events().assign(1, start_event);
+        next_events(false);
 
         left_buffers.emplace_back();
         top_buffers.emplace_back();
-        kernels.emplace_back();
         inner_queues.emplace_back();
         for (uint rep = 0; rep < config.programSettings->kernelReplications; rep++) {
-            inner_queues.back().emplace_back(*config.context, *config.device, 0, &err);
+            inner_queues.back().emplace_back(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
             ASSERT_CL(err)
         }
 
@@ -138,18 +181,31 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
         // For every row of blocks create kernels and enqueue them
         for (int block_row=0; block_row < config.programSettings->matrixSize / config.programSettings->blockSize; block_row++) {
 
+            if (use_pivoting && block_row > 0) {
+                // The pivot search needs the whole updated panel, so all operations of the previous block row have to be finished
+                for (auto queues : {&lu_queues, &top_queues, &left_queues, &network_queues_bottomright, &network_queues_top, &network_queues_left}) {
+                    queues->back().finish();
+                }
+                // The inner updates of a block row are distributed over the last two lists of queues
+                for (auto inner = std::prev(inner_queues.end(), std::min(inner_queues.size(), static_cast<size_t>(2))); inner != inner_queues.end(); inner++) {
+                    for (auto& queue : *inner) {
+                        queue.finish();
+                    }
+                }
+            }
+
             // Create Command queues
-            lu_queues.emplace_back(*config.context, *config.device, 0, &err);
+            lu_queues.emplace_back(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
             ASSERT_CL(err)
-            top_queues.emplace_back(*config.context, *config.device, 0, &err);
+            top_queues.emplace_back(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
             ASSERT_CL(err)
-            left_queues.emplace_back(*config.context, *config.device, 0, &err);
+            left_queues.emplace_back(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
             ASSERT_CL(err)
-            network_queues_bottomright.emplace_back(*config.context, *config.device, 0, &err);
+            network_queues_bottomright.emplace_back(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
             ASSERT_CL(err)
-            network_queues_top.emplace_back(*config.context, *config.device, 0, &err);
+            network_queues_top.emplace_back(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
             ASSERT_CL(err)
-            network_queues_left.emplace_back(*config.context, *config.device, 0, &err);
+            network_queues_left.emplace_back(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
             ASSERT_CL(err)
 
             // already emplace new buffer list for next iteration since left and top buffers need to be stored until all MMs are executed.
@@ -176,58 +232,82 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
             std::fill(network_layer_op_flags.begin(), network_layer_op_flags.end(), 0);
             bool is_calulating_lu_block = (in_same_col_as_lu && in_same_row_as_lu);
 
+            if (use_pivoting) {
+                // The panel contains the LU block and all top blocks. The lu and top_update kernels only send the final values afterwards
+                size_t panel_offset = sizeof(HOST_DATA_TYPE) * local_block_row * config.programSettings->blockSize * data.matrix_width;
+                size_t panel_size = sizeof(HOST_DATA_TYPE) * panel.size();
+                if (in_same_row_as_lu) {
+                    err = lu_queues.back().enqueueReadBuffer(Buffer_a, CL_TRUE, panel_offset, panel_size, panel.data());
+                    ASSERT_CL(err)
+                    linpack::distributed_gefa_panel(panel.data(), data.matrix_width, config.programSettings->blockSize, block_row,
+                                                    config.programSettings->torus_width, config.programSettings->torus_col, row_communicator, panel_pivots.data());
+                    std::copy(panel_pivots.begin(), panel_pivots.end(), data.ipvt + local_block_row * config.programSettings->blockSize);
+                    err = lu_queues.back().enqueueWriteBuffer(Buffer_a, CL_TRUE, panel_offset, panel_size, panel.data());
+                    ASSERT_CL(err)
+                }
+                // Every rank needs the pivots to exchange the rows of its trailing matrix
+                MPI_Bcast(panel_pivots.data(), config.programSettings->blockSize, MPI_INT, local_block_row_remainder, col_communicator);
+                linpack::distributed_exchange_pivot_rows(lu_queues.back(), Buffer_a, data.matrix_width, start_row_index * config.programSettings->blockSize,
+                                                        data.matrix_height - start_row_index * config.programSettings->blockSize, panel_pivots.data(),
+                                                        config.programSettings->blockSize, block_row, config.programSettings->torus_width,
+                                                        config.programSettings->torus_col, row_communicator);
+            }
+
             if (is_calulating_lu_block) {
-                // create the LU kernel
-                kernels.back().emplace_back(*config.program, "lu",
-                                            &err);
+                cl::Kernel& kernel = kernel_pool.at("lu");
 #ifndef NDEBUG
                 std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col << " LU     " << local_block_row << "," << local_block_col <<  std::endl;
 #endif
-                err = kernels.back().back().setArg(0, Buffer_a);
+                err = kernel.setArg(0, Buffer_a);
                 ASSERT_CL(err);
-                err = kernels.back().back().setArg(1, local_block_col);
+                err = kernel.setArg(1, use_pivoting ? CL_TRUE : CL_FALSE);
+                ASSERT_CL(err);
+                err = kernel.setArg(2, local_block_col);
                 ASSERT_CL(err)
-                err = kernels.back().back().setArg(2, local_block_row);
+                err = kernel.setArg(3, local_block_row);
                 ASSERT_CL(err)
-                err =kernels.back().back().setArg(3, blocks_per_row);
+                err = kernel.setArg(4, blocks_per_row);
                 ASSERT_CL(err)
-                all_events.back().emplace_back();
-                err = lu_queues.back().enqueueNDRangeKernel(kernels.back().back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &(*std::prev(std::prev(all_events.end()))), &all_events.back().back());
+                current_events().emplace_back();
+                err = lu_queues.back().enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &previous_events(), &current_events().back());
                 ASSERT_CL(err)
+                config.profiler->addEvent("lu", current_events().back());
 
 
                 network_layer_op_flags[0] |= LU_BLOCK_OUT;
             }
 
             if (num_top_blocks > 0) {
-                // Create top kernels
+                // Enqueue top kernels
                 for (int tops=start_col_index; tops < blocks_per_row; tops++) {
-                    kernels.back().emplace_back(*config.program, "top_update",
-                                                    &err);
+                    cl::Kernel& kernel = kernel_pool.at("top_update");
 #ifndef NDEBUG
                     std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col << " Top    " << local_block_row << "," << tops <<  std::endl;
 #endif
                     ASSERT_CL(err);     
-                    err = kernels.back().back().setArg(0, Buffer_a);
+                    err = kernel.setArg(0, Buffer_a);
                     ASSERT_CL(err);    
-                    err = kernels.back().back().setArg(1, Buffer_lu1);
+                    err = kernel.setArg(1, Buffer_lu1);
+                    ASSERT_CL(err) 
+                    err = kernel.setArg(2, (tops == start_col_index) ? CL_TRUE : CL_FALSE);
                     ASSERT_CL(err) 
-                    err = kernels.back().back().setArg(2, (tops == start_col_index) ? CL_TRUE : CL_FALSE);
+                    err = kernel.setArg(3, use_pivoting ? CL_TRUE : CL_FALSE);
                     ASSERT_CL(err) 
-                    err = kernels.back().back().setArg(3, tops);
+                    err = kernel.setArg(4, tops);
                     ASSERT_CL(err)
-                    err = kernels.back().back().setArg(4, local_block_row);
+                    err = kernel.setArg(5, local_block_row);
                     ASSERT_CL(err)
-                    err = kernels.back().back().setArg(5, blocks_per_row);
+                    err = kernel.setArg(6, blocks_per_row);
                     ASSERT_CL(err)
 
                     if (tops + 1 == blocks_per_row) {
-                        all_events.back().emplace_back();
-                        err = top_queues.back().enqueueNDRangeKernel(kernels.back().back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &(*std::prev(std::prev(all_events.end()))), &(all_events.back().back()));
-                        ASSERT_CL(err) 
+                        current_events().emplace_back();
+                        err = top_queues.back().enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &previous_events(), &(current_events().back()));
+                        ASSERT_CL(err)
+                        config.profiler->addEvent("top_update", current_events().back());
                     }
                     else {
-                        err = top_queues.back().enqueueNDRangeKernel(kernels.back().back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &(*std::prev(std::prev(all_events.end()))));
+                        err = top_queues.back().enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &previous_events(), config.profiler->event("top_update"));
                         ASSERT_CL(err) 
                     }
         
@@ -237,34 +317,34 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                 }
             }
             if (num_left_blocks > 0) {
-                // Create left kernels
+                // Enqueue left kernels
                 for (int tops=start_row_index; tops < blocks_per_col; tops++) {
-                    kernels.back().emplace_back(*config.program, "left_update",
-                                                    &err);
+                    cl::Kernel& kernel = kernel_pool.at("left_update");
 #ifndef NDEBUG
                     std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col <<  " Left   " <<tops  << "," << local_block_col <<  std::endl;
 #endif
                     ASSERT_CL(err);     
-                    err = kernels.back().back().setArg(0, Buffer_a);
+                    err = kernel.setArg(0, Buffer_a);
                     ASSERT_CL(err);    
-                    err = kernels.back().back().setArg(1, Buffer_lu2);
+                    err = kernel.setArg(1, Buffer_lu2);
                     ASSERT_CL(err) 
-                    err = kernels.back().back().setArg(2, (tops == start_row_index) ? CL_TRUE : CL_FALSE);
+                    err = kernel.setArg(2, (tops == start_row_index) ? CL_TRUE : CL_FALSE);
                     ASSERT_CL(err) 
-                    err = kernels.back().back().setArg(3, local_block_col);
+                    err = kernel.setArg(3, local_block_col);
                     ASSERT_CL(err)
-                    err = kernels.back().back().setArg(4, tops);
+                    err = kernel.setArg(4, tops);
                     ASSERT_CL(err)
-                    err = kernels.back().back().setArg(5, blocks_per_row);
+                    err = kernel.setArg(5, blocks_per_row);
                     ASSERT_CL(err)
 
                     if (tops + 1 == blocks_per_col) {
-                        all_events.back().emplace_back();
-                        err = left_queues.back().enqueueNDRangeKernel(kernels.back().back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1), &(*std::prev(std::prev(all_events.end()))), &(all_events.back().back()));
-                        ASSERT_CL(err) 
+                        current_events().emplace_back();
+                        err = left_queues.back().enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(1), cl::NDRange(1), &previous_events(), &(current_events().back()));
+                        ASSERT_CL(err)
+                        config.profiler->addEvent("left_update", current_events().back());
                     }
                     else {
-                        err = left_queues.back().enqueueNDRangeKernel(kernels.back().back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1), &(*std::prev(std::prev(all_events.end()))));
+                        err = left_queues.back().enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(1), cl::NDRange(1), &previous_events(), config.profiler->event("left_update"));
                         ASSERT_CL(err) 
                     }
                     network_layer_op_flags[0] |= LEFT_BLOCK;
@@ -277,7 +357,7 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                 // create at least a single network kernel to forward data if required!
                 network_layer_op_flags.emplace_back(0);
             }
-            // Create network kernels
+            // Enqueue network kernels
             int nw_exe_count = 0;
             for (auto it = network_layer_op_flags.begin(); it < network_layer_op_flags.end(); it++) {
 
@@ -322,66 +402,64 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                 }
 
                 if (it == network_layer_op_flags.begin()) {
-                    // Create the network kernel
-                    kernels.back().emplace_back(*config.program, "network_layer_bottomright",
-                                                &err);
+                    cl::Kernel& kernel = kernel_pool.at("network_layer_bottomright");
     #ifndef NDEBUG
                     std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col <<  " Nw ->    " << op_flags << "," << network_forward_flags <<  std::endl;
     #endif
                     ASSERT_CL(err);
-                    err = kernels.back().back().setArg(0, op_flags);
+                    err = kernel.setArg(0, op_flags);
                     ASSERT_CL(err)
-                    err = kernels.back().back().setArg(1, network_forward_flags);
+                    err = kernel.setArg(1, network_forward_flags);
                     ASSERT_CL(err)
                     
-                    err = network_queues_bottomright.back().enqueueNDRangeKernel(kernels.back().back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1), &(*std::prev(std::prev(all_events.end()))));
+                    err = network_queues_bottomright.back().enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(1), cl::NDRange(1), &previous_events(), config.profiler->event("network_layer_bottomright"));
                     ASSERT_CL(err) 
                 }
-                // Create the network kernel for down -> top direction
-                kernels.back().emplace_back(*config.program, "network_layer_top",
-                                            &err);
+                // Enqueue the network kernel for down -> top direction
+                cl::Kernel& kernel_top = kernel_pool.at("network_layer_top");
     #ifndef NDEBUG
                 std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col <<  " Nw T <-    " << op_flags << "," << network_forward_flags <<  std::endl;
     #endif
                 ASSERT_CL(err);
-                err = kernels.back().back().setArg(0, (top_block_is_received) ? top_buffers.back().back() : Buffer_network_scaling);
+                err = kernel_top.setArg(0, (top_block_is_received) ? top_buffers.back().back() : Buffer_network_scaling);
                 ASSERT_CL(err);
-                err = kernels.back().back().setArg(1, op_flags);
+                err = kernel_top.setArg(1, op_flags);
                 ASSERT_CL(err)
-                err = kernels.back().back().setArg(2, network_forward_flags);
+                err = kernel_top.setArg(2, network_forward_flags);
                 ASSERT_CL(err)
 
                 if (std::distance(it,network_layer_op_flags.end()) == 1) {
-                    all_events.back().emplace_back();
-                    err = network_queues_top.back().enqueueNDRangeKernel(kernels.back().back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1), &(*std::prev(std::prev(all_events.end()))), &(all_events.back().back()));
-                    ASSERT_CL(err) 
+                    current_events().emplace_back();
+                    err = network_queues_top.back().enqueueNDRangeKernel(kernel_top, cl::NullRange, cl::NDRange(1), cl::NDRange(1), &previous_events(), &(current_events().back()));
+                    ASSERT_CL(err)
+                    config.profiler->addEvent("network_layer_top", current_events().back());
                 }
                 else {
-                    err = network_queues_top.back().enqueueNDRangeKernel(kernels.back().back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1), &(*std::prev(std::prev(all_events.end()))));
+                    err = network_queues_top.back().enqueueNDRangeKernel(kernel_top, cl::NullRange, cl::NDRange(1), cl::NDRange(1), &previous_events(), config.profiler->event("network_layer_top"));
                     ASSERT_CL(err)    
                 }
 
-                // Create the network kernel for right -> left direction
-                kernels.back().emplace_back(*config.program, "network_layer_left",
-                                            &err);
+                // Enqueue the network kernel for right -> left direction
+                cl::Kernel& kernel_left = kernel_pool.at("network_layer_left");
     #ifndef NDEBUG
                 std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col <<  " Nw L <-    " << op_flags << "," << network_forward_flags <<  std::endl;
     #endif
                 ASSERT_CL(err);
-                err = kernels.back().back().setArg(0, (left_block_is_received) ? left_buffers.back().back() : Buffer_network_scaling);
+                err = kernel_left.setArg(0, (left_block_is_received) ? left_buffers.back().back() : Buffer_network_scaling);
                 ASSERT_CL(err);
-                err = kernels.back().back().setArg(1, op_flags);
+                err = kernel_left.setArg(1, op_flags);
                 ASSERT_CL(err)
-                err = kernels.back().back().setArg(2, network_forward_flags);
+                err = kernel_left.setArg(2, network_forward_flags);
                 ASSERT_CL(err)
 
                 if (std::distance(it,network_layer_op_flags.end()) == 1) {
-                    all_events.back().emplace_back();
-                    err = network_queues_left.back().enqueueNDRangeKernel(kernels.back().back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1), &(*std::prev(std::prev(all_events.end()))), &(all_events.back().back()));
-                    ASSERT_CL(err) 
+                    current_events().emplace_back();
+                    err = network_queues_left.back().enqueueNDRangeKernel(kernel_left, cl::NullRange, cl::NDRange(1), cl::NDRange(1), &previous_events(), &(current_events().back()));
+                    ASSERT_CL(err)
+                    config.profiler->addEvent("network_layer_left", current_events().back());
                 }
                 else {
-                    err = network_queues_left.back().enqueueNDRangeKernel(kernels.back().back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1), &(*std::prev(std::prev(all_events.end()))));
+                    err = network_queues_left.back().enqueueNDRangeKernel(kernel_left, cl::NullRange, cl::NDRange(1), cl::NDRange(1), &previous_events(), config.profiler->event("network_layer_left"));
                     ASSERT_CL(err)    
                 }
 
@@ -391,7 +469,7 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
 
             // update all remaining inner blocks using only global memory
 
-            all_events.emplace_back(all_events.back());
+            next_events(true);
             //auto communication_events = all_events.back();
 
             uint current_update = 0;
@@ -401,23 +479,22 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
             uint total_updates_per_replication = total_inner_updates/ config.programSettings->kernelReplications;
             for (auto l = std::next(left_buffers.back().begin()); l < left_buffers.back().end(); l++) {
                 // select the matrix multiplication kernel that should be used for this block updated 
-                kernels.back().emplace_back(*config.program, ("inner_update_mm" + std::to_string(current_replication)).c_str(),
-                                    &err);
+                cl::Kernel& kernel = kernel_pool.at("inner_update_mm" + std::to_string(current_replication));
 
                 int block_col = static_cast<cl_uint>((blocks_per_row) - num_inner_block_cols);
                 int block_row = static_cast<cl_uint>((blocks_per_col) - num_inner_block_rows + std::distance(left_buffers.back().begin(), l));  
                 ASSERT_CL(err);
-                err = kernels.back().back().setArg(0, Buffer_a);
+                err = kernel.setArg(0, Buffer_a);
                 ASSERT_CL(err);
-                err = kernels.back().back().setArg(1, *l);
+                err = kernel.setArg(1, *l);
                 ASSERT_CL(err)
-                err = kernels.back().back().setArg(2, *top_buffers.back().begin());
+                err = kernel.setArg(2, *top_buffers.back().begin());
                 ASSERT_CL(err)
-                err = kernels.back().back().setArg(3, block_col);
+                err = kernel.setArg(3, block_col);
                 ASSERT_CL(err)
-                err = kernels.back().back().setArg(4, block_row);
+                err = kernel.setArg(4, block_row);
                 ASSERT_CL(err)
-                err = kernels.back().back().setArg(5, blocks_per_row);
+                err = kernel.setArg(5, blocks_per_row);
                 ASSERT_CL(err)
 
                 if ((left_buffers.back().size() - 1) - current_update <= config.programSettings->kernelReplications) {
@@ -425,9 +502,11 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                     std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col << " Inner L Ev " << block_row << "," << block_col <<  std::endl;
 #endif 
                     // this is the last taks that will be enqueued in this queue, so create an event
-                    all_events.back().emplace_back();
+                    current_events().emplace_back();
                     // Distribute the workload over all available matrix multiplication kernels
-                    err = inner_queues.back()[(current_replication)].enqueueNDRangeKernel(kernels.back().back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &(*std::prev(std::prev(all_events.end()))), &(all_events.back().back()));         
+                    err = inner_queues.back()[(current_replication)].enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &previous_events(), &(current_events().back()));
+                    ASSERT_CL(err)
+                    config.profiler->addEvent("inner_update_mm", current_events().back());
                     //err = inner_queues.back()[(current_replication)].enqueueNDRangeKernel(kernels.back().back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &communication_events, &(all_events.back().back()));         
                 }
                 else {
@@ -435,7 +514,7 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                     std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col << " Inner L " << block_row << "," << block_col <<  std::endl;
 #endif 
                     // Distribute the workload over all available matrix multiplication kernels
-                    err = inner_queues.back()[(current_replication)].enqueueNDRangeKernel(kernels.back().back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &(*std::prev(std::prev(all_events.end()))));         
+                    err = inner_queues.back()[(current_replication)].enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &previous_events(), config.profiler->event("inner_update_mm"));
                     //err = inner_queues.back()[(current_replication)].enqueueNDRangeKernel(kernels.back().back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &communication_events);         
                 }
                 current_update++;
@@ -445,24 +524,23 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
             current_update = 0;
             for (auto t = top_buffers.back().begin(); t < top_buffers.back().end(); t++) {
                 // select the matrix multiplication kernel that should be used for this block updated 
-                kernels.back().emplace_back(*config.program, ("inner_update_mm" + std::to_string(current_replication)).c_str(),
-                                    &err);
+                cl::Kernel& kernel = kernel_pool.at("inner_update_mm" + std::to_string(current_replication));
 
                 int block_col = static_cast<cl_uint>((blocks_per_row) - num_inner_block_cols + std::distance(top_buffers.back().begin(), t));
                 int block_row = static_cast<cl_uint>((blocks_per_col) - num_inner_block_rows);
 
                 ASSERT_CL(err);
-                err = kernels.back().back().setArg(0, Buffer_a);
+                err = kernel.setArg(0, Buffer_a);
                 ASSERT_CL(err);
-                err = kernels.back().back().setArg(1, *left_buffers.back().begin());
+                err = kernel.setArg(1, *left_buffers.back().begin());
                 ASSERT_CL(err)
-                err = kernels.back().back().setArg(2, *t);
+                err = kernel.setArg(2, *t);
                 ASSERT_CL(err)
-                err = kernels.back().back().setArg(3, block_col);
+                err = kernel.setArg(3, block_col);
                 ASSERT_CL(err)
-                err = kernels.back().back().setArg(4, block_row);
+                err = kernel.setArg(4, block_row);
                 ASSERT_CL(err)
-                err = kernels.back().back().setArg(5, blocks_per_row);
+                err = kernel.setArg(5, blocks_per_row);
                 ASSERT_CL(err)
                 // If number of blocks is not dividable by the number of replications, the first replications will do one update more
                 if (top_buffers.back().size() - current_update <= config.programSettings->kernelReplications) {
@@ -470,16 +548,18 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                     std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col << " Inner T Ev " << block_row << "," << block_col <<  std::endl;
 #endif 
                     // this is the last taks that will be enqueued in this queue, so create an event
-                    all_events.back().emplace_back();
+                    current_events().emplace_back();
                     // Distribute the workload over all available matrix multiplication kernels
-                    err = inner_queues.back()[(current_replication)].enqueueNDRangeKernel(kernels.back().back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &(*std::prev(std::prev(all_events.end()))), &(all_events.back().back()));         
+                    err = inner_queues.back()[(current_replication)].enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &previous_events(), &(current_events().back()));
+                    ASSERT_CL(err)
+                    config.profiler->addEvent("inner_update_mm", current_events().back());
                 }
                 else {
 #ifndef NDEBUG
                     std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col << " Inner T " << block_row << "," << block_col <<  std::endl;
 #endif 
                     // Distribute the workload over all available matrix multiplication kernels
-                    err = inner_queues.back()[(current_replication)].enqueueNDRangeKernel(kernels.back().back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &(*std::prev(std::prev(all_events.end()))));         
+                    err = inner_queues.back()[(current_replication)].enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &previous_events(), config.profiler->event("inner_update_mm"));
                 }
                 ASSERT_CL(err) 
                 current_update++;
@@ -487,36 +567,34 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
             }
             
             // count the inner MM already to next iteration by creating new buffers in the queue
-            all_events.emplace_back();
-            kernels.emplace_back();
+            next_events(false);
             inner_queues.emplace_back();
             current_update = 0;
             for (uint rep = 0; rep < config.programSettings->kernelReplications; rep++) {
-                inner_queues.back().emplace_back(*config.context, *config.device, 0, &err);
+                inner_queues.back().emplace_back(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
                 ASSERT_CL(err)
             }
 
             for (auto l = std::next(left_buffers.back().begin()); l < left_buffers.back().end(); l++) {
                 for (auto t = std::next(top_buffers.back().begin()); t < top_buffers.back().end(); t++) {
                     // select the matrix multiplication kernel that should be used for this block updated 
-                    kernels.back().emplace_back(*config.program, ("inner_update_mm" + std::to_string(current_replication)).c_str(),
-                                        &err);
+                    cl::Kernel& kernel = kernel_pool.at("inner_update_mm" + std::to_string(current_replication));
 
                     int block_col = static_cast<cl_uint>((blocks_per_row) - num_inner_block_cols + std::distance(top_buffers.back().begin(), t));
                     int block_row = static_cast<cl_uint>((blocks_per_col) - num_inner_block_rows + std::distance(left_buffers.back().begin(), l));
   
                     ASSERT_CL(err);
-                    err = kernels.back().back().setArg(0, Buffer_a);
+                    err = kernel.setArg(0, Buffer_a);
                     ASSERT_CL(err);
-                    err = kernels.back().back().setArg(1, *l);
+                    err = kernel.setArg(1, *l);
                     ASSERT_CL(err)
-                    err = kernels.back().back().setArg(2, *t);
+                    err = kernel.setArg(2, *t);
                     ASSERT_CL(err)
-                    err = kernels.back().back().setArg(3, block_col);
+                    err = kernel.setArg(3, block_col);
                     ASSERT_CL(err)
-                    err = kernels.back().back().setArg(4, block_row);
+                    err = kernel.setArg(4, block_row);
                     ASSERT_CL(err)
-                    err = kernels.back().back().setArg(5, blocks_per_row);
+                    err = kernel.setArg(5, blocks_per_row);
                     ASSERT_CL(err)
 
                     // If number of blocks is not dividable by the number of replications, the first replications will do one update more
@@ -525,16 +603,18 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                     std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col << " Inner Ev " << block_row << "," << block_col <<  std::endl;
 #endif 
                         // this is the last taks that will be enqueued in this queue, so create an event
-                        all_events.back().emplace_back();
+                        current_events().emplace_back();
                         // Distribute the workload over all available matrix multiplication kernels
-                        err = inner_queues.back()[(current_replication)].enqueueNDRangeKernel(kernels.back().back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &(*std::prev(std::prev(all_events.end()))), &(all_events.back().back()));
+                        err = inner_queues.back()[(current_replication)].enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &previous_events(), &(current_events().back()));
+                        ASSERT_CL(err)
+                        config.profiler->addEvent("inner_update_mm", current_events().back());
                     }
                     else {
 #ifndef NDEBUG
                     std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col << " Inner " << block_row << "," << block_col <<  std::endl;
 #endif 
                         // Distribute the workload over all available matrix multiplication kernels
-                        err = inner_queues.back()[(current_replication)].enqueueNDRangeKernel(kernels.back().back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &(*std::prev(std::prev(all_events.end()))));
+                        err = inner_queues.back()[(current_replication)].enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &previous_events(), config.profiler->event("inner_update_mm"));
                     }
 
                     ASSERT_CL(err)
@@ -603,7 +683,7 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
             std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col << " NW T <- Done    " << block_row <<  std::endl;
             network_queues_left.back().finish();
             std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col << " NW L <- Done    " << block_row <<  std::endl;
-            cl::Event::waitForEvents(all_events.back());
+            cl::Event::waitForEvents(current_events());
             std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col << " Done    " << block_row <<  std::endl;
 
             if (block_row == blocks_per_row * config.programSettings->torus_width - 1) {
@@ -617,7 +697,7 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                 network_queues_left.back().finish();
                 top_queues.back().finish();
                 left_queues.back().finish();
-                cl::Event::waitForEvents(all_events.back());
+                cl::Event::waitForEvents(current_events());
 
             }
             MPI_Barrier(MPI_COMM_WORLD);
@@ -661,8 +741,10 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
 #ifdef NDEBUG
 
         int count = 0;
-        for (auto evs = all_events.end() - config.programSettings->torus_width; evs != all_events.end(); evs++) {
-            cl::Event::waitForEvents(*evs);
+        // wait for the event lists of the last torus_width steps, starting with the oldest one
+        uint wait_lists = std::min(static_cast<uint>(config.programSettings->torus_width), event_list_count + 1);
+        for (uint evs = event_list_count + 1 - wait_lists; evs <= event_list_count; evs++) {
+            cl::Event::waitForEvents(all_events[evs % all_events.size()]);
             // std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col <<  "Step " << count << " of " << all_events.size() << std::endl;
         }
         lu_queues.back().finish();
@@ -688,6 +770,8 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
         timespan = std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1);
         geslExecutionTimes.push_back(timespan.count());
     }
+    config.repetitions->discardWarmup(gefaExecutionTimes);
+    config.repetitions->discardWarmup(geslExecutionTimes);
 
     /* --- Read back results from Device --- */
 
@@ -716,13 +800,12 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                                      sizeof(HOST_DATA_TYPE)*data.matrix_width*data.matrix_height, data.A);
     // buffer_queue.enqueueReadBuffer(Buffer_b, CL_TRUE, 0,
     //                                  sizeof(HOST_DATA_TYPE)*config.programSettings->matrixSize, b);
-    if (!config.programSettings->isDiagonallyDominant) {
-        buffer_queue.enqueueReadBuffer(Buffer_pivot, CL_TRUE, 0,
-                                        sizeof(cl_int)*data.matrix_height, data.ipvt);
-    }
     buffer_queue.finish();
 #endif
 
+    MPI_Comm_free(&row_communicator);
+    MPI_Comm_free(&col_communicator);
+
     std::unique_ptr<linpack::LinpackExecutionTimings> results(
                     new linpack::LinpackExecutionTimings{gefaExecutionTimes, geslExecutionTimes});
     
@@ -25,10 +25,12 @@ SOFTWARE.
 /* C++ standard library headers */
 #include <chrono>
 #include <fstream>
+#include <functional>
 #include <memory>
 #include <vector>
 #include <list>
-#include <thread>
+#include <map>
+#include <string>
 
 /* External library headers */
 #if QUARTUS_MAJOR_VERSION > 18
@@ -40,6 +42,8 @@ SOFTWARE.
 
 #include "parameters.h"
 #include "linpack_benchmark.hpp"
+#include "communication_progress.hpp"
+#include "trace_region.hpp"
 
 namespace linpack {
 namespace execution {
@@ -71,7 +75,7 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
     MPI_Comm_split(MPI_COMM_WORLD, config.programSettings->torus_row, 0, &row_communicator);
     MPI_Comm_split(MPI_COMM_WORLD, config.programSettings->torus_col, 0, &col_communicator);
 
-    cl::CommandQueue buffer_queue(*config.context, *config.device, 0, &err);
+    cl::CommandQueue buffer_queue(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
     ASSERT_CL(err)
 
     // Create Buffers for input and output
@@ -79,14 +83,20 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                                         sizeof(HOST_DATA_TYPE)*data.matrix_height * data.matrix_width);
     cl::Buffer Buffer_b(*config.context, CL_MEM_READ_WRITE,
                                         sizeof(HOST_DATA_TYPE)*data.matrix_width);
-    cl::Buffer Buffer_pivot(*config.context, CL_MEM_READ_WRITE,
-                                        sizeof(cl_int)*data.matrix_height);
 
 
     /* --- Setup MPI communication and required additional buffers --- */
     HOST_DATA_TYPE *lu_block, *lu_trans_block;
-    posix_memalign(reinterpret_cast<void**>(&lu_block), 4096, sizeof(HOST_DATA_TYPE) * (config.programSettings->blockSize)*(config.programSettings->blockSize));
-    posix_memalign(reinterpret_cast<void**>(&lu_trans_block), 4096, sizeof(HOST_DATA_TYPE) * (config.programSettings->blockSize)*(config.programSettings->blockSize));
+    lu_block = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>((config.programSettings->blockSize)*(config.programSettings->blockSize));
+    lu_trans_block = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>((config.programSettings->blockSize)*(config.programSettings->blockSize));
+
+    // Without diagonal dominance, the panels are factorized on the host with partial pivoting over the whole column
+    bool use_pivoting = !config.programSettings->isDiagonallyDominant;
+    std::vector<HOST_DATA_TYPE> panel;
+    std::vector<cl_int> panel_pivots(config.programSettings->blockSize);
+    if (use_pivoting) {
+        panel.resize(config.programSettings->blockSize * data.matrix_width);
+    }
 
     // Buffers only used to store data received over the network layer
     // The content will not be modified by the host
@@ -101,30 +111,112 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
     std::vector<HOST_DATA_TYPE*> top_blocks(blocks_per_row);
 
     for (int i =0; i < blocks_per_row; i++) {
-        posix_memalign(reinterpret_cast<void**>(&(top_blocks[i])), 4096, sizeof(HOST_DATA_TYPE) * (config.programSettings->blockSize)*(config.programSettings->blockSize));
+        top_blocks[i] = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>((config.programSettings->blockSize)*(config.programSettings->blockSize));
         Buffer_top_list.emplace_back(*config.context, CL_MEM_WRITE_ONLY,
                                         sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize));
     }
 
     for (int i =0; i < blocks_per_col; i++) {
-        posix_memalign(reinterpret_cast<void**>(&(left_blocks[i])), 4096, sizeof(HOST_DATA_TYPE) * (config.programSettings->blockSize)*(config.programSettings->blockSize));
+        left_blocks[i] = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>((config.programSettings->blockSize)*(config.programSettings->blockSize));
         Buffer_left_list.emplace_back(*config.context, CL_MEM_WRITE_ONLY,
                                         sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize));
     }
 
+    // Create every kernel only once for every OpenMP thread. The kernels are reused for every block by updating their
+    // arguments before each enqueue, since the arguments are captured by the runtime when the kernel is enqueued.
+    // Every thread gets its own pool, because setting the arguments of a kernel is not thread safe.
+    int num_kernel_pools = 1;
+#ifdef _OPENMP
+    num_kernel_pools = omp_get_max_threads();
+#endif
+    std::vector<std::map<std::string, cl::Kernel>> kernel_pools(num_kernel_pools);
+    for (auto& kernel_pool : kernel_pools) {
+        for (std::string name : {"lu", "top_update", "left_update"}) {
+            kernel_pool.emplace(name, cl::Kernel(*config.program, name.c_str(), &err));
+            ASSERT_CL(err)
+        }
+        for (uint rep = 0; rep < config.programSettings->kernelReplications; rep++) {
+            // the replications of the matrix multiplication are compute units of a single kernel for Xilinx
+#ifdef INTEL_FPGA
+            std::string kernel_name = "inner_update_mm" + std::to_string(rep);
+#endif
+#ifdef XILINX_FPGA
+            std::string kernel_name = "inner_update_mm0:{inner_update_mm0_" + std::to_string(rep + 1) + "}";
+#endif
+            kernel_pool.emplace("inner_update_mm" + std::to_string(rep), cl::Kernel(*config.program, kernel_name.c_str(), &err));
+            ASSERT_CL(err)
+        }
+    }
+
+    // Ring of event lists used to express the dependencies between the blocks. Every kernel waits for the
+    // events of the previous list and signals into the current list, so only the two most recent lists are required.
+    std::vector<std::vector<cl::Event>> all_events(2);
+    uint event_list_count = 0;
+    auto current_events = [&]() -> std::vector<cl::Event>& { return all_events[event_list_count % all_events.size()]; };
+    auto previous_events = [&]() -> std::vector<cl::Event>& { return all_events[(event_list_count - 1) % all_events.size()]; };
+    auto next_events = [&]() {
+        event_list_count++;
+        current_events().clear();
+    };
+
+    // Time the host waits for MPI communication in a repetition. The time is counted as exposed, when the device
+    // has finished all inner updates of the previous block row that could overlap with the communication.
+    std::chrono::duration<double> communication_time;
+    std::chrono::duration<double> exposed_communication_time;
+    auto events_pending = [](const std::vector<cl::Event>& events) {
+        for (auto& ev : events) {
+            if (ev.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() != CL_COMPLETE) {
+                return true;
+            }
+        }
+        return false;
+    };
+    // Wait until all requests are completed and call on_completion with the index of every completed request
+    auto wait_for_requests = [&](std::vector<MPI_Request>& requests, const std::vector<cl::Event>& overlap_events,
+                                    const std::function<void(int)>& on_completion) {
+        auto wait_start = std::chrono::high_resolution_clock::now();
+        auto idle_start = wait_start;
+        bool device_busy = events_pending(overlap_events);
+        std::vector<int> completed_indices(requests.size());
+        int remaining_requests = requests.size();
+        while (remaining_requests > 0) {
+            int completed_count;
+            MPI_Testsome(requests.size(), requests.data(), &completed_count, completed_indices.data(), MPI_STATUSES_IGNORE);
+            for (int c = 0; c < completed_count; c++) {
+                on_completion(completed_indices[c]);
+            }
+            remaining_requests -= completed_count;
+            if (device_busy && !events_pending(overlap_events)) {
+                device_busy = false;
+                idle_start = std::chrono::high_resolution_clock::now();
+            }
+        }
+        auto wait_end = std::chrono::high_resolution_clock::now();
+        communication_time += wait_end - wait_start;
+        if (!device_busy) {
+            exposed_communication_time += wait_end - idle_start;
+        }
+    };
+
     /* --- Execute actual benchmark kernels --- */
 
     double t;
     std::vector<double> gefaExecutionTimes;
     std::vector<double> geslExecutionTimes;
     std::vector<double> gefaWaitTimes;
-    for (int i = 0; i < config.programSettings->numRepetitions; i++) {
+    std::vector<double> communicationTimes;
+    std::vector<double> exposedCommunicationTimes;
+    config.repetitions->start(*config.programSettings);
+    for (int i = 0; config.repetitions->next(gefaExecutionTimes); i++) {
 
-        err = buffer_queue.enqueueWriteBuffer(Buffer_a, CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*data.matrix_height*data.matrix_width, data.A);
-        ASSERT_CL(err)
-        err = buffer_queue.enqueueWriteBuffer(Buffer_b, CL_FALSE, 0, sizeof(HOST_DATA_TYPE)* data.matrix_width, data.b);
-        ASSERT_CL(err)
-        buffer_queue.finish();
+        {
+            HPCC_TRACE_REGION("write to device");
+            err = buffer_queue.enqueueWriteBuffer(Buffer_a, CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*data.matrix_height*data.matrix_width, data.A);
+            ASSERT_CL(err)
+            err = buffer_queue.enqueueWriteBuffer(Buffer_b, CL_FALSE, 0, sizeof(HOST_DATA_TYPE)* data.matrix_width, data.b);
+            ASSERT_CL(err)
+            buffer_queue.finish();
+        }
 
         // Command queues 
         // A new command queue is created for every iteration of the algorithm to reduce the overhead
@@ -135,28 +227,27 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
         std::deque<std::vector<cl::Buffer>> left_buffers;
         std::deque<std::vector<cl::Buffer>> top_buffers;
         std::deque<std::vector<cl::CommandQueue>> inner_queues;
-        std::deque<std::vector<cl::Kernel>> kernels;
-        std::thread flush_thread;
+        hpcc_base::CommunicationProgress progress;
 
         // User event that is used to start actual execution of benchmark kernels
         cl::UserEvent start_event(*config.context, &err);
         ASSERT_CL(err);
-        std::deque<std::vector<cl::Event>> all_events;
-        all_events.emplace_back();
-        all_events.back().emplace_back(start_event);
-        all_events.emplace_back();
+        event_list_count = 0;
+        current_events().assign(1, start_event);
+        next_events();
 
         left_buffers.emplace_back();
         top_buffers.emplace_back();
-        kernels.emplace_back();
         inner_queues.emplace_back();
         for (uint rep = 0; rep < config.programSettings->kernelReplications; rep++) {
-            inner_queues.back().emplace_back(*config.context, *config.device, 0, &err);
+            inner_queues.back().emplace_back(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
             ASSERT_CL(err)
         }
 
         std::chrono::time_point<std::chrono::high_resolution_clock> t1, t2, twait1, twait2;
         std::chrono::duration<double> currentwaittime = std::chrono::duration<double>::zero();
+        communication_time = std::chrono::duration<double>::zero();
+        exposed_communication_time = std::chrono::duration<double>::zero();
 
         std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col <<  "Start! " << std::endl;
         MPI_Barrier(MPI_COMM_WORLD);
@@ -165,12 +256,17 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
         start_event.setStatus(CL_COMPLETE);
 
 
-        int kernel_offset = 0;
         #pragma omp parallel
         {
 
+        int thread_id = 0;
+#ifdef _OPENMP
+        thread_id = omp_get_thread_num();
+#endif
+        std::map<std::string, cl::Kernel>& kernel_pool = kernel_pools[thread_id];
+
         #pragma omp single
-        all_events.back().reserve(num_omp_threads*config.programSettings->kernelReplications*3);
+        current_events().reserve(num_omp_threads*config.programSettings->kernelReplications*3);
         uint current_replication = 0;
 
         // For every row of blocks create kernels and enqueue them
@@ -201,60 +297,107 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
             uint total_updates_per_replication = total_inner_updates/ config.programSettings->kernelReplications;
             uint current_update = 0;
 
-            std::vector<cl::Kernel> private_kernels;
-
 
             #pragma omp single
             {
 
             // Create Command queues
-            lu_queues.emplace_back(*config.context, *config.device, 0, &err);
+            lu_queues.emplace_back(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
             ASSERT_CL(err)
-            top_queues.emplace_back(*config.context, *config.device, 0, &err);
+            top_queues.emplace_back(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
             ASSERT_CL(err)
-            left_queues.emplace_back(*config.context, *config.device, 0, &err);
+            left_queues.emplace_back(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
             ASSERT_CL(err)
 
-            if (is_calulating_lu_block) {
-                // create the LU kernel
-                private_kernels.emplace_back(*config.program, "lu",
-                                            &err);
-                ASSERT_CL(err);
+            // The current list contains the remaining inner updates of the previous block row.
+            // Without lookahead, the next LU, top and left blocks are calculated after all of them are done.
+            // The pivot search needs the whole updated panel, so there is no lookahead with pivoting.
+            if (config.programSettings->lookahead == 0 || use_pivoting) {
+                previous_events().insert(previous_events().end(), current_events().begin(), current_events().end());
+            }
+
+            if (use_pivoting) {
+                HPCC_TRACE_REGION("factorize panel");
+                size_t panel_offset = sizeof(HOST_DATA_TYPE) * local_block_row * config.programSettings->blockSize * data.matrix_width;
+                size_t panel_size = sizeof(HOST_DATA_TYPE) * panel.size();
+                if (in_same_row_as_lu) {
+                    // The panel contains the LU block and all top blocks, which are calculated on the host instead of the lu and top_update kernels
+                    err = lu_queues.back().enqueueReadBuffer(Buffer_a, CL_TRUE, panel_offset, panel_size, panel.data(), &previous_events(), config.profiler->event("read_panel"));
+                    ASSERT_CL(err)
+                    linpack::distributed_gefa_panel(panel.data(), data.matrix_width, config.programSettings->blockSize, block_row,
+                                                    config.programSettings->torus_width, config.programSettings->torus_col, row_communicator, panel_pivots.data());
+                    std::copy(panel_pivots.begin(), panel_pivots.end(), data.ipvt + local_block_row * config.programSettings->blockSize);
+                    err = lu_queues.back().enqueueWriteBuffer(Buffer_a, CL_FALSE, panel_offset, panel_size, panel.data(), nullptr, config.profiler->event("write_panel"));
+                    ASSERT_CL(err)
+                    for (uint r = 0; r < config.programSettings->blockSize; r++) {
+                        for (uint c = 0; c < config.programSettings->blockSize; c++) {
+                            if (is_calulating_lu_block) {
+                                lu_block[r * config.programSettings->blockSize + c] = panel[r * data.matrix_width + local_block_col * config.programSettings->blockSize + c];
+                            }
+                            for (int tbi = 0; tbi < num_top_blocks; tbi++) {
+                                top_blocks[tbi][r * config.programSettings->blockSize + c] = panel[r * data.matrix_width + (start_col_index + tbi) * config.programSettings->blockSize + c];
+                            }
+                        }
+                    }
+                    lu_queues.back().finish();
+                }
+                else {
+                    // Wait for the remaining inner updates before the rows are exchanged
+                    if (!previous_events().empty()) {
+                        err = cl::WaitForEvents(previous_events());
+                        ASSERT_CL(err)
+                    }
+                }
+                // Every rank needs the pivots to exchange the rows of its trailing matrix
+                MPI_Bcast(panel_pivots.data(), config.programSettings->blockSize, MPI_INT, local_block_row_remainder, col_communicator);
+                linpack::distributed_exchange_pivot_rows(lu_queues.back(), Buffer_a, data.matrix_width, start_row_index * config.programSettings->blockSize,
+                                                        data.matrix_height - start_row_index * config.programSettings->blockSize, panel_pivots.data(),
+                                                        config.programSettings->blockSize, block_row, config.programSettings->torus_width,
+                                                        config.programSettings->torus_col, row_communicator);
+            }
+            else if (is_calulating_lu_block) {
+                cl::Kernel& k = kernel_pool.at("lu");
 #ifndef NDEBUG
                 std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col << " LU     " << local_block_row << "," << local_block_col <<  std::endl;
 #endif
-                err = private_kernels.back().setArg(0, Buffer_a);
+                err = k.setArg(0, Buffer_a);
                 ASSERT_CL(err);
-                err = private_kernels.back().setArg(1, Buffer_lu1);
+                err = k.setArg(1, Buffer_lu1);
                 ASSERT_CL(err);
-                err = private_kernels.back().setArg(2, Buffer_lu2);
+                err = k.setArg(2, Buffer_lu2);
                 ASSERT_CL(err);
-                err = private_kernels.back().setArg(3, local_block_col);
+                err = k.setArg(3, local_block_col);
                 ASSERT_CL(err)
-                err = private_kernels.back().setArg(4, local_block_row);
+                err = k.setArg(4, local_block_row);
                 ASSERT_CL(err)
-                err =private_kernels.back().setArg(5, blocks_per_row);
+                err = k.setArg(5, blocks_per_row);
                 ASSERT_CL(err)
-                err = lu_queues.back().enqueueNDRangeKernel(private_kernels.back(), cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &(*std::prev(std::prev(all_events.end()))));
+                err = lu_queues.back().enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &previous_events(), config.profiler->event("lu"));
                 ASSERT_CL(err)
                 // read back result of LU calculation so it can be distributed 
-                err = lu_queues.back().enqueueReadBuffer(Buffer_lu2, CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), lu_block);
+                err = lu_queues.back().enqueueReadBuffer(Buffer_lu2, CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), lu_block, nullptr, config.profiler->event("read_lu"));
                 ASSERT_CL(err)
-                err = lu_queues.back().enqueueReadBuffer(Buffer_lu1, CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), lu_trans_block);
+                err = lu_queues.back().enqueueReadBuffer(Buffer_lu1, CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), lu_trans_block, nullptr, config.profiler->event("read_lu_trans"));
                 ASSERT_CL(err)
             }
 
             // Exchange LU blocks on all ranks to prevent stalls in MPI broadcast
             // All tasks until now need to be executed so we can use the result of the LU factorization and communicate it via MPI with the other FPGAs
+            HPCC_TRACE_REGION("broadcast LU block");
             lu_queues.back().finish();
 
-            // Broadcast LU block in column to update all left blocks
-            MPI_Bcast(lu_block, config.programSettings->blockSize*config.programSettings->blockSize, MPI_DATA_TYPE, local_block_row_remainder, col_communicator);
-            // Broadcast LU block in row to update all top blocks
-            MPI_Bcast(lu_trans_block, config.programSettings->blockSize*config.programSettings->blockSize, MPI_DATA_TYPE, local_block_col_remainder, row_communicator);
+            // Broadcast LU block in column to update all left blocks and in row to update all top blocks.
+            // Both broadcasts are done concurrently while the device may still update the inner blocks of the previous block row
+            // The top blocks are already calculated by the host with pivoting, so the transposed LU block is not needed
+            std::vector<MPI_Request> lu_requests(use_pivoting ? 1 : 2);
+            MPI_Ibcast(lu_block, config.programSettings->blockSize*config.programSettings->blockSize, MPI_DATA_TYPE, local_block_row_remainder, col_communicator, &lu_requests[0]);
+            if (!use_pivoting) {
+                MPI_Ibcast(lu_trans_block, config.programSettings->blockSize*config.programSettings->blockSize, MPI_DATA_TYPE, local_block_col_remainder, row_communicator, &lu_requests[1]);
+            }
+            wait_for_requests(lu_requests, current_events(), [](int) {});
            }
 
-            if (num_top_blocks > 0) {
+            if (num_top_blocks > 0 && !use_pivoting) {
 
                 #pragma omp single
                 {
@@ -262,14 +405,14 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                 // Copy LU block to FPGA for calulation of top blocks only if required
                 err = top_queues.back().enqueueWriteBuffer(Buffer_lu1, CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), lu_trans_block, NULL, &write_lu_trans_done);
                 ASSERT_CL(err)
-                (*std::prev(std::prev(all_events.end()))).push_back(write_lu_trans_done);
+                config.profiler->addEvent("write_lu_trans", write_lu_trans_done);
+                previous_events().push_back(write_lu_trans_done);
                 }
 
                 // Create top kernels
                 #pragma omp for
                 for (int tops=start_col_index; tops < blocks_per_row; tops++) {
-                    cl::Kernel k(*config.program, "top_update",
-                                                    &err);
+                    cl::Kernel& k = kernel_pool.at("top_update");
 #ifndef NDEBUG
                     std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col << " Top    " << local_block_row << "," << tops <<  std::endl;
 #endif
@@ -289,14 +432,12 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                     err = k.setArg(6, blocks_per_row);
                     ASSERT_CL(err)
 
-                    err = top_queues.back().enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &(*std::prev(std::prev(all_events.end()))));
+                    err = top_queues.back().enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &previous_events(), config.profiler->event("top_update"));
                     ASSERT_CL(err) 
 
-                    err = top_queues.back().enqueueReadBuffer(Buffer_top_list[tops - start_col_index], CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), top_blocks[tops - start_col_index]);
+                    err = top_queues.back().enqueueReadBuffer(Buffer_top_list[tops - start_col_index], CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), top_blocks[tops - start_col_index], nullptr, config.profiler->event("read_top"));
                     ASSERT_CL(err)
 
-                    private_kernels.push_back(k);
-
                 }
             }
             if (num_left_blocks > 0) {
@@ -307,14 +448,14 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                 // Copy LU block to FPGA for calulation of left blocks only if required
                 err = left_queues.back().enqueueWriteBuffer(Buffer_lu2, CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), lu_block, NULL, &write_lu_done);
                 ASSERT_CL(err)
-                (*std::prev(std::prev(all_events.end()))).push_back(write_lu_done);
+                config.profiler->addEvent("write_lu", write_lu_done);
+                previous_events().push_back(write_lu_done);
                 }
 
                 // Create left kernels
                 #pragma omp for
                 for (int tops=start_row_index; tops < blocks_per_col; tops++) {
-                    cl::Kernel k(*config.program, "left_update",
-                                                    &err);
+                    cl::Kernel& k = kernel_pool.at("left_update");
 #ifndef NDEBUG
                     std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col <<  " Left   " <<tops  << "," << local_block_col <<  std::endl;
 #endif
@@ -334,57 +475,69 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                     err = k.setArg(6, blocks_per_row);
                     ASSERT_CL(err)
 
-                    err = left_queues.back().enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &(*std::prev(std::prev(all_events.end()))));
+                    err = left_queues.back().enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &previous_events(), config.profiler->event("left_update"));
                     ASSERT_CL(err) 
 
-                    err = left_queues.back().enqueueReadBuffer(Buffer_left_list[tops - start_row_index], CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), left_blocks[tops - start_row_index]);
+                    err = left_queues.back().enqueueReadBuffer(Buffer_left_list[tops - start_row_index], CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), left_blocks[tops - start_row_index], nullptr, config.profiler->event("read_left"));
 
                     ASSERT_CL(err) 
-
-                    private_kernels.push_back(k);
                 }
             }
 
             #pragma omp single
             {
-            // Wait until all top and left blocks are calculated
+            HPCC_TRACE_REGION("broadcast left and top blocks");
+            // Send the left and top blocks to all other ranks so they can be used to update all inner blocks.
+            // The top blocks are already sent while the left blocks are still calculated
+            std::vector<MPI_Request> block_requests;
             top_queues.back().finish();
-            left_queues.back().finish();
-
-            // Send the left and top blocks to all other ranks so they can be used to update all inner blocks
-            for (int lbi=0; lbi < std::max(static_cast<int>(blocks_per_col - local_block_col), 0); lbi++) {
-                MPI_Bcast(left_blocks[lbi], config.programSettings->blockSize*config.programSettings->blockSize, MPI_DATA_TYPE, local_block_col_remainder, row_communicator);
+            // All ranks in a torus column have the same start column and all ranks in a torus row the same start row
+            int num_top_requests = std::max(static_cast<int>(blocks_per_row) - start_col_index, 0);
+            for (int tbi=0; tbi < num_top_requests; tbi++) {
+                block_requests.emplace_back();
+                MPI_Ibcast(top_blocks[tbi], config.programSettings->blockSize*config.programSettings->blockSize, MPI_DATA_TYPE, local_block_row_remainder, col_communicator, &block_requests.back());
             }
-            for (int tbi=0; tbi < std::max(static_cast<int>(blocks_per_row  - local_block_row), 0); tbi++) {
-                MPI_Bcast(top_blocks[tbi], config.programSettings->blockSize*config.programSettings->blockSize, MPI_DATA_TYPE, local_block_row_remainder, col_communicator);
+            left_queues.back().finish();
+            for (int lbi=0; lbi < std::max(static_cast<int>(blocks_per_col) - start_row_index, 0); lbi++) {
+                block_requests.emplace_back();
+                MPI_Ibcast(left_blocks[lbi], config.programSettings->blockSize*config.programSettings->blockSize, MPI_DATA_TYPE, local_block_col_remainder, row_communicator, &block_requests.back());
             }
 
             // update all remaining inner blocks using only global memory
 
             // all_events.emplace_back();
-            //auto communication_events = all_events.back();
+            //auto communication_events = current_events();
             left_buffers.emplace_back();
             top_buffers.emplace_back();
             
-            cl::CommandQueue buffer_transfer_queue(*config.context, *config.device, 0, &err);
+            cl::CommandQueue buffer_transfer_queue(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
 
-            // Write all left and top blocks to FPGA memory
             for (int lbi=0; lbi < num_inner_block_rows; lbi++) {
                 left_buffers.back().emplace_back(*config.context, CL_MEM_READ_ONLY,
                                         sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize));
-                err = buffer_transfer_queue.enqueueWriteBuffer(left_buffers.back().back(), CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), left_blocks[lbi]);
             }
             for (int tbi=0; tbi < num_inner_block_cols; tbi++) {
                 top_buffers.back().emplace_back(*config.context, CL_MEM_READ_ONLY,
                         sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * config.programSettings->blockSize);
-                err = buffer_transfer_queue.enqueueWriteBuffer(top_buffers.back().back(), CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), top_blocks[tbi]);
             }
 
-            kernel_offset = kernels.back().size();
-            kernels.back().resize(std::max(kernel_offset + num_inner_block_rows - 1 + num_inner_block_cols,0));
+            // Write every left and top block to FPGA memory as soon as it is received
+            wait_for_requests(block_requests, current_events(), [&](int request) {
+                if (request < num_top_requests) {
+                    if (request < num_inner_block_cols) {
+                        err = buffer_transfer_queue.enqueueWriteBuffer(top_buffers.back()[request], CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), top_blocks[request], nullptr, config.profiler->event("write_top"));
+                        ASSERT_CL(err)
+                    }
+                }
+                else if (request - num_top_requests < num_inner_block_rows) {
+                    err = buffer_transfer_queue.enqueueWriteBuffer(left_buffers.back()[request - num_top_requests], CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), left_blocks[request - num_top_requests], nullptr, config.profiler->event("write_left"));
+                    ASSERT_CL(err)
+                }
+                buffer_transfer_queue.flush();
+            });
 
-            all_events.emplace_back();
-            all_events.back().reserve(num_omp_threads*config.programSettings->kernelReplications*2);
+            next_events();
+            current_events().reserve(num_omp_threads*config.programSettings->kernelReplications*2);
 
             // Wait until data is copied to FPGA
             buffer_transfer_queue.finish();
@@ -397,14 +550,7 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                 current_replication = (lbi)  % config.programSettings->kernelReplications;
 
                 // select the matrix multiplication kernel that should be used for this block updated 
-#ifdef INTEL_FPGA
-                cl::Kernel k(*config.program, ("inner_update_mm" + std::to_string(current_replication)).c_str(),
-                                    &err);
-#endif
-#ifdef XILINX_FPGA
-                cl::Kernel k(*config.program, ("inner_update_mm0:{inner_update_mm0_" + std::to_string(current_replication + 1) + "}").c_str(),
-                                    &err);
-#endif
+                cl::Kernel& k = kernel_pool.at("inner_update_mm" + std::to_string(current_replication));
 
                 int block_col = static_cast<cl_uint>((data.matrix_width / config.programSettings->blockSize) - num_inner_block_cols);
                 int block_row = static_cast<cl_uint>((data.matrix_height / config.programSettings->blockSize) - num_inner_block_rows + lbi);  
@@ -430,21 +576,20 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                     // this is the last taks that will be enqueued in this queue, so create an event
                     cl::Event ev;
                     // Distribute the workload over all available matrix multiplication kernels
-                    err = inner_queues.back()[current_replication].enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &(*std::prev(std::prev(all_events.end()))), &ev);  
+                    err = inner_queues.back()[current_replication].enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &previous_events(), &ev);
+                    config.profiler->addEvent("inner_update_mm", ev);
 
                     #pragma omp critical
-                    all_events.back().push_back(ev);           
+                    current_events().push_back(ev);           
                 }
                 else {
 #ifndef NDEBUG
                 std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col << " Inner L " << block_row << "," << block_col <<  std::endl;
 #endif 
                     // Distribute the workload over all available matrix multiplication kernels
-                    err = inner_queues.back()[current_replication].enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &(*std::prev(std::prev(all_events.end()))));         
+                    err = inner_queues.back()[current_replication].enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &previous_events(), config.profiler->event("inner_update_mm"));
                 }
 
-                kernels.back()[kernel_offset + lbi - 1] = k;
-
                 current_update++;
             }
 
@@ -455,14 +600,7 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                 current_replication = (tbi)  % config.programSettings->kernelReplications;
 
                 // select the matrix multiplication kernel that should be used for this block updated 
-#ifdef INTEL_FPGA
-                cl::Kernel k(*config.program, ("inner_update_mm" + std::to_string(current_replication)).c_str(),
-                                    &err);
-#endif
-#ifdef XILINX_FPGA
-                cl::Kernel k(*config.program, ("inner_update_mm0:{inner_update_mm0_" + std::to_string(current_replication + 1) + "}").c_str(),
-                                    &err);
-#endif
+                cl::Kernel& k = kernel_pool.at("inner_update_mm" + std::to_string(current_replication));
                 int block_col = static_cast<cl_uint>((data.matrix_width / config.programSettings->blockSize) - num_inner_block_cols + tbi);
                 int block_row = static_cast<cl_uint>((data.matrix_height / config.programSettings->blockSize) - num_inner_block_rows);
 
@@ -487,20 +625,20 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                     // this is the last taks that will be enqueued in this queue, so create an event
                     cl::Event ev;
                     // Distribute the workload over all available matrix multiplication kernels
-                    err = inner_queues.back()[current_replication].enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &(*std::prev(std::prev(all_events.end()))), &ev);  
+                    err = inner_queues.back()[current_replication].enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &previous_events(), &ev);
+                    config.profiler->addEvent("inner_update_mm", ev);
 
                     #pragma omp critical
-                    all_events.back().push_back(ev);           
+                    current_events().push_back(ev);           
                 }
                 else {
 #ifndef NDEBUG
                 std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col << " Inner " << block_row << "," << block_col <<  std::endl;
 #endif 
                     // Distribute the workload over all available matrix multiplication kernels
-                    err = inner_queues.back()[current_replication].enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &(*std::prev(std::prev(all_events.end()))));         
+                    err = inner_queues.back()[current_replication].enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &previous_events(), config.profiler->event("inner_update_mm"));
                 }
                 ASSERT_CL(err) 
-                kernels.back()[kernel_offset + tbi + num_inner_block_rows - 1] = k;
 
                 current_update++;
             }
@@ -508,13 +646,12 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
             #pragma omp single
             {
             // count the inner MM already to next iteration by creating new buffers in the queue
-            all_events.emplace_back();
-            all_events.back().reserve(num_omp_threads*config.programSettings->kernelReplications);
-            kernels.emplace_back(total_inner_updates);
+            next_events();
+            current_events().reserve(num_omp_threads*config.programSettings->kernelReplications);
             inner_queues.emplace_back();
             current_update = 0;
             for (uint rep = 0; rep < config.programSettings->kernelReplications; rep++) {
-                inner_queues.back().emplace_back(*config.context, *config.device, 0, &err);
+                inner_queues.back().emplace_back(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
                 ASSERT_CL(err)
             }
 
@@ -527,14 +664,7 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
 
                     current_replication = (lbi * num_inner_block_cols + tbi)  % config.programSettings->kernelReplications;
 
-#ifdef INTEL_FPGA
-                    cl::Kernel k(*config.program, ("inner_update_mm" + std::to_string(current_replication)).c_str(),
-                                        &err);
-#endif
-#ifdef XILINX_FPGA
-                    cl::Kernel k(*config.program, ("inner_update_mm0:{inner_update_mm0_" + std::to_string(current_replication + 1) + "}").c_str(),
-                                        &err);
-#endif
+                    cl::Kernel& k = kernel_pool.at("inner_update_mm" + std::to_string(current_replication));
 
                     int block_col = static_cast<cl_uint>((data.matrix_width / config.programSettings->blockSize) - num_inner_block_cols + tbi);
                     int block_row = static_cast<cl_uint>((data.matrix_height / config.programSettings->blockSize) - num_inner_block_rows + lbi);
@@ -561,23 +691,22 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                         // this is the last taks that will be enqueued in this queue, so create an event
                         cl::Event ev;
                         // Distribute the workload over all available matrix multiplication kernels
-                        err = inner_queues.back()[current_replication].enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &(*std::prev(std::prev(all_events.end()))), &(ev));
+                        err = inner_queues.back()[current_replication].enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &previous_events(), &(ev));
+                        config.profiler->addEvent("inner_update_mm", ev);
 
                         #pragma omp critical
-                        all_events.back().push_back(ev);      
+                        current_events().push_back(ev);      
                     }
                     else {
 #ifndef NDEBUG
                     std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col << " Inner " << block_row << "," << block_col <<  std::endl;
 #endif 
                         // Distribute the workload over all available matrix multiplication kernels
-                        err = inner_queues.back()[current_replication].enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &(*std::prev(std::prev(all_events.end()))));
+                        err = inner_queues.back()[current_replication].enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(1), cl::NDRange(1),  &previous_events(), config.profiler->event("inner_update_mm"));
                     }
 
                     ASSERT_CL(err)
 
-                    kernels.back()[(lbi-1)*(num_inner_block_cols - 1)+(tbi-1)] = k;
-
                     current_update++;
                 }
             }
@@ -585,13 +714,9 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
 #ifdef NDEBUG
             #pragma omp single
             {
-                if (flush_thread.joinable()) {
-                    flush_thread.join();
-                }
-                // Start new thread that cuntinuously puts new tasks on the FPGA while the main thread
+                // The progress thread continuously puts new tasks on the FPGA while the main thread
                 // may be blocked by MPI calls
-                std::thread new_thread([all_events](){ cl::Event::waitForEvents(all_events.back());});
-                flush_thread.swap(new_thread);
+                progress.addEvents(current_events());
             }
 #endif
 
@@ -609,13 +734,13 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
 #endif
 
 #ifndef NDEBUG
-            cl::Event::waitForEvents(all_events.back());
+            cl::Event::waitForEvents(current_events());
             std::cout << "Torus " << config.programSettings->torus_row << "," << config.programSettings->torus_col << " Done    " << block_row <<  std::endl;
 
-            if (block_row == blocks_per_row * config.programSettings->torus_width - 1) {
+            if (block_row == config.programSettings->matrixSize / config.programSettings->blockSize - 1) {
                 // wait until the last LU queue is done since it will be the last required operation
                 t2 = std::chrono::high_resolution_clock::now();
-                cl::Event::waitForEvents(all_events.back());
+                cl::Event::waitForEvents(current_events());
 
             }
 #endif
@@ -624,16 +749,13 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
             #pragma omp single nowait
             {
             if (block_row > 2) {
-                // clean up old queues and kernels
+                // clean up old queues and buffers
                 lu_queues.pop_front();
                 left_queues.pop_front();
                 top_queues.pop_front();
                 inner_queues.pop_front();
                 left_buffers.pop_front();
                 top_buffers.pop_front();
-                kernels.pop_front();
-                all_events.pop_front();
-                all_events.pop_front();
             }
             }
 #endif
@@ -641,9 +763,7 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
         }
     }
 
-    if (flush_thread.joinable()) {
-        flush_thread.join();
-    }
+    progress.waitAll();
 
 #ifdef NDEBUG
         t2 = std::chrono::high_resolution_clock::now();
@@ -659,6 +779,8 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
                 std::chrono::duration_cast<std::chrono::duration<double>>
                                                                     (t2 - t1);
         gefaExecutionTimes.push_back(timespan.count());
+        communicationTimes.push_back(communication_time.count());
+        exposedCommunicationTimes.push_back(exposed_communication_time.count());
 
         // Execute GESL
         t1 = std::chrono::high_resolution_clock::now();
@@ -668,6 +790,10 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
         timespan = std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1);
         geslExecutionTimes.push_back(timespan.count());
     }
+    config.repetitions->discardWarmup(gefaExecutionTimes);
+    config.repetitions->discardWarmup(geslExecutionTimes);
+    config.repetitions->discardWarmup(communicationTimes);
+    config.repetitions->discardWarmup(exposedCommunicationTimes);
 
     /* --- Read back results from Device --- */
 
@@ -692,33 +818,30 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings>&co
     clSVMFree((*config.context)(), reinterpret_cast<void*>(A_tmp));
 
 #else
+    HPCC_TRACE_REGION("read from device");
     buffer_queue.enqueueReadBuffer(Buffer_a, CL_TRUE, 0,
                                      sizeof(HOST_DATA_TYPE)*data.matrix_height*data.matrix_width, data.A);
     // buffer_queue.enqueueReadBuffer(Buffer_b, CL_TRUE, 0,
     //                                  sizeof(HOST_DATA_TYPE)*config.programSettings->matrixSize, b);
-    if (!config.programSettings->isDiagonallyDominant) {
-        buffer_queue.enqueueReadBuffer(Buffer_pivot, CL_TRUE, 0,
-                                        sizeof(cl_int)*data.matrix_height, data.ipvt);
-    }
     buffer_queue.finish();
 #endif
 
     /* --- Clean up MPI communication buffers --- */
-    free(lu_block);
-    free(lu_trans_block);
+    hpcc_base::host_memory::release(lu_block);
+    hpcc_base::host_memory::release(lu_trans_block);
 
     for (int i =0; i < left_blocks.size(); i++) {
-        free(left_blocks[i]);
+        hpcc_base::host_memory::release(left_blocks[i]);
     }
     for (int i =0; i < top_blocks.size(); i++) {
-        free(top_blocks[i]);
+        hpcc_base::host_memory::release(top_blocks[i]);
     }
 
     MPI_Comm_free(&row_communicator);
     MPI_Comm_free(&col_communicator);
 
     std::unique_ptr<linpack::LinpackExecutionTimings> results(
-                    new linpack::LinpackExecutionTimings{gefaExecutionTimes, geslExecutionTimes});
+                    new linpack::LinpackExecutionTimings{gefaExecutionTimes, geslExecutionTimes, communicationTimes, exposedCommunicationTimes});
     
     MPI_Barrier(MPI_COMM_WORLD);
 
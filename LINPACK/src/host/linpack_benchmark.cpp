@@ -27,22 +27,40 @@ SOFTWARE.
 #include "linpack_benchmark.hpp"
 
 /* C++ standard library headers */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
 #include <memory>
-#include <random>
+#include <vector>
 
 /* Project's headers */
 #include "communication_types.hpp"
 #include "execution_types/execution_types.hpp"
+#include "hpcc_suite.hpp"
 #include "parameters.h"
 
+namespace {
+
+/**
+ * @brief Seed of the counter-based generator used for the input matrix
+ */
+const uint64_t input_seed = 0;
+
+}
+
 linpack::LinpackProgramSettings::LinpackProgramSettings(cxxopts::ParseResult &results) : hpcc_base::BaseSettings(results),
     matrixSize(results["m"].as<uint>() * (1 << (results["b"].as<uint>()))), blockSize(1 << (results["b"].as<uint>())), 
     isEmulationKernel(results.count("emulation") > 0), isDiagonallyDominant(results.count("uniform") == 0),
-    torus_width(results["p"].as<uint>()) {
+    isMixedPrecision(results.count("mixed-precision") > 0),
+    lookahead(results["lookahead"].as<uint>()), torus_width(results["p"].as<uint>()) {
     int mpi_comm_rank;
     int mpi_comm_size;
     MPI_Comm_rank(MPI_COMM_WORLD, &mpi_comm_rank);
     MPI_Comm_size(MPI_COMM_WORLD, &mpi_comm_size);
+    if (torus_width == 0) {
+        torus_width = linpack::best_torus_width(mpi_comm_size, matrixSize / blockSize);
+    }
     // calculate the row and column of the MPI rank in the torus 
     if (mpi_comm_size % torus_width != 0) {
         throw std::runtime_error("MPI size not dividable by P=" + std::to_string(torus_width) + "!");
@@ -50,6 +68,20 @@ linpack::LinpackProgramSettings::LinpackProgramSettings(cxxopts::ParseResult &re
     torus_height = mpi_comm_size / torus_width;
     torus_row = (mpi_comm_rank / torus_width);
     torus_col = (mpi_comm_rank % torus_width);
+    if (matrixSize / blockSize < std::max(torus_width, torus_height)) {
+        throw std::runtime_error("Matrix needs at least one block for every row and column of the PQ grid!");
+    }
+    if (lookahead > 1) {
+        throw std::runtime_error("Lookahead depth " + std::to_string(lookahead) + " not supported! Use 0 or 1.");
+    }
+    if (isMixedPrecision) {
+#ifdef _DP
+        throw std::runtime_error("Mixed precision mode requires a kernel with a lower precision than double!");
+#endif
+        if (!isDiagonallyDominant) {
+            throw std::runtime_error("Mixed precision mode can not be combined with --uniform, because GMRES is preconditioned with a factorization without pivoting!");
+        }
+    }
 }
 
 std::map<std::string, std::string>
@@ -60,6 +92,9 @@ linpack::LinpackProgramSettings::getSettingsMap() {
         map["Emulate"] = (isEmulationKernel) ? "Yes" : "No";
         map["Data Type"] = STR(HOST_DATA_TYPE);
         map["FPGA Torus"] = "P=" + std::to_string(torus_width) + ", Q=" + std::to_string(torus_height);
+        map["Lookahead"] = std::to_string(lookahead);
+        map["Mixed Precision"] = (isMixedPrecision) ? "Yes" : "No";
+        map["Pivoting"] = (isDiagonallyDominant) ? "No" : "Partial";
         return map;
 }
 
@@ -76,9 +111,9 @@ linpack::LinpackData::LinpackData(cl::Context context, size_t width, size_t heig
                         clSVMAlloc(context(), 0 ,
                         size * sizeof(cl_int), 1024));
 #else
-    posix_memalign(reinterpret_cast<void**>(&A), 4096, width * height * sizeof(HOST_DATA_TYPE));
-    posix_memalign(reinterpret_cast<void**>(&b), 4096, width * sizeof(HOST_DATA_TYPE));
-    posix_memalign(reinterpret_cast<void**>(&ipvt), 4096, height * sizeof(cl_int));
+    A = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(width * height);
+    b = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(width);
+    ipvt = hpcc_base::host_memory::allocate<cl_int>(height);
 #endif
     }
 
@@ -88,9 +123,9 @@ linpack::LinpackData::~LinpackData() {
     clSVMFree(context(), reinterpret_cast<void*>(b));
     clSVMFree(context(), reinterpret_cast<void*>(ipvt));
 #else
-    free(A);
-    free(b);
-    free(ipvt);
+    hpcc_base::host_memory::release(A);
+    hpcc_base::host_memory::release(b);
+    hpcc_base::host_memory::release(ipvt);
 #endif
 }
 
@@ -98,6 +133,18 @@ linpack::LinpackBenchmark::LinpackBenchmark(int argc, char* argv[]) : HpccFpgaBe
     setupBenchmark(argc, argv);
 }
 
+linpack::LinpackBenchmark::~LinpackBenchmark() {
+    if (row_communicator != MPI_COMM_NULL) {
+        MPI_Comm_free(&row_communicator);
+        MPI_Comm_free(&col_communicator);
+    }
+}
+
+hpcc_base::suite::BenchmarkResult
+linpack::runSuiteBenchmark(int argc, char* argv[]) {
+    return hpcc_base::suite::runBenchmark<linpack::LinpackBenchmark>(argc, argv);
+}
+
 void
 linpack::LinpackBenchmark::addAdditionalParseOptions(cxxopts::Options &options) {
     options.add_options()
@@ -105,9 +152,12 @@ linpack::LinpackBenchmark::addAdditionalParseOptions(cxxopts::Options &options)
             cxxopts::value<uint>()->default_value(std::to_string(DEFAULT_MATRIX_SIZE)))
         ("b", "Log2 of the block size in number of values in one dimension",
             cxxopts::value<uint>()->default_value(std::to_string(LOCAL_MEM_BLOCK_LOG)))
-        ("p", "Width of the FPGA grid. The heigth (Q) will be calculated from mpi_size / P.",
+        ("p", "Width of the FPGA grid. The heigth (Q) will be calculated from mpi_size / P. Use 0 to select the grid with the lowest predicted communication to computation ratio.",
             cxxopts::value<uint>()->default_value(std::to_string(DEFAULT_P_VALUE)))
-        ("uniform", "Generate a uniform matrix instead of a diagonally dominant. This has to be supported by the FPGA kernel!")
+        ("lookahead", "Number of block rows the MPI communication may overlap with the inner block updates of the previous block row. Supported are 0 and 1. Only used by the PCIe communication type",
+            cxxopts::value<uint>()->default_value("1"))
+        ("uniform", "Generate a uniform matrix instead of a diagonally dominant. The LU factorization will use partial pivoting over the whole column like HPL")
+        ("mixed-precision", "Refine the solution of the low precision factorization to double precision with GMRES on the host (HPL-MxP)")
         ("emulation", "Use kernel arguments for emulation. This may be necessary to simulate persistent local memory on the FPGA");
 }
 
@@ -116,11 +166,21 @@ linpack::LinpackBenchmark::executeKernel(LinpackData &data) {
     std::unique_ptr<linpack::LinpackExecutionTimings> timings;
     switch (executionSettings->programSettings->communicationType) {
         case hpcc_base::CommunicationType::pcie_mpi : timings = execution::pcie::calculate(*executionSettings, data); break;
-        case hpcc_base::CommunicationType::intel_external_channels: timings = execution::iec::calculate(*executionSettings, data); break;
+        case hpcc_base::CommunicationType::intel_external_channels: 
+                // The forwarding of the blocks over the external channels requires the same number of blocks on every FPGA
+                if ((executionSettings->programSettings->matrixSize / executionSettings->programSettings->blockSize) % executionSettings->programSettings->torus_width > 0 || 
+                    (executionSettings->programSettings->matrixSize / executionSettings->programSettings->blockSize) % executionSettings->programSettings->torus_height > 0) {
+                    throw std::runtime_error("Global matrix size must be multiple of LCM of PQ grid for communication type " + commToString(executionSettings->programSettings->communicationType) + "!");
+                }
+                timings = execution::iec::calculate(*executionSettings, data); break;
         default: throw std::runtime_error("No calculate method implemented for communication type " + commToString(executionSettings->programSettings->communicationType));
     }
+    if (executionSettings->programSettings->isMixedPrecision) {
+        timings->refinementTimings.push_back(mixed_precision_refinement(data));
+        return timings;
+    }
 #ifdef DISTRIBUTED_VALIDATION
-    distributed_gesl_nopvt_ref(data);
+    distributed_gesl_ref(data);
 #endif
     return timings;
 }
@@ -139,10 +199,26 @@ linpack::LinpackBenchmark::collectAndPrintResults(const linpack::LinpackExecutio
     std::cout << "Rank " << mpi_comm_rank << ": Result collection started" << std::endl;
 #endif
 
+    rawTimings["gefa"] = output.gefaTimings;
+    rawTimings["gesl"] = output.geslTimings;
+
     std::vector<double> global_lu_times(output.gefaTimings.size());
     MPI_Reduce(output.gefaTimings.data(), global_lu_times.data(), output.gefaTimings.size(), MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
     std::vector<double> global_sl_times(output.geslTimings.size());
     MPI_Reduce(output.geslTimings.data(), global_sl_times.data(), output.geslTimings.size(), MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    std::vector<double> global_comm_times(output.communicationTimings.size());
+    std::vector<double> global_exposed_comm_times(output.exposedCommunicationTimings.size());
+    if (!output.communicationTimings.empty()) {
+        rawTimings["communication"] = output.communicationTimings;
+        rawTimings["exposed communication"] = output.exposedCommunicationTimings;
+        MPI_Reduce(output.communicationTimings.data(), global_comm_times.data(), output.communicationTimings.size(), MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+        MPI_Reduce(output.exposedCommunicationTimings.data(), global_exposed_comm_times.data(), output.exposedCommunicationTimings.size(), MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    }
+    std::vector<double> global_refinement_times(output.refinementTimings.size());
+    if (!output.refinementTimings.empty()) {
+        rawTimings["gmres"] = output.refinementTimings;
+        MPI_Reduce(output.refinementTimings.data(), global_refinement_times.data(), output.refinementTimings.size(), MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    }
 #ifndef NDEBUG
     std::cout << "Rank " << mpi_comm_rank << ": Result collection done" << std::endl;
 #endif
@@ -175,6 +251,16 @@ linpack::LinpackBenchmark::collectAndPrintResults(const linpack::LinpackExecutio
     tlumean = tlumean / global_lu_times.size();
     tslmean = tslmean / global_sl_times.size();
 
+    derivedMetrics["total best [s]"] = tmin;
+    derivedMetrics["total mean [s]"] = tmean;
+    derivedMetrics["total GFLOPS"] = (gflops_lu + gflops_sl) / tmin;
+    derivedMetrics["GEFA best [s]"] = lu_min;
+    derivedMetrics["GEFA mean [s]"] = tlumean;
+    derivedMetrics["GEFA GFLOPS"] = gflops_lu / lu_min;
+    derivedMetrics["GESL best [s]"] = sl_min;
+    derivedMetrics["GESL mean [s]"] = tslmean;
+    derivedMetrics["GESL GFLOPS"] = gflops_sl / sl_min;
+
      std::cout << std::setw(ENTRY_SPACE)
               << "Method" << std::setw(ENTRY_SPACE)
               << "best" << std::setw(ENTRY_SPACE) << "mean"
@@ -194,91 +280,177 @@ linpack::LinpackBenchmark::collectAndPrintResults(const linpack::LinpackExecutio
               << sl_min << std::setw(ENTRY_SPACE) << tslmean
               << std::setw(ENTRY_SPACE) << (gflops_sl / sl_min)
               << std::endl;
+
+    if (!global_refinement_times.empty()) {
+        // The refinement is only done once for the factorization of the last repetition.
+        // The performance is calculated with the operation count of LU in double precision like in HPL-MxP
+        double t_refine = global_refinement_times[0];
+        double gflops_mxp = ((2.0e0*total_matrix_size * total_matrix_size * total_matrix_size)/ 3.0 + 
+                                (3.0 * total_matrix_size * total_matrix_size) / 2.0) / 1.0e9;
+        derivedMetrics["GMRES [s]"] = t_refine;
+        derivedMetrics["MxP best [s]"] = lu_min + t_refine;
+        derivedMetrics["MxP mean [s]"] = tlumean + t_refine;
+        derivedMetrics["MxP GFLOPS"] = gflops_mxp / (lu_min + t_refine);
+
+        std::cout << std::setw(ENTRY_SPACE) << "MxP" << std::setw(ENTRY_SPACE)
+                << (lu_min + t_refine) << std::setw(ENTRY_SPACE) << (tlumean + t_refine)
+                << std::setw(ENTRY_SPACE) << (gflops_mxp / (lu_min + t_refine))
+                << std::endl;
+    }
+
+    if (!global_comm_times.empty()) {
+        double comm_mean = 0;
+        double exposed_comm_mean = 0;
+        for (int i =0; i < global_comm_times.size(); i++) {
+            comm_mean += global_comm_times[i];
+            exposed_comm_mean += global_exposed_comm_times[i];
+        }
+        comm_mean = comm_mean / global_comm_times.size();
+        exposed_comm_mean = exposed_comm_mean / global_exposed_comm_times.size();
+        derivedMetrics["communication mean [s]"] = comm_mean;
+        derivedMetrics["exposed communication mean [s]"] = exposed_comm_mean;
+
+        std::cout << "Communication time with lookahead " << executionSettings->programSettings->lookahead
+                  << ": mean " << comm_mean << " s, exposed mean " << exposed_comm_mean << " s" << std::endl;
+    }
+
+    std::vector<double> global_total_times(global_lu_times.size());
+    for (int i =0; i < global_lu_times.size(); i++) {
+        global_total_times[i] = global_lu_times[i] + global_sl_times[i];
+    }
+    printTimingStatistics({{"total", global_total_times}, {"GEFA", global_lu_times}, {"GESL", global_sl_times}});
+
+    // The factorization is dominated by the updates of the inner blocks. Every replication of the inner update kernel
+    // calculates 2^(3*REGISTER_BLOCK_MM_LOG) multiply-add operations per cycle on blocks stored in local memory, so
+    // the global memory is not considered.
+    double gemm_block_mm = static_cast<double>(1 << REGISTER_BLOCK_MM_LOG);
+    hpcc_base::Roofline roofline{mpi_comm_size * executionSettings->programSettings->kernelReplications * 2.0 * gemm_block_mm * gemm_block_mm * gemm_block_mm * getKernelFrequency(),
+                                0.0, 0.0};
+    printEfficiency({{"GEFA", {gflops_lu / lu_min, roofline}}}, "GFLOPS", 1.0e-9);
+}
+
+bool
+linpack::LinpackBenchmark::setAutomaticSize(hpcc_base::MemoryLimits const& limits) {
+    auto& settings = *executionSettings->programSettings;
+    uint64_t width = settings.torus_width;
+    uint64_t height = settings.torus_height;
+    uint64_t unit = hpcc_base::leastCommonMultiple(width, height);
+    double block_bytes = static_cast<double>(settings.blockSize) * settings.blockSize * sizeof(HOST_DATA_TYPE);
+    double max_blocks = limits.totalMemory / block_bytes;
+    double max_buffer_blocks = limits.maxBufferSize / block_bytes;
+    // Start with the size where the local matrix alone fills the memory and reduce it until
+    // the local matrix, a block for every local row and column and the two LU blocks fit
+    double max_width = std::min(std::sqrt(std::min(max_blocks, max_buffer_blocks) * width * height),
+                                static_cast<double>(std::numeric_limits<uint>::max() / settings.blockSize));
+    uint64_t blocks = hpcc_base::largestMultiple(max_width, unit);
+    while (blocks > 0) {
+        double local_blocks = static_cast<double>(blocks / width) * (blocks / height);
+        if (local_blocks <= max_buffer_blocks && local_blocks + blocks / width + blocks / height + 2 <= max_blocks) {
+            break;
+        }
+        blocks -= unit;
+    }
+    if (blocks == 0) {
+        return false;
+    }
+    settings.matrixSize = static_cast<uint>(blocks * settings.blockSize);
+    return true;
 }
 
 std::unique_ptr<linpack::LinpackData>
 linpack::LinpackBenchmark::generateInputData() {
-    int local_matrix_width = executionSettings->programSettings->matrixSize / executionSettings->programSettings->torus_width;
-    int local_matrix_height = executionSettings->programSettings->matrixSize / executionSettings->programSettings->torus_height;
-
-    if ((executionSettings->programSettings->matrixSize / executionSettings->programSettings->blockSize) % executionSettings->programSettings->torus_width > 0 || 
-        (executionSettings->programSettings->matrixSize / executionSettings->programSettings->blockSize) % executionSettings->programSettings->torus_height > 0) {
-            throw std::runtime_error("Global matrix size must be multiple of LCM of PQ grid!");
-    }
+    // The blocks are distributed block-cyclic, so the first ranks of a torus row or column get one block more if the
+    // number of blocks is not a multiple of the grid size
+    int local_matrix_width = linpack::local_block_count(executionSettings->programSettings->matrixSize / executionSettings->programSettings->blockSize,
+                                executionSettings->programSettings->torus_width, executionSettings->programSettings->torus_col) * executionSettings->programSettings->blockSize;
+    int local_matrix_height = linpack::local_block_count(executionSettings->programSettings->matrixSize / executionSettings->programSettings->blockSize,
+                                executionSettings->programSettings->torus_height, executionSettings->programSettings->torus_row) * executionSettings->programSettings->blockSize;
 
     auto d = std::unique_ptr<linpack::LinpackData>(new linpack::LinpackData(*executionSettings->context ,local_matrix_width, local_matrix_height));
-    std::mt19937 gen(this->mpi_comm_rank);
-    std::uniform_real_distribution<> dis(0.0, 1.0);
-    d->norma = 0.0;
-    d->normb = 0.0;
 
+    // The communicators are created once and reused for every generation of the input data
+    if (row_communicator == MPI_COMM_NULL) {
+        MPI_Comm_split(MPI_COMM_WORLD, executionSettings->programSettings->torus_row, 0,&row_communicator);
+        MPI_Comm_split(MPI_COMM_WORLD, executionSettings->programSettings->torus_col, 0,&col_communicator);
+    }
+
+    int blockSize = executionSettings->programSettings->blockSize;
+    size_t n = executionSettings->programSettings->matrixSize;
+    HOST_DATA_TYPE norma = 0.0;
 
     /*
-    Generate a matrix by using pseudo random number in the range (0,1)
+    Generate a matrix by using pseudo random number in the range (0,1).
+    The numbers are calculated from the global position of the value, so every row can be generated in parallel and the matrix does not depend on the torus size
     */
+    #pragma omp parallel for reduction(max:norma)
     for (int j = 0; j < local_matrix_height; j++) {
+        size_t global_j = ((j / blockSize) * executionSettings->programSettings->torus_height + executionSettings->programSettings->torus_row) * blockSize + (j % blockSize);
         // fill a single column of the matrix
         for (int i = 0; i < local_matrix_width; i++) {
-                HOST_DATA_TYPE temp = dis(gen);
-                d->A[local_matrix_width*j+i] = temp;
-                d->norma = (temp > d->norma) ? temp : d->norma;
+            size_t global_i = ((i / blockSize) * executionSettings->programSettings->torus_width + executionSettings->programSettings->torus_col) * blockSize + (i % blockSize);
+            HOST_DATA_TYPE temp = hpcc_base::rng::toUniformUnsigned(hpcc_base::rng::randomBits(global_j * n + global_i, input_seed)[0]);
+            d->A[local_matrix_width*j+i] = temp;
+            norma = (temp > norma) ? temp : norma;
         }
     }
 
-
     // If the matrix should be diagonally dominant, we need to exchange the sum of the rows with
     // the ranks that share blocks in the same column
     if (executionSettings->programSettings->isDiagonallyDominant) {
-        // create a communicator to exchange the rows
-        MPI_Comm row_communicator;
-        MPI_Comm_split(MPI_COMM_WORLD, executionSettings->programSettings->torus_row, 0,&row_communicator);
+        std::vector<HOST_DATA_TYPE> row_sums(local_matrix_height);
+        std::vector<int> diagonal_cols(local_matrix_height, -1);
 
-        // Caclulate the sum for every row and insert in into the matrix
+        // Caclulate the local sum for every row with the diagonal elements set to 0
+        #pragma omp parallel for
         for (int local_matrix_row = 0; local_matrix_row < local_matrix_height; local_matrix_row++) {
-            int blockSize = executionSettings->programSettings->blockSize;
             int global_matrix_row = executionSettings->programSettings->torus_row * blockSize + (local_matrix_row / blockSize) * blockSize * executionSettings->programSettings->torus_height + (local_matrix_row % blockSize);
             int local_matrix_col = (global_matrix_row - executionSettings->programSettings->torus_col * blockSize) / (blockSize * executionSettings->programSettings->torus_width) * blockSize + (global_matrix_row % blockSize);
             int diagonal_rank = (global_matrix_row / blockSize) % executionSettings->programSettings->torus_width;
-            bool diagonal_on_this_rank = diagonal_rank == executionSettings->programSettings->torus_col;
-            // set the diagonal elements of the matrix to 0
-            if (diagonal_on_this_rank) {
+            if (diagonal_rank == executionSettings->programSettings->torus_col) {
+                diagonal_cols[local_matrix_row] = local_matrix_col;
                 d->A[local_matrix_width*local_matrix_row + local_matrix_col] = 0.0;
             }
             HOST_DATA_TYPE local_row_sum = 0.0;
             for (int i = 0; i < local_matrix_width; i++) {
                 local_row_sum += d->A[local_matrix_width*local_matrix_row + i];
             } 
-            HOST_DATA_TYPE row_sum = 0.0;
-            MPI_Reduce(&local_row_sum, &row_sum, 1, MPI_DATA_TYPE, MPI_SUM, diagonal_rank, row_communicator);
-            // insert row sum into matrix if it contains the diagonal block
-            if (diagonal_on_this_rank) {
+            row_sums[local_matrix_row] = local_row_sum;
+        }
+
+        // Sum up the rows of all ranks in the torus row at once
+        MPI_Allreduce(MPI_IN_PLACE, row_sums.data(), local_matrix_height, MPI_DATA_TYPE, MPI_SUM, row_communicator);
+
+        // insert row sum into matrix if it contains the diagonal block
+        for (int local_matrix_row = 0; local_matrix_row < local_matrix_height; local_matrix_row++) {
+            if (diagonal_cols[local_matrix_row] >= 0) {
                 // update norm of local matrix
-                d->norma = (row_sum > d->norma) ? row_sum : d->norma;
-                d->A[local_matrix_width*local_matrix_row + local_matrix_col] = row_sum;
+                norma = (row_sums[local_matrix_row] > norma) ? row_sums[local_matrix_row] : norma;
+                d->A[local_matrix_width*local_matrix_row + diagonal_cols[local_matrix_row]] = row_sums[local_matrix_row];
             }
         }
     }
+    d->norma = norma;
         
     // initialize other vectors
-    for (int i = 0; i < local_matrix_width; i++) {
-        d->b[i] = 0.0;
-    }
     for (int i = 0; i < local_matrix_height; i++) {
         d->ipvt[i] = i;
     }
 
-    MPI_Comm col_communicator;
-    MPI_Comm_split(MPI_COMM_WORLD, executionSettings->programSettings->torus_col, 0,&col_communicator);
-
     // Generate vector b by accumulating the columns of the matrix.
     // This will lead to a result vector x with ones on every position
     // Every rank will have a valid part of the final b vector stored
+    #pragma omp parallel for
     for (int j = 0; j < local_matrix_width; j++) {
         HOST_DATA_TYPE local_col_sum = 0.0;
         for (int i = 0; i < local_matrix_height; i++) {
             local_col_sum += d->A[local_matrix_width*i+j];
         }
-        MPI_Allreduce(&local_col_sum, &(d->b[j]), 1, MPI_DATA_TYPE, MPI_SUM, col_communicator);   
+        d->b[j] = local_col_sum;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, d->b, local_matrix_width, MPI_DATA_TYPE, MPI_SUM, col_communicator);
+
+    d->normb = 0.0;
+    for (int j = 0; j < local_matrix_width; j++) {
         d->normb = (d->b[j] > d->normb) ? d->b[j] : d->normb;   
     }
     return d;
@@ -292,64 +464,61 @@ linpack::LinpackBenchmark::validateOutputAndPrintError(linpack::LinpackData &dat
     double residn;
     double resid = 0.0;
     double normx = 0.0;
-#ifndef DISTRIBUTED_VALIDATION
-    if (mpi_comm_rank > 0) {
-        for (int j = 0; j < matrix_height; j++) {
-            for (int i = 0; i < matrix_width; i+= executionSettings->programSettings->blockSize) {
-                MPI_Send(&data.A[matrix_width * j + i], executionSettings->programSettings->blockSize, MPI_DATA_TYPE, 0, 0, MPI_COMM_WORLD);
-            }
+    if (executionSettings->programSettings->isMixedPrecision) {
+        // Scaled residual ||Ax - b|| / ((||A|| * ||x|| + ||b||) * n * eps) in double precision as used by HPL-MxP
+        auto original = generateInputData();
+        auto a = gather_matrix(original->A, data);
+        if (mpi_comm_rank > 0) {
+            return true;
         }
-        if (executionSettings->programSettings->torus_row == 0) {
-            for (int i = 0; i < matrix_width; i+= executionSettings->programSettings->blockSize) {
-                MPI_Send(&data.b[i], executionSettings->programSettings->blockSize, MPI_DATA_TYPE, 0, 0, MPI_COMM_WORLD);
+        std::vector<double> ax(n, 0.0);
+        std::vector<double> b(n, 0.0);
+        std::vector<double> row_norm(n, 0.0);
+        #pragma omp parallel for
+        for (uint i = 0; i < n; i++) {
+            for (uint j = 0; j < n; j++) {
+                double v = a[static_cast<size_t>(j) * n + i];
+                ax[i] += v * data.refined_x[j];
+                b[i] += v;
+                row_norm[i] += std::abs(v);
             }
         }
-        residn = 0;
-    }
-    else {
-        MPI_Status status;
-        size_t current_offset = 0;
-        std::vector<HOST_DATA_TYPE> total_b_original(n);
-        std::vector<HOST_DATA_TYPE> total_b(n);
-        std::vector<HOST_DATA_TYPE> total_a(n*n);
-        for (int j = 0; j < n; j++) {
-            for (int i = 0; i < n; i+= executionSettings->programSettings->blockSize) {
-                int recvcol= (i / executionSettings->programSettings->blockSize) % executionSettings->programSettings->torus_width;
-                int recvrow= (j / executionSettings->programSettings->blockSize) % executionSettings->programSettings->torus_height;
-                int recvrank = executionSettings->programSettings->torus_width * recvrow + recvcol;
-                if (recvrank > 0) {
-                    MPI_Recv(&total_a[j * n + i],executionSettings->programSettings->blockSize, MPI_DATA_TYPE, recvrank, 0, MPI_COMM_WORLD,  &status);
-                }
-                else {
-                    for (int k=0; k < executionSettings->programSettings->blockSize; k++) {
-                        total_a[j * n + i + k] = data.A[current_offset + k];
-                    }
-                    current_offset += executionSettings->programSettings->blockSize;
-                }
-            }
+        double norma = 0.0;
+        double normb = 0.0;
+        for (uint i = 0; i < n; i++) {
+            resid = std::max(resid, std::abs(ax[i] - b[i]));
+            norma = std::max(norma, row_norm[i]);
+            normb = std::max(normb, std::abs(b[i]));
+            normx = std::max(normx, std::abs(data.refined_x[i]));
         }
-        current_offset = 0;
-        for (int i = 0; i < n; i+= executionSettings->programSettings->blockSize) {
-            int recvcol= (i / executionSettings->programSettings->blockSize) % executionSettings->programSettings->torus_width;
-            if (recvcol > 0) {
-                MPI_Recv(&total_b[i], executionSettings->programSettings->blockSize, MPI_DATA_TYPE, recvcol, 0, MPI_COMM_WORLD, &status);
-            }
-            else {
-                for (int k=0; k < executionSettings->programSettings->blockSize; k++) {
-                    total_b[i + k] = data.b[current_offset + k];
-                }
-                current_offset += executionSettings->programSettings->blockSize;
+        double eps = std::numeric_limits<double>::epsilon() / 2.0;
+        residn = resid / ((norma * normx + normb) * static_cast<double>(n) * eps);
+        std::cout << "  norm. resid        resid       "\
+                    "machep   " << std::endl;
+        std::cout << std::setw(ENTRY_SPACE) << residn << std::setw(ENTRY_SPACE)
+                << resid << std::setw(ENTRY_SPACE) << eps << std::endl;
+        // Threshold of the HPL-MxP residual check
+        return residn < 16;
+    }
+    if (executionSettings->programSettings->validationMode == hpcc_base::ValidationMode::sampled) {
+        if (executionSettings->programSettings->isDiagonallyDominant) {
+            residn = freivalds_lu_residual(data);
+            if (mpi_comm_rank == 0) {
+                std::cout << "  norm. resid  Freivalds trials" << std::endl;
+                std::cout << std::setw(ENTRY_SPACE) << residn << std::setw(ENTRY_SPACE)
+                        << hpcc_base::validation::freivaldsTrials(executionSettings->programSettings->validationErrorBound) << std::endl;
+                return residn < 1;
             }
+            return true;
         }
-
-        std::copy(total_b.begin(), total_b.end(), total_b_original.begin());
-        gesl_ref_nopvt(total_a.data(), total_b.data(), n, n);
-
-        for (int i = 0; i < n; i++) {
-            resid = (resid > std::abs(total_b[i] - 1)) ? resid : std::abs(total_b[i] - 1);
-            normx = (normx > std::abs(total_b_original[i])) ? normx : std::abs(total_b_original[i]);
+        else if (mpi_comm_rank == 0) {
+            std::cout << "Sampled validation is not supported with pivoting. Full validation is used instead." << std::endl;
         }
     }
+#ifndef DISTRIBUTED_VALIDATION
+    // Solve the system distributed and calculate the residual of Ax - b without gathering the matrix
+    distributed_gesl_ref(data);
+    residn = distributed_residual(data, resid);
 #else
     double local_resid = 0;
     double local_normx = data.normb;
@@ -363,11 +532,11 @@ linpack::LinpackBenchmark::validateOutputAndPrintError(linpack::LinpackData &dat
 
     MPI_Reduce(&local_resid, &resid, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
     MPI_Reduce(&local_normx, &normx, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    residn = resid / (static_cast<double>(n)*normx*std::numeric_limits<HOST_DATA_TYPE>::epsilon());
 #endif
 
 
     HOST_DATA_TYPE eps = std::numeric_limits<HOST_DATA_TYPE>::epsilon();
-    residn = resid / (static_cast<double>(n)*normx*eps);
 
     #ifndef NDEBUG
         if (residn > 1 &&  mpi_comm_size == 1) {
@@ -423,111 +592,417 @@ linpack::LinpackBenchmark::validateOutputAndPrintError(linpack::LinpackData &dat
     }
 }
 
-void 
-linpack::LinpackBenchmark::distributed_gesl_nopvt_ref(linpack::LinpackData& data) {
-    uint global_matrix_size = executionSettings->programSettings->matrixSize;
+double
+linpack::LinpackBenchmark::freivalds_lu_residual(linpack::LinpackData& data) {
+    uint n = executionSettings->programSettings->matrixSize;
     uint matrix_width = data.matrix_width;
     uint matrix_height = data.matrix_height;
     uint block_size = executionSettings->programSettings->blockSize;
-    // create a communicator to exchange the rows
-    MPI_Comm row_communicator;
-    MPI_Comm_split(MPI_COMM_WORLD, executionSettings->programSettings->torus_row, 0,&row_communicator);
-    MPI_Comm col_communicator;
-    MPI_Comm_split(MPI_COMM_WORLD, executionSettings->programSettings->torus_col, 0,&col_communicator);
-    std::vector<HOST_DATA_TYPE> b_tmp(matrix_width);
-
-    for (int k = 0; k < b_tmp.size(); k++) {
-        b_tmp[k] = data.b[k];
+    uint torus_width = executionSettings->programSettings->torus_width;
+    uint torus_height = executionSettings->programSettings->torus_height;
+    uint torus_row = executionSettings->programSettings->torus_row;
+    uint torus_col = executionSettings->programSettings->torus_col;
+
+    // The input matrix is generated from the position of the values, so it can be recreated without storing a copy
+    auto original = generateInputData();
+
+    size_t trials = hpcc_base::validation::freivaldsTrials(executionSettings->programSettings->validationErrorBound);
+    // same seed on all ranks, so every rank uses the same vectors
+    auto x = hpcc_base::validation::freivaldsVectors(executionSettings->programSettings->validationErrorBound, n, 0);
+
+    // global indices of the local rows and columns
+    std::vector<size_t> global_j(matrix_height);
+    for (uint lj = 0; lj < matrix_height; lj++) {
+        global_j[lj] = ((lj / block_size) * torus_height + torus_row) * block_size + lj % block_size;
+    }
+    std::vector<size_t> global_i(matrix_width);
+    for (uint li = 0; li < matrix_width; li++) {
+        global_i[li] = ((li / block_size) * torus_width + torus_col) * block_size + li % block_size;
     }
 
-    // solve l*y = b
-    // For each row in matrix
-    for (int k = 0; k < global_matrix_size - 1; k++) {
-        size_t local_k_index_col =  k / (block_size * executionSettings->programSettings->torus_width) * block_size;
-        size_t local_k_index_row =  k / (block_size * executionSettings->programSettings->torus_height) * block_size;
-        size_t remaining_k_col = k % (block_size * executionSettings->programSettings->torus_width);
-        size_t remaining_k_row = k % (block_size * executionSettings->programSettings->torus_height);
-        size_t start_offset = local_k_index_col;
-        if (remaining_k_col / block_size > executionSettings->programSettings->torus_col){
-            local_k_index_col += block_size;
-            start_offset = local_k_index_col;
-        }
-        else if (remaining_k_col / block_size == executionSettings->programSettings->torus_col) {
-            local_k_index_col += (remaining_k_col % block_size);
-            start_offset = local_k_index_col + 1;
-        }
-        if (remaining_k_row / block_size > executionSettings->programSettings->torus_row){
-            local_k_index_row += block_size;
-        }
-        else if (remaining_k_row / block_size == executionSettings->programSettings->torus_row) {
-            local_k_index_row += (remaining_k_row % block_size);
-        }
-
-        int row_diagonal_rank = (k / block_size) % executionSettings->programSettings->torus_height;
-        int col_diagonal_rank = (k / block_size) % executionSettings->programSettings->torus_width;
-        std::vector<HOST_DATA_TYPE> tmp_scaled_b(matrix_width, 0.0);
-        if (row_diagonal_rank == executionSettings->programSettings->torus_row) {
-            HOST_DATA_TYPE current_k;
-            current_k = (local_k_index_col < matrix_width) ? b_tmp[local_k_index_col] : 0.0;
-            MPI_Bcast(&current_k, 1, MPI_DATA_TYPE,  col_diagonal_rank, row_communicator);
-            // For each row below add
-            for (int i = start_offset; i < matrix_width; i++) {
-                // add solved upper row to current row
-                tmp_scaled_b[i] = current_k * data.A[matrix_width * local_k_index_row + i];
+    // gefa stores the factors transposed: a[j * lda + i] contains the value for row i and column j.
+    // The diagonal contains the negative inverse of U, the multipliers of L are negated.
+    // First pass: y = U * x, |U| * 1 and w = A * x. The last n values of the buffer hold |U| * 1
+    std::vector<double> ux((trials + 1) * n, 0.0);
+    std::vector<double> ax(trials * n, 0.0);
+    #pragma omp parallel for
+    for (uint li = 0; li < matrix_width; li++) {
+        size_t r = global_i[li];
+        for (uint lj = 0; lj < matrix_height; lj++) {
+            size_t c = global_j[lj];
+            double s = data.A[static_cast<size_t>(matrix_width) * lj + li];
+            double orig = original->A[static_cast<size_t>(matrix_width) * lj + li];
+            double u = (r == c) ? -1.0 / s : ((r < c) ? s : 0.0);
+            for (size_t t = 0; t < trials; t++) {
+                ux[t * n + r] += u * x[t * n + c];
+                ax[t * n + r] += orig * x[t * n + c];
             }
+            ux[trials * n + r] += std::abs(u);
         }
-        MPI_Bcast(&tmp_scaled_b.data()[start_offset], matrix_width - start_offset, MPI_DATA_TYPE, row_diagonal_rank, col_communicator);
-        for (int i = start_offset; i < matrix_width; i++) {
-            // add solved upper row to current row
-            b_tmp[i] += tmp_scaled_b[i];
+    }
+    MPI_Allreduce(MPI_IN_PLACE, ux.data(), ux.size(), MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, ax.data(), ax.size(), MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+
+    // Second pass: z = L * y and |L| * |U| * 1 without the unit diagonal of L
+    std::vector<double> lux((trials + 1) * n, 0.0);
+    #pragma omp parallel for
+    for (uint li = 0; li < matrix_width; li++) {
+        size_t r = global_i[li];
+        for (uint lj = 0; lj < matrix_height; lj++) {
+            size_t c = global_j[lj];
+            if (r <= c) {
+                continue;
+            }
+            double l = -data.A[static_cast<size_t>(matrix_width) * lj + li];
+            for (size_t t = 0; t < trials + 1; t++) {
+                lux[t * n + r] += ((t < trials) ? l : std::abs(l)) * ux[t * n + c];
+            }
+        }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, lux.data(), lux.size(), MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+
+    double eps = std::numeric_limits<HOST_DATA_TYPE>::epsilon();
+    double residn = 0.0;
+    #pragma omp parallel for reduction(max:residn)
+    for (uint r = 0; r < n; r++) {
+        double tolerance = static_cast<double>(n) * eps * (lux[trials * n + r] + ux[trials * n + r]) + std::numeric_limits<double>::min();
+        for (size_t t = 0; t < trials; t++) {
+            double diff = std::abs(lux[t * n + r] + ux[t * n + r] - ax[t * n + r]);
+            residn = std::max(residn, diff / tolerance);
         }
     }
+    return residn;
+}
 
-    // now solve  u*x = y
-    for (int k = global_matrix_size - 1; k >= 0; k--) {
-        size_t local_k_index_col =  k / (block_size * executionSettings->programSettings->torus_width) * block_size;
-        size_t local_k_index_row =  k / (block_size * executionSettings->programSettings->torus_height) * block_size;
-        size_t remaining_k_col = k % (block_size * executionSettings->programSettings->torus_width);
-        size_t remaining_k_row = k % (block_size * executionSettings->programSettings->torus_height);
-        if (remaining_k_col / block_size > executionSettings->programSettings->torus_col){
-            local_k_index_col += block_size;
+std::vector<double>
+linpack::LinpackBenchmark::gather_matrix(const HOST_DATA_TYPE* local, const linpack::LinpackData& data) {
+    uint n = executionSettings->programSettings->matrixSize;
+    uint block_size = executionSettings->programSettings->blockSize;
+    uint torus_width = executionSettings->programSettings->torus_width;
+    uint torus_height = executionSettings->programSettings->torus_height;
+    uint num_blocks = n / block_size;
+
+    // The local matrix sizes differ, if the number of blocks is not a multiple of the grid size
+    std::vector<int> counts(mpi_comm_size);
+    std::vector<int> offsets(mpi_comm_size);
+    int total_size = 0;
+    for (int rank = 0; rank < mpi_comm_size; rank++) {
+        counts[rank] = linpack::local_block_count(num_blocks, torus_width, rank % torus_width) *
+                        linpack::local_block_count(num_blocks, torus_height, rank / torus_width) * block_size * block_size;
+        offsets[rank] = total_size;
+        total_size += counts[rank];
+    }
+    std::vector<HOST_DATA_TYPE> buffer((mpi_comm_rank == 0) ? total_size : 0);
+    MPI_Gatherv(local, data.matrix_width * data.matrix_height, MPI_DATA_TYPE, buffer.data(), counts.data(), offsets.data(), MPI_DATA_TYPE, 0, MPI_COMM_WORLD);
+
+    std::vector<double> global;
+    if (mpi_comm_rank > 0) {
+        return global;
+    }
+    global.resize(static_cast<size_t>(n) * n);
+    for (int rank = 0; rank < mpi_comm_size; rank++) {
+        uint torus_row = rank / torus_width;
+        uint torus_col = rank % torus_width;
+        uint matrix_width = linpack::local_block_count(num_blocks, torus_width, torus_col) * block_size;
+        uint matrix_height = linpack::local_block_count(num_blocks, torus_height, torus_row) * block_size;
+        #pragma omp parallel for
+        for (uint lj = 0; lj < matrix_height; lj++) {
+            size_t c = ((lj / block_size) * torus_height + torus_row) * block_size + lj % block_size;
+            for (uint li = 0; li < matrix_width; li++) {
+                size_t r = ((li / block_size) * torus_width + torus_col) * block_size + li % block_size;
+                global[c * n + r] = buffer[offsets[rank] + static_cast<size_t>(matrix_width) * lj + li];
+            }
         }
-        else if (remaining_k_col / block_size == executionSettings->programSettings->torus_col) {
-            local_k_index_col += remaining_k_col % block_size;
+    }
+    return global;
+}
+
+double
+linpack::LinpackBenchmark::mixed_precision_refinement(linpack::LinpackData& data) {
+    uint n = executionSettings->programSettings->matrixSize;
+
+    // The input matrix is generated from the position of the values, so it can be recreated without storing a copy
+    auto original = generateInputData();
+    auto a = gather_matrix(original->A, data);
+    auto lu = gather_matrix(data.A, data);
+
+    if (mpi_comm_rank == 0) {
+        // Convert the factors to the format used by gmres_ref: U contains its diagonal instead of the negative
+        // inverse and the multipliers of L are not negated
+        #pragma omp parallel for
+        for (uint j = 0; j < n; j++) {
+            for (uint i = 0; i < n; i++) {
+                size_t index = static_cast<size_t>(j) * n + i;
+                if (i == j) {
+                    lu[index] = -1.0 / lu[index];
+                }
+                else if (i > j) {
+                    lu[index] = -lu[index];
+                }
+            }
         }
-        if (remaining_k_row / block_size > executionSettings->programSettings->torus_row){
-            local_k_index_row += block_size;
+        // b is calculated in double precision, so the exact solution is one on every position
+        std::vector<double> b(n, 0.0);
+        #pragma omp parallel for
+        for (uint i = 0; i < n; i++) {
+            for (uint j = 0; j < n; j++) {
+                b[i] += a[static_cast<size_t>(j) * n + i];
+            }
         }
-        else if (remaining_k_row / block_size == executionSettings->programSettings->torus_row) {
-            local_k_index_row += remaining_k_row % block_size;
+        // Same restart and tolerance as the HPL-AI reference implementation
+        double tol = std::numeric_limits<double>::epsilon() / 2.0 / (n / 4.0);
+        data.refined_x.assign(n, 0.0);
+        // Only the GMRES iterations are measured. The preparation of the matrix and the factors is host setup.
+        auto t1 = std::chrono::high_resolution_clock::now();
+        gmres_ref(n, a.data(), n, data.refined_x.data(), b.data(), lu.data(), n, 50, 1, tol);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count();
+    }
+    return 0.0;
+}
+
+double
+linpack::LinpackBenchmark::distributed_residual(linpack::LinpackData& data, double& resid) {
+    uint n = executionSettings->programSettings->matrixSize;
+    uint matrix_width = data.matrix_width;
+    uint matrix_height = data.matrix_height;
+    uint block_size = executionSettings->programSettings->blockSize;
+    uint torus_width = executionSettings->programSettings->torus_width;
+    uint torus_height = executionSettings->programSettings->torus_height;
+    uint torus_row = executionSettings->programSettings->torus_row;
+    uint torus_col = executionSettings->programSettings->torus_col;
+
+    // The input matrix is generated from the position of the values, so it can be recreated without storing a copy
+    auto original = generateInputData();
+
+    // global indices of the local rows and columns
+    std::vector<size_t> global_j(matrix_height);
+    for (uint lj = 0; lj < matrix_height; lj++) {
+        global_j[lj] = ((lj / block_size) * torus_height + torus_row) * block_size + lj % block_size;
+    }
+    std::vector<size_t> global_i(matrix_width);
+    for (uint li = 0; li < matrix_width; li++) {
+        global_i[li] = ((li / block_size) * torus_width + torus_col) * block_size + li % block_size;
+    }
+
+    // Every torus row contains the whole solution, so it is collected over the row communicator
+    std::vector<double> x(n, 0.0);
+    for (uint li = 0; li < matrix_width; li++) {
+        x[global_i[li]] = data.b[li];
+    }
+    MPI_Allreduce(MPI_IN_PLACE, x.data(), n, MPI_DOUBLE, MPI_SUM, row_communicator);
+
+    // The matrix is stored transposed: A[lj * matrix_width + li] contains the value for row i and column j.
+    // Partial sums of A * x and |A| * 1 for the local rows. The last matrix_width values hold |A| * 1
+    std::vector<double> ax(2 * matrix_width, 0.0);
+    #pragma omp parallel for
+    for (uint li = 0; li < matrix_width; li++) {
+        for (uint lj = 0; lj < matrix_height; lj++) {
+            double orig = original->A[static_cast<size_t>(matrix_width) * lj + li];
+            ax[li] += orig * x[global_j[lj]];
+            ax[matrix_width + li] += std::abs(orig);
         }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, ax.data(), ax.size(), MPI_DOUBLE, MPI_SUM, col_communicator);
+
+    // ||Ax - b||, ||A|| and ||x|| using the infinity norm
+    double norms[3] = {0.0, 0.0, 0.0};
+    for (uint li = 0; li < matrix_width; li++) {
+        norms[0] = std::max(norms[0], std::abs(ax[li] - original->b[li]));
+        norms[1] = std::max(norms[1], ax[matrix_width + li]);
+        norms[2] = std::max(norms[2], std::abs(x[global_i[li]]));
+    }
+    MPI_Allreduce(MPI_IN_PLACE, norms, 3, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+    resid = norms[0];
+    double eps = std::numeric_limits<HOST_DATA_TYPE>::epsilon();
+    return norms[0] / (norms[1] * norms[2] * static_cast<double>(n) * eps);
+}
 
-        HOST_DATA_TYPE scale_element = (local_k_index_col < matrix_width && local_k_index_row < matrix_height) ? b_tmp[local_k_index_col] * data.A[matrix_width * local_k_index_row + local_k_index_col] : 0.0;
-        int row_diagonal_rank = (k / block_size) % executionSettings->programSettings->torus_height;
-        int col_diagonal_rank = (k / block_size) % executionSettings->programSettings->torus_width;
-        MPI_Bcast(&scale_element, 1, MPI_DATA_TYPE, row_diagonal_rank, col_communicator);
-        if (col_diagonal_rank == executionSettings->programSettings->torus_col) {
-            b_tmp[local_k_index_col] = -scale_element;
+std::vector<cl_int>
+linpack::LinpackBenchmark::distributed_pivot_indices(linpack::LinpackData& data) {
+    uint n = executionSettings->programSettings->matrixSize;
+    uint block_size = executionSettings->programSettings->blockSize;
+    uint torus_width = executionSettings->programSettings->torus_width;
+    uint torus_height = executionSettings->programSettings->torus_height;
+    uint torus_row = executionSettings->programSettings->torus_row;
+    uint torus_col = executionSettings->programSettings->torus_col;
+
+    std::vector<cl_int> ipvt(n, 0);
+    // All ranks of the torus row of a panel store its pivots, so only the rank holding the LU block contributes them
+    for (uint lb_row = 0; lb_row < data.matrix_height / block_size; lb_row++) {
+        uint gb = lb_row * torus_height + torus_row;
+        if (gb % torus_width != torus_col) {
+            continue;
         }
-        MPI_Bcast(&scale_element, 1, MPI_DATA_TYPE, col_diagonal_rank, row_communicator);
-        size_t end_offset = local_k_index_col;
+        std::copy(data.ipvt + lb_row * block_size, data.ipvt + (lb_row + 1) * block_size, ipvt.begin() + gb * block_size);
+    }
+    MPI_Allreduce(MPI_IN_PLACE, ipvt.data(), n, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    return ipvt;
+}
 
-        std::vector<HOST_DATA_TYPE> tmp_scaled_b(matrix_width, 0.0);
-        if (row_diagonal_rank == executionSettings->programSettings->torus_row) {
-            // For each row below add
-            for (int i = 0; i < end_offset; i++) {
-                tmp_scaled_b[i] = scale_element * data.A[matrix_width * local_k_index_row + i];
+void 
+linpack::LinpackBenchmark::distributed_gesl_ref(linpack::LinpackData& data) {
+    uint global_matrix_size = executionSettings->programSettings->matrixSize;
+    uint matrix_width = data.matrix_width;
+    uint block_size = executionSettings->programSettings->blockSize;
+    uint num_blocks = global_matrix_size / block_size;
+    uint torus_width = executionSettings->programSettings->torus_width;
+    uint torus_height = executionSettings->programSettings->torus_height;
+    uint torus_row = executionSettings->programSettings->torus_row;
+    uint torus_col = executionSettings->programSettings->torus_col;
+    // Pivots are only calculated without diagonal dominance
+    std::vector<cl_int> ipvt;
+    if (!executionSettings->programSettings->isDiagonallyDominant) {
+        ipvt = distributed_pivot_indices(data);
+    }
+    std::vector<HOST_DATA_TYPE> b_tmp(data.b, data.b + matrix_width);
+
+    // The system is solved block by block. The rank that holds the diagonal block solves it with the same operations
+    // as the unblocked substitution and broadcasts the solution within its torus row. The ranks of this torus row
+    // calculate the updates of their local part of b for the whole block and broadcast them within their torus columns.
+    // The updates of the columns that are needed to solve the next diagonal block are broadcasted first.
+    // The remaining updates are only waited for after the next diagonal block is solved, so their broadcast
+    // overlaps with the solution of the next block.
+
+    // Number of local columns that belong to global blocks before the given block
+    auto local_columns_before = [&](int block) -> size_t {
+        return local_block_count(std::max(block, 0), torus_width, torus_col) * block_size;
+    };
+    // Number of local columns that belong to the given global blocks
+    auto local_columns_of = [&](int first_block, int last_block) -> size_t {
+        return local_columns_before(std::min(last_block + 1, static_cast<int>(num_blocks))) - local_columns_before(first_block);
+    };
+
+    std::vector<HOST_DATA_TYPE> diagonal_values(block_size);
+    std::vector<HOST_DATA_TYPE> head_update(matrix_width);
+    // The remaining updates of the current and the previous block are still in flight, so they need separate buffers
+    std::vector<std::vector<HOST_DATA_TYPE>> tail_updates(2, std::vector<HOST_DATA_TYPE>(matrix_width));
+    MPI_Request tail_request = MPI_REQUEST_NULL;
+    size_t tail_begin = 0;
+    size_t tail_end = 0;
+    int tail_buffer = 0;
+
+    // Calculate the updates of the columns [begin, end) caused by the solution of a diagonal block.
+    // The columns of the diagonal block itself contain their solution.
+    auto calculate_update = [&](std::vector<HOST_DATA_TYPE>& update, HOST_DATA_TYPE const* block_rows,
+                                    size_t begin, size_t end, size_t diagonal_begin, size_t diagonal_end, bool backward) {
+        #pragma omp parallel for
+        for (size_t i = begin; i < end; i++) {
+            if (i >= diagonal_begin && i < diagonal_end) {
+                update[i] = backward ? -diagonal_values[i - diagonal_begin] : diagonal_values[i - diagonal_begin];
+                continue;
+            }
+            HOST_DATA_TYPE sum = 0.0;
+            for (uint r = 0; r < block_size; r++) {
+                sum += diagonal_values[r] * block_rows[matrix_width * r + i];
             }
+            update[i] = sum;
         }
-        MPI_Bcast(tmp_scaled_b.data(), end_offset, MPI_DATA_TYPE, row_diagonal_rank, col_communicator);
-        for (int i = 0; i < end_offset; i++) {
-            // add solved upper row to current row
-            b_tmp[i] += tmp_scaled_b[i];
+    };
+    // Add the updates of the columns [begin, end) to b and replace the columns of the diagonal block by their solution
+    auto apply_update = [&](std::vector<HOST_DATA_TYPE> const& update, size_t begin, size_t end, size_t diagonal_begin, size_t diagonal_end) {
+        for (size_t i = begin; i < end; i++) {
+            b_tmp[i] = (i >= diagonal_begin && i < diagonal_end) ? update[i] : b_tmp[i] + update[i];
+        }
+    };
+    // Calculate and broadcast the updates of a solved diagonal block. The remaining updates of the previous block are applied afterwards.
+    auto distribute_block = [&](int block, size_t head_begin, size_t head_end, size_t next_tail_begin, size_t next_tail_end,
+                                    size_t diagonal_begin, size_t diagonal_end, bool backward) {
+        uint row_diagonal_rank = block % torus_height;
+        uint col_diagonal_rank = block % torus_width;
+        HOST_DATA_TYPE const* block_rows = nullptr;
+        if (row_diagonal_rank == torus_row) {
+            MPI_Bcast(diagonal_values.data(), block_size, MPI_DATA_TYPE, col_diagonal_rank, row_communicator);
+            block_rows = &data.A[matrix_width * (block / torus_height) * block_size];
+            calculate_update(head_update, block_rows, head_begin, head_end, diagonal_begin, diagonal_end, backward);
+        }
+        MPI_Request head_request;
+        MPI_Ibcast(head_update.data() + head_begin, head_end - head_begin, MPI_DATA_TYPE, row_diagonal_rank, col_communicator, &head_request);
+        int next_tail_buffer = 1 - tail_buffer;
+        if (row_diagonal_rank == torus_row) {
+            calculate_update(tail_updates[next_tail_buffer], block_rows, next_tail_begin, next_tail_end, diagonal_begin, diagonal_end, backward);
+        }
+        MPI_Request next_tail_request;
+        MPI_Ibcast(tail_updates[next_tail_buffer].data() + next_tail_begin, next_tail_end - next_tail_begin, MPI_DATA_TYPE,
+                        row_diagonal_rank, col_communicator, &next_tail_request);
+        MPI_Wait(&head_request, MPI_STATUS_IGNORE);
+        apply_update(head_update, head_begin, head_end, diagonal_begin, diagonal_end);
+        MPI_Wait(&tail_request, MPI_STATUS_IGNORE);
+        apply_update(tail_updates[tail_buffer], tail_begin, tail_end, 0, 0);
+        tail_request = next_tail_request;
+        tail_buffer = next_tail_buffer;
+        tail_begin = next_tail_begin;
+        tail_end = next_tail_end;
+    };
+    auto finish_blocks = [&]() {
+        MPI_Wait(&tail_request, MPI_STATUS_IGNORE);
+        apply_update(tail_updates[tail_buffer], tail_begin, tail_end, 0, 0);
+        tail_begin = 0;
+        tail_end = 0;
+    };
+
+    // solve l*y = b
+    for (int kb = 0; kb < static_cast<int>(num_blocks); kb++) {
+        size_t block_begin = local_columns_before(kb);
+        bool is_diagonal_col = (kb % torus_width) == torus_col;
+        if (!ipvt.empty()) {
+            // The pivots of the block may be located anywhere below it, so all pending updates are needed
+            // before the values are exchanged. The exchanges of the whole block are applied at once,
+            // because the panel factorization exchanged the rows over the whole panel width.
+            finish_blocks();
+            auto columns = pivot_columns(&ipvt[kb * block_size], block_size, kb);
+            std::vector<HOST_DATA_TYPE> values(columns.size(), 0.0);
+            for (size_t s = 0; s < columns.size(); s++) {
+                if ((columns[s] / block_size) % torus_width == torus_col) {
+                    values[s] = b_tmp[((columns[s] / block_size) / torus_width) * block_size + columns[s] % block_size];
+                }
+            }
+            exchange_pivot_columns(values.data(), 1, columns, &ipvt[kb * block_size], block_size, kb, row_communicator);
+            for (size_t s = 0; s < columns.size(); s++) {
+                if ((columns[s] / block_size) % torus_width == torus_col) {
+                    b_tmp[((columns[s] / block_size) / torus_width) * block_size + columns[s] % block_size] = values[s];
+                }
+            }
         }
+        if (is_diagonal_col && (kb % torus_height) == torus_row) {
+            HOST_DATA_TYPE const* block_rows = &data.A[matrix_width * (kb / torus_height) * block_size];
+            std::copy(b_tmp.begin() + block_begin, b_tmp.begin() + block_begin + block_size, diagonal_values.begin());
+            for (uint r = 0; r < block_size; r++) {
+                for (uint i = r + 1; i < block_size; i++) {
+                    diagonal_values[i] += diagonal_values[r] * block_rows[matrix_width * r + block_begin + i];
+                }
+            }
+        }
+        // The columns of this and the next block are needed to solve the next block
+        size_t head_end = block_begin + local_columns_of(kb, kb + 1);
+        distribute_block(kb, block_begin, head_end, head_end, matrix_width,
+                            block_begin, is_diagonal_col ? block_begin + block_size : block_begin, false);
     }
-    for (int k = 0; k < b_tmp.size(); k++) {
-        data.b[k] = b_tmp[k];
+    finish_blocks();
+
+    // now solve  u*x = y
+    for (int kb = num_blocks - 1; kb >= 0; kb--) {
+        size_t block_end = local_columns_before(kb + 1);
+        bool is_diagonal_col = (kb % torus_width) == torus_col;
+        size_t block_begin = is_diagonal_col ? block_end - block_size : block_end;
+        if (is_diagonal_col && (kb % torus_height) == torus_row) {
+            // The diagonal of the LU factorization is stored inverted, so the values are scaled instead of divided
+            HOST_DATA_TYPE const* block_rows = &data.A[matrix_width * (kb / torus_height) * block_size];
+            std::copy(b_tmp.begin() + block_begin, b_tmp.begin() + block_end, diagonal_values.begin());
+            for (int r = block_size - 1; r >= 0; r--) {
+                diagonal_values[r] *= block_rows[matrix_width * r + block_begin + r];
+                for (int i = 0; i < r; i++) {
+                    diagonal_values[i] += diagonal_values[r] * block_rows[matrix_width * r + block_begin + i];
+                }
+            }
+        }
+        size_t head_begin = block_end - local_columns_of(kb - 1, kb);
+        distribute_block(kb, head_begin, block_end, 0, head_begin, block_begin, block_end, true);
     }
+    finish_blocks();
+
+    std::copy(b_tmp.begin(), b_tmp.end(), data.b);
 
 #ifndef NDEBUG
     MPI_Barrier(MPI_COMM_WORLD);
@@ -548,60 +1023,324 @@ linpack::LinpackBenchmark::distributed_gesl_nopvt_ref(linpack::LinpackData& data
 #endif
 }
 
-/**
-Standard LU factorization on a block with fixed size
+uint
+linpack::local_block_count(uint num_blocks, uint grid_size, uint grid_index) {
+    return num_blocks / grid_size + ((grid_index < num_blocks % grid_size) ? 1 : 0);
+}
 
-Case 1 of Zhangs description
-*/
-void
-linpack::gefa_ref(HOST_DATA_TYPE* a, unsigned n, unsigned lda, cl_int* ipvt) {
-    for (int i = 0; i < n; i++) {
-        ipvt[i] = i;
+uint
+linpack::best_torus_width(uint num_ranks, uint num_blocks) {
+    uint best_width = 1;
+    double best_time = std::numeric_limits<double>::max();
+    for (uint width = 1; width <= num_ranks; width++) {
+        if (num_ranks % width != 0) {
+            continue;
+        }
+        uint height = num_ranks / width;
+        if (num_blocks < std::max(width, height)) {
+            continue;
+        }
+        // Local blocks of the rank with the most blocks in the first iteration.
+        // Every block row, the rank updates all its local blocks and receives one block for every local row and column
+        double local_cols = local_block_count(num_blocks, width, 0);
+        double local_rows = local_block_count(num_blocks, height, 0);
+        double predicted_time = local_rows * local_cols + local_rows + local_cols;
+        if (predicted_time < best_time) {
+            best_time = predicted_time;
+            best_width = width;
+        }
     }
-    // For each diagnonal element
-    for (int k = 0; k < n - 1; k++) {
-        HOST_DATA_TYPE max_val = fabs(a[k * lda + k]);
-        int pvt_index = k;
-        for (int i = k + 1; i < n; i++) {
-            if (max_val < fabs(a[k * lda + i])) {
-                pvt_index = i;
-                max_val = fabs(a[k * lda + i]);
+    return best_width;
+}
+
+void
+linpack::distributed_gefa_panel(HOST_DATA_TYPE* panel, unsigned matrix_width, unsigned block_size, unsigned block_row,
+                                unsigned torus_width, unsigned torus_col, MPI_Comm row_communicator, cl_int* ipvt) {
+    // The pivot candidates are stored together with their global column index for the MAXLOC reduction
+    struct {
+        HOST_DATA_TYPE value;
+        int index;
+    } local_max, global_max;
+#ifdef _DP
+    MPI_Datatype pivot_type = MPI_DOUBLE_INT;
+#else
+    MPI_Datatype pivot_type = MPI_FLOAT_INT;
+#endif
+    uint diagonal_col = block_row % torus_width;
+    bool is_diagonal_rank = diagonal_col == torus_col;
+    // Local column of the diagonal block on the diagonal rank and of the first block right of it on all other ranks
+    size_t first_local_col = local_block_count(block_row, torus_width, torus_col) * block_size;
+    auto global_col = [&](size_t local_col) -> int {
+        return ((local_col / block_size) * torus_width + torus_col) * block_size + local_col % block_size;
+    };
+    std::vector<HOST_DATA_TYPE> column(block_size);
+
+    for (uint k = 0; k < block_size; k++) {
+        int gk = block_row * block_size + k;
+        size_t begin = first_local_col + (is_diagonal_rank ? k : 0);
+
+        // Search the pivot in the whole column. Ranks without a candidate can not win the reduction.
+        // For equal values, MAXLOC returns the smaller index, so the first maximum is used like in gefa_ref
+        local_max.value = -1.0;
+        local_max.index = gk;
+        for (size_t i = begin; i < matrix_width; i++) {
+            HOST_DATA_TYPE value = std::abs(panel[matrix_width * k + i]);
+            if (value > local_max.value) {
+                local_max.value = value;
+                local_max.index = global_col(i);
+            }
+        }
+        MPI_Allreduce(&local_max, &global_max, 1, pivot_type, MPI_MAXLOC, row_communicator);
+        int pivot = global_max.index;
+        ipvt[k] = pivot;
+
+        // Exchange the rows over the whole panel, so the multipliers can directly be used for the trailing update
+        if (pivot != gk) {
+            uint pivot_col = (pivot / block_size) % torus_width;
+            size_t local_pivot = ((pivot / block_size) / torus_width) * block_size + pivot % block_size;
+            size_t local_k = first_local_col + k;
+            if (is_diagonal_rank && pivot_col == torus_col) {
+                for (uint j = 0; j < block_size; j++) {
+                    std::swap(panel[matrix_width * j + local_k], panel[matrix_width * j + local_pivot]);
+                }
+            }
+            else if (is_diagonal_rank || pivot_col == torus_col) {
+                size_t local_i = is_diagonal_rank ? local_k : local_pivot;
+                for (uint j = 0; j < block_size; j++) {
+                    column[j] = panel[matrix_width * j + local_i];
+                }
+                // The rank in the row communicator is the column of the rank in the torus
+                int partner = is_diagonal_rank ? pivot_col : diagonal_col;
+                MPI_Sendrecv_replace(column.data(), block_size, MPI_DATA_TYPE, partner, 0, partner, 0, row_communicator, MPI_STATUS_IGNORE);
+                for (uint j = 0; j < block_size; j++) {
+                    panel[matrix_width * j + local_i] = column[j];
+                }
             }
         }
 
-        for (int i = k; i < n; i++) {
-            HOST_DATA_TYPE tmp_val = a[i * lda + k];
-            a[i * lda + k] = a[i * lda + pvt_index];
-            a[i * lda + pvt_index] = tmp_val;
+        // Distribute the pivot and the upper part of its column within the torus row
+        if (is_diagonal_rank) {
+            for (uint j = k; j < block_size; j++) {
+                column[j - k] = panel[matrix_width * j + first_local_col + k];
+            }
         }
-        ipvt[k] = pvt_index;
+        MPI_Bcast(column.data(), block_size - k, MPI_DATA_TYPE, diagonal_col, row_communicator);
 
-        // For each element below it
-        for (int i = k + 1; i < n; i++) {
-            a[k * lda + i] *= -1.0 / a[k * lda + k];
+        // Store negative inverse of diagonal elements like the kernels do
+        HOST_DATA_TYPE scale = -1.0 / column[0];
+        if (is_diagonal_rank) {
+            panel[matrix_width * k + begin] = scale;
+            begin++;
         }
-        // For each column right of current diagonal element
-        for (int j = k + 1; j < n; j++) {
-            // For each element below it
-            for (int i = k+1; i < n; i++) {
-                a[j * lda + i] += a[k * lda + i] * a[j * lda + k];
+        for (size_t i = begin; i < matrix_width; i++) {
+            panel[matrix_width * k + i] *= scale;
+        }
+        // For each remaining row of the panel
+        for (uint j = k + 1; j < block_size; j++) {
+            for (size_t i = begin; i < matrix_width; i++) {
+                panel[matrix_width * j + i] += panel[matrix_width * k + i] * column[j - k];
+            }
+        }
+    }
+}
+
+void
+linpack::exchange_pivot_columns(HOST_DATA_TYPE* values, size_t num_rows, std::vector<cl_int> const& columns,
+                                const cl_int* ipvt, unsigned block_size, unsigned block_row, MPI_Comm row_communicator) {
+    // Every column is only owned by a single rank, so the sum contains the values of all columns
+    MPI_Allreduce(MPI_IN_PLACE, values, columns.size() * num_rows, MPI_DATA_TYPE, MPI_SUM, row_communicator);
+    auto position = [&](cl_int column) -> size_t {
+        return std::lower_bound(columns.begin(), columns.end(), column) - columns.begin();
+    };
+    // Apply the exchanges in the order of the panel factorization to the indices of the columns
+    std::vector<size_t> source(columns.size());
+    for (size_t s = 0; s < columns.size(); s++) {
+        source[s] = s;
+    }
+    for (uint k = 0; k < block_size; k++) {
+        std::swap(source[position(block_row * block_size + k)], source[position(ipvt[k])]);
+    }
+    std::vector<HOST_DATA_TYPE> exchanged(columns.size() * num_rows);
+    for (size_t s = 0; s < columns.size(); s++) {
+        std::copy(values + source[s] * num_rows, values + (source[s] + 1) * num_rows, exchanged.begin() + s * num_rows);
+    }
+    std::copy(exchanged.begin(), exchanged.end(), values);
+}
+
+void
+linpack::distributed_exchange_pivot_rows(cl::CommandQueue& queue, cl::Buffer& buffer, unsigned matrix_width, unsigned first_row,
+                                        unsigned num_rows, const cl_int* ipvt, unsigned block_size, unsigned block_row,
+                                        unsigned torus_width, unsigned torus_col, MPI_Comm row_communicator) {
+    if (num_rows == 0) {
+        return;
+    }
+    auto columns = pivot_columns(ipvt, block_size, block_row);
+    std::vector<HOST_DATA_TYPE> values(columns.size() * num_rows, 0.0);
+#ifndef USE_DEPRECATED_HPP_HEADER
+    cl::array<size_t,3> buffer_offset;
+    cl::array<size_t,3> host_offset;
+    cl::array<size_t,3> region;
+#else
+    cl::size_t<3> buffer_offset;
+    cl::size_t<3> host_offset;
+    cl::size_t<3> region;
+#endif
+    buffer_offset[1] = first_row;
+    buffer_offset[2] = 0;
+    host_offset[0] = 0;
+    host_offset[1] = 0;
+    host_offset[2] = 0;
+    // A single value of every row
+    region[0] = sizeof(HOST_DATA_TYPE);
+    region[1] = num_rows;
+    region[2] = 1;
+    std::vector<bool> is_local(columns.size());
+    for (size_t s = 0; s < columns.size(); s++) {
+        is_local[s] = (columns[s] / block_size) % torus_width == torus_col;
+        if (is_local[s]) {
+            buffer_offset[0] = (((columns[s] / block_size) / torus_width) * block_size + columns[s] % block_size) * sizeof(HOST_DATA_TYPE);
+            cl_int err = queue.enqueueReadBufferRect(buffer, CL_FALSE, buffer_offset, host_offset, region,
+                                                    matrix_width * sizeof(HOST_DATA_TYPE), 0, sizeof(HOST_DATA_TYPE), 0,
+                                                    values.data() + s * num_rows);
+            ASSERT_CL(err)
+        }
+    }
+    queue.finish();
+    exchange_pivot_columns(values.data(), num_rows, columns, ipvt, block_size, block_row, row_communicator);
+    for (size_t s = 0; s < columns.size(); s++) {
+        if (is_local[s]) {
+            buffer_offset[0] = (((columns[s] / block_size) / torus_width) * block_size + columns[s] % block_size) * sizeof(HOST_DATA_TYPE);
+            cl_int err = queue.enqueueWriteBufferRect(buffer, CL_FALSE, buffer_offset, host_offset, region,
+                                                    matrix_width * sizeof(HOST_DATA_TYPE), 0, sizeof(HOST_DATA_TYPE), 0,
+                                                    values.data() + s * num_rows);
+            ASSERT_CL(err)
+        }
+    }
+    queue.finish();
+}
+
+std::vector<cl_int>
+linpack::pivot_columns(const cl_int* ipvt, unsigned block_size, unsigned block_row) {
+    std::vector<cl_int> columns;
+    for (uint k = 0; k < block_size; k++) {
+        columns.push_back(block_row * block_size + k);
+        columns.push_back(ipvt[k]);
+    }
+    std::sort(columns.begin(), columns.end());
+    columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+    return columns;
+}
+
+void
+linpack::gemm_update_ref(HOST_DATA_TYPE* l, HOST_DATA_TYPE* u, HOST_DATA_TYPE* c, int m, int n, int k, int lda) {
+    if (m <= 0 || n <= 0 || k <= 0) {
+        return;
+    }
+#ifdef _USE_BLAS_
+    char trans = 'N';
+    HOST_DATA_TYPE one = 1.0;
+#ifdef _DP
+    dgemm_(&trans, &trans, &m, &n, &k, &one, l, &lda, u, &lda, &one, c, &lda);
+#else
+    sgemm_(&trans, &trans, &m, &n, &k, &one, l, &lda, u, &lda, &one, c, &lda);
+#endif
+#else
+    #pragma omp parallel for
+    for (int j = 0; j < n; j++) {
+        for (int kk = 0; kk < k; kk++) {
+            HOST_DATA_TYPE scale = u[j * lda + kk];
+            for (int i = 0; i < m; i++) {
+                c[j * lda + i] += l[kk * lda + i] * scale;
             }
         }
+    }
+#endif
+}
 
-#ifdef DEBUG
-        std::cout << "A(k=" << k <<"): " << std::endl;
-                for (int i= 0; i < n; i++) {
-                    for (int j=0; j < n; j++) {
-                        std::cout << a[i*lda + j] << ", ";
+void
+linpack::gefa_ref_blocked(HOST_DATA_TYPE* a, unsigned n, unsigned lda, cl_int* ipvt) {
+    for (int kb = 0; kb < n; kb += GEFA_REF_BLOCK_SIZE) {
+        int kend = std::min(kb + GEFA_REF_BLOCK_SIZE, static_cast<int>(n));
+
+        // Factorize the panel. Rows are exchanged over the whole panel width,
+        // so the multipliers can directly be used for the update of the trailing matrix
+        for (int k = kb; k < kend; k++) {
+            if (ipvt != nullptr) {
+                HOST_DATA_TYPE max_val = fabs(a[k * lda + k]);
+                int pvt_index = k;
+                for (int i = k + 1; i < n; i++) {
+                    if (max_val < fabs(a[k * lda + i])) {
+                        pvt_index = i;
+                        max_val = fabs(a[k * lda + i]);
                     }
-                    std::cout << std::endl;
                 }
-                std::cout <<  std::endl;
-#endif
+                ipvt[k] = pvt_index;
+                if (pvt_index != k) {
+                    for (int j = kb; j < kend; j++) {
+                        HOST_DATA_TYPE tmp_val = a[j * lda + k];
+                        a[j * lda + k] = a[j * lda + pvt_index];
+                        a[j * lda + pvt_index] = tmp_val;
+                    }
+                }
+            }
+            // Store negative inverse of diagonal elements to get rid of some divisions afterwards if no pivoting is used
+            HOST_DATA_TYPE scale = -1.0 / a[k * lda + k];
+            if (ipvt == nullptr) {
+                a[k * lda + k] = scale;
+            }
+            // For each element below it
+            for (int i = k + 1; i < n; i++) {
+                a[k * lda + i] *= scale;
+            }
+            // For each remaining column of the panel
+            for (int j = k + 1; j < kend; j++) {
+                for (int i = k + 1; i < n; i++) {
+                    a[j * lda + i] += a[k * lda + i] * a[j * lda + k];
+                }
+            }
+        }
+
+        // Exchange the rows and solve the upper part of the trailing columns with the unit lower triangle of the panel
+        #pragma omp parallel for
+        for (int j = kend; j < n; j++) {
+            for (int k = kb; k < kend; k++) {
+                if (ipvt != nullptr && ipvt[k] != k) {
+                    HOST_DATA_TYPE tmp_val = a[j * lda + k];
+                    a[j * lda + k] = a[j * lda + ipvt[k]];
+                    a[j * lda + ipvt[k]] = tmp_val;
+                }
+            }
+            for (int k = kb; k < kend; k++) {
+                for (int i = k + 1; i < kend; i++) {
+                    a[j * lda + i] += a[k * lda + i] * a[j * lda + k];
+                }
+            }
+        }
 
+        // Update the trailing matrix
+        gemm_update_ref(&a[kb * lda + kend], &a[kend * lda + kb], &a[kend * lda + kend], n - kend, n - kend, kend - kb, lda);
+
+        // gesl_ref applies the pivots interleaved with the elimination steps.
+        // So the exchanges are reverted for the multipliers that were calculated before the exchange
+        if (ipvt != nullptr) {
+            for (int k = kend - 1; k >= kb; k--) {
+                if (ipvt[k] != k) {
+                    for (int j = kb; j < k; j++) {
+                        HOST_DATA_TYPE tmp_val = a[j * lda + k];
+                        a[j * lda + k] = a[j * lda + ipvt[k]];
+                        a[j * lda + ipvt[k]] = tmp_val;
+                    }
+                }
+            }
+        }
     }
 }
 
+void
+linpack::gefa_ref(HOST_DATA_TYPE* a, unsigned n, unsigned lda, cl_int* ipvt) {
+    gefa_ref_blocked(a, n, lda, ipvt);
+}
+
 void
 linpack::gesl_ref(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, cl_int* ipvt, unsigned n, unsigned lda) {
     auto b_tmp = new HOST_DATA_TYPE[n];
@@ -649,39 +1388,17 @@ void linpack::dmxpy(unsigned n1, HOST_DATA_TYPE* y, unsigned n2, unsigned ldm, H
 
 void
 linpack::gefa_ref_nopvt(HOST_DATA_TYPE* a, unsigned n, unsigned lda) {
-    // For each diagnonal element
-    for (int k = 0; k < n; k++) {
-        // Store negatie invers of diagonal elements to get rid of some divisions afterwards!
-        a[k * lda + k] = -1.0 / a[k * lda + k];
-        // For each element below it
-        for (int i = k + 1; i < n; i++) {
-            a[k * lda + i] *= a[k * lda + k];
-        }
-        // For each column right of current diagonal element
-        for (int j = k + 1; j < n; j++) {
-            // For each element below it
-            for (int i = k+1; i < n; i++) {
-                a[j * lda + i] += a[k * lda + i] * a[j * lda + k];
-            }
-        }
-
-#ifdef DEBUG
-        std::cout << "A(k=" << k << "): " << std::endl;
-                for (int i= 0; i < n; i++) {
-                    for (int j=0; j < n; j++) {
-                        std::cout << a[i*lda + j] << ", ";
-                    }
-                    std::cout << std::endl;
-                }
-                std::cout <<  std::endl;
-#endif
-
-    }
+    gefa_ref_blocked(a, n, lda, nullptr);
 }
 
 
 void
 linpack::gesl_ref_nopvt(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, unsigned n, unsigned lda) {
+    gesl_ref_inverted_diagonal(a, b, nullptr, n, lda);
+}
+
+void
+linpack::gesl_ref_inverted_diagonal(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, const cl_int* ipvt, unsigned n, unsigned lda) {
     auto b_tmp = new HOST_DATA_TYPE[n];
 
     for (int k = 0; k < n; k++) {
@@ -691,6 +1408,11 @@ linpack::gesl_ref_nopvt(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, unsigned n, unsign
     // solve l*y = b
     // For each row in matrix
     for (int k = 0; k < n - 1; k++) {
+        if (ipvt != nullptr && ipvt[k] != k) {
+            HOST_DATA_TYPE tmp = b_tmp[k];
+            b_tmp[k] = b_tmp[ipvt[k]];
+            b_tmp[ipvt[k]] = tmp;
+        }
         // For each row below add
         for (int i = k + 1; i < n; i++) {
             // add solved upper row to current row
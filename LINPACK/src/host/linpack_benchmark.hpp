@@ -26,6 +26,7 @@ SOFTWARE.
 /* C++ standard library headers */
 #include <complex>
 #include <memory>
+#include <vector>
 
 /* Project's headers */
 #include "hpcc_benchmark.hpp"
@@ -34,6 +35,18 @@ extern "C" {
     #include "gmres.h"
 }
 
+#ifdef _USE_BLAS_
+
+extern "C" void sgemm_(char*, char*, int*, int*,int*, float*, float*, int*, float*, int*, float*, float*, int*);
+extern "C" void dgemm_(char*, char*, int*, int*,int*, double*, double*, int*, double*, int*, double*, double*, int*);
+#endif
+
+/**
+ * @brief Width of the panels used by the blocked host reference LU factorization
+ * 
+ */
+#define GEFA_REF_BLOCK_SIZE 64
+
 /**
  * @brief Contains all classes and methods needed by the LINPACK benchmark
  * 
@@ -72,6 +85,20 @@ public:
      */
     bool isEmulationKernel;
 
+    /**
+     * @brief Number of block rows the communication of the next LU, left and top blocks may overlap with the
+     *          inner block updates of the previous block row. Only 0 and 1 are supported by the PCIe execution.
+     * 
+     */
+    uint lookahead;
+
+    /**
+     * @brief True, if the solution of the low precision factorization calculated by the kernel should be
+     *          refined to double precision with GMRES on the host (HPL-MxP)
+     * 
+     */
+    bool isMixedPrecision;
+
     /**
      * @brief The row position of this MPI rank in the torus
      * 
@@ -168,6 +195,12 @@ public:
      */
     HOST_DATA_TYPE normb;
 
+    /**
+     * @brief The solution in double precision after the mixed precision refinement. Only set on rank 0.
+     * 
+     */
+    std::vector<double> refined_x;
+
     /**
      * @brief Construct a new Linpack Data object
      * 
@@ -203,6 +236,26 @@ public:
      */
     std::vector<double> geslTimings;
 
+    /**
+     * @brief A vector containing the time spent waiting for MPI communication during the gefa execution for all repetitions.
+     *          May be empty, if the communication time is not measured by the execution type.
+     * 
+     */
+    std::vector<double> communicationTimings;
+
+    /**
+     * @brief A vector containing the part of the communication time that could not be overlapped with inner block updates
+     *          for all repetitions. May be empty, if the communication time is not measured by the execution type.
+     * 
+     */
+    std::vector<double> exposedCommunicationTimings;
+
+    /**
+     * @brief A vector containing the time of the GMRES refinement of the solution in mixed precision mode.
+     *          Empty, if the mixed precision mode is not used.
+     * 
+     */
+    std::vector<double> refinementTimings;
 
 };
 
@@ -214,6 +267,18 @@ class LinpackBenchmark : public hpcc_base::HpccFpgaBenchmark<LinpackProgramSetti
 
 protected:
 
+    /**
+     * @brief Communicator containing all ranks in the same torus row. Created with the first input data generation.
+     * 
+     */
+    MPI_Comm row_communicator = MPI_COMM_NULL;
+
+    /**
+     * @brief Communicator containing all ranks in the same torus column. Created with the first input data generation.
+     * 
+     */
+    MPI_Comm col_communicator = MPI_COMM_NULL;
+
     /**
      * @brief Additional input parameters of the Linpack benchmark
      * 
@@ -223,12 +288,56 @@ protected:
     addAdditionalParseOptions(cxxopts::Options &options) override;
 
     /**
-     * @brief Distributed solving of l*y=b and u*x = y 
+     * @brief Distributed solving of l*y=b and u*x = y. The pivots of the panel factorizations are applied if the matrix is not diagonally dominant.
+     *          The system is solved block by block with one broadcast of the solved diagonal block and two broadcasts of the updates per block,
+     *          where the broadcast of the updates that are not needed for the next block overlaps with its solution.
      * 
      * @param data The local data. b will contain the solution for the unknows that were handeled by this rank
      */
     void 
-    distributed_gesl_nopvt_ref(linpack::LinpackData& data);
+    distributed_gesl_ref(linpack::LinpackData& data);
+
+    /**
+     * @brief Distributed calculation of the residual ||Ax - b|| / (||A|| * ||x|| * n * eps) using the infinity norm.
+     *          A and b are regenerated from the counter-based generator, so the matrix does not need to be gathered.
+     *
+     * @param data The local data. b has to contain the solution for the unknowns handled by this rank
+     * @param resid Will contain ||Ax - b||. Same on all ranks.
+     * @return double The normalized residual. Same on all ranks.
+     */
+    double
+    distributed_residual(linpack::LinpackData& data, double& resid);
+
+    /**
+     * @brief Collect the pivot indices of all diagonal blocks from the ranks that calculated them
+     * 
+     * @param data The local data containing the global pivot indices of its block rows
+     * @return std::vector<cl_int> The global pivot index for every row of the matrix. Same on all ranks.
+     */
+    std::vector<cl_int>
+    distributed_pivot_indices(linpack::LinpackData& data);
+
+    /**
+     * @brief Distributed Freivalds check of the LU decomposition without pivoting.
+     *          Calculates A * x and L * (U * x) for random vectors x with entries +-1 without gathering the matrix.
+     *          A is regenerated from the counter-based generator, so the check needs O(n^2) work instead of O(n^3).
+     *
+     * @param data The local data containing the LU decomposition calculated by the kernel
+     * @return double The maximum difference of both results, normalized by n * eps * (|L| * |U| * |x|). Same on all ranks.
+     */
+    double
+    freivalds_lu_residual(linpack::LinpackData& data);
+
+    /**
+     * @brief Gather a distributed matrix on rank 0 and convert it to double precision
+     * 
+     * @param local The local part of the matrix in the layout of the kernel
+     * @param data The local data used to get the local matrix size
+     * @return std::vector<double> The global matrix in column-major order, so value (row i, column j) is stored at
+     *              index j * n + i. Empty on all other ranks.
+     */
+    std::vector<double>
+    gather_matrix(const HOST_DATA_TYPE* local, const linpack::LinpackData& data);
 
 public:
 
@@ -259,6 +368,19 @@ public:
     bool
     validateOutputAndPrintError(LinpackData &data) override;
 
+    /**
+     * @brief Refine the solution of the low precision LU factorization to double precision using GMRES
+     *          preconditioned with the LU factors (HPL-MxP). The factors and the matrix are gathered on rank 0,
+     *          which solves the system with gmres_ref.
+     * 
+     * @param data The local data containing the LU factorization calculated without pivoting.
+     *          refined_x will contain the solution on rank 0.
+     * @return double The time of the GMRES iterations on rank 0 in seconds. The generation and gathering of the matrix
+     *          are not included. 0 on all other ranks.
+     */
+    double
+    mixed_precision_refinement(LinpackData &data);
+
     /**
      * @brief Linpack specific implementation of printing the execution results
      * 
@@ -267,6 +389,16 @@ public:
     void
     collectAndPrintResults(const LinpackExecutionTimings &output) override;
 
+    /**
+     * @brief Select the largest matrix size that fits into the device memory.
+     *          The matrix width in blocks is a multiple of P and Q, so all ranks get the same number of blocks.
+     * 
+     * @param limits The memory limits of the device
+     * @return true if a valid matrix size was found, false otherwise
+     */
+    bool
+    setAutomaticSize(hpcc_base::MemoryLimits const& limits) override;
+
     /**
      * @brief Construct a new Linpack Benchmark object
      * 
@@ -280,6 +412,12 @@ public:
      */
     LinpackBenchmark();
 
+    /**
+     * @brief Destroy the Linpack Benchmark object and free the torus communicators
+     * 
+     */
+    ~LinpackBenchmark();
+
 };
 
 /**
@@ -294,6 +432,131 @@ public:
  */
 void dmxpy(unsigned n1, HOST_DATA_TYPE* y, unsigned n2, unsigned ldm, HOST_DATA_TYPE* x, HOST_DATA_TYPE* m, bool transposed);
 
+/**
+Number of blocks a rank gets in one dimension of the block-cyclic distribution
+
+@param num_blocks number of blocks of the global matrix in the dimension
+@param grid_size number of ranks in the dimension
+@param grid_index position of the rank in the dimension
+
+@return the number of local blocks. Differs by at most one between the ranks.
+*/
+uint local_block_count(uint num_blocks, uint grid_size, uint grid_index);
+
+/**
+Select the width P of the PQ grid with the lowest predicted execution time.
+All factorizations of the number of ranks are considered, so no rank stays idle.
+For every grid, the time of an iteration of the rank with the most blocks is predicted by the number of inner
+block updates plus the number of blocks it has to receive, assuming that the transfer of a block
+takes about as long as the update of an inner block. This favors grids with a low communication to computation ratio
+and few remainder blocks.
+
+@param num_ranks the number of MPI ranks
+@param num_blocks number of blocks of the global matrix in one dimension
+
+@return the width P of the grid. The height is num_ranks / P.
+*/
+uint best_torus_width(uint num_ranks, uint num_blocks);
+
+/**
+Factorize the panel of a block row with partial pivoting over the whole column.
+The panel is distributed over all ranks of a torus row. For every row, the pivot is searched with a
+MAXLOC reduction over the torus row and the rows are exchanged over the whole panel width.
+The diagonal of the factorization contains the negative inverse of the pivots like in the kernels.
+
+@param panel the local part of the panel with size block_size*matrix_width
+@param matrix_width width of the local matrix in values
+@param block_size size of the blocks
+@param block_row global index of the block row of the panel
+@param torus_width width of the torus in number of ranks
+@param torus_col column position of the rank in the torus
+@param row_communicator communicator containing the ranks of the torus row
+@param ipvt array of size block_size that will contain the global pivot indices. Same on all ranks of the torus row.
+
+*/
+void distributed_gefa_panel(HOST_DATA_TYPE* panel, unsigned matrix_width, unsigned block_size, unsigned block_row,
+                            unsigned torus_width, unsigned torus_col, MPI_Comm row_communicator, cl_int* ipvt);
+
+/**
+Global indices of the columns that are exchanged by the pivots of a block row
+
+@param ipvt the global pivot indices of the block row
+@param block_size size of the blocks
+@param block_row global index of the block row
+
+@return the sorted indices of the columns
+*/
+std::vector<cl_int> pivot_columns(const cl_int* ipvt, unsigned block_size, unsigned block_row);
+
+/**
+Exchange columns of the local matrix between the ranks of a torus row with the pivots of a block row.
+The columns are exchanged in the same order as in the panel factorization.
+
+@param values the values of the columns with size columns.size()*num_rows. The values of a column are stored consecutively.
+            Only the columns owned by the rank are filled and all others have to be 0.
+            Will contain the exchanged values of all columns.
+@param num_rows number of values of a single column
+@param columns the global indices of the columns as returned by pivot_columns
+@param ipvt the global pivot indices of the block row
+@param block_size size of the blocks
+@param block_row global index of the block row
+@param row_communicator communicator containing the ranks of the torus row
+
+*/
+void exchange_pivot_columns(HOST_DATA_TYPE* values, size_t num_rows, std::vector<cl_int> const& columns,
+                            const cl_int* ipvt, unsigned block_size, unsigned block_row, MPI_Comm row_communicator);
+
+/**
+Exchange the rows of the trailing matrix in the device memory with the pivots of a block row.
+Since the matrix is stored transposed, the rows are columns of the local matrix. Only the exchanged columns
+are read from the device, exchanged with exchange_pivot_columns and written back.
+All operations on the buffer have to be finished before.
+
+@param queue the command queue used for the transfers
+@param buffer the buffer containing the local matrix
+@param matrix_width width of the local matrix in values
+@param first_row first local row of the trailing matrix
+@param num_rows number of local rows of the trailing matrix
+@param ipvt the global pivot indices of the block row
+@param block_size size of the blocks
+@param block_row global index of the block row
+@param torus_width width of the torus in number of ranks
+@param torus_col column position of the rank in the torus
+@param row_communicator communicator containing the ranks of the torus row
+
+*/
+void distributed_exchange_pivot_rows(cl::CommandQueue& queue, cl::Buffer& buffer, unsigned matrix_width, unsigned first_row,
+                                    unsigned num_rows, const cl_int* ipvt, unsigned block_size, unsigned block_row,
+                                    unsigned torus_width, unsigned torus_col, MPI_Comm row_communicator);
+
+/**
+Update of the trailing matrix in the blocked LU factorization: c = c + l * u.
+All matrices are stored column major with the same leading dimension.
+Uses BLAS if available.
+
+@param l the multipliers of the panel with size m*k
+@param u the upper part of the trailing columns with size k*n
+@param c the trailing matrix with size m*n
+@param m number of rows of c
+@param n number of columns of c
+@param k width of the panel
+@param lda row with of the matrices
+
+*/
+void gemm_update_ref(HOST_DATA_TYPE* l, HOST_DATA_TYPE* u, HOST_DATA_TYPE* c, int m, int n, int k, int lda);
+
+/**
+Blocked right-looking LU factorization with panels of width GEFA_REF_BLOCK_SIZE.
+The result is the same as the one of gefa_ref if ipvt is given and the one of gefa_ref_nopvt otherwise.
+
+@param a the matrix with size of n*n
+@param n size of matrix A
+@param lda row with of the matrix. must be >=n
+@param ipvt array of pivoting indices or nullptr to calculate the LU factorization without pivoting
+
+*/
+void gefa_ref_blocked(HOST_DATA_TYPE* a, unsigned n, unsigned lda, cl_int* ipvt);
+
 /**
 Gaussian elemination reference implementation with partial pivoting.
 Can be used in exchange with kernel functions for functionality testing
@@ -344,6 +607,21 @@ where A is a matrix of size n*n
 */
 void gesl_ref_nopvt(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, unsigned n, unsigned lda);
 
+/**
+Solve linear equations using its LU decomposition with the negative inverse on the diagonal
+like it is calculated by gefa_ref_nopvt and the kernels.
+Therefore solves A*x = b by solving L*y = b and then U*x = y with PA = LU
+where A is a matrix of size n*n
+
+@param a the matrix a in LU representation
+@param b vector b of the given equation
+@param ipvt vector containing pivoting information or nullptr, if no pivoting was used
+@param n size of matrix A
+@param lda row with of the matrix. must be >=n
+
+*/
+void gesl_ref_inverted_diagonal(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, const cl_int* ipvt, unsigned n, unsigned lda);
+
 } // namespace stream
 
 
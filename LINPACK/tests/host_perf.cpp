@@ -0,0 +1,72 @@
+//
+// Micro-benchmarks for the host code of the LINPACK benchmark
+//
+#include <algorithm>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "host_perf_fixture.hpp"
+#include "linpack_benchmark.hpp"
+#include "parameters.h"
+
+/**
+ * The range gives the matrix size in number of blocks. The generated matrix needs pivoting.
+ */
+class LinpackHostPerf : public hpcc_base::HostPerfFixture<linpack::LinpackBenchmark> {
+protected:
+    void
+    setDataSize(benchmark::State& state) override {
+        auto& settings = *getBenchmark().getExecutionSettings().programSettings;
+        settings.matrixSize = state.range(0) * settings.blockSize;
+        settings.isDiagonallyDominant = false;
+    }
+
+    size_t
+    getInputDataBytes(benchmark::State& state) override {
+        size_t n = getBenchmark().getExecutionSettings().programSettings->matrixSize;
+        return n * n * sizeof(HOST_DATA_TYPE);
+    }
+};
+
+BENCHMARK_DEFINE_F(LinpackHostPerf, GenerateInputData)(benchmark::State& state) {
+    measureInputDataGeneration(state);
+}
+BENCHMARK_REGISTER_F(LinpackHostPerf, GenerateInputData)->RangeMultiplier(2)->Range(1, 16)->Unit(benchmark::kMillisecond);
+
+/**
+ * LU factorization with partial pivoting that is used as reference implementation.
+ * The factorized matrix is replaced by the input matrix outside of the measurement.
+ */
+BENCHMARK_DEFINE_F(LinpackHostPerf, GefaRef)(benchmark::State& state) {
+    auto data = generateData(state);
+    unsigned n = getBenchmark().getExecutionSettings().programSettings->matrixSize;
+    std::vector<HOST_DATA_TYPE> input(data->A, data->A + n * n);
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::copy(input.begin(), input.end(), data->A);
+        state.ResumeTiming();
+        linpack::gefa_ref(data->A, n, n, data->ipvt);
+        benchmark::ClobberMemory();
+    }
+    state.counters["FLOPS"] = benchmark::Counter(2.0 / 3.0 * n * n * n * state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK_REGISTER_F(LinpackHostPerf, GefaRef)->RangeMultiplier(2)->Range(1, 8)->Unit(benchmark::kMillisecond);
+
+/**
+ * Solution of the factorized system that is used as reference implementation
+ */
+BENCHMARK_DEFINE_F(LinpackHostPerf, GeslRef)(benchmark::State& state) {
+    auto data = generateData(state);
+    unsigned n = getBenchmark().getExecutionSettings().programSettings->matrixSize;
+    linpack::gefa_ref(data->A, n, n, data->ipvt);
+    std::vector<HOST_DATA_TYPE> b(data->b, data->b + n);
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::copy(b.begin(), b.end(), data->b);
+        state.ResumeTiming();
+        linpack::gesl_ref(data->A, data->b, data->ipvt, n, n);
+        benchmark::ClobberMemory();
+    }
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * n * n * state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK_REGISTER_F(LinpackHostPerf, GeslRef)->RangeMultiplier(2)->Range(1, 8)->Unit(benchmark::kMicrosecond);
@@ -5,6 +5,9 @@
 #include "test_program_settings.h"
 #include "linpack_benchmark.hpp"
 
+#include <utility>
+#include <vector>
+
 
 struct LinpackHostTest : testing::Test {
     
@@ -76,6 +79,17 @@ TEST_F(LinpackHostTest, ReferenceSolveGMRES) {
     }
     EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
 }
+
+TEST_F(LinpackHostTest, MixedPrecisionRefinementReachesDoublePrecision) {
+    bm->getExecutionSettings().programSettings->isMixedPrecision = true;
+    linpack::gefa_ref_nopvt(data->A, array_size, array_size);
+    bm->mixed_precision_refinement(*data);
+    ASSERT_EQ(data->refined_x.size(), array_size);
+    for (int i=0; i < array_size; i++) {
+        EXPECT_NEAR(data->refined_x[i], 1.0, 1.0e-12);
+    }
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
 #endif
 
 TEST_F(LinpackHostTest, ReferenceSolveWithPivoting) {
@@ -86,6 +100,18 @@ TEST_F(LinpackHostTest, ReferenceSolveWithPivoting) {
     EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
 }
 
+TEST_F(LinpackHostTest, ReferenceSolveInvertedDiagonalWithPivoting) {
+    bm->getExecutionSettings().programSettings->isDiagonallyDominant = false;
+    data = bm->generateInputData();
+    linpack::gefa_ref(data->A, array_size, array_size, data->ipvt);
+    // Store the negative inverse on the diagonal like the kernels do
+    for (int k = 0; k < array_size; k++) {
+        data->A[k * array_size + k] = -1.0 / data->A[k * array_size + k];
+    }
+    linpack::gesl_ref_inverted_diagonal(data->A, data->b, data->ipvt, array_size, array_size);
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
 
 TEST_F(LinpackHostTest, ReferenceSolveWithoutPivoting) {
     data = bm->generateInputData();
@@ -94,4 +120,107 @@ TEST_F(LinpackHostTest, ReferenceSolveWithoutPivoting) {
     EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
 }
 
+TEST_F(LinpackHostTest, ReferenceSolveWithPivotingMultiplePanels) {
+    // Use a matrix that is not a multiple of the panel width of the blocked factorization
+    bm->getExecutionSettings().programSettings->matrixSize = 5 * bm->getExecutionSettings().programSettings->blockSize;
+    bm->getExecutionSettings().programSettings->isDiagonallyDominant = false;
+    array_size = bm->getExecutionSettings().programSettings->matrixSize;
+    data = bm->generateInputData();
+    linpack::gefa_ref(data->A, array_size, array_size, data->ipvt);
+    linpack::gesl_ref(data->A, data->b, data->ipvt, array_size, array_size);
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
 
+TEST_F(LinpackHostTest, ReferencePanelFactorizationSameAsPartialPivoting) {
+    bm->getExecutionSettings().programSettings->matrixSize = 4 * bm->getExecutionSettings().programSettings->blockSize;
+    bm->getExecutionSettings().programSettings->isDiagonallyDominant = false;
+    array_size = bm->getExecutionSettings().programSettings->matrixSize;
+    int block_size = bm->getExecutionSettings().programSettings->blockSize;
+    data = bm->generateInputData();
+    auto ref_A = std::vector<HOST_DATA_TYPE>(data->A, data->A + array_size * array_size);
+    auto ref_ipvt = std::vector<cl_int>(array_size);
+    linpack::gefa_ref(ref_A.data(), array_size, array_size, ref_ipvt.data());
+    // The first block row is the panel of the whole first block column on a single rank
+    linpack::distributed_gefa_panel(data->A, array_size, block_size, 0, 1, 0, MPI_COMM_SELF, data->ipvt);
+    int pivots_outside_block = 0;
+    for (int k = 0; k < block_size; k++) {
+        EXPECT_EQ(data->ipvt[k], ref_ipvt[k]);
+        pivots_outside_block += (data->ipvt[k] >= block_size) ? 1 : 0;
+    }
+    // The uniform matrix needs pivots from the whole column
+    EXPECT_GT(pivots_outside_block, 0);
+    // The panel exchanges the rows also for the multipliers that were calculated before the exchange.
+    // The diagonal contains the negative inverse of the pivots.
+    for (int k = 0; k < block_size; k++) {
+        for (int j = 0; j < k; j++) {
+            std::swap(ref_A[j * array_size + k], ref_A[j * array_size + ref_ipvt[k]]);
+        }
+    }
+    for (int j = 0; j < block_size; j++) {
+        for (int i = 0; i < array_size; i++) {
+            HOST_DATA_TYPE expected = (i == j) ? -1.0 / ref_A[j * array_size + i] : ref_A[j * array_size + i];
+            EXPECT_NEAR(data->A[j * array_size + i], expected, 1.0e-4);
+        }
+    }
+}
+
+TEST_F(LinpackHostTest, ReferenceSolveWithPanelFactorization) {
+    bm->getExecutionSettings().programSettings->isDiagonallyDominant = false;
+    data = bm->generateInputData();
+    linpack::distributed_gefa_panel(data->A, array_size, array_size, 0, 1, 0, MPI_COMM_SELF, data->ipvt);
+    // The rows are exchanged over the whole panel, so all exchanges are applied to b before the solve
+    for (int k = 0; k < array_size; k++) {
+        std::swap(data->b[k], data->b[data->ipvt[k]]);
+    }
+    linpack::gesl_ref_nopvt(data->A, data->b, array_size, array_size);
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+TEST(LinpackPivotTest, ExchangePivotColumnsInOrderOfPanel) {
+    std::vector<cl_int> ipvt = {2, 5, 2, 3};
+    auto columns = linpack::pivot_columns(ipvt.data(), 4, 0);
+    EXPECT_EQ(columns, std::vector<cl_int>({0, 1, 2, 3, 5}));
+    // Two values for every column, both containing the index of the column
+    std::vector<HOST_DATA_TYPE> values;
+    for (auto c : columns) {
+        values.push_back(c);
+        values.push_back(c);
+    }
+    linpack::exchange_pivot_columns(values.data(), 2, columns, ipvt.data(), 4, 0, MPI_COMM_SELF);
+    std::vector<HOST_DATA_TYPE> expected = {2, 2, 5, 5, 0, 0, 3, 3, 1, 1};
+    EXPECT_EQ(values, expected);
+}
+
+TEST_F(LinpackHostTest, ReferenceSolveWithoutPivotingMultiplePanels) {
+    // Use a matrix that is not a multiple of the panel width of the blocked factorization
+    bm->getExecutionSettings().programSettings->matrixSize = 5 * bm->getExecutionSettings().programSettings->blockSize;
+    array_size = bm->getExecutionSettings().programSettings->matrixSize;
+    data = bm->generateInputData();
+    linpack::gefa_ref_nopvt(data->A, array_size, array_size);
+    linpack::gesl_ref_nopvt(data->A, data->b, array_size, array_size);
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+
+
+TEST(LinpackGridTest, LocalBlockCountDistributesRemainderBlocks) {
+    EXPECT_EQ(linpack::local_block_count(8, 4, 0), 2);
+    EXPECT_EQ(linpack::local_block_count(8, 4, 3), 2);
+    EXPECT_EQ(linpack::local_block_count(10, 4, 1), 3);
+    EXPECT_EQ(linpack::local_block_count(10, 4, 2), 2);
+    uint total = 0;
+    for (uint i = 0; i < 3; i++) {
+        total += linpack::local_block_count(11, 3, i);
+    }
+    EXPECT_EQ(total, 11);
+}
+
+TEST(LinpackGridTest, BestTorusWidthUsesAllRanks) {
+    EXPECT_EQ(linpack::best_torus_width(4, 8), 2);
+    EXPECT_EQ(linpack::best_torus_width(6, 12), 2);
+    EXPECT_EQ(linpack::best_torus_width(16, 64), 4);
+    // Prime number of ranks can only be used as a single row or column
+    EXPECT_EQ(7 % linpack::best_torus_width(7, 21), 0);
+    // The grid must not be larger than the matrix
+    EXPECT_EQ(linpack::best_torus_width(8, 4), 2);
+}
@@ -77,15 +77,16 @@ public:
 
 class LinpackKernelCommunicationTestLU : public LinpackKernelCommunicationTest {
 
+protected:
     void SetUp() override {
         LinpackKernelCommunicationTest::SetUp();
         if (bm->getExecutionSettings().programSettings->communicationType != hpcc_base::CommunicationType::intel_external_channels) {
             GTEST_SKIP() << "This test is IEC Specific but other kernel is used";
         }
-        executeKernel();
+        executeKernel(CL_FALSE);
     }
 
-    void executeKernel() {
+    void executeKernel(cl_uint is_factorized) {
         int err;
         cl::CommandQueue compute_queue(*bm->getExecutionSettings().context, *bm->getExecutionSettings().device, 0, &err);
         cl::CommandQueue network_queue(*bm->getExecutionSettings().context, *bm->getExecutionSettings().device, 0, &err);
@@ -96,9 +97,10 @@ class LinpackKernelCommunicationTestLU : public LinpackKernelCommunicationTest {
         cl::Kernel kernel(*bm->getExecutionSettings().program, "lu", &err);
 
         err = kernel.setArg(0, buffer);
-        err = kernel.setArg(1, 0);
+        err = kernel.setArg(1, is_factorized);
         err = kernel.setArg(2, 0);
-        err = kernel.setArg(3, 1);
+        err = kernel.setArg(3, 0);
+        err = kernel.setArg(4, 1);
 
         // Start network layer kernel
         cl::Kernel network(*bm->getExecutionSettings().program, "network_layer_bottomright", &err);
@@ -115,6 +117,19 @@ class LinpackKernelCommunicationTestLU : public LinpackKernelCommunicationTest {
     }
 };
 
+class LinpackKernelCommunicationTestLUFactorized : public LinpackKernelCommunicationTestLU {
+
+    void SetUp() override {
+        LinpackKernelCommunicationTest::SetUp();
+        if (bm->getExecutionSettings().programSettings->communicationType != hpcc_base::CommunicationType::intel_external_channels) {
+            GTEST_SKIP() << "This test is IEC Specific but other kernel is used";
+        }
+        // The block is factorized on the host like it is done with partial pivoting
+        linpack::gefa_ref_nopvt(data->A, bm->getExecutionSettings().programSettings->matrixSize,bm->getExecutionSettings().programSettings->matrixSize);
+        executeKernel(CL_TRUE);
+    }
+};
+
 class LinpackKernelCommunicationTestTop : public LinpackKernelCommunicationTest {
 
 public: 
@@ -162,9 +177,10 @@ public:
         err = kernel.setArg(0, buffer);
         err = kernel.setArg(1, lu_buffer);
         err = kernel.setArg(2, CL_TRUE);
-        err = kernel.setArg(3, 0);
+        err = kernel.setArg(3, CL_FALSE);
         err = kernel.setArg(4, 0);
-        err = kernel.setArg(5, 1);
+        err = kernel.setArg(5, 0);
+        err = kernel.setArg(6, 1);
 
         // Start network layer kernel
         cl::Kernel network(*bm->getExecutionSettings().program, "network_layer_bottomright", &err);
@@ -229,9 +245,10 @@ class LinpackKernelCommunicationTestTopOut : public LinpackKernelCommunicationTe
         err = kernel.setArg(0, buffer);
         err = kernel.setArg(1, lu_buffer);
         err = kernel.setArg(2, CL_FALSE);
-        err = kernel.setArg(3, 0);
+        err = kernel.setArg(3, CL_FALSE);
         err = kernel.setArg(4, 0);
-        err = kernel.setArg(5, 1);
+        err = kernel.setArg(5, 0);
+        err = kernel.setArg(6, 1);
 
         // Start network layer kernel
         cl::Kernel network(*bm->getExecutionSettings().program, "network_layer_bottomright", &err);
@@ -1012,6 +1029,42 @@ TEST_F(LinpackKernelCommunicationTestLU, LUBlockExternalChannelOutputToBottomCor
     }
 }
 
+TEST_F(LinpackKernelCommunicationTestLUFactorized, LUBlockFactorizedResultIsNotModified) {
+    auto data2 = bm->generateInputData();
+    linpack::gefa_ref_nopvt(data2->A, bm->getExecutionSettings().programSettings->matrixSize,bm->getExecutionSettings().programSettings->matrixSize);
+    double max_error = 0.0;
+    for (int i = 0; i < bm->getExecutionSettings().programSettings->matrixSize * bm->getExecutionSettings().programSettings->matrixSize; i++) {
+        max_error = std::max(max_error, static_cast<double>(std::abs(data2->A[i] - data->A[i])));
+    }
+    EXPECT_FLOAT_EQ(max_error, 0.0);
+}
+
+TEST_F(LinpackKernelCommunicationTestLUFactorized, LUBlockFactorizedChannelOutputToBottomCorrect) {
+    // data that was sent to top kernels
+    auto data_top = getDataFromExternalChannel(1, true);
+
+    size_t number_values = 0;
+    for (int i = 0; i < BLOCK_SIZE; i++ ) {
+        number_values += (BLOCK_SIZE - (i / CHUNK) * CHUNK);
+    }
+    EXPECT_EQ(data_top.size(), number_values);
+    if (data_top.size() == number_values) {
+
+        HOST_DATA_TYPE total_error = 0.0;
+
+        size_t offset = 0;
+        // for every column of a block
+        for (int i = 0; i < BLOCK_SIZE; i++ ) {
+            // for every row of a block
+            for (int j = (i / CHUNK) * CHUNK; j < BLOCK_SIZE; j++) {
+                total_error += std::abs(data->A[j + i * BLOCK_SIZE] - data_top[offset + (j - (i / CHUNK) * CHUNK)]);
+            }
+            offset += BLOCK_SIZE - (i / CHUNK) * CHUNK;
+        }
+        EXPECT_FLOAT_EQ(total_error, 0.0);
+    }
+}
+
 // START Unit tests for Left without LU input over channels
 
 TEST_F(LinpackKernelCommunicationTestLeftOut, LeftBlockExternalResultisCorrect) {
@@ -1147,23 +1200,26 @@ class LinpackKernelCommunicationTestAll : public LinpackKernelCommunicationTest
         err = topkernel.setArg(0, buffer);
         err = topkernel.setArg(1, lu_buffer_top);
         err = topkernel.setArg(2, CL_TRUE);
-        err = topkernel.setArg(3, 1);
-        err = topkernel.setArg(4, 0);
-        err = topkernel.setArg(5, 2);
+        err = topkernel.setArg(3, CL_FALSE);
+        err = topkernel.setArg(4, 1);
+        err = topkernel.setArg(5, 0);
+        err = topkernel.setArg(6, 2);
 
         cl::Kernel lu1kernel(*bm->getExecutionSettings().program, "lu", &err);
 
         err = lu1kernel.setArg(0, buffer);
-        err = lu1kernel.setArg(1, 0);
+        err = lu1kernel.setArg(1, CL_FALSE);
         err = lu1kernel.setArg(2, 0);
-        err = lu1kernel.setArg(3, 2);
+        err = lu1kernel.setArg(3, 0);
+        err = lu1kernel.setArg(4, 2);
 
         cl::Kernel lu2kernel(*bm->getExecutionSettings().program, "lu", &err);
 
         err = lu2kernel.setArg(0, buffer);
-        err = lu2kernel.setArg(1, 1);
+        err = lu2kernel.setArg(1, CL_FALSE);
         err = lu2kernel.setArg(2, 1);
-        err = lu2kernel.setArg(3, 2);
+        err = lu2kernel.setArg(3, 1);
+        err = lu2kernel.setArg(4, 2);
 
         // Start network layer kernel
         cl::Kernel network_br1(*bm->getExecutionSettings().program, "network_layer_bottomright", &err);
@@ -6,6 +6,8 @@
 #include "test_program_settings.h"
 #include "linpack_benchmark.hpp"
 
+#include <cmath>
+
 #ifdef _LAPACK_
 #ifdef _DP
 extern "C" void dgesv_(int* size, int* lrhs, double* A, int* size2, int* ipvt, double* b, int* size3, int* info);
@@ -72,6 +74,40 @@ TEST_P(LinpackKernelTest, DISABLED_FPGACorrectResultsGEFA) {
     EXPECT_EQ(0, errors);
 }
 
+/**
+ * The execution with a uniform matrix chooses the same pivots from the whole column as the host reference
+ * and solves the system
+ */
+TEST_P(LinpackKernelTest, FPGACorrectPivotsAndResultsWithPartialPivoting) {
+    bm->getExecutionSettings().programSettings->isDiagonallyDominant = false;
+    data = bm->generateInputData();
+    auto result = bm->executeKernel(*data);
+    // The reference implementation needs the whole matrix on a single rank
+    if (bm->getExecutionSettings().programSettings->torus_width * bm->getExecutionSettings().programSettings->torus_height == 1) {
+        auto ref_data = bm->generateInputData();
+        linpack::gefa_ref(ref_data->A, array_size, array_size, ref_data->ipvt);
+        for (int k = 0; k < array_size; k++) {
+            EXPECT_EQ(data->ipvt[k], ref_data->ipvt[k]);
+        }
+    }
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+/**
+ * Sampled validation accepts the reference LU decomposition and detects a wrong value
+ */
+TEST_P(LinpackKernelTest, SampledValidationDetectsWrongValue) {
+    if (!bm->getExecutionSettings().programSettings->isDiagonallyDominant || bm->getExecutionSettings().programSettings->torus_width * bm->getExecutionSettings().programSettings->torus_height > 1) {
+        // The reference implementation needs the whole matrix on a single rank
+        return;
+    }
+    bm->getExecutionSettings().programSettings->validationMode = hpcc_base::ValidationMode::sampled;
+    linpack::gefa_ref_nopvt(data->A, array_size, array_size);
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+    data->A[array_size + array_size / 2] += 1.0;
+    EXPECT_FALSE(bm->validateOutputAndPrintError(*data));
+}
+
 #ifdef _LAPACK_
 /**
  * Execution returns correct results for a single repetition
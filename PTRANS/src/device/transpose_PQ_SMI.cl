@@ -0,0 +1,229 @@
+/******************************************************************************
+ *  Author: Arjun Ramaswami
+ *
+ *  Edited by Marius Meyer:
+ *  - Adapt to used kernel signature
+ *  - Change to row-column loop structure
+ *  - Exchange the blocks over the Streaming Message Interface (SMI)
+ *****************************************************************************/
+
+/**
+ * This file contains the kernels "transpose_read" and "transpose_write" of the PQ distribution
+ * that use the Streaming Message Interface (SMI) instead of the external channels.
+ * The blocks are sent to the rank at the transposed position in the PQ grid, which is passed
+ * to the kernels by the host. SMI routes the messages over the available links,
+ * so the FPGAs do not have to be cabled such that the transposed ranks are direct neighbours.
+ * The file has to be processed with the SMI code generator that adds the transport kernels and
+ * generates the host code to initialize the communicator.
+ */
+
+#include "parameters.h"
+#include "smi.h"
+
+#pragma OPENCL EXTENSION cl_intel_channels : enable
+
+/**
+ * SMI data type of the exchanged values. The data handler of the host exchanges the values as float.
+ */
+#define SMI_DEVICE_DATA_TYPE SMI_FLOAT
+
+/**
+* Load a block of A into local memory in a reordered fashion
+* to transpose it half-way
+*
+*
+* @param A Buffer for matrix A
+* @param local_buffer The local memory buffer the block is stored into
+* @param current_block Index of the current block used to calculate the offset in global memory
+*
+*/
+void
+load_chunk_of_a(__global DEVICE_DATA_TYPE *restrict A,
+        DEVICE_DATA_TYPE local_buffer[BLOCK_SIZE * BLOCK_SIZE / CHANNEL_WIDTH][CHANNEL_WIDTH],
+        const ulong block_row,
+        const ulong block_col,
+        const ulong width_in_blocks,
+        const ulong row,
+        const ulong col) {
+
+        ulong local_mem_converted_row = row * (BLOCK_SIZE / CHANNEL_WIDTH) + col;
+
+        DEVICE_DATA_TYPE rotate_in[CHANNEL_WIDTH];
+
+        ulong load_address = block_row * BLOCK_SIZE * BLOCK_SIZE * width_in_blocks +
+                                block_col * BLOCK_SIZE + 
+                                row * BLOCK_SIZE * width_in_blocks + 
+                                col * CHANNEL_WIDTH;
+
+        // Blocks of a will be stored columnwise in global memory
+__attribute__((opencl_unroll_hint(CHANNEL_WIDTH)))
+        for (unsigned unroll_count = 0; unroll_count < CHANNEL_WIDTH; unroll_count++) {
+            rotate_in[unroll_count] = A[load_address + unroll_count];
+        }
+
+        unsigned rot = row & (CHANNEL_WIDTH - 1);
+
+        // rotate temporary buffer to store data into local buffer
+__attribute__((opencl_unroll_hint(CHANNEL_WIDTH)))
+        for (unsigned unroll_count = 0; unroll_count < CHANNEL_WIDTH; unroll_count++) {
+            // every block of (N / CHANNEL_WIDTH), rotates the index by 1
+            // store in double buffer
+            local_buffer[local_mem_converted_row][unroll_count] = rotate_in[(unroll_count + CHANNEL_WIDTH - rot)
+                                                                                        & (CHANNEL_WIDTH - 1)];
+        }
+}
+
+// PY_CODE_GEN block_start [replace(local_variables=locals()) for i in range(num_total_replications)]
+
+/**
+* send a chunk of A into local memory in a reordered fashion
+* to transpose it half-way
+*
+*
+* @param local_buffer The local memory buffer the block is stored into
+* @param row Row of the chunk in the block
+* @param col Column of the chunk in the block
+* @param chan SMI channel to the rank at the transposed position
+*
+*/
+void
+send_chunk_of_a/*PY_CODE_GEN i*/(const DEVICE_DATA_TYPE local_buffer[BLOCK_SIZE * BLOCK_SIZE / CHANNEL_WIDTH][CHANNEL_WIDTH],
+        const ulong row,
+        const ulong col,
+        SMI_Channel *chan) {
+
+        DEVICE_DATA_TYPE rotate_out[CHANNEL_WIDTH];
+
+        ulong base = col * BLOCK_SIZE;
+        ulong offset = row / CHANNEL_WIDTH;
+
+
+__attribute__((opencl_unroll_hint(CHANNEL_WIDTH)))
+        for (unsigned unroll_count = 0; unroll_count < CHANNEL_WIDTH; unroll_count++) {
+            unsigned rot = ((CHANNEL_WIDTH + unroll_count - row) * (BLOCK_SIZE / CHANNEL_WIDTH)) &
+                                                                                        (BLOCK_SIZE - 1);
+            unsigned row_rotate = base + offset + rot;
+            rotate_out[unroll_count] = local_buffer[row_rotate][unroll_count];
+        }
+
+        unsigned rot_out = row & (CHANNEL_WIDTH - 1);
+
+        DEVICE_DATA_TYPE data[CHANNEL_WIDTH];
+        // rotate temporary buffer to store data into local buffer
+__attribute__((opencl_unroll_hint(CHANNEL_WIDTH)))
+        for (unsigned unroll_count = 0; unroll_count < CHANNEL_WIDTH; unroll_count++) {
+            data[unroll_count] = rotate_out[(unroll_count + rot_out) & (CHANNEL_WIDTH - 1)];
+        }
+
+        // SMI sends a single value per push, so the chunk is sent value by value
+        for (unsigned unroll_count = 0; unroll_count < CHANNEL_WIDTH; unroll_count++) {
+            SMI_Push(chan, &data[unroll_count]);
+        }
+}
+
+/**
+ * Read blocks of matrix A and transpose them in memory.
+ * Send the block to the rank at the transposed position with SMI.
+ *
+ * Will do the following:
+ *
+ * A -> trans(A) -> SMI
+ *
+ * @param A Buffer for matrix A
+ * @param block_offset The first block that will be processed in the provided buffer
+ * @param number_of_blocks The number of blocks that will be processed starting from the block offset
+ * @param transposed_rank Rank at the transposed position in the PQ grid the blocks are sent to
+ * @param comm SMI communicator
+ */
+__attribute__((max_global_work_dim(0)))
+__kernel
+void transpose_read/*PY_CODE_GEN i*/(__global DEVICE_DATA_TYPE *restrict A,
+            const ulong offset,
+            const ulong width_in_blocks,
+            const ulong height_in_blocks,
+            const ulong number_of_blocks,
+            const int transposed_rank,
+            SMI_Comm comm) {
+
+    SMI_Channel chan = SMI_Open_send_channel(number_of_blocks * BLOCK_SIZE * BLOCK_SIZE, SMI_DEVICE_DATA_TYPE, transposed_rank, /*PY_CODE_GEN i*/, comm);
+
+    // local memory double buffer for a matrix block
+    DEVICE_DATA_TYPE a_block[2][BLOCK_SIZE * BLOCK_SIZE / CHANNEL_WIDTH][CHANNEL_WIDTH] __attribute__((xcl_array_partition(cyclic, CHANNEL_WIDTH,1))) __attribute__((xcl_array_partition(cyclic, CHANNEL_WIDTH,2)));
+
+    // transpose the matrix block-wise from global memory
+    // One extra iteration to empty double buffer
+    #pragma loop_coalesce
+    for (ulong block = offset; block < number_of_blocks + offset + 1; block++) {
+        // read in block from global memory and store it in a memory efficient manner
+        for (ulong row = 0; row < BLOCK_SIZE; row++) {
+            for (ulong col = 0; col < BLOCK_SIZE / CHANNEL_WIDTH; col++) {
+                if (block < number_of_blocks + offset) {
+                    ulong block_col = block / height_in_blocks;
+                    ulong block_row = block % height_in_blocks;
+                    load_chunk_of_a(A, a_block[block & 1], block_row, block_col, width_in_blocks, row, col);
+                }
+                if (block > offset) {
+                    send_chunk_of_a/*PY_CODE_GEN i*/(a_block[(block - 1) & 1], row, col, &chan);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Will add a matrix received with SMI and matrix from global memory and store result in global memory.
+ *
+ * Will do the following:
+ *
+ * SMI + B --> A_out
+ *
+ * where A_out, SMI and B are matrices of size matrixSize*matrixSize
+ *
+ * @param B Buffer for matrix B
+ * @param A_out Output buffer for result matrix
+ * @param block_offset The first block that will be processed in the provided buffer
+ * @param number_of_blocks The number of blocks that will be processed starting from the block offset
+ * @param transposed_rank Rank at the transposed position in the PQ grid the blocks are received from
+ * @param comm SMI communicator
+ */
+__attribute__((max_global_work_dim(0)))
+__kernel
+void transpose_write/*PY_CODE_GEN i*/(__global DEVICE_DATA_TYPE *restrict B,
+            __global DEVICE_DATA_TYPE *restrict A_out,
+            const ulong offset,
+            const ulong width_in_blocks,
+            const ulong number_of_blocks,
+            const int transposed_rank,
+            SMI_Comm comm) {
+
+    SMI_Channel chan = SMI_Open_receive_channel(number_of_blocks * BLOCK_SIZE * BLOCK_SIZE, SMI_DEVICE_DATA_TYPE, transposed_rank, /*PY_CODE_GEN i*/, comm);
+
+    #pragma loop_coalesce
+    for (ulong block = offset; block < number_of_blocks + offset; block++) {
+        // complete matrix transposition and write the result back to global memory
+        for (ulong row = 0; row < BLOCK_SIZE; row++) {
+            for (ulong col = 0; col < BLOCK_SIZE / CHANNEL_WIDTH; col++) {
+
+                DEVICE_DATA_TYPE data[CHANNEL_WIDTH];
+                for (unsigned unroll_count = 0; unroll_count < CHANNEL_WIDTH; unroll_count++) {
+                    SMI_Pop(&chan, &data[unroll_count]);
+                }
+
+                ulong block_col = block % width_in_blocks;
+                ulong block_row = block / width_in_blocks;
+
+                // rotate temporary buffer to store data into local buffer
+__attribute__((opencl_unroll_hint(CHANNEL_WIDTH)))
+                for (unsigned unroll_count = 0; unroll_count < CHANNEL_WIDTH; unroll_count++) {
+                    ulong ls_address = block_row * BLOCK_SIZE * BLOCK_SIZE * width_in_blocks +
+                                        block_col * BLOCK_SIZE +
+                                        row * BLOCK_SIZE * width_in_blocks + 
+                                        col * CHANNEL_WIDTH + unroll_count;
+                    A_out[ls_address] = data[unroll_count] + B[ls_address];
+                }
+            }
+        }
+    }
+}
+
+// PY_CODE_GEN block_end
@@ -29,6 +29,8 @@ SOFTWARE.
 
 /* Project's headers */
 #include "handler.hpp"
+#include "../transpose_host.hpp"
+#include "trace_region.hpp"
 
 /**
  * @brief Contains all classes and methods needed by the Transpose benchmark
@@ -142,6 +144,7 @@ public:
      */
     void
     exchangeData(TransposeData& data) override {
+        HPCC_TRACE_REGION("exchangeData");
 
     #ifndef NDEBUG
         // std::cout << "Start data exchange " << mpi_comm_rank << std::endl;
@@ -185,15 +188,23 @@ public:
 
     void 
     reference_transpose(TransposeData& data) {
+        size_t block_size = data.blockSize;
+        HOST_DATA_TYPE* A = data.A;
+        const HOST_DATA_TYPE* B = data.B;
+        const HOST_DATA_TYPE* result = data.result;
+        // The blocks are stored one after the other, so they form a matrix with a width of a single block
+        transpose::host::tiledTransposeLoop(data.numBlocks * block_size, block_size, [=](size_t i, size_t j) {
+            A[(i / block_size) * block_size * block_size + j * block_size + i % block_size] -= (result[i * block_size + j] - B[i * block_size + j]);
+        });
+    }
+
+    double
+    getTransposeError(TransposeData& data, size_t index) {
         size_t block_offset = data.blockSize * data.blockSize;
-        for (size_t b = 0; b < data.numBlocks; b++) {
-            for (size_t i = 0; i < data.blockSize; i++) {
-                for (size_t j = 0; j < data.blockSize; j++) {
-                    data.A[b * block_offset + j * data.blockSize + i] -= (data.result[b * block_offset + i * data.blockSize + j] 
-                                                                                - data.B[b * block_offset + i * data.blockSize + j]);
-                }
-            }
-        }
+        size_t b = index / block_offset;
+        size_t i = (index % block_offset) / data.blockSize;
+        size_t j = index % data.blockSize;
+        return data.A[b * block_offset + j * data.blockSize + i] - (data.result[index] - data.B[index]);
     }
 
     DistributedDiagonalTransposeDataHandler(int mpi_rank, int mpi_size): TransposeDataHandler(mpi_rank, mpi_size) {
@@ -82,12 +82,25 @@ public:
     virtual void
     reference_transpose(TransposeData& data) = 0;
 
+    /**
+     * @brief Calculate the error of a single value of the result after the data was exchanged with exchangeData().
+     *          Used by the sampled validation instead of reference_transpose() to check only some of the values.
+     * 
+     * @param data The exchanged data
+     * @param index Index of the value in the result matrix of this rank
+     * @return double The difference between the calculated and the expected value
+     */
+    virtual double
+    getTransposeError(TransposeData& data, size_t index) = 0;
+
     /**
      * @brief Construct a new Transpose Data Handler object and initialize the MPI rank and MPI size variables if MPI is used
      * 
      */
     TransposeDataHandler(int mpi_comm_rank, int mpi_comm_size) : mpi_comm_rank(mpi_comm_rank), mpi_comm_size(mpi_comm_size) {}
 
+    virtual ~TransposeDataHandler() {}
+
 };
 
 }
@@ -26,9 +26,13 @@ SOFTWARE.
 /* C++ standard library headers */
 #include <memory>
 #include <algorithm>
+#include <functional>
+#include <map>
 
 /* Project's headers */
 #include "handler.hpp"
+#include "../transpose_host.hpp"
+#include "trace_region.hpp"
 
 /**
  * @brief Contains all classes and methods needed by the Transpose benchmark
@@ -37,21 +41,6 @@ SOFTWARE.
 namespace transpose {
 namespace data_handler {
 
-/**
- * @brief Modulo operation that always produces positive values in range [0,op-1]. This is required for the PQ transpose algorithm and is different from the usual remainder calculation done with %!
- * 
- * @tparam T Data type used for the modulo operation.
- * @param number Number the modulo is calculated from
- * @param op Modulo operator
- * @return T number mod op
- */
-template<typename T> 
-static T mod(T number, T op) {
-    T result = number % op;
-    // result >= op required for unsinged data types
-    return (result < 0 || result >= op) ? op + result : result;
-}
-
 class DistributedPQTransposeDataHandler : public TransposeDataHandler {
 
 private:
@@ -98,25 +87,304 @@ private:
      */
     int pq_height;
 
+public:
+
+    /**
+     * @brief The blocks of a single message of the data exchange
+     * 
+     */
+    struct MessageBlocks {
+        /**
+         * @brief Rank the message is sent to or received from
+         * 
+         */
+        int rank;
+        /**
+         * @brief Block row of the sending rank in its local matrix the blocks of the message are taken from
+         * 
+         */
+        int tag;
+        /**
+         * @brief Block row and block column of all blocks of the message in the local or exchanged matrix
+         * 
+         */
+        std::vector<std::pair<int,int>> blocks;
+    };
+
+private:
+
+    /**
+     * @brief A single message of the data exchange. The blocks are described by an MPI datatype directly 
+     *          in the local matrix, so no packing into intermediate buffers is needed.
+     * 
+     */
+    struct ExchangeMessage : MessageBlocks {
+        MPI_Datatype type;
+    };
+
+    /**
+     * @brief Persistent requests for all exchange messages that are bound to a pair of matrix buffers
+     * 
+     */
+    struct PersistentRequests {
+        HOST_DATA_TYPE* send_base;
+        HOST_DATA_TYPE* recv_base;
+        /**
+         * @brief True, if the requests exchange the local matrix. False, if they transfer the exchanged matrix back.
+         * 
+         */
+        bool forward;
+        std::vector<MPI_Request> send_requests;
+        std::vector<MPI_Request> recv_requests;
+    };
+
+    /**
+     * @brief All messages that are sent by this rank. Created with the first exchange.
+     * 
+     */
+    std::vector<ExchangeMessage> send_messages;
+
+    /**
+     * @brief All messages that are received by this rank. Created with the first exchange.
+     * 
+     */
+    std::vector<ExchangeMessage> recv_messages;
+
+    /**
+     * @brief Persistent requests that are reused by all repetitions. 
+     *          Since exchangeData swaps A and exchange, two sets of requests will be created for the same data object.
+     * 
+     */
+    std::vector<PersistentRequests> persistent_requests;
+
+    /**
+     * @brief Create the datatypes of all messages exchanged by this rank
+     * 
+     * @param block_size Width of a block in number of values
+     */
+    void
+    createMessages(int block_size) {
+        // A single block within the local and the exchanged matrix
+        MPI_Datatype local_block;
+        MPI_Type_vector(block_size, block_size, width_per_rank * block_size, MPI_FLOAT, &local_block);
+        MPI_Datatype exchanged_block;
+        MPI_Type_vector(block_size, block_size, height_per_rank * block_size, MPI_FLOAT, &exchanged_block);
+
+        auto messages = getExchangeMessages();
+        for (auto& message_blocks : messages.first) {
+            std::vector<MPI_Aint> displacements;
+            ExchangeMessage message;
+            static_cast<MessageBlocks&>(message) = message_blocks;
+            for (auto& block : message.blocks) {
+                displacements.push_back((static_cast<size_t>(block.first) * width_per_rank * block_size + block.second) * block_size * sizeof(HOST_DATA_TYPE));
+            }
+            MPI_Type_create_hindexed_block(displacements.size(), 1, displacements.data(), local_block, &message.type);
+            MPI_Type_commit(&message.type);
+            send_messages.push_back(message);
+        }
+        for (auto& message_blocks : messages.second) {
+            std::vector<MPI_Aint> displacements;
+            ExchangeMessage message;
+            static_cast<MessageBlocks&>(message) = message_blocks;
+            for (auto& block : message.blocks) {
+                displacements.push_back((static_cast<size_t>(block.first) * height_per_rank * block_size + block.second) * block_size * sizeof(HOST_DATA_TYPE));
+            }
+            MPI_Type_create_hindexed_block(displacements.size(), 1, displacements.data(), exchanged_block, &message.type);
+            MPI_Type_commit(&message.type);
+            recv_messages.push_back(message);
+        }
+#ifndef NDEBUG
+        std::cout << "Rank " << mpi_comm_rank << ": send " << send_messages.size() << " messages, recv " << recv_messages.size() << " messages" << std::endl << std::flush;
+#endif
+        MPI_Type_free(&local_block);
+        MPI_Type_free(&exchanged_block);
+    }
+
+public:
+
+    /**
+     * @brief Calculate the blocks of all messages exchanged by this rank. It only depends on the size of the local matrix,
+     *          so the exchange of a whole PQ grid can also be checked without MPI.
+     *          The local matrix has height_per_rank x width_per_rank blocks. The exchanged matrix contains the blocks of A 
+     *          that are required to calculate the transposed result blocks of this rank. It has width_per_rank x height_per_rank blocks.
+     *          Every block row of a rank is sent in one message to every rank that needs blocks of it, so the received blocks can be
+     *          used while the remaining rows are still transferred.
+     * 
+     * @return std::pair<std::vector<MessageBlocks>, std::vector<MessageBlocks>> The sent messages with blocks of the local matrix
+     *          and the received messages with blocks of the exchanged matrix. The blocks of a message have the same order on both ranks.
+     */
+    std::pair<std::vector<MessageBlocks>, std::vector<MessageBlocks>>
+    getExchangeMessages() const {
+        std::pair<std::vector<MessageBlocks>, std::vector<MessageBlocks>> messages;
+
+        // The local block (row, col) is the global block (row * Q + pq_row, col * P + pq_col).
+        // It is required by the rank that calculates the global result block at the transposed position.
+        std::map<std::pair<int,int>, std::vector<std::pair<int,int>>> send_blocks;
+        for (int row = 0; row < height_per_rank; row++) {
+            for (int col = 0; col < width_per_rank; col++) {
+                int global_block_row = row * pq_height + pq_row;
+                int global_block_col = col * pq_width + pq_col;
+                int destination_rank = (global_block_col % pq_height) * pq_width + (global_block_row % pq_width);
+                send_blocks[{destination_rank, row}].push_back({row, col});
+            }
+        }
+
+        // The exchanged block (row, col) is the global block (row * P + pq_col, col * Q + pq_row) of A.
+        // The blocks are sorted by the rank and the local position they are received from, to match the order of the sending rank.
+        std::map<std::pair<int,int>, std::vector<std::pair<int,std::pair<int,int>>>> recv_blocks;
+        for (int row = 0; row < width_per_rank; row++) {
+            for (int col = 0; col < height_per_rank; col++) {
+                int global_block_row = row * pq_width + pq_col;
+                int global_block_col = col * pq_height + pq_row;
+                int source_rank = (global_block_row % pq_height) * pq_width + (global_block_col % pq_width);
+                recv_blocks[{source_rank, global_block_row / pq_height}].push_back({global_block_col / pq_width, {row, col}});
+            }
+        }
+
+        for (auto& message_blocks : send_blocks) {
+            messages.first.push_back({message_blocks.first.first, message_blocks.first.second, message_blocks.second});
+        }
+        for (auto& message_blocks : recv_blocks) {
+            std::sort(message_blocks.second.begin(), message_blocks.second.end());
+            MessageBlocks message{message_blocks.first.first, message_blocks.first.second, {}};
+            for (auto& block : message_blocks.second) {
+                message.blocks.push_back(block.second);
+            }
+            messages.second.push_back(message);
+        }
+        return messages;
+    }
+
+private:
+
+    /**
+     * @brief Get the persistent requests for the current matrix buffers of the data object.
+     *          They are created if they do not exist yet. The first exchange of a data object always exchanges the local matrix,
+     *          the exchange with swapped buffers transfers the exchanged matrix back using the messages in reverse direction.
+     * 
+     * @param data The data object that will be exchanged
+     * @return PersistentRequests& The requests that send data.A and receive into data.exchange
+     */
+    PersistentRequests&
+    getPersistentRequests(TransposeData& data) {
+        for (auto& requests : persistent_requests) {
+            if (requests.send_base == data.A && requests.recv_base == data.exchange) {
+                return requests;
+            }
+        }
+        PersistentRequests requests;
+        requests.send_base = data.A;
+        requests.recv_base = data.exchange;
+        requests.forward = persistent_requests.empty() || persistent_requests[0].send_base != data.exchange || persistent_requests[0].recv_base != data.A;
+        if (requests.forward) {
+            // Only the requests for the two buffer orders of a single data object are kept
+            freePersistentRequests();
+        }
+        auto& sent = requests.forward ? send_messages : recv_messages;
+        auto& received = requests.forward ? recv_messages : send_messages;
+        requests.send_requests.resize(sent.size());
+        requests.recv_requests.resize(received.size());
+        for (int m = 0; m < received.size(); m++) {
+            MPI_Recv_init(data.exchange, 1, received[m].type, received[m].rank, received[m].tag, MPI_COMM_WORLD, &requests.recv_requests[m]);
+        }
+        for (int m = 0; m < sent.size(); m++) {
+            MPI_Send_init(data.A, 1, sent[m].type, sent[m].rank, sent[m].tag, MPI_COMM_WORLD, &requests.send_requests[m]);
+        }
+        persistent_requests.push_back(requests);
+        return persistent_requests.back();
+    }
+
+    /**
+     * @brief Seed of the counter based random number generator used for the input matrices
+     * 
+     */
+    static constexpr uint64_t input_seed = 42;
+
     /**
-     * @brief MPI derived data type for block-wise matrix transfer
+     * @brief Get the global row of a row of the local matrix
      * 
+     * @param row Row in the local matrix in number of values
+     * @param block_size Width and height of a block in number of values
+     * @return size_t Row in the global matrix
      */
-    MPI_Datatype data_block;
+    size_t
+    globalRow(size_t row, size_t block_size) const {
+        return ((row / block_size) * pq_height + pq_row) * block_size + row % block_size;
+    }
 
     /**
-     * @brief Vector of buffers that is used to send data to multiple ranks in parallel.
-     *          We will need GCD(pq_width,pq_height) buffers
+     * @brief Get the global column of a column of the local matrix
      * 
+     * @param col Column in the local matrix in number of values
+     * @param block_size Width and height of a block in number of values
+     * @return size_t Column in the global matrix
      */
-    std::vector<std::vector<HOST_DATA_TYPE>> send_buffers;
+    size_t
+    globalColumn(size_t col, size_t block_size) const {
+        return ((col / block_size) * pq_width + pq_col) * block_size + col % block_size;
+    }
 
     /**
-     * @brief Vector of buffers that is used to receive data from multiple ranks in parallel.
-     *          We will need GCD(pq_width,pq_height) buffers
+     * @brief Get the counter of the random number generator for a position in the global matrix
      * 
+     * @param row Row in the global matrix
+     * @param col Column in the global matrix
+     * @param block_size Width and height of a block in number of values
+     * @return uint64_t The counter for the position
      */
-    std::vector<std::vector<HOST_DATA_TYPE>> recv_buffers;
+    uint64_t
+    globalIndex(size_t row, size_t col, size_t block_size) const {
+        return static_cast<uint64_t>(row) * global_width * block_size + col;
+    }
+
+    /**
+     * @brief Regenerate the value of the transposed global matrix A for a position of the local matrix.
+     *          Used for the validation if the exchanged matrix A is not kept in lean memory mode.
+     * 
+     * @param row Row in the local matrix in number of values
+     * @param col Column in the local matrix in number of values
+     * @param block_size Width and height of a block in number of values
+     * @return HOST_DATA_TYPE The value of A^T at the given position
+     */
+    HOST_DATA_TYPE
+    transposedValue(size_t row, size_t col, size_t block_size) const {
+        auto bits = hpcc_base::rng::randomBits(globalIndex(globalColumn(col, block_size), globalRow(row, block_size), block_size), input_seed);
+        return 100.0 * hpcc_base::rng::toUniformSigned(bits[0]);
+    }
+
+    /**
+     * @brief Free all persistent requests
+     * 
+     */
+    void
+    freePersistentRequests() {
+        for (auto& requests : persistent_requests) {
+            for (auto& r : requests.send_requests) {
+                MPI_Request_free(&r);
+            }
+            for (auto& r : requests.recv_requests) {
+                MPI_Request_free(&r);
+            }
+        }
+        persistent_requests.clear();
+    }
+
+    /**
+     * @brief Free all requests and datatypes, e.g. if the size of the local matrix changes
+     * 
+     */
+    void
+    freeMessages() {
+        freePersistentRequests();
+        for (auto& message : send_messages) {
+            MPI_Type_free(&message.type);
+        }
+        for (auto& message : recv_messages) {
+            MPI_Type_free(&message.type);
+        }
+        send_messages.clear();
+        recv_messages.clear();
+    }
 
 public:
 
@@ -128,6 +396,20 @@ public:
         return height_per_rank;
     }
 
+    /**
+     * @brief Get the rank at the transposed position in the PQ grid. This rank holds the blocks of A that are
+     *          required to calculate the result blocks of the current rank and vice versa.
+     *          Only defined for P=Q, because the transposed position does not exist in the grid otherwise.
+     *
+     * @return int The rank at the transposed position of the current rank
+     */
+    int getTransposedRank() {
+        if (pq_width != pq_height) {
+            throw std::runtime_error("The transposed rank is only defined for P=Q, but P=" + std::to_string(pq_width) + " and Q=" + std::to_string(pq_height));
+        }
+        return (mpi_comm_rank % pq_width) * pq_width + mpi_comm_rank / pq_width;
+    }
+
     /**
      * @brief Generate data for transposition based on the implemented distribution scheme
      * 
@@ -139,6 +421,9 @@ public:
         int width_in_blocks = settings.programSettings->matrixSize / settings.programSettings->blockSize;
         global_width = width_in_blocks;
 
+        // The messages depend on the size of the local matrix
+        freeMessages();
+
         width_per_rank = width_in_blocks / pq_width;
         height_per_rank = width_in_blocks / pq_height;
         pq_row = mpi_comm_rank / pq_width;
@@ -149,36 +434,37 @@ public:
         height_per_rank += (pq_row < (width_in_blocks % pq_height)) ?  1 : 0;
         width_per_rank += (pq_col < (width_in_blocks % pq_width)) ? 1 : 0;
 
-        // A data block is strided and stride depends on the local matrix size!
-        MPI_Type_vector(settings.programSettings->blockSize,settings.programSettings->blockSize,(width_per_rank - 1)*settings.programSettings->blockSize, MPI_FLOAT, &data_block);
-        MPI_Type_commit(&data_block);
-
         int blocks_per_rank = height_per_rank * width_per_rank;
-
-        // Create send and receive buffers for concurrent MPI communication
-        int gcd = std::__gcd(pq_height, pq_width);
-        for (int i = 0; i < gcd; i++) {
-            send_buffers.emplace_back(settings.programSettings->blockSize * settings.programSettings->blockSize * blocks_per_rank);
-            recv_buffers.emplace_back(settings.programSettings->blockSize * settings.programSettings->blockSize * blocks_per_rank);
-        }
         
         // Allocate memory for a single device and all its memory banks
-        auto d = std::unique_ptr<transpose::TransposeData>(new transpose::TransposeData(*settings.context, settings.programSettings->blockSize, blocks_per_rank));
-
-        // Fill the allocated memory with pseudo random values
-        std::mt19937 gen(mpi_comm_rank);
-        std::uniform_real_distribution<> dis(-100.0, 100.0);
-        for (size_t i = 0; i < blocks_per_rank * settings.programSettings->blockSize; i++) {
-            for (size_t j = 0; j < settings.programSettings->blockSize; j++) {
-                d->A[i * settings.programSettings->blockSize + j] = dis(gen);
-                d->B[i * settings.programSettings->blockSize + j] = dis(gen);
-                d->result[i * settings.programSettings->blockSize + j] = 0.0;
+        auto d = std::unique_ptr<transpose::TransposeData>(new transpose::TransposeData(*settings.context, settings.programSettings->blockSize, blocks_per_rank,
+                                                                                        settings.programSettings->leanMemory));
+
+        // Fill the allocated memory with pseudo random values.
+        // The values only depend on the global position, so they can be regenerated for the validation 
+        size_t block_size = settings.programSettings->blockSize;
+        size_t local_width = width_per_rank * block_size;
+        #pragma omp parallel for
+        for (int i = 0; i < static_cast<int>(height_per_rank * block_size); i++) {
+            for (size_t j = 0; j < local_width; j++) {
+                auto bits = hpcc_base::rng::randomBits(globalIndex(globalRow(i, block_size), globalColumn(j, block_size), block_size), input_seed);
+                d->A[i * local_width + j] = 100.0 * hpcc_base::rng::toUniformSigned(bits[0]);
+                d->B[i * local_width + j] = 100.0 * hpcc_base::rng::toUniformSigned(bits[1]);
+                d->result[i * local_width + j] = 0.0;
             }
         }
         
         return d;
     }
 
+    /**
+     * @brief Function that is called for every block as soon as it is available after the exchange.
+     *          Gets the block row and block column of the block and a pointer to the matrix,
+     *          which will be data.A after the exchange. The exchanged matrix has width_per_rank x height_per_rank blocks.
+     * 
+     */
+    using BlockReceivedCallback = std::function<void(size_t, size_t, const HOST_DATA_TYPE*)>;
+
     /**
      * @brief Exchange the data blocks for verification
      * 
@@ -187,194 +473,85 @@ public:
      */
     void
     exchangeData(TransposeData& data) override {
+        exchangeData(data, [](size_t, size_t, const HOST_DATA_TYPE*) {});
+    }
 
-        MPI_Status status;     
-
-        if (pq_width == pq_height) {
-            if (pq_col != pq_row) {
-
-                int pair_rank = pq_width * pq_col + pq_row;
-
-                // To re-calculate the matrix transposition locally on this host, we need to 
-                // exchange matrix A for every kernel replication
-                // The order of the matrix blocks does not change during the exchange, because they are distributed diagonally 
-                // and will be handled in the order below:
-                //
-                // . . 1 3
-                // . . . 2
-                // 1 . . .
-                // 3 2 . .
-   
-
-                size_t remaining_data_size = data.numBlocks;
-                size_t offset = 0;
-                while (remaining_data_size > 0) {
-                    int next_chunk = (remaining_data_size > std::numeric_limits<int>::max()) ? std::numeric_limits<int>::max(): remaining_data_size;
-                    MPI_Sendrecv(&data.A[offset], next_chunk, data_block, pair_rank, 0, &data.exchange[offset], next_chunk, data_block, pair_rank, 0, MPI_COMM_WORLD, &status);
-
-                    remaining_data_size -= next_chunk;
-                    offset += static_cast<size_t>(next_chunk) * static_cast<size_t>(data.blockSize * data.blockSize);
+    /**
+     * @brief Exchange the data blocks in a pipeline. All messages are started at once using persistent requests
+     *          and every received message can be used while the remaining messages are still transferred. 
+     * 
+     * @param data The data that was generated locally and will be exchanged with other MPI ranks 
+     *              Exchanged data will be stored in the same object.
+     * @param on_block_received Called for every block as soon as it is received, e.g. to copy it to the device
+     *              while the remaining blocks are still transferred
+     */
+    void
+    exchangeData(TransposeData& data, const BlockReceivedCallback& on_block_received) {
+        HPCC_TRACE_REGION("exchangeData");
+
+        if ((pq_width == pq_height && pq_col == pq_row) || width_per_rank * height_per_rank == 0) {
+            // Blocks on the diagonal stay on the rank. Ranks without blocks do not take part in the exchange.
+            for (int row = 0; row < width_per_rank; row++) {
+                for (int col = 0; col < height_per_rank; col++) {
+                    on_block_received(row, col, data.A);
                 }
-
-                // Exchange window pointers
-                HOST_DATA_TYPE* tmp = data.exchange;
-                data.exchange = data.A;
-                data.A = tmp;
             }
+            return;
         }
-        else {
-            // Taken from "Parallel matrix transpose algorithms on distributed memory concurrent computers" by J. Choi, J. J. Dongarra, D. W. Walker
-            // and translated to C++
-            // This will do a diagonal exchange of matrix blocks.
-
-            // Determine LCM using GCD from standard library using the C++14 call
-            // In C++17 this changes to std::gcd in numeric, also std::lcm is directly available in numeric
-            int gcd = std::__gcd(pq_height, pq_width);
-            int least_common_multiple = pq_height * pq_width / gcd;
-
-            // If the global matrix size is not a multiple of the LCM block size, the numbers of send and received blocks
-            // may be wrongly calculated. Throw exception to prevent this and make aware of this issue!
-            if (global_width % least_common_multiple > 0) {
-                throw std::runtime_error("Implementation does not support matrix sizes that are not multiple of LCM blocks! Results may be wrong!");
-            }
 
-            // MPI requests for non-blocking communication
-            // First half of vector is for Isend, second half for Irecv!
-            std::vector<MPI_Request> mpi_requests(2 * gcd);
-
-            // Begin algorithm from Figure 14 for general case
-            int g = mod(pq_row - pq_col, gcd);
-            int p = mod(pq_col + g, pq_width);
-            int q = mod(pq_row - g, pq_height);
-
-            // Pre-calculate target ranks in LCM block
-            // The vector list variable can be interpreted as 2D matrix. Every entry represents the target rank of the sub-block
-            // Since the LCM block will repeat, we only need to store this small amount of data!
-            std::vector<int> target_list(least_common_multiple/pq_height * least_common_multiple/pq_width);
-            for (int row = 0; row  < least_common_multiple/pq_height; row++) {
-                for (int col = 0; col  < least_common_multiple/pq_width; col++) {
-                    int global_block_col = pq_col + col * pq_width;
-                    int global_block_row = pq_row + row * pq_height;
-                    int destination_rank = (global_block_col % pq_height) * pq_width + (global_block_row % pq_width);
-                    target_list[row * least_common_multiple/pq_width + col] = destination_rank;
-                }
-            }
-
-            int current_parallel_execution = 0;
-
-            for (int j = 0; j < least_common_multiple/pq_width; j++) {
-                for (int i = 0; i < least_common_multiple/pq_height; i++) {
-                    // Determine sender and receiver rank of current rank for current communication step
-                    int send_rank = mod(p + i * gcd, pq_width) + mod(q - j * gcd, pq_height) * pq_width;
-                    int recv_rank = mod(p - i * gcd, pq_width) + mod(q + j * gcd, pq_height) * pq_width;
-
-                    // Collect all blocks that need to be send to other rank
-                    auto send_buffer_location = send_buffers[current_parallel_execution].begin();
-                    // Also count receiving buffer size because sending and receiving buffer size may differ in certain scenarios!
-                    int receiving_size = 0;
-                    int sending_size = 0;
-
-                    std::vector<int> send_rows;
-                    std::vector<int> send_cols;
-                    // Look up which blocks are affected by the current rank
-                    for (int row = 0; row  < least_common_multiple/pq_height; row++) {
-                        for (int col = 0; col  < least_common_multiple/pq_width; col++) {
-                            if (target_list[row * least_common_multiple/pq_width + col] == send_rank) {
-                                send_rows.push_back(row);
-                                send_cols.push_back(col);
-                                sending_size += data.blockSize * data.blockSize;
-                            }
-                            if (target_list[row * least_common_multiple/pq_width + col] == recv_rank) {
-                                receiving_size += data.blockSize * data.blockSize;
-                            }
-                        }
-                    }
-                    receiving_size *= (height_per_rank)/(least_common_multiple/pq_height) * ((width_per_rank)/(least_common_multiple/pq_width));
-                    sending_size *= (height_per_rank)/(least_common_multiple/pq_height) * ((width_per_rank)/(least_common_multiple/pq_width));
-
-                    #pragma omp parallel for collapse(3)
-                    for (int t=0; t < send_rows.size(); t++) {
-                        for (int lcm_row = 0; lcm_row < (height_per_rank)/(least_common_multiple/pq_height); lcm_row++) {
-                            for (int lcm_col = 0; lcm_col < (width_per_rank)/(least_common_multiple/pq_width); lcm_col++) {
-                                auto sending_buffer_offset = send_buffer_location + lcm_row * data.blockSize * data.blockSize * ((width_per_rank)/(least_common_multiple/pq_width)) + lcm_col * data.blockSize * data.blockSize;
-                                size_t matrix_buffer_offset = (send_cols[t] + lcm_col * least_common_multiple/pq_width)  * data.blockSize + (send_rows[t] + lcm_row * least_common_multiple/pq_height) * width_per_rank * data.blockSize * data.blockSize;
-                                for (int block_row = 0; block_row < data.blockSize; block_row++) {
-                                    std::copy(data.A + matrix_buffer_offset + block_row * width_per_rank * data.blockSize, data.A + matrix_buffer_offset + block_row * width_per_rank * data.blockSize + data.blockSize, sending_buffer_offset);
-                                }
-                            }
-                        }
-                    }
-
-                    // Do actual MPI communication
-#ifndef NDEBUG
-                    std::cout << "Rank " << mpi_comm_rank << ": blocks (" << sending_size / (data.blockSize * data.blockSize) << "," << receiving_size / (data.blockSize * data.blockSize) << ") send " << send_rank << ", recv " << recv_rank << std::endl << std::flush;
-#endif
-                    MPI_Isend(send_buffers[current_parallel_execution].data(), sending_size, MPI_FLOAT, send_rank, 0, MPI_COMM_WORLD, &mpi_requests[current_parallel_execution]);
-                    MPI_Irecv(recv_buffers[current_parallel_execution].data(), receiving_size, MPI_FLOAT, recv_rank, 0, MPI_COMM_WORLD, &mpi_requests[gcd + current_parallel_execution]);
-                    // Increase the counter for parallel executions
-                    current_parallel_execution = (current_parallel_execution + 1) % gcd;
-
-                    // Wait for MPI requests if GCD MPI calls are scheduled in parallel
-                    if ((current_parallel_execution) % gcd == 0) {
-
-
-                        for (auto& req : mpi_requests) {
-                        
-                            MPI_Status status;
-                            int index;
-
-                            MPI_Waitany(mpi_requests.size(), mpi_requests.data(),&index, &status);
-
-                            // For each message that was received in parallel
-                            if (index >= gcd) {
-                                // Insert received data into result matrix
-                                auto recv_buffer_location = recv_buffers[index - gcd].begin();
-
-                                std::vector<int> recv_rows;
-                                std::vector<int> recv_cols;
-                                // Look up which blocks are affected by the current rank
-                                for (int row = 0; row  < least_common_multiple/pq_height; row++) {
-                                    for (int col = 0; col  < least_common_multiple/pq_width; col++) {
-                                        if (target_list[row * least_common_multiple/pq_width + col] == status.MPI_SOURCE) {
-                                            recv_rows.push_back(row);
-                                            recv_cols.push_back(col);
-                                        }
-                                    }
-                                }
-                                #pragma omp parallel for collapse(3)
-                                for (int t=0; t < recv_rows.size(); t++) {
-                                    for (int lcm_row = 0; lcm_row < (height_per_rank)/(least_common_multiple/pq_height); lcm_row++) {
-                                        for (int lcm_col = 0; lcm_col < (width_per_rank)/(least_common_multiple/pq_width); lcm_col++) {
-                                            auto receiving_buffer_offset = recv_buffer_location + lcm_row * data.blockSize * data.blockSize * ((width_per_rank)/(least_common_multiple/pq_width)) + lcm_col * data.blockSize * data.blockSize;
-                                            size_t matrix_buffer_offset = (recv_cols[t] + lcm_col * least_common_multiple/pq_width)  * data.blockSize + (recv_rows[t] + lcm_row * least_common_multiple/pq_height) * width_per_rank * data.blockSize * data.blockSize;
-                                            for (int block_row = 0; block_row < data.blockSize; block_row++) {
-                                                std::copy(receiving_buffer_offset, receiving_buffer_offset + data.blockSize,data.exchange + matrix_buffer_offset + block_row * width_per_rank * data.blockSize);
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    } 
-                }
+        if (send_messages.empty() && recv_messages.empty()) {
+            createMessages(data.blockSize);
+        }
+        PersistentRequests& requests = getPersistentRequests(data);
+
+        MPI_Startall(requests.recv_requests.size(), requests.recv_requests.data());
+        MPI_Startall(requests.send_requests.size(), requests.send_requests.data());
+        auto& received_messages = requests.forward ? recv_messages : send_messages;
+        for (int received = 0; received < received_messages.size(); received++) {
+            int m;
+            MPI_Waitany(requests.recv_requests.size(), requests.recv_requests.data(), &m, MPI_STATUS_IGNORE);
+            for (auto& block : received_messages[m].blocks) {
+                on_block_received(block.first, block.second, data.exchange);
             }
- 
-            // Exchange window pointers
-            HOST_DATA_TYPE* tmp = data.exchange;
-            data.exchange = data.A;
-            data.A = tmp;
         }
+        MPI_Waitall(requests.send_requests.size(), requests.send_requests.data(), MPI_STATUSES_IGNORE);
 
-
+        // Exchange window pointers
+        HOST_DATA_TYPE* tmp = data.exchange;
+        data.exchange = data.A;
+        data.A = tmp;
     }
 
     void 
     reference_transpose(TransposeData& data) {
-        for (size_t j = 0; j < height_per_rank * data.blockSize; j++) {
-            for (size_t i = 0; i < width_per_rank * data.blockSize; i++) {
-                data.A[i * height_per_rank * data.blockSize + j] -= (data.result[j * width_per_rank * data.blockSize + i] - data.B[j * width_per_rank * data.blockSize + i]);
+        size_t height = height_per_rank * data.blockSize;
+        size_t width = width_per_rank * data.blockSize;
+        HOST_DATA_TYPE* A = data.A;
+        const HOST_DATA_TYPE* B = data.B;
+        const HOST_DATA_TYPE* result = data.result;
+        if (data.leanMemory) {
+            // The exchanged matrix A does not exist anymore, so the buffer of A is overwritten with the errors
+            #pragma omp parallel for
+            for (int j = 0; j < static_cast<int>(height); j++) {
+                for (size_t i = 0; i < width; i++) {
+                    A[j * width + i] = transposedValue(j, i, data.blockSize) - (result[j * width + i] - B[j * width + i]);
+                }
             }
+            return;
+        }
+        transpose::host::tiledTransposeLoop(height, width, [=](size_t j, size_t i) {
+            A[i * height + j] -= (result[j * width + i] - B[j * width + i]);
+        });
+    }
+
+    double
+    getTransposeError(TransposeData& data, size_t index) {
+        size_t j = index / (width_per_rank * data.blockSize);
+        size_t i = index % (width_per_rank * data.blockSize);
+        if (data.leanMemory) {
+            return transposedValue(j, i, data.blockSize) - (data.result[index] - data.B[index]);
         }
+        return data.A[i * height_per_rank * data.blockSize + j] - (data.result[index] - data.B[index]);
     }
 
 /**
@@ -392,6 +569,20 @@ public:
         pq_height = mpi_size / p;
     }
 
+    /**
+     * @brief The handler owns MPI datatypes and persistent requests, so it must not be copied
+     * 
+     */
+    DistributedPQTransposeDataHandler(const DistributedPQTransposeDataHandler&) = delete;
+
+    ~DistributedPQTransposeDataHandler() {
+        int finalized;
+        MPI_Finalized(&finalized);
+        if (!finalized) {
+            freeMessages();
+        }
+    }
+
 };
 
 
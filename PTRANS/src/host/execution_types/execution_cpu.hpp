@@ -22,8 +22,6 @@ SOFTWARE.
 #ifndef SRC_HOST_CPU_EXECUTION_H_
 #define SRC_HOST_CPU_EXECUTION_H_
 
-#ifdef MKL_FOUND
-
 /* C++ standard library headers */
 #include <memory>
 #include <vector>
@@ -31,10 +29,11 @@ SOFTWARE.
 
 /* External library headers */
 #include "mpi.h"
-#include "mkl_trans.h"
 
 /* Project's headers */
 #include "data_handlers/handler.hpp"
+#include "data_handlers/pq.hpp"
+#include "transpose_host.hpp"
 
 namespace transpose
 {
@@ -44,7 +43,7 @@ namespace transpose
         {
 
             /**
- * @brief Transpose and add the matrices using MKL routines
+ * @brief Transpose and add the matrices using the tiled host transpose
  * 
  * @param config The progrma configuration
  * @param data data object that contains all required data for the execution
@@ -53,19 +52,12 @@ namespace transpose
             static std::unique_ptr<transpose::TransposeExecutionTimings>
             calculate(const hpcc_base::ExecutionSettings<transpose::TransposeProgramSettings> &config, transpose::TransposeData &data, transpose::data_handler::TransposeDataHandler &handler)
             {
-                int err;
-
                 std::vector<double> transferTimings;
                 std::vector<double> calculationTimings;
 
-                if (data.blockSize != BLOCK_SIZE) {
-                    throw std::runtime_error("Block size for CPU hardcoded to " + std::to_string(BLOCK_SIZE) + ". Recompile to use different block sizes!");
-                }
-
-                for (int repetition = 0; repetition < config.programSettings->numRepetitions; repetition++)
+                config.repetitions->start(*config.programSettings);
+                for (int repetition = 0; config.repetitions->next(calculationTimings); repetition++)
                 {
-                    transpose::data_handler::DistributedPQTransposeDataHandler pq_handler = *reinterpret_cast<transpose::data_handler::DistributedPQTransposeDataHandler*>(&handler);
-                    
                     MPI_Barrier(MPI_COMM_WORLD);
 
                     auto startCalculation = std::chrono::high_resolution_clock::now();
@@ -76,22 +68,22 @@ namespace transpose
                     auto endTransfer = std::chrono::high_resolution_clock::now();
 
                     switch (config.programSettings->dataHandlerIdentifier) {
-                        case transpose::data_handler::DataHandlerType::diagonal: 
-                                #pragma omp parallel for 
-                                for (ulong offset=0; offset < data.numBlocks * BLOCK_SIZE * BLOCK_SIZE; offset += BLOCK_SIZE * BLOCK_SIZE) {
-                                    mkl_somatadd('R', 'T', 'N', BLOCK_SIZE, BLOCK_SIZE, 1.0, &data.A[offset], BLOCK_SIZE, 1.0, &data.B[offset], BLOCK_SIZE, &data.result[offset], BLOCK_SIZE);
-                                }
-                                break;
-                        case transpose::data_handler::DataHandlerType::pq: 
-                                #pragma omp parallel for
-                                for (ulong yoffset=0; yoffset < BLOCK_SIZE * pq_handler.getHeightforRank(); yoffset += BLOCK_SIZE) {
-                                    for (ulong xoffset=0; xoffset < BLOCK_SIZE * pq_handler.getWidthforRank(); xoffset += BLOCK_SIZE) {
-                                        ulong toffset = xoffset * BLOCK_SIZE * pq_handler.getHeightforRank() + yoffset;
-                                        ulong offset = yoffset * BLOCK_SIZE * pq_handler.getWidthforRank() + xoffset;
-                                        mkl_somatadd('R', 'T', 'N', BLOCK_SIZE, BLOCK_SIZE, 1.0, &data.A[toffset], BLOCK_SIZE * pq_handler.getHeightforRank(), 1.0, &data.B[offset], BLOCK_SIZE * pq_handler.getWidthforRank(), &data.result[offset], BLOCK_SIZE * pq_handler.getWidthforRank());
-                                    }
-                                }
-                                break;
+                        case transpose::data_handler::DataHandlerType::diagonal: {
+                                // The blocks are stored one after the other, so they form a matrix with a width of a single block
+                                size_t block_size = data.blockSize;
+                                const HOST_DATA_TYPE* A = data.A;
+                                const HOST_DATA_TYPE* B = data.B;
+                                HOST_DATA_TYPE* result = data.result;
+                                transpose::host::tiledTransposeLoop(data.numBlocks * block_size, block_size, [=](size_t i, size_t j) {
+                                    result[i * block_size + j] = A[(i / block_size) * block_size * block_size + j * block_size + i % block_size] + B[i * block_size + j];
+                                });
+                                } break;
+                        case transpose::data_handler::DataHandlerType::pq: {
+                                auto& pq_handler = static_cast<transpose::data_handler::DistributedPQTransposeDataHandler&>(handler);
+                                size_t height = data.blockSize * pq_handler.getHeightforRank();
+                                size_t width = data.blockSize * pq_handler.getWidthforRank();
+                                transpose::host::transposeAdd(data.A, height, data.B, width, data.result, width, height, width);
+                                } break;
                         default: throw std::runtime_error("Given data handler is not supported by CPU implementation: " + transpose::data_handler::handlerToString(config.programSettings->dataHandlerIdentifier));
                     }
 
@@ -114,6 +106,8 @@ namespace transpose
                         std::chrono::duration_cast<std::chrono::duration<double>>(endTransfer - startCalculation);
                     transferTimings.push_back(transferTime.count());
                 }
+                config.repetitions->discardWarmup(calculationTimings);
+                config.repetitions->discardWarmup(transferTimings);
 
                 std::unique_ptr<transpose::TransposeExecutionTimings> result(new transpose::TransposeExecutionTimings{
                     transferTimings,
@@ -124,5 +118,4 @@ namespace transpose
         } // namespace bm_execution
     }
 }
-#endif // MKL_FOUND
 #endif // SRC_HOST_CPU_EXECUTION_H_
@@ -146,9 +146,9 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
                 err = transposeReadKernel.setArg(2, static_cast<cl_ulong>(blocks_per_replication));
                 ASSERT_CL(err)     
 
-                cl::CommandQueue readQueue(*config.context, *config.device, 0, &err);
+                cl::CommandQueue readQueue(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
                 ASSERT_CL(err)
-                cl::CommandQueue writeQueue(*config.context, *config.device, 0, &err);
+                cl::CommandQueue writeQueue(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
                 ASSERT_CL(err)
 
                 readCommandQueueList.push_back(readQueue);
@@ -163,7 +163,8 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
         std::vector<double> transferTimings;
         std::vector<double> calculationTimings;
 
-        for (int repetition = 0; repetition < config.programSettings->numRepetitions; repetition++) {
+        config.repetitions->start(*config.programSettings);
+        for (int repetition = 0; config.repetitions->next(calculationTimings); repetition++) {
 
             auto startTransfer = std::chrono::high_resolution_clock::now();
             size_t bufferOffset = 0;
@@ -186,9 +187,9 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
         #else
                 for (int r = 0; r < transposeReadKernelList.size(); r++) {
                         readCommandQueueList[r].enqueueWriteBuffer(bufferListA[r], CL_FALSE, 0,
-                                                bufferSizeList[r]* sizeof(HOST_DATA_TYPE), &data.A[bufferOffset]);
+                                                bufferSizeList[r]* sizeof(HOST_DATA_TYPE), &data.A[bufferOffset], nullptr, config.profiler->event("write_A"));
                         writeCommandQueueList[r].enqueueWriteBuffer(bufferListB[r], CL_FALSE, 0,
-                                                bufferSizeList[r]* sizeof(HOST_DATA_TYPE), &data.B[bufferOffset]);
+                                                bufferSizeList[r]* sizeof(HOST_DATA_TYPE), &data.B[bufferOffset], nullptr, config.profiler->event("write_B"));
                         bufferOffset += bufferSizeList[r];
                 }
         #endif
@@ -206,21 +207,21 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
             auto startCalculation = std::chrono::high_resolution_clock::now();
 #ifdef HOST_EMULATION_REORDER
             for (int r = 0; r < transposeReadKernelList.size(); r++) {
-                readCommandQueueList[r].enqueueNDRangeKernel(transposeReadKernelList[r], cl::NullRange, cl::NDRange(1));
+                readCommandQueueList[r].enqueueNDRangeKernel(transposeReadKernelList[r], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, config.profiler->event("transpose_read"));
             }
             for (int r = 0; r < transposeReadKernelList.size(); r++) {
                 readCommandQueueList[r].finish();
             }
             for (int r = 0; r < transposeReadKernelList.size(); r++) {
-                writeCommandQueueList[r].enqueueNDRangeKernel(transposeWriteKernelList[r], cl::NullRange, cl::NDRange(1));
+                writeCommandQueueList[r].enqueueNDRangeKernel(transposeWriteKernelList[r], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, config.profiler->event("transpose_write"));
             }
             for (int r = 0; r < transposeReadKernelList.size(); r++) {
                 writeCommandQueueList[r].finish();
             }
 #else
             for (int r = 0; r < transposeReadKernelList.size(); r++) {
-                writeCommandQueueList[r].enqueueNDRangeKernel(transposeWriteKernelList[r], cl::NullRange, cl::NDRange(1));
-                readCommandQueueList[r].enqueueNDRangeKernel(transposeReadKernelList[r], cl::NullRange, cl::NDRange(1));
+                writeCommandQueueList[r].enqueueNDRangeKernel(transposeWriteKernelList[r], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, config.profiler->event("transpose_write"));
+                readCommandQueueList[r].enqueueNDRangeKernel(transposeReadKernelList[r], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, config.profiler->event("transpose_read"));
             }
             for (int r = 0; r < transposeReadKernelList.size(); r++) {
                 writeCommandQueueList[r].finish();
@@ -253,7 +254,7 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
         #else
                 for (int r = 0; r < transposeReadKernelList.size(); r++) {
                         writeCommandQueueList[r].enqueueReadBuffer(bufferListA_out[r], CL_TRUE, 0,
-                                                bufferSizeList[r]* sizeof(HOST_DATA_TYPE), &data.result[bufferOffset]);
+                                                bufferSizeList[r]* sizeof(HOST_DATA_TYPE), &data.result[bufferOffset], nullptr, config.profiler->event("read_A_out"));
                         bufferOffset += bufferSizeList[r];
                 }
         #endif
@@ -263,6 +264,8 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
                             (endTransfer - startTransfer);
             transferTimings.push_back(transferTime.count());
         }
+        config.repetitions->discardWarmup(calculationTimings);
+        config.repetitions->discardWarmup(transferTimings);
 
         std::unique_ptr<transpose::TransposeExecutionTimings> result(new transpose::TransposeExecutionTimings{
                 transferTimings,
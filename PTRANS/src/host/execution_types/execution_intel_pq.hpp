@@ -179,9 +179,9 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
                 err = transposeReadKernel.setArg(4, static_cast<cl_ulong>(blocks_per_replication));
                 ASSERT_CL(err)     
 
-                cl::CommandQueue readQueue(*config.context, *config.device, 0, &err);
+                cl::CommandQueue readQueue(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
                 ASSERT_CL(err)
-                cl::CommandQueue writeQueue(*config.context, *config.device, 0, &err);
+                cl::CommandQueue writeQueue(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
                 ASSERT_CL(err)
 
                 readCommandQueueList.push_back(readQueue);
@@ -196,13 +196,14 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
         std::vector<double> transferTimings;
         std::vector<double> calculationTimings;
 
-        for (int repetition = 0; repetition < config.programSettings->numRepetitions; repetition++) {
+        config.repetitions->start(*config.programSettings);
+        for (int repetition = 0; config.repetitions->next(calculationTimings); repetition++) {
 
             auto startTransfer = std::chrono::high_resolution_clock::now();
 
         for (int r = 0; r < transposeReadKernelList.size(); r++) {
                 writeCommandQueueList[r].enqueueWriteBuffer(bufferListB[r], CL_FALSE, 0,
-                                        bufferSizeList[r]* sizeof(HOST_DATA_TYPE), &data.B[bufferStartList[r] * data.blockSize * data.blockSize]);
+                                        bufferSizeList[r]* sizeof(HOST_DATA_TYPE), &data.B[bufferStartList[r] * data.blockSize * data.blockSize], nullptr, config.profiler->event("write_B"));
 #ifdef USE_BUFFER_WRITE_RECT_FOR_A
 #ifndef USE_DEPRECATED_HPP_HEADER
                 cl::array<size_t,3> deviceOffset;
@@ -228,10 +229,10 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
                                                 rectShape,
                                                 (bufferSizeList[r]) / (local_matrix_width * data.blockSize) * sizeof(HOST_DATA_TYPE), 0,
                                                 local_matrix_width* data.blockSize*sizeof(HOST_DATA_TYPE), 0,
-                                                data.A);
+                                                data.A, nullptr, config.profiler->event("write_A"));
 #else
                 readCommandQueueList[r].enqueueWriteBuffer(bufferListA[r], CL_FALSE, 0,
-                                        data.numBlocks * data.blockSize * data.blockSize * sizeof(HOST_DATA_TYPE), data.A);
+                                        data.numBlocks * data.blockSize * data.blockSize * sizeof(HOST_DATA_TYPE), data.A, nullptr, config.profiler->event("write_A"));
 #endif
 
         }
@@ -256,7 +257,7 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
                 // If current rank, start sending to the channels
                 if (k == mpi_rank) {
                         for (int r = 0; r < transposeReadKernelList.size(); r++) {
-                                readCommandQueueList[r].enqueueNDRangeKernel(transposeReadKernelList[r], cl::NullRange, cl::NDRange(1));
+                                readCommandQueueList[r].enqueueNDRangeKernel(transposeReadKernelList[r], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, config.profiler->event("transpose_read"));
                         }
                         for (int r = 0; r < transposeReadKernelList.size(); r++) {
                                 readCommandQueueList[r].finish();
@@ -270,7 +271,7 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
                 // Only rank that has to receive the data starts receive kernel
                 if (receiver_rank == mpi_rank) {
                         for (int r = 0; r < transposeReadKernelList.size(); r++) {
-                                writeCommandQueueList[r].enqueueNDRangeKernel(transposeWriteKernelList[r], cl::NullRange, cl::NDRange(1));
+                                writeCommandQueueList[r].enqueueNDRangeKernel(transposeWriteKernelList[r], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, config.profiler->event("transpose_write"));
                         }
                         for (int r = 0; r < transposeReadKernelList.size(); r++) {
                                 writeCommandQueueList[r].finish();
@@ -288,8 +289,8 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
         }
 #else
             for (int r = 0; r < transposeReadKernelList.size(); r++) {
-                writeCommandQueueList[r].enqueueNDRangeKernel(transposeWriteKernelList[r], cl::NullRange, cl::NDRange(1));
-                readCommandQueueList[r].enqueueNDRangeKernel(transposeReadKernelList[r], cl::NullRange, cl::NDRange(1));
+                writeCommandQueueList[r].enqueueNDRangeKernel(transposeWriteKernelList[r], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, config.profiler->event("transpose_write"));
+                readCommandQueueList[r].enqueueNDRangeKernel(transposeReadKernelList[r], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, config.profiler->event("transpose_read"));
             }
             for (int r = 0; r < transposeReadKernelList.size(); r++) {
                 writeCommandQueueList[r].finish();
@@ -319,7 +320,7 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
                         // Copy possibly incomplete first block row
                         if (bufferOffsetList[r] != 0) {
                                 writeCommandQueueList[r].enqueueReadBuffer(bufferListA_out[r], CL_TRUE, 0,
-                                                bufferSizeList[r]* sizeof(HOST_DATA_TYPE), tmp_write_buffer.data());
+                                                bufferSizeList[r]* sizeof(HOST_DATA_TYPE), tmp_write_buffer.data(), nullptr, config.profiler->event("read_A_out"));
                                 writeCommandQueueList[r].finish();
                                 for (int row = 0; row < data.blockSize; row++) {
                                         for (int col = bufferOffsetList[r] * data.blockSize; col < local_matrix_width * data.blockSize; col++) {
@@ -332,7 +333,7 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
                         }
                         else {
                                 writeCommandQueueList[r].enqueueReadBuffer(bufferListA_out[r], CL_TRUE, 0,
-                                                         bufferSizeList[r]* sizeof(HOST_DATA_TYPE), &data.result[bufferStartList[r] * data.blockSize * data.blockSize]);
+                                                         bufferSizeList[r]* sizeof(HOST_DATA_TYPE), &data.result[bufferStartList[r] * data.blockSize * data.blockSize], nullptr, config.profiler->event("read_A_out"));
                                 writeCommandQueueList[r].finish();
                         }
                 }
@@ -342,6 +343,8 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
                             (endTransfer - startTransfer);
             transferTimings.push_back(transferTime.count());
         }
+        config.repetitions->discardWarmup(calculationTimings);
+        config.repetitions->discardWarmup(transferTimings);
 
         std::unique_ptr<transpose::TransposeExecutionTimings> result(new transpose::TransposeExecutionTimings{
                 transferTimings,
@@ -32,6 +32,7 @@ SOFTWARE.
 
 /* Project's headers */
 #include "data_handlers/handler.hpp"
+#include "trace_region.hpp"
 
 namespace transpose
 {
@@ -53,14 +54,12 @@ namespace transpose
             {
                 int err;
 
-#ifdef USE_SVM
-                throw new std::runtime_error("SVM not supported in the host implementation of this communication method");
-#endif
                 if (config.programSettings->dataHandlerIdentifier != transpose::data_handler::DataHandlerType::diagonal) {
                         throw std::runtime_error("Used data handler not supported by execution handler!");
                 }
 
                 std::vector<size_t> bufferSizeList;
+                std::vector<size_t> bufferStartList;
                 std::vector<cl::Buffer> bufferListA;
                 std::vector<cl::Buffer> bufferListB;
                 std::vector<cl::Buffer> bufferListA_out;
@@ -68,6 +67,7 @@ namespace transpose
                 std::vector<cl::CommandQueue> transCommandQueueList;
 
                 size_t local_matrix_width = std::sqrt(data.numBlocks);
+                size_t total_offset = 0;
 
                 // Setup the kernels depending on the number of kernel replications
                 for (int r = 0; r < config.programSettings->kernelReplications; r++)
@@ -89,6 +89,8 @@ namespace transpose
                     size_t buffer_size = data.blockSize * (data.blockSize * blocks_per_replication);
 
                     bufferSizeList.push_back(buffer_size);
+                    bufferStartList.push_back(total_offset);
+                    total_offset += buffer_size;
 
                     int memory_bank_info_a = 0;
                     int memory_bank_info_b = 0;
@@ -111,41 +113,76 @@ namespace transpose
                         }
                     }
 #endif
+#ifndef USE_SVM
                     cl::Buffer bufferA(*config.context, CL_MEM_READ_ONLY | memory_bank_info_a,
                                buffer_size * sizeof(HOST_DATA_TYPE));
                     cl::Buffer bufferB(*config.context, CL_MEM_READ_ONLY | memory_bank_info_b,
                                buffer_size * sizeof(HOST_DATA_TYPE));
                     cl::Buffer bufferA_out(*config.context, CL_MEM_WRITE_ONLY | memory_bank_info_out,
                                    buffer_size * sizeof(HOST_DATA_TYPE));
+#endif
 
                     // TODO the kernel name may need to be changed for Xilinx support
                     cl::Kernel transposeKernel(*config.program, ("transpose" + std::to_string(r)).c_str(), &err);
                     ASSERT_CL(err)
 
-
+#ifdef USE_SVM
+                    // The pointer to A changes with every exchange, so it is set before every kernel execution
+                    err = clSetKernelArgSVMPointer(transposeKernel(), 1,
+                                                reinterpret_cast<void*>(&data.B[bufferStartList.back()]));
+                    ASSERT_CL(err)
+                    err = clSetKernelArgSVMPointer(transposeKernel(), 2,
+                                                reinterpret_cast<void*>(&data.result[bufferStartList.back()]));
+                    ASSERT_CL(err)
+#else
                     err = transposeKernel.setArg(0, bufferA);
                     ASSERT_CL(err)
                     err = transposeKernel.setArg(1, bufferB);
                     ASSERT_CL(err)
                     err = transposeKernel.setArg(2, bufferA_out);
                     ASSERT_CL(err)
+#endif
                     err = transposeKernel.setArg(3, static_cast<cl_uint>(blocks_per_replication));
                     ASSERT_CL(err)
 
-                    cl::CommandQueue transQueue(*config.context, *config.device, 0, &err);
+                    cl::CommandQueue transQueue(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
                     ASSERT_CL(err)
 
                     transCommandQueueList.push_back(transQueue);
+#ifndef USE_SVM
                     bufferListA.push_back(bufferA);
                     bufferListB.push_back(bufferB);
                     bufferListA_out.push_back(bufferA_out);
+#endif
                     transposeKernelList.push_back(transposeKernel);
                 }
 
+#ifdef USE_SVM
+                // The SVM buffers are mapped to the host except while the kernels are running, 
+                // so the MPI exchange writes directly into the memory the kernels read from
+                size_t svm_size = data.numBlocks * data.blockSize * data.blockSize * sizeof(HOST_DATA_TYPE);
+                auto map_svm = [&](std::vector<HOST_DATA_TYPE*> buffers) {
+                    for (auto buffer : buffers) {
+                        err = clEnqueueSVMMap(transCommandQueueList[0](), CL_TRUE, CL_MAP_READ | CL_MAP_WRITE,
+                                        reinterpret_cast<void*>(buffer), svm_size, 0, NULL, NULL);
+                        ASSERT_CL(err)
+                    }
+                };
+                auto unmap_svm = [&](std::vector<HOST_DATA_TYPE*> buffers) {
+                    for (auto buffer : buffers) {
+                        err = clEnqueueSVMUnmap(transCommandQueueList[0](), reinterpret_cast<void*>(buffer), 0, NULL, NULL);
+                        ASSERT_CL(err)
+                    }
+                    transCommandQueueList[0].finish();
+                };
+                map_svm({data.A, data.B, data.result, data.exchange});
+#endif
+
                 std::vector<double> transferTimings;
                 std::vector<double> calculationTimings;
 
-                for (int repetition = 0; repetition < config.programSettings->numRepetitions; repetition++)
+                config.repetitions->start(*config.programSettings);
+                for (int repetition = 0; config.repetitions->next(calculationTimings); repetition++)
                 {
 
                     MPI_Barrier(MPI_COMM_WORLD);
@@ -153,14 +190,17 @@ namespace transpose
                     auto startTransfer = std::chrono::high_resolution_clock::now();
                     size_t bufferOffset = 0;
 
+#ifndef USE_SVM
                     for (int r = 0; r < transposeKernelList.size(); r++)
                     {
+                        HPCC_TRACE_REGION("write to device");
                         transCommandQueueList[r].enqueueWriteBuffer(bufferListB[r], CL_TRUE, 0,
-                                              bufferSizeList[r] * sizeof(HOST_DATA_TYPE), &data.B[bufferOffset]);
+                                              bufferSizeList[r] * sizeof(HOST_DATA_TYPE), &data.B[bufferOffset], nullptr, config.profiler->event("write_B"));
                         transCommandQueueList[r].enqueueWriteBuffer(bufferListA[r], CL_TRUE, 0,
-                                              bufferSizeList[r] * sizeof(HOST_DATA_TYPE), &data.A[bufferOffset]);
+                                              bufferSizeList[r] * sizeof(HOST_DATA_TYPE), &data.A[bufferOffset], nullptr, config.profiler->event("write_A"));
                         bufferOffset += bufferSizeList[r];
                     }
+#endif
 
                     auto endTransfer = std::chrono::high_resolution_clock::now();
                     std::chrono::duration<double> transferTime =
@@ -169,33 +209,50 @@ namespace transpose
                     MPI_Barrier(MPI_COMM_WORLD);
 
                     auto startCalculation = std::chrono::high_resolution_clock::now();
+#ifndef USE_SVM
                     bufferOffset = 0;
                     for (int r = 0; r < transposeKernelList.size(); r++)
                     {
+                        HPCC_TRACE_REGION("read from device");
                         transCommandQueueList[r].enqueueReadBuffer(bufferListA[r], CL_TRUE, 0,
-                                               bufferSizeList[r] * sizeof(HOST_DATA_TYPE), &data.A[bufferOffset]);
+                                               bufferSizeList[r] * sizeof(HOST_DATA_TYPE), &data.A[bufferOffset], nullptr, config.profiler->event("read_A"));
                         bufferOffset += bufferSizeList[r];
                     }
+#endif
 
                     // Exchange A data via PCIe and MPI
                     handler.exchangeData(data);
 
+#ifdef USE_SVM
+                    for (int r = 0; r < transposeKernelList.size(); r++)
+                    {
+                        err = clSetKernelArgSVMPointer(transposeKernelList[r](), 0,
+                                                reinterpret_cast<void*>(&data.A[bufferStartList[r]]));
+                        ASSERT_CL(err)
+                    }
+                    unmap_svm({data.A, data.B, data.result});
+#else
                     bufferOffset = 0;
                     for (int r = 0; r < transposeKernelList.size(); r++)
                     {
+                        HPCC_TRACE_REGION("write to device");
                         transCommandQueueList[r].enqueueWriteBuffer(bufferListA[r], CL_FALSE, 0,
-                                                bufferSizeList[r] * sizeof(HOST_DATA_TYPE), &data.A[bufferOffset]);
+                                                bufferSizeList[r] * sizeof(HOST_DATA_TYPE), &data.A[bufferOffset], nullptr, config.profiler->event("write_A"));
                         bufferOffset += bufferSizeList[r];
                     }
+#endif
 
                     for (int r = 0; r < transposeKernelList.size(); r++)
                     {
-                        transCommandQueueList[r].enqueueNDRangeKernel(transposeKernelList[r], cl::NullRange, cl::NDRange(1));
+                        transCommandQueueList[r].enqueueNDRangeKernel(transposeKernelList[r], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, config.profiler->event("transpose"));
                     }
                     for (int r = 0; r < transposeKernelList.size(); r++)
                     {
                         transCommandQueueList[r].finish();
                     }
+#ifdef USE_SVM
+                    map_svm({data.A, data.B, data.result});
+#endif
 
                     auto endCalculation = std::chrono::high_resolution_clock::now();
 #ifndef NDEBUG
@@ -214,18 +271,23 @@ namespace transpose
                     bufferOffset = 0;
                     startTransfer = std::chrono::high_resolution_clock::now();
 
+#ifndef USE_SVM
                     for (int r = 0; r < transposeKernelList.size(); r++)
                     {
+                        HPCC_TRACE_REGION("read from device");
                         transCommandQueueList[r].enqueueReadBuffer(bufferListA_out[r], CL_TRUE, 0,
-                                               bufferSizeList[r] * sizeof(HOST_DATA_TYPE), &data.result[bufferOffset]);
+                                               bufferSizeList[r] * sizeof(HOST_DATA_TYPE), &data.result[bufferOffset], nullptr, config.profiler->event("read_A_out"));
                         bufferOffset += bufferSizeList[r];
                     }
+#endif
 
                     endTransfer = std::chrono::high_resolution_clock::now();
                     transferTime +=
                         std::chrono::duration_cast<std::chrono::duration<double>>(endTransfer - startTransfer);
                     transferTimings.push_back(transferTime.count());
                 }
+                config.repetitions->discardWarmup(calculationTimings);
+                config.repetitions->discardWarmup(transferTimings);
 
                 std::unique_ptr<transpose::TransposeExecutionTimings> result(new transpose::TransposeExecutionTimings{
                     transferTimings,
@@ -31,6 +31,7 @@ SOFTWARE.
 #include "transpose_benchmark.hpp"
 #include "data_handlers/data_handler_types.h"
 #include "data_handlers/pq.hpp"
+#include "trace_region.hpp"
 
 namespace transpose {
 namespace fpga_execution {
@@ -52,7 +53,9 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
                 throw std::runtime_error("Used data handler not supported by execution handler!");
         }
 #ifdef USE_SVM
-        throw new std::runtime_error("SVM not supported in the host implementation of this communication method");
+        if (data.leanMemory) {
+                throw std::runtime_error("Lean memory mode is not supported with SVM!");
+        }
 #endif
 
         std::vector<size_t> bufferSizeList;
@@ -66,7 +69,8 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
 
         size_t local_matrix_width = handler.getWidthforRank();
         size_t local_matrix_height = handler.getHeightforRank();
-        size_t local_matrix_width_bytes = local_matrix_width * data.blockSize * sizeof(HOST_DATA_TYPE);
+        // Row pitch of the exchanged matrix A, which contains local_matrix_width x local_matrix_height blocks
+        size_t exchanged_matrix_width_bytes = local_matrix_height * data.blockSize * sizeof(HOST_DATA_TYPE);
 
         size_t total_offset = 0;
         size_t row_offset = 0;
@@ -112,6 +116,7 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
                         }
                 }
 #endif
+#ifndef USE_SVM
 #ifdef USE_BUFFER_WRITE_RECT_FOR_A
                 cl::Buffer bufferA(*config.context, CL_MEM_READ_ONLY | memory_bank_info_a,
                                 buffer_size * sizeof(HOST_DATA_TYPE));
@@ -121,8 +126,10 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
 #endif
                 cl::Buffer bufferB(*config.context, CL_MEM_READ_ONLY | memory_bank_info_b,
                                 buffer_size * sizeof(HOST_DATA_TYPE));
+                // The result needs its own buffer also in lean memory mode, since B and A_out are restrict arguments of the kernel
                 cl::Buffer bufferA_out(*config.context, CL_MEM_WRITE_ONLY | memory_bank_info_out,
                                 buffer_size * sizeof(HOST_DATA_TYPE));
+#endif
 
 #ifdef INTEL_FPGA
                 cl::Kernel transposeKernel(*config.program, ("transpose" + std::to_string(r)).c_str(), &err);
@@ -135,17 +142,28 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
         ASSERT_CL(err);
 #endif
 
+#ifdef USE_SVM
+                // The kernels directly access the whole matrix A in SVM. 
+                // The pointer to A changes with every exchange, so it is set before every kernel execution
+                err = clSetKernelArgSVMPointer(transposeKernel(), 1,
+                                                reinterpret_cast<void*>(&data.B[bufferStartList[r] * data.blockSize * data.blockSize]));
+                ASSERT_CL(err)
+                err = clSetKernelArgSVMPointer(transposeKernel(), 2,
+                                                reinterpret_cast<void*>(&data.result[bufferStartList[r] * data.blockSize * data.blockSize]));
+                ASSERT_CL(err)
+#else
                 err = transposeKernel.setArg(0, bufferA);
                 ASSERT_CL(err)
                 err = transposeKernel.setArg(1, bufferB);
                 ASSERT_CL(err)
                 err = transposeKernel.setArg(2, bufferA_out);
                 ASSERT_CL(err)
+#endif
                 err = transposeKernel.setArg(5, static_cast<cl_uint>(blocks_per_replication));
                 ASSERT_CL(err)
                 err = transposeKernel.setArg(6, static_cast<cl_uint>(handler.getWidthforRank()));
                 ASSERT_CL(err)
-#ifndef USE_BUFFER_WRITE_RECT_FOR_A
+#if !defined(USE_BUFFER_WRITE_RECT_FOR_A) || defined(USE_SVM)
                 err = transposeKernel.setArg(7, static_cast<cl_uint>(handler.getHeightforRank()));
                 ASSERT_CL(err) 
                 err = transposeKernel.setArg(3, static_cast<cl_uint>(bufferStartList[r] + bufferOffsetList[r]));
@@ -162,26 +180,52 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
 #endif
  
 
-                cl::CommandQueue transQueue(*config.context, *config.device, 0, &err);
+                cl::CommandQueue transQueue(*config.context, *config.device, config.profiler->getQueueProperties(), &err);
                 ASSERT_CL(err)
 
                 transCommandQueueList.push_back(transQueue);
+#ifndef USE_SVM
                 bufferListA.push_back(bufferA);
                 bufferListB.push_back(bufferB);
                 bufferListA_out.push_back(bufferA_out);
+#endif
                 transposeKernelList.push_back(transposeKernel);
         }
 
+#ifdef USE_SVM
+        // The SVM buffers are mapped to the host except while the kernels are running, 
+        // so the MPI exchange writes directly into the memory the kernels read from
+        size_t svm_size = data.numBlocks * data.blockSize * data.blockSize * sizeof(HOST_DATA_TYPE);
+        auto map_svm = [&](std::vector<HOST_DATA_TYPE*> buffers) {
+                for (auto buffer : buffers) {
+                        err = clEnqueueSVMMap(transCommandQueueList[0](), CL_TRUE, CL_MAP_READ | CL_MAP_WRITE,
+                                        reinterpret_cast<void*>(buffer), svm_size, 0, NULL, NULL);
+                        ASSERT_CL(err)
+                }
+        };
+        auto unmap_svm = [&](std::vector<HOST_DATA_TYPE*> buffers) {
+                for (auto buffer : buffers) {
+                        err = clEnqueueSVMUnmap(transCommandQueueList[0](), reinterpret_cast<void*>(buffer), 0, NULL, NULL);
+                        ASSERT_CL(err)
+                }
+                transCommandQueueList[0].finish();
+        };
+        map_svm({data.A, data.B, data.result, data.exchange});
+#endif
+
         std::vector<double> transferTimings;
         std::vector<double> calculationTimings;
 
-        for (int repetition = 0; repetition < config.programSettings->numRepetitions; repetition++) {
+        config.repetitions->start(*config.programSettings);
+        for (int repetition = 0; config.repetitions->next(calculationTimings); repetition++) {
 
             auto startTransfer = std::chrono::high_resolution_clock::now();
 
+#ifndef USE_SVM
         for (int r = 0; r < transposeKernelList.size(); r++) {
+                HPCC_TRACE_REGION("write to device");
                 transCommandQueueList[r].enqueueWriteBuffer(bufferListB[r], CL_FALSE, 0,
-                                        bufferSizeList[r]* sizeof(HOST_DATA_TYPE), &data.B[bufferStartList[r] * data.blockSize * data.blockSize]);
+                                        bufferSizeList[r]* sizeof(HOST_DATA_TYPE), &data.B[bufferStartList[r] * data.blockSize * data.blockSize], nullptr, config.profiler->event("write_B"));
 #ifdef USE_BUFFER_WRITE_RECT_FOR_A
 #ifndef USE_DEPRECATED_HPP_HEADER
                 cl::array<size_t,3> deviceOffset;
@@ -206,14 +250,15 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
                                                 hostOffset, 
                                                 rectShape,
                                                 (bufferSizeList[r]) / (local_matrix_width * data.blockSize) * sizeof(HOST_DATA_TYPE), 0,
-                                                local_matrix_width* data.blockSize*sizeof(HOST_DATA_TYPE), 0,
-                                                data.A);
+                                                exchanged_matrix_width_bytes, 0,
+                                                data.A, nullptr, config.profiler->event("write_A"));
 #else
                 transCommandQueueList[r].enqueueWriteBuffer(bufferListA[r], CL_FALSE, 0,
-                                        data.numBlocks * data.blockSize * data.blockSize * sizeof(HOST_DATA_TYPE), data.A);
+                                        data.numBlocks * data.blockSize * data.blockSize * sizeof(HOST_DATA_TYPE), data.A, nullptr, config.profiler->event("write_A"));
 #endif
 
         }
+#endif
             for (int r = 0; r < transposeKernelList.size(); r++) {
                 transCommandQueueList[r].finish();
             }
@@ -227,6 +272,17 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
 
             auto startCalculation = std::chrono::high_resolution_clock::now();
 
+#ifdef USE_SVM
+        // Exchange A data via MPI directly in the shared memory
+        handler.exchangeData(data);
+
+        for (int r = 0; r < transposeKernelList.size(); r++)
+        {
+                err = clSetKernelArgSVMPointer(transposeKernelList[r](), 0, reinterpret_cast<void*>(data.A));
+                ASSERT_CL(err)
+        }
+        unmap_svm({data.A, data.B, data.result});
+#else
         for (int r = 0; r < transposeKernelList.size(); r++)
         {
 #ifdef USE_BUFFER_WRITE_RECT_FOR_A
@@ -253,54 +309,62 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
                                                 hostOffset, 
                                                 rectShape,
                                                 (bufferSizeList[r]) / (local_matrix_width * data.blockSize) * sizeof(HOST_DATA_TYPE), 0,
-                                                local_matrix_width* data.blockSize*sizeof(HOST_DATA_TYPE), 0,
-                                                data.A);
+                                                exchanged_matrix_width_bytes, 0,
+                                                data.A, nullptr, config.profiler->event("read_A"));
 #else
                 transCommandQueueList[r].enqueueReadBuffer(bufferListA[r], CL_FALSE, 0,
-                                        data.numBlocks * data.blockSize * data.blockSize * sizeof(HOST_DATA_TYPE), data.A);
+                                        data.numBlocks * data.blockSize * data.blockSize * sizeof(HOST_DATA_TYPE), data.A, nullptr, config.profiler->event("read_A"));
 #endif
         }
 
 
-        // Exchange A data via PCIe and MPI
-        handler.exchangeData(data);
-
-        std::vector<std::vector<cl::Event>> copy_events(transposeKernelList.size());
-
-        for (int r = 0; r < transposeKernelList.size(); r++)
-        {
-                copy_events[r].emplace_back();
-#ifdef USE_BUFFER_WRITE_RECT_FOR_A
+        // Exchange A data via PCIe and MPI.
+        // Every block is written to the kernel replications that need it as soon as it is received
+        handler.exchangeData(data, [&](size_t block_row, size_t block_col, const HOST_DATA_TYPE* matrix) {
+                for (int r = 0; r < transposeKernelList.size(); r++)
+                {
 #ifndef USE_DEPRECATED_HPP_HEADER
-                cl::array<size_t,3> deviceOffset;
-                cl::array<size_t,3> hostOffset;
-                cl::array<size_t,3> rectShape;
+                        cl::array<size_t,3> deviceOffset;
+                        cl::array<size_t,3> hostOffset;
+                        cl::array<size_t,3> rectShape;
 #else
-                cl::size_t<3> deviceOffset;
-                cl::size_t<3> hostOffset;
-                cl::size_t<3> rectShape;
+                        cl::size_t<3> deviceOffset;
+                        cl::size_t<3> hostOffset;
+                        cl::size_t<3> rectShape;
 #endif
-                deviceOffset[0] = 0;
-                deviceOffset[1] = 0;
-                deviceOffset[2] = 0;
-                hostOffset[0] = (bufferStartList[r]) / local_matrix_width * data.blockSize * sizeof(HOST_DATA_TYPE);
-                hostOffset[1] = 0;
-                hostOffset[2] = 0;
-                rectShape[0] = (bufferSizeList[r]) / (local_matrix_width * data.blockSize) * sizeof(HOST_DATA_TYPE);
-                rectShape[1] = local_matrix_width* data.blockSize;
-                rectShape[2] = 1L;
-                transCommandQueueList[r].enqueueWriteBufferRect(bufferListA[r],CL_FALSE, 
-                                                deviceOffset, 
-                                                hostOffset, 
-                                                rectShape,
-                                                (bufferSizeList[r]) / (local_matrix_width * data.blockSize) * sizeof(HOST_DATA_TYPE), 0,
-                                                local_matrix_width* data.blockSize*sizeof(HOST_DATA_TYPE), 0,
-                                                data.A);
+#ifdef USE_BUFFER_WRITE_RECT_FOR_A
+                        // The buffer of a replication only contains the block columns of A it needs
+                        size_t first_block_col = bufferStartList[r] / local_matrix_width;
+                        size_t num_block_cols = bufferSizeList[r] / (local_matrix_width * data.blockSize * data.blockSize);
+                        if (block_col < first_block_col || block_col >= first_block_col + num_block_cols) {
+                                continue;
+                        }
+                        size_t device_row_pitch = num_block_cols * data.blockSize * sizeof(HOST_DATA_TYPE);
+                        deviceOffset[0] = (block_col - first_block_col) * data.blockSize * sizeof(HOST_DATA_TYPE);
 #else
-                transCommandQueueList[r].enqueueWriteBuffer(bufferListA[r], CL_FALSE, 0,
-                                        data.numBlocks * data.blockSize * data.blockSize * sizeof(HOST_DATA_TYPE), data.A, NULL, &copy_events[r][0]);
+                        size_t device_row_pitch = exchanged_matrix_width_bytes;
+                        deviceOffset[0] = block_col * data.blockSize * sizeof(HOST_DATA_TYPE);
 #endif
-        }
+                        deviceOffset[1] = block_row * data.blockSize;
+                        deviceOffset[2] = 0;
+                        hostOffset[0] = block_col * data.blockSize * sizeof(HOST_DATA_TYPE);
+                        hostOffset[1] = block_row * data.blockSize;
+                        hostOffset[2] = 0;
+                        rectShape[0] = data.blockSize * sizeof(HOST_DATA_TYPE);
+                        rectShape[1] = data.blockSize;
+                        rectShape[2] = 1L;
+                        transCommandQueueList[r].enqueueWriteBufferRect(bufferListA[r],CL_FALSE, 
+                                                        deviceOffset, 
+                                                        hostOffset, 
+                                                        rectShape,
+                                                        device_row_pitch, 0,
+                                                        exchanged_matrix_width_bytes, 0,
+                                                        matrix, nullptr, config.profiler->event("write_A"));
+                        transCommandQueueList[r].flush();
+                }
+        });
+#endif
+
 #ifndef NDEBUG
         for (int r = 0; r < transposeKernelList.size(); r++)
         {
@@ -310,12 +374,16 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
 #endif
         for (int r = 0; r < transposeKernelList.size(); r++)
         {
-        transCommandQueueList[r].enqueueNDRangeKernel(transposeKernelList[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1), &copy_events[r]);
+        // The queues are in-order, so the kernels start after all blocks of A are written
+        transCommandQueueList[r].enqueueNDRangeKernel(transposeKernelList[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1), nullptr, config.profiler->event("transpose"));
         }
         for (int r = 0; r < transposeKernelList.size(); r++)
         {
         transCommandQueueList[r].finish();
         }
+#ifdef USE_SVM
+        map_svm({data.A, data.B, data.result});
+#endif
             auto endCalculation = std::chrono::high_resolution_clock::now();
 #ifndef NDEBUG
                 int mpi_rank;
@@ -334,15 +402,17 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
                             (endCalculation - startCalculation);
             calculationTimings.push_back(calculationTime.count());
 
-            std::vector<HOST_DATA_TYPE> tmp_write_buffer(local_matrix_height * local_matrix_width * data.blockSize * data.blockSize); 
-
             startTransfer = std::chrono::high_resolution_clock::now();
 
+#ifndef USE_SVM
+            std::vector<HOST_DATA_TYPE> tmp_write_buffer(local_matrix_height * local_matrix_width * data.blockSize * data.blockSize); 
+
                 for (int r = 0; r < transposeKernelList.size(); r++) {
+                        HPCC_TRACE_REGION("read from device");
                         // Copy possibly incomplete first block row
                         if (bufferOffsetList[r] != 0) {
                                 transCommandQueueList[r].enqueueReadBuffer(bufferListA_out[r], CL_TRUE, 0,
-                                                bufferSizeList[r]* sizeof(HOST_DATA_TYPE), tmp_write_buffer.data());
+                                                bufferSizeList[r]* sizeof(HOST_DATA_TYPE), tmp_write_buffer.data(), nullptr, config.profiler->event("read_A_out"));
                                 transCommandQueueList[r].finish();
                                 for (int row = 0; row < data.blockSize; row++) {
                                         for (int col = bufferOffsetList[r] * data.blockSize; col < local_matrix_width * data.blockSize; col++) {
@@ -355,16 +425,19 @@ static  std::unique_ptr<transpose::TransposeExecutionTimings>
                         }
                         else {
                                 transCommandQueueList[r].enqueueReadBuffer(bufferListA_out[r], CL_TRUE, 0,
-                                                         bufferSizeList[r]* sizeof(HOST_DATA_TYPE), &data.result[bufferStartList[r] * data.blockSize * data.blockSize]);
+                                                         bufferSizeList[r]* sizeof(HOST_DATA_TYPE), &data.result[bufferStartList[r] * data.blockSize * data.blockSize], nullptr, config.profiler->event("read_A_out"));
                                 transCommandQueueList[r].finish();
                         }
                 }
+#endif
             endTransfer = std::chrono::high_resolution_clock::now();
             transferTime +=
                     std::chrono::duration_cast<std::chrono::duration<double>>
                             (endTransfer - startTransfer);
             transferTimings.push_back(transferTime.count());
         }
+        config.repetitions->discardWarmup(calculationTimings);
+        config.repetitions->discardWarmup(transferTimings);
 
         std::unique_ptr<transpose::TransposeExecutionTimings> result(new transpose::TransposeExecutionTimings{
                 transferTimings,
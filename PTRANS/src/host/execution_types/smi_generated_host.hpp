@@ -0,0 +1,49 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SRC_HOST_EXECUTION_TYPES_SMI_GENERATED_HOST_HPP
+#define SRC_HOST_EXECUTION_TYPES_SMI_GENERATED_HOST_HPP
+
+/* C++ standard library headers */
+#include <vector>
+
+/* External library headers */
+#include OPENCL_HPP_HEADER
+#include "smi/communicator.h"
+
+/**
+ * @brief Load the routing tables and start the SMI transport kernels of the kernel transpose_PQ_SMI.
+ *          The function is defined in smi_generated_host.c, which is generated by the SMI code generator and compiled
+ *          together with the host code.
+ *
+ * @param rank The MPI rank of this process
+ * @param ranks_count The number of MPI ranks
+ * @param routing_dir Directory that contains the routing tables
+ * @param context The OpenCL context
+ * @param program The program that contains the kernels and the transport kernels
+ * @param buffers Device buffers that hold the routing tables. They have to be kept until all kernels finished
+ * @return SMI_Comm The communicator that is passed to the kernels
+ */
+SMI_Comm
+SmiInit_transpose_PQ_SMI(int rank, int ranks_count, const char* routing_dir, cl::Context &context, cl::Program &program,
+                            std::vector<cl::Buffer> &buffers);
+
+#endif
@@ -27,8 +27,10 @@ SOFTWARE.
 #include "transpose_benchmark.hpp"
 
 /* C++ standard library headers */
+#include <cmath>
 #include <memory>
 #include <random>
+#include <limits>
 
 /* Project's headers */
 #include "execution_types/execution_intel.hpp"
@@ -36,21 +38,33 @@ SOFTWARE.
 #include "execution_types/execution_pcie.hpp"
 #include "execution_types/execution_pcie_pq.hpp"
 #include "execution_types/execution_cpu.hpp"
+#ifdef USE_SMI
+#include "execution_types/execution_smi_pq.hpp"
+#endif
 #include "communication_types.hpp"
 
 #include "data_handlers/data_handler_types.h"
 #include "data_handlers/diagonal.hpp"
 #include "data_handlers/pq.hpp"
 
+#include "hpcc_suite.hpp"
 #include "parameters.h"
 
 
 transpose::TransposeBenchmark::TransposeBenchmark(int argc, char* argv[]) : HpccFpgaBenchmark(argc, argv) {
     if (setupBenchmark(argc, argv)) {
         setTransposeDataHandler(executionSettings->programSettings->dataHandlerIdentifier);
+        if (executionSettings->programSettings->autotune && !executionSettings->programSettings->testOnly) {
+            autotune();
+        }
     }
 }
 
+hpcc_base::suite::BenchmarkResult
+transpose::runSuiteBenchmark(int argc, char* argv[]) {
+    return hpcc_base::suite::runBenchmark<transpose::TransposeBenchmark>(argc, argv);
+}
+
 void
 transpose::TransposeBenchmark::addAdditionalParseOptions(cxxopts::Options &options) {
     options.add_options()
@@ -61,8 +75,12 @@ transpose::TransposeBenchmark::addAdditionalParseOptions(cxxopts::Options &optio
         ("p", "Value of P that equals the width of the PQ grid of FPGAs. Q is determined by the world size.",
             cxxopts::value<uint>()->default_value(std::to_string(DEFAULT_P_VALUE)))
         ("distribute-buffers", "Distribute buffers over memory banks. This will use three memory banks instead of one for a single kernel replication, but kernel replications may interfere. This is an Intel only attribute, since buffer placement is decided at compile time for Xilinx FPGAs.")
+        ("autotune", "Select the value of P and the buffer distribution with the lowest execution time with short probe executions before the benchmark is executed")
+        ("lean-memory", "Do not allocate a host buffer for the data exchange. This allows larger matrices. Only supported by the PQ data handler with PCIe communication.")
         ("handler", "Specify the used data handler that distributes the data over devices and memory banks",
-            cxxopts::value<std::string>()->default_value(DEFAULT_DIST_TYPE));
+            cxxopts::value<std::string>()->default_value(DEFAULT_DIST_TYPE))
+        ("smi-routes", "Directory that contains the routing tables generated by SMI for the used topology. Only used by the SMI communication type",
+            cxxopts::value<std::string>()->default_value("smi-routes"));
 }
 
 std::unique_ptr<transpose::TransposeExecutionTimings>
@@ -82,8 +100,9 @@ transpose::TransposeBenchmark::executeKernel(TransposeData &data) {
                                 else {
                                     return transpose::fpga_execution::pcie_pq::calculate(*executionSettings, data, reinterpret_cast<transpose::data_handler::DistributedPQTransposeDataHandler&>(*dataHandler));
                                 } break;
-#ifdef MKL_FOUND
         case hpcc_base::CommunicationType::cpu_only : return transpose::fpga_execution::cpu::calculate(*executionSettings, data, *dataHandler); break;
+#ifdef USE_SMI
+        case hpcc_base::CommunicationType::smi : return transpose::fpga_execution::smi_pq::calculate(*executionSettings, data, reinterpret_cast<transpose::data_handler::DistributedPQTransposeDataHandler&>(*dataHandler)); break;
 #endif
         default: throw std::runtime_error("No calculate method implemented for communication type " + commToString(executionSettings->programSettings->communicationType));
     }
@@ -93,6 +112,9 @@ void
 transpose::TransposeBenchmark::collectAndPrintResults(const transpose::TransposeExecutionTimings &output) {
     double flops = static_cast<double>(executionSettings->programSettings->matrixSize) * executionSettings->programSettings->matrixSize;
 
+    rawTimings["calculation"] = output.calculationTimings;
+    rawTimings["transfer"] = output.transferTimings;
+
     // Number of experiment repetitions
     uint number_measurements = output.calculationTimings.size();
     std::vector<double> max_measures(number_measurements);
@@ -126,6 +148,19 @@ transpose::TransposeBenchmark::collectAndPrintResults(const transpose::Transpose
 
 
     if (mpi_comm_rank == 0) {
+        derivedMetrics["avg total [s]"] = avgTransferTime + avgCalculationTime;
+        derivedMetrics["avg transfer [s]"] = avgTransferTime;
+        derivedMetrics["avg calc [s]"] = avgCalculationTime;
+        derivedMetrics["avg calc [FLOPS]"] = avgCalcFLOPS;
+        derivedMetrics["avg Mem [B/s]"] = avgMemBandwidth;
+        derivedMetrics["avg PCIe [B/s]"] = avgTransferBandwidth;
+        derivedMetrics["best total [s]"] = minTransferTime + minCalculationTime;
+        derivedMetrics["best transfer [s]"] = minTransferTime;
+        derivedMetrics["best calc [s]"] = minCalculationTime;
+        derivedMetrics["best calc [FLOPS]"] = maxCalcFLOPS;
+        derivedMetrics["best Mem [B/s]"] = maxMemBandwidth;
+        derivedMetrics["best PCIe [B/s]"] = maxTransferBandwidth;
+
         std::cout << "       total [s]     transfer [s]  calc [s]      calc FLOPS    Mem [B/s]     PCIe [B/s]" << std::endl;
         std::cout << "avg:   " << (avgTransferTime + avgCalculationTime)
                 << "   " << avgTransferTime
@@ -141,6 +176,14 @@ transpose::TransposeBenchmark::collectAndPrintResults(const transpose::Transpose
                 << "   " << maxMemBandwidth
                 << "   " << maxTransferBandwidth
                 << std::endl;
+        printTimingStatistics({{"calc", max_measures}, {"transfer", max_transfers}});
+        if (executionSettings->programSettings->communicationType != hpcc_base::CommunicationType::cpu_only) {
+            // Every kernel replication adds at most CHANNEL_WIDTH values per cycle. For every addition,
+            // a value of A and B is read and the result is written to global memory.
+            hpcc_base::Roofline roofline{mpi_comm_size * executionSettings->programSettings->kernelReplications * CHANNEL_WIDTH * getKernelFrequency(),
+                                        mpi_comm_size * getMemoryPeak(), 3.0 * sizeof(HOST_DATA_TYPE)};
+            printEfficiency({{"calc", {maxCalcFLOPS, roofline}}}, "FLOPS", 1.0);
+        }
     }
 }
 
@@ -152,14 +195,26 @@ transpose::TransposeBenchmark::generateInputData() {
 bool  
 transpose::TransposeBenchmark::validateOutputAndPrintError(transpose::TransposeData &data) {
 
-    // exchange the data using MPI depending on the chosen distribution scheme
-    dataHandler->exchangeData(data);
-
-    dataHandler->reference_transpose(data);
+    // exchange the data using MPI depending on the chosen distribution scheme.
+    // In lean memory mode the exchanged matrix A is regenerated by the data handler instead
+    if (!data.leanMemory) {
+        dataHandler->exchangeData(data);
+    }
 
     double max_error = 0.0;
-    for (size_t i = 0; i < executionSettings->programSettings->blockSize * executionSettings->programSettings->blockSize * data.numBlocks; i++) {
-        max_error = std::max(fabs(data.A[i]), max_error);
+    size_t total_values = executionSettings->programSettings->blockSize * executionSettings->programSettings->blockSize * data.numBlocks;
+    if (executionSettings->programSettings->validationMode == hpcc_base::ValidationMode::sampled) {
+        // Only check randomly selected values of the result
+        for (size_t i : hpcc_base::validation::sampleIndices(executionSettings->programSettings->validationErrorBound, total_values, mpi_comm_rank)) {
+            max_error = std::max(std::abs(dataHandler->getTransposeError(data, i)), max_error);
+        }
+    }
+    else {
+        dataHandler->reference_transpose(data);
+
+        for (size_t i = 0; i < total_values; i++) {
+            max_error = std::max(fabs(data.A[i]), max_error);
+        }
     }
 
     double global_max_error = 0;
@@ -173,6 +228,32 @@ transpose::TransposeBenchmark::validateOutputAndPrintError(transpose::TransposeD
     return static_cast<double>(global_max_error) < 100 * std::numeric_limits<HOST_DATA_TYPE>::epsilon();
 }
 
+bool
+transpose::TransposeBenchmark::setAutomaticSize(hpcc_base::MemoryLimits const& limits) {
+    auto& settings = *executionSettings->programSettings;
+    if (settings.dataHandlerIdentifier != transpose::data_handler::DataHandlerType::pq
+            || settings.p == 0 || mpi_comm_size % settings.p != 0) {
+        return false;
+    }
+    uint64_t pq_width = settings.p;
+    uint64_t pq_height = mpi_comm_size / settings.p;
+    // A, B and the result are stored on the device
+    double matrices = 3.0;
+    double block_bytes = static_cast<double>(settings.blockSize) * settings.blockSize * sizeof(HOST_DATA_TYPE);
+    double max_local_blocks = std::min(limits.totalMemory / matrices, limits.maxBufferSize) / block_bytes;
+    // Every rank holds (w / P) x (w / Q) blocks of a matrix with a width of w blocks
+    uint64_t width = hpcc_base::largestMultiple(std::sqrt(max_local_blocks * pq_width * pq_height),
+                                                    hpcc_base::leastCommonMultiple(pq_width, pq_height));
+    while (width > 0 && static_cast<double>(width / pq_width) * (width / pq_height) > max_local_blocks) {
+        width -= hpcc_base::leastCommonMultiple(pq_width, pq_height);
+    }
+    if (width == 0) {
+        return false;
+    }
+    settings.matrixSize = static_cast<uint>(width * settings.blockSize);
+    return true;
+}
+
 void
 transpose::TransposeBenchmark::setTransposeDataHandler(transpose::data_handler::DataHandlerType dataHandlerIdentifier) {
     switch (dataHandlerIdentifier) {
@@ -183,3 +264,74 @@ transpose::TransposeBenchmark::setTransposeDataHandler(transpose::data_handler::
         
 
 }
+
+void
+transpose::TransposeBenchmark::autotune() {
+    auto& settings = *executionSettings->programSettings;
+
+    // Only P values that are supported by the used data handler and communication type are probed
+    std::vector<uint> p_values;
+    if (settings.dataHandlerIdentifier == transpose::data_handler::DataHandlerType::pq) {
+        for (uint p = 1; p <= static_cast<uint>(mpi_comm_size); p++) {
+            if (mpi_comm_size % p == 0 && ((settings.communicationType != hpcc_base::CommunicationType::intel_external_channels
+                                                    && settings.communicationType != hpcc_base::CommunicationType::smi)
+                                                || p * p == static_cast<uint>(mpi_comm_size))) {
+                p_values.push_back(p);
+            }
+        }
+    }
+    if (p_values.empty()) {
+        p_values.push_back(settings.p);
+    }
+    // The buffer placement can only be changed by the host for Intel FPGAs without memory interleaving.
+    // If the distribution was requested explicitly, it is not changed.
+    std::vector<bool> distribute_values{settings.distributeBuffers};
+#ifdef INTEL_FPGA
+    if (!settings.distributeBuffers && !settings.useMemoryInterleaving && settings.communicationType != hpcc_base::CommunicationType::cpu_only) {
+        distribute_values = {false, true};
+    }
+#endif
+
+    // A single repetition is executed per configuration. The original settings are restored with the selected configuration.
+    settings.numRepetitions = 1;
+    settings.warmupRepetitions = 0;
+    settings.repetitionTolerance = 0.0;
+
+    double best_time = std::numeric_limits<double>::max();
+    uint best_p = settings.p;
+    bool best_distribute = settings.distributeBuffers;
+    for (uint p : p_values) {
+        settings.p = p;
+        setTransposeDataHandler(settings.dataHandlerIdentifier);
+        auto data = generateInputData();
+        for (bool distribute : distribute_values) {
+            settings.distributeBuffers = distribute;
+            auto timings = executeKernel(*data);
+            double time = timings->calculationTimings.front() + timings->transferTimings.front();
+            // All ranks have to select the same configuration
+            MPI_Allreduce(MPI_IN_PLACE, &time, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+            if (mpi_comm_rank == 0) {
+                std::cout << "Autotune P=" << p << ", Dist. Buffers=" << (distribute ? "Yes" : "No") << ": " << time << " s" << std::endl;
+            }
+            if (time < best_time) {
+                best_time = time;
+                best_p = p;
+                best_distribute = distribute;
+            }
+        }
+    }
+
+    // Create new settings with the selected configuration. This also drops data that was generated for the old configuration.
+    std::vector<std::string> selected_arguments{"-p", std::to_string(best_p)};
+    if (best_distribute) {
+        selected_arguments.push_back("--distribute-buffers");
+    }
+    if (!updateProgramSettings(selected_arguments)) {
+        throw std::runtime_error("Selected configuration of the autotuning could not be applied!");
+    }
+    setTransposeDataHandler(executionSettings->programSettings->dataHandlerIdentifier);
+    executionSettings->programSettings->autotuneResult = "P=" + std::to_string(best_p) + ", Dist. Buffers=" + (best_distribute ? "Yes" : "No");
+    if (mpi_comm_rank == 0) {
+        std::cout << "Autotune selected " << executionSettings->programSettings->autotuneResult << std::endl;
+    }
+}
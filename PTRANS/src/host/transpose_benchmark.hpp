@@ -77,6 +77,15 @@ public:
     void
     setTransposeDataHandler(transpose::data_handler::DataHandlerType dataHandlerIdentifier);
 
+    /**
+     * @brief Select the grid width P and the buffer distribution with the lowest execution time.
+     *          The data handler and the block size are given by the kernel, so only P and the buffer distribution are varied.
+     *          Every feasible configuration is executed once and the fastest one is kept in the program settings.
+     * 
+     */
+    void
+    autotune();
+
     /**
      * @brief Transpose specific implementation of the kernel execution
      * 
@@ -104,6 +113,17 @@ public:
     void
     collectAndPrintResults(const TransposeExecutionTimings &output) override;
 
+    /**
+     * @brief Select the largest matrix size that fits into the device memory.
+     *          Only supported by the PQ data handler. The matrix width in blocks is a multiple of P and Q,
+     *          so all ranks get the same number of blocks.
+     * 
+     * @param limits The memory limits of the device
+     * @return true if a valid matrix size was found, false otherwise
+     */
+    bool
+    setAutomaticSize(hpcc_base::MemoryLimits const& limits) override;
+
     /**
      * @brief Construct a new Transpose Benchmark object
      * 
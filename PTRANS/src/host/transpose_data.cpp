@@ -7,7 +7,9 @@
 transpose::TransposeProgramSettings::TransposeProgramSettings(cxxopts::ParseResult &results) : hpcc_base::BaseSettings(results),
     matrixSize(results["m"].as<uint>() * results["b"].as<uint>()),
     blockSize(results["b"].as<uint>()), dataHandlerIdentifier(transpose::data_handler::stringToHandler(results["handler"].as<std::string>())),
-    distributeBuffers(results["distribute-buffers"].count() > 0), p(results["p"].as<uint>()) {
+    distributeBuffers(results["distribute-buffers"].count() > 0),
+    leanMemory(results["lean-memory"].count() > 0), autotune(results["autotune"].count() > 0), p(results["p"].as<uint>()),
+    smiRoutingDirectory(results["smi-routes"].as<std::string>()) {
 
         // auto detect data distribution type if required
         if (dataHandlerIdentifier == transpose::data_handler::DataHandlerType::automatic) {
@@ -21,6 +23,18 @@ transpose::TransposeProgramSettings::TransposeProgramSettings(cxxopts::ParseResu
                 throw std::runtime_error("Required data distribution could not be detected from kernel file name!");
             }
         }
+        if (leanMemory && (dataHandlerIdentifier != transpose::data_handler::DataHandlerType::pq
+                            || communicationType != hpcc_base::CommunicationType::pcie_mpi)) {
+            throw std::runtime_error("Lean memory mode is only supported by the PQ data handler with PCIe communication!");
+        }
+#ifndef USE_SMI
+        if (communicationType == hpcc_base::CommunicationType::smi) {
+            throw std::runtime_error("The host code was built without support for SMI. Enable it with USE_SMI!");
+        }
+#endif
+        if (communicationType == hpcc_base::CommunicationType::smi && dataHandlerIdentifier != transpose::data_handler::DataHandlerType::pq) {
+            throw std::runtime_error("SMI is only supported by the PQ data handler!");
+        }
 }
 
 std::map<std::string, std::string>
@@ -33,12 +47,17 @@ transpose::TransposeProgramSettings::getSettingsMap() {
         map["Matrix Size"] = std::to_string(matrixSize);
         map["Block Size"] = std::to_string(blockSize);
         map["Dist. Buffers"] = distributeBuffers ? "Yes" : "No";
+        map["Lean Memory"] = leanMemory ? "Yes" : "No";
+        map["Autotune"] = autotune ? (autotuneResult.empty() ? "Yes" : autotuneResult) : "No";
         map["Data Handler"] = transpose::data_handler::handlerToString(dataHandlerIdentifier);
+        if (communicationType == hpcc_base::CommunicationType::smi) {
+            map["SMI Routes"] = smiRoutingDirectory;
+        }
         return map;
 }
 
-transpose::TransposeData::TransposeData(cl::Context context, uint block_size, uint y_size) : context(context), 
-                                                                                numBlocks(y_size), blockSize(block_size) {
+transpose::TransposeData::TransposeData(cl::Context context, uint block_size, uint y_size, bool lean_memory) : context(context), 
+                                                                                numBlocks(y_size), blockSize(block_size), leanMemory(lean_memory) {
     if (numBlocks * blockSize > 0) {
 #ifdef USE_SVM
         A = reinterpret_cast<HOST_DATA_TYPE*>(
@@ -50,18 +69,14 @@ transpose::TransposeData::TransposeData(cl::Context context, uint block_size, ui
         result = reinterpret_cast<HOST_DATA_TYPE*>(
                             clSVMAlloc(context(), 0 ,
                             block_size * block_size * y_size * sizeof(HOST_DATA_TYPE), 1024));
-        exchange = reinterpret_cast<HOST_DATA_TYPE*>(
+        exchange = leanMemory ? result : reinterpret_cast<HOST_DATA_TYPE*>(
                             clSVMAlloc(context(), 0 ,
                             block_size * block_size * y_size * sizeof(HOST_DATA_TYPE), 1024));
 #else
-        posix_memalign(reinterpret_cast<void **>(&A), 64,
-                    sizeof(HOST_DATA_TYPE) * block_size * block_size * y_size);
-        posix_memalign(reinterpret_cast<void **>(&B), 64,
-                    sizeof(HOST_DATA_TYPE) * block_size * block_size * y_size);
-        posix_memalign(reinterpret_cast<void **>(&result), 64,
-                    sizeof(HOST_DATA_TYPE) * block_size * block_size * y_size);
-        posix_memalign(reinterpret_cast<void **>(&exchange), 64,
-                    sizeof(HOST_DATA_TYPE) * block_size * block_size * y_size);
+        A = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(block_size * block_size * y_size);
+        B = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(block_size * block_size * y_size);
+        result = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(block_size * block_size * y_size);
+        exchange = leanMemory ? result : hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(block_size * block_size * y_size);
 #endif
     }
 }
@@ -69,15 +84,19 @@ transpose::TransposeData::TransposeData(cl::Context context, uint block_size, ui
 transpose::TransposeData::~TransposeData() {
     if (numBlocks * blockSize > 0) {
 #ifdef USE_SVM
-        clSVMFree(context(), reinterpret_cast<void*>(A));});
-        clSVMFree(context(), reinterpret_cast<void*>(B));});
-        clSVMFree(context(), reinterpret_cast<void*>(result));});
-        clSVMFree(context(), reinterpret_cast<void*>(exchange));});
+        clSVMFree(context(), reinterpret_cast<void*>(A));
+        clSVMFree(context(), reinterpret_cast<void*>(B));
+        clSVMFree(context(), reinterpret_cast<void*>(exchange));
+        if (!leanMemory) {
+            clSVMFree(context(), reinterpret_cast<void*>(result));
+        }
 #else
-        free(A);
-        free(B);
-        free(result);
-        free(exchange);
+        hpcc_base::host_memory::release(A);
+        hpcc_base::host_memory::release(B);
+        hpcc_base::host_memory::release(exchange);
+        if (!leanMemory) {
+            hpcc_base::host_memory::release(result);
+        }
 #endif
     }
 }
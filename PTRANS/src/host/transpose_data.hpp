@@ -74,6 +74,30 @@ public:
      */
     bool distributeBuffers;
 
+    /**
+     * @brief If true, no host buffer is allocated for the data exchange and the result is written into the
+     *          device buffer of B. This allows larger matrices at the cost of regenerating A during validation.
+     */
+    bool leanMemory;
+
+    /**
+     * @brief If true, the grid width P and the buffer distribution are selected by short probe executions before the benchmark
+     * 
+     */
+    bool autotune;
+
+    /**
+     * @brief Summary of the configuration that was selected by the autotuning. Empty if no autotuning was done.
+     * 
+     */
+    std::string autotuneResult;
+
+    /**
+     * @brief Directory that contains the routing tables generated by SMI. Only used by the SMI communication type
+     * 
+     */
+    std::string smiRoutingDirectory;
+
     /**
      * @brief Construct a new Transpose Program Settings object
      * 
@@ -134,6 +158,12 @@ public:
      */
     const size_t blockSize;
 
+    /**
+     * @brief If true, exchange and result point to the same memory. The exchanged matrix A is then not
+     *          available for validation and has to be regenerated.
+     */
+    const bool leanMemory;
+
     /**
      * @brief The context that is used to allocate memory in SVM mode
      * 
@@ -146,8 +176,9 @@ public:
      * @param context Context that is used to allocate memory for SVM
      * @param block_size size of the quadratic blocks that are stored within this object
      * @param y_size number of blocks that are stored within this object per replication
+     * @param lean_memory if true, no separate exchange buffer is allocated. The result buffer is used instead.
      */
-    TransposeData(cl::Context context, uint block_size, uint size_y);
+    TransposeData(cl::Context context, uint block_size, uint size_y, bool lean_memory = false);
 
     /**
      * @brief Destroy the Transpose Data object. Free the allocated memory
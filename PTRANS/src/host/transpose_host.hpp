@@ -0,0 +1,92 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SRC_HOST_TRANSPOSE_HOST_HPP_
+#define SRC_HOST_TRANSPOSE_HOST_HPP_
+
+/* C++ standard library headers */
+#include <algorithm>
+
+/* Project's headers */
+#include "parameters.h"
+
+namespace transpose {
+namespace host {
+
+/**
+ * @brief Width and height of the tiles the host transpose is processed in.
+ *          Tiles of three matrices in single precision fit into the L1 cache.
+ * 
+ */
+static constexpr size_t tile_size = 32;
+
+/**
+ * @brief Apply an operation to all elements of a matrix that is accessed row-wise and column-wise at the same time.
+ *          The matrix is processed in tiles, so the data of the strided accesses stays in the cache while a tile is processed.
+ *          The tiles are distributed over the OpenMP threads.
+ * 
+ * @tparam Op Type of the operation
+ * @param rows Number of rows of the matrix
+ * @param cols Number of columns of the matrix
+ * @param op Operation that is called with the row and column of every element. Calls for different elements must be independent.
+ */
+template<typename Op>
+static void
+tiledTransposeLoop(size_t rows, size_t cols, Op op) {
+    #pragma omp parallel for collapse(2) schedule(static)
+    for (size_t tile_row = 0; tile_row < rows; tile_row += tile_size) {
+        for (size_t tile_col = 0; tile_col < cols; tile_col += tile_size) {
+            size_t row_end = std::min(tile_row + tile_size, rows);
+            size_t col_end = std::min(tile_col + tile_size, cols);
+            for (size_t i = tile_row; i < row_end; i++) {
+                #pragma omp simd
+                for (size_t j = tile_col; j < col_end; j++) {
+                    op(i, j);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Calculate C = A^T + B on the host
+ * 
+ * @param A Matrix with cols rows and rows columns
+ * @param lda Leading dimension of A
+ * @param B Matrix with rows rows and cols columns
+ * @param ldb Leading dimension of B
+ * @param C Result matrix with rows rows and cols columns
+ * @param ldc Leading dimension of C
+ * @param rows Number of rows of the result matrix
+ * @param cols Number of columns of the result matrix
+ */
+static void
+transposeAdd(const HOST_DATA_TYPE* A, size_t lda, const HOST_DATA_TYPE* B, size_t ldb, HOST_DATA_TYPE* C, size_t ldc, size_t rows, size_t cols) {
+    tiledTransposeLoop(rows, cols, [=](size_t i, size_t j) {
+        C[i * ldc + j] = A[j * lda + i] + B[i * ldb + j];
+    });
+}
+
+}
+}
+
+#endif
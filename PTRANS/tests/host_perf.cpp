@@ -0,0 +1,79 @@
+//
+// Micro-benchmarks for the host code of the PTRANS benchmark
+//
+#include <memory>
+
+#include "benchmark/benchmark.h"
+#include "host_perf_fixture.hpp"
+#include "transpose_benchmark.hpp"
+#include "data_handlers/pq.hpp"
+#include "parameters.h"
+
+/**
+ * The range gives the number of block rows per rank
+ */
+class TransposeHostPerf : public hpcc_base::HostPerfFixture<transpose::TransposeBenchmark> {
+protected:
+    void
+    setDataSize(benchmark::State& state) override {
+        int mpi_size;
+        MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+        auto& settings = *getBenchmark().getExecutionSettings().programSettings;
+        settings.matrixSize = state.range(0) * settings.blockSize * mpi_size;
+    }
+
+    /**
+     * Create a PQ data handler for all MPI ranks with the data size given by the range
+     */
+    std::unique_ptr<transpose::data_handler::DistributedPQTransposeDataHandler>
+    createHandler(benchmark::State& state) {
+        int mpi_rank;
+        int mpi_size;
+        MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+        setDataSize(state);
+        return std::unique_ptr<transpose::data_handler::DistributedPQTransposeDataHandler>(
+                    new transpose::data_handler::DistributedPQTransposeDataHandler(mpi_rank, mpi_size, getBenchmark().getExecutionSettings().programSettings->p));
+    }
+};
+
+/**
+ * Generation of the input matrices with the PQ data handler
+ */
+BENCHMARK_DEFINE_F(TransposeHostPerf, GenerateInputData)(benchmark::State& state) {
+    auto handler = createHandler(state);
+    for (auto _ : state) {
+        auto data = handler->generateData(getBenchmark().getExecutionSettings());
+        benchmark::DoNotOptimize(data->A);
+    }
+}
+BENCHMARK_REGISTER_F(TransposeHostPerf, GenerateInputData)->RangeMultiplier(2)->Range(1, 16)->Unit(benchmark::kMillisecond);
+
+/**
+ * Packing and exchange of the blocks between the ranks for the validation.
+ * With a single rank the blocks stay on the rank, so the benchmark has to be executed with MPI to measure the exchange.
+ */
+BENCHMARK_DEFINE_F(TransposeHostPerf, ExchangeData)(benchmark::State& state) {
+    auto handler = createHandler(state);
+    auto data = handler->generateData(getBenchmark().getExecutionSettings());
+    for (auto _ : state) {
+        handler->exchangeData(*data);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * data->numBlocks * data->blockSize * data->blockSize * sizeof(HOST_DATA_TYPE));
+}
+BENCHMARK_REGISTER_F(TransposeHostPerf, ExchangeData)->RangeMultiplier(2)->Range(1, 16)->Unit(benchmark::kMillisecond);
+
+/**
+ * Transposition on the host that is used to calculate the error of the result
+ */
+BENCHMARK_DEFINE_F(TransposeHostPerf, ReferenceTranspose)(benchmark::State& state) {
+    auto handler = createHandler(state);
+    auto data = handler->generateData(getBenchmark().getExecutionSettings());
+    for (auto _ : state) {
+        handler->reference_transpose(*data);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * 3 * data->numBlocks * data->blockSize * data->blockSize * sizeof(HOST_DATA_TYPE));
+}
+BENCHMARK_REGISTER_F(TransposeHostPerf, ReferenceTranspose)->RangeMultiplier(2)->Range(1, 16)->Unit(benchmark::kMillisecond);
@@ -2,6 +2,7 @@
 // Created by Marius Meyer on 04.12.19.
 //
 #include <memory>
+#include <vector>
 #include "transpose_benchmark.hpp"
 #include "gtest/gtest.h"
 #include "parameters.h"
@@ -189,6 +190,31 @@ TEST_F(TransposeKernelTest, FPGAAAndBAreSummedUp4Blocks) {
     EXPECT_FLOAT_EQ(aggregated_error, 0.0);
 }
 
+/**
+ * Tests if the lean memory mode calculates the same result as the default mode
+ */
+TEST_F(TransposeKernelTest, FPGALeanMemoryMatchesDefaultMode) {
+    auto& settings = *bm->getExecutionSettings().programSettings;
+    if (settings.dataHandlerIdentifier != transpose::data_handler::DataHandlerType::pq
+            || settings.communicationType != hpcc_base::CommunicationType::pcie_mpi) {
+        // Lean memory mode is only supported by the PQ data handler with PCIe communication
+        return;
+    }
+    matrix_size = BLOCK_SIZE * settings.kernelReplications;
+    settings.matrixSize = matrix_size;
+    data = bm->generateInputData();
+    bm->executeKernel(*data);
+    std::vector<HOST_DATA_TYPE> reference(data->result, data->result + matrix_size * matrix_size);
+    settings.leanMemory = true;
+    auto lean_data = bm->generateInputData();
+    bm->executeKernel(*lean_data);
+    settings.leanMemory = false;
+    double aggregated_error = 0.0;
+    for (int i = 0; i < matrix_size * matrix_size; i++) {
+        aggregated_error += std::abs(lean_data->result[i] - reference[i]);
+    }
+    EXPECT_FLOAT_EQ(aggregated_error, 0.0);
+}
 
 /**
  * Checks the size and values of the timing measurements that are retured by calculate.
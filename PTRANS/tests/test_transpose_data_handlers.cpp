@@ -1,12 +1,17 @@
 //
 // Created by Marius Meyer on 19.10.20.
 //
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <vector>
 #include "gtest/gtest.h"
 #include "parameters.h"
 #include "test_program_settings.h"
 #include "gmock/gmock-matchers.h"
 #include "transpose_benchmark.hpp"
 #include "data_handlers/diagonal.hpp"
+#include "data_handlers/pq.hpp"
 
 
 struct TransposeHandlersTest : testing::Test {
@@ -224,4 +229,208 @@ TEST_F(TransposeHandlersTest, GenerateInputDataInRangeDistDiagMultipleBlocks) {
     EXPECT_THROW(bm->generateInputData(), std::runtime_error);
 }
 
+/**
+ * The data handlers and the generated data of all ranks of a P x Q grid in a single process and the global matrix A
+ * that is reassembled from the local matrices
+ */
+struct PQGrid {
+    std::vector<std::unique_ptr<transpose::data_handler::DistributedPQTransposeDataHandler>> handlers;
+    std::vector<std::unique_ptr<transpose::TransposeData>> data;
+    std::vector<HOST_DATA_TYPE> global_a;
+};
+
+PQGrid
+createPQGrid(hpcc_base::ExecutionSettings<transpose::TransposeProgramSettings>& settings, int p, int q) {
+    PQGrid grid;
+    size_t block_size = settings.programSettings->blockSize;
+    size_t global_width = settings.programSettings->matrixSize;
+    grid.global_a.resize(global_width * global_width);
+    for (int rank = 0; rank < p * q; rank++) {
+        grid.handlers.emplace_back(new transpose::data_handler::DistributedPQTransposeDataHandler(rank, p * q, p));
+        grid.data.push_back(grid.handlers.back()->generateData(settings));
+        size_t width = grid.handlers.back()->getWidthforRank() * block_size;
+        for (size_t i = 0; i < grid.handlers.back()->getHeightforRank() * block_size; i++) {
+            for (size_t j = 0; j < width; j++) {
+                size_t global_row = ((i / block_size) * q + rank / p) * block_size + i % block_size;
+                size_t global_col = ((j / block_size) * p + rank % p) * block_size + j % block_size;
+                grid.global_a[global_row * global_width + global_col] = grid.data.back()->A[i * width + j];
+            }
+        }
+    }
+    return grid;
+}
+
+/**
+ * Calculate the aggregated error of the exchanged matrix of a rank. 
+ * The exchanged block (row, col) has to be the global block (row * P + pq_col, col * Q + pq_row) of A.
+ */
+double
+getExchangedMatrixError(PQGrid const& grid, const HOST_DATA_TYPE* exchanged, int rank, int p, int q, size_t block_size) {
+    size_t global_width = static_cast<size_t>(std::sqrt(grid.global_a.size()));
+    size_t exchanged_height = grid.handlers[rank]->getWidthforRank() * block_size;
+    size_t exchanged_width = grid.handlers[rank]->getHeightforRank() * block_size;
+    double aggregated_error = 0.0;
+    for (size_t i = 0; i < exchanged_height; i++) {
+        for (size_t j = 0; j < exchanged_width; j++) {
+            size_t global_row = ((i / block_size) * p + rank % p) * block_size + i % block_size;
+            size_t global_col = ((j / block_size) * q + rank / p) * block_size + j % block_size;
+            aggregated_error += std::fabs(exchanged[i * exchanged_width + j] - grid.global_a[global_row * global_width + global_col]);
+        }
+    }
+    return aggregated_error;
+}
+
+/**
+ * Exchange the blocks of all ranks of a P x Q grid in a single process with the messages calculated by the PQ data handlers.
+ * The blocks of a message are packed in the order of the sending rank and unpacked in the order of the receiving rank.
+ * Checks if every message is received exactly once and if every rank gets the blocks of the global matrix A
+ * that are required to calculate its transposed result blocks.
+ */
+void
+checkPQExchange(hpcc_base::ExecutionSettings<transpose::TransposeProgramSettings>& settings, int p, int q) {
+    size_t block_size = settings.programSettings->blockSize;
+    auto grid = createPQGrid(settings, p, q);
+
+    // Messages that are sent but not received yet, identified by the source rank, the destination rank and the tag
+    std::map<std::tuple<int,int,int>, std::vector<HOST_DATA_TYPE>> sent_messages;
+    for (int rank = 0; rank < p * q; rank++) {
+        size_t width = grid.handlers[rank]->getWidthforRank() * block_size;
+        for (auto const& message : grid.handlers[rank]->getExchangeMessages().first) {
+            std::vector<HOST_DATA_TYPE> packed;
+            for (auto const& block : message.blocks) {
+                for (size_t i = 0; i < block_size; i++) {
+                    for (size_t j = 0; j < block_size; j++) {
+                        packed.push_back(grid.data[rank]->A[(block.first * block_size + i) * width + block.second * block_size + j]);
+                    }
+                }
+            }
+            EXPECT_EQ(sent_messages.count(std::make_tuple(rank, message.rank, message.tag)), 0);
+            sent_messages[std::make_tuple(rank, message.rank, message.tag)] = packed;
+        }
+    }
+
+    double aggregated_error = 0.0;
+    for (int rank = 0; rank < p * q; rank++) {
+        // The exchanged matrix has width_per_rank x height_per_rank blocks
+        size_t exchanged_width = grid.handlers[rank]->getHeightforRank() * block_size;
+        std::vector<HOST_DATA_TYPE> exchanged(grid.handlers[rank]->getWidthforRank() * block_size * exchanged_width, 1000.0);
+        for (auto const& message : grid.handlers[rank]->getExchangeMessages().second) {
+            auto sent = sent_messages.find(std::make_tuple(message.rank, rank, message.tag));
+            ASSERT_NE(sent, sent_messages.end());
+            ASSERT_EQ(sent->second.size(), message.blocks.size() * block_size * block_size);
+            size_t value = 0;
+            for (auto const& block : message.blocks) {
+                for (size_t i = 0; i < block_size; i++) {
+                    for (size_t j = 0; j < block_size; j++) {
+                        exchanged[(block.first * block_size + i) * exchanged_width + block.second * block_size + j] = sent->second[value++];
+                    }
+                }
+            }
+            sent_messages.erase(sent);
+        }
+        aggregated_error += getExchangedMatrixError(grid, exchanged.data(), rank, p, q, block_size);
+    }
+    EXPECT_TRUE(sent_messages.empty());
+    EXPECT_FLOAT_EQ(aggregated_error, 0.0);
+}
+
+/**
+ * Check the data exchange of the PQ data handler for grids with P != Q and a matrix width that is a multiple of P and Q
+ */
+TEST_F(TransposeHandlersTest, DistPQExchangeReassemblesMatrixForPNotEqualQ) {
+    std::vector<std::pair<int,int>> grids = {{1, 2}, {2, 1}, {2, 4}, {4, 2}};
+    for (auto const& grid : grids) {
+        SCOPED_TRACE("P=" + std::to_string(grid.first) + ", Q=" + std::to_string(grid.second));
+        bm->getExecutionSettings().programSettings->matrixSize = 4 * 8;
+        checkPQExchange(bm->getExecutionSettings(), grid.first, grid.second);
+    }
+}
 
+/**
+ * Check if the transposed rank used by the SMI communication type is the only rank the PQ data handler exchanges blocks with for P = Q
+ */
+TEST_F(TransposeHandlersTest, PQTransposedRankMatchesExchangeMessagesForPEqualsQ) {
+    bm->getExecutionSettings().programSettings->matrixSize = 4 * 6;
+    for (int p = 1; p <= 3; p++) {
+        SCOPED_TRACE("P=Q=" + std::to_string(p));
+        auto grid = createPQGrid(bm->getExecutionSettings(), p, p);
+        for (int rank = 0; rank < p * p; rank++) {
+            int transposed_rank = grid.handlers[rank]->getTransposedRank();
+            EXPECT_EQ(grid.handlers[transposed_rank]->getTransposedRank(), rank);
+            for (auto const& message : grid.handlers[rank]->getExchangeMessages().first) {
+                EXPECT_EQ(message.rank, transposed_rank);
+            }
+            for (auto const& message : grid.handlers[rank]->getExchangeMessages().second) {
+                EXPECT_EQ(message.rank, transposed_rank);
+            }
+        }
+    }
+}
+
+/**
+ * Check if the transposed rank is rejected for P != Q, because the transposed position does not exist in the grid
+ */
+TEST_F(TransposeHandlersTest, PQTransposedRankThrowsForPNotEqualQ) {
+    transpose::data_handler::DistributedPQTransposeDataHandler handler(0, 6, 2);
+    EXPECT_THROW(handler.getTransposedRank(), std::runtime_error);
+}
+
+/**
+ * Check the data exchange of the PQ data handler for grids with gcd(P, Q) = 1 and matrix widths that are not a multiple of P and Q
+ */
+TEST_F(TransposeHandlersTest, DistPQExchangeReassemblesMatrixForCoprimePAndQ) {
+    std::vector<std::tuple<int,int,int>> grids = {std::make_tuple(2, 3, 6), std::make_tuple(3, 2, 6), std::make_tuple(2, 3, 7),
+                                                    std::make_tuple(3, 2, 7), std::make_tuple(3, 5, 15), std::make_tuple(5, 3, 17)};
+    for (auto const& grid : grids) {
+        SCOPED_TRACE("P=" + std::to_string(std::get<0>(grid)) + ", Q=" + std::to_string(std::get<1>(grid))
+                        + ", width in blocks=" + std::to_string(std::get<2>(grid)));
+        bm->getExecutionSettings().programSettings->matrixSize = 4 * std::get<2>(grid);
+        checkPQExchange(bm->getExecutionSettings(), std::get<0>(grid), std::get<1>(grid));
+    }
+}
+
+/**
+ * Exchange the data with MPI using the datatypes and persistent requests of the PQ data handler.
+ * The test requires multiple MPI ranks and is skipped otherwise. It is executed with six ranks by the test test_unit_mpi_pq_exchange.
+ * The second exchange has to transfer the exchanged matrix back with the reversed messages,
+ * and the third exchange reuses the persistent requests of the first one.
+ */
+TEST_F(TransposeHandlersTest, DistPQMPIExchangeWithPersistentRequestsInBothDirections) {
+    int mpi_rank;
+    int mpi_size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+    if (mpi_size == 1) {
+        GTEST_SKIP();
+    }
+    // Use the smallest divisor of the number of ranks as P, so P != Q if the number of ranks is not a square
+    int p = 2;
+    while (mpi_size % p != 0) {
+        p++;
+    }
+    int q = mpi_size / p;
+    size_t block_size = bm->getExecutionSettings().programSettings->blockSize;
+    // The width is not a multiple of P and Q, so the ranks have different numbers of blocks
+    bm->getExecutionSettings().programSettings->matrixSize = block_size * (2 * mpi_size + 1);
+    auto grid = createPQGrid(bm->getExecutionSettings(), p, q);
+
+    transpose::data_handler::DistributedPQTransposeDataHandler handler(mpi_rank, mpi_size, p);
+    auto data = handler.generateData(bm->getExecutionSettings());
+    size_t local_size = handler.getWidthforRank() * handler.getHeightforRank() * block_size * block_size;
+    std::vector<HOST_DATA_TYPE> original(data->A, data->A + local_size);
+
+    size_t received_blocks = 0;
+    handler.exchangeData(*data, [&received_blocks](size_t, size_t, const HOST_DATA_TYPE*) { received_blocks++; });
+    EXPECT_EQ(received_blocks, handler.getWidthforRank() * handler.getHeightforRank());
+    EXPECT_FLOAT_EQ(getExchangedMatrixError(grid, data->A, mpi_rank, p, q, block_size), 0.0);
+
+    handler.exchangeData(*data);
+    double aggregated_error = 0.0;
+    for (size_t i = 0; i < local_size; i++) {
+        aggregated_error += std::fabs(data->A[i] - original[i]);
+    }
+    EXPECT_FLOAT_EQ(aggregated_error, 0.0);
+
+    handler.exchangeData(*data);
+    EXPECT_FLOAT_EQ(getExchangedMatrixError(grid, data->A, mpi_rank, p, q, block_size), 0.0);
+}
@@ -0,0 +1,66 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "parameters.h"
+
+/* PY_CODE_GEN 
+try:
+    kernel_param_attributes = generate_attributes(num_replications)
+except:
+    kernel_param_attributes = ["" for i in range(num_replications)]
+*/
+
+// PY_CODE_GEN block_start [replace(local_variables=locals()) for i in range(num_replications)]
+
+/*
+Kernel, that applies a list of pseudo random updates to the data chunk of the kernel.
+In contrast to the accessMemory kernels, the random numbers are not generated on the device.
+They are generated by all MPI ranks and exchanged by the host, so the list only contains
+the updates that target the data chunk of this kernel.
+
+@param data The data chunk of the kernel that will be updated
+@param updates The pseudo random numbers that are used for the updates
+@param num_updates Number of updates in the updates array
+@param m The size of the global data array over all ranks
+@param data_chunk The size of the data chunk of this kernel
+@param address_start The global address of the first value in the data chunk
+*/
+__attribute__((max_global_work_dim(0),uses_global_work_offset(0)))
+__kernel
+void applyUpdates_/*PY_CODE_GEN i*/(__global /*PY_CODE_GEN kernel_param_attributes[i]*/ DEVICE_DATA_TYPE_UNSIGNED volatile * restrict data,
+                        __global /*PY_CODE_GEN kernel_param_attributes[i]*/ const DEVICE_DATA_TYPE_UNSIGNED * restrict updates,
+                        const uint num_updates,
+                        const DEVICE_DATA_TYPE_UNSIGNED m,
+                        const DEVICE_DATA_TYPE_UNSIGNED data_chunk,
+                        const DEVICE_DATA_TYPE_UNSIGNED address_start) {
+
+    for (uint i = 0; i < num_updates; i++) {
+        DEVICE_DATA_TYPE_UNSIGNED random_number = updates[i];
+        DEVICE_DATA_TYPE_UNSIGNED local_address = ((random_number >> 3) & (m - 1)) - address_start;
+        // The host only sends updates for this data chunk, so the check only protects from out of bounds accesses
+        if (local_address < data_chunk) {
+            data[local_address] ^= random_number;
+        }
+    }
+}
+
+// PY_CODE_GEN block_end
@@ -0,0 +1,145 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "parameters.h"
+
+/*
+Constant used to update the pseudo random number
+*/
+#define POLY 7
+
+/*
+The random number 0 is never generated by the generator, so it is used to mark the end of the updates of a generator
+*/
+#define END_OF_UPDATES 0
+
+#pragma OPENCL EXTENSION cl_intel_channels : enable
+
+/*
+Crossbar between the kernel replications. route[g][o] forwards the updates of generator g to the
+update kernel o that owns the memory bank with the addressed value.
+*/
+channel DEVICE_DATA_TYPE_UNSIGNED route[NUM_REPLICATIONS][NUM_REPLICATIONS] __attribute__((depth(HPCC_FPGA_RA_ROUTE_DEPTH)));
+
+/* PY_CODE_GEN
+try:
+    kernel_param_attributes = generate_attributes(num_replications)
+except:
+    kernel_param_attributes = ["" for i in range(num_replications)]
+*/
+
+// PY_CODE_GEN block_start [replace(local_variables=locals()) for i in range(num_replications)]
+
+/*
+Kernel, that generates a part of the pseudo random updates and forwards every update that targets
+the table of this rank to the update kernel that owns the addressed memory bank.
+All kernel replications share a single logical table, that is split into equally sized banks.
+
+@param stats Will contain the number of forwarded updates and the number of updates that were forwarded to another replication
+@param random_init The random number before the first update of this kernel
+@param m The size of the data array over all ranks
+@param num_updates Number of updates that are generated by this kernel
+@param local_size The size of the data array on this rank
+@param address_start The global address of the first value on this rank
+@param bank_size_log Log2 of the number of values in a single memory bank
+*/
+__attribute__((max_global_work_dim(0),uses_global_work_offset(0)))
+__kernel
+void generateUpdates_/*PY_CODE_GEN i*/(__global DEVICE_DATA_TYPE_UNSIGNED * restrict stats,
+                        const DEVICE_DATA_TYPE_UNSIGNED random_init,
+                        const DEVICE_DATA_TYPE_UNSIGNED m,
+                        const DEVICE_DATA_TYPE_UNSIGNED num_updates,
+                        const DEVICE_DATA_TYPE_UNSIGNED local_size,
+                        const DEVICE_DATA_TYPE_UNSIGNED address_start,
+                        const uint bank_size_log) {
+
+    DEVICE_DATA_TYPE_UNSIGNED ran = random_init;
+    DEVICE_DATA_TYPE_UNSIGNED forwarded = 0;
+    DEVICE_DATA_TYPE_UNSIGNED cross_bank = 0;
+
+    for (DEVICE_DATA_TYPE_UNSIGNED u = 0; u < num_updates; u++) {
+        DEVICE_DATA_TYPE_UNSIGNED v = ((DEVICE_DATA_TYPE) ran < 0) ? POLY : 0UL;
+        ran = (ran << 1) ^ v;
+        DEVICE_DATA_TYPE_UNSIGNED local_address = ((ran >> 3) & (m - 1)) - address_start;
+        if (local_address < local_size) {
+            uint owner = local_address >> bank_size_log;
+            forwarded++;
+            cross_bank += (owner != /*PY_CODE_GEN i*/) ? 1 : 0;
+            // Channels can only be addressed with constants, so the owner is selected in an unrolled loop
+            __attribute__((opencl_unroll_hint(NUM_REPLICATIONS)))
+            for (uint o = 0; o < NUM_REPLICATIONS; o++) {
+                if (owner == o) {
+                    write_channel_intel(route[/*PY_CODE_GEN i*/][o], ran);
+                }
+            }
+        }
+    }
+
+    // Notify all update kernels, that this generator is done
+    __attribute__((opencl_unroll_hint(NUM_REPLICATIONS)))
+    for (uint o = 0; o < NUM_REPLICATIONS; o++) {
+        write_channel_intel(route[/*PY_CODE_GEN i*/][o], END_OF_UPDATES);
+    }
+
+    stats[0] = forwarded;
+    stats[1] = cross_bank;
+}
+
+/*
+Kernel, that applies the updates it receives from the generators of all replications to its memory bank.
+The input channels are polled without blocking, so a generator that has no update for this bank
+does not stall the updates of the other generators.
+
+@param data The memory bank of the shared table that is owned by this kernel
+@param bank_size The number of values in the memory bank
+@param active_replications Number of generators that send updates to this kernel.
+*/
+__attribute__((max_global_work_dim(0),uses_global_work_offset(0)))
+__kernel
+void updateBank_/*PY_CODE_GEN i*/(__global /*PY_CODE_GEN kernel_param_attributes[i]*/ DEVICE_DATA_TYPE_UNSIGNED volatile * restrict data,
+                        const DEVICE_DATA_TYPE_UNSIGNED bank_size,
+                        const uint active_replications) {
+
+    uint finished = 0;
+    while (finished < active_replications) {
+        bool valid = false;
+        DEVICE_DATA_TYPE_UNSIGNED random_number = 0;
+        // Take at most one update per iteration from the first generator with a pending update
+        __attribute__((opencl_unroll_hint(NUM_REPLICATIONS)))
+        for (uint g = 0; g < NUM_REPLICATIONS; g++) {
+            if (!valid) {
+                random_number = read_channel_nb_intel(route[g][/*PY_CODE_GEN i*/], &valid);
+            }
+        }
+        if (valid) {
+            if (random_number == END_OF_UPDATES) {
+                finished++;
+            }
+            else {
+                // The bank is selected by the upper address bits, so the lower bits are the address within the bank
+                data[(random_number >> 3) & (bank_size - 1)] ^= random_number;
+            }
+        }
+    }
+}
+
+// PY_CODE_GEN block_end
@@ -43,6 +43,65 @@ namespace bm_execution {
 std::unique_ptr<random_access::RandomAccessExecutionTimings>
 calculate(hpcc_base::ExecutionSettings<random_access::RandomAccessProgramSettings> const& config, HOST_DATA_TYPE * data, int mpi_rank, int mpi_size);
 
+namespace cpu {
+
+/**
+ * @brief Execute the random updates on the host CPU. Every OpenMP thread processes the pseudo random numbers
+ *          of one or more of the RNGs, which are initialized the same way as for the FPGA kernel.
+ *          Concurrent updates of the same value are not synchronized, which is covered by the error tolerance of the benchmark.
+ * 
+ * @copydoc bm_execution::calculate()
+ */
+std::unique_ptr<random_access::RandomAccessExecutionTimings>
+calculate(hpcc_base::ExecutionSettings<random_access::RandomAccessProgramSettings> const& config, HOST_DATA_TYPE * data, int mpi_rank, int mpi_size);
+
+}  // namespace cpu
+
+namespace pcie {
+
+/**
+ * @brief Execute the random updates distributed over all MPI ranks like in the MPI version of the HPCC reference implementation.
+ *          Every rank generates an equal share of the global update stream on the host and sorts the updates into buckets
+ *          for the destination ranks. The buckets are exchanged with non-blocking MPI_Ialltoallv in batches, while the kernels
+ *          apply the updates to the local data on the FPGA. The local updates of a batch are applied during its exchange.
+ * 
+ * @copydoc bm_execution::calculate()
+ */
+std::unique_ptr<random_access::RandomAccessExecutionTimings>
+calculate(hpcc_base::ExecutionSettings<random_access::RandomAccessProgramSettings> const& config, HOST_DATA_TYPE * data, int mpi_rank, int mpi_size);
+
+/**
+ * @brief Sort the given updates into buckets for the MPI ranks that store the updated values
+ * 
+ * @param updates The pseudo random numbers of the updates
+ * @param numUpdates Number of updates
+ * @param localSize Size of the data array on a single rank
+ * @param mpiSize Number of MPI ranks
+ * @param sortedUpdates Vector that will contain the updates sorted by destination rank. Has to hold at least numUpdates values
+ * @param counts Number of updates for every rank. Will be resized to mpiSize
+ * @param displacements Offset of the updates of every rank in sortedUpdates. Will be resized to mpiSize
+ */
+void
+sortUpdatesByRank(HOST_DATA_TYPE const* updates, size_t numUpdates, HOST_DATA_TYPE localSize, int mpiSize,
+                    std::vector<HOST_DATA_TYPE>& sortedUpdates, std::vector<int>& counts, std::vector<int>& displacements);
+
+}  // namespace pcie
+
+namespace shared {
+
+/**
+ * @brief Execute the random updates on a single logical table that is shared by all kernel replications.
+ *          Every replication generates an equal share of the updates and routes them over a crossbar of channels
+ *          to the replication that owns the memory bank with the addressed value.
+ *          The number of routed and cross-bank updates of the last repetition are returned with the timings.
+ * 
+ * @copydoc bm_execution::calculate()
+ */
+std::unique_ptr<random_access::RandomAccessExecutionTimings>
+calculate(hpcc_base::ExecutionSettings<random_access::RandomAccessProgramSettings> const& config, HOST_DATA_TYPE * data, int mpi_rank, int mpi_size);
+
+}  // namespace shared
+
 }  // namespace bm_execution
 
 #endif  // SRC_HOST_EXECUTION_H_
@@ -0,0 +1,96 @@
+/*
+Copyright (c) 2021 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "execution.h"
+
+/* C++ standard library headers */
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace bm_execution {
+namespace cpu {
+
+    /*
+    Implementation of the random updates for the host CPU.
+     @copydoc bm_execution::cpu::calculate()
+    */
+    std::unique_ptr<random_access::RandomAccessExecutionTimings>
+    calculate(hpcc_base::ExecutionSettings<random_access::RandomAccessProgramSettings> const& config, HOST_DATA_TYPE * data, int mpi_rank, int mpi_size) {
+
+        const HOST_DATA_TYPE local_size = config.programSettings->dataSize;
+        const HOST_DATA_TYPE global_mask = local_size * mpi_size - 1;
+        const HOST_DATA_TYPE local_offset = local_size * mpi_rank;
+
+        // Calculate RNG initial values
+        HOST_DATA_TYPE num_rngs = std::min(static_cast<size_t>(config.programSettings->numRngs), config.programSettings->dataSize * 4 * mpi_size);
+        HOST_DATA_TYPE chunk = config.programSettings->dataSize * mpi_size * 4 / num_rngs;
+        std::vector<HOST_DATA_TYPE> random_inits(num_rngs);
+        random_access::calculateRngStartValues(random_inits.data(), num_rngs, chunk);
+
+        // Like for the FPGA, every repetition starts with the initial data, so the updates are done on a copy
+        HOST_DATA_TYPE* table = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(local_size);
+
+        std::vector<double> executionTimes;
+        config.repetitions->start(*config.programSettings);
+        for (int i = 0; config.repetitions->next(executionTimes); i++) {
+            #pragma omp parallel for simd
+            for (HOST_DATA_TYPE j = 0; j < local_size; j++) {
+                table[j] = data[j];
+            }
+            auto t1 = std::chrono::high_resolution_clock::now();
+            #pragma omp parallel for schedule(static)
+            for (HOST_DATA_TYPE r = 0; r < num_rngs; r++) {
+                HOST_DATA_TYPE temp = random_inits[r];
+                for (HOST_DATA_TYPE run = 0; run < chunk; run++) {
+                    HOST_DATA_TYPE_SIGNED v = 0;
+                    if (((HOST_DATA_TYPE_SIGNED) temp) < 0) {
+                        v = POLY;
+                    }
+                    temp = (temp << 1) ^ v;
+                    // Only update the values that are stored on this rank
+                    HOST_DATA_TYPE address = ((temp >> 3) & global_mask) - local_offset;
+                    if (address < local_size) {
+                        table[address] ^= temp;
+                    }
+                }
+            }
+            auto t2 = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> timespan =
+                    std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1);
+            executionTimes.push_back(timespan.count());
+        }
+        config.repetitions->discardWarmup(executionTimes);
+
+        #pragma omp parallel for simd
+        for (HOST_DATA_TYPE j = 0; j < local_size; j++) {
+            data[j] = table[j];
+        }
+        hpcc_base::host_memory::release(table);
+
+        return std::unique_ptr<random_access::RandomAccessExecutionTimings>(new random_access::RandomAccessExecutionTimings{executionTimes, std::vector<std::vector<double>>()});
+    }
+
+}  // namespace cpu
+}  // namespace bm_execution
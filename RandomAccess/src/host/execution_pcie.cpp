@@ -0,0 +1,273 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "execution.h"
+
+/* C++ standard library headers */
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+/* External library headers */
+#ifdef INTEL_FPGA
+#include "CL/cl_ext_intelfpga.h"
+#endif
+
+namespace bm_execution {
+namespace pcie {
+
+    /**
+     * @brief Buffer on the device that is used to transfer the updates to a kernel replication.
+     *          Two of them are used per replication, so the host can fill one while the kernel processes the other.
+     * 
+     */
+    struct UpdateSlot {
+        cl::Buffer buffer;
+        std::vector<HOST_DATA_TYPE> staging;
+        cl::Event done;
+        bool pending;
+    };
+
+    void
+    sortUpdatesByRank(HOST_DATA_TYPE const* updates, size_t numUpdates, HOST_DATA_TYPE localSize, int mpiSize,
+                        std::vector<HOST_DATA_TYPE>& sortedUpdates, std::vector<int>& counts, std::vector<int>& displacements) {
+        const HOST_DATA_TYPE global_mask = localSize * mpiSize - 1;
+        counts.assign(mpiSize, 0);
+        displacements.assign(mpiSize, 0);
+        for (size_t i = 0; i < numUpdates; i++) {
+            counts[((updates[i] >> 3) & global_mask) / localSize]++;
+        }
+        for (int r = 1; r < mpiSize; r++) {
+            displacements[r] = displacements[r - 1] + counts[r - 1];
+        }
+        std::vector<int> next(displacements);
+        for (size_t i = 0; i < numUpdates; i++) {
+            sortedUpdates[next[((updates[i] >> 3) & global_mask) / localSize]++] = updates[i];
+        }
+    }
+
+    /*
+    Implementation of the distributed random updates with update exchange over MPI.
+     @copydoc bm_execution::pcie::calculate()
+    */
+    std::unique_ptr<random_access::RandomAccessExecutionTimings>
+    calculate(hpcc_base::ExecutionSettings<random_access::RandomAccessProgramSettings> const& config, HOST_DATA_TYPE * data, int mpi_rank, int mpi_size) {
+#ifdef USE_SVM
+        throw std::runtime_error("The PCIE communication type is not supported with SVM!");
+#endif
+        // int used to check for OpenCL errors
+        int err;
+
+        const uint replications = config.programSettings->kernelReplications;
+        const HOST_DATA_TYPE local_size = config.programSettings->dataSize;
+        const HOST_DATA_TYPE replication_size = local_size / replications;
+        const HOST_DATA_TYPE local_offset = local_size * mpi_rank;
+        // Every rank generates an equal share of the global update stream, so all ranks together
+        // execute the same updates as in the other implementations and the validation stays the same
+        const HOST_DATA_TYPE rank_updates = 4 * local_size;
+        const HOST_DATA_TYPE first_update = rank_updates * mpi_rank;
+        const HOST_DATA_TYPE batch_size = std::min(static_cast<HOST_DATA_TYPE>(config.programSettings->updateBatchSize), rank_updates);
+        const HOST_DATA_TYPE num_batches = (rank_updates + batch_size - 1) / batch_size;
+
+        std::vector<cl::CommandQueue> compute_queue;
+        std::vector<cl::Buffer> Buffer_data;
+        std::vector<cl::Kernel> updatekernel;
+        std::vector<std::vector<UpdateSlot>> update_slots(replications);
+        std::vector<int> next_slot(replications, 0);
+
+        /* --- Prepare kernels --- */
+
+        for (uint r = 0; r < replications; r++) {
+            compute_queue.push_back(cl::CommandQueue(*config.context, config.getDevice(r), 0, &err));
+            ASSERT_CL(err);
+            int memory_bank_info = 0;
+#ifdef INTEL_FPGA
+#ifdef USE_HBM
+            memory_bank_info = CL_MEM_HETEROGENEOUS_INTELFPGA;
+#else
+            memory_bank_info = ((r + 1) << 16);
+#endif
+#endif
+            Buffer_data.push_back(cl::Buffer(*config.context,
+                        CL_MEM_READ_WRITE | memory_bank_info,
+                        sizeof(HOST_DATA_TYPE) * replication_size));
+            for (int s = 0; s < 2; s++) {
+                update_slots[r].push_back({cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info, sizeof(HOST_DATA_TYPE) * batch_size),
+                                            std::vector<HOST_DATA_TYPE>(batch_size), cl::Event(), false});
+            }
+#ifdef INTEL_FPGA
+            updatekernel.push_back(cl::Kernel(*config.program,
+                        (RANDOM_ACCESS_UPDATE_KERNEL + std::to_string(r)).c_str() ,
+                        &err));
+#endif
+#ifdef XILINX_FPGA
+            updatekernel.push_back(cl::Kernel(*config.program,
+                        (std::string(RANDOM_ACCESS_UPDATE_KERNEL) + "0:{" + RANDOM_ACCESS_UPDATE_KERNEL + "0_" + std::to_string(r + 1) + "}").c_str() ,
+                        &err));
+#endif
+            ASSERT_CL(err);
+            err = updatekernel[r].setArg(0, Buffer_data[r]);
+            ASSERT_CL(err);
+            err = updatekernel[r].setArg(3, HOST_DATA_TYPE(local_size * mpi_size));
+            ASSERT_CL(err);
+            err = updatekernel[r].setArg(4, replication_size);
+            ASSERT_CL(err);
+            err = updatekernel[r].setArg(5, HOST_DATA_TYPE(local_offset + r * replication_size));
+            ASSERT_CL(err);
+        }
+
+        // Enqueue the updates for a kernel replication. The updates are split over multiple kernel executions if they do
+        // not fit into a single update buffer. The host only waits for a buffer if it is still used by the kernel.
+        auto enqueue_replication_updates = [&](uint r, HOST_DATA_TYPE const* updates, HOST_DATA_TYPE count) {
+            for (HOST_DATA_TYPE offset = 0; offset < count; offset += batch_size) {
+                HOST_DATA_TYPE n = std::min(batch_size, count - offset);
+                UpdateSlot& slot = update_slots[r][next_slot[r]];
+                next_slot[r] = 1 - next_slot[r];
+                if (slot.pending) {
+                    slot.done.wait();
+                }
+                std::copy(updates + offset, updates + offset + n, slot.staging.begin());
+                err = compute_queue[r].enqueueWriteBuffer(slot.buffer, CL_FALSE, 0, sizeof(HOST_DATA_TYPE) * n, slot.staging.data());
+                ASSERT_CL(err);
+                err = updatekernel[r].setArg(1, slot.buffer);
+                ASSERT_CL(err);
+                err = updatekernel[r].setArg(2, cl_uint(n));
+                ASSERT_CL(err);
+                err = compute_queue[r].enqueueNDRangeKernel(updatekernel[r], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, &slot.done);
+                ASSERT_CL(err);
+                slot.pending = true;
+            }
+        };
+
+        // Distribute updates that target this rank over the kernel replications
+        std::vector<std::vector<HOST_DATA_TYPE>> replication_updates(replications);
+        auto apply_updates = [&](HOST_DATA_TYPE const* updates, HOST_DATA_TYPE count) {
+            if (replications == 1) {
+                enqueue_replication_updates(0, updates, count);
+                return;
+            }
+            for (auto& u : replication_updates) {
+                u.clear();
+            }
+            for (HOST_DATA_TYPE i = 0; i < count; i++) {
+                HOST_DATA_TYPE local_address = ((updates[i] >> 3) & (local_size * mpi_size - 1)) - local_offset;
+                replication_updates[local_address / replication_size].push_back(updates[i]);
+            }
+            for (uint r = 0; r < replications; r++) {
+                enqueue_replication_updates(r, replication_updates[r].data(), replication_updates[r].size());
+            }
+        };
+
+        // Buffers for two batches, so the next batch can be generated while the previous one is exchanged
+        std::vector<HOST_DATA_TYPE> generated(batch_size);
+        std::vector<std::vector<HOST_DATA_TYPE>> send_buffer(2, std::vector<HOST_DATA_TYPE>(batch_size));
+        std::vector<std::vector<HOST_DATA_TYPE>> recv_buffer(2);
+        std::vector<std::vector<int>> send_counts(2), send_displs(2), recv_counts(2, std::vector<int>(mpi_size)), recv_displs(2, std::vector<int>(mpi_size));
+
+        /* --- Execute actual benchmark kernels --- */
+
+        std::vector<double> executionTimes;
+        config.repetitions->start(*config.programSettings);
+        for (int i = 0; config.repetitions->next(executionTimes); i++) {
+            for (uint r = 0; r < replications; r++) {
+                err = compute_queue[r].enqueueWriteBuffer(Buffer_data[r], CL_TRUE, 0,
+                                                    sizeof(HOST_DATA_TYPE) * replication_size, &data[r * replication_size]);
+                ASSERT_CL(err)
+            }
+#ifdef _USE_MPI_
+            MPI_Barrier(MPI_COMM_WORLD);
+            MPI_Request exchange_request;
+#endif
+            bool exchange_pending = false;
+            auto t1 = std::chrono::high_resolution_clock::now();
+
+            HOST_DATA_TYPE ran = random_access::getRandomStartValue(first_update);
+            for (HOST_DATA_TYPE b = 0; b < num_batches; b++) {
+                int current = b % 2;
+                HOST_DATA_TYPE n = std::min(batch_size, rank_updates - b * batch_size);
+                for (HOST_DATA_TYPE u = 0; u < n; u++) {
+                    HOST_DATA_TYPE_SIGNED v = 0;
+                    if (((HOST_DATA_TYPE_SIGNED) ran) < 0) {
+                        v = POLY;
+                    }
+                    ran = (ran << 1) ^ v;
+                    generated[u] = ran;
+                }
+                sortUpdatesByRank(generated.data(), n, local_size, mpi_size, send_buffer[current], send_counts[current], send_displs[current]);
+
+                // The local updates are applied by the kernels while the remote updates are exchanged
+                apply_updates(&send_buffer[current][send_displs[current][mpi_rank]], send_counts[current][mpi_rank]);
+#ifdef _USE_MPI_
+                send_counts[current][mpi_rank] = 0;
+                MPI_Alltoall(send_counts[current].data(), 1, MPI_INT, recv_counts[current].data(), 1, MPI_INT, MPI_COMM_WORLD);
+                int total_received = 0;
+                for (int p = 0; p < mpi_size; p++) {
+                    recv_displs[current][p] = total_received;
+                    total_received += recv_counts[current][p];
+                }
+                recv_buffer[current].resize(total_received);
+                MPI_Request request;
+                MPI_Ialltoallv(send_buffer[current].data(), send_counts[current].data(), send_displs[current].data(), MPI_UINT64_T,
+                                recv_buffer[current].data(), recv_counts[current].data(), recv_displs[current].data(), MPI_UINT64_T,
+                                MPI_COMM_WORLD, &request);
+                // Apply the updates of the previous batch while the current batch is exchanged
+                if (exchange_pending) {
+                    MPI_Wait(&exchange_request, MPI_STATUS_IGNORE);
+                    apply_updates(recv_buffer[1 - current].data(), recv_buffer[1 - current].size());
+                }
+                exchange_request = request;
+                exchange_pending = true;
+#endif
+            }
+#ifdef _USE_MPI_
+            if (exchange_pending) {
+                MPI_Wait(&exchange_request, MPI_STATUS_IGNORE);
+                apply_updates(recv_buffer[(num_batches - 1) % 2].data(), recv_buffer[(num_batches - 1) % 2].size());
+            }
+#endif
+            for (uint r = 0; r < replications; r++) {
+                compute_queue[r].finish();
+                for (auto& slot : update_slots[r]) {
+                    slot.pending = false;
+                }
+            }
+            auto t2 = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> timespan =
+                    std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1);
+            executionTimes.push_back(timespan.count());
+        }
+        config.repetitions->discardWarmup(executionTimes);
+
+        /* --- Read back results from Device --- */
+        for (uint r = 0; r < replications; r++) {
+            err = compute_queue[r].enqueueReadBuffer(Buffer_data[r], CL_TRUE, 0,
+                    sizeof(HOST_DATA_TYPE) * replication_size, &data[r * replication_size]);
+            ASSERT_CL(err)
+        }
+
+        return std::unique_ptr<random_access::RandomAccessExecutionTimings>(new random_access::RandomAccessExecutionTimings{executionTimes, std::vector<std::vector<double>>()});
+    }
+
+}  // namespace pcie
+}  // namespace bm_execution
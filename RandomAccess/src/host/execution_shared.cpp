@@ -0,0 +1,198 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "execution.h"
+
+/* C++ standard library headers */
+#include <chrono>
+#include <memory>
+#include <vector>
+
+/* External library headers */
+#ifdef INTEL_FPGA
+#include "CL/cl_ext_intelfpga.h"
+#endif
+
+namespace bm_execution {
+namespace shared {
+
+    /*
+    Implementation of the random updates on a table that is shared by all kernel replications.
+     @copydoc bm_execution::shared::calculate()
+    */
+    std::unique_ptr<random_access::RandomAccessExecutionTimings>
+    calculate(hpcc_base::ExecutionSettings<random_access::RandomAccessProgramSettings> const& config, HOST_DATA_TYPE * data, int mpi_rank, int mpi_size) {
+#ifdef USE_SVM
+        throw std::runtime_error("The shared table is not supported in combination with SVM!");
+#endif
+#ifndef INTEL_FPGA
+        throw std::runtime_error("The shared table needs the channels of the Intel OpenCL SDK for FPGA!");
+#endif
+        // int used to check for OpenCL errors
+        int err;
+
+        const uint replications = config.programSettings->kernelReplications;
+        const HOST_DATA_TYPE local_size = config.programSettings->dataSize;
+        const HOST_DATA_TYPE bank_size = local_size / replications;
+        const HOST_DATA_TYPE global_size = local_size * mpi_size;
+        // Every rank executes all updates, but only forwards the updates for its own part of the table like the single kernel
+        const HOST_DATA_TYPE generator_updates = 4 * global_size / replications;
+        uint bank_size_log = 0;
+        while ((HOST_DATA_TYPE(1) << bank_size_log) < bank_size) {
+            bank_size_log++;
+        }
+
+        std::vector<cl::CommandQueue> generate_queue;
+        std::vector<cl::CommandQueue> update_queue;
+        std::vector<cl::Buffer> Buffer_data;
+        std::vector<cl::Buffer> Buffer_initial;
+        std::vector<cl::Buffer> Buffer_stats;
+        std::vector<cl::Kernel> generatekernel;
+        std::vector<cl::Kernel> updatekernel;
+
+        /* --- Prepare kernels --- */
+
+        for (uint r = 0; r < replications; r++) {
+            // The generators and update kernels communicate over channels, so they have to be executed concurrently
+            generate_queue.push_back(cl::CommandQueue(*config.context, config.getDevice(r), 0, &err));
+            ASSERT_CL(err);
+            update_queue.push_back(cl::CommandQueue(*config.context, config.getDevice(r), 0, &err));
+            ASSERT_CL(err);
+            int memory_bank_info = 0;
+#ifdef INTEL_FPGA
+#ifdef USE_HBM
+            memory_bank_info = CL_MEM_HETEROGENEOUS_INTELFPGA;
+#else
+            memory_bank_info = ((r + 1) << 16);
+#endif
+#endif
+            Buffer_data.push_back(cl::Buffer(*config.context,
+                        CL_MEM_READ_WRITE | memory_bank_info,
+                        sizeof(HOST_DATA_TYPE) * bank_size));
+            if (config.programSettings->deviceTableReset) {
+                // Copy of the initial data in the same memory bank that is used to reset the data array on the device
+                Buffer_initial.push_back(cl::Buffer(*config.context,
+                            CL_MEM_READ_WRITE | memory_bank_info,
+                            sizeof(HOST_DATA_TYPE) * bank_size));
+            }
+            Buffer_stats.push_back(cl::Buffer(*config.context, CL_MEM_WRITE_ONLY, sizeof(HOST_DATA_TYPE) * 2));
+#ifdef INTEL_FPGA
+            generatekernel.push_back(cl::Kernel(*config.program,
+                        (RANDOM_ACCESS_GENERATE_KERNEL + std::to_string(r)).c_str() ,
+                        &err));
+            ASSERT_CL(err);
+            updatekernel.push_back(cl::Kernel(*config.program,
+                        (RANDOM_ACCESS_BANK_KERNEL + std::to_string(r)).c_str() ,
+                        &err));
+            ASSERT_CL(err);
+#endif
+            err = generatekernel[r].setArg(0, Buffer_stats[r]);
+            ASSERT_CL(err);
+            err = generatekernel[r].setArg(1, random_access::getRandomStartValue(r * generator_updates));
+            ASSERT_CL(err);
+            err = generatekernel[r].setArg(2, global_size);
+            ASSERT_CL(err);
+            err = generatekernel[r].setArg(3, generator_updates);
+            ASSERT_CL(err);
+            err = generatekernel[r].setArg(4, local_size);
+            ASSERT_CL(err);
+            err = generatekernel[r].setArg(5, HOST_DATA_TYPE(local_size * mpi_rank));
+            ASSERT_CL(err);
+            err = generatekernel[r].setArg(6, cl_uint(bank_size_log));
+            ASSERT_CL(err);
+            err = updatekernel[r].setArg(0, Buffer_data[r]);
+            ASSERT_CL(err);
+            err = updatekernel[r].setArg(1, bank_size);
+            ASSERT_CL(err);
+            err = updatekernel[r].setArg(2, cl_uint(replications));
+            ASSERT_CL(err);
+            if (config.programSettings->deviceTableReset) {
+                err = update_queue[r].enqueueWriteBuffer(Buffer_initial[r], CL_TRUE, 0,
+                                                    sizeof(HOST_DATA_TYPE) * bank_size, &data[r * bank_size]);
+                ASSERT_CL(err)
+            }
+        }
+
+        /* --- Execute actual benchmark kernels --- */
+
+        std::vector<double> executionTimes;
+        config.repetitions->start(*config.programSettings);
+        for (int i = 0; config.repetitions->next(executionTimes); i++) {
+            for (uint r = 0; r < replications; r++) {
+                if (config.programSettings->deviceTableReset) {
+                    err = update_queue[r].enqueueCopyBuffer(Buffer_initial[r], Buffer_data[r], 0, 0, sizeof(HOST_DATA_TYPE) * bank_size);
+                    ASSERT_CL(err)
+                    err = update_queue[r].finish();
+                }
+                else {
+                    err = update_queue[r].enqueueWriteBuffer(Buffer_data[r], CL_TRUE, 0,
+                                                        sizeof(HOST_DATA_TYPE) * bank_size, &data[r * bank_size]);
+                }
+                ASSERT_CL(err)
+            }
+#ifdef _USE_MPI_
+            MPI_Barrier(MPI_COMM_WORLD);
+#endif
+            auto t1 = std::chrono::high_resolution_clock::now();
+            // The update kernels are started first, so they already drain the channels when the generators start
+            for (uint r = 0; r < replications; r++) {
+                err = update_queue[r].enqueueNDRangeKernel(updatekernel[r], cl::NullRange, cl::NDRange(1));
+                ASSERT_CL(err)
+                update_queue[r].flush();
+            }
+            for (uint r = 0; r < replications; r++) {
+                err = generate_queue[r].enqueueNDRangeKernel(generatekernel[r], cl::NullRange, cl::NDRange(1));
+                ASSERT_CL(err)
+                generate_queue[r].flush();
+            }
+            for (uint r = 0; r < replications; r++) {
+                generate_queue[r].finish();
+                update_queue[r].finish();
+            }
+            auto t2 = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> timespan =
+                    std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1);
+            executionTimes.push_back(timespan.count());
+        }
+        config.repetitions->discardWarmup(executionTimes);
+
+        /* --- Read back results from Device --- */
+
+        auto result = std::unique_ptr<random_access::RandomAccessExecutionTimings>(new random_access::RandomAccessExecutionTimings{executionTimes, std::vector<std::vector<double>>()});
+        for (uint r = 0; r < replications; r++) {
+            err = update_queue[r].enqueueReadBuffer(Buffer_data[r], CL_TRUE, 0,
+                    sizeof(HOST_DATA_TYPE) * bank_size, &data[r * bank_size]);
+            ASSERT_CL(err)
+            // The statistics are the same for all repetitions, so only the values of the last one are used
+            HOST_DATA_TYPE stats[2];
+            err = generate_queue[r].enqueueReadBuffer(Buffer_stats[r], CL_TRUE, 0, sizeof(HOST_DATA_TYPE) * 2, stats);
+            ASSERT_CL(err)
+            result->routedUpdates += stats[0];
+            result->crossBankUpdates += stats[1];
+        }
+
+        return result;
+    }
+
+}  // namespace shared
+}  // namespace bm_execution
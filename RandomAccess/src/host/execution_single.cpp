@@ -24,8 +24,10 @@ SOFTWARE.
 #include "execution.h"
 
 /* C++ standard library headers */
+#include <algorithm>
 #include <chrono>
 #include <fstream>
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -36,6 +38,50 @@ SOFTWARE.
 
 namespace bm_execution {
 
+    /**
+     * @brief Measure the kernel execution for smaller logical table sizes reusing the allocated buffers.
+     *          Only the kernel arguments for the table size and the RNG start values are changed, so the number of RNGs is
+     *          defined by the bitstream. The table content is not reset, since the results are not validated.
+     */
+    void execute_size_sweep(hpcc_base::ExecutionSettings<random_access::RandomAccessProgramSettings> const& config,
+                        std::vector<cl::CommandQueue> &compute_queue, std::vector<cl::Buffer> &Buffer_randoms,
+                        std::vector<cl::Kernel> &accesskernel, HOST_DATA_TYPE* random_inits, int mpi_size,
+                        random_access::RandomAccessExecutionTimings &result) {
+#ifdef USE_SVM
+        throw std::runtime_error("The table size sweep is not supported in combination with SVM!");
+#endif
+        const uint replications = config.programSettings->kernelReplications;
+        HOST_DATA_TYPE local_size = config.programSettings->dataSize;
+        for (uint p = 0; p < config.programSettings->sizeSweepPoints && local_size / replications > 0; p++, local_size /= 2) {
+            HOST_DATA_TYPE global_size = local_size * mpi_size;
+            HOST_DATA_TYPE num_rngs = std::min(static_cast<HOST_DATA_TYPE>(config.programSettings->numRngs), 4 * global_size);
+            random_access::calculateRngStartValues(random_inits, num_rngs, 4 * global_size / num_rngs);
+            for (uint r = 0; r < replications; r++) {
+                ASSERT_CL(compute_queue[r].enqueueWriteBuffer(Buffer_randoms[r], CL_TRUE, 0,
+                                                    sizeof(HOST_DATA_TYPE) * config.programSettings->numRngs, random_inits));
+                ASSERT_CL(accesskernel[r].setArg(2, global_size));
+                ASSERT_CL(accesskernel[r].setArg(3, HOST_DATA_TYPE(local_size / replications)));
+            }
+            double min_time = std::numeric_limits<double>::max();
+            for (int i = 0; i < config.programSettings->numRepetitions; i++) {
+#ifdef _USE_MPI_
+                MPI_Barrier(MPI_COMM_WORLD);
+#endif
+                auto t1 = std::chrono::high_resolution_clock::now();
+                for (uint r = 0; r < replications; r++) {
+                    ASSERT_CL(compute_queue[r].enqueueNDRangeKernel(accesskernel[r], cl::NullRange, cl::NDRange(1)));
+                }
+                for (uint r = 0; r < replications; r++) {
+                    ASSERT_CL(compute_queue[r].finish());
+                }
+                std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - t1;
+                min_time = std::min(min_time, duration.count());
+            }
+            result.sweepSizes.push_back(global_size);
+            result.sweepTimes.push_back(min_time);
+        }
+    }
+
     /*
     Implementation for the single kernel.
      @copydoc bm_execution::calculate()
@@ -47,31 +93,21 @@ namespace bm_execution {
 
         std::vector<cl::CommandQueue> compute_queue;
         std::vector<cl::Buffer> Buffer_data;
+        std::vector<cl::Buffer> Buffer_initial;
         std::vector<cl::Buffer> Buffer_randoms;
         std::vector<cl::Kernel> accesskernel;
 
         // Calculate RNG initial values
         HOST_DATA_TYPE* random_inits;
-        posix_memalign(reinterpret_cast<void**>(&random_inits), 4096, sizeof(HOST_DATA_TYPE)*config.programSettings->numRngs);
+        random_inits = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(config.programSettings->numRngs);
         HOST_DATA_TYPE chunk = config.programSettings->dataSize * mpi_size * 4 / std::min(static_cast<size_t>(config.programSettings->numRngs), config.programSettings->dataSize * 4 * mpi_size);
-        HOST_DATA_TYPE ran = 1;
-        random_inits[0] = ran;
-        for (HOST_DATA_TYPE r=0; r < config.programSettings->numRngs - 1; r++) {
-            for (HOST_DATA_TYPE run = 0; run < chunk; run++) {
-                HOST_DATA_TYPE_SIGNED v = 0;
-                if (((HOST_DATA_TYPE_SIGNED) ran) < 0) {
-                    v = POLY;
-                }
-                ran = (ran << 1) ^v;
-            }
-            random_inits[r + 1] = ran;
-        }
+        random_access::calculateRngStartValues(random_inits, config.programSettings->numRngs, chunk);
 
 
         /* --- Prepare kernels --- */
 
         for (int r=0; r < config.programSettings->kernelReplications; r++) {
-            compute_queue.push_back(cl::CommandQueue(*config.context, *config.device, 0, &err));
+            compute_queue.push_back(cl::CommandQueue(*config.context, config.getDevice(r), 0, &err));
             ASSERT_CL(err);
             int memory_bank_info = 0;
 #ifdef INTEL_FPGA
@@ -84,6 +120,12 @@ namespace bm_execution {
             Buffer_data.push_back(cl::Buffer(*config.context,
                         CL_MEM_READ_WRITE | memory_bank_info,
                         sizeof(HOST_DATA_TYPE)*(config.programSettings->dataSize / config.programSettings->kernelReplications)));
+            if (config.programSettings->deviceTableReset) {
+                // Copy of the initial data in the same memory bank that is used to reset the data array on the device
+                Buffer_initial.push_back(cl::Buffer(*config.context,
+                            CL_MEM_READ_WRITE | memory_bank_info,
+                            sizeof(HOST_DATA_TYPE)*(config.programSettings->dataSize / config.programSettings->kernelReplications)));
+            }
 
             Buffer_randoms.emplace_back(*config.context,
                         CL_MEM_READ_ONLY,
@@ -125,10 +167,30 @@ namespace bm_execution {
             ASSERT_CL(err);
         }
 
+#ifndef USE_SVM
+        // The RNG start values and the initial data in the device are not modified by the kernel, so they are only transferred once
+        for (int r = 0; r < config.programSettings->kernelReplications; r++) {
+            err = compute_queue[r].enqueueWriteBuffer(Buffer_randoms[r], CL_TRUE, 0,
+                                                sizeof(HOST_DATA_TYPE) * config.programSettings->numRngs,
+                                                random_inits);
+            ASSERT_CL(err)
+            if (config.programSettings->deviceTableReset) {
+                err = compute_queue[r].enqueueWriteBuffer(Buffer_initial[r], CL_TRUE, 0,
+                                                    sizeof(HOST_DATA_TYPE) *
+                                                    (config.programSettings->dataSize / config.programSettings->kernelReplications),
+                                                    &data[r * (config.programSettings->dataSize / config.programSettings->kernelReplications)]);
+                ASSERT_CL(err)
+            }
+        }
+#endif
+
         /* --- Execute actual benchmark kernels --- */
 
         std::vector<double> executionTimes;
-        for (int i = 0; i < config.programSettings->numRepetitions; i++) {
+        std::vector<std::vector<double>> deviceTimings;
+        std::vector<double> replicationTimes(config.programSettings->kernelReplications);
+        config.repetitions->start(*config.programSettings);
+        for (int i = 0; config.repetitions->next(executionTimes); i++) {
             std::chrono::time_point<std::chrono::high_resolution_clock> t1;
 #pragma omp parallel default(shared)
             {
@@ -149,14 +211,19 @@ namespace bm_execution {
                                     NULL, NULL);
                     ASSERT_CL(err)
 #else
-                    err = compute_queue[r].enqueueWriteBuffer(Buffer_data[r], CL_TRUE, 0,
+                    if (config.programSettings->deviceTableReset) {
+                        err = compute_queue[r].enqueueCopyBuffer(Buffer_initial[r], Buffer_data[r], 0, 0,
                                                         sizeof(HOST_DATA_TYPE) *
-                                                        (config.programSettings->dataSize / config.programSettings->kernelReplications),
-                                                        &data[r * (config.programSettings->dataSize / config.programSettings->kernelReplications)]);
-                    ASSERT_CL(err)
-                    err = compute_queue[r].enqueueWriteBuffer(Buffer_randoms[r], CL_TRUE, 0,
-                                                        sizeof(HOST_DATA_TYPE) * config.programSettings->numRngs,
-                                                        random_inits);
+                                                        (config.programSettings->dataSize / config.programSettings->kernelReplications));
+                        ASSERT_CL(err)
+                        err = compute_queue[r].finish();
+                    }
+                    else {
+                        err = compute_queue[r].enqueueWriteBuffer(Buffer_data[r], CL_TRUE, 0,
+                                                            sizeof(HOST_DATA_TYPE) *
+                                                            (config.programSettings->dataSize / config.programSettings->kernelReplications),
+                                                            &data[r * (config.programSettings->dataSize / config.programSettings->kernelReplications)]);
+                    }
                     ASSERT_CL(err)
 #endif
                 }
@@ -173,6 +240,8 @@ namespace bm_execution {
 #pragma omp for
                 for (int r = 0; r < config.programSettings->kernelReplications; r++) {
                     compute_queue[r].finish();
+                    std::chrono::duration<double> replicationTime = std::chrono::high_resolution_clock::now() - t1;
+                    replicationTimes[r] = replicationTime.count();
                 }
 #pragma omp master
                 {
@@ -181,9 +250,22 @@ namespace bm_execution {
                             std::chrono::duration_cast<std::chrono::duration<double>>
                                     (t2 - t1);
                     executionTimes.push_back(timespan.count());
+                    // A device is done when the last kernel replication executed on it is finished
+                    std::vector<double> deviceTimes(config.devices.size(), 0.0);
+                    for (int r = 0; r < config.programSettings->kernelReplications; r++) {
+                        deviceTimes[r % config.devices.size()] = std::max(deviceTimes[r % config.devices.size()], replicationTimes[r]);
+                    }
+                    deviceTimings.resize(deviceTimes.size());
+                    for (size_t d = 0; d < deviceTimes.size(); d++) {
+                        deviceTimings[d].push_back(deviceTimes[d]);
+                    }
                 }
             }
         }
+        config.repetitions->discardWarmup(executionTimes);
+        for (auto& t : deviceTimings) {
+            config.repetitions->discardWarmup(t);
+        }
 
         /* --- Read back results from Device --- */
         for (int r=0; r < config.programSettings->kernelReplications; r++) {
@@ -202,9 +284,14 @@ namespace bm_execution {
             ASSERT_CL(err)
         }
 
-        free(random_inits);
+        auto result = std::unique_ptr<random_access::RandomAccessExecutionTimings>(new random_access::RandomAccessExecutionTimings{executionTimes, deviceTimings});
+        if (config.programSettings->sizeSweepPoints > 0) {
+            execute_size_sweep(config, compute_queue, Buffer_randoms, accesskernel, random_inits, mpi_size, *result);
+        }
+
+        hpcc_base::host_memory::release(random_inits);
 
-        return std::unique_ptr<random_access::RandomAccessExecutionTimings>(new random_access::RandomAccessExecutionTimings{executionTimes});
+        return result;
     }
 
 }  // namespace bm_execution
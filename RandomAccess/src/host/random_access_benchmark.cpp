@@ -32,12 +32,63 @@ SOFTWARE.
 
 /* Project's headers */
 #include "execution.h"
+#include "hpcc_suite.hpp"
 #include "parameters.h"
 
+HOST_DATA_TYPE
+random_access::getRandomStartValue(HOST_DATA_TYPE n) {
+    n = n % PERIOD;
+    if (n == 0) {
+        return 0x1;
+    }
+    // m2[i] contains the random number after 2*i steps starting with 1
+    HOST_DATA_TYPE m2[BIT_SIZE];
+    HOST_DATA_TYPE temp = 0x1;
+    for (int i = 0; i < BIT_SIZE; i++) {
+        m2[i] = temp;
+        temp = (temp << 1) ^ ((static_cast<HOST_DATA_TYPE_SIGNED>(temp) < 0) ? POLY : 0);
+        temp = (temp << 1) ^ ((static_cast<HOST_DATA_TYPE_SIGNED>(temp) < 0) ? POLY : 0);
+    }
+    int i;
+    for (i = BIT_SIZE - 2; i >= 0; i--) {
+        if ((n >> i) & 1) {
+            break;
+        }
+    }
+    // The generator is a linear function over GF(2), so the number of steps can be doubled with the precalculated values
+    HOST_DATA_TYPE ran = 0x2;
+    while (i > 0) {
+        temp = 0;
+        for (int j = 0; j < BIT_SIZE; j++) {
+            if ((ran >> j) & 1) {
+                temp ^= m2[j];
+            }
+        }
+        ran = temp;
+        i -= 1;
+        if ((n >> i) & 1) {
+            ran = (ran << 1) ^ ((static_cast<HOST_DATA_TYPE_SIGNED>(ran) < 0) ? POLY : 0);
+        }
+    }
+    return ran;
+}
+
+void
+random_access::calculateRngStartValues(HOST_DATA_TYPE* startValues, size_t numRngs, HOST_DATA_TYPE chunk) {
+#pragma omp parallel for
+    for (long r = 0; r < static_cast<long>(numRngs); r++) {
+        startValues[r] = getRandomStartValue(r * chunk);
+    }
+}
+
 random_access::RandomAccessProgramSettings::RandomAccessProgramSettings(cxxopts::ParseResult &results) : hpcc_base::BaseSettings(results),
     dataSize((1UL << results["d"].as<size_t>())),
     kernelReplications(results["r"].as<uint>()),
-    numRngs((1UL << results["g"].as<uint>())) {
+    numRngs((1UL << results["g"].as<uint>())),
+    updateBatchSize((1UL << results["update-batch"].as<uint>())),
+    sizeSweepPoints(results["size-sweep"].as<uint>()),
+    deviceTableReset(static_cast<bool>(results.count("device-reset"))),
+    sharedTable(static_cast<bool>(results.count("shared-table"))) {
 
 }
 
@@ -53,6 +104,12 @@ random_access::RandomAccessProgramSettings::getSettingsMap() {
     map["Array Size"] = ss.str();
     map["Kernel Replications"] = std::to_string(kernelReplications);
     map["#RNGs"] = std::to_string(numRngs);
+    if (communicationType == hpcc_base::CommunicationType::pcie_mpi) {
+        map["Update Batch Size"] = std::to_string(updateBatchSize);
+    }
+    map["Table Reset"] = deviceTableReset ? "device copy" : "host transfer";
+    map["Shared Table"] = sharedTable ? "Yes" : "No";
+    map["Table Size Sweep"] = (sizeSweepPoints > 0) ? std::to_string(sizeSweepPoints) + " sizes" : "disabled";
     return map;
 }
 
@@ -62,7 +119,7 @@ random_access::RandomAccessData::RandomAccessData(cl::Context& context, size_t s
                         clSVMAlloc(context(), 0 ,
                         size * sizeof(HOST_DATA_TYPE), 1024));
 #else
-    posix_memalign(reinterpret_cast<void**>(&data), 4096, size * sizeof(HOST_DATA_TYPE));
+    data = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(size);
 #endif
 }
 
@@ -70,7 +127,7 @@ random_access::RandomAccessData::~RandomAccessData() {
 #ifdef USE_SVM
     clSVMFree(context(), reinterpret_cast<void*>(data));
 #else
-    free(data);
+    hpcc_base::host_memory::release(data);
 #endif
 }
 
@@ -78,23 +135,48 @@ random_access::RandomAccessBenchmark::RandomAccessBenchmark(int argc, char* argv
     setupBenchmark(argc, argv);
 }
 
+hpcc_base::suite::BenchmarkResult
+random_access::runSuiteBenchmark(int argc, char* argv[]) {
+    return hpcc_base::suite::runBenchmark<random_access::RandomAccessBenchmark>(argc, argv);
+}
+
 void
 random_access::RandomAccessBenchmark::addAdditionalParseOptions(cxxopts::Options &options) {
     options.add_options()
         ("d", "Log2 of the size of the data array",
             cxxopts::value<size_t>()->default_value(std::to_string(DEFAULT_ARRAY_LENGTH_LOG)))
         ("g", "Log2 of the number of random number generators",
-            cxxopts::value<uint>()->default_value(std::to_string(HPCC_FPGA_RA_RNG_COUNT_LOG)));
+            cxxopts::value<uint>()->default_value(std::to_string(HPCC_FPGA_RA_RNG_COUNT_LOG)))
+        ("update-batch", "Log2 of the number of updates every rank generates before they are exchanged with the other ranks. Only used with the PCIE communication type",
+            cxxopts::value<uint>()->default_value("16"))
+        ("size-sweep", "Measure the GUOPS for the given number of table sizes after the benchmark execution. "\
+            "The table size is halved for every point starting with the size of the data array. 0 disables the sweep",
+            cxxopts::value<uint>()->default_value("0"))
+        ("device-reset", "Reset the data array between the repetitions with a copy of the initial data on the device instead of a transfer from the host. "\
+            "Needs twice the global memory for the data array")
+        ("shared-table", "Share a single logical table between all kernel replications. "\
+            "The updates are routed to the replication that owns the addressed memory bank. Needs the shared table kernel");
 }
 
 std::unique_ptr<random_access::RandomAccessExecutionTimings>
 random_access::RandomAccessBenchmark::executeKernel(RandomAccessData &data) {
-    return bm_execution::calculate(*executionSettings, data.data, mpi_comm_rank, mpi_comm_size);
+    switch (executionSettings->programSettings->communicationType) {
+        case hpcc_base::CommunicationType::cpu_only: return bm_execution::cpu::calculate(*executionSettings, data.data, mpi_comm_rank, mpi_comm_size);
+        case hpcc_base::CommunicationType::pcie_mpi: return bm_execution::pcie::calculate(*executionSettings, data.data, mpi_comm_rank, mpi_comm_size);
+        case hpcc_base::CommunicationType::unsupported:
+            if (executionSettings->programSettings->sharedTable) {
+                return bm_execution::shared::calculate(*executionSettings, data.data, mpi_comm_rank, mpi_comm_size);
+            }
+            return bm_execution::calculate(*executionSettings, data.data, mpi_comm_rank, mpi_comm_size);
+        default: throw std::runtime_error("Selected Communication type not supported: " + hpcc_base::commToString(executionSettings->programSettings->communicationType));
+    }
 }
 
 void
 random_access::RandomAccessBenchmark::collectAndPrintResults(const random_access::RandomAccessExecutionTimings &output) {
 
+    rawTimings["execution"] = output.times;
+
     std::vector<double> avgTimings(output.times.size());
 #ifdef _USE_MPI_
     // Copy the object variable to a local variable to make it accessible to the lambda function
@@ -121,10 +203,58 @@ random_access::RandomAccessBenchmark::collectAndPrintResults(const random_access
         }
         tmean = tmean / output.times.size();
 
+        derivedMetrics["best [s]"] = tmin;
+        derivedMetrics["mean [s]"] = tmean;
+        derivedMetrics["GUOPS"] = gups / tmin;
+
         std::cout << std::setw(ENTRY_SPACE)
                 << tmin << std::setw(ENTRY_SPACE) << tmean
                 << std::setw(ENTRY_SPACE) << gups / tmin
                 << std::endl;
+        printTimingStatistics({{"execution", avgTimings}});
+        printDeviceResults("execution", output.deviceTimings, gups / mpi_comm_size, "GUOPS");
+        // Every kernel replication can apply at most one update per cycle. Every update reads and writes a full
+        // memory word, since the updates address random values
+        hpcc_base::Roofline roofline{mpi_comm_size * executionSettings->programSettings->kernelReplications * getKernelFrequency(),
+                                    mpi_comm_size * getMemoryPeak(), 2.0 * executionSettings->programSettings->memoryBankWidth};
+        printEfficiency({{"execution", {gups / tmin, roofline}}}, "GUOPS", 1.0e-9);
+    }
+
+    if (executionSettings->programSettings->sharedTable) {
+        HOST_DATA_TYPE counts[2] = {output.routedUpdates, output.crossBankUpdates};
+#ifdef _USE_MPI_
+        HOST_DATA_TYPE total_counts[2];
+        MPI_Reduce(counts, total_counts, 2, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+        counts[0] = total_counts[0];
+        counts[1] = total_counts[1];
+#endif
+        if (mpi_comm_rank == 0) {
+            double cross_bank_fraction = (counts[0] > 0) ? static_cast<double>(counts[1]) / counts[0] : 0.0;
+            derivedMetrics["cross-bank fraction"] = cross_bank_fraction;
+            std::cout << "Cross-bank updates: " << cross_bank_fraction * 100 << "% of " << counts[0] << " routed updates" << std::endl;
+        }
+    }
+
+    if (!output.sweepSizes.empty()) {
+        // All ranks execute the sweep synchronously, so the slowest rank defines the time of a point
+        std::vector<double> sweepTimes(output.sweepTimes.size());
+#ifdef _USE_MPI_
+        MPI_Reduce(output.sweepTimes.data(), sweepTimes.data(), output.sweepTimes.size(), MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+#else
+        std::copy(output.sweepTimes.begin(), output.sweepTimes.end(), sweepTimes.begin());
+#endif
+        if (mpi_comm_rank == 0) {
+            std::cout << "Table size sweep:" << std::endl;
+            std::cout << std::setw(ENTRY_SPACE) << "Table Size" << std::setw(ENTRY_SPACE) << "best [s]"
+                    << std::setw(ENTRY_SPACE) << "GUOPS" << std::setw(ENTRY_SPACE) << "ns/update" << std::endl;
+            for (size_t i = 0; i < output.sweepSizes.size(); i++) {
+                double updates = 4.0 * output.sweepSizes[i];
+                double sweep_gups = updates / sweepTimes[i] * 1.0e-9;
+                derivedMetrics["Sweep " + std::to_string(output.sweepSizes[i]) + " GUOPS"] = sweep_gups;
+                std::cout << std::setw(ENTRY_SPACE) << output.sweepSizes[i] << std::setw(ENTRY_SPACE) << sweepTimes[i]
+                        << std::setw(ENTRY_SPACE) << sweep_gups << std::setw(ENTRY_SPACE) << 1.0 / sweep_gups << std::endl;
+            }
+        }
     }
 }
 
@@ -142,9 +272,39 @@ random_access::RandomAccessBenchmark::checkInputParameters() {
         std::cerr << "ERROR: Data chunk size for each kernel replication is not a power of 2!" << std::endl;
         validationResult = false;
     }
+    if (executionSettings->programSettings->updateBatchSize == 0 || executionSettings->programSettings->updateBatchSize > (1UL << 30)) {
+        std::cerr << "ERROR: Update batch size has to be between 1 and 2^30!" << std::endl;
+        validationResult = false;
+    }
+    if (executionSettings->programSettings->sizeSweepPoints > 0 && executionSettings->programSettings->communicationType != hpcc_base::CommunicationType::unsupported) {
+        std::cerr << "ERROR: The table size sweep is only supported by the FPGA implementation without update exchange!" << std::endl;
+        validationResult = false;
+    }
+    if (executionSettings->programSettings->sharedTable && executionSettings->programSettings->communicationType != hpcc_base::CommunicationType::unsupported) {
+        std::cerr << "ERROR: The shared table is only supported by the FPGA implementation without update exchange!" << std::endl;
+        validationResult = false;
+    }
+    if (executionSettings->programSettings->sharedTable && executionSettings->programSettings->sizeSweepPoints > 0) {
+        std::cerr << "ERROR: The table size sweep is not supported in combination with the shared table!" << std::endl;
+        validationResult = false;
+    }
     return validationResult;
 }
 
+bool
+random_access::RandomAccessBenchmark::setAutomaticSize(hpcc_base::MemoryLimits const& limits) {
+    auto& settings = *executionSettings->programSettings;
+    // The data array is split equally between the kernel replications
+    double max_values = std::min(limits.totalMemory / sizeof(HOST_DATA_TYPE),
+                                settings.kernelReplications * limits.maxBufferSize / sizeof(HOST_DATA_TYPE));
+    size_t size = static_cast<size_t>(hpcc_base::largestPowerOfTwo(max_values));
+    if (size < settings.kernelReplications) {
+        return false;
+    }
+    settings.dataSize = size;
+    return true;
+}
+
 std::unique_ptr<random_access::RandomAccessData>
 random_access::RandomAccessBenchmark::generateInputData() {
     auto d = std::unique_ptr<RandomAccessData>(new RandomAccessData(*executionSettings->context, executionSettings->programSettings->dataSize));
@@ -157,55 +317,54 @@ random_access::RandomAccessBenchmark::generateInputData() {
 bool  
 random_access::RandomAccessBenchmark::validateOutputAndPrintError(random_access::RandomAccessData &data) {
 
-    HOST_DATA_TYPE* rawdata;
-    if (mpi_comm_size > 1) {
-#ifdef _USE_MPI_
-        if (mpi_comm_rank == 0) {
-            rawdata = new HOST_DATA_TYPE[executionSettings->programSettings->dataSize * mpi_comm_size];
-        }
-        MPI_Gather(data.data, executionSettings->programSettings->dataSize, MPI_LONG, 
-                rawdata, executionSettings->programSettings->dataSize, MPI_LONG, 0, MPI_COMM_WORLD);
-#endif
-    }
-    else {
-        rawdata = data.data;
-    }
-
-
-    if (mpi_comm_rank == 0) {
-
-        // Serially execute all pseudo random updates again
-        // This should lead to the initial values in the data array, because XOR is a involutory function
-        HOST_DATA_TYPE temp = 1;
-        for (HOST_DATA_TYPE i=0; i < 4L*executionSettings->programSettings->dataSize * mpi_comm_size; i++) {
+    // Every rank executes all pseudo random updates again, but only applies the updates to its own part of the table.
+    // This should lead to the initial values in the data array, because XOR is a involutory function
+    const HOST_DATA_TYPE local_size = executionSettings->programSettings->dataSize;
+    const HOST_DATA_TYPE global_mask = local_size * mpi_comm_size - 1;
+    const HOST_DATA_TYPE local_offset = local_size * mpi_comm_rank;
+    const HOST_DATA_TYPE total_updates = 4 * local_size * mpi_comm_size;
+    // The update stream is split into blocks that start with the jump-ahead, so they can be replayed in parallel
+    const HOST_DATA_TYPE num_blocks = std::min(static_cast<HOST_DATA_TYPE>(1024), total_updates);
+    HOST_DATA_TYPE* table = data.data;
+#pragma omp parallel for schedule(dynamic)
+    for (long b = 0; b < static_cast<long>(num_blocks); b++) {
+        HOST_DATA_TYPE first = total_updates / num_blocks * b;
+        HOST_DATA_TYPE last = (b == static_cast<long>(num_blocks) - 1) ? total_updates : total_updates / num_blocks * (b + 1);
+        HOST_DATA_TYPE temp = getRandomStartValue(first);
+        for (HOST_DATA_TYPE i = first; i < last; i++) {
             HOST_DATA_TYPE_SIGNED v = 0;
             if (((HOST_DATA_TYPE_SIGNED)temp) < 0) {
                 v = POLY;
             }
             temp = (temp << 1) ^ v;
-            rawdata[(temp >> 3) & (executionSettings->programSettings->dataSize * mpi_comm_size - 1)] ^= temp;
+            HOST_DATA_TYPE address = ((temp >> 3) & global_mask) - local_offset;
+            if (address < local_size) {
+#pragma omp atomic
+                table[address] ^= temp;
+            }
         }
+    }
 
-        double errors = 0;
+    double errors = 0;
 #pragma omp parallel for reduction(+:errors)
-        for (HOST_DATA_TYPE i=0; i< executionSettings->programSettings->dataSize * mpi_comm_size; i++) {
-            if (rawdata[i] != i) {
-                // If the array at index i does not contain i, it differs from the initial value and is counted as an error
-                errors++;
-            }
+    for (HOST_DATA_TYPE i=0; i< local_size; i++) {
+        if (table[i] != local_offset + i) {
+            // If the array at index i does not contain i, it differs from the initial value and is counted as an error
+            errors++;
         }
+    }
+#ifdef _USE_MPI_
+    double total_errors = 0;
+    MPI_Reduce(&errors, &total_errors, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    errors = total_errors;
+#endif
 
+    if (mpi_comm_rank == 0) {
         // The overall error is calculated in percent of the overall array size
-        double error_ratio = static_cast<double>(errors) / (executionSettings->programSettings->dataSize * mpi_comm_size);
+        double error_ratio = static_cast<double>(errors) / (local_size * mpi_comm_size);
         std::cout  << "Error: " << error_ratio * 100 
                     << "%" << std::endl;
 
-#ifdef _USE_MPI_
-        if (mpi_comm_rank == 0 && mpi_comm_size > 1) {
-            delete [] rawdata;
-        }
-#endif
-
         return error_ratio < 0.01;
     }
 
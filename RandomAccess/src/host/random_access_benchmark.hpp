@@ -37,6 +37,28 @@ SOFTWARE.
  */
 namespace random_access {
 
+/**
+ * @brief Calculate the value of the pseudo random number generator after the given number of steps starting with 1.
+ *          The jump-ahead over GF(2) of the HPCC reference implementation (HPCC_starts) is used, which needs O(log n) operations
+ *          instead of n steps of the generator.
+ * 
+ * @param n Number of steps of the generator
+ * @return HOST_DATA_TYPE The random number after n steps
+ */
+HOST_DATA_TYPE
+getRandomStartValue(HOST_DATA_TYPE n);
+
+/**
+ * @brief Calculate the start values of all random number generators in parallel.
+ *          Generator r starts with the random number after r * chunk steps.
+ * 
+ * @param startValues Array that will contain the start values. Has to have numRngs elements.
+ * @param numRngs Number of random number generators
+ * @param chunk Number of random numbers that are generated by every generator
+ */
+void
+calculateRngStartValues(HOST_DATA_TYPE* startValues, size_t numRngs, HOST_DATA_TYPE chunk);
+
 /**
  * @brief The random access specific program settings
  * 
@@ -62,6 +84,33 @@ public:
      */
     uint numRngs;
 
+    /**
+     * @brief Number of updates every rank generates before they are exchanged with the other ranks.
+     *          Only used with the PCIE communication type.
+     * 
+     */
+    uint updateBatchSize;
+
+    /**
+     * @brief Number of smaller table sizes that are measured after the benchmark execution. 0 disables the sweep.
+     * 
+     */
+    uint sizeSweepPoints;
+
+    /**
+     * @brief If true, the data array is reset between the repetitions with a copy of the initial data on the device
+     *          instead of a transfer from the host
+     * 
+     */
+    bool deviceTableReset;
+
+    /**
+     * @brief If true, all kernel replications update a single logical table and the updates are routed
+     *          to the replication that owns the addressed memory bank
+     * 
+     */
+    bool sharedTable;
+
     /**
      * @brief Construct a new random access Program Settings object
      * 
@@ -126,6 +175,36 @@ public:
      */
     std::vector<double> times;
 
+    /**
+     * @brief The timings of all repetitions for every device used by the rank
+     * 
+     */
+    std::vector<std::vector<double>> deviceTimings;
+
+    /**
+     * @brief The logical table sizes over all ranks that are measured in the table size sweep
+     * 
+     */
+    std::vector<size_t> sweepSizes;
+
+    /**
+     * @brief The best execution time for every table size of the sweep
+     * 
+     */
+    std::vector<double> sweepTimes;
+
+    /**
+     * @brief Number of updates that were routed to the memory banks of the rank with the shared table
+     * 
+     */
+    HOST_DATA_TYPE routedUpdates;
+
+    /**
+     * @brief Number of routed updates that were forwarded to the memory bank of another kernel replication
+     * 
+     */
+    HOST_DATA_TYPE crossBankUpdates;
+
 };
 
 /**
@@ -189,6 +268,15 @@ public:
     bool
     checkInputParameters() override;
 
+    /**
+     * @brief Select the largest power of two as data size that fits into the device memory
+     * 
+     * @param limits The memory limits of the device
+     * @return true if a valid data size was found, false otherwise
+     */
+    bool
+    setAutomaticSize(hpcc_base::MemoryLimits const& limits) override;
+
     /**
      * @brief Construct a new RandomAccess Benchmark object
      * 
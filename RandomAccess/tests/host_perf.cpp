@@ -0,0 +1,53 @@
+//
+// Micro-benchmarks for the host code of the RandomAccess benchmark
+//
+#include <iostream>
+#include <sstream>
+
+#include "benchmark/benchmark.h"
+#include "host_perf_fixture.hpp"
+#include "random_access_benchmark.hpp"
+#include "parameters.h"
+
+/**
+ * The range gives the size of the data array
+ */
+class RandomAccessHostPerf : public hpcc_base::HostPerfFixture<random_access::RandomAccessBenchmark> {
+protected:
+    void
+    setDataSize(benchmark::State& state) override {
+        getBenchmark().getExecutionSettings().programSettings->dataSize = state.range(0);
+    }
+
+    size_t
+    getInputDataBytes(benchmark::State& state) override {
+        return state.range(0) * sizeof(HOST_DATA_TYPE);
+    }
+};
+
+BENCHMARK_DEFINE_F(RandomAccessHostPerf, GenerateInputData)(benchmark::State& state) {
+    measureInputDataGeneration(state);
+}
+BENCHMARK_REGISTER_F(RandomAccessHostPerf, GenerateInputData)->RangeMultiplier(4)->Range(1 << 16, 1 << 24)->Unit(benchmark::kMillisecond);
+
+/**
+ * Replay of all updates for the validation of the table.
+ * The printed error is discarded, so it does not mix with the output of the benchmark.
+ */
+BENCHMARK_DEFINE_F(RandomAccessHostPerf, ValidationReplay)(benchmark::State& state) {
+    auto data = generateData(state);
+    std::stringstream discarded_output;
+    auto cout_buffer = std::cout.rdbuf(discarded_output.rdbuf());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(getBenchmark().validateOutputAndPrintError(*data));
+        discarded_output.str("");
+    }
+    std::cout.rdbuf(cout_buffer);
+    // Every rank replays all updates of all ranks
+    int mpi_size = 1;
+#ifdef _USE_MPI_
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+#endif
+    state.SetItemsProcessed(state.iterations() * 4 * state.range(0) * mpi_size);
+}
+BENCHMARK_REGISTER_F(RandomAccessHostPerf, ValidationReplay)->RangeMultiplier(4)->Range(1 << 16, 1 << 22)->Unit(benchmark::kMillisecond);
@@ -1,9 +1,12 @@
 //
 // Created by Marius Meyer on 04.12.19
 //
+#include <algorithm>
+
 #include "gtest/gtest.h"
 #include "parameters.h"
 #include "random_access_benchmark.hpp"
+#include "execution.h"
 #include "test_program_settings.h"
 
 
@@ -56,3 +59,60 @@ TEST_F(RandomAccessHostCodeTest, ResultValidationWorksForWrongUpdates) {
     bool success = bm->validateOutputAndPrintError( *data);
     EXPECT_FALSE(success);
 }
+
+/**
+ * Check if the jump-ahead calculates the same start values as stepping the random number generator
+ */
+TEST_F(RandomAccessHostCodeTest, JumpAheadMatchesSequentialGenerator) {
+    HOST_DATA_TYPE ran = 1;
+    for (HOST_DATA_TYPE n = 0; n < 10000; n++) {
+        ASSERT_EQ(random_access::getRandomStartValue(n), ran);
+        ran = (ran << 1) ^ ((static_cast<HOST_DATA_TYPE_SIGNED>(ran) < 0) ? POLY : 0);
+    }
+    std::vector<HOST_DATA_TYPE> start_values(16);
+    random_access::calculateRngStartValues(start_values.data(), start_values.size(), 100);
+    for (size_t r = 0; r < start_values.size(); r++) {
+        EXPECT_EQ(start_values[r], random_access::getRandomStartValue(r * 100));
+    }
+}
+
+/**
+ * Check if the shared table is rejected in combination with the table size sweep
+ */
+TEST_F(RandomAccessHostCodeTest, SharedTableWithSizeSweepIsRejected) {
+    bm->getExecutionSettings().programSettings->sharedTable = true;
+    bm->getExecutionSettings().programSettings->sizeSweepPoints = 2;
+    EXPECT_FALSE(bm->checkInputParameters());
+}
+
+/**
+ * Check if the updates are sorted into the buckets of the ranks that store the updated values
+ */
+TEST_F(RandomAccessHostCodeTest, UpdatesAreSortedByDestinationRank) {
+    const HOST_DATA_TYPE local_size = 256;
+    const int mpi_size = 4;
+    std::vector<HOST_DATA_TYPE> updates(1000);
+    HOST_DATA_TYPE ran = 1;
+    for (auto& u : updates) {
+        ran = (ran << 1) ^ ((static_cast<HOST_DATA_TYPE_SIGNED>(ran) < 0) ? POLY : 0);
+        u = ran;
+    }
+    std::vector<HOST_DATA_TYPE> sorted(updates.size());
+    std::vector<int> counts;
+    std::vector<int> displacements;
+    bm_execution::pcie::sortUpdatesByRank(updates.data(), updates.size(), local_size, mpi_size, sorted, counts, displacements);
+    ASSERT_EQ(counts.size(), mpi_size);
+    int total = 0;
+    for (int r = 0; r < mpi_size; r++) {
+        EXPECT_EQ(displacements[r], total);
+        for (int i = displacements[r]; i < displacements[r] + counts[r]; i++) {
+            EXPECT_EQ(((sorted[i] >> 3) & (local_size * mpi_size - 1)) / local_size, r);
+        }
+        total += counts[r];
+    }
+    EXPECT_EQ(total, updates.size());
+    // No update is lost or duplicated
+    std::sort(updates.begin(), updates.end());
+    std::sort(sorted.begin(), sorted.end());
+    EXPECT_EQ(updates, sorted);
+}
@@ -15,6 +15,9 @@ struct RandomAccessKernelTest : testing::Test {
         bm = std::unique_ptr<random_access::RandomAccessBenchmark>(new random_access::RandomAccessBenchmark(global_argc, global_argv));
         bm->getExecutionSettings().programSettings->dataSize =  128 * NUM_REPLICATIONS * BUFFER_SIZE;
         bm->getExecutionSettings().programSettings->numRepetitions = 1;
+        // The shared table bitstream only contains the kernels for the shared table
+        bm->getExecutionSettings().programSettings->sharedTable =
+                (bm->getExecutionSettings().programSettings->kernelFileName.find("shared") != std::string::npos);
     }
 
     void SetUp() override {
@@ -49,3 +52,68 @@ TEST_F(RandomAccessKernelTest, FPGAErrorBelow1Percent) {
     bool success = bm->validateOutputAndPrintError(*data);
     EXPECT_TRUE(success);
 }
+
+/**
+ * The CPU backend calculates the same updates as the FPGA kernel
+ */
+TEST_F(RandomAccessKernelTest, CPUErrorBelow1Percent) {
+    bm->getExecutionSettings().programSettings->communicationType = hpcc_base::CommunicationType::cpu_only;
+    auto result = bm->executeKernel(*data);
+    EXPECT_EQ(result->times.size(), 1);
+    bool success = bm->validateOutputAndPrintError(*data);
+    EXPECT_TRUE(success);
+}
+
+/**
+ * The table size sweep measures the halved table sizes and does not change the validated results
+ */
+TEST_F(RandomAccessKernelTest, FPGASizeSweepMeasuresHalvedSizes) {
+    if (bm->getExecutionSettings().programSettings->communicationType != hpcc_base::CommunicationType::unsupported
+            || bm->getExecutionSettings().programSettings->sharedTable) {
+        GTEST_SKIP() << "The table size sweep is only supported by the single kernel";
+    }
+    bm->getExecutionSettings().programSettings->sizeSweepPoints = 3;
+    auto result = bm->executeKernel(*data);
+    ASSERT_EQ(result->sweepSizes.size(), 3);
+    ASSERT_EQ(result->sweepTimes.size(), 3);
+    for (size_t i = 1; i < result->sweepSizes.size(); i++) {
+        EXPECT_EQ(result->sweepSizes[i] * 2, result->sweepSizes[i - 1]);
+    }
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+/**
+ * Resetting the data array on the device leads to the same results as the transfer from the host
+ */
+TEST_F(RandomAccessKernelTest, FPGADeviceResetErrorBelow1Percent3Rep) {
+    if (bm->getExecutionSettings().programSettings->communicationType != hpcc_base::CommunicationType::unsupported) {
+        GTEST_SKIP() << "The table reset on the device is only supported by the single kernel";
+    }
+    bm->getExecutionSettings().programSettings->numRepetitions = 3;
+    bm->getExecutionSettings().programSettings->deviceTableReset = true;
+    auto result = bm->executeKernel(*data);
+    EXPECT_EQ(result->times.size(), 3);
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+/**
+ * With the shared table, the updates of the rank are routed to its memory banks and a large part of them
+ * is forwarded to another replication, because the addresses are spread over all banks
+ */
+TEST_F(RandomAccessKernelTest, FPGASharedTableRoutesUpdatesAcrossBanks) {
+    if (!bm->getExecutionSettings().programSettings->sharedTable) {
+        GTEST_SKIP() << "The shared table needs the shared table kernel";
+    }
+    auto result = bm->executeKernel(*data);
+    HOST_DATA_TYPE replications = bm->getExecutionSettings().programSettings->kernelReplications;
+    ASSERT_GT(result->routedUpdates, 0);
+    EXPECT_LE(result->crossBankUpdates, result->routedUpdates);
+    if (replications == 1) {
+        EXPECT_EQ(result->crossBankUpdates, 0);
+    }
+    else {
+        double cross_bank_fraction = static_cast<double>(result->crossBankUpdates) / result->routedUpdates;
+        EXPECT_GT(cross_bank_fraction, 0.5 * (replications - 1) / replications);
+    }
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
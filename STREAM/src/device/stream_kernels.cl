@@ -60,4 +60,88 @@ void triad_/*PY_CODE_GEN i*/(__global const DEVICE_ARRAY_DATA_TYPE * restrict in
     }
 }
 
+#ifdef ACCESS_PATTERN_KERNELS
+
+/*
+Kernels for additional memory access patterns. Indices and the stride are given in number of vectors,
+so every access transfers VECTOR_COUNT values.
+*/
+
+__kernel
+__attribute__((uses_global_work_offset(0)))
+void strided_/*PY_CODE_GEN i*/(__global const DEVICE_ARRAY_DATA_TYPE * restrict in,
+          __global DEVICE_ARRAY_DATA_TYPE * restrict out,
+          const uint stride,
+          const uint array_size) {
+    uint number_elements = array_size / VECTOR_COUNT;
+    // The address wraps around at the end of the array, so the modulo is not needed
+    uint address = 0;
+    __attribute__((opencl_unroll_hint(UNROLL_COUNT)))
+    for (uint i = 0; i < number_elements; i++) {
+        out[i] = in[address];
+        address += stride;
+        if (address >= number_elements) {
+            address -= number_elements;
+        }
+    }
+}
+
+__kernel
+__attribute__((uses_global_work_offset(0)))
+void gather_/*PY_CODE_GEN i*/(__global const DEVICE_ARRAY_DATA_TYPE * restrict in,
+          __global const uint * restrict index,
+          __global DEVICE_ARRAY_DATA_TYPE * restrict out,
+          const uint array_size) {
+    uint number_elements = array_size / VECTOR_COUNT;
+    __attribute__((opencl_unroll_hint(UNROLL_COUNT)))
+    for (uint i = 0; i < number_elements; i++) {
+        out[i] = in[index[i]];
+    }
+}
+
+__kernel
+__attribute__((uses_global_work_offset(0)))
+void scatter_/*PY_CODE_GEN i*/(__global const DEVICE_ARRAY_DATA_TYPE * restrict in,
+          __global const uint * restrict index,
+          __global DEVICE_ARRAY_DATA_TYPE * restrict out,
+          const uint array_size) {
+    uint number_elements = array_size / VECTOR_COUNT;
+    __attribute__((opencl_unroll_hint(UNROLL_COUNT)))
+    for (uint i = 0; i < number_elements; i++) {
+        out[index[i]] = in[i];
+    }
+}
+
+/*
+Only reads the input array and stores the maximum of every vector lane in out[0].
+The maximum does not depend on the order of the reads, so the result can be validated exactly.
+*/
+__kernel
+__attribute__((uses_global_work_offset(0)))
+void read_only_/*PY_CODE_GEN i*/(__global const DEVICE_ARRAY_DATA_TYPE * restrict in,
+          __global DEVICE_ARRAY_DATA_TYPE * restrict out,
+          const uint array_size) {
+    uint number_elements = array_size / VECTOR_COUNT;
+    DEVICE_ARRAY_DATA_TYPE maximum = in[0];
+    __attribute__((opencl_unroll_hint(UNROLL_COUNT)))
+    for (uint i = 1; i < number_elements; i++) {
+        maximum = fmax(maximum, in[i]);
+    }
+    out[0] = maximum;
+}
+
+__kernel
+__attribute__((uses_global_work_offset(0)))
+void write_only_/*PY_CODE_GEN i*/(__global DEVICE_ARRAY_DATA_TYPE * restrict out,
+          const DEVICE_SCALAR_DATA_TYPE scalar,
+          const uint array_size) {
+    uint number_elements = array_size / VECTOR_COUNT;
+    __attribute__((opencl_unroll_hint(UNROLL_COUNT)))
+    for (uint i = 0; i < number_elements; i++) {
+        out[i] = scalar;
+    }
+}
+
+#endif
+
 // PY_CODE_GEN block_end
@@ -24,6 +24,7 @@ SOFTWARE.
 
 /* C++ standard library headers */
 #include <complex>
+#include <functional>
 #include <memory>
 #include <vector>
 #include <map>
@@ -41,6 +42,12 @@ SOFTWARE.
 #define SCALE_KEY "Scale"
 #define ADD_KEY "Add"
 #define TRIAD_KEY "Triad"
+#define STREAMING_KEY "Streaming"
+#define STRIDED_KEY "Strided"
+#define GATHER_KEY "Gather"
+#define SCATTER_KEY "Scatter"
+#define READ_KEY "Read"
+#define WRITE_KEY "Write"
 
 namespace bm_execution {
 
@@ -50,16 +57,69 @@ namespace bm_execution {
             {COPY_KEY, 2.0},
             {SCALE_KEY, 2.0},
             {ADD_KEY, 3.0},
-            {TRIAD_KEY, 3.0}
+            {TRIAD_KEY, 3.0},
+            // all three arrays are written to and read from the device
+            {STREAMING_KEY, 6.0},
+            {STRIDED_KEY, 2.0},
+            // the index of every vector is read in addition to the input and output arrays
+            {GATHER_KEY, 2.0 + static_cast<double>(sizeof(cl_uint)) / (VECTOR_COUNT * sizeof(HOST_DATA_TYPE))},
+            {SCATTER_KEY, 2.0 + static_cast<double>(sizeof(cl_uint)) / (VECTOR_COUNT * sizeof(HOST_DATA_TYPE))},
+            {READ_KEY, 1.0},
+            {WRITE_KEY, 1.0}
     };
 
     /**
-     * @brief This method will prepare and execute the FPGA kernel and measure the execution time
+     * @brief This method will prepare and execute the FPGA kernel and measure the execution time.
+     *          If a streaming chunk size is given in the program settings, the arrays are streamed through the device
+     *          and only the end-to-end time of all operations is measured with the STREAMING_KEY.
      * 
      * @param config The ExecutionSettings with the OpenCL objects and program settings
      * @param A The array A of the stream benchmark
      * @param B The array B of the stream benchmark
      * @param C The array C of the stream benchmark
+     * @param resultsAvailable Optional function that is called as soon as the final results are copied back to the arrays,
+     *          but before the array size sweep and PCIe characterization are executed
+     * @return std::unique_ptr<stream::StreamExecutionTimings> The measured timings for all stream operations
+     */
+    std::unique_ptr<stream::StreamExecutionTimings>
+    calculate(const hpcc_base::ExecutionSettings<stream::StreamProgramSettings>& config,
+              HOST_DATA_TYPE* A,
+              HOST_DATA_TYPE* B,
+              HOST_DATA_TYPE* C,
+              std::function<void()> const& resultsAvailable = std::function<void()>());
+
+    /**
+     * @brief Calculate the log-spaced array sizes that are measured in the array size sweep
+     * 
+     * @param blockSize All sizes are a multiple of this block size. It is also the smallest size.
+     * @param maxSize The largest size of the sweep. It is rounded down to a multiple of the block size.
+     * @param points The number of sizes. Less sizes are returned, if the range does not contain enough distinct multiples of the block size.
+     * @return std::vector<uint> The sizes in ascending order
+     */
+    std::vector<uint>
+    sweepSizes(uint blockSize, uint maxSize, uint points);
+
+    /**
+     * @brief Calculate the indices that are used by the gather and scatter kernels.
+     *          The indices are a random permutation, so the scatter kernel writes every vector exactly once.
+     * 
+     * @param size Number of vectors in the arrays of a kernel replication
+     * @param seed Seed of the random number generator
+     * @return std::vector<cl_uint> The permutation of the indices 0 to size - 1
+     */
+    std::vector<cl_uint>
+    accessPatternIndices(uint size, uint seed);
+
+namespace cpu {
+
+    /**
+     * @brief Execute the stream operations on the host CPU using OpenMP. The same timing keys as for the FPGA are used
+     *          except for the PCIe transfers, so the results can be compared directly.
+     * 
+     * @param config The ExecutionSettings with the program settings. No OpenCL objects are used.
+     * @param A The array A of the stream benchmark
+     * @param B The array B of the stream benchmark
+     * @param C The array C of the stream benchmark
      * @return std::unique_ptr<stream::StreamExecutionTimings> The measured timings for all stream operations
      */
     std::unique_ptr<stream::StreamExecutionTimings>
@@ -68,6 +128,8 @@ namespace bm_execution {
               HOST_DATA_TYPE* B,
               HOST_DATA_TYPE* C);
 
+}  // namespace cpu
+
 }  // namespace bm_execution
 
 #endif  // SRC_HOST_EXECUTION_H_
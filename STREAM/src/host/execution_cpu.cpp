@@ -0,0 +1,115 @@
+/*
+Copyright (c) 2021 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "execution.hpp"
+
+/* C++ standard library headers */
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace bm_execution {
+namespace cpu {
+
+    /*
+    Implementation of the stream operations for the host CPU.
+     @copydoc bm_execution::cpu::calculate()
+    */
+    std::unique_ptr<stream::StreamExecutionTimings>
+    calculate(const hpcc_base::ExecutionSettings<stream::StreamProgramSettings>& config,
+            HOST_DATA_TYPE* A,
+            HOST_DATA_TYPE* B,
+            HOST_DATA_TYPE* C) {
+
+        if (config.programSettings->accessPatterns) {
+            throw std::runtime_error("The access patterns are only supported by the FPGA implementation!");
+        }
+        const long array_size = config.programSettings->streamArraySize;
+        const HOST_DATA_TYPE scalar = static_cast<HOST_DATA_TYPE>(3.0);
+        const HOST_DATA_TYPE test_scalar = static_cast<HOST_DATA_TYPE>(2.0);
+
+        std::map<std::string, std::vector<double>> timingMap;
+        timingMap.insert({COPY_KEY, std::vector<double>()});
+        timingMap.insert({SCALE_KEY, std::vector<double>()});
+        timingMap.insert({ADD_KEY, std::vector<double>()});
+        timingMap.insert({TRIAD_KEY, std::vector<double>()});
+
+        auto measure = [](std::function<void()> operation) {
+            auto startExecution = std::chrono::high_resolution_clock::now();
+            operation();
+            auto endExecution = std::chrono::high_resolution_clock::now();
+            return std::chrono::duration_cast<std::chrono::duration<double>>(endExecution - startExecution).count();
+        };
+
+        // Same test execution as for the FPGA. It scales A in place, which is considered by the validation.
+        double test_time = measure([&]() {
+            #pragma omp parallel for simd
+            for (long j = 0; j < array_size; j++) {
+                A[j] = test_scalar * A[j];
+            }
+        });
+        std::cout << "Each test below will take on the order of " << test_time * 1.0e6 << " microseconds." << std::endl;
+        std::cout << HLINE;
+
+        config.repetitions->start(*config.programSettings);
+        for (uint r = 0; config.repetitions->next(timingMap[TRIAD_KEY]); r++) {
+            timingMap[COPY_KEY].push_back(measure([&]() {
+                #pragma omp parallel for simd
+                for (long j = 0; j < array_size; j++) {
+                    C[j] = A[j];
+                }
+            }));
+            timingMap[SCALE_KEY].push_back(measure([&]() {
+                #pragma omp parallel for simd
+                for (long j = 0; j < array_size; j++) {
+                    B[j] = scalar * C[j];
+                }
+            }));
+            timingMap[ADD_KEY].push_back(measure([&]() {
+                #pragma omp parallel for simd
+                for (long j = 0; j < array_size; j++) {
+                    C[j] = A[j] + B[j];
+                }
+            }));
+            timingMap[TRIAD_KEY].push_back(measure([&]() {
+                #pragma omp parallel for simd
+                for (long j = 0; j < array_size; j++) {
+                    A[j] = B[j] + scalar * C[j];
+                }
+            }));
+        }
+        for (auto& t : timingMap) {
+            config.repetitions->discardWarmup(t.second);
+        }
+
+        std::unique_ptr<stream::StreamExecutionTimings> result(new stream::StreamExecutionTimings{
+                timingMap,
+                config.programSettings->streamArraySize,
+                std::map<std::string, std::vector<std::vector<double>>>()
+        });
+        return result;
+    }
+
+}  // namespace cpu
+}  // namespace bm_execution
@@ -24,9 +24,16 @@ SOFTWARE.
 #include "execution.hpp"
 
 /* C++ standard library headers */
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <memory>
+#include <numeric>
+#include <random>
 #include <vector>
 #include <chrono>
+#include <stdexcept>
+#include <string>
 
 /* External library headers */
 #include "CL/opencl.h"
@@ -34,10 +41,23 @@ SOFTWARE.
 #ifdef INTEL_FPGA
 #include "CL/cl_ext_intelfpga.h"
 #endif
+#ifdef XILINX_FPGA
+#include "CL/cl_ext_xilinx.h"
+#endif
 /* Project's headers */
+#include "command_sequence.hpp"
 
 namespace bm_execution {
 
+    /**
+     * @brief Get the properties for the command queues. Profiling is also enabled, if the bank report is requested.
+     * 
+     */
+    cl_command_queue_properties
+    get_queue_properties(const hpcc_base::ExecutionSettings<stream::StreamProgramSettings> &config) {
+        return config.profiler->getQueueProperties() | (config.programSettings->bankReport ? CL_QUEUE_PROFILING_ENABLE : 0);
+    }
+
     void initialize_buffers(const hpcc_base::ExecutionSettings<stream::StreamProgramSettings> &config, unsigned int data_per_kernel,
                             std::vector<cl::Buffer> &Buffers_A, std::vector<cl::Buffer> &Buffers_B,
                             std::vector<cl::Buffer> &Buffers_C);
@@ -63,6 +83,54 @@ namespace bm_execution {
                                        HOST_DATA_TYPE* C,
                                        std::vector<cl::CommandQueue> &command_queues);
 
+    /**
+     * @brief Device buffers and kernels of one of the two slots that are used alternately for the chunks in streaming mode
+     * 
+     */
+    struct StreamingSlot {
+        std::vector<cl::Buffer> Buffers_A;
+        std::vector<cl::Buffer> Buffers_B;
+        std::vector<cl::Buffer> Buffers_C;
+        std::vector<cl::Kernel> test_kernels;
+        std::vector<cl::Kernel> copy_kernels;
+        std::vector<cl::Kernel> scale_kernels;
+        std::vector<cl::Kernel> add_kernels;
+        std::vector<cl::Kernel> triad_kernels;
+    };
+
+    void execute_sweep(const hpcc_base::ExecutionSettings<stream::StreamProgramSettings> &config,
+                        unsigned int data_per_kernel, const std::vector<cl::Buffer> &Buffers_A,
+                        const std::vector<cl::Buffer> &Buffers_B,
+                        const std::vector<cl::Buffer> &Buffers_C,
+                        std::vector<cl::Kernel> &copy_kernels, std::vector<cl::Kernel> &scale_kernels,
+                        std::vector<cl::Kernel> &add_kernels, std::vector<cl::Kernel> &triad_kernels,
+                        std::vector<cl::CommandQueue> &command_queues,
+                        stream::StreamExecutionTimings &result);
+
+    void execute_pcie_sweep(const hpcc_base::ExecutionSettings<stream::StreamProgramSettings> &config,
+                        unsigned int data_per_kernel, const std::vector<cl::Buffer> &Buffers_A,
+                        const std::vector<cl::Buffer> &Buffers_B,
+                        stream::StreamExecutionTimings &result);
+
+    void execute_access_patterns(const hpcc_base::ExecutionSettings<stream::StreamProgramSettings> &config,
+                        unsigned int data_per_kernel, const std::vector<cl::Buffer> &Buffers_A,
+                        const std::vector<cl::Buffer> &Buffers_C,
+                        std::vector<cl::CommandQueue> &command_queues,
+                        stream::StreamExecutionTimings &result);
+
+    std::unique_ptr<stream::StreamExecutionTimings>
+    calculate_streaming(const hpcc_base::ExecutionSettings<stream::StreamProgramSettings>& config,
+            HOST_DATA_TYPE* A,
+            HOST_DATA_TYPE* B,
+            HOST_DATA_TYPE* C);
+
+    void enqueue_streaming_pass(const hpcc_base::ExecutionSettings<stream::StreamProgramSettings> &config,
+                                unsigned int data_per_kernel, unsigned int chunk_size, StreamingSlot* slots, bool test_pass,
+                                HOST_DATA_TYPE* A, HOST_DATA_TYPE* B, HOST_DATA_TYPE* C,
+                                std::vector<cl::CommandQueue> &write_queues,
+                                std::vector<cl::CommandQueue> &compute_queues,
+                                std::vector<cl::CommandQueue> &read_queues);
+
 /*
     Implementation for the single kernel.
      @copydoc bm_execution::calculate()
@@ -71,7 +139,12 @@ namespace bm_execution {
     calculate(const hpcc_base::ExecutionSettings<stream::StreamProgramSettings>& config,
             HOST_DATA_TYPE* A,
             HOST_DATA_TYPE* B,
-            HOST_DATA_TYPE* C) {
+            HOST_DATA_TYPE* C,
+            std::function<void()> const& resultsAvailable) {
+
+        if (config.programSettings->streamingChunkSize > 0) {
+            return calculate_streaming(config, A, B, C);
+        }
 
         unsigned data_per_kernel = config.programSettings->streamArraySize/config.programSettings->kernelReplications;
 
@@ -118,6 +191,8 @@ namespace bm_execution {
         timingMap.insert({SCALE_KEY, std::vector<double>()});
         timingMap.insert({ADD_KEY, std::vector<double>()});
         timingMap.insert({TRIAD_KEY, std::vector<double>()});
+        // Timings of the kernel operations for every device of the rank
+        std::map<std::string, std::vector<std::vector<double>>> deviceTimingMap;
 
         //
         // Do first test execution
@@ -134,7 +209,7 @@ namespace bm_execution {
                                 NULL, NULL));
 
 #else
-            ASSERT_CL(command_queues[i].enqueueWriteBuffer(Buffers_A[i], CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*data_per_kernel, &A[data_per_kernel*i]));
+            ASSERT_CL(command_queues[i].enqueueWriteBuffer(Buffers_A[i], CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*data_per_kernel, &A[data_per_kernel*i], nullptr, config.profiler->event("write_A")));
 #endif
         }
         for (int i=0; i<config.programSettings->kernelReplications; i++) {
@@ -142,7 +217,7 @@ namespace bm_execution {
         }
         startExecution = std::chrono::high_resolution_clock::now();
         for (int i=0; i<config.programSettings->kernelReplications; i++) {
-            ASSERT_CL(command_queues[i].enqueueNDRangeKernel(test_kernels[i], cl::NullRange, cl::NDRange(1)));
+            ASSERT_CL(command_queues[i].enqueueNDRangeKernel(test_kernels[i], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, config.profiler->event("test")));
         }
         for (int i=0; i<config.programSettings->kernelReplications; i++) {
             ASSERT_CL(command_queues[i].finish());
@@ -166,7 +241,7 @@ namespace bm_execution {
                         NULL, NULL));
 
 #else
-            ASSERT_CL(command_queues[i].enqueueReadBuffer(Buffers_A[i], CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*data_per_kernel, &A[data_per_kernel*i]));
+            ASSERT_CL(command_queues[i].enqueueReadBuffer(Buffers_A[i], CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*data_per_kernel, &A[data_per_kernel*i], nullptr, config.profiler->event("read_A")));
 #endif
         }
         for (int i=0; i<config.programSettings->kernelReplications; i++) {
@@ -177,7 +252,48 @@ namespace bm_execution {
         //
         // Do actual benchmark measurements
         //
-        for (uint r = 0; r < config.programSettings->numRepetitions; r++) {
+        // Record the commands of a repetition once, so they can be enqueued with low overhead in every repetition
+        hpcc_base::CommandSequence write_sequence(command_queues, *config.profiler);
+        hpcc_base::CommandSequence read_sequence(command_queues, *config.profiler);
+        hpcc_base::CommandSequence copy_sequence(command_queues, *config.profiler);
+        hpcc_base::CommandSequence scale_sequence(command_queues, *config.profiler);
+        hpcc_base::CommandSequence add_sequence(command_queues, *config.profiler);
+        hpcc_base::CommandSequence triad_sequence(command_queues, *config.profiler);
+        for (int i = 0; i < config.programSettings->kernelReplications; i++) {
+#ifndef USE_SVM
+            write_sequence.addWriteBuffer(i, Buffers_A[i], sizeof(HOST_DATA_TYPE) * data_per_kernel, &A[data_per_kernel * i], "write_A");
+            write_sequence.addWriteBuffer(i, Buffers_B[i], sizeof(HOST_DATA_TYPE) * data_per_kernel, &B[data_per_kernel * i], "write_B");
+            write_sequence.addWriteBuffer(i, Buffers_C[i], sizeof(HOST_DATA_TYPE) * data_per_kernel, &C[data_per_kernel * i], "write_C");
+            read_sequence.addReadBuffer(i, Buffers_A[i], sizeof(HOST_DATA_TYPE) * data_per_kernel, &A[data_per_kernel * i], "read_A");
+            read_sequence.addReadBuffer(i, Buffers_B[i], sizeof(HOST_DATA_TYPE) * data_per_kernel, &B[data_per_kernel * i], "read_B");
+            read_sequence.addReadBuffer(i, Buffers_C[i], sizeof(HOST_DATA_TYPE) * data_per_kernel, &C[data_per_kernel * i], "read_C");
+#endif
+            copy_sequence.addKernel(i, copy_kernels[i], "copy");
+            scale_sequence.addKernel(i, scale_kernels[i], "scale");
+            add_sequence.addKernel(i, add_kernels[i], "add");
+            triad_sequence.addKernel(i, triad_kernels[i], "triad");
+        }
+        for (auto sequence : {&write_sequence, &read_sequence, &copy_sequence, &scale_sequence, &add_sequence, &triad_sequence}) {
+            sequence->finalize();
+        }
+
+        // Kernel execution times of every replication that are measured with the events of the sequences for the bank report
+        std::map<std::string, std::vector<std::vector<double>>> replicationTimingMap;
+        auto record_replication_times = [&](std::string const& key, hpcc_base::CommandSequence const& sequence) {
+            if (!config.programSettings->bankReport) {
+                return;
+            }
+            replicationTimingMap[key].resize(config.programSettings->kernelReplications);
+            for (int i = 0; i < config.programSettings->kernelReplications; i++) {
+                cl::Event const& event = sequence.getCompletionEvent(i);
+                cl_ulong start = event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+                cl_ulong end = event.getProfilingInfo<CL_PROFILING_COMMAND_END>();
+                replicationTimingMap[key][i].push_back(static_cast<double>(end - start) * 1.0e-9);
+            }
+        };
+
+        config.repetitions->start(*config.programSettings);
+        for (uint r = 0; config.repetitions->next(timingMap[TRIAD_KEY]); r++) {
 
 
             startExecution = std::chrono::high_resolution_clock::now();
@@ -199,18 +315,11 @@ namespace bm_execution {
                             reinterpret_cast<void *>(&C[data_per_kernel * i]),
                             sizeof(HOST_DATA_TYPE) * data_per_kernel, 0,
                             NULL, NULL);
-#else
-                command_queues[i].enqueueWriteBuffer(Buffers_A[i], CL_FALSE, 0,
-                                                        sizeof(HOST_DATA_TYPE) * data_per_kernel,
-                                                        &A[data_per_kernel * i]);
-                command_queues[i].enqueueWriteBuffer(Buffers_B[i], CL_FALSE, 0,
-                                                        sizeof(HOST_DATA_TYPE) * data_per_kernel,
-                                                        &B[data_per_kernel * i]);
-                command_queues[i].enqueueWriteBuffer(Buffers_C[i], CL_FALSE, 0,
-                                                        sizeof(HOST_DATA_TYPE) * data_per_kernel,
-                                                        &C[data_per_kernel * i]);
 #endif
             }
+#ifndef USE_SVM
+            write_sequence.replay();
+#endif
 
             for (int i = 0; i < config.programSettings->kernelReplications; i++) {
                 command_queues[i].finish();
@@ -225,74 +334,78 @@ namespace bm_execution {
             int err;
             cl::UserEvent copy_user_event(*config.context, &err);
             ASSERT_CL(err);
-            std::vector<cl::Event> copy_start_events({copy_user_event});
-            std::vector<cl::Event> copy_events(config.programSettings->kernelReplications);
-            for (int i = 0; i < config.programSettings->kernelReplications; i++) {
-                command_queues[i].enqueueNDRangeKernel(copy_kernels[i], cl::NullRange, cl::NDRange(1), cl::NDRange(1), &copy_start_events, &copy_events[i]);
-            }
+            copy_sequence.replay(&copy_user_event);
 
             cl::UserEvent scale_user_event(*config.context, &err);
             ASSERT_CL(err);
-            std::vector<cl::Event> scale_start_events({scale_user_event});
-            std::vector<cl::Event> scale_events(config.programSettings->kernelReplications);
-            for (int i = 0; i < config.programSettings->kernelReplications; i++) {
-                command_queues[i].enqueueNDRangeKernel(scale_kernels[i], cl::NullRange, cl::NDRange(1), cl::NDRange(1), &scale_start_events, &scale_events[i]);
-            }
+            scale_sequence.replay(&scale_user_event);
 
             cl::UserEvent add_user_event(*config.context, &err);
             ASSERT_CL(err);
-            std::vector<cl::Event> add_start_events({add_user_event});
-            std::vector<cl::Event> add_events(config.programSettings->kernelReplications);
-            for (int i = 0; i < config.programSettings->kernelReplications; i++) {
-                command_queues[i].enqueueNDRangeKernel(add_kernels[i], cl::NullRange, cl::NDRange(1), cl::NDRange(1), &add_start_events, &add_events[i]);
-            }
+            add_sequence.replay(&add_user_event);
 
             cl::UserEvent triad_user_event(*config.context, &err);
             ASSERT_CL(err);
-            std::vector<cl::Event> triad_start_events({triad_user_event});
-            std::vector<cl::Event> triad_events(config.programSettings->kernelReplications);
-            for (int i = 0; i < config.programSettings->kernelReplications; i++) {
-                command_queues[i].enqueueNDRangeKernel(triad_kernels[i], cl::NullRange, cl::NDRange(1), cl::NDRange(1), &triad_start_events, &triad_events[i]);
-            }
+            triad_sequence.replay(&triad_user_event);
 
             startExecution = std::chrono::high_resolution_clock::now();
             copy_user_event.setStatus(CL_COMPLETE);
-            cl::Event::waitForEvents(copy_events);
+            auto copy_device_times = copy_sequence.finish(config.devices.size(), startExecution);
 
             endExecution = std::chrono::high_resolution_clock::now();
             duration = std::chrono::duration_cast<std::chrono::duration<double>>
                     (endExecution - startExecution);
             timingMap[COPY_KEY].push_back(duration.count());
+            deviceTimingMap[COPY_KEY].resize(copy_device_times.size());
+            for (size_t d = 0; d < copy_device_times.size(); d++) {
+                deviceTimingMap[COPY_KEY][d].push_back(copy_device_times[d]);
+            }
+            record_replication_times(COPY_KEY, copy_sequence);
 
             startExecution = std::chrono::high_resolution_clock::now();
 
             scale_user_event.setStatus(CL_COMPLETE);
-            cl::Event::waitForEvents(scale_events);
+            auto scale_device_times = scale_sequence.finish(config.devices.size(), startExecution);
 
             endExecution = std::chrono::high_resolution_clock::now();
             duration = std::chrono::duration_cast<std::chrono::duration<double>>
                     (endExecution - startExecution);
             timingMap[SCALE_KEY].push_back(duration.count());
+            deviceTimingMap[SCALE_KEY].resize(scale_device_times.size());
+            for (size_t d = 0; d < scale_device_times.size(); d++) {
+                deviceTimingMap[SCALE_KEY][d].push_back(scale_device_times[d]);
+            }
+            record_replication_times(SCALE_KEY, scale_sequence);
 
             startExecution = std::chrono::high_resolution_clock::now();
 
             add_user_event.setStatus(CL_COMPLETE);
-            cl::Event::waitForEvents(add_events);
+            auto add_device_times = add_sequence.finish(config.devices.size(), startExecution);
 
             endExecution = std::chrono::high_resolution_clock::now();
             duration = std::chrono::duration_cast<std::chrono::duration<double>>
                     (endExecution - startExecution);
             timingMap[ADD_KEY].push_back(duration.count());
+            deviceTimingMap[ADD_KEY].resize(add_device_times.size());
+            for (size_t d = 0; d < add_device_times.size(); d++) {
+                deviceTimingMap[ADD_KEY][d].push_back(add_device_times[d]);
+            }
+            record_replication_times(ADD_KEY, add_sequence);
 
             startExecution = std::chrono::high_resolution_clock::now();
 
             triad_user_event.setStatus(CL_COMPLETE);
-            cl::Event::waitForEvents(triad_events);
+            auto triad_device_times = triad_sequence.finish(config.devices.size(), startExecution);
 
             endExecution = std::chrono::high_resolution_clock::now();
             duration = std::chrono::duration_cast<std::chrono::duration<double>>
                     (endExecution - startExecution);
             timingMap[TRIAD_KEY].push_back(duration.count());
+            deviceTimingMap[TRIAD_KEY].resize(triad_device_times.size());
+            for (size_t d = 0; d < triad_device_times.size(); d++) {
+                deviceTimingMap[TRIAD_KEY][d].push_back(triad_device_times[d]);
+            }
+            record_replication_times(TRIAD_KEY, triad_sequence);
 
             startExecution = std::chrono::high_resolution_clock::now();
 
@@ -307,18 +420,11 @@ namespace bm_execution {
                 clEnqueueSVMUnmap(command_queues[i](),
                             reinterpret_cast<void *>(&C[data_per_kernel * i]), 0,
                             NULL, NULL);
-#else
-                command_queues[i].enqueueReadBuffer(Buffers_A[i], CL_FALSE, 0,
-                                                    sizeof(HOST_DATA_TYPE) * data_per_kernel,
-                                                    &A[data_per_kernel * i]);
-                command_queues[i].enqueueReadBuffer(Buffers_B[i], CL_FALSE, 0,
-                                                    sizeof(HOST_DATA_TYPE) * data_per_kernel,
-                                                    &B[data_per_kernel * i]);
-                command_queues[i].enqueueReadBuffer(Buffers_C[i], CL_FALSE, 0,
-                                                    sizeof(HOST_DATA_TYPE) * data_per_kernel,
-                                                    &C[data_per_kernel * i]);
 #endif
             }
+#ifndef USE_SVM
+            read_sequence.replay();
+#endif
 
             for (int i = 0; i < config.programSettings->kernelReplications; i++) {
                 command_queues[i].finish();
@@ -330,14 +436,465 @@ namespace bm_execution {
             timingMap[PCIE_READ_KEY].push_back(duration.count());
 
         }
+        for (auto& t : timingMap) {
+            config.repetitions->discardWarmup(t.second);
+        }
+        for (auto& t : deviceTimingMap) {
+            for (auto& d : t.second) {
+                config.repetitions->discardWarmup(d);
+            }
+        }
+        for (auto& t : replicationTimingMap) {
+            for (auto& d : t.second) {
+                config.repetitions->discardWarmup(d);
+            }
+        }
+
+        std::unique_ptr<stream::StreamExecutionTimings> result(new stream::StreamExecutionTimings{
+                timingMap,
+                config.programSettings->streamArraySize,
+                deviceTimingMap
+        });
+        result->replicationTimings = replicationTimingMap;
+        if (resultsAvailable) {
+            resultsAvailable();
+        }
+        if (config.programSettings->sweepPoints > 0) {
+            // The host arrays already contain the final results, so the sweep does not affect the validation
+            execute_sweep(config, data_per_kernel, Buffers_A, Buffers_B, Buffers_C, copy_kernels, scale_kernels,
+                            add_kernels, triad_kernels, command_queues, *result);
+        }
+        if (config.programSettings->pcieSweepPoints > 0) {
+            execute_pcie_sweep(config, data_per_kernel, Buffers_A, Buffers_B, *result);
+        }
+        if (config.programSettings->accessPatterns) {
+            // Like the sweeps, the access patterns only use the device buffers, which do not contain the results anymore
+            execute_access_patterns(config, data_per_kernel, Buffers_A, Buffers_C, command_queues, *result);
+        }
+        return result;
+    }
+
+    std::vector<uint>
+    sweepSizes(uint blockSize, uint maxSize, uint points) {
+        std::vector<uint> sizes;
+        uint max_blocks = maxSize / blockSize;
+        for (uint p = 0; p < points && max_blocks > 0; p++) {
+            double exponent = (points > 1) ? static_cast<double>(p) / (points - 1) : 1.0;
+            uint blocks = static_cast<uint>(std::round(std::pow(static_cast<double>(max_blocks), exponent)));
+            // Small sizes may be rounded to the same number of blocks
+            if (sizes.empty() || sizes.back() != blocks * blockSize) {
+                sizes.push_back(blocks * blockSize);
+            }
+        }
+        return sizes;
+    }
+
+    void execute_sweep(const hpcc_base::ExecutionSettings<stream::StreamProgramSettings> &config,
+                        unsigned int data_per_kernel, const std::vector<cl::Buffer> &Buffers_A,
+                        const std::vector<cl::Buffer> &Buffers_B,
+                        const std::vector<cl::Buffer> &Buffers_C,
+                        std::vector<cl::Kernel> &copy_kernels, std::vector<cl::Kernel> &scale_kernels,
+                        std::vector<cl::Kernel> &add_kernels, std::vector<cl::Kernel> &triad_kernels,
+                        std::vector<cl::CommandQueue> &command_queues,
+                        stream::StreamExecutionTimings &result) {
+#ifdef USE_SVM
+        throw std::runtime_error("The array size sweep is not supported in combination with SVM!");
+#endif
+        // The index of the size argument differs between the legacy kernels, but is the same for the single kernel
+        bool single = config.programSettings->useSingleKernel;
+        std::vector<std::pair<std::string, std::vector<cl::Kernel>*>> operations{{COPY_KEY, &copy_kernels},
+                {SCALE_KEY, &scale_kernels}, {ADD_KEY, &add_kernels}, {TRIAD_KEY, &triad_kernels}};
+        std::map<std::string, int> size_arg_index{{COPY_KEY, single ? 4 : 2}, {SCALE_KEY, single ? 4 : 3},
+                {ADD_KEY, single ? 4 : 3}, {TRIAD_KEY, 4}};
+
+        for (uint size : sweepSizes(VECTOR_COUNT * UNROLL_COUNT * BUFFER_SIZE, data_per_kernel, config.programSettings->sweepPoints)) {
+            for (int i = 0; i < config.programSettings->kernelReplications; i++) {
+                for (auto& op : operations) {
+                    ASSERT_CL((*op.second)[i].setArg(size_arg_index[op.first], size));
+                }
+                // Reset the used part of the buffers, so the values do not overflow over the repetitions
+                ASSERT_CL(command_queues[i].enqueueFillBuffer(Buffers_A[i], static_cast<HOST_DATA_TYPE>(1.0), 0, sizeof(HOST_DATA_TYPE) * size));
+                ASSERT_CL(command_queues[i].enqueueFillBuffer(Buffers_B[i], static_cast<HOST_DATA_TYPE>(2.0), 0, sizeof(HOST_DATA_TYPE) * size));
+                ASSERT_CL(command_queues[i].enqueueFillBuffer(Buffers_C[i], static_cast<HOST_DATA_TYPE>(0.0), 0, sizeof(HOST_DATA_TYPE) * size));
+            }
+            for (int i = 0; i < config.programSettings->kernelReplications; i++) {
+                ASSERT_CL(command_queues[i].finish());
+            }
+            std::map<std::string, double> min_times;
+            for (int r = 0; r < config.programSettings->numRepetitions; r++) {
+                for (auto& op : operations) {
+                    auto startExecution = std::chrono::high_resolution_clock::now();
+                    for (int i = 0; i < config.programSettings->kernelReplications; i++) {
+                        ASSERT_CL(command_queues[i].enqueueNDRangeKernel((*op.second)[i], cl::NullRange, cl::NDRange(1), cl::NullRange,
+                                                                    nullptr, config.profiler->event("sweep")));
+                    }
+                    for (int i = 0; i < config.programSettings->kernelReplications; i++) {
+                        ASSERT_CL(command_queues[i].finish());
+                    }
+                    std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - startExecution;
+                    if (r == 0 || duration.count() < min_times[op.first]) {
+                        min_times[op.first] = duration.count();
+                    }
+                }
+            }
+            result.sweepSizes.push_back(size * config.programSettings->kernelReplications);
+            for (auto& op : operations) {
+                result.sweepTimings[op.first].push_back(min_times[op.first]);
+            }
+        }
+    }
+
+    void execute_pcie_sweep(const hpcc_base::ExecutionSettings<stream::StreamProgramSettings> &config,
+                        unsigned int data_per_kernel, const std::vector<cl::Buffer> &Buffers_A,
+                        const std::vector<cl::Buffer> &Buffers_B,
+                        stream::StreamExecutionTimings &result) {
+#ifdef USE_SVM
+        throw std::runtime_error("The PCIe characterization is not supported in combination with SVM!");
+#endif
+        // The buffers of the first kernel replication are used. A is written and B is read, so both directions
+        // can be executed at the same time on separate queues.
+        size_t max_bytes = sizeof(HOST_DATA_TYPE) * data_per_kernel;
+        cl::CommandQueue write_queue(*config.context, config.getDevice(0), config.profiler->getQueueProperties());
+        cl::CommandQueue read_queue(*config.context, config.getDevice(0), config.profiler->getQueueProperties());
+
+        // Pageable host memory is allocated by the C++ runtime. Pinned host memory is allocated by the OpenCL runtime
+        // with CL_MEM_ALLOC_HOST_PTR and mapped to the host.
+        std::vector<HOST_DATA_TYPE> pageable_write(data_per_kernel);
+        std::vector<HOST_DATA_TYPE> pageable_read(data_per_kernel);
+        int err;
+        cl::Buffer pinned_write_buffer(*config.context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, max_bytes, nullptr, &err);
+        ASSERT_CL(err);
+        cl::Buffer pinned_read_buffer(*config.context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, max_bytes, nullptr, &err);
+        ASSERT_CL(err);
+        void* pinned_write = write_queue.enqueueMapBuffer(pinned_write_buffer, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, max_bytes, nullptr, nullptr, &err);
+        ASSERT_CL(err);
+        void* pinned_read = read_queue.enqueueMapBuffer(pinned_read_buffer, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, max_bytes, nullptr, nullptr, &err);
+        ASSERT_CL(err);
+
+        for (uint size : sweepSizes(1, data_per_kernel, config.programSettings->pcieSweepPoints)) {
+            size_t bytes = sizeof(HOST_DATA_TYPE) * size;
+            for (bool pinned : {false, true}) {
+                void* write_ptr = pinned ? pinned_write : reinterpret_cast<void*>(pageable_write.data());
+                void* read_ptr = pinned ? pinned_read : reinterpret_cast<void*>(pageable_read.data());
+                stream::PcieMeasurement measurement{bytes, pinned, 0.0, 0.0, 0.0};
+                for (int r = 0; r < config.programSettings->numRepetitions; r++) {
+                    auto startExecution = std::chrono::high_resolution_clock::now();
+                    ASSERT_CL(write_queue.enqueueWriteBuffer(Buffers_A[0], CL_FALSE, 0, bytes, write_ptr, nullptr, config.profiler->event("write")));
+                    ASSERT_CL(write_queue.finish());
+                    std::chrono::duration<double> write_time = std::chrono::high_resolution_clock::now() - startExecution;
+
+                    startExecution = std::chrono::high_resolution_clock::now();
+                    ASSERT_CL(read_queue.enqueueReadBuffer(Buffers_B[0], CL_FALSE, 0, bytes, read_ptr, nullptr, config.profiler->event("read")));
+                    ASSERT_CL(read_queue.finish());
+                    std::chrono::duration<double> read_time = std::chrono::high_resolution_clock::now() - startExecution;
+
+                    // Both transfers wait for the same user event, so they are started at the same time
+                    cl::UserEvent start_event(*config.context, &err);
+                    ASSERT_CL(err);
+                    std::vector<cl::Event> wait_list{start_event};
+                    ASSERT_CL(write_queue.enqueueWriteBuffer(Buffers_A[0], CL_FALSE, 0, bytes, write_ptr, &wait_list, config.profiler->event("duplex_write")));
+                    ASSERT_CL(read_queue.enqueueReadBuffer(Buffers_B[0], CL_FALSE, 0, bytes, read_ptr, &wait_list, config.profiler->event("duplex_read")));
+                    write_queue.flush();
+                    read_queue.flush();
+                    startExecution = std::chrono::high_resolution_clock::now();
+                    start_event.setStatus(CL_COMPLETE);
+                    ASSERT_CL(write_queue.finish());
+                    ASSERT_CL(read_queue.finish());
+                    std::chrono::duration<double> duplex_time = std::chrono::high_resolution_clock::now() - startExecution;
+
+                    if (r == 0 || write_time.count() < measurement.writeTime) {
+                        measurement.writeTime = write_time.count();
+                    }
+                    if (r == 0 || read_time.count() < measurement.readTime) {
+                        measurement.readTime = read_time.count();
+                    }
+                    if (r == 0 || duplex_time.count() < measurement.duplexTime) {
+                        measurement.duplexTime = duplex_time.count();
+                    }
+                }
+                result.pcieMeasurements.push_back(measurement);
+            }
+        }
+        ASSERT_CL(write_queue.enqueueUnmapMemObject(pinned_write_buffer, pinned_write));
+        ASSERT_CL(read_queue.enqueueUnmapMemObject(pinned_read_buffer, pinned_read));
+        ASSERT_CL(write_queue.finish());
+        ASSERT_CL(read_queue.finish());
+    }
+
+    std::vector<cl_uint>
+    accessPatternIndices(uint size, uint seed) {
+        std::vector<cl_uint> indices(size);
+        std::iota(indices.begin(), indices.end(), 0);
+        std::mt19937 generator(seed);
+        std::shuffle(indices.begin(), indices.end(), generator);
+        return indices;
+    }
+
+    void execute_access_patterns(const hpcc_base::ExecutionSettings<stream::StreamProgramSettings> &config,
+                        unsigned int data_per_kernel, const std::vector<cl::Buffer> &Buffers_A,
+                        const std::vector<cl::Buffer> &Buffers_C,
+                        std::vector<cl::CommandQueue> &command_queues,
+                        stream::StreamExecutionTimings &result) {
+#ifdef USE_SVM
+        throw std::runtime_error("The access patterns are not supported in combination with SVM!");
+#endif
+#ifndef ACCESS_PATTERN_KERNELS
+        throw std::runtime_error("The access patterns need kernels that are built with ACCESS_PATTERN_KERNELS!");
+#endif
+        int err;
+        const uint vectors = data_per_kernel / VECTOR_COUNT;
+        const cl_uint stride = config.programSettings->patternStride % vectors;
+        const HOST_DATA_TYPE scalar = static_cast<HOST_DATA_TYPE>(3.0);
+
+        // The input values are exactly representable also in half precision, so all results can be compared exactly
+        std::vector<HOST_DATA_TYPE> input(data_per_kernel);
+        for (uint j = 0; j < data_per_kernel; j++) {
+            input[j] = static_cast<HOST_DATA_TYPE>(static_cast<float>(j % 1024));
+        }
+        std::vector<cl_uint> indices = accessPatternIndices(vectors, 0);
+        std::vector<HOST_DATA_TYPE> lane_maximum(VECTOR_COUNT, input[0]);
+        for (uint j = 0; j < data_per_kernel; j++) {
+            lane_maximum[j % VECTOR_COUNT] = std::max(lane_maximum[j % VECTOR_COUNT], input[j]);
+        }
+
+        std::vector<cl::Buffer> Buffers_index;
+        for (int i = 0; i < config.programSettings->kernelReplications; i++) {
+            Buffers_index.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY, sizeof(cl_uint) * vectors));
+            ASSERT_CL(command_queues[i].enqueueWriteBuffer(Buffers_index[i], CL_FALSE, 0, sizeof(cl_uint) * vectors, indices.data()));
+            ASSERT_CL(command_queues[i].enqueueWriteBuffer(Buffers_A[i], CL_FALSE, 0, sizeof(HOST_DATA_TYPE) * data_per_kernel, input.data()));
+        }
+
+        /**
+         * @brief Kernel of an access pattern together with the expected values in the output buffer
+         * 
+         */
+        struct AccessPattern {
+            std::string key;
+            std::string kernelName;
+            std::function<void(cl::Kernel&, int)> setArgs;
+            size_t outputValues;
+            std::function<HOST_DATA_TYPE(size_t)> expected;
+        };
+        std::vector<AccessPattern> patterns{
+            {STRIDED_KEY, "strided", [&](cl::Kernel& k, int i) {
+                    ASSERT_CL(k.setArg(0, Buffers_A[i])); ASSERT_CL(k.setArg(1, Buffers_C[i]));
+                    ASSERT_CL(k.setArg(2, stride)); ASSERT_CL(k.setArg(3, data_per_kernel)); },
+                data_per_kernel, [&](size_t j) {
+                    return input[(static_cast<size_t>(j / VECTOR_COUNT) * stride % vectors) * VECTOR_COUNT + j % VECTOR_COUNT]; }},
+            {GATHER_KEY, "gather", [&](cl::Kernel& k, int i) {
+                    ASSERT_CL(k.setArg(0, Buffers_A[i])); ASSERT_CL(k.setArg(1, Buffers_index[i]));
+                    ASSERT_CL(k.setArg(2, Buffers_C[i])); ASSERT_CL(k.setArg(3, data_per_kernel)); },
+                data_per_kernel, [&](size_t j) {
+                    return input[indices[j / VECTOR_COUNT] * VECTOR_COUNT + j % VECTOR_COUNT]; }},
+            {SCATTER_KEY, "scatter", [&](cl::Kernel& k, int i) {
+                    ASSERT_CL(k.setArg(0, Buffers_A[i])); ASSERT_CL(k.setArg(1, Buffers_index[i]));
+                    ASSERT_CL(k.setArg(2, Buffers_C[i])); ASSERT_CL(k.setArg(3, data_per_kernel)); },
+                data_per_kernel, [&](size_t j) {
+                    return input[j]; }},
+            {READ_KEY, "read_only", [&](cl::Kernel& k, int i) {
+                    ASSERT_CL(k.setArg(0, Buffers_A[i])); ASSERT_CL(k.setArg(1, Buffers_C[i]));
+                    ASSERT_CL(k.setArg(2, data_per_kernel)); },
+                VECTOR_COUNT, [&](size_t j) {
+                    return lane_maximum[j]; }},
+            {WRITE_KEY, "write_only", [&](cl::Kernel& k, int i) {
+                    ASSERT_CL(k.setArg(0, Buffers_C[i])); ASSERT_CL(k.setArg(1, scalar));
+                    ASSERT_CL(k.setArg(2, data_per_kernel)); },
+                data_per_kernel, [&](size_t j) {
+                    return scalar; }}
+        };
+
+        std::vector<HOST_DATA_TYPE> output(data_per_kernel);
+        for (auto const& pattern : patterns) {
+            std::vector<cl::Kernel> kernels;
+            for (int i = 0; i < config.programSettings->kernelReplications; i++) {
+#ifdef XILINX_FPGA
+                std::string name = config.programSettings->useSingleKernel ?
+                            pattern.kernelName + "_0:{" + pattern.kernelName + "_0_" + std::to_string(i + 1) + "}" : pattern.kernelName + "_" + std::to_string(i);
+#else
+                std::string name = pattern.kernelName + "_" + std::to_string(i);
+#endif
+                kernels.push_back(cl::Kernel(*config.program, name.c_str(), &err));
+                ASSERT_CL(err);
+                pattern.setArgs(kernels[i], i);
+                // Remove the results of the previous pattern
+                ASSERT_CL(command_queues[i].enqueueFillBuffer(Buffers_C[i], static_cast<HOST_DATA_TYPE>(0.0), 0, sizeof(HOST_DATA_TYPE) * data_per_kernel));
+            }
+            for (int i = 0; i < config.programSettings->kernelReplications; i++) {
+                ASSERT_CL(command_queues[i].finish());
+            }
+            for (int r = 0; r < config.programSettings->numRepetitions; r++) {
+                auto startExecution = std::chrono::high_resolution_clock::now();
+                for (int i = 0; i < config.programSettings->kernelReplications; i++) {
+                    ASSERT_CL(command_queues[i].enqueueNDRangeKernel(kernels[i], cl::NullRange, cl::NDRange(1), cl::NullRange,
+                                                                nullptr, config.profiler->event(pattern.kernelName)));
+                }
+                for (int i = 0; i < config.programSettings->kernelReplications; i++) {
+                    ASSERT_CL(command_queues[i].finish());
+                }
+                std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - startExecution;
+                result.timings[pattern.key].push_back(duration.count());
+            }
+            size_t errors = 0;
+            for (int i = 0; i < config.programSettings->kernelReplications; i++) {
+                ASSERT_CL(command_queues[i].enqueueReadBuffer(Buffers_C[i], CL_TRUE, 0, sizeof(HOST_DATA_TYPE) * pattern.outputValues, output.data()));
+                for (size_t j = 0; j < pattern.outputValues; j++) {
+                    errors += (output[j] != pattern.expected(j)) ? 1 : 0;
+                }
+            }
+            result.patternErrors[pattern.key] = errors;
+        }
+    }
+
+    /*
+    Implementation of the streaming mode.
+    The arrays are split into chunks that are transferred to the device, processed by all four STREAM operations
+    and transferred back to the host. Two sets of device buffers are used alternately, so the write of chunk i+1,
+    the kernels on chunk i and the read of chunk i-1 can overlap in separate command queues.
+     @copydoc bm_execution::calculate()
+    */
+    std::unique_ptr<stream::StreamExecutionTimings>
+    calculate_streaming(const hpcc_base::ExecutionSettings<stream::StreamProgramSettings>& config,
+            HOST_DATA_TYPE* A,
+            HOST_DATA_TYPE* B,
+            HOST_DATA_TYPE* C) {
+#ifdef USE_SVM
+        throw std::runtime_error("The streaming mode is not supported in combination with SVM!");
+#endif
+        if (config.programSettings->sweepPoints > 0 || config.programSettings->pcieSweepPoints > 0 || config.programSettings->accessPatterns) {
+            throw std::runtime_error("The array size sweep, PCIe characterization and access patterns can not be combined with the streaming mode!");
+        }
+        unsigned data_per_kernel = config.programSettings->streamArraySize/config.programSettings->kernelReplications;
+        unsigned chunk_size = config.programSettings->streamingChunkSize;
+        if (data_per_kernel % chunk_size != 0) {
+            throw std::runtime_error("The array size per kernel replication (" + std::to_string(data_per_kernel)
+                                        + ") has to be a multiple of the streaming chunk size (" + std::to_string(chunk_size) + ")!");
+        }
+
+        StreamingSlot slots[2];
+        std::vector<cl::CommandQueue> write_queues;
+        std::vector<cl::CommandQueue> compute_queues;
+        std::vector<cl::CommandQueue> read_queues;
+
+        //
+        // Setup buffers and kernels for both slots. Only buffers of the chunk size are allocated on the device.
+        //
+        for (int s = 0; s < 2; s++) {
+            initialize_buffers(config, chunk_size, slots[s].Buffers_A, slots[s].Buffers_B, slots[s].Buffers_C);
+            // The queues that are created together with the kernels of the two slots are used for the transfers
+            std::vector<cl::CommandQueue> &transfer_queues = (s == 0) ? write_queues : read_queues;
+            bool success = false;
+            if (config.programSettings->useSingleKernel) {
+                success = initialize_queues_and_kernels_single(config, chunk_size, slots[s].Buffers_A, slots[s].Buffers_B, slots[s].Buffers_C,
+                                            slots[s].test_kernels, slots[s].copy_kernels, slots[s].scale_kernels,
+                                            slots[s].add_kernels, slots[s].triad_kernels, A, B, C, transfer_queues);
+            }
+            else {
+                success = initialize_queues_and_kernels(config, chunk_size, slots[s].Buffers_A, slots[s].Buffers_B, slots[s].Buffers_C,
+                                            slots[s].test_kernels, slots[s].copy_kernels, slots[s].scale_kernels,
+                                            slots[s].add_kernels, slots[s].triad_kernels, transfer_queues);
+            }
+            if (!success) {
+                return std::unique_ptr<stream::StreamExecutionTimings>(nullptr);
+            }
+        }
+        for (int i=0; i<config.programSettings->kernelReplications; i++) {
+            compute_queues.push_back(cl::CommandQueue(*config.context, config.getDevice(i), get_queue_properties(config)));
+        }
+
+        std::map<std::string, std::vector<double>> timingMap;
+        timingMap.insert({STREAMING_KEY, std::vector<double>()});
+
+        //
+        // Do first test execution
+        //
+        std::chrono::time_point<std::chrono::high_resolution_clock> startExecution, endExecution;
+        std::chrono::duration<double> duration;
+        startExecution = std::chrono::high_resolution_clock::now();
+        enqueue_streaming_pass(config, data_per_kernel, chunk_size, slots, true, A, B, C, write_queues, compute_queues, read_queues);
+        endExecution = std::chrono::high_resolution_clock::now();
+        duration = std::chrono::duration_cast<std::chrono::duration<double>>
+                (endExecution - startExecution);
+        std::cout << "Streaming the array A through the device took " << duration.count() * 1.0e6 << " microseconds." << std::endl;
+        std::cout << HLINE;
+
+        //
+        // Do actual benchmark measurements
+        //
+        config.repetitions->start(*config.programSettings);
+        for (uint r = 0; config.repetitions->next(timingMap[STREAMING_KEY]); r++) {
+            startExecution = std::chrono::high_resolution_clock::now();
+            enqueue_streaming_pass(config, data_per_kernel, chunk_size, slots, false, A, B, C, write_queues, compute_queues, read_queues);
+            endExecution = std::chrono::high_resolution_clock::now();
+            duration = std::chrono::duration_cast<std::chrono::duration<double>>
+                    (endExecution - startExecution);
+            timingMap[STREAMING_KEY].push_back(duration.count());
+        }
+        for (auto& t : timingMap) {
+            config.repetitions->discardWarmup(t.second);
+        }
 
         std::unique_ptr<stream::StreamExecutionTimings> result(new stream::StreamExecutionTimings{
                 timingMap,
-                config.programSettings->streamArraySize
+                config.programSettings->streamArraySize,
+                std::map<std::string, std::vector<std::vector<double>>>()
         });
         return result;
     }
 
+    void enqueue_streaming_pass(const hpcc_base::ExecutionSettings<stream::StreamProgramSettings> &config,
+                                unsigned int data_per_kernel, unsigned int chunk_size, StreamingSlot* slots, bool test_pass,
+                                HOST_DATA_TYPE* A, HOST_DATA_TYPE* B, HOST_DATA_TYPE* C,
+                                std::vector<cl::CommandQueue> &write_queues,
+                                std::vector<cl::CommandQueue> &compute_queues,
+                                std::vector<cl::CommandQueue> &read_queues) {
+        unsigned num_chunks = data_per_kernel / chunk_size;
+        size_t chunk_bytes = sizeof(HOST_DATA_TYPE) * chunk_size;
+        for (int i = 0; i < config.programSettings->kernelReplications; i++) {
+            // The last read of every chunk. A slot can be reused after the read of the chunk two steps before has finished.
+            std::vector<cl::Event> read_events(num_chunks);
+            for (unsigned c = 0; c < num_chunks; c++) {
+                StreamingSlot &slot = slots[c % 2];
+                size_t offset = static_cast<size_t>(data_per_kernel) * i + static_cast<size_t>(chunk_size) * c;
+                // The test pass only scales array A like the test kernel of the default execution
+                std::vector<std::pair<cl::Buffer*, HOST_DATA_TYPE*>> transfers{{&slot.Buffers_A[i], &A[offset]}};
+                std::vector<cl::Kernel*> kernels{&slot.test_kernels[i]};
+                if (!test_pass) {
+                    transfers.push_back({&slot.Buffers_B[i], &B[offset]});
+                    transfers.push_back({&slot.Buffers_C[i], &C[offset]});
+                    kernels = {&slot.copy_kernels[i], &slot.scale_kernels[i], &slot.add_kernels[i], &slot.triad_kernels[i]};
+                }
+
+                std::vector<cl::Event> write_wait;
+                if (c >= 2) {
+                    write_wait.push_back(read_events[c - 2]);
+                }
+                // All queues are in-order, so it is sufficient to wait for the last command of the previous stage
+                std::vector<cl::Event> kernel_wait(1);
+                for (auto const& t : transfers) {
+                    ASSERT_CL(write_queues[i].enqueueWriteBuffer(*t.first, CL_FALSE, 0, chunk_bytes, t.second,
+                                                                write_wait.empty() ? nullptr : &write_wait, &kernel_wait[0]));
+                    config.profiler->addEvent("write", kernel_wait[0]);
+                }
+                std::vector<cl::Event> read_wait(1);
+                for (size_t k = 0; k < kernels.size(); k++) {
+                    ASSERT_CL(compute_queues[i].enqueueNDRangeKernel(*kernels[k], cl::NullRange, cl::NDRange(1), cl::NullRange,
+                                                                    (k == 0) ? &kernel_wait : nullptr, &read_wait[0]));
+                    config.profiler->addEvent(test_pass ? "test" : "calc", read_wait[0]);
+                }
+                for (auto const& t : transfers) {
+                    ASSERT_CL(read_queues[i].enqueueReadBuffer(*t.first, CL_FALSE, 0, chunk_bytes, t.second,
+                                                                &read_wait, &read_events[c]));
+                    config.profiler->addEvent("read", read_events[c]);
+                }
+            }
+        }
+        for (auto queues : {&write_queues, &compute_queues, &read_queues}) {
+            for (auto &q : *queues) {
+                ASSERT_CL(q.finish());
+            }
+        }
+    }
+
     bool initialize_queues_and_kernels(const hpcc_base::ExecutionSettings<stream::StreamProgramSettings> &config,
                                        unsigned int data_per_kernel, const std::vector<cl::Buffer> &Buffers_A,
                                        const std::vector<cl::Buffer> &Buffers_B,
@@ -408,7 +965,7 @@ namespace bm_execution {
             err = triadkernel.setArg(4, data_per_kernel);
             ASSERT_CL(err);
 
-            command_queues.push_back(cl::CommandQueue(*config.context));
+            command_queues.push_back(cl::CommandQueue(*config.context, config.getDevice(i), get_queue_properties(config)));
             test_kernels.push_back(testkernel);
             copy_kernels.push_back(copykernel);
             scale_kernels.push_back(scalekernel);
@@ -587,7 +1144,7 @@ namespace bm_execution {
             err = triadkernel.setArg(5, TRIAD_KERNEL_TYPE);
             ASSERT_CL(err);
 
-            command_queues.push_back(cl::CommandQueue(*config.context));
+            command_queues.push_back(cl::CommandQueue(*config.context, config.getDevice(i), get_queue_properties(config)));
             test_kernels.push_back(testkernel);
             copy_kernels.push_back(copykernel);
             scale_kernels.push_back(scalekernel);
@@ -608,6 +1165,34 @@ namespace bm_execution {
 #endif
 #endif
 
+        if (config.programSettings->bankMapping != stream::BankMapping::default_mapping) {
+#if defined(INTEL_FPGA) && !defined(USE_HBM)
+            if (config.programSettings->useMemoryInterleaving) {
+                throw std::runtime_error("The bank mapping can not be used together with memory interleaving!");
+            }
+#endif
+            std::vector<cl::Buffer>* buffers[3] = {&Buffers_A, &Buffers_B, &Buffers_C};
+            for (int i=0; i < config.programSettings->kernelReplications; i++) {
+                for (uint a = 0; a < 3; a++) {
+                    uint bank = stream::getMemoryBank(config.programSettings->bankMapping, i, a,
+                                                        config.programSettings->kernelReplications, config.programSettings->numBanks);
+#if defined(INTEL_FPGA) && !defined(USE_HBM)
+                    buffers[a]->push_back(cl::Buffer(*config.context, mem_bits | ((bank + 1) << 16), sizeof(HOST_DATA_TYPE)*data_per_kernel));
+#elif defined(XILINX_FPGA)
+                    // The bank is given as index into the memory topology of the device, e.g. HBM[bank] on HBM boards
+                    cl_mem_ext_ptr_t bank_ext;
+                    bank_ext.flags = bank | XCL_MEM_TOPOLOGY;
+                    bank_ext.obj = nullptr;
+                    bank_ext.param = 0;
+                    buffers[a]->push_back(cl::Buffer(*config.context, mem_bits | CL_MEM_EXT_PTR_XILINX, sizeof(HOST_DATA_TYPE)*data_per_kernel, &bank_ext));
+#else
+                    throw std::runtime_error("The bank mapping is not supported for the memory of the device. Use the default mapping!");
+#endif
+                }
+            }
+            return;
+        }
+
         if (!config.programSettings->useMemoryInterleaving) {
             //Create Buffers for input and output
             for (int i=0; i < config.programSettings->kernelReplications; i++) {
@@ -29,18 +29,57 @@ SOFTWARE.
 /* C++ standard library headers */
 #include <memory>
 #include <random>
+#include <limits>
 
 /* Project's headers */
 #include "execution.hpp"
+#include "hpcc_suite.hpp"
 #include "parameters.h"
 
 stream::StreamProgramSettings::StreamProgramSettings(cxxopts::ParseResult &results) : hpcc_base::BaseSettings(results),
     streamArraySize(results["s"].as<uint>()),
     kernelReplications(results["r"].as<uint>()),
-    useSingleKernel(!static_cast<bool>(results.count("multi-kernel"))) {
+    useSingleKernel(!static_cast<bool>(results.count("multi-kernel"))),
+    streamingChunkSize(results["streaming-chunk"].as<uint>()),
+    sweepPoints(results["size-sweep"].as<uint>()),
+    bankMapping(stringToBankMapping(results["bank-mapping"].as<std::string>())),
+    numBanks(results["banks"].as<uint>() > 0 ? results["banks"].as<uint>() : kernelReplications),
+    bankReport(static_cast<bool>(results.count("bank-report"))),
+    pcieSweepPoints(results["pcie-sweep"].as<uint>()),
+    accessPatterns(static_cast<bool>(results.count("access-patterns"))),
+    patternStride(results["pattern-stride"].as<uint>()) {
 
 }
 
+stream::BankMapping
+stream::stringToBankMapping(std::string const& name) {
+    if (name == "default") return BankMapping::default_mapping;
+    if (name == "same") return BankMapping::same;
+    if (name == "split") return BankMapping::split;
+    if (name == "round-robin") return BankMapping::round_robin;
+    throw std::runtime_error("Unknown bank mapping: " + name + ". Use default, same, split or round-robin");
+}
+
+std::string
+stream::bankMappingToString(BankMapping mapping) {
+    switch (mapping) {
+        case BankMapping::same: return "same";
+        case BankMapping::split: return "split";
+        case BankMapping::round_robin: return "round-robin";
+        default: return "default";
+    }
+}
+
+uint
+stream::getMemoryBank(BankMapping mapping, uint replication, uint array, uint replications, uint banks) {
+    switch (mapping) {
+        case BankMapping::same: return replication % banks;
+        case BankMapping::split: return (3 * replication + array) % banks;
+        case BankMapping::round_robin: return (array * replications + replication) % banks;
+        default: throw std::runtime_error("The default bank mapping is defined by the kernel and not by the host");
+    }
+}
+
 std::map<std::string, std::string>
 stream::StreamProgramSettings::getSettingsMap() {
         auto map = hpcc_base::BaseSettings::getSettingsMap();
@@ -50,6 +89,11 @@ stream::StreamProgramSettings::getSettingsMap() {
         map["Array Size"] = ss.str();
         map["Kernel Replications"] = std::to_string(kernelReplications);
         map["Kernel Type"] = (useSingleKernel ? "Single" : "Separate");
+        map["Streaming Chunk Size"] = (streamingChunkSize > 0) ? std::to_string(streamingChunkSize) : "disabled";
+        map["Array Size Sweep"] = (sweepPoints > 0) ? std::to_string(sweepPoints) + " sizes" : "disabled";
+        map["PCIe Characterization"] = (pcieSweepPoints > 0) ? std::to_string(pcieSweepPoints) + " sizes" : "disabled";
+        map["Access Patterns"] = accessPatterns ? "stride " + std::to_string(patternStride) : "disabled";
+        map["Bank Mapping"] = bankMappingToString(bankMapping) + ((bankMapping != BankMapping::default_mapping) ? " over " + std::to_string(numBanks) + " banks" : "");
         return map;
 }
 
@@ -66,15 +110,15 @@ stream::StreamData::StreamData(const cl::Context& _context, size_t size) : conte
                             clSVMAlloc(context(), 0 ,
                             size * sizeof(HOST_DATA_TYPE), 1024));
 #else
-    posix_memalign(reinterpret_cast<void**>(&A), 64, size * sizeof(HOST_DATA_TYPE));
-    posix_memalign(reinterpret_cast<void**>(&B), 64, size * sizeof(HOST_DATA_TYPE));
-    posix_memalign(reinterpret_cast<void**>(&C), 64, size * sizeof(HOST_DATA_TYPE));
+    A = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(size);
+    B = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(size);
+    C = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(size);
 #endif
 #endif
 #ifdef XILINX_FPGA
-    posix_memalign(reinterpret_cast<void**>(&A), 4096, size * sizeof(HOST_DATA_TYPE));
-    posix_memalign(reinterpret_cast<void**>(&B), 4096, size * sizeof(HOST_DATA_TYPE));
-    posix_memalign(reinterpret_cast<void**>(&C), 4096, size * sizeof(HOST_DATA_TYPE));
+    A = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(size);
+    B = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(size);
+    C = hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(size);
 #endif
 }
 
@@ -84,9 +128,9 @@ stream::StreamData::~StreamData() {
     clSVMFree(context(), reinterpret_cast<void*>(B));
     clSVMFree(context(), reinterpret_cast<void*>(C));
 #else
-    free(A);
-    free(B);
-    free(C);
+    hpcc_base::host_memory::release(A);
+    hpcc_base::host_memory::release(B);
+    hpcc_base::host_memory::release(C);
 #endif
 }
 
@@ -94,20 +138,52 @@ stream::StreamBenchmark::StreamBenchmark(int argc, char* argv[]) : HpccFpgaBench
     setupBenchmark(argc, argv);
 }
 
+hpcc_base::suite::BenchmarkResult
+stream::runSuiteBenchmark(int argc, char* argv[]) {
+    return hpcc_base::suite::runBenchmark<stream::StreamBenchmark>(argc, argv);
+}
+
 void
 stream::StreamBenchmark::addAdditionalParseOptions(cxxopts::Options &options) {
         options.add_options()
             ("s", "Size of the data arrays",
              cxxopts::value<uint>()->default_value(std::to_string(DEFAULT_ARRAY_LENGTH)))
-            ("multi-kernel", "Use the legacy multi kernel implementation");
+            ("multi-kernel", "Use the legacy multi kernel implementation")
+            ("streaming-chunk", "Stream the arrays through the device in chunks of the given number of values. Transfers and kernel executions of consecutive chunks are overlapped. 0 disables streaming",
+             cxxopts::value<uint>()->default_value("0"))
+            ("size-sweep", "Measure the kernel bandwidth for the given number of log-spaced array sizes up to the array size after the benchmark execution. 0 disables the sweep",
+             cxxopts::value<uint>()->default_value("0"))
+            ("bank-mapping", "Placement of the arrays in the memory banks: default, same, split or round-robin",
+             cxxopts::value<std::string>()->default_value("default"))
+            ("banks", "Number of memory banks used by the bank mapping. 0 uses one bank per kernel replication",
+             cxxopts::value<uint>()->default_value("0"))
+            ("bank-report", "Measure the kernel execution times with OpenCL events and report the bandwidth of every kernel replication and its memory banks")
+            ("pcie-sweep", "Measure the PCIe bandwidth and latency in both directions and in full duplex for the given number of log-spaced transfer sizes after the benchmark execution. 0 disables the measurement",
+             cxxopts::value<uint>()->default_value("0"))
+            ("access-patterns", "Measure the strided, gather, scatter, read-only and write-only kernels after the benchmark execution. "\
+             "Needs kernels that are built with ACCESS_PATTERN_KERNELS")
+            ("pattern-stride", "Stride in number of vectors used by the strided kernel",
+             cxxopts::value<uint>()->default_value("16"));
 }
 
 std::unique_ptr<stream::StreamExecutionTimings>
 stream::StreamBenchmark::executeKernel(StreamData &data) {
-    return bm_execution::calculate(*executionSettings,
-              data.A,
-              data.B,
-              data.C);
+    pendingErrors = std::future<StreamErrors>();
+    std::function<void()> results_available;
+    if (executionSettings->programSettings->sweepPoints > 0 || executionSettings->programSettings->pcieSweepPoints > 0) {
+        // Calculate the errors on the host while the device executes the sweeps
+        results_available = [this, &data]() {
+            pendingErrors = std::async(std::launch::async, [this, &data]() { return calculateLocalErrors(data); });
+        };
+    }
+    std::unique_ptr<stream::StreamExecutionTimings> result;
+    switch (executionSettings->programSettings->communicationType) {
+        case hpcc_base::CommunicationType::cpu_only: result = bm_execution::cpu::calculate(*executionSettings, data.A, data.B, data.C); break;
+        case hpcc_base::CommunicationType::unsupported: result = bm_execution::calculate(*executionSettings, data.A, data.B, data.C, results_available); break;
+        default: throw std::runtime_error("Selected Communication type not supported: " + hpcc_base::commToString(executionSettings->programSettings->communicationType));
+    }
+    patternErrors = result ? result->patternErrors : std::map<std::string, size_t>();
+    return result;
 }
 
 void
@@ -115,6 +191,7 @@ stream::StreamBenchmark::collectAndPrintResults(const stream::StreamExecutionTim
 
     std::map<std::string,std::vector<double>> totalTimingsMap;
     for (auto v : output.timings) {
+        rawTimings[v.first] = v.second;
         // Number of experiment repetitions
         uint number_measurements = v.second.size();
         // create a new 
@@ -130,6 +207,48 @@ stream::StreamBenchmark::collectAndPrintResults(const stream::StreamExecutionTim
         totalTimingsMap.insert({v.first,avg_measures});
     }
 
+    // Average the sweep timings over all ranks in the same way
+    std::map<std::string,std::vector<double>> totalSweepMap;
+    for (auto const& v : output.sweepTimings) {
+        std::vector<double> avg_measures(v.second.size());
+#ifdef _USE_MPI_
+        int mpi_size = mpi_comm_size;
+        MPI_Reduce(v.second.data(), avg_measures.data(), v.second.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        std::for_each(avg_measures.begin(),avg_measures.end(), [mpi_size](double& x) {x /= mpi_size;});
+#else
+        std::copy(v.second.begin(), v.second.end(), avg_measures.begin());
+#endif
+        totalSweepMap.insert({v.first, avg_measures});
+    }
+
+    // Best kernel execution time of every replication. The slowest rank is reported, so underperforming banks are visible.
+    std::map<std::string,std::vector<double>> totalReplicationMap;
+    for (auto const& v : output.replicationTimings) {
+        std::vector<double> best_times;
+        for (auto const& r : v.second) {
+            best_times.push_back(r.empty() ? 0.0 : *min_element(r.begin(), r.end()));
+        }
+        std::vector<double> max_times(best_times.size());
+#ifdef _USE_MPI_
+        MPI_Reduce(best_times.data(), max_times.data(), best_times.size(), MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+#else
+        std::copy(best_times.begin(), best_times.end(), max_times.begin());
+#endif
+        totalReplicationMap.insert({v.first, max_times});
+    }
+
+    // The PCIe link of every rank is measured separately, so the slowest rank is reported
+    std::vector<double> pcie_times;
+    for (auto const& m : output.pcieMeasurements) {
+        pcie_times.insert(pcie_times.end(), {m.writeTime, m.readTime, m.duplexTime});
+    }
+    std::vector<double> max_pcie_times(pcie_times.size());
+#ifdef _USE_MPI_
+    MPI_Reduce(pcie_times.data(), max_pcie_times.data(), pcie_times.size(), MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+#else
+    std::copy(pcie_times.begin(), pcie_times.end(), max_pcie_times.begin());
+#endif
+
     if (mpi_comm_rank == 0) {
         std::cout << std::setw(ENTRY_SPACE) << "Function";
         std::cout << std::setw(ENTRY_SPACE) << "Best Rate MB/s";
@@ -142,15 +261,142 @@ stream::StreamBenchmark::collectAndPrintResults(const stream::StreamExecutionTim
             double avgTime = accumulate(v.second.begin(), v.second.end(), 0.0)
                             / v.second.size();
             double maxTime = *max_element(v.second.begin(), v.second.end());
+            double bestRate = (static_cast<double>(sizeof(HOST_DATA_TYPE)) * output.arraySize * bm_execution::multiplicatorMap[v.first] / minTime) * 1.0e-6 * mpi_comm_size;
+
+            derivedMetrics[v.first + " Best Rate [MB/s]"] = bestRate;
+            derivedMetrics[v.first + " Avg time [s]"] = avgTime;
+            derivedMetrics[v.first + " Min time [s]"] = minTime;
+            derivedMetrics[v.first + " Max time [s]"] = maxTime;
 
             std::cout << std::setw(ENTRY_SPACE) << v.first;
             std::cout << std::setw(ENTRY_SPACE)
-            << (static_cast<double>(sizeof(HOST_DATA_TYPE)) * output.arraySize * bm_execution::multiplicatorMap[v.first] / minTime) * 1.0e-6 * mpi_comm_size
+            << bestRate
                     << std::setw(ENTRY_SPACE) << avgTime
                     << std::setw(ENTRY_SPACE) << minTime
                     << std::setw(ENTRY_SPACE) << maxTime << std::endl;
         }
+        printTimingStatistics(totalTimingsMap);
+        // The single kernel accesses one array after the other with UNROLL_COUNT vectors per cycle,
+        // the separate kernels access all their arrays in parallel. Operations are given in bytes.
+        double kernel_peak = mpi_comm_size * executionSettings->programSettings->kernelReplications * UNROLL_COUNT * VECTOR_COUNT
+                                * static_cast<double>(sizeof(HOST_DATA_TYPE)) * getKernelFrequency();
+        std::map<std::string, std::pair<double, hpcc_base::Roofline>> efficiencies;
+        for (auto const& key : {COPY_KEY, SCALE_KEY, ADD_KEY, TRIAD_KEY}) {
+            if (derivedMetrics.count(std::string(key) + " Best Rate [MB/s]") > 0) {
+                double compute_peak = executionSettings->programSettings->useSingleKernel ? kernel_peak : kernel_peak * bm_execution::multiplicatorMap[key];
+                efficiencies[key] = {derivedMetrics[std::string(key) + " Best Rate [MB/s]"], {compute_peak, mpi_comm_size * getMemoryPeak(), 1.0}};
+            }
+        }
+        printEfficiency(efficiencies, "MB/s", 1.0e-6);
+        for (auto const& v : totalReplicationMap) {
+            std::cout << std::endl << std::setw(ENTRY_SPACE) << v.first << std::setw(ENTRY_SPACE) << "Banks A/B/C"
+                    << std::setw(ENTRY_SPACE) << "best [s]" << std::setw(ENTRY_SPACE) << "MB/s" << std::endl;
+            for (size_t r = 0; r < v.second.size(); r++) {
+                std::string banks = "default";
+                if (executionSettings->programSettings->bankMapping != BankMapping::default_mapping) {
+                    banks = "";
+                    for (uint a = 0; a < 3; a++) {
+                        banks += ((a > 0) ? "/" : "") + std::to_string(getMemoryBank(executionSettings->programSettings->bankMapping, r, a,
+                                                            executionSettings->programSettings->kernelReplications, executionSettings->programSettings->numBanks));
+                    }
+                }
+                double rate = static_cast<double>(sizeof(HOST_DATA_TYPE)) * output.arraySize / executionSettings->programSettings->kernelReplications
+                                    * bm_execution::multiplicatorMap[v.first] / v.second[r] * 1.0e-6;
+                derivedMetrics[v.first + " replication " + std::to_string(r) + " best [s]"] = v.second[r];
+                derivedMetrics[v.first + " replication " + std::to_string(r) + " MB/s"] = rate;
+                std::cout << std::setw(ENTRY_SPACE) << ("Replication " + std::to_string(r)) << std::setw(ENTRY_SPACE) << banks
+                        << std::setw(ENTRY_SPACE) << v.second[r] << std::setw(ENTRY_SPACE) << rate << std::endl;
+            }
+        }
+        if (!output.pcieMeasurements.empty()) {
+            std::cout << std::endl << "PCIe characterization:" << std::endl;
+            std::cout << std::setw(ENTRY_SPACE) << "Size [B]" << std::setw(ENTRY_SPACE) << "Host memory"
+                    << std::setw(ENTRY_SPACE) << "Write GB/s" << std::setw(ENTRY_SPACE) << "Read GB/s"
+                    << std::setw(ENTRY_SPACE) << "Duplex GB/s" << std::setw(ENTRY_SPACE) << "Write lat. us"
+                    << std::setw(ENTRY_SPACE) << "Read lat. us" << std::endl;
+            for (size_t i = 0; i < output.pcieMeasurements.size(); i++) {
+                auto const& m = output.pcieMeasurements[i];
+                double write_time = max_pcie_times[3 * i];
+                double read_time = max_pcie_times[3 * i + 1];
+                double duplex_time = max_pcie_times[3 * i + 2];
+                std::string prefix = std::string("PCIe ") + (m.pinned ? "pinned " : "pageable ") + std::to_string(m.bytes) + "B ";
+                derivedMetrics[prefix + "write [GB/s]"] = m.bytes / write_time * 1.0e-9;
+                derivedMetrics[prefix + "read [GB/s]"] = m.bytes / read_time * 1.0e-9;
+                // Data is transferred in both directions at the same time
+                derivedMetrics[prefix + "duplex [GB/s]"] = 2.0 * m.bytes / duplex_time * 1.0e-9;
+                derivedMetrics[prefix + "write latency [us]"] = write_time * 1.0e6;
+                derivedMetrics[prefix + "read latency [us]"] = read_time * 1.0e6;
+                std::cout << std::setw(ENTRY_SPACE) << m.bytes << std::setw(ENTRY_SPACE) << (m.pinned ? "pinned" : "pageable")
+                        << std::setw(ENTRY_SPACE) << derivedMetrics[prefix + "write [GB/s]"]
+                        << std::setw(ENTRY_SPACE) << derivedMetrics[prefix + "read [GB/s]"]
+                        << std::setw(ENTRY_SPACE) << derivedMetrics[prefix + "duplex [GB/s]"]
+                        << std::setw(ENTRY_SPACE) << derivedMetrics[prefix + "write latency [us]"]
+                        << std::setw(ENTRY_SPACE) << derivedMetrics[prefix + "read latency [us]"] << std::endl;
+            }
+        }
+        if (!output.sweepSizes.empty()) {
+            std::cout << "Array size sweep:" << std::endl;
+            std::cout << std::setw(ENTRY_SPACE) << "Array Size";
+            for (auto const& v : totalSweepMap) {
+                std::cout << std::setw(ENTRY_SPACE) << v.first + " GB/s";
+            }
+            std::cout << std::endl;
+            for (size_t i = 0; i < output.sweepSizes.size(); i++) {
+                std::cout << std::setw(ENTRY_SPACE) << output.sweepSizes[i];
+                for (auto const& v : totalSweepMap) {
+                    double rate = static_cast<double>(sizeof(HOST_DATA_TYPE)) * output.sweepSizes[i] * bm_execution::multiplicatorMap[v.first] / v.second[i] * 1.0e-9 * mpi_comm_size;
+                    derivedMetrics[v.first + " Sweep " + std::to_string(output.sweepSizes[i]) + " Best Rate [GB/s]"] = rate;
+                    std::cout << std::setw(ENTRY_SPACE) << rate;
+                }
+                std::cout << std::endl;
+            }
+        }
+        for (auto const& v : output.deviceTimings) {
+            printDeviceResults(v.first, v.second, static_cast<double>(sizeof(HOST_DATA_TYPE)) * output.arraySize * bm_execution::multiplicatorMap[v.first] * 1.0e-6, "MB/s");
+        }
+    }
+}
+
+bool
+stream::StreamBenchmark::setAutomaticSize(hpcc_base::MemoryLimits const& limits) {
+    auto& settings = *executionSettings->programSettings;
+    // Every replication uses a buffer for each of the three arrays
+    double max_values = std::min(limits.totalMemory / (3.0 * sizeof(HOST_DATA_TYPE)),
+                                settings.kernelReplications * limits.maxBufferSize / sizeof(HOST_DATA_TYPE));
+    max_values = std::min(max_values, static_cast<double>(std::numeric_limits<uint>::max()));
+    uint64_t unit = static_cast<uint64_t>(settings.kernelReplications) * VECTOR_COUNT * UNROLL_COUNT * BUFFER_SIZE;
+    uint64_t size = hpcc_base::largestMultiple(max_values, unit);
+    if (size == 0) {
+        return false;
+    }
+    settings.streamArraySize = static_cast<uint>(size);
+    return true;
+}
+
+std::unique_ptr<cl::Kernel>
+stream::StreamBenchmark::createEmptyKernel() {
+    bool single = executionSettings->programSettings->useSingleKernel;
+#ifdef XILINX_FPGA
+    std::string name = single ? "calc_0:{calc_0_1}" : "scale_0";
+#else
+    std::string name = single ? "calc_0" : "scale_0";
+#endif
+    int err;
+    std::unique_ptr<cl::Kernel> kernel(new cl::Kernel(*executionSettings->program, name.c_str(), &err));
+    ASSERT_CL(err)
+    // No values are accessed with an array size of zero, so the buffers are not needed
+    uint args = 0;
+    ASSERT_CL(kernel->setArg(args++, cl::Buffer()))
+    ASSERT_CL(kernel->setArg(args++, cl::Buffer()))
+    if (single) {
+        ASSERT_CL(kernel->setArg(args++, cl::Buffer()))
+    }
+    ASSERT_CL(kernel->setArg(args++, static_cast<HOST_DATA_TYPE>(2.0)))
+    ASSERT_CL(kernel->setArg(args++, 0u))
+    if (single) {
+        ASSERT_CL(kernel->setArg(args++, SCALE_KERNEL_TYPE))
     }
+    return kernel;
 }
 
 std::unique_ptr<stream::StreamData>
@@ -165,14 +411,41 @@ stream::StreamBenchmark::generateInputData() {
     return d;
 }
 
-bool  
-stream::StreamBenchmark::validateOutputAndPrintError(stream::StreamData &data) {
+stream::StreamErrors
+stream::calculateErrors(StreamData const& data, size_t size, double const expected[3], std::vector<size_t> const* indices) {
+    double a_sum = 0.0;
+    double b_sum = 0.0;
+    double c_sum = 0.0;
+    double aj = expected[0];
+    double bj = expected[1];
+    double cj = expected[2];
+    HOST_DATA_TYPE const* A = data.A;
+    HOST_DATA_TYPE const* B = data.B;
+    HOST_DATA_TYPE const* C = data.C;
+    if (indices != nullptr) {
+        size_t const* idx = indices->data();
+        long count = static_cast<long>(indices->size());
+#pragma omp parallel for reduction(+:a_sum,b_sum,c_sum)
+        for (long j = 0; j < count; j++) {
+            a_sum += std::abs(static_cast<double>(A[idx[j]]) - aj);
+            b_sum += std::abs(static_cast<double>(B[idx[j]]) - bj);
+            c_sum += std::abs(static_cast<double>(C[idx[j]]) - cj);
+        }
+        return {a_sum, b_sum, c_sum, indices->size()};
+    }
+    long count = static_cast<long>(size);
+#pragma omp parallel for simd reduction(+:a_sum,b_sum,c_sum)
+    for (long j = 0; j < count; j++) {
+        a_sum += std::abs(static_cast<double>(A[j]) - aj);
+        b_sum += std::abs(static_cast<double>(B[j]) - bj);
+        c_sum += std::abs(static_cast<double>(C[j]) - cj);
+    }
+    return {a_sum, b_sum, c_sum, size};
+}
+
+void
+stream::StreamBenchmark::getExpectedValues(double expected[3]) {
     HOST_DATA_TYPE aj,bj,cj,scalar;
-    double aSumErr,bSumErr,cSumErr;
-    double aAvgErr,bAvgErr,cAvgErr;
-    double epsilon;
-    ssize_t	j;
-    int	k,ierr,err;
 
     /* reproduce initialization */
     aj = static_cast<HOST_DATA_TYPE>(1.0);
@@ -182,81 +455,114 @@ stream::StreamBenchmark::validateOutputAndPrintError(stream::StreamData &data) {
     aj = static_cast<HOST_DATA_TYPE>(2.0) * aj;
     /* now execute timing loop */
     scalar = static_cast<HOST_DATA_TYPE>(3.0);
-    for (k=0; k<executionSettings->programSettings->numRepetitions; k++)
+    for (int k=0; k<executionSettings->repetitions->getExecutedRepetitions(); k++)
     {
         cj = aj;
         bj = scalar*cj;
         cj = aj+bj;
         aj = bj+scalar*cj;
     }
+    expected[0] = static_cast<double>(aj);
+    expected[1] = static_cast<double>(bj);
+    expected[2] = static_cast<double>(cj);
+}
 
-    /* accumulate deltas between observed and expected results */
-    aSumErr = 0.0;
-    bSumErr = 0.0;
-    cSumErr = 0.0;
-    for (j=0; j< executionSettings->programSettings->streamArraySize; j++) {
-        aSumErr += std::abs(data.A[j] - aj);
-        bSumErr += std::abs(data.B[j] - bj);
-        cSumErr += std::abs(data.C[j] - cj);
+stream::StreamErrors
+stream::StreamBenchmark::calculateLocalErrors(StreamData const& data) {
+    double expected[3];
+    getExpectedValues(expected);
+    if (executionSettings->programSettings->validationMode == hpcc_base::ValidationMode::sampled) {
+        // Only check randomly selected indices of the arrays
+        auto indices = hpcc_base::validation::sampleIndices(executionSettings->programSettings->validationErrorBound,
+                                                            executionSettings->programSettings->streamArraySize, mpi_comm_rank);
+        return calculateErrors(data, executionSettings->programSettings->streamArraySize, expected, &indices);
     }
-    aAvgErr = aSumErr / executionSettings->programSettings->streamArraySize;
-    bAvgErr = bSumErr / executionSettings->programSettings->streamArraySize;
-    cAvgErr = cSumErr / executionSettings->programSettings->streamArraySize;
+    return calculateErrors(data, executionSettings->programSettings->streamArraySize, expected, nullptr);
+}
+
+bool  
+stream::StreamBenchmark::validateOutputAndPrintError(stream::StreamData &data) {
+    double aAvgErr,bAvgErr,cAvgErr;
+    double epsilon;
+    int err;
+
+    double expected[3];
+    getExpectedValues(expected);
+    double aj = expected[0];
+    double bj = expected[1];
+    double cj = expected[2];
+
+    /* accumulate deltas between observed and expected results */
+    StreamErrors errors = pendingErrors.valid() ? pendingErrors.get() : calculateLocalErrors(data);
+    aAvgErr = errors.a / errors.checkedValues;
+    bAvgErr = errors.b / errors.checkedValues;
+    cAvgErr = errors.c / errors.checkedValues;
 
 #ifdef _USE_MPI_
     double totalAAvgErr = 0.0;
     double totalBAvgErr = 0.0;
     double totalCAvgErr = 0.0;
     MPI_Reduce(&aAvgErr, &totalAAvgErr, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
-    MPI_Reduce(&bAvgErr, &totalAAvgErr, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
-    MPI_Reduce(&cAvgErr, &totalAAvgErr, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&bAvgErr, &totalBAvgErr, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&cAvgErr, &totalCAvgErr, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
     aAvgErr = totalAAvgErr / mpi_comm_size;
     bAvgErr = totalBAvgErr / mpi_comm_size;
-    bAvgErr = totalBAvgErr / mpi_comm_size;
+    cAvgErr = totalCAvgErr / mpi_comm_size;
+#endif
+
+    // The wrong values of the access patterns are summed over all ranks
+    std::map<std::string, unsigned long> totalPatternErrors;
+    for (auto const& p : patternErrors) {
+        unsigned long pattern_errors = p.second;
+#ifdef _USE_MPI_
+        unsigned long total_pattern_errors = 0;
+        MPI_Reduce(&pattern_errors, &total_pattern_errors, 1, MPI_UNSIGNED_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+        pattern_errors = total_pattern_errors;
 #endif
+        totalPatternErrors[p.first] = pattern_errors;
+    }
 
     if (mpi_comm_rank == 0) {
 
         epsilon = std::numeric_limits<HOST_DATA_TYPE>::epsilon();
 
+        // Count the values of an array with a relative error larger than epsilon
+        long size = static_cast<long>(executionSettings->programSettings->streamArraySize);
+        auto count_errors = [size, epsilon](HOST_DATA_TYPE const* array, double expected_value) {
+            long errors = 0;
+#pragma omp parallel for simd reduction(+:errors)
+            for (long j = 0; j < size; j++) {
+                errors += (std::abs(static_cast<double>(array[j]) / expected_value - 1.0) > epsilon) ? 1 : 0;
+            }
+            return errors;
+        };
+
         err = 0;
-        if (abs(aAvgErr/aj) > epsilon) {
+        if (std::abs(aAvgErr/aj) > epsilon) {
             err++;
             printf ("Failed Validation on array a[], AvgRelAbsErr > epsilon (%e)\n",epsilon);
-            printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",aj,aAvgErr,abs(aAvgErr)/aj);
-            ierr = 0;
-            for (j=0; j<executionSettings->programSettings->streamArraySize; j++) {
-                if (abs(data.A[j]/aj-1.0) > epsilon) {
-                    ierr++;
-                }
-            }
-            printf("     For array a[], %d errors were found.\n",ierr);
+            printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",aj,aAvgErr,std::abs(aAvgErr)/aj);
+            printf("     For array a[], %ld errors were found.\n",count_errors(data.A, aj));
         }
-        if (abs(bAvgErr/bj) > epsilon) {
+        if (std::abs(bAvgErr/bj) > epsilon) {
             err++;
             printf ("Failed Validation on array b[], AvgRelAbsErr > epsilon (%e)\n",epsilon);
-            printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",bj,bAvgErr,abs(bAvgErr)/bj);
+            printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",bj,bAvgErr,std::abs(bAvgErr)/bj);
             printf ("     AvgRelAbsErr > Epsilon (%e)\n",epsilon);
-            ierr = 0;
-            for (j=0; j<executionSettings->programSettings->streamArraySize; j++) {
-                if (abs(data.B[j]/bj-1.0) > epsilon) {
-                    ierr++;
-                }
-            }
-            printf("     For array b[], %d errors were found.\n",ierr);
+            printf("     For array b[], %ld errors were found.\n",count_errors(data.B, bj));
         }
-        if (abs(cAvgErr/cj) > epsilon) {
+        if (std::abs(cAvgErr/cj) > epsilon) {
             err++;
             printf ("Failed Validation on array c[], AvgRelAbsErr > epsilon (%e)\n",epsilon);
-            printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",cj,cAvgErr,abs(cAvgErr)/cj);
+            printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",cj,cAvgErr,std::abs(cAvgErr)/cj);
             printf ("     AvgRelAbsErr > Epsilon (%e)\n",epsilon);
-            ierr = 0;
-            for (j=0; j<executionSettings->programSettings->streamArraySize; j++) {
-                if (abs(data.C[j]/cj-1.0) > epsilon) {
-                    ierr++;
-                }
+            printf("     For array c[], %ld errors were found.\n",count_errors(data.C, cj));
+        }
+        for (auto const& p : totalPatternErrors) {
+            if (p.second > 0) {
+                err++;
+                printf ("Failed Validation of the %s access pattern: %lu wrong values\n", p.first.c_str(), p.second);
             }
-            printf("     For array c[], %d errors were found.\n",ierr);
         }
         if (err == 0) {
             printf ("Solution Validates: avg error less than %e on all three arrays\n",epsilon);
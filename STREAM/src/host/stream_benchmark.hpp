@@ -25,6 +25,7 @@ SOFTWARE.
 
 /* C++ standard library headers */
 #include <complex>
+#include <future>
 #include <memory>
 
 /* Project's headers */
@@ -39,6 +40,67 @@ SOFTWARE.
  */
 namespace stream {
 
+/**
+ * @brief Policies to place the arrays A, B and C of every kernel replication in the memory banks of the device
+ * 
+ */
+enum class BankMapping {
+    /**
+     * @brief The placement defined by the kernel type and the build configuration is used
+     * 
+     */
+    default_mapping,
+
+    /**
+     * @brief All arrays of a replication are placed in the same bank
+     * 
+     */
+    same,
+
+    /**
+     * @brief The arrays of a replication are placed in three consecutive banks
+     * 
+     */
+    split,
+
+    /**
+     * @brief The buffers of all replications are distributed round-robin over all banks, one array after the other
+     * 
+     */
+    round_robin
+};
+
+/**
+ * @brief Convert the name of a bank mapping policy to the enum value
+ * 
+ * @param name One of default, same, split or round-robin
+ * @return BankMapping The policy. Throws a std::runtime_error for unknown names.
+ */
+BankMapping
+stringToBankMapping(std::string const& name);
+
+/**
+ * @brief Convert a bank mapping policy to its name
+ * 
+ * @param mapping The policy
+ * @return std::string The name of the policy
+ */
+std::string
+bankMappingToString(BankMapping mapping);
+
+/**
+ * @brief Get the memory bank of an array of a kernel replication for the given bank mapping policy
+ * 
+ * @param mapping The bank mapping policy. Must not be BankMapping::default_mapping
+ * @param replication Index of the kernel replication
+ * @param array Index of the array. 0 for A, 1 for B and 2 for C
+ * @param replications Total number of kernel replications
+ * @param banks Number of available memory banks
+ * @return uint Index of the memory bank starting with 0
+ */
+uint
+getMemoryBank(BankMapping mapping, uint replication, uint array, uint replications, uint banks);
+
 /**
  * @brief The STREAM specific program settings
  * 
@@ -64,6 +126,58 @@ public:
      */
     bool useSingleKernel;
 
+    /**
+     * @brief Number of values of every array that are transferred to the device at once in streaming mode.
+     *          If 0, the whole arrays are kept in device memory and the streaming mode is disabled.
+     * 
+     */
+    uint streamingChunkSize;
+
+    /**
+     * @brief Number of log-spaced array sizes that are measured in the array size sweep after the benchmark execution.
+     *          If 0, no sweep is executed.
+     * 
+     */
+    uint sweepPoints;
+
+    /**
+     * @brief The policy used to place the arrays in the memory banks
+     * 
+     */
+    BankMapping bankMapping;
+
+    /**
+     * @brief Number of memory banks that are used by the bank mapping policy
+     * 
+     */
+    uint numBanks;
+
+    /**
+     * @brief If true, the execution time of every kernel is measured with OpenCL events
+     *          to report the bandwidth of every kernel replication and its memory banks
+     * 
+     */
+    bool bankReport;
+
+    /**
+     * @brief Number of log-spaced transfer sizes that are measured in the PCIe characterization after the benchmark execution.
+     *          If 0, no characterization is executed.
+     * 
+     */
+    uint pcieSweepPoints;
+
+    /**
+     * @brief If true, the strided, gather, scatter, read-only and write-only kernels are measured after the benchmark execution
+     * 
+     */
+    bool accessPatterns;
+
+    /**
+     * @brief Stride in number of vectors that is used by the strided kernel
+     * 
+     */
+    uint patternStride;
+
     /**
      * @brief Construct a new Stream Program Settings object
      * 
@@ -127,6 +241,43 @@ public:
 
 };
 
+/**
+ * @brief Minimum transfer times measured for a single transfer size and host memory type in the PCIe characterization
+ * 
+ */
+struct PcieMeasurement {
+
+    /**
+     * @brief Size of a single transfer in bytes
+     * 
+     */
+    size_t bytes;
+
+    /**
+     * @brief True, if pinned host memory was used for the transfers. Pageable memory otherwise.
+     * 
+     */
+    bool pinned;
+
+    /**
+     * @brief Time of a single transfer from the host to the device in seconds
+     * 
+     */
+    double writeTime;
+
+    /**
+     * @brief Time of a single transfer from the device to the host in seconds
+     * 
+     */
+    double readTime;
+
+    /**
+     * @brief Time of a transfer in each direction that are executed at the same time in seconds
+     * 
+     */
+    double duplexTime;
+};
+
 /**
  * @brief Measured execution timing from the kernel execution
  * 
@@ -144,8 +295,89 @@ public:
      * 
      */
     uint arraySize;
+
+    /**
+     * @brief A map containing the timings of the kernel operations for every device used by the rank
+     * 
+     */
+    std::map<std::string,std::vector<std::vector<double>>> deviceTimings;
+
+    /**
+     * @brief The array sizes that were measured in the array size sweep. Empty, if no sweep was executed.
+     * 
+     */
+    std::vector<uint> sweepSizes;
+
+    /**
+     * @brief A map containing the minimum timings of the kernel operations for every size in sweepSizes
+     * 
+     */
+    std::map<std::string,std::vector<double>> sweepTimings;
+
+    /**
+     * @brief A map containing the kernel execution times of the kernel operations for every replication.
+     *          Only measured if the bank report is enabled.
+     * 
+     */
+    std::map<std::string,std::vector<std::vector<double>>> replicationTimings;
+
+    /**
+     * @brief The results of the PCIe characterization. Empty, if no characterization was executed.
+     * 
+     */
+    std::vector<PcieMeasurement> pcieMeasurements;
+
+    /**
+     * @brief Number of wrong values in the output array of every measured access pattern. Empty, if the access patterns were not measured.
+     * 
+     */
+    std::map<std::string,size_t> patternErrors;
+};
+
+/**
+ * @brief Sums of the absolute errors of the three arrays compared to the expected values
+ * 
+ */
+struct StreamErrors {
+
+    /**
+     * @brief Sum of the absolute errors of array A
+     * 
+     */
+    double a;
+
+    /**
+     * @brief Sum of the absolute errors of array B
+     * 
+     */
+    double b;
+
+    /**
+     * @brief Sum of the absolute errors of array C
+     * 
+     */
+    double c;
+
+    /**
+     * @brief Number of values of every array that were checked
+     * 
+     */
+    size_t checkedValues;
 };
 
+/**
+ * @brief Calculate the errors of the arrays in parallel with OpenMP.
+ *          All values are converted to double first, so the loops can be vectorized also for half precision.
+ * 
+ * @param data The data containing the arrays
+ * @param size Size of the arrays
+ * @param expected The expected values of A, B and C in this order
+ * @param indices If not nullptr, only the values at the given indices are checked
+ * @return StreamErrors The summed absolute errors
+ */
+StreamErrors
+calculateErrors(StreamData const& data, size_t size, double const expected[3], std::vector<size_t> const* indices);
+
 /**
  * @brief Implementation of the Sream benchmark
  * 
@@ -154,6 +386,36 @@ class StreamBenchmark : public hpcc_base::HpccFpgaBenchmark<StreamProgramSetting
 
 protected:
 
+    /**
+     * @brief Errors of the arrays that are calculated on the host, while the device executes the sweeps after the benchmark.
+     *          Only valid, if a sweep was executed.
+     * 
+     */
+    std::future<StreamErrors> pendingErrors;
+
+    /**
+     * @brief Number of wrong values of every access pattern of the last kernel execution
+     * 
+     */
+    std::map<std::string,size_t> patternErrors;
+
+    /**
+     * @brief Calculate the expected values of the arrays from the number of executed repetitions
+     * 
+     * @param expected The expected values of A, B and C in this order
+     */
+    void
+    getExpectedValues(double expected[3]);
+
+    /**
+     * @brief Calculate the errors of the arrays of this rank
+     * 
+     * @param data The data containing the arrays
+     * @return StreamErrors The summed absolute errors
+     */
+    StreamErrors
+    calculateLocalErrors(StreamData const& data);
+
     /**
      * @brief Additional input parameters of the strema benchmark
      * 
@@ -199,6 +461,24 @@ public:
     void
     collectAndPrintResults(const StreamExecutionTimings &output) override;
 
+    /**
+     * @brief Select the largest array size that fits into the device memory.
+     *          Every kernel replication processes its part of the three arrays in chunks of the device buffer size.
+     * 
+     * @param limits The memory limits of the device
+     * @return true always
+     */
+    bool
+    setAutomaticSize(hpcc_base::MemoryLimits const& limits) override;
+
+    /**
+     * @brief Create the scale kernel of the first replication with an array size of zero
+     * 
+     * @return std::unique_ptr<cl::Kernel> The kernel that finishes without work
+     */
+    std::unique_ptr<cl::Kernel>
+    createEmptyKernel() override;
+
     /**
      * @brief Construct a new Stream Benchmark object
      * 
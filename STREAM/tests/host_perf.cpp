@@ -0,0 +1,41 @@
+//
+// Micro-benchmarks for the host code of the STREAM benchmark
+//
+#include "benchmark/benchmark.h"
+#include "host_perf_fixture.hpp"
+#include "stream_benchmark.hpp"
+#include "parameters.h"
+
+/**
+ * The range gives the size of the three arrays
+ */
+class StreamHostPerf : public hpcc_base::HostPerfFixture<stream::StreamBenchmark> {
+protected:
+    void
+    setDataSize(benchmark::State& state) override {
+        getBenchmark().getExecutionSettings().programSettings->streamArraySize = state.range(0);
+    }
+
+    size_t
+    getInputDataBytes(benchmark::State& state) override {
+        return 3 * state.range(0) * sizeof(HOST_DATA_TYPE);
+    }
+};
+
+BENCHMARK_DEFINE_F(StreamHostPerf, GenerateInputData)(benchmark::State& state) {
+    measureInputDataGeneration(state);
+}
+BENCHMARK_REGISTER_F(StreamHostPerf, GenerateInputData)->RangeMultiplier(4)->Range(1 << 16, 1 << 26)->Unit(benchmark::kMillisecond);
+
+/**
+ * Error calculation over all values of the arrays that is used for the validation
+ */
+BENCHMARK_DEFINE_F(StreamHostPerf, CalculateErrors)(benchmark::State& state) {
+    auto data = generateData(state);
+    double expected[3] = {1.0, 2.0, 0.0};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(stream::calculateErrors(*data, state.range(0), expected, nullptr));
+    }
+    state.SetBytesProcessed(state.iterations() * 3 * state.range(0) * sizeof(HOST_DATA_TYPE));
+}
+BENCHMARK_REGISTER_F(StreamHostPerf, CalculateErrors)->RangeMultiplier(4)->Range(1 << 16, 1 << 26)->Unit(benchmark::kMillisecond);
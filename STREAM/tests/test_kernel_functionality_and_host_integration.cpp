@@ -5,6 +5,7 @@
 #include "parameters.h"
 #include "test_program_settings.h"
 #include "stream_benchmark.hpp"
+#include "execution.hpp"
 
 
 struct StreamKernelTest :public  ::testing::Test {
@@ -49,3 +50,197 @@ TEST_F(StreamKernelTest, FPGACorrectResultsThreeRepetition) {
         EXPECT_FLOAT_EQ(data->C[i], 1800.0);
     }
 }
+
+/**
+ * Warmup repetitions are not part of the timings but are considered by the validation
+ */
+TEST_F(StreamKernelTest, FPGAWarmupRepetitionsAreValidated) {
+    bm->getExecutionSettings().programSettings->numRepetitions = 2;
+    bm->getExecutionSettings().programSettings->warmupRepetitions = 1;
+    auto result = bm->executeKernel(*data);
+    for (auto const& t : result->timings) {
+        EXPECT_EQ(t.second.size(), 2);
+    }
+    EXPECT_EQ(bm->getExecutionSettings().repetitions->getExecutedRepetitions(), 3);
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+/**
+ * Checks if the CPU backend calculates the same results and reports all kernel operations
+ */
+TEST_F(StreamKernelTest, CPUCorrectResultsThreeRepetition) {
+    bm->getExecutionSettings().programSettings->numRepetitions = 3;
+    bm->getExecutionSettings().programSettings->communicationType = hpcc_base::CommunicationType::cpu_only;
+    auto result = bm->executeKernel(*data);
+    EXPECT_EQ(result->timings.size(), 4);
+    for (auto const& t : result->timings) {
+        EXPECT_EQ(t.second.size(), 3);
+    }
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+/**
+ * Checks if the streaming mode calculates the same results as the default execution with multiple chunks per kernel
+ */
+TEST_F(StreamKernelTest, FPGAStreamingCorrectResultsThreeRepetition) {
+    unsigned chunk_size = VECTOR_COUNT * UNROLL_COUNT * BUFFER_SIZE;
+    bm->getExecutionSettings().programSettings->streamArraySize = chunk_size * NUM_REPLICATIONS * 3;
+    bm->getExecutionSettings().programSettings->streamingChunkSize = chunk_size;
+    bm->getExecutionSettings().programSettings->numRepetitions = 3;
+    data = bm->generateInputData();
+    auto result = bm->executeKernel(*data);
+    EXPECT_EQ(result->timings.size(), 1);
+    EXPECT_EQ(result->timings[STREAMING_KEY].size(), 3);
+    for (int i = 0; i < bm->getExecutionSettings().programSettings->streamArraySize; i++) {
+        EXPECT_FLOAT_EQ(data->A[i], 6750.0);
+        EXPECT_FLOAT_EQ(data->B[i], 1350.0);
+        EXPECT_FLOAT_EQ(data->C[i], 1800.0);
+    }
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+/**
+ * The sizes of the array size sweep are log-spaced multiples of the block size
+ */
+TEST(StreamSweepTest, SweepSizesAreLogSpaced) {
+    auto sizes = bm_execution::sweepSizes(16, 16 * 1024 + 3, 11);
+    ASSERT_EQ(sizes.size(), 11);
+    EXPECT_EQ(sizes.front(), 16);
+    EXPECT_EQ(sizes.back(), 16 * 1024);
+    for (size_t i = 1; i < sizes.size(); i++) {
+        EXPECT_EQ(sizes[i], 2 * sizes[i - 1]);
+    }
+    // Duplicate sizes are removed and no size is smaller than the block size
+    EXPECT_EQ(bm_execution::sweepSizes(16, 32, 10).size(), 2);
+    EXPECT_TRUE(bm_execution::sweepSizes(16, 15, 10).empty());
+}
+
+/**
+ * The array size sweep measures all kernel operations for every size and does not affect the validation
+ */
+TEST_F(StreamKernelTest, FPGASweepDoesNotAffectValidation) {
+    bm->getExecutionSettings().programSettings->numRepetitions = 1;
+    bm->getExecutionSettings().programSettings->sweepPoints = 2;
+    auto result = bm->executeKernel(*data);
+    EXPECT_EQ(result->sweepTimings.size(), 4);
+    for (auto const& t : result->sweepTimings) {
+        EXPECT_EQ(t.second.size(), result->sweepSizes.size());
+    }
+    EXPECT_EQ(result->sweepSizes.back(), bm->getExecutionSettings().programSettings->streamArraySize);
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+/**
+ * The bank mapping policies place the arrays in the expected memory banks
+ */
+TEST(StreamBankMappingTest, BanksMatchPolicy) {
+    // Two replications and eight banks
+    for (uint a = 0; a < 3; a++) {
+        EXPECT_EQ(stream::getMemoryBank(stream::BankMapping::same, 1, a, 2, 8), 1);
+        EXPECT_EQ(stream::getMemoryBank(stream::BankMapping::split, 1, a, 2, 8), 3 + a);
+        EXPECT_EQ(stream::getMemoryBank(stream::BankMapping::round_robin, 1, a, 2, 8), 2 * a + 1);
+    }
+    // Banks wrap around
+    EXPECT_EQ(stream::getMemoryBank(stream::BankMapping::split, 2, 2, 3, 4), 0);
+    EXPECT_EQ(stream::stringToBankMapping("round-robin"), stream::BankMapping::round_robin);
+    EXPECT_THROW(stream::stringToBankMapping("unknown"), std::runtime_error);
+}
+
+/**
+ * The bank report contains the kernel execution times of every replication
+ */
+TEST_F(StreamKernelTest, FPGABankReportContainsAllReplications) {
+    bm->getExecutionSettings().programSettings->numRepetitions = 2;
+    bm->getExecutionSettings().programSettings->bankReport = true;
+    auto result = bm->executeKernel(*data);
+    EXPECT_EQ(result->replicationTimings.size(), 4);
+    for (auto const& t : result->replicationTimings) {
+        ASSERT_EQ(t.second.size(), NUM_REPLICATIONS);
+        for (auto const& r : t.second) {
+            EXPECT_EQ(r.size(), 2);
+        }
+    }
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+/**
+ * The PCIe characterization measures pageable and pinned memory for every transfer size and does not affect the validation
+ */
+TEST_F(StreamKernelTest, FPGAPcieSweepMeasuresAllSizes) {
+    bm->getExecutionSettings().programSettings->numRepetitions = 1;
+    bm->getExecutionSettings().programSettings->pcieSweepPoints = 3;
+    auto result = bm->executeKernel(*data);
+    auto sizes = bm_execution::sweepSizes(1, bm->getExecutionSettings().programSettings->streamArraySize / NUM_REPLICATIONS, 3);
+    ASSERT_EQ(result->pcieMeasurements.size(), 2 * sizes.size());
+    for (size_t i = 0; i < result->pcieMeasurements.size(); i++) {
+        EXPECT_EQ(result->pcieMeasurements[i].bytes, sizes[i / 2] * sizeof(HOST_DATA_TYPE));
+        EXPECT_EQ(result->pcieMeasurements[i].pinned, i % 2 == 1);
+        EXPECT_GT(result->pcieMeasurements[i].duplexTime, 0.0);
+    }
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+/**
+ * The indices of the gather and scatter kernels are a permutation, so every value is accessed exactly once
+ */
+TEST(StreamAccessPatternTest, IndicesArePermutation) {
+    auto indices = bm_execution::accessPatternIndices(1000, 7);
+    ASSERT_EQ(indices.size(), 1000);
+    std::vector<bool> used(indices.size(), false);
+    for (auto index : indices) {
+        ASSERT_LT(index, indices.size());
+        EXPECT_FALSE(used[index]);
+        used[index] = true;
+    }
+    EXPECT_EQ(indices, bm_execution::accessPatternIndices(1000, 7));
+}
+
+/**
+ * All access patterns are measured and validated and do not affect the validation of the benchmark
+ */
+TEST_F(StreamKernelTest, FPGAAccessPatternsValidate) {
+#ifndef ACCESS_PATTERN_KERNELS
+    GTEST_SKIP() << "Kernels were not built with ACCESS_PATTERN_KERNELS";
+#endif
+    bm->getExecutionSettings().programSettings->numRepetitions = 2;
+    bm->getExecutionSettings().programSettings->accessPatterns = true;
+    bm->getExecutionSettings().programSettings->patternStride = 3;
+    auto result = bm->executeKernel(*data);
+    for (auto const& key : {STRIDED_KEY, GATHER_KEY, SCATTER_KEY, READ_KEY, WRITE_KEY}) {
+        EXPECT_EQ(result->timings[key].size(), 2);
+        EXPECT_EQ(result->patternErrors[key], 0);
+    }
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+/**
+ * The parallel error calculation sums up the errors of all values and of the sampled values
+ */
+TEST_F(StreamKernelTest, ParallelErrorCalculationSumsAllErrors) {
+    size_t size = bm->getExecutionSettings().programSettings->streamArraySize;
+    double expected[3] = {1.0, 2.0, 0.0};
+    data->A[size - 1] = 3.0;
+    data->C[0] = 1.0;
+    auto errors = stream::calculateErrors(*data, size, expected, nullptr);
+    EXPECT_DOUBLE_EQ(errors.a, 2.0);
+    EXPECT_DOUBLE_EQ(errors.b, 0.0);
+    EXPECT_DOUBLE_EQ(errors.c, 1.0);
+    EXPECT_EQ(errors.checkedValues, size);
+    std::vector<size_t> indices{0, 1};
+    errors = stream::calculateErrors(*data, size, expected, &indices);
+    EXPECT_DOUBLE_EQ(errors.a, 0.0);
+    EXPECT_DOUBLE_EQ(errors.c, 1.0);
+    EXPECT_EQ(errors.checkedValues, 2);
+}
+
+/**
+ * The automatically selected array size fits into the memory and can be split into the device buffers
+ */
+TEST_F(StreamKernelTest, AutomaticSizeFitsIntoMemory) {
+    uint unit = VECTOR_COUNT * UNROLL_COUNT * NUM_REPLICATIONS * BUFFER_SIZE;
+    double memory = 10.5 * unit * 3 * sizeof(HOST_DATA_TYPE);
+    EXPECT_TRUE(bm->setAutomaticSize({memory, memory}));
+    EXPECT_EQ(bm->getExecutionSettings().programSettings->streamArraySize, 10 * unit);
+    EXPECT_FALSE(bm->setAutomaticSize({1.0, 1.0}));
+    EXPECT_EQ(bm->getExecutionSettings().programSettings->streamArraySize, 10 * unit);
+}
@@ -65,12 +65,18 @@ channel message_part ch_exchange/*PY_CODE_GEN 2*r+2*/;
  *
  * @param data_size Size of the used message
  * @param repetitions Number of times the message will be sent and received
+ * @param channel_mask Bit mask of the used channels. Bit 0 enables the first and bit 1 the second channel.
+ *                  The message is split over all enabled channels.
  */
 __kernel
 __attribute__ ((max_global_work_dim(0)))
 void send/*PY_CODE_GEN  r*/(const unsigned data_size,
-        const unsigned repetitions) {
-    const unsigned send_iterations = ((1 << data_size) +  2 * ITEMS_PER_CHANNEL - 1) / (2 * ITEMS_PER_CHANNEL);
+        const unsigned repetitions,
+        const unsigned channel_mask) {
+    const bool use_ch1 = (channel_mask & 1) != 0;
+    const bool use_ch2 = (channel_mask & 2) != 0;
+    const unsigned used_channels = (use_ch1 ? 1 : 0) + (use_ch2 ? 1 : 0);
+    const unsigned send_iterations = ((1 << data_size) +  used_channels * ITEMS_PER_CHANNEL - 1) / (used_channels * ITEMS_PER_CHANNEL);
     message_part send_part1;
     message_part send_part2;
 
@@ -83,15 +89,23 @@ void send/*PY_CODE_GEN  r*/(const unsigned data_size,
 
     // Sent a message multiple times over the external channels
     for (unsigned i=0; i < repetitions; i++) {
-        // Send a single message sent over two channels split into multiple chunks
+        // Send a single message sent over the enabled channels split into multiple chunks
         for (unsigned k=0; k < send_iterations; k++) {
-            write_channel_intel(ch_out_/*PY_CODE_GEN  2*r+1*/, send_part1);
-            write_channel_intel(ch_out_/*PY_CODE_GEN  2*r+2*/, send_part2);
+            if (use_ch1) {
+                write_channel_intel(ch_out_/*PY_CODE_GEN  2*r+1*/, send_part1);
+            }
+            if (use_ch2) {
+                write_channel_intel(ch_out_/*PY_CODE_GEN  2*r+2*/, send_part2);
+            }
         }
 #ifndef EMULATE
         // Introduce data dependency between loop iterations to prevent coalescing of loop
-        send_part1 = read_channel_intel(ch_exchange/*PY_CODE_GEN 2*r+1*/);
-        send_part2 = read_channel_intel(ch_exchange/*PY_CODE_GEN 2*r+2*/);
+        if (use_ch1) {
+            send_part1 = read_channel_intel(ch_exchange/*PY_CODE_GEN 2*r+1*/);
+        }
+        if (use_ch2) {
+            send_part2 = read_channel_intel(ch_exchange/*PY_CODE_GEN 2*r+2*/);
+        }
 #endif
     }
 }
@@ -103,39 +117,58 @@ void send/*PY_CODE_GEN  r*/(const unsigned data_size,
  *
  * @param data_size Size of the used message
  * @param repetitions Number of times the message will be sent and received
+ * @param channel_mask Bit mask of the used channels. Bit 0 enables the first and bit 1 the second channel.
+ *                  The message is split over all enabled channels.
  */
 __kernel
 __attribute__ ((max_global_work_dim(0)))
 void recv/*PY_CODE_GEN  r*/(__global DEVICE_DATA_TYPE* validation_buffer,
             const unsigned data_size,
-            const unsigned repetitions) {
-    const unsigned send_iterations = ((1 << data_size) +  2 * ITEMS_PER_CHANNEL - 1) / (2 * ITEMS_PER_CHANNEL);
+            const unsigned repetitions,
+            const unsigned channel_mask) {
+    const bool use_ch1 = (channel_mask & 1) != 0;
+    const bool use_ch2 = (channel_mask & 2) != 0;
+    const unsigned used_channels = (use_ch1 ? 1 : 0) + (use_ch2 ? 1 : 0);
+    const unsigned send_iterations = ((1 << data_size) +  used_channels * ITEMS_PER_CHANNEL - 1) / (used_channels * ITEMS_PER_CHANNEL);
     message_part recv_part1;
     message_part recv_part2;
 
     // Receive a message multiple times over the external channels
     for (unsigned i=0; i < repetitions; i++) {
-        // Receive a single message sent over two channels split into multiple chunks
+        // Receive a single message sent over the enabled channels split into multiple chunks
         for (unsigned k=0; k < send_iterations; k++) {
-            recv_part1 = read_channel_intel(ch_in_/*PY_CODE_GEN  2*r+1*/);
-            recv_part2 = read_channel_intel(ch_in_/*PY_CODE_GEN  2*r+2*/);
+            if (use_ch1) {
+                recv_part1 = read_channel_intel(ch_in_/*PY_CODE_GEN  2*r+1*/);
+            }
+            if (use_ch2) {
+                recv_part2 = read_channel_intel(ch_in_/*PY_CODE_GEN  2*r+2*/);
+            }
         }
 #ifndef EMULATE
         // Introduce data dependency between loop iterations to prevent coalescing of loop
         // by sending the data to the send kernel
-        write_channel_intel(ch_exchange/*PY_CODE_GEN 2*r+1*/, recv_part1);
-        write_channel_intel(ch_exchange/*PY_CODE_GEN 2*r+2*/, recv_part2);
+        if (use_ch1) {
+            write_channel_intel(ch_exchange/*PY_CODE_GEN 2*r+1*/, recv_part1);
+        }
+        if (use_ch2) {
+            write_channel_intel(ch_exchange/*PY_CODE_GEN 2*r+2*/, recv_part2);
+        }
 #endif
     }
 
     // Store the last received data chunks in global memory for later validation
-    __attribute__((opencl_unroll_hint(ITEMS_PER_CHANNEL)))
-    for (DEVICE_DATA_TYPE d = 0; d < ITEMS_PER_CHANNEL; d++) {
-        validation_buffer[d] = recv_part1.values[d];
+    // The data of disabled channels is not written
+    if (use_ch1) {
+        __attribute__((opencl_unroll_hint(ITEMS_PER_CHANNEL)))
+        for (DEVICE_DATA_TYPE d = 0; d < ITEMS_PER_CHANNEL; d++) {
+            validation_buffer[d] = recv_part1.values[d];
+        }
     }
-    __attribute__((opencl_unroll_hint(ITEMS_PER_CHANNEL)))
-    for (DEVICE_DATA_TYPE d = 0; d < ITEMS_PER_CHANNEL; d++) {
-        validation_buffer[ITEMS_PER_CHANNEL + d] = recv_part2.values[d];
+    if (use_ch2) {
+        __attribute__((opencl_unroll_hint(ITEMS_PER_CHANNEL)))
+        for (DEVICE_DATA_TYPE d = 0; d < ITEMS_PER_CHANNEL; d++) {
+            validation_buffer[ITEMS_PER_CHANNEL + d] = recv_part2.values[d];
+        }
     }
 }
 
@@ -0,0 +1,140 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file contains two kernels "send" and "recv" that use the Streaming Message Interface (SMI)
+ * instead of the external channels.
+ * They behave like the kernels for the external channels:
+ * - "send" sends half of a message to the next and half of the message to the previous rank in the ring
+ * - "recv" receives the halves of the messages from both neighbours
+ *
+ * SMI routes the messages over the available links, so the ranks do not have to be connected in a torus.
+ * The file has to be processed with the SMI code generator that adds the transport kernels and
+ * generates the host code to initialize the communicator.
+ */
+
+
+#include "parameters.h"
+#include "smi.h"
+
+#pragma OPENCL EXTENSION cl_intel_channels : enable
+
+/**
+ * Number of bytes that are sent with a single SMI push
+ */
+#define BYTES_PER_PUSH 4
+
+// PY_CODE_GEN block_start [replace(local_variables=locals()) for r in range(num_replications)]
+channel int ch_exchange/*PY_CODE_GEN r*/;
+// PY_CODE_GEN block_end
+
+
+// PY_CODE_GEN block_start [replace(local_variables=locals()) for r in range(num_replications)]
+/**
+ * Send kernel that will send messages to both neighbours in the ring
+ *
+ * @param data_size Size of the used message
+ * @param repetitions Number of times the message will be sent and received
+ * @param comm SMI communicator
+ */
+__kernel
+__attribute__ ((max_global_work_dim(0)))
+void send/*PY_CODE_GEN  r*/(const unsigned data_size,
+        const unsigned repetitions,
+        SMI_Comm comm) {
+    const unsigned send_iterations = ((1 << data_size) +  2 * BYTES_PER_PUSH - 1) / (2 * BYTES_PER_PUSH);
+    const int rank = SMI_Comm_rank(comm);
+    const int size = SMI_Comm_size(comm);
+    const int next = (rank + 1) % size;
+    const int previous = (rank - 1 + size) % size;
+
+    // Every byte of the message contains the message size
+    const int value = data_size & 255;
+    int send_part = value | (value << 8) | (value << 16) | (value << 24);
+
+    // Sent a message multiple times to both neighbours
+    for (unsigned i=0; i < repetitions; i++) {
+        SMI_Channel ch_next = SMI_Open_send_channel(send_iterations, SMI_INT, next, /*PY_CODE_GEN 2*r*/, comm);
+        SMI_Channel ch_previous = SMI_Open_send_channel(send_iterations, SMI_INT, previous, /*PY_CODE_GEN 2*r+1*/, comm);
+        // Send a single message split into two halves
+        for (unsigned k=0; k < send_iterations; k++) {
+            SMI_Push(&ch_next, &send_part);
+            SMI_Push(&ch_previous, &send_part);
+        }
+#ifndef EMULATE
+        // Introduce data dependency between loop iterations to prevent coalescing of loop
+        send_part = read_channel_intel(ch_exchange/*PY_CODE_GEN r*/);
+#endif
+    }
+}
+
+
+/**
+ * Receive kernel that will receive the messages from both neighbours in the ring
+ *
+ * @param validation_buffer Buffer that will contain the last received message parts
+ * @param data_size Size of the used message
+ * @param repetitions Number of times the message will be sent and received
+ * @param comm SMI communicator
+ */
+__kernel
+__attribute__ ((max_global_work_dim(0)))
+void recv/*PY_CODE_GEN  r*/(__global DEVICE_DATA_TYPE* validation_buffer,
+            const unsigned data_size,
+            const unsigned repetitions,
+            SMI_Comm comm) {
+    const unsigned send_iterations = ((1 << data_size) +  2 * BYTES_PER_PUSH - 1) / (2 * BYTES_PER_PUSH);
+    const int rank = SMI_Comm_rank(comm);
+    const int size = SMI_Comm_size(comm);
+    const int next = (rank + 1) % size;
+    const int previous = (rank - 1 + size) % size;
+    int recv_part1 = 0;
+    int recv_part2 = 0;
+
+    // Receive a message multiple times from both neighbours
+    for (unsigned i=0; i < repetitions; i++) {
+        // The previous rank sends to its next rank and vice versa
+        SMI_Channel ch_previous = SMI_Open_receive_channel(send_iterations, SMI_INT, previous, /*PY_CODE_GEN 2*r*/, comm);
+        SMI_Channel ch_next = SMI_Open_receive_channel(send_iterations, SMI_INT, next, /*PY_CODE_GEN 2*r+1*/, comm);
+        for (unsigned k=0; k < send_iterations; k++) {
+            SMI_Pop(&ch_previous, &recv_part1);
+            SMI_Pop(&ch_next, &recv_part2);
+        }
+#ifndef EMULATE
+        // Introduce data dependency between loop iterations to prevent coalescing of loop
+        // by sending the data to the send kernel
+        write_channel_intel(ch_exchange/*PY_CODE_GEN r*/, recv_part1);
+#endif
+    }
+
+    // Store the last received data chunks in global memory for later validation
+    __attribute__((opencl_unroll_hint(CHANNEL_WIDTH)))
+    for (unsigned d = 0; d < CHANNEL_WIDTH; d++) {
+        validation_buffer[d] = (recv_part1 >> (8 * (d % BYTES_PER_PUSH))) & 255;
+    }
+    __attribute__((opencl_unroll_hint(CHANNEL_WIDTH)))
+    for (unsigned d = 0; d < CHANNEL_WIDTH; d++) {
+        validation_buffer[CHANNEL_WIDTH + d] = (recv_part2 >> (8 * (d % BYTES_PER_PUSH))) & 255;
+    }
+}
+
+//PY_CODE_GEN block_end
@@ -0,0 +1,196 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SRC_HOST_EXECUTION_TYPES_COMMUNICATION_BUFFERS_HPP
+#define SRC_HOST_EXECUTION_TYPES_COMMUNICATION_BUFFERS_HPP
+
+/* C++ standard library headers */
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+/* Project's headers */
+#include "host_memory.hpp"
+#include "communication_progress.hpp"
+
+namespace network::execution_types {
+
+    /**
+     * @brief Command queues, device buffers and host buffers of all kernel replications that are used by the
+     *          PCIe and CPU implementations. They are created once for the largest message size and reused
+     *          for all repetitions and message sizes.
+     * 
+     */
+    class CommunicationBuffers {
+
+    public:
+
+        /**
+         * @brief One command queue per kernel replication
+         * 
+         */
+        std::vector<cl::CommandQueue> sendQueues;
+
+        /**
+         * @brief One device buffer per kernel replication that contains the received data
+         * 
+         */
+        std::vector<cl::Buffer> dummyBuffers;
+
+        /**
+         * @brief One host buffer per kernel replication that is used for the MPI communication.
+         *          The buffers are allocated with the host memory configuration, so they are pinned if requested.
+         * 
+         */
+        std::vector<HOST_DATA_TYPE*> dummyBufferContents;
+
+        /**
+         * @brief One command queue per kernel replication for the writes to the device in windowed mode,
+         *          so they overlap with the reads on the send queues
+         * 
+         */
+        std::vector<cl::CommandQueue> recvQueues;
+
+        /**
+         * @brief One device buffer per kernel replication that contains the data that is sent in windowed mode.
+         *          The received data is written to the dummy buffers in parallel.
+         * 
+         */
+        std::vector<cl::Buffer> sendBuffers;
+
+        /**
+         * @brief One host buffer per kernel replication for windowed mode. It contains windowSize slots for
+         *          received messages followed by windowSize slots for sent messages.
+         * 
+         */
+        std::vector<HOST_DATA_TYPE*> windowContents;
+
+        /**
+         * @brief Size of all buffers in number of values
+         * 
+         */
+        size_t maxSize;
+
+        /**
+         * @brief Number of outstanding messages in windowed mode. 0, if windowed mode is not used.
+         * 
+         */
+        size_t windowSize;
+
+        /**
+         * @brief Progress thread that completes the messages and starts the writes of the received data in windowed mode.
+         *          It is declared last, so the thread is stopped before the queues and buffers are released.
+         * 
+         */
+        std::unique_ptr<hpcc_base::CommunicationProgress> progress;
+
+        /**
+         * @brief Create the queues and buffers for all kernel replications
+         * 
+         * @param config The execution settings
+         * @param max_size Size of the buffers in number of values. Has to fit the largest message size.
+         */
+        CommunicationBuffers(hpcc_base::ExecutionSettings<network::NetworkProgramSettings> const& config, size_t max_size) : maxSize(max_size),
+                                                        windowSize(config.programSettings->windowSize) {
+            int err;
+            for (int r = 0; r < config.programSettings->kernelReplications; r++) {
+                dummyBuffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_WRITE, sizeof(HOST_DATA_TYPE) * maxSize,0,&err));
+                ASSERT_CL(err)
+
+                dummyBufferContents.push_back(hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(maxSize));
+
+                cl::CommandQueue sendQueue(*config.context, *config.device, 0, &err);
+                ASSERT_CL(err)
+                sendQueues.push_back(sendQueue);
+
+                if (windowSize > 0) {
+                    sendBuffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY, sizeof(HOST_DATA_TYPE) * maxSize,0,&err));
+                    ASSERT_CL(err)
+
+                    windowContents.push_back(hpcc_base::host_memory::allocate<HOST_DATA_TYPE>(2 * windowSize * maxSize));
+
+                    cl::CommandQueue recvQueue(*config.context, *config.device, 0, &err);
+                    ASSERT_CL(err)
+                    recvQueues.push_back(recvQueue);
+                }
+            }
+            if (windowSize > 0) {
+                progress.reset(new hpcc_base::CommunicationProgress());
+            }
+        }
+
+        CommunicationBuffers(const CommunicationBuffers&) = delete;
+
+        ~CommunicationBuffers() {
+            progress.reset();
+            for (auto buffer : dummyBufferContents) {
+                hpcc_base::host_memory::release(buffer);
+            }
+            for (auto buffer : windowContents) {
+                hpcc_base::host_memory::release(buffer);
+            }
+        }
+
+        /**
+         * @brief Initialize the first values of all host and device buffers for a new message size
+         * 
+         * @param value The value the buffers are filled with
+         * @param size Number of values that are initialized
+         */
+        void
+        fill(HOST_DATA_TYPE value, size_t size) {
+            for (int r = 0; r < sendQueues.size(); r++) {
+                std::fill(dummyBufferContents[r], dummyBufferContents[r] + size, value);
+                sendQueues[r].enqueueWriteBuffer(dummyBuffers[r], CL_TRUE, 0, sizeof(HOST_DATA_TYPE) * size, dummyBufferContents[r]);
+                if (windowSize > 0) {
+                    sendQueues[r].enqueueWriteBuffer(sendBuffers[r], CL_TRUE, 0, sizeof(HOST_DATA_TYPE) * size, dummyBufferContents[r]);
+                }
+            }
+        }
+
+        /**
+         * @brief Get a slot for a received message in windowed mode
+         * 
+         * @param r The kernel replication
+         * @param slot The slot in the window
+         * @return HOST_DATA_TYPE* Pointer to the slot
+         */
+        HOST_DATA_TYPE*
+        recvSlot(int r, size_t slot) {
+            return windowContents[r] + slot * maxSize;
+        }
+
+        /**
+         * @brief Get a slot for a sent message in windowed mode
+         * 
+         * @param r The kernel replication
+         * @param slot The slot in the window
+         * @return HOST_DATA_TYPE* Pointer to the slot
+         */
+        HOST_DATA_TYPE*
+        sendSlot(int r, size_t slot) {
+            return windowContents[r] + (windowSize + slot) * maxSize;
+        }
+    };
+
+}  // namespace network::execution_types
+
+#endif
@@ -0,0 +1,155 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SRC_HOST_EXECUTION_TYPES_COMMUNICATION_PATTERNS_HPP
+#define SRC_HOST_EXECUTION_TYPES_COMMUNICATION_PATTERNS_HPP
+
+/* C++ standard library headers */
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace network {
+
+/**
+ * @brief The communication patterns that define which ranks exchange messages
+ * 
+ */
+typedef enum _CommunicationPattern {
+
+    /**
+     * @brief Every rank exchanges messages with its left and right neighbour in the natural ring of ranks.
+     *          The kernel replications alternate between both directions.
+     * 
+     */
+    ring,
+
+    /**
+     * @brief Like the natural ring, but the ranks are ordered by a random permutation that is given by a seed
+     * 
+     */
+    random_ring,
+
+    /**
+     * @brief Every rank exchanges messages with the rank in the other half of the ranks, so all messages cross the bisection
+     * 
+     */
+    bisection,
+
+    /**
+     * @brief Every rank exchanges messages with all other ranks in every iteration
+     * 
+     */
+    all_to_all
+
+} CommunicationPattern;
+
+static const std::map<const std::string, CommunicationPattern> pattern_to_str_map{
+    {"RING", CommunicationPattern::ring},
+    {"RANDOM", CommunicationPattern::random_ring},
+    {"BISECTION", CommunicationPattern::bisection},
+    {"ALLTOALL", CommunicationPattern::all_to_all}
+    };
+
+/**
+ * @brief Serializes a communication pattern into a string
+ * 
+ * @param p the communication pattern
+ * @return std::string String representation of the pattern
+ */
+static std::string patternToString(CommunicationPattern p) {
+    for (auto& entry : pattern_to_str_map) {
+        if (entry.second == p) {
+            return entry.first;
+        }
+    }
+    throw std::runtime_error("Communication pattern could not be converted to string!");
+}
+
+/**
+ * @brief Deserializes a string into a communication pattern
+ * 
+ * @param pattern_name String serialization of the pattern
+ * @return CommunicationPattern The pattern. Will throw a runtime error if the string does not match a pattern.
+ */
+static CommunicationPattern stringToPattern(std::string pattern_name) {
+    auto result = pattern_to_str_map.find(pattern_name);
+    if (result != pattern_to_str_map.end()) {
+        return result->second;
+    }
+    throw std::runtime_error("Communication pattern could not be converted from string: " + pattern_name);
+}
+
+/**
+ * @brief Get the message exchanges of a rank in a single iteration of the benchmark.
+ *          Every exchange consists of the rank a message is sent to and the rank a message is received from.
+ *          All ranks have to call the function with the same pattern and seed, so the exchanges match.
+ * 
+ * @param pattern The used communication pattern
+ * @param seed Seed of the random permutation of the random ring
+ * @param rank The rank the exchanges are calculated for
+ * @param size The number of ranks
+ * @param replication The kernel replication. The ring patterns alternate the direction with the replication.
+ * @return std::vector<std::pair<int, int>> Pairs of destination and source rank for all exchanges of an iteration
+ */
+inline std::vector<std::pair<int, int>>
+getExchanges(CommunicationPattern pattern, uint seed, int rank, int size, int replication) {
+    std::vector<std::pair<int, int>> exchanges;
+    switch (pattern) {
+        case CommunicationPattern::ring: {
+            int partner = (rank - 1 + 2 * ((rank + replication) % 2) + size) % size;
+            exchanges.push_back({partner, partner});
+        } break;
+        case CommunicationPattern::random_ring: {
+            std::vector<int> permutation(size);
+            std::iota(permutation.begin(), permutation.end(), 0);
+            std::shuffle(permutation.begin(), permutation.end(), std::mt19937(seed));
+            int position = std::find(permutation.begin(), permutation.end(), rank) - permutation.begin();
+            int partner = permutation[(position - 1 + 2 * ((position + replication) % 2) + size) % size];
+            exchanges.push_back({partner, partner});
+        } break;
+        case CommunicationPattern::bisection: {
+            if (size % 2 != 0) {
+                throw std::runtime_error("The bisection pattern requires an even number of ranks!");
+            }
+            int partner = (rank + size / 2) % size;
+            exchanges.push_back({partner, partner});
+        } break;
+        case CommunicationPattern::all_to_all: {
+            for (int s = 1; s < size; s++) {
+                exchanges.push_back({(rank + s) % size, (rank - s + size) % size});
+            }
+            if (exchanges.empty()) {
+                exchanges.push_back({rank, rank});
+            }
+        } break;
+    }
+    return exchanges;
+}
+
+}  // namespace network
+
+#endif
@@ -22,4 +22,7 @@ SOFTWARE.
 
 #include "execution_types/execution_cpu.hpp"
 #include "execution_types/execution_pcie.hpp"
-#include "execution_types/execution_iec.hpp"
\ No newline at end of file
+#include "execution_types/execution_iec.hpp"
+#ifdef USE_SMI
+#include "execution_types/execution_smi.hpp"
+#endif
\ No newline at end of file
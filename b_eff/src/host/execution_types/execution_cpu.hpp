@@ -31,23 +31,58 @@ SOFTWARE.
 #include "mpi.h"
 
 /* Project's headers */
+#include "communication_buffers.hpp"
+#include "communication_patterns.hpp"
+#include "trace_region.hpp"
 
 namespace network::execution_types::cpu {
 
+    /**
+     * @brief Exchange the messages of a kernel replication with up to windowSize outstanding non-blocking messages.
+     *          All messages are sent from the same host buffer and received into their own slot.
+     * 
+     * @param buffers The queues and buffers of all kernel replications
+     * @param i The kernel replication
+     * @param exchanges Destination and source ranks of all messages of a single iteration
+     * @param size_in_bytes Size of a single message
+     * @param looplength Number of iterations
+     */
+    void
+    windowedExchange(CommunicationBuffers &buffers, int i, std::vector<std::pair<int, int>> const& exchanges, cl_uint size_in_bytes, cl_uint looplength) {
+        size_t window = buffers.windowSize;
+        // The messages of an iteration are sent one after the other, so they are matched in the same order by all ranks
+        cl_uint messages = looplength * exchanges.size();
+        std::vector<MPI_Request> requests(2 * window, MPI_REQUEST_NULL);
+        for (cl_uint l = 0; l < messages; l++) {
+            size_t s = l % window;
+            auto const& e = exchanges[l % exchanges.size()];
+            HPCC_TRACE_REGION("MPI_Isend/MPI_Irecv");
+            MPI_Waitall(2, &requests[2 * s], MPI_STATUSES_IGNORE);
+            MPI_Irecv(buffers.recvSlot(i, s), size_in_bytes, MPI_CHAR, e.second, 0, MPI_COMM_WORLD, &requests[2 * s]);
+            MPI_Isend(buffers.dummyBufferContents[i], size_in_bytes, MPI_CHAR, e.first, 0, MPI_COMM_WORLD, &requests[2 * s + 1]);
+        }
+        MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+    }
+
     /*
     Implementation for the single kernel.
+    The queues and buffers are reused for all repetitions and message sizes.
      @copydoc bm_execution::calculate()
     */
     std::shared_ptr<network::ExecutionTimings>
     calculate(hpcc_base::ExecutionSettings<network::NetworkProgramSettings> const& config, cl_uint messageSize, cl_uint looplength,
-                cl::vector<HOST_DATA_TYPE> &validationData) {
+                cl::vector<HOST_DATA_TYPE> &validationData, CommunicationBuffers &buffers) {
 
         int err;
-        std::vector<cl::CommandQueue> sendQueues;
-        std::vector<cl::Buffer> dummyBuffers;
-        std::vector<cl::vector<HOST_DATA_TYPE>> dummyBufferContents;
+        std::vector<cl::CommandQueue>& sendQueues = buffers.sendQueues;
+        std::vector<cl::Buffer>& dummyBuffers = buffers.dummyBuffers;
+        std::vector<HOST_DATA_TYPE*>& dummyBufferContents = buffers.dummyBufferContents;
 
         cl_uint size_in_bytes = std::max(static_cast<int>(validationData.size()), (1 << messageSize));
+        if (size_in_bytes > buffers.maxSize) {
+            throw std::runtime_error("Message size exceeds the size of the communication buffers!");
+        }
+        buffers.fill(static_cast<HOST_DATA_TYPE>(messageSize & (255)), size_in_bytes);
 
         int current_rank;
         MPI_Comm_rank(MPI_COMM_WORLD, & current_rank);
@@ -56,33 +91,30 @@ namespace network::execution_types::cpu {
         MPI_Comm_size(MPI_COMM_WORLD, & current_size);
 
         std::vector<double> calculationTimings;
-        for (uint r =0; r < config.programSettings->numRepetitions; r++) {
-            sendQueues.clear();
-            dummyBuffers.clear();
-            dummyBufferContents.clear();
-            // Create all kernels and buffers. The kernel pairs are generated twice to utilize all channels
-            for (int r = 0; r < config.programSettings->kernelReplications; r++) {
-
-                dummyBuffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_WRITE, sizeof(HOST_DATA_TYPE) * size_in_bytes,0,&err));
-                ASSERT_CL(err)
-
-                dummyBufferContents.emplace_back(size_in_bytes, static_cast<HOST_DATA_TYPE>(messageSize & (255)));
-
-                cl::CommandQueue sendQueue(*config.context, *config.device, 0, &err);
-                ASSERT_CL(err)
-
-                sendQueue.enqueueWriteBuffer(dummyBuffers.back(), CL_TRUE, 0, sizeof(HOST_DATA_TYPE) * size_in_bytes, dummyBufferContents.back().data());
-
-                sendQueues.push_back(sendQueue);
-
-            }
+        std::vector<std::vector<double>> latencies(config.programSettings->kernelReplications);
+        config.repetitions->start(*config.programSettings);
+        for (uint r =0; config.repetitions->next(calculationTimings); r++) {
             double calculationTime = 0.0;
+            bool measureLatency = config.programSettings->latencyMode && !config.repetitions->isWarmup();
             for (int i = 0; i < config.programSettings->kernelReplications; i++) {
                 MPI_Barrier(MPI_COMM_WORLD);
+                auto exchanges = getExchanges(config.programSettings->pattern, config.programSettings->patternSeed, current_rank, current_size, i);
                 auto startCalculation = std::chrono::high_resolution_clock::now();
-                for (int l = 0; l < looplength; l++) {
-                        MPI_Sendrecv(dummyBufferContents[i].data(), size_in_bytes, MPI_CHAR, (current_rank - 1 + 2 * ((current_rank + i) % 2) + current_size) % current_size, 0, 
-                                        dummyBufferContents[i].data(), size_in_bytes, MPI_CHAR, (current_rank - 1 + 2 * ((current_rank + i) % 2)  + current_size) % current_size, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                if (buffers.windowSize > 0) {
+                    windowedExchange(buffers, i, exchanges, size_in_bytes, looplength);
+                }
+                else {
+                    for (int l = 0; l < looplength; l++) {
+                            auto startMessage = std::chrono::high_resolution_clock::now();
+                            for (auto const& e : exchanges) {
+                                HPCC_TRACE_REGION("MPI_Sendrecv");
+                                MPI_Sendrecv(dummyBufferContents[i], size_in_bytes, MPI_CHAR, e.first, 0, 
+                                                dummyBufferContents[i], size_in_bytes, MPI_CHAR, e.second, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                            }
+                            if (measureLatency) {
+                                latencies[i].push_back(std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - startMessage).count());
+                            }
+                    }
                 }
                 auto endCalculation = std::chrono::high_resolution_clock::now();
                 calculationTime += std::chrono::duration_cast<std::chrono::duration<double>>(endCalculation - startCalculation).count();
@@ -99,6 +131,7 @@ namespace network::execution_types::cpu {
         std::cout << "Rank " << current_rank << ": Done " << r << std::endl;
 #endif
         }
+        config.repetitions->discardWarmup(calculationTimings);
         // Read validation data from FPGA will be placed sequentially in buffer for all replications
         // The data order should not matter, because every byte should have the same value!
         for (int r = 0; r < config.programSettings->kernelReplications; r++) {
@@ -108,7 +141,8 @@ namespace network::execution_types::cpu {
         std::shared_ptr<network::ExecutionTimings> result(new network::ExecutionTimings{
                 looplength,
                 messageSize,
-                calculationTimings
+                calculationTimings,
+                latencies
         });
         return result;
     }
@@ -26,6 +26,7 @@ SOFTWARE.
 #include <memory>
 #include <vector>
 #include <chrono>
+#include <algorithm>
 
 /* External library headers */
 #include "CL/cl_ext_intelfpga.h"
@@ -35,6 +36,86 @@ SOFTWARE.
 
 namespace network::execution_types::iec {
 
+    /**
+     * @brief Measure the channels of all kernel pairs on their own. For every channel index, all kernel pairs
+     *        are executed with only this channel enabled, so the partner ranks read the matching channels.
+     *        The execution time of every kernel pair is measured by polling its events.
+     * 
+     * @param config The execution settings of the benchmark
+     * @param sendKernels The send kernels of all replications
+     * @param recvKernels The receive kernels of all replications
+     * @param sendQueues The queues of the send kernels
+     * @param recvQueues The queues of the receive kernels
+     * @return std::vector<double> The best execution time for every channel index and kernel replication (index: channel * replications + replication)
+     */
+    std::vector<double>
+    measureLinks(hpcc_base::ExecutionSettings<network::NetworkProgramSettings> const& config, std::vector<cl::Kernel> &sendKernels, std::vector<cl::Kernel> &recvKernels,
+                std::vector<cl::CommandQueue> &sendQueues, std::vector<cl::CommandQueue> &recvQueues) {
+        int err;
+        int replications = config.programSettings->kernelReplications;
+        std::vector<double> linkTimings;
+        for (cl_uint c = 0; c < 2; c++) {
+            for (int i = 0; i < replications; i++) {
+                err = sendKernels[i].setArg(2, static_cast<cl_uint>(1 << c));
+                ASSERT_CL(err)
+                err = recvKernels[i].setArg(3, static_cast<cl_uint>(1 << c));
+                ASSERT_CL(err)
+            }
+            std::vector<std::vector<double>> replicationTimings(replications);
+            std::vector<double> timings;
+            config.repetitions->start(*config.programSettings);
+            while (config.repetitions->next(timings)) {
+                std::vector<cl::Event> sendEvents(replications);
+                std::vector<cl::Event> recvEvents(replications);
+                std::vector<double> finished(replications, 0.0);
+                std::vector<bool> done(replications, false);
+                MPI_Barrier(MPI_COMM_WORLD);
+                auto startCalculation = std::chrono::high_resolution_clock::now();
+                for (int i = 0; i < replications; i++) {
+                    sendQueues[i].enqueueNDRangeKernel(sendKernels[i], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, &sendEvents[i]);
+                    sendQueues[i].flush();
+                }
+#ifdef HOST_EMULATION_REORDER
+                for (int i = 0; i < replications; i++) {
+                    sendQueues[i].finish();
+                }
+#endif
+                for (int i = 0; i < replications; i++) {
+                    recvQueues[i].enqueueNDRangeKernel(recvKernels[i], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, &recvEvents[i]);
+                    recvQueues[i].flush();
+                }
+                // Poll the events, so the completion of every kernel pair is recorded independent of the others
+                int running = replications;
+                while (running > 0) {
+                    for (int i = 0; i < replications; i++) {
+                        if (!done[i] && sendEvents[i].getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() == CL_COMPLETE
+                                && recvEvents[i].getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() == CL_COMPLETE) {
+                            finished[i] = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - startCalculation).count();
+                            done[i] = true;
+                            running--;
+                        }
+                    }
+                }
+                for (int i = 0; i < replications; i++) {
+                    replicationTimings[i].push_back(finished[i]);
+                }
+                timings.push_back(*std::max_element(finished.begin(), finished.end()));
+            }
+            for (int i = 0; i < replications; i++) {
+                config.repetitions->discardWarmup(replicationTimings[i]);
+                linkTimings.push_back(*std::min_element(replicationTimings[i].begin(), replicationTimings[i].end()));
+            }
+        }
+        // Enable both channels again for the measurement of all channels
+        for (int i = 0; i < replications; i++) {
+            err = sendKernels[i].setArg(2, static_cast<cl_uint>(3));
+            ASSERT_CL(err)
+            err = recvKernels[i].setArg(3, static_cast<cl_uint>(3));
+            ASSERT_CL(err)
+        }
+        return linkTimings;
+    }
+
     /*
     Implementation for the single kernel.
      @copydoc bm_execution::calculate()
@@ -63,6 +144,9 @@ namespace network::execution_types::iec {
             ASSERT_CL(err)
             err = sendKernel.setArg(1, looplength);
             ASSERT_CL(err)
+            // Use both channels of the kernel pair
+            err = sendKernel.setArg(2, static_cast<cl_uint>(3));
+            ASSERT_CL(err)
 
             cl::Kernel recvKernel(*config.program, (RECV_KERNEL_NAME + std::to_string(r)).c_str(), &err);
             ASSERT_CL(err)
@@ -72,6 +156,8 @@ namespace network::execution_types::iec {
             ASSERT_CL(err)
             err = recvKernel.setArg(2, looplength);
             ASSERT_CL(err)
+            err = recvKernel.setArg(3, static_cast<cl_uint>(3));
+            ASSERT_CL(err)
 
             cl::CommandQueue sendQueue(*config.context, *config.device, 0, &err);
             ASSERT_CL(err)
@@ -85,8 +171,15 @@ namespace network::execution_types::iec {
 
         }
 
+        // The single channels are measured first, because the validation data is written by the last execution
+        std::vector<double> linkTimings;
+        if (config.programSettings->perLinkMode) {
+            linkTimings = measureLinks(config, sendKernels, recvKernels, sendQueues, recvQueues);
+        }
+
         std::vector<double> calculationTimings;
-        for (uint r =0; r < config.programSettings->numRepetitions; r++) {
+        config.repetitions->start(*config.programSettings);
+        for (uint r =0; config.repetitions->next(calculationTimings); r++) {
             MPI_Barrier(MPI_COMM_WORLD);
             auto startCalculation = std::chrono::high_resolution_clock::now();
 #ifdef HOST_EMULATION_REORDER
@@ -158,6 +251,7 @@ namespace network::execution_types::iec {
         std::cout << "Rank " << current_rank << ": Done " << r << std::endl;
 #endif
         }
+        config.repetitions->discardWarmup(calculationTimings);
         // Read validation data from FPGA will be placed sequentially in buffer for all replications
         // The data order should not matter, because every byte should have the same value!
         for (int r = 0; r < config.programSettings->kernelReplications; r++) {
@@ -167,7 +261,9 @@ namespace network::execution_types::iec {
         std::shared_ptr<network::ExecutionTimings> result(new network::ExecutionTimings{
                 looplength,
                 messageSize,
-                calculationTimings
+                calculationTimings,
+                {},
+                linkTimings
         });
         return result;
     }
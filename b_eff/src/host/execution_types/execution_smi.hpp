@@ -0,0 +1,169 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SRC_HOST_EXECUTION_TYPES_EXECUTION_SMI_HPP
+#define SRC_HOST_EXECUTION_TYPES_EXECUTION_SMI_HPP
+
+/* C++ standard library headers */
+#include <memory>
+#include <vector>
+#include <chrono>
+
+/* External library headers */
+#include "CL/cl_ext_intelfpga.h"
+#include "mpi.h"
+
+/* Project's headers */
+#include "execution_types/smi_generated_host.hpp"
+
+namespace network::execution_types::smi {
+
+    /**
+     * @brief Initialize the SMI communicator and start the SMI transport kernels on the device.
+     *        This has to be done only once, since the transport kernels keep running for all message sizes.
+     * 
+     * @param config The execution settings of the benchmark
+     * @param routingBuffers Device buffers that hold the routing tables. They have to be kept until the benchmark finished
+     * @return SMI_Comm The communicator that is passed to the kernels
+     */
+    SMI_Comm
+    initCommunicator(hpcc_base::ExecutionSettings<network::NetworkProgramSettings> const& config, std::vector<cl::Buffer> &routingBuffers) {
+        int current_rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, & current_rank);
+
+        int current_size;
+        MPI_Comm_size(MPI_COMM_WORLD, & current_size);
+
+        return SmiInit_communication_bw520n_SMI(current_rank, current_size, config.programSettings->smiRoutingDirectory.c_str(),
+                                                *config.context, *config.program, routingBuffers);
+    }
+
+    /*
+    Implementation for the single kernel.
+    The messages are routed by SMI, so the ranks do not have to be connected in a torus.
+     @copydoc bm_execution::calculate()
+    */
+    std::shared_ptr<network::ExecutionTimings>
+    calculate(hpcc_base::ExecutionSettings<network::NetworkProgramSettings> const& config, cl_uint messageSize, cl_uint looplength,
+                cl::vector<HOST_DATA_TYPE> &validationData, SMI_Comm comm) {
+
+        int err;
+        std::vector<cl::Kernel> sendKernels;
+        std::vector<cl::Kernel> recvKernels;
+        std::vector<cl::CommandQueue> sendQueues;
+        std::vector<cl::CommandQueue> recvQueues;
+        std::vector<cl::Buffer> validationBuffers;
+
+        // Create all kernels and buffers. The kernel pairs are generated twice to utilize all channels
+        for (int r = 0; r < config.programSettings->kernelReplications; r++) {
+
+            validationBuffers.push_back(cl::Buffer(*config.context, CL_MEM_WRITE_ONLY, sizeof(HOST_DATA_TYPE) * validationData.size(),0,&err));
+            ASSERT_CL(err)
+
+            cl::Kernel sendKernel(*config.program, (SEND_KERNEL_NAME + std::to_string(r)).c_str(), &err);
+            ASSERT_CL(err)
+
+            err = sendKernel.setArg(0, messageSize);
+            ASSERT_CL(err)
+            err = sendKernel.setArg(1, looplength);
+            ASSERT_CL(err)
+            err = sendKernel.setArg(2, comm);
+            ASSERT_CL(err)
+
+            cl::Kernel recvKernel(*config.program, (RECV_KERNEL_NAME + std::to_string(r)).c_str(), &err);
+            ASSERT_CL(err)
+            err = recvKernel.setArg(0, validationBuffers[r]);
+            ASSERT_CL(err)
+            err = recvKernel.setArg(1, messageSize);
+            ASSERT_CL(err)
+            err = recvKernel.setArg(2, looplength);
+            ASSERT_CL(err)
+            err = recvKernel.setArg(3, comm);
+            ASSERT_CL(err)
+
+            cl::CommandQueue sendQueue(*config.context, config.getDevice(r), config.profiler->getQueueProperties(), &err);
+            ASSERT_CL(err)
+            cl::CommandQueue recvQueue(*config.context, config.getDevice(r), config.profiler->getQueueProperties(), &err);
+            ASSERT_CL(err)
+
+            recvQueues.push_back(recvQueue);
+            sendQueues.push_back(sendQueue);
+            sendKernels.push_back(sendKernel);
+            recvKernels.push_back(recvKernel);
+
+        }
+
+        std::vector<double> calculationTimings;
+        config.repetitions->start(*config.programSettings);
+        for (uint r =0; config.repetitions->next(calculationTimings); r++) {
+            MPI_Barrier(MPI_COMM_WORLD);
+            auto startCalculation = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < config.programSettings->kernelReplications; i++) {
+                sendQueues[i].enqueueNDRangeKernel(sendKernels[i], cl::NullRange, cl::NDRange(1));
+                recvQueues[i].enqueueNDRangeKernel(recvKernels[i], cl::NullRange, cl::NDRange(1));
+                #ifndef NDEBUG
+                        int current_rank;
+                        MPI_Comm_rank(MPI_COMM_WORLD, & current_rank);
+                        std::cout << "Rank " << current_rank << ": Enqueued " << r << "," << i << std::endl;
+                #endif
+            }
+            for (int i = 0; i < config.programSettings->kernelReplications; i++) {
+                sendQueues[i].finish();
+                #ifndef NDEBUG
+                        int current_rank;
+                        MPI_Comm_rank(MPI_COMM_WORLD, & current_rank);
+                        std::cout << "Rank " << current_rank << ": Send done " << r << "," << i << std::endl;
+                #endif
+                recvQueues[i].finish();
+                #ifndef NDEBUG
+                        MPI_Comm_rank(MPI_COMM_WORLD, & current_rank);
+                        std::cout << "Rank " << current_rank << ": Recv done " << r << "," << i << std::endl;
+                #endif
+            }
+            auto endCalculation = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> calculationTime =
+                    std::chrono::duration_cast<std::chrono::duration<double>>
+                            (endCalculation - startCalculation);
+            calculationTimings.push_back(calculationTime.count());
+#ifndef NDEBUG
+        int current_rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, & current_rank);
+        std::cout << "Rank " << current_rank << ": Done " << r << std::endl;
+#endif
+        }
+        config.repetitions->discardWarmup(calculationTimings);
+        // Read validation data from FPGA will be placed sequentially in buffer for all replications
+        // The data order should not matter, because every byte should have the same value!
+        for (int r = 0; r < config.programSettings->kernelReplications; r++) {
+            err = recvQueues[r].enqueueReadBuffer(validationBuffers[r], CL_TRUE, 0, sizeof(HOST_DATA_TYPE) * validationData.size() / config.programSettings->kernelReplications, &validationData.data()[r * validationData.size() / config.programSettings->kernelReplications]);
+            ASSERT_CL(err);
+        }
+        std::shared_ptr<network::ExecutionTimings> result(new network::ExecutionTimings{
+                looplength,
+                messageSize,
+                calculationTimings
+        });
+        return result;
+    }
+
+}  // namespace network::execution_types::smi
+
+#endif
\ No newline at end of file
@@ -13,7 +13,8 @@ The program entry point
 int
 main(int argc, char *argv[]) {
     // Initialize the MPI environment
-    MPI_Init(&argc, &argv);
+    // Request the thread support for the communication progress thread of the PCIE communication type
+    hpcc_base::initializeMPI(&argc, &argv);
     // Setup benchmark
     NetworkBenchmark bm(argc, argv);
     bool success = bm.executeBenchmark();
@@ -29,14 +29,39 @@ SOFTWARE.
 /* C++ standard library headers */
 #include <memory>
 #include <random>
+#include <cmath>
 
 /* Project's headers */
 #include "execution_types/execution.hpp"
+#include "hpcc_suite.hpp"
 #include "parameters.h"
 
 network::NetworkProgramSettings::NetworkProgramSettings(cxxopts::ParseResult &results) : hpcc_base::BaseSettings(results),
     maxLoopLength(results["u"].as<uint>()), minLoopLength(results["l"].as<uint>()), maxMessageSize(results["m"].as<uint>()), 
-    minMessageSize(results["min-size"].as<uint>()), llOffset(results["o"].as<uint>()), llDecrease(results["d"].as<uint>()) {
+    minMessageSize(results["min-size"].as<uint>()), llOffset(results["o"].as<uint>()), llDecrease(results["d"].as<uint>()),
+    windowSize(results["window"].as<uint>()), latencyMode(results["latency"].count() > 0),
+    pattern(stringToPattern(results["pattern"].as<std::string>())), patternSeed(results["pattern-seed"].as<uint>()),
+    smiRoutingDirectory(results["smi-routes"].as<std::string>()), perLinkMode(results["per-link"].count() > 0) {
+        if (pattern != CommunicationPattern::ring && communicationType == hpcc_base::CommunicationType::intel_external_channels) {
+            throw std::runtime_error("IEC only supports the RING pattern, because the channels connect the neighbouring FPGAs!");
+        }
+#ifndef USE_SMI
+        if (communicationType == hpcc_base::CommunicationType::smi) {
+            throw std::runtime_error("The host code was built without support for SMI. Enable it with USE_SMI!");
+        }
+#endif
+        if (pattern != CommunicationPattern::ring && communicationType == hpcc_base::CommunicationType::smi) {
+            throw std::runtime_error("SMI only supports the RING pattern, because the kernels calculate the neighbouring ranks!");
+        }
+        if (perLinkMode && communicationType != hpcc_base::CommunicationType::intel_external_channels) {
+            throw std::runtime_error("Per-link mode is only supported by the IEC communication type!");
+        }
+        if (latencyMode && windowSize > 0) {
+            throw std::runtime_error("Latency mode requires blocking messages and can not be combined with a window!");
+        }
+        if (latencyMode && (communicationType == hpcc_base::CommunicationType::intel_external_channels || communicationType == hpcc_base::CommunicationType::smi)) {
+            throw std::runtime_error("Latency mode is only supported by the PCIE and CPU communication types!");
+        }
 
 }
 
@@ -45,6 +70,13 @@ network::NetworkProgramSettings::getSettingsMap() {
         auto map = hpcc_base::BaseSettings::getSettingsMap();
         map["Loop Length"] = std::to_string(minLoopLength) + " - " + std::to_string(maxLoopLength);
         map["Message Sizes"] =  "2^" + std::to_string(minMessageSize) + " - 2^" + std::to_string(maxMessageSize) + " Bytes";
+        map["Window Size"] = (windowSize == 0) ? "blocking" : std::to_string(windowSize);
+        map["Latency Mode"] = latencyMode ? "Yes" : "No";
+        if (communicationType == hpcc_base::CommunicationType::smi) {
+            map["SMI Routes"] = smiRoutingDirectory;
+        }
+        map["Per-Link Mode"] = perLinkMode ? "Yes" : "No";
+        map["Pattern"] = patternToString(pattern) + ((pattern == CommunicationPattern::random_ring) ? " (seed " + std::to_string(patternSeed) + ")" : "");
         return map;
 }
 
@@ -73,6 +105,11 @@ network::NetworkBenchmark::NetworkBenchmark(int argc, char* argv[]) {
 
 network::NetworkBenchmark::NetworkBenchmark() {}
 
+hpcc_base::suite::BenchmarkResult
+network::runSuiteBenchmark(int argc, char* argv[]) {
+    return hpcc_base::suite::runBenchmark<network::NetworkBenchmark>(argc, argv);
+}
+
 void
 network::NetworkBenchmark::addAdditionalParseOptions(cxxopts::Options &options) {
     options.add_options()
@@ -86,7 +123,21 @@ network::NetworkBenchmark::addAdditionalParseOptions(cxxopts::Options &options)
         ("o", "Offset used before reducing repetitions",
             cxxopts::value<uint>()->default_value(std::to_string(DEFAULT_LOOP_LENGTH_OFFSET)))
         ("d", "Number os steps the repetitions are decreased to its minimum",
-            cxxopts::value<uint>()->default_value(std::to_string(DEFAULT_LOOP_LENGTH_DECREASE)));
+            cxxopts::value<uint>()->default_value(std::to_string(DEFAULT_LOOP_LENGTH_DECREASE)))
+        ("window", "Number of outstanding non-blocking messages per kernel replication for the PCIE and CPU communication types. "\
+            "Device reads and writes are overlapped with the communication. If 0, blocking MPI_Sendrecv is used",
+            cxxopts::value<uint>()->default_value(std::to_string(0)))
+        ("latency", "Measure the time of every single message exchange and report the latency distribution for every message size and pair of ranks. "\
+            "Only supported by the PCIE and CPU communication types")
+        ("pattern", "Communication pattern: RING for the natural ring of ranks, RANDOM for a random ring, BISECTION for pairs of ranks in both halves "\
+            "of the ranks and ALLTOALL for messages between all ranks. IEC only supports RING",
+            cxxopts::value<std::string>()->default_value("RING"))
+        ("pattern-seed", "Seed of the random ring of the RANDOM pattern",
+            cxxopts::value<uint>()->default_value(std::to_string(1)))
+        ("smi-routes", "Directory that contains the routing tables generated by SMI for the used topology. Only used by the SMI communication type",
+            cxxopts::value<std::string>()->default_value("smi-routes"))
+        ("per-link", "Measure every external channel on its own and all channels concurrently and report the bandwidth and latency of every channel. "\
+            "Only supported by the IEC communication type");
 }
 
 std::unique_ptr<network::NetworkExecutionTimings>
@@ -101,114 +152,316 @@ network::NetworkBenchmark::executeKernel(NetworkData &data) {
 
     std::vector<std::shared_ptr<network::ExecutionTimings>> timing_results;
 
+    // The PCIe and CPU implementations use the same queues and buffers for all message sizes,
+    // so they are created once for the largest message size
+    std::unique_ptr<execution_types::CommunicationBuffers> buffers;
+    if (executionSettings->programSettings->communicationType == hpcc_base::CommunicationType::cpu_only ||
+            executionSettings->programSettings->communicationType == hpcc_base::CommunicationType::pcie_mpi) {
+        size_t max_size = 0;
+        for (auto& run : data.items) {
+            max_size = std::max(max_size, std::max(run.validationBuffer.size(), static_cast<size_t>(1) << run.messageSize));
+        }
+        buffers = std::unique_ptr<execution_types::CommunicationBuffers>(new execution_types::CommunicationBuffers(*executionSettings, max_size));
+    }
+#ifdef USE_SMI
+    // The SMI transport kernels are started once and are used for all message sizes
+    std::vector<cl::Buffer> smiRoutingBuffers;
+    SMI_Comm smiComm;
+    if (executionSettings->programSettings->communicationType == hpcc_base::CommunicationType::smi) {
+        smiComm = execution_types::smi::initCommunicator(*executionSettings, smiRoutingBuffers);
+    }
+#endif
+
     for (auto& run : data.items) {
         if (world_rank == 0) {
             std::cout << "Measure for " << (1 << run.messageSize) << " Byte" << std::endl;
         }
         std::shared_ptr<network::ExecutionTimings> timing;
         switch (executionSettings->programSettings->communicationType) {
-            case hpcc_base::CommunicationType::cpu_only: timing = execution_types::cpu::calculate(*executionSettings, run.messageSize, run.loopLength, run.validationBuffer); break;
-            case hpcc_base::CommunicationType::pcie_mpi: timing = execution_types::pcie::calculate(*executionSettings, run.messageSize, run.loopLength, run.validationBuffer); break;
+            case hpcc_base::CommunicationType::cpu_only: timing = execution_types::cpu::calculate(*executionSettings, run.messageSize, run.loopLength, run.validationBuffer, *buffers); break;
+            case hpcc_base::CommunicationType::pcie_mpi: timing = execution_types::pcie::calculate(*executionSettings, run.messageSize, run.loopLength, run.validationBuffer, *buffers); break;
             case hpcc_base::CommunicationType::intel_external_channels: timing = execution_types::iec::calculate(*executionSettings, run.messageSize, run.loopLength, run.validationBuffer); break;
+#ifdef USE_SMI
+            case hpcc_base::CommunicationType::smi: timing = execution_types::smi::calculate(*executionSettings, run.messageSize, run.loopLength, run.validationBuffer, smiComm); break;
+#endif
             default: throw std::runtime_error("Selected Communication type not supported: " + hpcc_base::commToString(executionSettings->programSettings->communicationType));
         }
         timing_results.push_back(timing);
     }
 
     std::unique_ptr<network::NetworkExecutionTimings> collected_results = std::unique_ptr<network::NetworkExecutionTimings> (new network::NetworkExecutionTimings());
-    if (world_rank > 0) {
-        for (const auto& t : timing_results) {
-            MPI_Send(&(t->messageSize),
-                     1,
-                     MPI_UNSIGNED, 0, 0, MPI_COMM_WORLD);
-            MPI_Send(&(t->looplength),
-                     1,
-                     MPI_UNSIGNED, 0, 1, MPI_COMM_WORLD);
-            MPI_Send(&(t->calculationTimings.front()),
-                     executionSettings->programSettings->numRepetitions,
-                     MPI_DOUBLE, 0,  2, MPI_COMM_WORLD);
+
+    // The slowest rank defines the time of every repetition and the best time of every message size.
+    // All ranks execute the same number of repetitions for a message size, so the timings have the same layout on all ranks.
+    std::vector<double> local_min_timings;
+    std::vector<double> local_timings;
+    for (const auto& t : timing_results) {
+        local_min_timings.push_back(*std::min_element(t->calculationTimings.begin(), t->calculationTimings.end()));
+        local_timings.insert(local_timings.end(), t->calculationTimings.begin(), t->calculationTimings.end());
+    }
+    std::vector<double> max_min_timings(local_min_timings.size());
+    std::vector<double> max_timings(local_timings.size());
+    MPI_Reduce(local_min_timings.data(), max_min_timings.data(), local_min_timings.size(), MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(local_timings.data(), max_timings.data(), local_timings.size(), MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    // Pack the results of all message sizes of a rank, so they are collected with a single gather:
+    // message size, loop length, number of timings, timings, number of replications, (number of latencies, latencies) per replication,
+    // number of link timings, link timings
+    std::vector<double> packed;
+    for (const auto& t : timing_results) {
+        packed.push_back(t->messageSize);
+        packed.push_back(t->looplength);
+        packed.push_back(t->calculationTimings.size());
+        packed.insert(packed.end(), t->calculationTimings.begin(), t->calculationTimings.end());
+        packed.push_back(t->latencies.size());
+        for (const auto& l : t->latencies) {
+            packed.push_back(l.size());
+            packed.insert(packed.end(), l.begin(), l.end());
         }
-    } else {
-        std::cout << "Collect results over MPI.";
-        int k = 0;
+        packed.push_back(t->linkTimings.size());
+        packed.insert(packed.end(), t->linkTimings.begin(), t->linkTimings.end());
+    }
+    int packed_size = packed.size();
+    std::vector<int> packed_sizes(world_size);
+    MPI_Gather(&packed_size, 1, MPI_INT, packed_sizes.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+    std::vector<int> displacements(world_size, 0);
+    for (int i = 1; i < world_size; i++) {
+        displacements[i] = displacements[i - 1] + packed_sizes[i - 1];
+    }
+    std::vector<double> all_packed(world_rank == 0 ? displacements.back() + packed_sizes.back() : 0);
+    MPI_Gatherv(packed.data(), packed_size, MPI_DOUBLE, all_packed.data(), packed_sizes.data(), displacements.data(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+    if (world_rank == 0) {
+        size_t offset = 0;
         for (auto& run : data.items) {
-            std::vector<std::shared_ptr<network::ExecutionTimings>> tmp_timings;
-            std::cout << ".";
-            for (int i=1; i < world_size; i++) {
-                auto execution_result = std::shared_ptr<network::ExecutionTimings>( new network::ExecutionTimings {
-                    0,0,std::vector<double>(executionSettings->programSettings->numRepetitions)
-                });
-                MPI_Status status;
-                MPI_Recv(&(execution_result->messageSize),
-                         1,
-                         MPI_UNSIGNED, i, 0, MPI_COMM_WORLD, &status);
-                MPI_Recv(&(execution_result->looplength),
-                         1,
-                         MPI_UNSIGNED, i, 1, MPI_COMM_WORLD, &status);
-                MPI_Recv(&(execution_result->calculationTimings.front()),
-                         executionSettings->programSettings->numRepetitions,
-                         MPI_DOUBLE, i, 2, MPI_COMM_WORLD, &status);
-                tmp_timings.push_back(execution_result);
-                if (execution_result->messageSize != run.messageSize) {
-                    std::cerr << "Wrong message size: " << execution_result->messageSize << " != " << run.messageSize << " from rank " << i << std::endl;
+            collected_results->timings.emplace(run.messageSize, std::make_shared<std::vector<std::shared_ptr<network::ExecutionTimings>>>());
+        }
+        // The results are stored in the order of the ranks
+        for (int i = 0; i < world_size; i++) {
+            for (size_t k = 0; k < data.items.size(); k++) {
+                auto execution_result = std::make_shared<network::ExecutionTimings>();
+                execution_result->messageSize = static_cast<cl_uint>(all_packed[offset++]);
+                execution_result->looplength = static_cast<cl_uint>(all_packed[offset++]);
+                size_t count = static_cast<size_t>(all_packed[offset++]);
+                execution_result->calculationTimings.assign(all_packed.begin() + offset, all_packed.begin() + offset + count);
+                offset += count;
+                execution_result->latencies.resize(static_cast<size_t>(all_packed[offset++]));
+                for (auto& l : execution_result->latencies) {
+                    count = static_cast<size_t>(all_packed[offset++]);
+                    l.assign(all_packed.begin() + offset, all_packed.begin() + offset + count);
+                    offset += count;
+                }
+                count = static_cast<size_t>(all_packed[offset++]);
+                execution_result->linkTimings.assign(all_packed.begin() + offset, all_packed.begin() + offset + count);
+                offset += count;
+                if (execution_result->messageSize != data.items[k].messageSize) {
+                    std::cerr << "Wrong message size: " << execution_result->messageSize << " != " << data.items[k].messageSize << " from rank " << i << std::endl;
                     throw std::runtime_error("Wrong message size received! Something went wrong in the MPI communication");
                 }
+                collected_results->timings[execution_result->messageSize]->push_back(execution_result);
             }
-            tmp_timings.push_back(timing_results[k]);
-            k++;
-            collected_results->timings.emplace(run.messageSize, std::make_shared<std::vector<std::shared_ptr<network::ExecutionTimings>>>(tmp_timings));
         }
-        std::cout << " done!" << std::endl;
+        size_t timing_offset = 0;
+        for (size_t k = 0; k < timing_results.size(); k++) {
+            size_t count = timing_results[k]->calculationTimings.size();
+            collected_results->maxMinCalculationTimings[timing_results[k]->messageSize] = max_min_timings[k];
+            collected_results->maxCalculationTimings[timing_results[k]->messageSize] = std::vector<double>(max_timings.begin() + timing_offset, max_timings.begin() + timing_offset + count);
+            timing_offset += count;
+        }
     }
+    collected_results->localTimings = timing_results;
 
-        return collected_results;
+    return collected_results;
 }
 
 void
 network::NetworkBenchmark::collectAndPrintResults(const network::NetworkExecutionTimings &output) {
     std::vector<double> maxBandwidths;
 
+    for (const auto& timing : output.localTimings) {
+        rawTimings[std::to_string(1 << timing->messageSize) + " B"] = timing->calculationTimings;
+        for (size_t i = 0; i < timing->latencies.size(); i++) {
+            rawTimings[std::to_string(1 << timing->messageSize) + " B latency replication " + std::to_string(i)] = timing->latencies[i];
+        }
+        if (!timing->linkTimings.empty()) {
+            rawTimings[std::to_string(1 << timing->messageSize) + " B links"] = timing->linkTimings;
+        }
+    }
+
     if (mpi_comm_rank == 0) {
         std::cout << std::setw(ENTRY_SPACE) << "MSize" << "   "
                 << std::setw(ENTRY_SPACE) << "looplength" << "   "
                 << std::setw(ENTRY_SPACE) << "transfer" << "   "
                 << std::setw(ENTRY_SPACE) << "B/s" << std::endl;
-        std::vector<double> totalMaxMinCalculationTime;
-        for (long unsigned int i =0; i < output.timings.size(); i++) {
-            totalMaxMinCalculationTime.push_back(0.0);
-        }
-        int i = 0;
-        for (const auto& msgSizeResults : output.timings) {
-            for (const auto& r : *msgSizeResults.second) {
-                double localMinCalculationTime = *min_element(r->calculationTimings.begin(), r->calculationTimings.end());
-                totalMaxMinCalculationTime[i] = std::max(totalMaxMinCalculationTime[i], localMinCalculationTime);
-            }
-            i++;
-        }
-        i = 0;
+        auto settings = executionSettings->programSettings.get();
+        size_t exchanges = getExchanges(settings->pattern, settings->patternSeed, mpi_comm_rank, mpi_comm_size, 0).size();
         for (const auto& msgSizeResults : output.timings) {
             int looplength = msgSizeResults.second->at(0)->looplength;
             // The total sent data in bytes will be:
-            // #Nodes * message_size * looplength * 2
+            // #Nodes * message_size * looplength * 2 * #exchanges
             // the * 2 is because we have two kernels per bitstream that will send and receive simultaneously.
+            // The number of exchanges per iteration is one except for the all-to-all pattern.
             // This will be divided by half of the maximum of the minimum measured runtime over all ranks.
-            double maxCalcBW = static_cast<double>(msgSizeResults.second->size() * 2 * (1 << msgSizeResults.first) * looplength)
-                                                                / (totalMaxMinCalculationTime[i]);
+            double maxCalcBW = static_cast<double>(msgSizeResults.second->size() * 2 * (1 << msgSizeResults.first) * looplength * exchanges)
+                                                                / output.maxMinCalculationTimings.at(msgSizeResults.first);
 
             maxBandwidths.push_back(maxCalcBW);
+            derivedMetrics[std::to_string(1 << msgSizeResults.first) + " B [B/s]"] = maxCalcBW;
 
             std::cout << std::setw(ENTRY_SPACE) << (1 << msgSizeResults.first) << "   "
                     << std::setw(ENTRY_SPACE) << looplength << "   "
-                    << std::setw(ENTRY_SPACE) << totalMaxMinCalculationTime[i] << "   "
+                    << std::setw(ENTRY_SPACE) << output.maxMinCalculationTimings.at(msgSizeResults.first) << "   "
                     << std::setw(ENTRY_SPACE)  << maxCalcBW
                     << std::endl;
-            i++;
         }
 
 
         double b_eff = accumulate(maxBandwidths.begin(), maxBandwidths.end(), 0.0) / static_cast<double>(maxBandwidths.size());
 
-        std::cout << std::endl << "b_eff = " << b_eff << " B/s" << std::endl;
+        derivedMetrics["b_eff [B/s]"] = b_eff;
+        derivedMetrics["b_eff " + patternToString(settings->pattern) + " [B/s]"] = b_eff;
+
+        std::cout << std::endl << "b_eff = " << b_eff << " B/s (" << patternToString(settings->pattern) << ")" << std::endl;
+
+        // The slowest rank determines the time of every repetition
+        std::map<std::string, std::vector<double>> maxCalculationTimings;
+        for (const auto& t : output.maxCalculationTimings) {
+            maxCalculationTimings[std::to_string(1 << t.first) + " B"] = t.second;
+        }
+        printTimingStatistics(maxCalculationTimings);
+
+        if (settings->communicationType == hpcc_base::CommunicationType::intel_external_channels && !maxBandwidths.empty()) {
+            // Every kernel replication sends CHANNEL_WIDTH bytes per cycle over its external channel.
+            // The bandwidth of the largest message is compared, since the small messages are latency bound.
+            hpcc_base::Roofline roofline{mpi_comm_size * settings->kernelReplications * static_cast<double>(CHANNEL_WIDTH) * getKernelFrequency(), 0.0, 0.0};
+            printEfficiency({{std::to_string(1 << output.timings.rbegin()->first) + " B", {maxBandwidths.back(), roofline}}}, "B/s", 1.0);
+        }
+
+        if (executionSettings->programSettings->latencyMode) {
+            printLatencies(output);
+        }
+        if (executionSettings->programSettings->perLinkMode) {
+            printLinks(output);
+        }
+    }
+}
+
+void
+network::NetworkBenchmark::printLinks(const network::NetworkExecutionTimings &output) {
+    int replications = executionSettings->programSettings->kernelReplications;
+    // The bandwidth is calculated from the largest and the latency from the smallest message size
+    const auto& bwResults = *output.timings.rbegin();
+    const auto& latResults = *output.timings.begin();
+    double messageBytes = static_cast<double>(1 << bwResults.first);
+
+    // Every channel sends and receives the whole message in single channel mode
+    std::vector<double> bandwidths;
+    for (const auto& r : *bwResults.second) {
+        for (double t : r->linkTimings) {
+            bandwidths.push_back(2.0 * messageBytes * r->looplength / t);
+        }
+    }
+    std::vector<double> sortedBandwidths(bandwidths);
+    std::sort(sortedBandwidths.begin(), sortedBandwidths.end());
+    double medianBandwidth = hpcc_base::percentile(sortedBandwidths, 0.5);
+
+    std::cout << std::endl << std::setw(ENTRY_SPACE) << "rank" << "   "
+            << std::setw(ENTRY_SPACE) << "channel" << "   "
+            << std::setw(ENTRY_SPACE) << "B/s" << "   "
+            << std::setw(ENTRY_SPACE) << "latency [s]" << std::endl;
+    for (int rank = 0; rank < static_cast<int>(bwResults.second->size()); rank++) {
+        const auto& bwRank = bwResults.second->at(rank);
+        const auto& latRank = latResults.second->at(rank);
+        for (int c = 0; c < 2; c++) {
+            for (int i = 0; i < replications; i++) {
+                // Channel used by the kernel replication as defined in the kernel code for the Bittware 520N
+                int channel = (i + 2 * c) % 4;
+                double bandwidth = bandwidths[rank * 2 * replications + c * replications + i];
+                double latency = latRank->linkTimings[c * replications + i] / latRank->looplength;
+                std::string name = "rank " + std::to_string(rank) + " channel " + std::to_string(channel);
+                derivedMetrics[name + " [B/s]"] = bandwidth;
+                derivedMetrics[name + " latency [s]"] = latency;
+                std::cout << std::setw(ENTRY_SPACE) << rank << "   "
+                        << std::setw(ENTRY_SPACE) << channel << "   "
+                        << std::setw(ENTRY_SPACE) << bandwidth << "   "
+                        << std::setw(ENTRY_SPACE) << latency
+                        << ((bandwidth < 0.9 * medianBandwidth) ? "   <-- below 90% of median" : "") << std::endl;
+            }
+        }
+    }
+
+    // All channels of a rank are used concurrently in the regular measurement, where every channel transfers half of a message
+    std::cout << std::endl << std::setw(ENTRY_SPACE) << "rank" << "   "
+            << std::setw(ENTRY_SPACE) << "sum single B/s" << "   "
+            << std::setw(ENTRY_SPACE) << "concurrent B/s" << std::endl;
+    for (int rank = 0; rank < static_cast<int>(bwResults.second->size()); rank++) {
+        const auto& r = bwResults.second->at(rank);
+        double sum = std::accumulate(bandwidths.begin() + rank * 2 * replications, bandwidths.begin() + (rank + 1) * 2 * replications, 0.0);
+        double concurrent = 2.0 * replications * messageBytes * r->looplength
+                                / *std::min_element(r->calculationTimings.begin(), r->calculationTimings.end());
+        derivedMetrics["rank " + std::to_string(rank) + " concurrent [B/s]"] = concurrent;
+        std::cout << std::setw(ENTRY_SPACE) << rank << "   "
+                << std::setw(ENTRY_SPACE) << sum << "   "
+                << std::setw(ENTRY_SPACE) << concurrent << std::endl;
+    }
+}
+
+void
+network::NetworkBenchmark::printLatencies(const network::NetworkExecutionTimings &output) {
+    std::cout << std::endl << std::setw(ENTRY_SPACE) << "MSize" << "   "
+            << std::setw(ENTRY_SPACE) << "ranks" << "   "
+            << std::setw(ENTRY_SPACE) << "p50 [s]" << "   "
+            << std::setw(ENTRY_SPACE) << "p99 [s]" << "   "
+            << std::setw(ENTRY_SPACE) << "p99.9 [s]" << "   "
+            << std::setw(ENTRY_SPACE) << "max [s]" << std::endl;
+    for (const auto& msgSizeResults : output.timings) {
+        // The results are ordered by the rank that measured them. Both ranks of a pair measure the same exchanges.
+        std::map<std::pair<int, int>, std::vector<double>> pairLatencies;
+        std::vector<double> allLatencies;
+        for (int rank = 0; rank < static_cast<int>(msgSizeResults.second->size()); rank++) {
+            const auto& r = msgSizeResults.second->at(rank);
+            for (int i = 0; i < static_cast<int>(r->latencies.size()); i++) {
+                auto exchanges = getExchanges(executionSettings->programSettings->pattern, executionSettings->programSettings->patternSeed, rank, mpi_comm_size, i);
+                // An iteration of the all-to-all pattern contains the messages to all ranks, so the latencies can not be assigned to a pair
+                if (exchanges.size() == 1) {
+                    int partner = exchanges.front().first;
+                    auto& l = pairLatencies[std::make_pair(std::min(rank, partner), std::max(rank, partner))];
+                    l.insert(l.end(), r->latencies[i].begin(), r->latencies[i].end());
+                }
+                allLatencies.insert(allLatencies.end(), r->latencies[i].begin(), r->latencies[i].end());
+            }
+        }
+        if (allLatencies.empty()) {
+            continue;
+        }
+        std::string size_name = std::to_string(1 << msgSizeResults.first) + " B";
+        auto print_row = [&](std::string const& ranks, std::vector<double>& latencies) {
+            std::sort(latencies.begin(), latencies.end());
+            std::cout << std::setw(ENTRY_SPACE) << (1 << msgSizeResults.first) << "   "
+                    << std::setw(ENTRY_SPACE) << ranks << "   "
+                    << std::setw(ENTRY_SPACE) << hpcc_base::percentile(latencies, 0.5) << "   "
+                    << std::setw(ENTRY_SPACE) << hpcc_base::percentile(latencies, 0.99) << "   "
+                    << std::setw(ENTRY_SPACE) << hpcc_base::percentile(latencies, 0.999) << "   "
+                    << std::setw(ENTRY_SPACE) << latencies.back() << std::endl;
+        };
+        print_row("all", allLatencies);
+        derivedMetrics[size_name + " latency p50 [s]"] = hpcc_base::percentile(allLatencies, 0.5);
+        derivedMetrics[size_name + " latency p99 [s]"] = hpcc_base::percentile(allLatencies, 0.99);
+        derivedMetrics[size_name + " latency p99.9 [s]"] = hpcc_base::percentile(allLatencies, 0.999);
+        for (auto& p : pairLatencies) {
+            print_row(std::to_string(p.first.first) + "-" + std::to_string(p.first.second), p.second);
+        }
+
+        // Histogram with bins of increasing powers of two starting at 1us
+        std::map<int, size_t> histogram;
+        for (double l : allLatencies) {
+            histogram[std::max(0, static_cast<int>(std::floor(std::log2(l * 1.0e6))) + 1)]++;
+        }
+        std::cout << std::setw(ENTRY_SPACE) << "histogram [us]:";
+        for (const auto& bin : histogram) {
+            std::cout << "  " << ((bin.first == 0) ? 0 : (1 << (bin.first - 1))) << "-" << (1 << bin.first) << ": " << bin.second;
+        }
+        std::cout << std::endl;
     }
 }
 
@@ -30,6 +30,7 @@ SOFTWARE.
 /* Project's headers */
 #include "hpcc_benchmark.hpp"
 #include "parameters.h"
+#include "execution_types/communication_patterns.hpp"
 
 /**
  * @brief Contains all classes and methods needed by the Network benchmark
@@ -62,6 +63,20 @@ namespace network {
          * 
          */
         std::vector<double> calculationTimings;
+
+        /**
+         * @brief The time of every single message exchange in seconds for every kernel replication.
+         *          Only measured in latency mode and without the warmup repetitions.
+         * 
+         */
+        std::vector<std::vector<double>> latencies;
+
+        /**
+         * @brief The best kernel runtime in seconds of every kernel replication when only one of its channels is used.
+         *          The index is channel * replications + replication. Only measured in per-link mode.
+         * 
+         */
+        std::vector<double> linkTimings;
     };
 
     /**
@@ -113,6 +128,44 @@ public:
      */
     uint llDecrease;
 
+    /**
+     * @brief Number of outstanding messages per kernel replication for the PCIe and CPU implementations.
+     *          If 0, every message is exchanged with a blocking MPI_Sendrecv.
+     * 
+     */
+    uint windowSize;
+
+    /**
+     * @brief If true, the time of every single message exchange is measured by the PCIe and CPU implementations
+     *          and the latency distribution is reported
+     * 
+     */
+    bool latencyMode;
+
+    /**
+     * @brief The communication pattern that defines which ranks exchange messages
+     * 
+     */
+    CommunicationPattern pattern;
+
+    /**
+     * @brief Seed used to create the random ring pattern
+     * 
+     */
+    uint patternSeed;
+
+    /**
+     * @brief Directory that contains the routing tables for the SMI communication type
+     * 
+     */
+    std::string smiRoutingDirectory;
+
+    /**
+     * @brief Measure every external channel on its own before all channels are measured concurrently
+     * 
+     */
+    bool perLinkMode;
+
     /**
      * @brief Construct a new Network Program Settings object
      * 
@@ -207,6 +260,24 @@ public:
      */
     CollectedResultMap timings;
 
+    /**
+     * @brief The maximum over all ranks of the minimum measured time of every rank for every message size
+     * 
+     */
+    std::map<int, double> maxMinCalculationTimings;
+
+    /**
+     * @brief The maximum over all ranks of the measured time of every repetition for every message size
+     * 
+     */
+    std::map<int, std::vector<double>> maxCalculationTimings;
+
+    /**
+     * @brief The timings of the current rank for every message size. Available on all ranks.
+     * 
+     */
+    std::vector<std::shared_ptr<ExecutionTimings>> localTimings;
+
 };
 
 /**
@@ -253,6 +324,25 @@ public:
     bool
     validateOutputAndPrintError(NetworkData &data) override;
 
+    /**
+     * @brief Print the percentiles of the latencies of all message sizes measured in latency mode for all ranks
+     *          and every pair of ranks and a histogram for all ranks. The percentiles are added to the derived metrics.
+     * 
+     * @param output The collected results of all ranks
+     */
+    void
+    printLatencies(const NetworkExecutionTimings &output);
+
+    /**
+     * @brief Print the bandwidth of the largest and the latency of the smallest message size for every channel of every rank
+     *          measured in per-link mode and compare them to the concurrent use of all channels. Channels with less than
+     *          90% of the median bandwidth are marked. The values are added to the derived metrics.
+     * 
+     * @param output The collected results of all ranks
+     */
+    void
+    printLinks(const NetworkExecutionTimings &output);
+
     /**
      * @brief Network specific implementation of printing the execution results
      * 
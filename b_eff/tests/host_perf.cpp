@@ -0,0 +1,25 @@
+//
+// Micro-benchmarks for the host code of the b_eff benchmark
+//
+#include "benchmark/benchmark.h"
+#include "host_perf_fixture.hpp"
+#include "network_benchmark.hpp"
+#include "parameters.h"
+
+/**
+ * The range gives the maximum message size in log2 of bytes
+ */
+class NetworkHostPerf : public hpcc_base::HostPerfFixture<network::NetworkBenchmark> {
+protected:
+    void
+    setDataSize(benchmark::State& state) override {
+        auto& settings = *getBenchmark().getExecutionSettings().programSettings;
+        settings.minMessageSize = 0;
+        settings.maxMessageSize = state.range(0);
+    }
+};
+
+BENCHMARK_DEFINE_F(NetworkHostPerf, GenerateInputData)(benchmark::State& state) {
+    measureInputDataGeneration(state);
+}
+BENCHMARK_REGISTER_F(NetworkHostPerf, GenerateInputData)->DenseRange(10, 22, 4)->Unit(benchmark::kMicrosecond);
@@ -2,6 +2,7 @@
 // Created by Marius Meyer on 04.12.19.
 //
 #include <memory>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "network_benchmark.hpp"
@@ -296,6 +297,105 @@ TEST_P(NetworkKernelTest, ValidationDataWrongTwoMessageSizesAfterExecution) {
     EXPECT_FALSE(bm->validateOutputAndPrintError(*data));
 }
 
+/**
+ * Tests if the queues and buffers that are created for the largest message size are reused for smaller message sizes
+ * and the received data is correct for all message sizes, also if the message size decreases
+ */
+TEST_P(NetworkKernelTest, ValidationDataCorrectForChangingMessageSizesWithReusedBuffers) {
+    if (bm->getExecutionSettings().programSettings->communicationType == hpcc_base::CommunicationType::intel_external_channels) {
+        // Only the PCIe and CPU implementations reuse the buffers
+        GTEST_SKIP();
+    }
+    const unsigned looplength = 4;
+    data->items.clear();
+    data->items.push_back(network::NetworkData::NetworkDataItem(3, looplength));
+    data->items.push_back(network::NetworkData::NetworkDataItem(1, looplength));
+    data->items.push_back(network::NetworkData::NetworkDataItem(4, looplength));
+    auto result = bm->executeKernel(*data);
+    EXPECT_EQ(result->timings.size(), 3);
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+/**
+ * Tests if the windowed exchange with multiple messages in flight delivers the correct data for multiple message sizes
+ */
+TEST_P(NetworkKernelTest, ValidationDataCorrectForWindowedExchange) {
+    if (bm->getExecutionSettings().programSettings->communicationType == hpcc_base::CommunicationType::intel_external_channels) {
+        // The window is only supported by the PCIe and CPU implementations
+        GTEST_SKIP();
+    }
+    bm->getExecutionSettings().programSettings->windowSize = 2;
+    const unsigned looplength = 5;
+    data->items.clear();
+    data->items.push_back(network::NetworkData::NetworkDataItem(2, looplength));
+    data->items.push_back(network::NetworkData::NetworkDataItem(1, looplength));
+    auto result = bm->executeKernel(*data);
+    EXPECT_EQ(result->timings.find(2)->second->at(0)->calculationTimings.size(), 1);
+    EXPECT_TRUE(bm->validateOutputAndPrintError(*data));
+}
+
+/**
+ * Tests if the latency of every message is measured for every kernel replication in latency mode
+ */
+TEST_P(NetworkKernelTest, LatencyModeMeasuresEveryMessage) {
+    if (bm->getExecutionSettings().programSettings->communicationType == hpcc_base::CommunicationType::intel_external_channels) {
+        // The IEC kernels can not measure the latency of single messages
+        GTEST_SKIP();
+    }
+    bm->getExecutionSettings().programSettings->latencyMode = true;
+    const unsigned looplength = 4;
+    data->items.clear();
+    data->items.push_back(network::NetworkData::NetworkDataItem(1, looplength));
+    auto result = bm->executeKernel(*data);
+    auto timing = result->timings.find(1)->second->at(0);
+    EXPECT_EQ(timing->latencies.size(), bm->getExecutionSettings().programSettings->kernelReplications);
+    for (auto const& replication_latencies : timing->latencies) {
+        EXPECT_EQ(replication_latencies.size(), looplength * timing->calculationTimings.size());
+        for (double latency : replication_latencies) {
+            EXPECT_GE(latency, 0.0);
+        }
+    }
+}
+
+/**
+ * Tests if the loop length of every message size is reduced after the offset and stays above the minimum loop length
+ */
+TEST(NetworkDataTest, LoopLengthsDecreaseWithMessageSize) {
+    network::NetworkData data(64, 4, 0, 10, 4, 3);
+    std::vector<unsigned> expected_looplengths = {64, 64, 64, 64, 64, 44, 24, 4, 4, 4, 4};
+    ASSERT_EQ(data.items.size(), expected_looplengths.size());
+    for (size_t i = 0; i < data.items.size(); i++) {
+        EXPECT_EQ(data.items[i].messageSize, i);
+        EXPECT_EQ(data.items[i].loopLength, expected_looplengths[i]);
+    }
+}
+
+/**
+ * Tests if every message that is sent by a rank is received by the destination rank in the same exchange for all patterns
+ */
+TEST(CommunicationPatternTest, ExchangesMatchBetweenRanks) {
+    std::vector<network::CommunicationPattern> patterns = {network::CommunicationPattern::ring, network::CommunicationPattern::random_ring,
+                                                            network::CommunicationPattern::bisection, network::CommunicationPattern::all_to_all};
+    for (auto pattern : patterns) {
+        for (int size = 2; size <= 8; size += 2) {
+            for (int replication = 0; replication < 2; replication++) {
+                SCOPED_TRACE(network::patternToString(pattern) + " with " + std::to_string(size) + " ranks, replication " + std::to_string(replication));
+                std::vector<std::vector<std::pair<int, int>>> exchanges;
+                for (int rank = 0; rank < size; rank++) {
+                    exchanges.push_back(network::getExchanges(pattern, 42, rank, size, replication));
+                }
+                for (int rank = 0; rank < size; rank++) {
+                    for (size_t e = 0; e < exchanges[rank].size(); e++) {
+                        int destination = exchanges[rank][e].first;
+                        ASSERT_EQ(exchanges[destination].size(), exchanges[rank].size());
+                        EXPECT_NE(destination, rank);
+                        EXPECT_EQ(exchanges[destination][e].second, rank);
+                    }
+                }
+            }
+        }
+    }
+}
 
 
 INSTANTIATE_TEST_CASE_P(
@@ -3,6 +3,8 @@ INCLUDE (CheckTypeSize)
 
 set (CMAKE_CXX_STANDARD 11)
 
+set(USE_HOST_PERF_TARGETS No CACHE BOOL "Build the micro-benchmarks for the host code. Google Benchmark will be downloaded as additional dependency")
+
 # Download build dependencies
 add_subdirectory(${CMAKE_SOURCE_DIR}/../extern ${CMAKE_BINARY_DIR}/extern)
 
@@ -22,6 +24,12 @@ else()
     set(comm_support_default No)
 endif()
 
+if(DEFINED MULTI_DEVICE_SUPPORT_ENABLED)
+    set(multi_device_support_default ${MULTI_DEVICE_SUPPORT_ENABLED})
+else()
+    set(multi_device_support_default No)
+endif()
+
 # Host code specific options
 set(DEFAULT_REPETITIONS 10 CACHE STRING "Default number of repetitions")
 set(DEFAULT_DEVICE -1 CACHE STRING "Index of the default device to use")
@@ -36,8 +44,9 @@ set(HPCC_FPGA_CONFIG ${HPCC_FPGA_CONFIG} CACHE FILEPATH "Configuration file that
 set(NUM_REPLICATIONS 4 CACHE STRING "Number of times the kernels will be replicated")
 set(KERNEL_REPLICATION_ENABLED Yes CACHE INTERNAL "Enables kernel replication for the OpenCL kernel targets")
 set(COMMUNICATION_TYPE_SUPPORT_ENABLED ${comm_support_default} CACHE INTERNAL "Enables the support for the selection of the communication type which has to be implemented by the specific benchmark")
+set(MULTI_DEVICE_SUPPORT_ENABLED ${multi_device_support_default} CACHE INTERNAL "Enables the support for multiple devices per MPI rank which has to be implemented by the specific benchmark")
 
-mark_as_advanced(KERNEL_REPLICATION_ENABLED COMMUNICATION_TYPE_SUPPORT_ENABLED)
+mark_as_advanced(KERNEL_REPLICATION_ENABLED COMMUNICATION_TYPE_SUPPORT_ENABLED MULTI_DEVICE_SUPPORT_ENABLED)
 if (NOT KERNEL_REPLICATION_ENABLED)
 # Only define NUM_REPLICATIONS if kernel replications is enabled
  unset(NUM_REPLICATIONS)
@@ -85,6 +94,11 @@ if (USE_MPI)
     add_definitions(-D_USE_MPI_)
     include_directories(${MPI_CXX_INCLUDE_PATH})
     link_libraries(${MPI_LIBRARIES})
+    # MPI requests are only completed by the communication progress thread if this is enabled, since it requires MPI_THREAD_MULTIPLE
+    set(USE_MPI_PROGRESS_THREAD Yes CACHE BOOL "Complete MPI requests in the communication progress thread. Requires MPI_THREAD_MULTIPLE.")
+    if (USE_MPI_PROGRESS_THREAD)
+        add_definitions(-D_USE_MPI_PROGRESS_THREAD_)
+    endif()
 endif()
 
 # Add configuration time to build
@@ -137,11 +151,37 @@ if (COMMUNICATION_TYPE_SUPPORT_ENABLED)
     add_definitions(-DCOMMUNICATION_TYPE_SUPPORT_ENABLED)
 endif()
 
+# set the multi device flag if required
+if (MULTI_DEVICE_SUPPORT_ENABLED)
+    add_definitions(-DMULTI_DEVICE_SUPPORT_ENABLED)
+endif()
+
 # Set OpenCL version that should be used
 set(HPCC_FPGA_OPENCL_VERSION 200 CACHE STRING "OpenCL version that should be used for the host code compilation")
 mark_as_advanced(HPCC_FPGA_OPENCL_VERSION)
 add_definitions(-DCL_HPP_TARGET_OPENCL_VERSION=${HPCC_FPGA_OPENCL_VERSION})
 
+# Select the backend for the annotation of host code regions
+set(HPCC_FPGA_TRACING None CACHE STRING "Backend for the annotation of host code regions: None, ITT, ScoreP or Ring")
+set_property(CACHE HPCC_FPGA_TRACING PROPERTY STRINGS None ITT ScoreP Ring)
+if (HPCC_FPGA_TRACING STREQUAL "ITT")
+    find_path(ITT_INCLUDE_DIR ittnotify.h HINTS $ENV{VTUNE_PROFILER_DIR}/include $ENV{VTUNE_PROFILER_DIR}/sdk/include)
+    find_library(ITT_LIBRARY ittnotify HINTS $ENV{VTUNE_PROFILER_DIR}/lib64 $ENV{VTUNE_PROFILER_DIR}/sdk/lib64)
+    if (NOT ITT_INCLUDE_DIR OR NOT ITT_LIBRARY)
+        message(FATAL_ERROR "ITT tracing requires ittnotify.h and libittnotify. Set VTUNE_PROFILER_DIR to the VTune installation!")
+    endif()
+    include_directories(${ITT_INCLUDE_DIR})
+    link_libraries(${ITT_LIBRARY} ${CMAKE_DL_LIBS})
+    add_definitions(-DHPCC_TRACING_ITT)
+elseif (HPCC_FPGA_TRACING STREQUAL "ScoreP")
+    # The host code has to be compiled with the Score-P compiler wrapper, e.g. CXX="scorep --user g++"
+    add_definitions(-DHPCC_TRACING_SCOREP -DSCOREP_USER_ENABLE)
+elseif (HPCC_FPGA_TRACING STREQUAL "Ring")
+    add_definitions(-DHPCC_TRACING_RING)
+elseif (NOT HPCC_FPGA_TRACING STREQUAL "None")
+    message(FATAL_ERROR "Unknown tracing backend ${HPCC_FPGA_TRACING}. Use one of: None, ITT, ScoreP, Ring")
+endif()
+
 
 # Set the size of the used data type
 list(APPEND CMAKE_REQUIRED_INCLUDES ${IntelFPGAOpenCL_INCLUDE_DIRS} ${Vitis_INCLUDE_DIRS})
@@ -0,0 +1,21 @@
+# Creates the executables for the micro-benchmarks of the host code.
+# The variables HOST_EXE_NAME, LIB_NAME and PERF_SOURCES have to be set before including this file.
+include_directories(${CMAKE_BINARY_DIR}/src/common)
+
+if (INTELFPGAOPENCL_FOUND)
+    include_directories(SYSTEM ${IntelFPGAOpenCL_INCLUDE_DIRS})
+    add_executable(${HOST_EXE_NAME}_host_perf_intel ${PERF_SOURCES})
+    target_link_libraries(${HOST_EXE_NAME}_host_perf_intel benchmark::benchmark ${LIB_NAME}_intel ${IntelFPGAOpenCL_LIBRARIES} "${OpenMP_CXX_FLAGS}")
+    target_link_libraries(${HOST_EXE_NAME}_host_perf_intel hpcc_fpga_base_perf)
+    target_compile_definitions(${HOST_EXE_NAME}_host_perf_intel PRIVATE -DINTEL_FPGA)
+    target_compile_options(${HOST_EXE_NAME}_host_perf_intel PRIVATE "${OpenMP_CXX_FLAGS}")
+endif()
+
+if (Vitis_FOUND)
+    include_directories(SYSTEM ${Vitis_INCLUDE_DIRS})
+    add_executable(${HOST_EXE_NAME}_host_perf_xilinx ${PERF_SOURCES})
+    target_link_libraries(${HOST_EXE_NAME}_host_perf_xilinx benchmark::benchmark ${LIB_NAME}_xilinx ${Vitis_LIBRARIES} "${OpenMP_CXX_FLAGS}")
+    target_link_libraries(${HOST_EXE_NAME}_host_perf_xilinx hpcc_fpga_base_perf)
+    target_compile_definitions(${HOST_EXE_NAME}_host_perf_xilinx PRIVATE -DXILINX_FPGA)
+    target_compile_options(${HOST_EXE_NAME}_host_perf_xilinx PRIVATE "${OpenMP_CXX_FLAGS}")
+endif()
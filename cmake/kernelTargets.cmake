@@ -3,6 +3,13 @@ set(COMPILER_INCLUDES "-I${CMAKE_BINARY_DIR}/src/common/" "-I${CMAKE_CURRENT_SOU
 
 set(Vitis_EMULATION_CONFIG_UTIL $ENV{XILINX_VITIS}/bin/emconfigutil)
 
+# Benchmarks can pass additional python statements to the code generator by setting
+# ADDITIONAL_CODE_GENERATION_PARAMETERS before including this file, e.g. "log_fft_sizes=[12,10]"
+set(additional_codegen_parameters "")
+foreach (codegen_parameter ${ADDITIONAL_CODE_GENERATION_PARAMETERS})
+        list(APPEND additional_codegen_parameters -p "\"${codegen_parameter}\"")
+endforeach()
+
 if (CMAKE_BUILD_TYPE EQUAL "Debug")
         set(VPP_FLAGS "-O0 -g")
 else()
@@ -57,7 +64,7 @@ function(generate_kernel_targets_xilinx)
         )
         if (XILINX_GENERATE_LINK_SETTINGS)
             add_custom_command(OUTPUT ${xilinx_link_settings}
-                    COMMAND ${Python3_EXECUTABLE} ${CODE_GENERATOR} -o ${xilinx_link_settings} -p num_replications=${NUM_REPLICATIONS} --comment "\"#\"" --comment-ml-start "\"$$\"" --comment-ml-end "\"$$\"" ${gen_xilinx_link_settings}
+                    COMMAND ${Python3_EXECUTABLE} ${CODE_GENERATOR} -o ${xilinx_link_settings} -p num_replications=${NUM_REPLICATIONS} ${additional_codegen_parameters} --comment "\"#\"" --comment-ml-start "\"$$\"" --comment-ml-end "\"$$\"" ${gen_xilinx_link_settings}
                     MAIN_DEPENDENCY ${gen_xilinx_link_settings}
                     )
         else()
@@ -69,7 +76,7 @@ function(generate_kernel_targets_xilinx)
 
         if (KERNEL_REPLICATION_ENABLED)
                 add_custom_command(OUTPUT ${source_f}
-                        COMMAND ${Python3_EXECUTABLE} ${CODE_GENERATOR} -o ${source_f} -p num_replications=1 -p num_total_replications=${NUM_REPLICATIONS} ${base_file}
+                        COMMAND ${Python3_EXECUTABLE} ${CODE_GENERATOR} -o ${source_f} -p num_replications=1 -p num_total_replications=${NUM_REPLICATIONS} ${additional_codegen_parameters} ${base_file}
                         MAIN_DEPENDENCY ${base_file}
                 )
         else()
@@ -139,7 +146,7 @@ function(generate_kernel_targets_intel)
         set(bitstream_emulate_f ${kernel_file_name}_emulate.aocx)
         set(bitstream_f ${kernel_file_name}.aocx)
         if (KERNEL_REPLICATION_ENABLED)
-                set(codegen_parameters -p num_replications=${NUM_REPLICATIONS} -p num_total_replications=${NUM_REPLICATIONS})
+                set(codegen_parameters -p num_replications=${NUM_REPLICATIONS} -p num_total_replications=${NUM_REPLICATIONS} ${additional_codegen_parameters})
                 if (INTEL_CODE_GENERATION_SETTINGS)
                         list(APPEND codegen_parameters -p "\"use_file('${INTEL_CODE_GENERATION_SETTINGS}')\"")
                 endif()
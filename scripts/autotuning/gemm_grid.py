@@ -0,0 +1,16 @@
+# Example grid for the GEMM benchmark that can be used with
+#
+#     ./sweep.py -b GEMM -k gemm_base --grid gemm_grid.py
+#
+# All values are passed to CMake, which forwards them to the code generator and the kernel compiler.
+
+grid = {
+    "BLOCK_SIZE": [256, 512],
+    "GEMM_BLOCK": [8, 16],
+    "GLOBAL_MEM_UNROLL": [8, 16],
+    "NUM_REPLICATIONS": [3, 4, 5]
+}
+
+def valid(config):
+    # The block size has to be a multiple of the block size used in the compute kernel
+    return int(config["BLOCK_SIZE"]) % int(config["GEMM_BLOCK"]) == 0
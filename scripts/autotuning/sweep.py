@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2022 Marius Meyer
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+# of the Software, and to permit persons to whom the Software is furnished to do
+# so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+##
+
+import argparse
+import itertools
+import os
+import subprocess
+import sys
+from concurrent.futures import ThreadPoolExecutor
+from os import path
+
+import pandas as pd
+
+SCRIPT_PATH = path.dirname(path.abspath(__file__))
+PROJECT_ROOT = path.join(SCRIPT_PATH, "..", "..")
+
+sys.path.append(path.join(SCRIPT_PATH, "..", "evaluation"))
+from parse_raw_to_csv import parse_map
+
+# Name of the host executable of every benchmark
+host_executables = {
+    "b_eff": "Network",
+    "FFT": "FFT",
+    "GEMM": "GEMM",
+    "LINPACK": "Linpack",
+    "PTRANS": "Transpose",
+    "RandomAccess": "RandomAccess",
+    "STREAM": "STREAM_FPGA"
+}
+
+# Values of the quartus report that are added to the results
+intel_report_keys = {
+    "Kernel fmax": "fmax",
+    "Logic utilization": "logic",
+    "DSP blocks": "dsp",
+    "RAM blocks": "ram",
+    "Memory bits": "memory_bits"
+}
+
+parser = argparse.ArgumentParser(description="Build and execute a benchmark for a grid of build parameters and collect the results in a single table.")
+parser.add_argument("-b", dest="benchmark", required=True, choices=host_executables.keys(), help="Name of the benchmark")
+parser.add_argument("-k", dest="kernel", required=True, help="Name of the kernel file without file extension, e.g. gemm_base")
+parser.add_argument("-p", dest="params", default=[], action="append",
+                    help="Build parameter and its values that are used in the grid, e.g. GLOBAL_MEM_UNROLL=8,16. Can be given multiple times.")
+parser.add_argument("--grid", dest="grid_file", default=None,
+                    help="Python file that defines the grid as dictionary 'grid' and optionally a function 'valid(config)' that removes invalid configurations.")
+parser.add_argument("--cmake", dest="cmake_args", default=[], action="append",
+                    help="Additional argument that is passed to CMake for every configuration, e.g. --cmake=-DHPCC_FPGA_CONFIG=config.cmake")
+parser.add_argument("--host-args", dest="host_args", default="", help="Additional arguments for the host application, e.g. --host-args=\"-n 5\"")
+parser.add_argument("--vendor", dest="vendor", default="intel", choices=["intel", "xilinx"], help="Vendor of the used FPGA")
+parser.add_argument("--synthesize", dest="synthesize", action="store_true", default=False,
+                    help="Synthesize the kernels. If not given, emulation kernels are used which only allows to compare the functionality.")
+parser.add_argument("--build-dir", dest="build_dir", default=path.join(PROJECT_ROOT, "build", "sweep"), help="Folder that will contain the builds of all configurations")
+parser.add_argument("-j", dest="jobs", type=int, default=1, help="Number of configurations that are built in parallel")
+parser.add_argument("--dry-run", dest="dry_run", action="store_true", default=False, help="Only print the configurations of the grid")
+parser.add_argument("-o", dest="output_file", default="-", help="Name of the output CSV file. If not given, stdout is used.")
+
+
+def create_grid(params, grid_file):
+    """
+    Create all configurations of the grid
+
+    @param params List of strings of the form NAME=VALUE1,VALUE2
+    @param grid_file Path to a Python file defining additional grid parameters or None
+
+    @returns list of dictionaries mapping the parameter names to the values of a configuration
+    """
+    grid = {}
+    valid = lambda config: True
+    if grid_file is not None:
+        definitions = {}
+        with open(grid_file) as f:
+            exec(f.read(), definitions)
+        grid.update({k: [str(v) for v in values] for k, values in definitions.get("grid", {}).items()})
+        valid = definitions.get("valid", valid)
+    for p in params:
+        name, values = p.split("=", 1)
+        grid[name] = values.split(",")
+    names = sorted(grid.keys())
+    configs = [dict(zip(names, values)) for values in itertools.product(*[grid[n] for n in names])]
+    return [c for c in configs if valid(c)]
+
+
+def config_name(kernel, config):
+    return "_".join([kernel] + ["%s-%s" % (k, v) for k, v in config.items()])
+
+
+def bitstream_name(kernel, vendor, synthesize):
+    return kernel + ("" if synthesize else "_emulate") + (".aocx" if vendor == "intel" else ".xclbin")
+
+
+def build_config(args, config):
+    """
+    Configure and build the host code and the kernel of a single configuration.
+    Finished builds are skipped, so an interrupted sweep can be continued.
+
+    @returns Path to the build folder of the configuration and an error message or None
+    """
+    build_path = path.join(args.build_dir, args.benchmark, config_name(args.kernel, config))
+    bitstream = path.join(build_path, "bin", bitstream_name(args.kernel, args.vendor, args.synthesize))
+    if path.exists(path.join(build_path, "BUILD_SUCCESS")):
+        return build_path, None
+    os.makedirs(build_path, exist_ok=True)
+    kernel_target = args.kernel + ("" if args.synthesize else "_emulate") + "_" + args.vendor
+    host_target = host_executables[args.benchmark] + "_" + args.vendor
+    commands = [["cmake", path.join(PROJECT_ROOT, args.benchmark)] + args.cmake_args + ["-D%s=%s" % (k, v) for k, v in config.items()],
+                ["make", host_target],
+                ["make", kernel_target]]
+    with open(path.join(build_path, "build.log"), "w") as log:
+        for c in commands:
+            if subprocess.call(c, cwd=build_path, stdout=log, stderr=subprocess.STDOUT) != 0:
+                return build_path, "Failed: %s" % " ".join(c)
+    if not path.exists(bitstream):
+        return build_path, "Missing bitstream: %s" % bitstream
+    open(path.join(build_path, "BUILD_SUCCESS"), "w").close()
+    return build_path, None
+
+
+def parse_intel_report(build_path, kernel):
+    """
+    Read the fmax and the resource usage from the quartus report of a synthesized kernel
+    """
+    result = {}
+    report = path.join(build_path, "bin", kernel + "_synth_reports", "acl_quartus_report.txt")
+    if not path.exists(report):
+        return result
+    with open(report) as f:
+        for line in f:
+            key, _, value = line.partition(":")
+            if key.strip() in intel_report_keys:
+                result[intel_report_keys[key.strip()]] = value.strip()
+    return result
+
+
+def execute_config(args, build_path):
+    """
+    Execute the benchmark with the bitstream of a configuration and parse the output
+
+    @returns Data frame with the parsed output or None and the exit code of the benchmark
+    """
+    env = dict(os.environ)
+    if not args.synthesize:
+        env["CL_CONTEXT_EMULATOR_DEVICE"] = "1"
+        env["XCL_EMULATION_MODE"] = "sw_emu"
+    command = ["./" + host_executables[args.benchmark] + "_" + args.vendor, "-f",
+               bitstream_name(args.kernel, args.vendor, args.synthesize)] + args.host_args.split()
+    run = subprocess.run(command, cwd=path.join(build_path, "bin"), env=env, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    with open(path.join(build_path, "run.log"), "w") as log:
+        log.write(run.stdout)
+    return parse_map[args.benchmark](run.stdout), run.returncode
+
+
+def sweep_script_called_directly():
+    args = parser.parse_args()
+    args.build_dir = path.abspath(args.build_dir)
+    configs = create_grid(args.params, args.grid_file)
+    if len(configs) == 0 or len(configs[0]) == 0:
+        print("The grid does not contain any configuration", file=sys.stderr)
+        exit(1)
+    if args.dry_run:
+        for c in configs:
+            print(config_name(args.kernel, c))
+        exit(0)
+
+    # The kernels are built in parallel, but the benchmark runs are executed one after the other
+    # so they do not interfere with each other
+    with ThreadPoolExecutor(max_workers=args.jobs) as executor:
+        builds = list(executor.map(lambda c: build_config(args, c), configs))
+
+    df = pd.DataFrame()
+    for config, (build_path, error) in zip(configs, builds):
+        row = dict(config)
+        if error is None:
+            result, returncode = execute_config(args, build_path)
+            if result is not None:
+                # b_eff reports a row for every message size, so the largest message size is used
+                row.update(result.iloc[-1].to_dict())
+            error = None if returncode == 0 else "Benchmark failed with exit code %d" % returncode
+            if args.vendor == "intel" and args.synthesize:
+                row.update(parse_intel_report(build_path, args.kernel))
+        row["status"] = "ok" if error is None else error
+        row["build_path"] = build_path
+        print("%s: %s" % (config_name(args.kernel, config), row["status"]), file=sys.stderr)
+        df = df.append(pd.DataFrame(row, index=[args.benchmark]))
+
+    if args.output_file == "-":
+        df.to_csv(sys.stdout, header=True)
+    else:
+        df.to_csv(args.output_file, header=True)
+
+
+if __name__ == "__main__":
+    sweep_script_called_directly()
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2022 Marius Meyer
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+# of the Software, and to permit persons to whom the Software is furnished to do
+# so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+##
+
+import argparse
+import json
+import os
+import shlex
+import statistics
+import subprocess
+import sys
+from os import path
+
+parser = argparse.ArgumentParser(description="Execute benchmarks alone and concurrently on the same node and report the slowdown of their timings caused by the interference.")
+parser.add_argument("-c", dest="commands", required=True, action="append",
+                    help="Command that executes a benchmark, e.g. -c \"./STREAM_FPGA_intel -f stream_kernels_single.aocx -d 0\". " \
+                         "Has to be given for every benchmark that should be co-scheduled. MPI launchers like mpirun can be part of the command.")
+parser.add_argument("--output-dir", dest="output_dir", default="co_schedule", help="Folder that will contain the JSON dumps and the logs of all executions")
+parser.add_argument("--skip-standalone", dest="skip_standalone", action="store_true", default=False,
+                    help="Reuse the standalone results of a previous execution from the output folder")
+parser.add_argument("-o", dest="output_file", default="-", help="Name of the output CSV file. If not given, stdout is used.")
+
+
+def benchmark_name(command):
+    """
+    Get the name of the benchmark executable from a command that may also contain an MPI launcher.
+    The host executables of all benchmarks end with the name of the vendor.
+    """
+    tokens = shlex.split(command)
+    for t in tokens:
+        if t.endswith("_intel") or t.endswith("_xilinx"):
+            return path.basename(t)
+    return path.basename(tokens[0])
+
+
+def start_benchmark(command, output_dir, name):
+    """
+    Start a benchmark in its own process. The results are written to a JSON dump in the output folder.
+
+    @returns the started process, the path to the JSON dump and the log file
+    """
+    dump_file = path.join(output_dir, name + ".json")
+    if path.exists(dump_file):
+        os.remove(dump_file)
+    log = open(path.join(output_dir, name + ".log"), "w")
+    process = subprocess.Popen(shlex.split(command) + ["--dump-json=" + path.abspath(dump_file)], stdout=log, stderr=subprocess.STDOUT)
+    return process, dump_file, log
+
+
+def wait_for_benchmarks(started):
+    """
+    Wait until all started benchmarks are finished and read their JSON dumps
+
+    @returns list of the parsed dumps or None for every failed benchmark
+    """
+    results = []
+    for process, dump_file, log in started:
+        returncode = process.wait()
+        log.close()
+        if returncode != 0 or not path.exists(dump_file):
+            print("%s failed with exit code %d. See %s for details." % (dump_file, returncode, log.name), file=sys.stderr)
+            results.append(None)
+            continue
+        with open(dump_file) as f:
+            results.append(json.load(f))
+    return results
+
+
+def median_timings(dump):
+    """
+    Calculate the median over all repetitions and ranks of every timing series of a benchmark
+    """
+    return {name: statistics.median([v for rank in ranks for v in rank]) for name, ranks in dump["timings"].items()
+            if any(len(rank) > 0 for rank in ranks)}
+
+
+def compare_runs(names, standalone, concurrent):
+    """
+    Compare the timings of the concurrent execution with the standalone execution of every benchmark
+
+    @returns list of rows with the benchmark, the timing series, both medians and the slowdown
+    """
+    rows = []
+    for name, alone, together in zip(names, standalone, concurrent):
+        if alone is None or together is None:
+            rows.append([name, "", "", "", "", "failed"])
+            continue
+        alone_medians = median_timings(alone)
+        together_medians = median_timings(together)
+        for timing in sorted(alone_medians.keys() & together_medians.keys()):
+            slowdown = together_medians[timing] / alone_medians[timing] if alone_medians[timing] > 0 else float("nan")
+            rows.append([name, timing, alone_medians[timing], together_medians[timing], slowdown,
+                         "ok" if together["validated"] else "validation failed"])
+    return rows
+
+
+def co_schedule_script_called_directly():
+    args = parser.parse_args()
+    if len(args.commands) < 2:
+        print("At least two benchmarks are required for the co-scheduling", file=sys.stderr)
+        exit(1)
+    os.makedirs(args.output_dir, exist_ok=True)
+    names = ["%d_%s" % (i, benchmark_name(c)) for i, c in enumerate(args.commands)]
+
+    # The standalone executions are done one after the other, so they do not interfere with each other
+    standalone = []
+    for name, command in zip(names, args.commands):
+        dump_file = path.join(args.output_dir, name + "_standalone.json")
+        if args.skip_standalone and path.exists(dump_file):
+            with open(dump_file) as f:
+                standalone.append(json.load(f))
+            continue
+        print("Execute %s standalone" % name, file=sys.stderr)
+        standalone += wait_for_benchmarks([start_benchmark(command, args.output_dir, name + "_standalone")])
+
+    print("Execute %s concurrently" % ", ".join(names), file=sys.stderr)
+    concurrent = wait_for_benchmarks([start_benchmark(command, args.output_dir, name + "_concurrent")
+                                      for name, command in zip(names, args.commands)])
+
+    rows = compare_runs(names, standalone, concurrent)
+    out = sys.stdout if args.output_file == "-" else open(args.output_file, "w")
+    out.write("benchmark,timing,standalone median [s],concurrent median [s],slowdown,status\n")
+    for row in rows:
+        out.write(",".join(str(v) for v in row) + "\n")
+    if out is not sys.stdout:
+        out.close()
+    exit(0 if all(r[-1] == "ok" for r in rows) else 1)
+
+
+if __name__ == "__main__":
+    co_schedule_script_called_directly()
@@ -0,0 +1,122 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHARED_AUTO_SIZE_HPP_
+#define SHARED_AUTO_SIZE_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace hpcc_base {
+
+/**
+ * @brief Limits of the device memory that are used to select the problem size automatically
+ *
+ */
+struct MemoryLimits {
+
+    /**
+     * @brief Number of bytes that can be used for all buffers on the devices of a single MPI rank
+     *
+     */
+    double totalMemory;
+
+    /**
+     * @brief Maximum size of a single buffer in bytes
+     *
+     */
+    double maxBufferSize;
+};
+
+/**
+ * @brief Calculate the memory limits of a rank from the properties of its devices
+ *
+ * @param globalMemory Global memory of a single device in bytes
+ * @param maxAllocation Maximum size of a single allocation on a device in bytes
+ * @param devices Number of devices used by the rank
+ * @param banks Number of memory banks of a device. 0, if unknown.
+ * @param bankBuffers True, if every buffer is placed in a single memory bank, i.e. memory interleaving is not used
+ * @param fraction Fraction of the global memory that should be used
+ * @return MemoryLimits The limits for the buffers of the benchmark
+ */
+inline MemoryLimits
+calculateMemoryLimits(uint64_t globalMemory, uint64_t maxAllocation, unsigned devices, unsigned banks, bool bankBuffers, double fraction) {
+    double total = fraction * static_cast<double>(globalMemory) * devices;
+    double max_buffer = static_cast<double>(maxAllocation);
+    if (banks > 0 && bankBuffers) {
+        max_buffer = std::min(max_buffer, fraction * static_cast<double>(globalMemory) / banks);
+    }
+    return {total, std::min(max_buffer, total)};
+}
+
+/**
+ * @brief Get the largest multiple of unit that is not larger than the given value
+ *
+ * @param maxValue The upper bound
+ * @param unit The unit the result has to be a multiple of. Has to be larger than 0.
+ * @return uint64_t The largest multiple. 0, if the value is smaller than unit.
+ */
+inline uint64_t
+largestMultiple(double maxValue, uint64_t unit) {
+    if (maxValue < static_cast<double>(unit)) {
+        return 0;
+    }
+    return static_cast<uint64_t>(std::floor(maxValue / static_cast<double>(unit))) * unit;
+}
+
+/**
+ * @brief Get the largest power of two that is not larger than the given value
+ *
+ * @param maxValue The upper bound
+ * @return uint64_t The largest power of two. 0, if the value is smaller than 1.
+ */
+inline uint64_t
+largestPowerOfTwo(double maxValue) {
+    if (maxValue < 1.0) {
+        return 0;
+    }
+    uint64_t value = 1;
+    while (static_cast<double>(value) * 2.0 <= maxValue && value < (static_cast<uint64_t>(1) << 63)) {
+        value *= 2;
+    }
+    return value;
+}
+
+/**
+ * @brief Calculate the least common multiple of two numbers
+ *
+ */
+inline uint64_t
+leastCommonMultiple(uint64_t a, uint64_t b) {
+    uint64_t x = a;
+    uint64_t y = b;
+    while (y != 0) {
+        uint64_t t = x % y;
+        x = y;
+        y = t;
+    }
+    return (x == 0) ? 0 : a / x * b;
+}
+
+}
+
+#endif
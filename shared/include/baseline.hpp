@@ -0,0 +1,422 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHARED_BASELINE_HPP_
+#define SHARED_BASELINE_HPP_
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "repetition_policy.hpp"
+
+namespace hpcc_base {
+
+/**
+ * @brief Results of a previous benchmark execution that was written with the dump-json option
+ *
+ */
+struct BaselineResults {
+
+    /**
+     * @brief Name of the device the baseline was measured on
+     *
+     */
+    std::string device;
+
+    /**
+     * @brief Number of MPI ranks used for the baseline
+     *
+     */
+    int mpiSize;
+
+    /**
+     * @brief The derived metrics of the baseline
+     *
+     */
+    std::map<std::string, double> results;
+
+    /**
+     * @brief The timings of all repetitions for every timing series. The timings of all ranks are concatenated.
+     *
+     */
+    std::map<std::string, std::vector<double>> timings;
+};
+
+/**
+ * @brief Reads the JSON files written with the dump-json option. Only the entries used for the baseline comparison are
+ *          extracted, all other entries are skipped.
+ *
+ */
+class BaselineParser {
+
+private:
+
+    std::string const& json;
+
+    size_t pos = 0;
+
+    void
+    skipWhitespace() {
+        while (pos < json.size() && std::isspace(static_cast<unsigned char>(json[pos]))) {
+            pos++;
+        }
+    }
+
+    void
+    expect(char c) {
+        skipWhitespace();
+        if (pos >= json.size() || json[pos] != c) {
+            throw std::runtime_error("Invalid baseline JSON: expected '" + std::string(1, c) + "' at position " + std::to_string(pos));
+        }
+        pos++;
+    }
+
+    bool
+    next(char c) {
+        skipWhitespace();
+        if (pos < json.size() && json[pos] == c) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    std::string
+    parseString() {
+        expect('"');
+        std::string str;
+        while (pos < json.size() && json[pos] != '"') {
+            if (json[pos] == '\\' && pos + 1 < json.size()) {
+                pos++;
+                switch (json[pos]) {
+                    case 'n': str += '\n'; break;
+                    case 't': str += '\t'; break;
+                    // Control characters are not used in the keys, so they are only skipped
+                    case 'u': pos += 4; break;
+                    default: str += json[pos];
+                }
+            }
+            else {
+                str += json[pos];
+            }
+            pos++;
+        }
+        expect('"');
+        return str;
+    }
+
+    /**
+     * @brief Parse a number. null is used for NaN values in the dump.
+     *
+     */
+    double
+    parseNumber() {
+        skipWhitespace();
+        if (json.compare(pos, 4, "null") == 0) {
+            pos += 4;
+            return NAN;
+        }
+        size_t length = 0;
+        double value;
+        try {
+            value = std::stod(json.substr(pos, 32), &length);
+        }
+        catch (std::exception const&) {
+            throw std::runtime_error("Invalid baseline JSON: expected number at position " + std::to_string(pos));
+        }
+        pos += length;
+        return value;
+    }
+
+    void
+    skipValue() {
+        skipWhitespace();
+        if (pos >= json.size()) {
+            throw std::runtime_error("Invalid baseline JSON: unexpected end of file");
+        }
+        if (json[pos] == '"') {
+            parseString();
+        }
+        else if (next('{')) {
+            if (!next('}')) {
+                do {
+                    parseString();
+                    expect(':');
+                    skipValue();
+                } while (next(','));
+                expect('}');
+            }
+        }
+        else if (next('[')) {
+            if (!next(']')) {
+                do {
+                    skipValue();
+                } while (next(','));
+                expect(']');
+            }
+        }
+        else if (json.compare(pos, 4, "true") == 0 || json.compare(pos, 4, "null") == 0) {
+            pos += 4;
+        }
+        else if (json.compare(pos, 5, "false") == 0) {
+            pos += 5;
+        }
+        else {
+            parseNumber();
+        }
+    }
+
+    /**
+     * @brief Parse an array of numbers and append them to values
+     *
+     */
+    void
+    parseNumbers(std::vector<double>& values) {
+        expect('[');
+        if (next(']')) {
+            return;
+        }
+        do {
+            if (next('[')) {
+                // Nested arrays contain the timings of a single rank
+                pos--;
+                parseNumbers(values);
+            }
+            else {
+                values.push_back(parseNumber());
+            }
+        } while (next(','));
+        expect(']');
+    }
+
+public:
+
+    explicit BaselineParser(std::string const& json) : json(json) {}
+
+    /**
+     * @brief Parse the JSON document
+     *
+     * @return BaselineResults The extracted results
+     */
+    BaselineResults
+    parse() {
+        BaselineResults baseline{"", 0, {}, {}};
+        expect('{');
+        if (next('}')) {
+            return baseline;
+        }
+        do {
+            std::string key = parseString();
+            expect(':');
+            if (key == "device") {
+                baseline.device = parseString();
+            }
+            else if (key == "mpi_size") {
+                baseline.mpiSize = static_cast<int>(parseNumber());
+            }
+            else if (key == "results" || key == "timings") {
+                expect('{');
+                if (!next('}')) {
+                    do {
+                        std::string name = parseString();
+                        expect(':');
+                        if (key == "results") {
+                            baseline.results[name] = parseNumber();
+                        }
+                        else {
+                            parseNumbers(baseline.timings[name]);
+                        }
+                    } while (next(','));
+                    expect('}');
+                }
+            }
+            else {
+                skipValue();
+            }
+        } while (next(','));
+        expect('}');
+        return baseline;
+    }
+};
+
+/**
+ * @brief Read the baseline from a file written with the dump-json option
+ *
+ * @param filePath Path to the JSON file
+ * @return BaselineResults The results of the baseline
+ */
+inline BaselineResults
+readBaseline(std::string const& filePath) {
+    std::ifstream in(filePath);
+    if (!in.is_open()) {
+        throw std::runtime_error("Could not open baseline file " + filePath);
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::string json = ss.str();
+    return BaselineParser(json).parse();
+}
+
+/**
+ * @brief Comparison of a timing series with the baseline
+ *
+ */
+struct BaselineComparison {
+
+    /**
+     * @brief Median of the baseline timings in s
+     *
+     */
+    double baselineMedian;
+
+    /**
+     * @brief Median of the current timings in s
+     *
+     */
+    double currentMedian;
+
+    /**
+     * @brief Relative change of the performance, i.e. the inverse of the median time. Negative, if the current execution is slower.
+     *
+     */
+    double change;
+
+    /**
+     * @brief One-sided p-value of the Mann-Whitney U test for the hypothesis, that the current timings are larger
+     *
+     */
+    double pValue;
+
+    /**
+     * @brief True, if the performance dropped by more than the threshold with statistical significance
+     *
+     */
+    bool regression;
+};
+
+/**
+ * @brief Calculate the one-sided p-value of the Mann-Whitney U test for the hypothesis, that the values of the
+ *          second sample are larger than the values of the first sample, so no assumptions on the distribution of the timings are made.
+ *          The exact distribution of U is used for small samples without ties, otherwise the normal approximation with tie correction.
+ *
+ * @param first The first sample
+ * @param second The second sample
+ * @return double The p-value. 1 if one of the samples is empty.
+ */
+inline double
+mannWhitneyPValue(std::vector<double> const& first, std::vector<double> const& second) {
+    if (first.empty() || second.empty()) {
+        return 1.0;
+    }
+    std::vector<std::pair<double, bool>> values;
+    for (double v : first) {
+        values.push_back({v, false});
+    }
+    for (double v : second) {
+        values.push_back({v, true});
+    }
+    std::sort(values.begin(), values.end(), [](std::pair<double, bool> const& a, std::pair<double, bool> const& b) {return a.first < b.first;});
+    size_t n1 = first.size();
+    size_t n2 = second.size();
+    double n = static_cast<double>(n1 + n2);
+    double rank_sum = 0.0;
+    double tie_correction = 0.0;
+    for (size_t i = 0; i < values.size();) {
+        size_t j = i;
+        while (j < values.size() && values[j].first == values[i].first) {
+            j++;
+        }
+        // Tied values get the average of their 1-based ranks
+        double rank = 0.5 * static_cast<double>(i + 1 + j);
+        double ties = static_cast<double>(j - i);
+        tie_correction += ties * ties * ties - ties;
+        for (size_t k = i; k < j; k++) {
+            if (values[k].second) {
+                rank_sum += rank;
+            }
+        }
+        i = j;
+    }
+    // Number of pairs where the value of the second sample is larger
+    double u = rank_sum - static_cast<double>(n2 * (n2 + 1)) / 2.0;
+    if (tie_correction == 0.0 && n1 + n2 <= 40) {
+        // counts[a][b][k]: Number of orderings of a values of the first and b values of the second sample with U = k.
+        // The largest value either belongs to the second sample and is larger than all a values, or to the first sample.
+        std::vector<std::vector<std::vector<double>>> counts(n1 + 1, std::vector<std::vector<double>>(n2 + 1));
+        for (size_t a = 0; a <= n1; a++) {
+            for (size_t b = 0; b <= n2; b++) {
+                counts[a][b].assign(a * b + 1, 0.0);
+                if (a == 0 || b == 0) {
+                    counts[a][b][0] = 1.0;
+                    continue;
+                }
+                for (size_t k = 0; k <= a * b; k++) {
+                    counts[a][b][k] = (k >= a ? counts[a][b - 1][k - a] : 0.0) + (k <= (a - 1) * b ? counts[a - 1][b][k] : 0.0);
+                }
+            }
+        }
+        double total = 0.0;
+        double larger = 0.0;
+        for (size_t k = 0; k <= n1 * n2; k++) {
+            total += counts[n1][n2][k];
+            if (static_cast<double>(k) >= u) {
+                larger += counts[n1][n2][k];
+            }
+        }
+        return larger / total;
+    }
+    double variance = static_cast<double>(n1 * n2) / 12.0 * ((n + 1) - tie_correction / (n * (n - 1)));
+    if (variance <= 0.0) {
+        return 1.0;
+    }
+    // Continuity correction of the normal approximation
+    double z = (u - static_cast<double>(n1 * n2) / 2.0 - 0.5) / std::sqrt(variance);
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+/**
+ * @brief Compare the timings of the current execution with the baseline
+ *
+ * @param baseline Timings of the baseline
+ * @param current Timings of the current execution
+ * @param threshold Maximum allowed relative drop of the performance, e.g. 0.05 for 5%
+ * @param significance Maximum p-value for a significant regression
+ * @return BaselineComparison The comparison
+ */
+inline BaselineComparison
+compareTimings(std::vector<double> const& baseline, std::vector<double> const& current, double threshold, double significance) {
+    double baseline_median = calculateStatistics(baseline).median;
+    double current_median = calculateStatistics(current).median;
+    double change = baseline_median / current_median - 1.0;
+    double p_value = mannWhitneyPValue(baseline, current);
+    return {baseline_median, current_median, change, p_value, change < -threshold && p_value < significance};
+}
+
+}
+
+#endif
@@ -0,0 +1,408 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHARED_COMMAND_SEQUENCE_HPP_
+#define SHARED_COMMAND_SEQUENCE_HPP_
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/* External library headers */
+#ifdef USE_DEPRECATED_HPP_HEADER
+#include "CL/cl.hpp"
+#else
+#include OPENCL_HPP_HEADER
+#endif
+
+#include "setup/fpga_setup.hpp"
+#include "event_profiler.hpp"
+#include "multi_device.hpp"
+
+// The function signatures of cl_khr_command_buffer changed with the provisional versions of the extension.
+// Only headers that define the extension version use the signatures expected here.
+#if defined(cl_khr_command_buffer) && defined(CL_KHR_COMMAND_BUFFER_EXTENSION_VERSION)
+#define HPCC_COMMAND_BUFFER_SUPPORT
+#endif
+
+namespace hpcc_base {
+
+/**
+ * @brief A sequence of buffer transfers and kernel executions on multiple command queues that is recorded once
+ *          and replayed in every repetition of a benchmark.
+ *          All kernels are executed as single work-item kernels.
+ *          If all commands of a queue are kernel executions and the device supports cl_khr_command_buffer,
+ *          the commands are recorded into a command buffer, so a replay needs only a single enqueue call per queue.
+ *          Otherwise, the commands are enqueued with the OpenCL C API using prepared arguments, which
+ *          avoids the creation of temporary objects in the repetition loop.
+ *
+ * Usage in the execution types:
+ *
+ *     hpcc_base::CommandSequence sequence(command_queues, *config.profiler);
+ *     for (int i = 0; i < replications; i++) {
+ *         sequence.addKernel(i, kernels[i], "kernel");
+ *     }
+ *     sequence.finalize();
+ *     for (...) {
+ *         sequence.replay();
+ *         auto deviceTimes = sequence.finish(config.devices.size(), start);
+ *     }
+ *
+ */
+class CommandSequence {
+
+private:
+
+    enum class CommandType {
+        write,
+        kernel,
+        read
+    };
+
+    struct Command {
+        CommandType type;
+        size_t queue;
+        std::string name;
+        cl::Kernel kernel;
+        cl::Buffer buffer;
+        size_t bytes;
+        void* hostPtr;
+    };
+
+    std::vector<cl::CommandQueue>& queues;
+
+    EventProfiler& profiler;
+
+    std::vector<Command> commands;
+
+    /**
+     * @brief Recorded command buffer for every queue. nullptr, if the commands of the queue are enqueued separately.
+     *
+     */
+    std::vector<void*> commandBuffers;
+
+    /**
+     * @brief Index of the last command of every queue
+     *
+     */
+    std::vector<size_t> lastCommands;
+
+    /**
+     * @brief Events of the last command of every queue of the latest replay
+     *
+     */
+    std::vector<cl::Event> completionEvents;
+
+    bool finalized = false;
+
+#ifdef HPCC_COMMAND_BUFFER_SUPPORT
+    clCreateCommandBufferKHR_fn createCommandBuffer = nullptr;
+    clCommandNDRangeKernelKHR_fn commandNDRangeKernel = nullptr;
+    clFinalizeCommandBufferKHR_fn finalizeCommandBuffer = nullptr;
+    clEnqueueCommandBufferKHR_fn enqueueCommandBuffer = nullptr;
+    clReleaseCommandBufferKHR_fn releaseCommandBuffer = nullptr;
+
+    /**
+     * @brief Load the extension functions if the device of the given queue supports command buffers
+     *
+     * @param queue A command queue of the sequence
+     * @return true if command buffers can be used
+     */
+    bool
+    loadCommandBufferFunctions(cl::CommandQueue const& queue) {
+        cl::Device device = queue.getInfo<CL_QUEUE_DEVICE>();
+        if (device.getInfo<CL_DEVICE_EXTENSIONS>().find("cl_khr_command_buffer") == std::string::npos) {
+            return false;
+        }
+        cl_platform_id platform = device.getInfo<CL_DEVICE_PLATFORM>();
+        createCommandBuffer = reinterpret_cast<clCreateCommandBufferKHR_fn>(clGetExtensionFunctionAddressForPlatform(platform, "clCreateCommandBufferKHR"));
+        commandNDRangeKernel = reinterpret_cast<clCommandNDRangeKernelKHR_fn>(clGetExtensionFunctionAddressForPlatform(platform, "clCommandNDRangeKernelKHR"));
+        finalizeCommandBuffer = reinterpret_cast<clFinalizeCommandBufferKHR_fn>(clGetExtensionFunctionAddressForPlatform(platform, "clFinalizeCommandBufferKHR"));
+        enqueueCommandBuffer = reinterpret_cast<clEnqueueCommandBufferKHR_fn>(clGetExtensionFunctionAddressForPlatform(platform, "clEnqueueCommandBufferKHR"));
+        releaseCommandBuffer = reinterpret_cast<clReleaseCommandBufferKHR_fn>(clGetExtensionFunctionAddressForPlatform(platform, "clReleaseCommandBufferKHR"));
+        return createCommandBuffer && commandNDRangeKernel && finalizeCommandBuffer && enqueueCommandBuffer && releaseCommandBuffer;
+    }
+
+    /**
+     * @brief Record all kernels of a queue into a new command buffer
+     *
+     * @param q Index of the queue
+     * @return void* The command buffer or nullptr if the recording failed
+     */
+    void*
+    recordCommandBuffer(size_t q) {
+        cl_int err;
+        cl_command_queue queue = queues[q]();
+        cl_command_buffer_khr command_buffer = createCommandBuffer(1, &queue, nullptr, &err);
+        if (err != CL_SUCCESS) {
+            return nullptr;
+        }
+        size_t work_size = 1;
+        for (auto const& c : commands) {
+            if (c.queue == q) {
+                err = commandNDRangeKernel(command_buffer, nullptr, nullptr, c.kernel(), 1, nullptr, &work_size, &work_size,
+                                            0, nullptr, nullptr, nullptr);
+                if (err != CL_SUCCESS) {
+                    releaseCommandBuffer(command_buffer);
+                    return nullptr;
+                }
+            }
+        }
+        if (finalizeCommandBuffer(command_buffer) != CL_SUCCESS) {
+            releaseCommandBuffer(command_buffer);
+            return nullptr;
+        }
+        return command_buffer;
+    }
+#endif
+
+    /**
+     * @brief Enqueue a single command
+     *
+     * @param c The command
+     * @param numWaitEvents Number of events in the wait list
+     * @param waitEvents The wait list
+     * @param completionEvent If not nullptr, the event of the command is stored in it
+     */
+    void
+    enqueueCommand(Command const& c, cl_uint numWaitEvents, cl_event const* waitEvents, cl::Event* completionEvent) {
+        cl_event event = nullptr;
+        cl::Event* profiled_event = profiler.event(c.name);
+        cl_event* event_ptr = (profiled_event || completionEvent) ? &event : nullptr;
+        size_t work_size = 1;
+        cl_int err = CL_SUCCESS;
+        switch (c.type) {
+            case CommandType::write: err = clEnqueueWriteBuffer(queues[c.queue](), c.buffer(), CL_FALSE, 0, c.bytes, c.hostPtr,
+                                                                numWaitEvents, waitEvents, event_ptr); break;
+            case CommandType::kernel: err = clEnqueueNDRangeKernel(queues[c.queue](), c.kernel(), 1, nullptr, &work_size, &work_size,
+                                                                numWaitEvents, waitEvents, event_ptr); break;
+            case CommandType::read: err = clEnqueueReadBuffer(queues[c.queue](), c.buffer(), CL_FALSE, 0, c.bytes, c.hostPtr,
+                                                                numWaitEvents, waitEvents, event_ptr); break;
+        }
+        ASSERT_CL(err)
+        if (event_ptr) {
+            cl::Event wrapped_event(event);
+            if (profiled_event) {
+                *profiled_event = wrapped_event;
+            }
+            if (completionEvent) {
+                *completionEvent = wrapped_event;
+            }
+        }
+    }
+
+public:
+
+    /**
+     * @brief Construct a new empty command sequence
+     *
+     * @param queues_ The command queues used by the sequence. They have to be in-order queues and must outlive the sequence.
+     * @param profiler_ The profiler that records the events of the commands
+     */
+    CommandSequence(std::vector<cl::CommandQueue>& queues_, EventProfiler& profiler_) : queues(queues_), profiler(profiler_) {}
+
+    // The recorded command buffers are released in the destructor, so the sequence must not be copied
+    CommandSequence(CommandSequence const&) = delete;
+    CommandSequence& operator=(CommandSequence const&) = delete;
+
+    /**
+     * @brief Add a non-blocking transfer from the host to a buffer
+     *
+     * @param queue Index of the used queue
+     * @param buffer The destination buffer
+     * @param bytes Number of transferred bytes
+     * @param hostPtr The source. Has to be valid for every replay.
+     * @param name Name of the command shown in the timeline
+     */
+    void
+    addWriteBuffer(size_t queue, cl::Buffer const& buffer, size_t bytes, void const* hostPtr, std::string const& name) {
+        commands.push_back({CommandType::write, queue, name, cl::Kernel(), buffer, bytes, const_cast<void*>(hostPtr)});
+    }
+
+    /**
+     * @brief Add the execution of a single work-item kernel. The kernel arguments are not allowed to change between replays.
+     *
+     * @param queue Index of the used queue
+     * @param kernel The kernel
+     * @param name Name of the command shown in the timeline
+     */
+    void
+    addKernel(size_t queue, cl::Kernel const& kernel, std::string const& name) {
+        commands.push_back({CommandType::kernel, queue, name, kernel, cl::Buffer(), 0, nullptr});
+    }
+
+    /**
+     * @brief Add a non-blocking transfer from a buffer to the host
+     *
+     * @param queue Index of the used queue
+     * @param buffer The source buffer
+     * @param bytes Number of transferred bytes
+     * @param hostPtr The destination. Has to be valid for every replay.
+     * @param name Name of the command shown in the timeline
+     */
+    void
+    addReadBuffer(size_t queue, cl::Buffer const& buffer, size_t bytes, void* hostPtr, std::string const& name) {
+        commands.push_back({CommandType::read, queue, name, cl::Kernel(), buffer, bytes, hostPtr});
+    }
+
+    /**
+     * @brief Finish the recording. Creates the command buffers if possible.
+     *          Command buffers are not used if profiling is enabled, so the events of the single commands show up in the timeline.
+     *
+     */
+    void
+    finalize() {
+        commandBuffers.assign(queues.size(), nullptr);
+        completionEvents.assign(queues.size(), cl::Event());
+        lastCommands.assign(queues.size(), commands.size());
+        for (size_t i = 0; i < commands.size(); i++) {
+            lastCommands[commands[i].queue] = i;
+        }
+#ifdef HPCC_COMMAND_BUFFER_SUPPORT
+        if (!profiler.isEnabled() && !queues.empty() && loadCommandBufferFunctions(queues.front())) {
+            for (size_t q = 0; q < queues.size(); q++) {
+                bool only_kernels = false;
+                for (auto const& c : commands) {
+                    if (c.queue == q) {
+                        only_kernels = c.type == CommandType::kernel;
+                        if (!only_kernels) {
+                            break;
+                        }
+                    }
+                }
+                if (only_kernels) {
+                    commandBuffers[q] = recordCommandBuffer(q);
+                }
+            }
+        }
+#endif
+        finalized = true;
+    }
+
+    /**
+     * @brief Check if a queue uses a recorded command buffer
+     *
+     * @param queue Index of the queue
+     * @return true if the commands of the queue are replayed with a command buffer
+     */
+    bool
+    usesCommandBuffer(size_t queue) const {
+        return finalized && commandBuffers[queue] != nullptr;
+    }
+
+    /**
+     * @brief Get the number of recorded commands
+     *
+     * @return size_t number of commands
+     */
+    size_t
+    size() const {
+        return commands.size();
+    }
+
+    /**
+     * @brief Enqueue all commands of the sequence without blocking
+     *
+     * @param startEvent Optional event, e.g. a user event, that has to complete before the first command of every queue is started
+     */
+    void
+    replay(cl::Event const* startEvent = nullptr) {
+        if (!finalized) {
+            finalize();
+        }
+        cl_event start_event = startEvent ? (*startEvent)() : nullptr;
+        cl_uint num_wait_events = startEvent ? 1 : 0;
+        // Only the first command of a queue has to wait for the start event, because in-order queues are used
+        std::vector<bool> started(queues.size(), false);
+#ifdef HPCC_COMMAND_BUFFER_SUPPORT
+        for (size_t q = 0; q < queues.size(); q++) {
+            if (commandBuffers[q] != nullptr) {
+                cl_command_queue queue = queues[q]();
+                cl_event event;
+                ASSERT_CL(enqueueCommandBuffer(1, &queue, reinterpret_cast<cl_command_buffer_khr>(commandBuffers[q]),
+                                                num_wait_events, num_wait_events ? &start_event : nullptr, &event))
+                completionEvents[q] = cl::Event(event);
+                started[q] = true;
+            }
+        }
+#endif
+        for (size_t i = 0; i < commands.size(); i++) {
+            auto const& c = commands[i];
+            if (commandBuffers[c.queue] != nullptr) {
+                continue;
+            }
+            bool wait = !started[c.queue] && num_wait_events > 0;
+            enqueueCommand(c, wait ? 1 : 0, wait ? &start_event : nullptr,
+                            (lastCommands[c.queue] == i) ? &completionEvents[c.queue] : nullptr);
+            started[c.queue] = true;
+        }
+        for (auto& q : queues) {
+            q.flush();
+        }
+    }
+
+    /**
+     * @brief Get the event of the last command of a queue from the latest replay.
+     *          If the queue is created with profiling enabled, it can be used to measure the execution time of the command
+     *          or the recorded command buffer.
+     *
+     * @param queue Index of the queue
+     * @return cl::Event const& The event. Empty, if the queue has no commands.
+     */
+    cl::Event const&
+    getCompletionEvent(size_t queue) const {
+        return completionEvents[queue];
+    }
+
+    /**
+     * @brief Wait until all commands of the latest replay are completed.
+     *          Commands that were enqueued to the queues after the replay are not waited for.
+     *
+     * @param numDevices Number of devices the queues are distributed over. Queue r belongs to device r % numDevices.
+     * @param start Time the execution was started
+     * @return std::vector<double> The time in seconds from start until every device finished
+     */
+    std::vector<double>
+    finish(size_t numDevices, std::chrono::time_point<std::chrono::high_resolution_clock> start) {
+        return multi_device::waitForDevices(numDevices, start, [this, numDevices](size_t d) {
+            for (size_t q = d; q < completionEvents.size(); q += numDevices) {
+                // Queues without commands have no completion event
+                if (completionEvents[q]() != nullptr) {
+                    completionEvents[q].wait();
+                }
+            }
+        });
+    }
+
+    ~CommandSequence() {
+#ifdef HPCC_COMMAND_BUFFER_SUPPORT
+        for (auto command_buffer : commandBuffers) {
+            if (command_buffer != nullptr) {
+                releaseCommandBuffer(reinterpret_cast<cl_command_buffer_khr>(command_buffer));
+            }
+        }
+#endif
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,379 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHARED_COMMUNICATION_PROGRESS_HPP_
+#define SHARED_COMMUNICATION_PROGRESS_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* External library headers */
+#ifdef USE_DEPRECATED_HPP_HEADER
+#include "CL/cl.hpp"
+#else
+#include OPENCL_HPP_HEADER
+#endif
+#ifdef _USE_MPI_
+#include "mpi.h"
+#endif
+
+#include "setup/fpga_setup.hpp"
+
+namespace hpcc_base {
+
+/**
+ * @brief Drives non-blocking MPI requests and device transfers in a dedicated thread, so the network and PCIe transfers
+ *          of the PCIE communication types overlap while the main thread is blocked in MPI or OpenCL calls.
+ *          Requests and events are added as tasks with an optional callback that is executed by the progress thread
+ *          as soon as all requests and events of the task are completed.
+ *          The completion of events is signaled with clSetEventCallback. If no MPI request is pending, the thread waits
+ *          for the oldest incomplete event, which also forces the OpenCL runtime to submit dependent commands to the device.
+ *          MPI requests are only tested by the progress thread if the host code is built with USE_MPI_PROGRESS_THREAD
+ *          and MPI provides MPI_THREAD_MULTIPLE (see initializeMPI). Otherwise, they are completed by the thread that waits for the task.
+ *
+ * Usage in the execution types:
+ *
+ *     hpcc_base::CommunicationProgress progress;
+ *     auto handle = progress.addRequests({recv_request, send_request}, [&]() {
+ *         queue.enqueueWriteBuffer(buffer, CL_FALSE, 0, size, received_data, nullptr, &write_event);
+ *         queue.flush();
+ *     });
+ *     queue.enqueueReadBuffer(...);  // MPI progresses while the read blocks
+ *     handle.wait();
+ */
+class CommunicationProgress {
+
+private:
+
+    /**
+     * @brief The requests and events of a task. All members except the requests are guarded by the mutex of the progress object.
+     *
+     */
+    struct Task {
+#ifdef _USE_MPI_
+        std::vector<MPI_Request> requests;
+#endif
+        std::function<void()> callback;
+        CommunicationProgress* progress = nullptr;
+        std::vector<cl::Event> events;
+        size_t pendingEvents = 0;
+        bool requestsCompleted = true;
+        bool finished = false;
+    };
+
+    std::mutex progressMutex;
+
+    /**
+     * @brief Wakes up the progress thread if new tasks are added or events are completed
+     *
+     */
+    std::condition_variable progressCondition;
+
+    /**
+     * @brief Wakes up threads that wait for a task
+     *
+     */
+    std::condition_variable finishedCondition;
+
+    std::list<std::shared_ptr<Task>> tasks;
+
+    bool running = true;
+
+    /**
+     * @brief True, if MPI requests can be tested by the progress thread
+     *
+     */
+    bool threadedMPI = false;
+
+    std::thread progressThread;
+
+    static void CL_CALLBACK
+    eventCompleted(cl_event event, cl_int status, void* user_data) {
+        Task* task = static_cast<Task*>(user_data);
+        // The task may be removed as soon as the mutex is released, so only the progress object is used afterwards
+        CommunicationProgress* progress = task->progress;
+        {
+            std::lock_guard<std::mutex> lock(progress->progressMutex);
+            task->pendingEvents--;
+        }
+        progress->progressCondition.notify_all();
+    }
+
+    void
+    progressLoop() {
+        std::unique_lock<std::mutex> lock(progressMutex);
+        while (running || !tasks.empty()) {
+            bool mpiPending = false;
+            cl::Event oldestEvent;
+            for (auto it = tasks.begin(); it != tasks.end();) {
+                auto task = *it;
+#ifdef _USE_MPI_
+                if (!task->requestsCompleted && threadedMPI) {
+                    int flag;
+                    MPI_Testall(task->requests.size(), task->requests.data(), &flag, MPI_STATUSES_IGNORE);
+                    task->requestsCompleted = flag;
+                }
+#endif
+                if (task->requestsCompleted && task->pendingEvents == 0) {
+                    // Only this thread removes tasks, so the iterator stays valid while the callback is executed
+                    it = tasks.erase(it);
+                    lock.unlock();
+                    if (task->callback) {
+                        task->callback();
+                    }
+                    lock.lock();
+                    task->finished = true;
+                    finishedCondition.notify_all();
+                    continue;
+                }
+                mpiPending |= !task->requestsCompleted && threadedMPI;
+                if (task->pendingEvents > 0 && oldestEvent() == nullptr) {
+                    for (auto& e : task->events) {
+                        if (e.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() != CL_COMPLETE) {
+                            oldestEvent = e;
+                            break;
+                        }
+                    }
+                }
+                it++;
+            }
+            if (mpiPending) {
+                // Test the requests again after a short time or as soon as new tasks or completed events are signaled
+                progressCondition.wait_for(lock, std::chrono::microseconds(50));
+            }
+            else if (oldestEvent() != nullptr) {
+                lock.unlock();
+                oldestEvent.wait();
+                lock.lock();
+            }
+            else if (running || !tasks.empty()) {
+                progressCondition.wait(lock);
+            }
+        }
+    }
+
+    void
+    waitForTask(std::shared_ptr<Task> const& task) {
+        std::unique_lock<std::mutex> lock(progressMutex);
+#ifdef _USE_MPI_
+        if (!threadedMPI && !task->requestsCompleted) {
+            lock.unlock();
+            MPI_Waitall(task->requests.size(), task->requests.data(), MPI_STATUSES_IGNORE);
+            lock.lock();
+            task->requestsCompleted = true;
+            progressCondition.notify_all();
+        }
+#endif
+        finishedCondition.wait(lock, [&task]() { return task->finished; });
+    }
+
+public:
+
+    /**
+     * @brief Handle of a task that was added to the progress thread
+     *
+     */
+    class Handle {
+
+    private:
+
+        std::shared_ptr<Task> task;
+
+        CommunicationProgress* progress = nullptr;
+
+    public:
+
+        Handle() = default;
+
+        Handle(std::shared_ptr<Task> task_, CommunicationProgress* progress_) : task(std::move(task_)), progress(progress_) {}
+
+        /**
+         * @brief Wait until all requests and events of the task are completed and the callback was executed
+         *
+         */
+        void
+        wait() {
+            if (task) {
+                progress->waitForTask(task);
+            }
+        }
+    };
+
+    /**
+     * @brief Construct a new Communication Progress object and start the progress thread
+     *
+     */
+    CommunicationProgress() {
+#ifdef _USE_MPI_PROGRESS_THREAD_
+        int initialized;
+        MPI_Initialized(&initialized);
+        if (initialized) {
+            int provided;
+            MPI_Query_thread(&provided);
+            threadedMPI = (provided == MPI_THREAD_MULTIPLE);
+        }
+#endif
+        progressThread = std::thread([this]() { progressLoop(); });
+    }
+
+    CommunicationProgress(CommunicationProgress const&) = delete;
+    CommunicationProgress& operator=(CommunicationProgress const&) = delete;
+
+    /**
+     * @brief Wait for all tasks and stop the progress thread
+     *
+     */
+    ~CommunicationProgress() {
+        waitAll();
+        {
+            std::lock_guard<std::mutex> lock(progressMutex);
+            running = false;
+        }
+        progressCondition.notify_all();
+        progressThread.join();
+    }
+
+#ifdef _USE_MPI_
+    /**
+     * @brief Add a task that waits for MPI requests and device events
+     *
+     * @param requests The MPI requests. They are completed by the progress object and must not be waited for by the caller.
+     * @param events The device events
+     * @param callback Function that is executed by the progress thread after all requests and events are completed
+     * @return Handle The handle that can be used to wait for the task
+     */
+    Handle
+    add(std::vector<MPI_Request> const& requests, std::vector<cl::Event> const& events, std::function<void()> callback = nullptr) {
+        auto task = std::make_shared<Task>();
+        task->requests = requests;
+        task->requestsCompleted = requests.empty();
+        return addTask(task, events, std::move(callback));
+    }
+
+    /**
+     * @brief Add a task that waits for MPI requests
+     *
+     * @param requests The MPI requests. They are completed by the progress object and must not be waited for by the caller.
+     * @param callback Function that is executed by the progress thread after all requests are completed
+     * @return Handle The handle that can be used to wait for the task
+     */
+    Handle
+    addRequests(std::vector<MPI_Request> const& requests, std::function<void()> callback = nullptr) {
+        return add(requests, {}, std::move(callback));
+    }
+#endif
+
+    /**
+     * @brief Add a task that waits for device events
+     *
+     * @param events The device events. The commands have to be flushed to the device by the caller.
+     * @param callback Function that is executed by the progress thread after all events are completed
+     * @return Handle The handle that can be used to wait for the task
+     */
+    Handle
+    addEvents(std::vector<cl::Event> const& events, std::function<void()> callback = nullptr) {
+        return addTask(std::make_shared<Task>(), events, std::move(callback));
+    }
+
+    /**
+     * @brief Wait until all tasks are completed
+     *
+     */
+    void
+    waitAll() {
+        std::list<std::shared_ptr<Task>> pending;
+        {
+            std::lock_guard<std::mutex> lock(progressMutex);
+            pending = tasks;
+        }
+        for (auto const& task : pending) {
+            waitForTask(task);
+        }
+    }
+
+private:
+
+    Handle
+    addTask(std::shared_ptr<Task> task, std::vector<cl::Event> const& events, std::function<void()> callback) {
+        task->callback = std::move(callback);
+        task->progress = this;
+        task->events = events;
+        task->pendingEvents = events.size();
+        {
+            std::lock_guard<std::mutex> lock(progressMutex);
+            tasks.push_back(task);
+        }
+        for (auto& e : task->events) {
+            int err = clSetEventCallback(e(), CL_COMPLETE, &eventCompleted, task.get());
+            ASSERT_CL(err)
+        }
+        progressCondition.notify_all();
+        return Handle(task, this);
+    }
+};
+
+#ifdef _USE_MPI_
+/**
+ * @brief Initialize MPI with the thread support that is required by the communication progress thread.
+ *          MPI_THREAD_MULTIPLE is only requested if the host code is built with USE_MPI_PROGRESS_THREAD.
+ *          Otherwise, only the main thread calls MPI functions.
+ *          If MPI does not provide MPI_THREAD_MULTIPLE, a warning is printed and the MPI requests are completed by the waiting threads.
+ *
+ * @param argc Pointer to the number of program arguments
+ * @param argv Pointer to the program arguments
+ * @return int The thread support level provided by MPI
+ */
+inline int
+initializeMPI(int* argc, char** argv[]) {
+#ifdef _USE_MPI_PROGRESS_THREAD_
+    int required = MPI_THREAD_MULTIPLE;
+#else
+    int required = MPI_THREAD_FUNNELED;
+#endif
+    int provided;
+    MPI_Init_thread(argc, argv, required, &provided);
+    if (provided < required) {
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        if (rank == 0) {
+            std::cerr << "WARNING: MPI does not provide the requested thread support. ";
+            if (required == MPI_THREAD_MULTIPLE) {
+                std::cerr << "MPI requests are not completed by the communication progress thread, so communication and transfers overlap less." << std::endl;
+            }
+            else {
+                std::cerr << "MPI functions are only called by the main thread, which should be supported by most MPI implementations." << std::endl;
+            }
+        }
+    }
+    return provided;
+}
+#endif
+
+} // namespace hpcc_base
+
+#endif // SHARED_COMMUNICATION_PROGRESS_HPP_
@@ -22,7 +22,9 @@ SOFTWARE.
 #ifndef HPCC_BASE_COMMUNICATION_TYPES_H_
 #define HPCC_BASE_COMMUNICATION_TYPES_H_
 
+#ifndef DEFAULT_COMM_TYPE
 #define DEFAULT_COMM_TYPE "AUTO"
+#endif
 
 #include <map>
 
@@ -0,0 +1,98 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHARED_COUNTER_RANDOM_HPP_
+#define SHARED_COUNTER_RANDOM_HPP_
+
+#include <array>
+#include <cstdint>
+
+namespace hpcc_base {
+
+/**
+ * @brief Counter-based random number generation.
+ *          The random numbers are calculated from the index of a value instead of the state of a sequential generator,
+ *          so the input data can be generated in parallel and independent of the number of threads and ranks.
+ *
+ */
+namespace rng {
+
+/**
+ * @brief Calculate the Philox4x32-10 random numbers for a counter and a key
+ *
+ * @param counter The 128 bit counter
+ * @param key The 64 bit key
+ * @return std::array<uint32_t, 4> Four independent 32 bit random numbers
+ */
+inline std::array<uint32_t, 4>
+philox4x32(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key) {
+    for (int round = 0; round < 10; round++) {
+        uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * counter[0];
+        uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * counter[2];
+        counter = {static_cast<uint32_t>(p1 >> 32) ^ counter[1] ^ key[0], static_cast<uint32_t>(p1),
+                    static_cast<uint32_t>(p0 >> 32) ^ counter[3] ^ key[1], static_cast<uint32_t>(p0)};
+        key[0] += 0x9E3779B9u;
+        key[1] += 0xBB67AE85u;
+    }
+    return counter;
+}
+
+/**
+ * @brief Calculate four random numbers for a value index
+ *
+ * @param index Index of the value, e.g. the position in a matrix
+ * @param seed Seed used as key of the generator
+ * @return std::array<uint32_t, 4> Four independent 32 bit random numbers
+ */
+inline std::array<uint32_t, 4>
+randomBits(uint64_t index, uint64_t seed) {
+    return philox4x32({static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32), 0, 0},
+                        {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)});
+}
+
+/**
+ * @brief Convert random bits to a uniformly distributed value in [-1, 1)
+ *
+ * @param bits 32 random bits
+ * @return double The random value
+ */
+inline double
+toUniformSigned(uint32_t bits) {
+    return static_cast<double>(bits) * (1.0 / 2147483648.0) - 1.0;
+}
+
+/**
+ * @brief Convert random bits to a uniformly distributed value in (0, 1).
+ *          Only the upper 23 bits are used, so the value stays exactly representable and in the open interval also in single precision.
+ *
+ * @param bits 32 random bits
+ * @return double The random value
+ */
+inline double
+toUniformUnsigned(uint32_t bits) {
+    return (static_cast<double>(bits >> 9) + 0.5) * (1.0 / 8388608.0);
+}
+
+} // namespace rng
+
+} // namespace hpcc_base
+
+#endif
@@ -0,0 +1,243 @@
+/*
+Copyright (c) 2021 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHARED_EVENT_PROFILER_HPP_
+#define SHARED_EVENT_PROFILER_HPP_
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+/* External library headers */
+#ifdef USE_DEPRECATED_HPP_HEADER
+#include "CL/cl.hpp"
+#else
+#include OPENCL_HPP_HEADER
+#endif
+
+namespace hpcc_base {
+
+/**
+ * @brief Collects the OpenCL events of all enqueued commands of a benchmark execution
+ *          and exports their device timestamps as a timeline in the Chrome trace event format.
+ *          The resulting file can be viewed with chrome://tracing or https://ui.perfetto.dev.
+ *          If the profiler is disabled, no events are recorded and the command queues are created without profiling,
+ *          so the measurements are not influenced.
+ *
+ */
+class EventProfiler {
+
+private:
+
+    /**
+     * @brief True, if the events should be recorded
+     *
+     */
+    bool enabled;
+
+    /**
+     * @brief All recorded events together with the name that is shown in the timeline.
+     *          A list is used, because the pointers to the events returned by event() have to stay valid.
+     *
+     */
+    std::list<std::pair<std::string, cl::Event>> events;
+
+    /**
+     * @brief Mutex to protect the event list, since some execution types enqueue commands from multiple threads
+     *
+     */
+    std::mutex eventsMutex;
+
+public:
+
+    /**
+     * @brief Construct a new Event Profiler object
+     *
+     * @param enabled_ If false, no events will be recorded
+     */
+    explicit EventProfiler(bool enabled_) : enabled(enabled_) {}
+
+    /**
+     * @brief Check if the profiler is recording events
+     *
+     * @return true if events are recorded
+     */
+    bool
+    isEnabled() const {
+        return enabled;
+    }
+
+    /**
+     * @brief Enable or disable the recording of events
+     *
+     * @param enabled_ If false, no new events will be recorded
+     */
+    void
+    setEnabled(bool enabled_) {
+        enabled = enabled_;
+    }
+
+    /**
+     * @brief Get the properties that should be used to create command queues.
+     *          The execution types have to use them for all queues that should show up in the timeline.
+     *
+     * @return cl_command_queue_properties CL_QUEUE_PROFILING_ENABLE if the profiler is enabled, 0 otherwise
+     */
+    cl_command_queue_properties
+    getQueueProperties() const {
+        return enabled ? CL_QUEUE_PROFILING_ENABLE : 0;
+    }
+
+    /**
+     * @brief Create a new event that can be passed to an enqueue call of the OpenCL API
+     *
+     * @param name The name of the command shown in the timeline e.g. the kernel name
+     * @return cl::Event* Pointer to the new event or nullptr if the profiler is disabled.
+     *                      So the result can always be passed to the enqueue calls.
+     */
+    cl::Event*
+    event(std::string const& name) {
+        if (!enabled) {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(eventsMutex);
+        events.emplace_back(name, cl::Event());
+        return &events.back().second;
+    }
+
+    /**
+     * @brief Record an already existing event, e.g. if the event is also used for synchronization
+     *
+     * @param name The name of the command shown in the timeline e.g. the kernel name
+     * @param event The event of the enqueued command
+     */
+    void
+    addEvent(std::string const& name, cl::Event const& event) {
+        if (enabled) {
+            std::lock_guard<std::mutex> lock(eventsMutex);
+            events.emplace_back(name, event);
+        }
+    }
+
+    /**
+     * @brief Get the number of recorded events
+     *
+     * @return size_t number of recorded events
+     */
+    size_t
+    size() const {
+        return events.size();
+    }
+
+    /**
+     * @brief Remove all recorded events
+     *
+     */
+    void
+    clear() {
+        std::lock_guard<std::mutex> lock(eventsMutex);
+        events.clear();
+    }
+
+    /**
+     * @brief Write all recorded events to a file in the Chrome trace event format.
+     *          Every command queue is shown as a separate thread of the process with the id of the MPI rank.
+     *          The timestamps are relative to the first recorded command.
+     *          Events without valid profiling information will be skipped.
+     *
+     * @param fileName Path to the output file
+     * @param rank The MPI rank of the process, used as process id in the trace
+     * @return true if the file was written successfully
+     */
+    bool
+    writeChromeTrace(std::string const& fileName, int rank) {
+        struct TimelineEntry {
+            std::string name;
+            int queueId;
+            cl_ulong start;
+            cl_ulong end;
+        };
+        std::map<cl_command_queue, int> queueIds;
+        std::list<TimelineEntry> timeline;
+        cl_ulong firstStart = std::numeric_limits<cl_ulong>::max();
+        std::lock_guard<std::mutex> lock(eventsMutex);
+        for (auto& e : events) {
+            if (e.second() == nullptr) {
+                // The event was never passed to an enqueue call
+                continue;
+            }
+            e.second.wait();
+            int err_start, err_end, err_queue;
+            cl_ulong start = e.second.getProfilingInfo<CL_PROFILING_COMMAND_START>(&err_start);
+            cl_ulong end = e.second.getProfilingInfo<CL_PROFILING_COMMAND_END>(&err_end);
+            cl::CommandQueue queue = e.second.getInfo<CL_EVENT_COMMAND_QUEUE>(&err_queue);
+            if (err_start != CL_SUCCESS || err_end != CL_SUCCESS || err_queue != CL_SUCCESS) {
+                continue;
+            }
+            auto queue_id = queueIds.find(queue());
+            if (queue_id == queueIds.end()) {
+                queue_id = queueIds.insert({queue(), static_cast<int>(queueIds.size())}).first;
+            }
+            firstStart = std::min(firstStart, start);
+            timeline.push_back({e.first, queue_id->second, start, end});
+        }
+
+        std::ofstream out(fileName);
+        if (!out.is_open()) {
+            std::cerr << "ERROR: Could not open file " << fileName << " to write the trace!" << std::endl;
+            return false;
+        }
+        out << std::fixed << std::setprecision(3);
+        out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [" << std::endl;
+        out << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << rank << ", \"args\": {\"name\": \"Rank " << rank << "\"}}";
+        for (auto const& q : queueIds) {
+            out << "," << std::endl << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << rank << ", \"tid\": " << q.second
+                    << ", \"args\": {\"name\": \"Queue " << q.second << "\"}}";
+        }
+        for (auto const& t : timeline) {
+            std::string name;
+            for (char c : t.name) {
+                if (c == '"' || c == '\\') {
+                    name += '\\';
+                }
+                name += c;
+            }
+            out << "," << std::endl << "  {\"name\": \"" << name << "\", \"cat\": \"opencl\", \"ph\": \"X\", \"pid\": " << rank
+                    << ", \"tid\": " << t.queueId
+                    << ", \"ts\": " << static_cast<double>(t.start - firstStart) * 1.0e-3
+                    << ", \"dur\": " << static_cast<double>(t.end - t.start) * 1.0e-3 << "}";
+        }
+        out << std::endl << "]}" << std::endl;
+        return true;
+    }
+
+};
+
+}
+
+#endif
@@ -0,0 +1,421 @@
+/*
+Copyright (c) 2021 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHARED_HOST_MEMORY_HPP_
+#define SHARED_HOST_MEMORY_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* External library headers */
+#ifdef USE_DEPRECATED_HPP_HEADER
+#include "CL/cl.hpp"
+#else
+#include OPENCL_HPP_HEADER
+#endif
+
+namespace hpcc_base {
+
+/**
+ * @brief Pooled allocator for the host buffers of the benchmark data classes.
+ *          All buffers are page aligned, so they fulfill the alignment requirements of all supported
+ *          OpenCL runtimes. Released buffers are kept in a pool and handed out again for allocations that fit into them.
+ *          This way, the memory is only allocated, placed and touched once for all repetitions and sweep configurations
+ *          that use the same data size. The pool never keeps more unused memory than is currently in use by the benchmark.
+ *
+ */
+namespace host_memory {
+
+/**
+ * @brief Configuration of the placement of new host buffers
+ *
+ */
+struct Configuration {
+
+    /**
+     * @brief NUMA node the memory should be placed on. A negative value disables the binding.
+     *
+     */
+    int numaNode;
+
+    /**
+     * @brief Use huge pages for the buffers. Explicit huge pages are used if available,
+     *          transparent huge pages otherwise.
+     *
+     */
+    bool hugePages;
+
+    /**
+     * @brief Lock the buffers in physical memory, so they can not be swapped or moved by the OS
+     *
+     */
+    bool pinned;
+
+    /**
+     * @brief Compare two configurations. Buffers of the process-wide pool are only reused while the configuration
+     *          stays equal, so configure() releases all unused buffers if the new configuration is not equal to the current one.
+     *
+     * @param other The configuration to compare with
+     * @return true if the NUMA node, huge page and pinning settings are the same
+     */
+    bool
+    operator==(Configuration const& other) const {
+        return numaNode == other.numaNode && hugePages == other.hugePages && pinned == other.pinned;
+    }
+};
+
+/**
+ * @brief Size of the huge pages used for explicit huge page allocations
+ *
+ */
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+/**
+ * @brief NUMA memory policy that prefers the given node, but falls back to other nodes if it is full.
+ *          Same constant as MPOL_PREFERRED in numaif.h, which is not required to be installed.
+ *
+ */
+static constexpr int MEMORY_POLICY_PREFERRED = 1;
+
+namespace detail {
+
+/**
+ * @brief Global state of the memory pool
+ *
+ */
+struct Pool {
+
+    /**
+     * @brief Configuration that is used for new allocations
+     *
+     */
+    Configuration configuration = {-1, false, false};
+
+    /**
+     * @brief A buffer that is currently not used together with the number of the release() call that returned it
+     *
+     */
+    struct FreeBlock {
+        void* ptr;
+        uint64_t released;
+    };
+
+    /**
+     * @brief Buffers that are currently not used mapped by their size in bytes
+     *
+     */
+    std::multimap<size_t, FreeBlock> freeBlocks;
+
+    /**
+     * @brief Number of release() calls. Used to find the least recently released buffer.
+     *
+     */
+    uint64_t releaseCount = 0;
+
+    /**
+     * @brief Buffers that are handed out to the benchmark together with their size in bytes
+     *
+     */
+    std::map<void*, size_t> usedBlocks;
+
+    /**
+     * @brief Protects all members of the pool, since the pool is shared by all threads of the process
+     *
+     */
+    std::mutex poolMutex;
+
+    /**
+     * @brief Unmap all currently unused buffers. The mutex has to be locked by the caller.
+     *
+     */
+    void
+    unmapFreeBlocks() {
+        for (auto& b : freeBlocks) {
+            munmap(b.second.ptr, b.first);
+        }
+        freeBlocks.clear();
+    }
+
+    /**
+     * @brief Unmap the least recently released buffers until the unused memory is not larger than the used memory.
+     *          The mutex has to be locked by the caller.
+     *
+     */
+    void
+    evictFreeBlocks() {
+        size_t used_bytes = 0;
+        for (auto const& b : usedBlocks) {
+            used_bytes += b.second;
+        }
+        size_t free_bytes = 0;
+        for (auto const& b : freeBlocks) {
+            free_bytes += b.first;
+        }
+        while (free_bytes > used_bytes) {
+            auto oldest = freeBlocks.begin();
+            for (auto it = freeBlocks.begin(); it != freeBlocks.end(); it++) {
+                if (it->second.released < oldest->second.released) {
+                    oldest = it;
+                }
+            }
+            munmap(oldest->second.ptr, oldest->first);
+            free_bytes -= oldest->first;
+            freeBlocks.erase(oldest);
+        }
+    }
+
+    ~Pool() {
+        unmapFreeBlocks();
+    }
+};
+
+inline Pool&
+getPool() {
+    static Pool pool;
+    return pool;
+}
+
+/**
+ * @brief Map new memory that is placed and touched according to the given configuration
+ *
+ * @param bytes The size of the buffer. Has to be a multiple of the page size.
+ * @param config The configuration used for the placement
+ * @return void* Pointer to the new buffer
+ */
+inline void*
+mapBlock(size_t bytes, Configuration const& config) {
+    void* ptr = MAP_FAILED;
+    if (config.hugePages) {
+        ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+    if (ptr == MAP_FAILED) {
+        ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+#ifdef MADV_HUGEPAGE
+        if (config.hugePages) {
+            madvise(ptr, bytes, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    if (config.numaNode >= 0) {
+        constexpr size_t bits_per_word = 8 * sizeof(unsigned long);
+        std::vector<unsigned long> node_mask(config.numaNode / bits_per_word + 1, 0);
+        node_mask[config.numaNode / bits_per_word] = 1ul << (config.numaNode % bits_per_word);
+        if (syscall(SYS_mbind, ptr, bytes, MEMORY_POLICY_PREFERRED, node_mask.data(),
+                            node_mask.size() * bits_per_word + 1, 0) != 0) {
+            std::cerr << "WARNING: Host memory could not be bound to NUMA node " << config.numaNode << std::endl;
+        }
+    }
+    // Touch all pages in parallel so they are already mapped before the first measurement.
+    // The memory policy ensures that they are placed on the chosen NUMA node.
+    char* pages = reinterpret_cast<char*>(ptr);
+    long page_size = sysconf(_SC_PAGESIZE);
+    long num_pages = static_cast<long>(bytes / page_size);
+#pragma omp parallel for
+    for (long p = 0; p < num_pages; p++) {
+        pages[p * page_size] = 0;
+    }
+    if (config.pinned && mlock(ptr, bytes) != 0) {
+        std::cerr << "WARNING: Host memory could not be pinned. Check the memlock limit with ulimit -l." << std::endl;
+    }
+    return ptr;
+}
+
+} // namespace detail
+
+/**
+ * @brief Set the configuration for new allocations. If the configuration changes,
+ *          all unused buffers in the pool are released, because they do not match the new configuration.
+ *
+ * @param config The new configuration
+ */
+inline void
+configure(Configuration const& config) {
+    auto& pool = detail::getPool();
+    std::lock_guard<std::mutex> lock(pool.poolMutex);
+    if (!(pool.configuration == config)) {
+        pool.unmapFreeBlocks();
+        pool.configuration = config;
+    }
+}
+
+/**
+ * @brief Get the currently used configuration
+ *
+ * @return Configuration the currently used configuration
+ */
+inline Configuration
+getConfiguration() {
+    auto& pool = detail::getPool();
+    std::lock_guard<std::mutex> lock(pool.poolMutex);
+    return pool.configuration;
+}
+
+/**
+ * @brief Allocate a page aligned host buffer.
+ *          The smallest unused buffer that fits the allocation is reused, if it is at most twice as large.
+ *          Only newly mapped buffers are zero initialized. Reused buffers contain the data of their previous use,
+ *          so the caller has to initialize the buffer.
+ *          If a new buffer is mapped, the least recently released buffers are unmapped until the pool does not keep
+ *          more unused memory than is in use.
+ *
+ * @param bytes Size of the buffer in bytes
+ * @return void* Pointer to the buffer. Has to be released with release().
+ */
+inline void*
+allocate(size_t bytes) {
+    auto& pool = detail::getPool();
+    std::unique_lock<std::mutex> lock(pool.poolMutex);
+    size_t page_size = pool.configuration.hugePages ? HUGE_PAGE_SIZE : static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t mapped_bytes = ((bytes + page_size - 1) / page_size) * page_size;
+    if (mapped_bytes == 0) {
+        mapped_bytes = page_size;
+    }
+    auto block = pool.freeBlocks.lower_bound(mapped_bytes);
+    if (block != pool.freeBlocks.end() && block->first <= 2 * mapped_bytes) {
+        void* ptr = block->second.ptr;
+        pool.usedBlocks[ptr] = block->first;
+        pool.freeBlocks.erase(block);
+        return ptr;
+    }
+    Configuration config = pool.configuration;
+    lock.unlock();
+    void* ptr = detail::mapBlock(mapped_bytes, config);
+    lock.lock();
+    pool.usedBlocks[ptr] = mapped_bytes;
+    // Buffers of sizes that were not requested for a long time will most likely not be needed anymore
+    pool.evictFreeBlocks();
+    return ptr;
+}
+
+/**
+ * @brief Allocate a page aligned host buffer for the given number of elements
+ *
+ * @tparam T Type of the elements
+ * @param count Number of elements
+ * @return T* Pointer to the buffer. Has to be released with release().
+ */
+template<class T>
+T*
+allocate(size_t count) {
+    return reinterpret_cast<T*>(allocate(count * sizeof(T)));
+}
+
+/**
+ * @brief Return a buffer to the pool, so it can be reused by later allocations
+ *
+ * @param ptr Pointer to a buffer returned by allocate(). nullptr is ignored.
+ */
+inline void
+release(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    auto& pool = detail::getPool();
+    std::lock_guard<std::mutex> lock(pool.poolMutex);
+    auto block = pool.usedBlocks.find(ptr);
+    if (block == pool.usedBlocks.end()) {
+        std::cerr << "ERROR: Released host memory was not allocated by the pool!" << std::endl;
+        return;
+    }
+    pool.freeBlocks.insert({block->second, {ptr, pool.releaseCount++}});
+    pool.usedBlocks.erase(block);
+}
+
+/**
+ * @brief Release all unused buffers of the pool to the OS
+ *
+ */
+inline void
+clearPool() {
+    auto& pool = detail::getPool();
+    std::lock_guard<std::mutex> lock(pool.poolMutex);
+    pool.unmapFreeBlocks();
+}
+
+/**
+ * @brief Get the number of bytes that are kept in the pool for reuse
+ *
+ * @return size_t bytes of all unused buffers
+ */
+inline size_t
+getPooledBytes() {
+    auto& pool = detail::getPool();
+    std::lock_guard<std::mutex> lock(pool.poolMutex);
+    size_t bytes = 0;
+    for (auto const& b : pool.freeBlocks) {
+        bytes += b.first;
+    }
+    return bytes;
+}
+
+/**
+ * @brief Get the NUMA node the given PCIe device is attached to.
+ *          The PCIe address of the device is only available for runtimes that support
+ *          the CL_DEVICE_PCIE_BDF query (Xilinx).
+ *
+ * @param device The OpenCL device
+ * @return int The NUMA node of the device or -1, if it can not be determined
+ */
+inline int
+getDeviceNumaNode(cl::Device const& device) {
+    std::string bdf;
+#ifdef CL_DEVICE_PCIE_BDF
+    char bdf_buffer[64] = {0};
+    if (clGetDeviceInfo(device(), CL_DEVICE_PCIE_BDF, sizeof(bdf_buffer) - 1, bdf_buffer, nullptr) == CL_SUCCESS) {
+        bdf = bdf_buffer;
+    }
+#else
+    (void) device;
+#endif
+    if (bdf.empty()) {
+        return -1;
+    }
+    // sysfs uses the domain as prefix of the address
+    if (std::count(bdf.begin(), bdf.end(), ':') < 2) {
+        bdf = "0000:" + bdf;
+    }
+    std::ifstream node_file("/sys/bus/pci/devices/" + bdf + "/numa_node");
+    int node = -1;
+    if (!(node_file >> node)) {
+        return -1;
+    }
+    return node;
+}
+
+} // namespace host_memory
+
+}
+
+#endif
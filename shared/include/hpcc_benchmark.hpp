@@ -23,6 +23,15 @@ SOFTWARE.
 #define SHARED_HPCC_BENCHMARK_HPP_
 
 #include <memory>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
 
 /* External library headers */
 #ifdef USE_DEPRECATED_HPP_HEADER
@@ -39,6 +48,20 @@ SOFTWARE.
 #include "cxxopts.hpp"
 #include "parameters.h"
 #include "communication_types.hpp"
+#include "communication_progress.hpp"
+#include "event_profiler.hpp"
+#include "host_memory.hpp"
+#include "repetition_policy.hpp"
+#include "multi_device.hpp"
+#include "power_sampler.hpp"
+#include "counter_random.hpp"
+#include "validation_policy.hpp"
+#include "roofline.hpp"
+#include "baseline.hpp"
+#include "auto_size.hpp"
+#include "launch_latency.hpp"
+#include "trace_region.hpp"
+#include "soak.hpp"
 
 #define STR_EXPAND(tok) #tok
 #define STR(tok) STR_EXPAND(tok)
@@ -52,6 +75,28 @@ SOFTWARE.
  */
 namespace hpcc_base {
 
+/**
+ * @brief Get the value of an input parameter or the given default value, if the benchmark does not offer the parameter.
+ *          The availability of some parameters depends on the build flags of the benchmark. Checking them at run time instead of 
+ *          compile time keeps the base settings identical for all benchmarks, so multiple benchmarks can be linked into a single binary.
+ * 
+ * @tparam T Type of the parameter value
+ * @param results The resulting map from parsing the program input parameters
+ * @param name Name of the parameter
+ * @param defaultValue Value that is returned if the parameter is not available
+ * @return T The value of the parameter
+ */
+template<typename T>
+T
+getOptionValue(cxxopts::ParseResult &results, std::string const& name, T const& defaultValue) {
+    try {
+        return results[name].as<T>();
+    }
+    catch (const cxxopts::OptionException&) {
+        return defaultValue;
+    }
+}
+
 /**
  * @brief This class should be derived and extended for every benchmark.
  *          It is a pure data object containing the benchmark settings that are
@@ -68,6 +113,26 @@ public:
      */
     uint numRepetitions;
 
+    /**
+     * @brief Number of kernel executions before the measurement starts. Their timings are discarded.
+     * 
+     */
+    uint warmupRepetitions;
+
+    /**
+     * @brief Maximum number of repetitions if a repetition tolerance is given
+     * 
+     */
+    uint maxRepetitions;
+
+    /**
+     * @brief Relative tolerance for the 95% confidence interval of the median execution time.
+     *          If greater zero, the kernel is repeated until the interval is within the tolerance or maxRepetitions is reached.
+     *          numRepetitions is used as the minimum number of repetitions in this case.
+     * 
+     */
+    double repetitionTolerance;
+
     /**
      * @brief Boolean showing if memory interleaving is used that is 
      *          triggered from the host side (Intel specific)
@@ -82,6 +147,18 @@ public:
      */
     bool skipValidation;
 
+    /**
+     * @brief The used validation mode. If it is off, skipValidation is also set.
+     * 
+     */
+    ValidationMode validationMode;
+
+    /**
+     * @brief Maximum probability that a wrong result passes the sampled validation
+     * 
+     */
+    double validationErrorBound;
+
     /**
      * @brief The default platform that should be used for execution. 
      *          A number representing the index in the list of available platforms
@@ -96,6 +173,13 @@ public:
      */
     int defaultDevice;
 
+    /**
+     * @brief Number of devices used by a single MPI rank.
+     *          The kernel replications are distributed over the devices.
+     * 
+     */
+    uint numDevices;
+
     /**
      * @brief Path to the kernel file that is used for execution
      * 
@@ -120,32 +204,201 @@ public:
      */
     CommunicationType communicationType;
 
+    /**
+     * @brief List of additional program arguments for a parameter sweep.
+     *          The benchmark will be executed once for every entry reusing the already programmed device.
+     *          The list is empty, if no sweep should be done.
+     * 
+     */
+    std::vector<std::string> sweepConfigurations;
+
+    /**
+     * @brief Path to the file the measurement results are written to in JSON format.
+     *          Empty, if no results should be dumped.
+     * 
+     */
+    std::string dumpFilePath;
+
+    /**
+     * @brief Path to the file the timeline of all enqueued OpenCL commands is written to in the Chrome trace format.
+     *          Empty, if no profiling should be done.
+     * 
+     */
+    std::string traceFilePath;
+
+    /**
+     * @brief Generate the input data while the FPGA is programmed in a separate thread
+     * 
+     */
+    bool overlapGeneration;
+
+    /**
+     * @brief NUMA node the host buffers are allocated on.
+     *          If negative, the node is derived from the PCIe locality of the device if possible.
+     * 
+     */
+    int numaNode;
+
+    /**
+     * @brief Allocate the host buffers using huge pages
+     * 
+     */
+    bool useHugePages;
+
+    /**
+     * @brief Lock the host buffers in physical memory
+     * 
+     */
+    bool pinHostMemory;
+
+    /**
+     * @brief Description of the power source that is sampled during the kernel execution.
+     *          Empty, if no power should be measured.
+     * 
+     */
+    std::string powerSource;
+
+    /**
+     * @brief Time between two power samples in ms
+     * 
+     */
+    uint powerInterval;
+
+    /**
+     * @brief Frequency of the kernels in MHz that is used to calculate the theoretical peak performance.
+     *          If 0, the maximum clock frequency reported by the device is used.
+     * 
+     */
+    double kernelFrequency;
+
+    /**
+     * @brief Number of global memory banks of the board that is used to calculate the peak memory bandwidth.
+     *          If 0, the memory bandwidth is not considered for the theoretical peak performance.
+     * 
+     */
+    uint memoryBanks;
+
+    /**
+     * @brief Number of bytes a single memory bank can transfer per cycle
+     * 
+     */
+    double memoryBankWidth;
+
+    /**
+     * @brief Frequency of the memory interface in MHz
+     * 
+     */
+    double memoryFrequency;
+
+    /**
+     * @brief Path to the JSON file of a previous execution the timings are compared to.
+     *          Empty, if no comparison should be done.
+     * 
+     */
+    std::string baselineFilePath;
+
+    /**
+     * @brief Maximum allowed relative performance drop compared to the baseline
+     * 
+     */
+    double baselineThreshold;
+
+    /**
+     * @brief Maximum p-value for a performance drop to be considered as significant
+     * 
+     */
+    double baselineSignificance;
+
+    /**
+     * @brief Fraction of the device memory that is used if the problem size is selected automatically.
+     *          If 0, the given problem size is used.
+     * 
+     */
+    double autoSizeFraction;
+
+    /**
+     * @brief Number of measurements of the kernel launch and transfer latencies after the benchmark execution. 0, if disabled.
+     * 
+     */
+    uint launchLatencyRepetitions;
+
+    /**
+     * @brief Duration of the soak run in s after the benchmark execution. 0, if disabled.
+     * 
+     */
+    double soakDuration;
+
+    /**
+     * @brief Number of soak iterations after which the input data is generated again and the output is validated. 0 to skip the validation.
+     * 
+     */
+    uint soakValidationInterval;
+
+    /**
+     * @brief Path to the file the metrics of the soak run are exported to in the Prometheus text format. Empty, if not exported.
+     * 
+     */
+    std::string soakExportPath;
+
+    /**
+     * @brief Description of the source of the board temperature that is reported by the soak run. Empty, if not measured.
+     * 
+     */
+    std::string temperatureSource;
+
     /**
      * @brief Construct a new Base Settings object
      * 
      * @param results The resulting map from parsing the program input parameters
      */
     BaseSettings(cxxopts::ParseResult &results) : numRepetitions(results["n"].as<uint>()),
+            warmupRepetitions(results["warmup"].as<uint>()),
+            maxRepetitions(results["max-repetitions"].as<uint>()),
+            repetitionTolerance(results["tolerance"].as<double>()),
 #ifdef INTEL_FPGA
             useMemoryInterleaving(static_cast<bool>(results.count("i"))), 
 #else
             useMemoryInterleaving(true),
 #endif
-            skipValidation(static_cast<bool>(results.count("skip-validation"))), 
+            skipValidation(static_cast<bool>(results.count("skip-validation")) || retrieveValidationMode(results["validation"].as<std::string>()) == ValidationMode::off), 
+            validationMode(results.count("skip-validation") ? ValidationMode::off : retrieveValidationMode(results["validation"].as<std::string>())),
+            validationErrorBound(results["validation-error"].as<double>()),
             defaultPlatform(results["platform"].as<int>()),
             defaultDevice(results["device"].as<int>()),
+            numDevices(getOptionValue<uint>(results, "num-devices", 1)),
             kernelFileName(results["f"].as<std::string>()),
-#ifdef NUM_REPLICATIONS
-            kernelReplications(results.count("r") > 0 ? results["r"].as<uint>() : NUM_REPLICATIONS),
-#else
-            kernelReplications(results.count("r") > 0 ? results["r"].as<uint>() : 1),
-#endif
-#ifdef COMMUNICATION_TYPE_SUPPORT_ENABLED
-            communicationType(retrieveCommunicationType(results["comm-type"].as<std::string>(), results["f"].as<std::string>())),
-#else
-            communicationType(retrieveCommunicationType("UNSUPPORTED", results["f"].as<std::string>())),
-#endif
-            testOnly(static_cast<bool>(results.count("test"))) {}
+            kernelReplications(getOptionValue<uint>(results, "r", 1)),
+            communicationType(retrieveCommunicationType(getOptionValue<std::string>(results, "comm-type", "UNSUPPORTED"), results["f"].as<std::string>())),
+            testOnly(static_cast<bool>(results.count("test"))),
+            sweepConfigurations(results.count("sweep") > 0 ? results["sweep"].as<std::vector<std::string>>() : std::vector<std::string>()),
+            dumpFilePath(results.count("dump-json") > 0 ? results["dump-json"].as<std::string>() : ""),
+            traceFilePath(results.count("trace") > 0 ? results["trace"].as<std::string>() : ""),
+            overlapGeneration(static_cast<bool>(results.count("overlap-generation"))),
+            numaNode(results["numa-node"].as<int>()),
+            useHugePages(static_cast<bool>(results.count("huge-pages"))),
+            pinHostMemory(static_cast<bool>(results.count("pin-memory"))),
+            powerSource(results.count("power-source") > 0 ? results["power-source"].as<std::string>() : ""),
+            powerInterval(results["power-interval"].as<uint>()),
+            kernelFrequency(results["kernel-frequency"].as<double>()),
+            memoryBanks(results["memory-banks"].as<uint>()),
+            memoryBankWidth(results["memory-bank-width"].as<double>()),
+            memoryFrequency(results["memory-frequency"].as<double>()),
+            baselineFilePath(results.count("baseline") > 0 ? results["baseline"].as<std::string>() : ""),
+            baselineThreshold(results["baseline-threshold"].as<double>()),
+            baselineSignificance(results["baseline-significance"].as<double>()),
+            autoSizeFraction(results["auto-size"].as<double>()),
+            launchLatencyRepetitions(results["launch-latency"].as<uint>()),
+            soakDuration(results["soak"].as<double>()),
+            soakValidationInterval(results["soak-validation"].as<uint>()),
+            soakExportPath(results.count("soak-export") > 0 ? results["soak-export"].as<std::string>() : ""),
+            temperatureSource(results.count("temperature-source") > 0 ? results["temperature-source"].as<std::string>() : "") {
+        if (autoSizeFraction < 0.0 || autoSizeFraction > 1.0) {
+            throw std::runtime_error("The fraction of the device memory used for the automatic size selection has to be between 0 and 1!");
+        }
+        if (soakDuration < 0.0) {
+            throw std::runtime_error("The duration of the soak run has to be positive!");
+        }
+    }
 
     /**
      * @brief Get a map of the settings. This map will be used to print the final configuration.
@@ -158,135 +411,1002 @@ public:
 #ifdef _USE_MPI_
      MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
 #endif
-    std::string str_mpi_ranks = "None";
-    if (mpi_size > 0) {
-        str_mpi_ranks = std::to_string(mpi_size);
-    }
-        return {{"Repetitions", std::to_string(numRepetitions)}, {"Kernel Replications", std::to_string(kernelReplications)}, 
-                {"Kernel File", kernelFileName}, {"MPI Ranks", str_mpi_ranks}, {"Test Mode", testOnly ? "Yes" : "No"},
-                {"Communication Type", commToString(communicationType)}};
-    }
+    std::string str_mpi_ranks = "None";
+    if (mpi_size > 0) {
+        str_mpi_ranks = std::to_string(mpi_size);
+    }
+    std::stringstream str_repetitions;
+    str_repetitions << numRepetitions;
+    if (repetitionTolerance > 0.0 && maxRepetitions > numRepetitions) {
+        str_repetitions << " to " << maxRepetitions << " until median CI within " << repetitionTolerance * 100 << "%";
+    }
+    if (warmupRepetitions > 0) {
+        str_repetitions << " (+" << warmupRepetitions << " warmup)";
+    }
+    std::stringstream str_validation;
+    str_validation << validationToString(validationMode);
+    if (validationMode == ValidationMode::sampled) {
+        str_validation << " (error bound " << validationErrorBound << ")";
+    }
+    std::stringstream str_roofline;
+    str_roofline << "Kernel ";
+    if (kernelFrequency > 0.0) {
+        str_roofline << kernelFrequency << " MHz";
+    }
+    else {
+        str_roofline << "device max. clock";
+    }
+    double memory_peak = calculateMemoryPeak(memoryBanks, memoryBankWidth, memoryFrequency);
+    if (memory_peak > 0.0) {
+        str_roofline << ", Memory " << memory_peak * 1.0e-9 << " GB/s";
+    }
+        return {{"Repetitions", str_repetitions.str()}, {"Kernel Replications", std::to_string(kernelReplications)}, 
+                {"Kernel File", kernelFileName}, {"MPI Ranks", str_mpi_ranks}, {"Test Mode", testOnly ? "Yes" : "No"},
+                {"Communication Type", commToString(communicationType)}, {"Devices per Rank", std::to_string(numDevices)},
+                {"Power Source", powerSource.empty() ? "None" : powerSource},
+                {"Validation", str_validation.str()}, {"Roofline", str_roofline.str()},
+                {"Baseline", baselineFilePath.empty() ? "None" : baselineFilePath},
+                {"Soak", soakDuration > 0.0 ? std::to_string(soakDuration) + " s" : "No"}};
+    }
+
+};
+
+
+/**
+ * @brief Convert a string to a JSON string including quotes and escaped special characters
+ * 
+ * @param str The string that should be converted
+ * @return std::string The JSON representation of the string
+ */
+static std::string
+toJsonString(const std::string& str) {
+    std::stringstream ss;
+    ss << "\"";
+    for (char c : str) {
+        switch (c) {
+            case '"': ss << "\\\""; break;
+            case '\\': ss << "\\\\"; break;
+            case '\n': ss << "\\n"; break;
+            case '\t': ss << "\\t"; break;
+            default: if (static_cast<unsigned char>(c) < 0x20) {
+                            ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+                        }
+                        else {
+                            ss << c;
+                        }
+        }
+    }
+    ss << "\"";
+    return ss.str();
+}
+
+/**
+ * @brief Convert a floating point value to a JSON number. Not finite values are converted to null.
+ * 
+ * @param value The value that should be converted
+ * @return std::string The JSON representation of the value
+ */
+static std::string
+toJsonNumber(double value) {
+    if (!std::isfinite(value)) {
+        return "null";
+    }
+    std::stringstream ss;
+    ss << std::setprecision(15) << value;
+    return ss.str();
+}
+
+/**
+ * @brief Settings class that is containing the program settings together with
+ *          additional information about the OpenCL runtime
+ * 
+ * @tparam TSettings The program settings class that should be used (Must derive from BaseSettings)
+ */
+template <class TSettings>
+class ExecutionSettings {
+public:
+
+    /**
+     * @brief Pointer to the additional program settings
+     * 
+     */
+    std::unique_ptr<TSettings> programSettings;
+
+    /**
+     * @brief The OpenCL device that should be used for execution
+     * 
+     */
+    std::unique_ptr<cl::Device> device;
+
+    /**
+     * @brief All OpenCL devices that are used for execution. The first device is the same as device.
+     *          Kernel replication r is executed on device r % devices.size().
+     * 
+     */
+    std::vector<cl::Device> devices;
+
+    /**
+     * @brief The OpenCL context that should be used for execution
+     * 
+     */
+    std::unique_ptr<cl::Context> context;
+
+    /**
+     * @brief The OpenCL program that contains the benchmark kernel
+     * 
+     */
+    std::unique_ptr<cl::Program> program;
+
+    /**
+     * @brief Profiler used to record the OpenCL events of the benchmark execution.
+     *          It is enabled if a trace file is given in the program settings.
+     * 
+     */
+    std::unique_ptr<EventProfiler> profiler;
+
+    /**
+     * @brief Decides how often the kernel is executed and keeps track of the executed repetitions.
+     *          Has to be started by the execution types with the current program settings.
+     * 
+     */
+    std::unique_ptr<RepetitionPolicy> repetitions;
+
+    /**
+     * @brief Construct a new Execution Settings object
+     * 
+     * @param programSettings_ Pointer to an existing program settings object that is derived from BaseSettings
+     * @param device_ Used OpenCL device
+     * @param context_ Used OpenCL context
+     * @param program_ Used OpenCL program
+     */
+    ExecutionSettings(std::unique_ptr<TSettings> programSettings_, std::unique_ptr<cl::Device> device_, 
+                        std::unique_ptr<cl::Context> context_, std::unique_ptr<cl::Program> program_): 
+                                    programSettings(std::move(programSettings_)), device(std::move(device_)), 
+                                    context(std::move(context_)), program(std::move(program_)),
+                                    profiler(new EventProfiler(!programSettings->traceFilePath.empty())),
+                                    repetitions(new RepetitionPolicy()) {
+        if (device) {
+            devices.push_back(*device);
+        }
+    }
+
+    /**
+     * @brief Get the device a kernel replication should be executed on
+     * 
+     * @param replication Index of the kernel replication
+     * @return cl::Device const& The device used for the replication
+     */
+    cl::Device const&
+    getDevice(uint replication) const {
+        return devices[replication % devices.size()];
+    }
+
+    /**
+     * @brief Destroy the Execution Settings object. Used to specify the order the contained objects are destroyed 
+     *         to prevent segmentation faults during exit.
+     * 
+     */
+    ~ExecutionSettings() {
+        repetitions = nullptr;
+        profiler = nullptr;
+        program = nullptr;
+        context = nullptr;
+        device = nullptr;
+        programSettings = nullptr;
+    }
+
+};
+
+/**
+ * @brief Base benchmark class. Every benchmark should be derived from this class and implement its abstract methods.
+ * 
+ * @tparam TSettings Class used to represent the program settings of the benchmark
+ * @tparam TData Class used to represent the benchmark input and output data
+ * @tparam TOutput Class representing the measurements like timings etc
+ */
+template <class TSettings, class TData, class TOutput>
+class HpccFpgaBenchmark {
+
+private:
+
+    /**
+     * @brief This flag is set by the setupBenchmark() routine after successful setting up the benchmark.
+     *          It is used to prevent undefined behavior in the case executeBenchmark() is called without
+     *          a complete setup.
+     * 
+     */
+    bool benchmark_setup_succeeded = false;
+
+    /**
+     * @brief Copy of the program arguments given to setupBenchmark().
+     *          They are used as a basis to create new program settings with updateProgramSettings().
+     * 
+     */
+    std::vector<std::string> programArguments;
+
+    /**
+     * @brief Time in seconds needed to select the device and program the FPGA in setupBenchmark()
+     * 
+     */
+    double setupTime = 0.0;
+
+    /**
+     * @brief Input data that was generated during setupBenchmark() while the FPGA was programmed.
+     *          It will be used by the next benchmark execution. nullptr if no data was generated in advance.
+     * 
+     */
+    std::unique_ptr<TData> pregeneratedData;
+
+    /**
+     * @brief Time in seconds needed to generate pregeneratedData
+     * 
+     */
+    double pregenerationTime = 0.0;
+
+    /**
+     * @brief Point in time when setupBenchmark() was called. Used to calculate the time to the first kernel execution
+     * 
+     */
+    std::chrono::time_point<std::chrono::high_resolution_clock> setupStartTime;
+
+    /**
+     * @brief True, if the kernel was already executed since the last call of setupBenchmark()
+     * 
+     */
+    bool firstKernelExecuted = false;
+
+    /**
+     * @brief Collect the raw timings of all MPI ranks on rank 0.
+     *          All MPI ranks need to call this method and all ranks have to use the same keys in rawTimings.
+     * 
+     * @return std::map<std::string, std::vector<std::vector<double>>> The timings of every rank for every key of rawTimings.
+     *          Only complete on rank 0.
+     */
+    std::map<std::string, std::vector<std::vector<double>>>
+    gatherRawTimings() {
+        std::map<std::string, std::vector<std::vector<double>>> rankTimings;
+        for (auto const& t : rawTimings) {
+            std::vector<std::vector<double>> timings_per_rank(mpi_comm_size);
+#ifdef _USE_MPI_
+            int local_count = static_cast<int>(t.second.size());
+            std::vector<int> counts(mpi_comm_size);
+            MPI_Gather(&local_count, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+            std::vector<int> displacements(mpi_comm_size, 0);
+            for (int r = 1; r < mpi_comm_size; r++) {
+                displacements[r] = displacements[r - 1] + counts[r - 1];
+            }
+            std::vector<double> all_timings(mpi_comm_rank == 0 ? displacements.back() + counts.back() : 0);
+            MPI_Gatherv(t.second.data(), local_count, MPI_DOUBLE, all_timings.data(), counts.data(), displacements.data(), 
+                            MPI_DOUBLE, 0, MPI_COMM_WORLD);
+            if (mpi_comm_rank == 0) {
+                for (int r = 0; r < mpi_comm_size; r++) {
+                    timings_per_rank[r] = std::vector<double>(all_timings.begin() + displacements[r], all_timings.begin() + displacements[r] + counts[r]);
+                }
+            }
+#else
+            timings_per_rank[0] = t.second;
+#endif
+            rankTimings[t.first] = timings_per_rank;
+        }
+        return rankTimings;
+    }
+
+    /**
+     * @brief Collect the raw timings of all MPI ranks and write them together with the settings,
+     *          derived metrics and the overall benchmark times to the file given with the dump-json option.
+     *          All MPI ranks need to call this method and all ranks have to use the same keys in rawTimings.
+     * 
+     * @param benchmarkTimes Measured times of the benchmark phases in seconds like generation or validation
+     * @param validationSuccess Result of the output validation
+     */
+    void
+    dumpResultsToJson(std::map<std::string, double> const& benchmarkTimes, bool validationSuccess) {
+        auto rankTimings = gatherRawTimings();
+
+        if (mpi_comm_rank > 0) {
+            return;
+        }
+
+        std::ofstream out(executionSettings->programSettings->dumpFilePath);
+        if (!out.is_open()) {
+            std::cerr << "ERROR: Could not open file " << executionSettings->programSettings->dumpFilePath << " to dump results!" << std::endl;
+            return;
+        }
+        std::string device_name = "None";
+        if (executionSettings->device) {
+            executionSettings->device->getInfo(CL_DEVICE_NAME, &device_name);
+        }
+        out << "{" << std::endl;
+        out << "  \"version\": " << toJsonString(VERSION) << "," << std::endl;
+        out << "  \"config_time\": " << toJsonString(CONFIG_TIME) << "," << std::endl;
+        out << "  \"git_commit\": " << toJsonString(GIT_COMMIT_HASH) << "," << std::endl;
+        out << "  \"device\": " << toJsonString(device_name) << "," << std::endl;
+        out << "  \"mpi_size\": " << mpi_comm_size << "," << std::endl;
+        out << "  \"settings\": {";
+        std::string separator = "";
+        for (auto const& k : executionSettings->programSettings->getSettingsMap()) {
+            out << separator << std::endl << "    " << toJsonString(k.first) << ": " << toJsonString(k.second);
+            separator = ",";
+        }
+        out << std::endl << "  }," << std::endl;
+        out << "  \"times\": {";
+        separator = "";
+        for (auto const& t : benchmarkTimes) {
+            out << separator << std::endl << "    " << toJsonString(t.first) << ": " << toJsonNumber(t.second);
+            separator = ",";
+        }
+        out << std::endl << "  }," << std::endl;
+        out << "  \"timings\": {";
+        separator = "";
+        for (auto const& t : rankTimings) {
+            out << separator << std::endl << "    " << toJsonString(t.first) << ": [";
+            std::string rank_separator = "";
+            for (auto const& rank_timings : t.second) {
+                out << rank_separator << std::endl << "      [";
+                std::string value_separator = "";
+                for (double v : rank_timings) {
+                    out << value_separator << toJsonNumber(v);
+                    value_separator = ", ";
+                }
+                out << "]";
+                rank_separator = ",";
+            }
+            out << std::endl << "    ]";
+            separator = ",";
+        }
+        out << std::endl << "  }," << std::endl;
+        out << "  \"results\": {";
+        separator = "";
+        for (auto const& m : derivedMetrics) {
+            out << separator << std::endl << "    " << toJsonString(m.first) << ": " << toJsonNumber(m.second);
+            separator = ",";
+        }
+        out << std::endl << "  }," << std::endl;
+        out << "  \"validated\": " << (validationSuccess ? "true" : "false") << std::endl;
+        out << "}" << std::endl;
+    }
+
+    /**
+     * @brief Compare the timings of all ranks with the baseline given with the baseline option and add the relative
+     *          performance changes to the derived metrics. Only timing series in seconds are compared.
+     *          All MPI ranks need to call this method.
+     * 
+     * @return true if the performance of no timing series dropped significantly by more than the threshold
+     * @return false if a regression was found or the baseline could not be read
+     */
+    bool
+    compareToBaseline() {
+        auto rankTimings = gatherRawTimings();
+        int passed = 1;
+        if (mpi_comm_rank == 0) {
+            auto const& settings = *executionSettings->programSettings;
+            try {
+                BaselineResults baseline = readBaseline(settings.baselineFilePath);
+                std::string device_name = "None";
+                if (executionSettings->device) {
+                    executionSettings->device->getInfo(CL_DEVICE_NAME, &device_name);
+                }
+                if (baseline.device != device_name || baseline.mpiSize != mpi_comm_size) {
+                    std::cerr << "WARNING: Baseline was measured on " << baseline.device << " with " << baseline.mpiSize
+                            << " MPI ranks, results might not be comparable!" << std::endl;
+                }
+                std::cout << std::endl << std::setw(ENTRY_SPACE) << "Baseline" << std::setw(ENTRY_SPACE) << "median [s]"
+                        << std::setw(ENTRY_SPACE) << "baseline [s]" << std::setw(ENTRY_SPACE) << "change"
+                        << std::setw(ENTRY_SPACE) << "p-value" << std::endl;
+                uint compared = 0;
+                for (auto const& t : rankTimings) {
+                    // Raw timings with a unit contain other measurements like power samples
+                    bool is_time = t.first.find('[') == std::string::npos ||
+                                    (t.first.size() >= 3 && t.first.compare(t.first.size() - 3, 3, "[s]") == 0);
+                    auto base = baseline.timings.find(t.first);
+                    if (!is_time || base == baseline.timings.end() || base->second.empty()) {
+                        continue;
+                    }
+                    std::vector<double> current;
+                    for (auto const& rank_timings : t.second) {
+                        current.insert(current.end(), rank_timings.begin(), rank_timings.end());
+                    }
+                    if (current.empty()) {
+                        continue;
+                    }
+                    auto comparison = compareTimings(base->second, current, settings.baselineThreshold, settings.baselineSignificance);
+                    compared++;
+                    derivedMetrics[t.first + " baseline change [%]"] = comparison.change * 100.0;
+                    std::cout << std::setw(ENTRY_SPACE) << t.first << std::setw(ENTRY_SPACE) << comparison.currentMedian
+                            << std::setw(ENTRY_SPACE) << comparison.baselineMedian << std::setw(ENTRY_SPACE - 2) << comparison.change * 100.0 << " %"
+                            << std::setw(ENTRY_SPACE) << comparison.pValue << (comparison.regression ? "   <-- regression" : "") << std::endl;
+                    if (comparison.regression) {
+                        passed = 0;
+                    }
+                }
+                if (compared == 0) {
+                    std::cerr << "WARNING: The baseline " << settings.baselineFilePath << " does not contain any of the measured timings!" << std::endl;
+                }
+            }
+            catch (std::exception const& e) {
+                std::cerr << "ERROR: " << e.what() << std::endl;
+                passed = 0;
+            }
+        }
+#ifdef _USE_MPI_
+        MPI_Bcast(&passed, 1, MPI_INT, 0, MPI_COMM_WORLD);
+#endif
+        return passed;
+    }
+
+    /**
+     * @brief Write the timeline of the recorded OpenCL events to the trace file given in the program settings.
+     *          If more than one MPI rank is used, every rank writes its own file with the rank appended to the file name.
+     * 
+     */
+    void
+    writeTrace() {
+        std::string fileName = executionSettings->programSettings->traceFilePath;
+        if (mpi_comm_size > 1) {
+            fileName += "." + std::to_string(mpi_comm_rank);
+        }
+        if (executionSettings->profiler->writeChromeTrace(fileName, mpi_comm_rank) && mpi_comm_rank == 0) {
+            std::cout << "Timeline of " << executionSettings->profiler->size() << " OpenCL commands written to " << fileName << std::endl;
+        }
+        executionSettings->profiler->clear();
+    }
+
+#ifdef HPCC_TRACING_RING
+    /**
+     * @brief Write the host code regions recorded in the ring buffer to the trace file with the suffix ".host"
+     *          and clear the buffer, so the next execution only contains its own regions.
+     * 
+     */
+    void
+    writeHostTrace() {
+        std::string fileName = executionSettings->programSettings->traceFilePath + ".host";
+        if (mpi_comm_size > 1) {
+            fileName += "." + std::to_string(mpi_comm_rank);
+        }
+        auto& ring_buffer = tracing::getRingBuffer();
+        if (ring_buffer.writeChromeTrace(fileName, mpi_comm_rank) && mpi_comm_rank == 0) {
+            std::cout << "Timeline of " << ring_buffer.size() << " host code regions written to " << fileName << std::endl;
+        }
+        ring_buffer.clear();
+    }
+#endif
+
+    /**
+     * @brief Sum up the average power of all ranks and add the energy efficiency of all throughput metrics to the derived metrics.
+     *          Has to be called after collectAndPrintResults().
+     * 
+     * @param sampler The sampler used during the kernel execution
+     * @param executionTime The time of the kernel execution in s
+     */
+    void
+    collectAndPrintPowerResults(PowerSampler const& sampler, double executionTime) {
+        double power = sampler.getAveragePower();
+        rawTimings["power samples [W]"] = std::vector<double>();
+        for (auto const& sample : sampler.getSamples()) {
+            rawTimings["power samples [W]"].push_back(sample.second);
+        }
+        int valid = power >= 0.0 ? 1 : 0;
+#ifdef _USE_MPI_
+        MPI_Allreduce(MPI_IN_PLACE, &valid, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+        MPI_Allreduce(MPI_IN_PLACE, &power, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+#endif
+        if (mpi_comm_rank > 0) {
+            return;
+        }
+        if (!valid) {
+            std::cerr << "WARNING: Power could not be read from " << sampler.getSourceName() << ". No energy efficiency is reported." << std::endl;
+            return;
+        }
+        auto efficiency = calculateEnergyEfficiency(derivedMetrics, power);
+        derivedMetrics["average power [W]"] = power;
+        derivedMetrics["energy [J]"] = power * executionTime;
+        std::cout << std::endl << std::setw(ENTRY_SPACE) << "Avg. Power [W]:" << std::setw(ENTRY_SPACE) << power << std::endl;
+        std::cout << std::setw(ENTRY_SPACE) << "Energy [J]:" << std::setw(ENTRY_SPACE) << power * executionTime << std::endl;
+        for (auto const& e : efficiency) {
+            derivedMetrics[e.first] = e.second;
+            std::cout << std::setw(2 * ENTRY_SPACE) << e.first << e.second << std::endl;
+        }
+    }
+
+    /**
+     * @brief Repeat the kernel execution with the given data until the soak duration is over.
+     *          The input data is only generated again before the iterations that are validated, since the kernels
+     *          may modify it. The result tables of the iterations are not printed, instead a status line is printed and
+     *          the status and derived metrics of every iteration are exported, if an export file is given.
+     *
+     * @param data The input data of the previous execution
+     * @return true If all validations are a success
+     * @return false If a validation failed
+     */
+    bool
+    executeSoak(std::unique_ptr<TData>& data) {
+        auto& settings = *executionSettings->programSettings;
+        if (mpi_comm_rank == 0) {
+            std::cout << HLINE << "Soak benchmark kernel for " << settings.soakDuration << " s..." << std::endl
+                    << HLINE;
+        }
+        std::unique_ptr<PowerSource> temperature_source;
+        if (!settings.temperatureSource.empty()) {
+            temperature_source = createTemperatureSource(settings.temperatureSource);
+        }
+        std::string export_file = settings.soakExportPath;
+        if (mpi_comm_size > 1 && !export_file.empty()) {
+            export_file += "." + std::to_string(mpi_comm_rank);
+        }
+        std::string device_name = "None";
+        if (executionSettings->device) {
+            executionSettings->device->getInfo(CL_DEVICE_NAME, &device_name);
+        }
+        std::map<std::string, std::string> labels{{"rank", std::to_string(mpi_comm_rank)}, {"device", device_name},
+                                                    {"kernel", settings.kernelFileName}};
+
+        SoakStatus status;
+        auto soak_start = std::chrono::high_resolution_clock::now();
+        int running = 1;
+        while (running) {
+            bool validate = !settings.skipValidation && settings.soakValidationInterval > 0 &&
+                                (status.iterations + 1) % settings.soakValidationInterval == 0;
+            if (validate) {
+                data = generateInputData();
+            }
+            rawTimings.clear();
+            derivedMetrics.clear();
+            executionSettings->profiler->clear();
+
+            std::unique_ptr<PowerSampler> power_sampler;
+            if (!settings.powerSource.empty()) {
+                power_sampler.reset(new PowerSampler(createPowerSource(settings.powerSource),
+                                        std::chrono::milliseconds(settings.powerInterval)));
+                power_sampler->start();
+            }
+            auto exe_start = std::chrono::high_resolution_clock::now();
+            std::unique_ptr<TOutput> output;
+            {
+                ScopedOutputSuppression quiet;
+                output = executeKernel(*data);
+            }
+            if (power_sampler) {
+                power_sampler->stop();
+            }
+            std::chrono::duration<double> exe_time = std::chrono::high_resolution_clock::now() - exe_start;
+            status.iterations++;
+            status.executionTime = exe_time.count();
+
+            bool validation_success = true;
+            if (validate) {
+                validation_success = validateOutputAndPrintError(*data);
+                status.validations++;
+                status.failedValidations += validation_success ? 0 : 1;
+            }
+            {
+                ScopedOutputSuppression quiet;
+                collectAndPrintResults(*output);
+                if (power_sampler) {
+                    collectAndPrintPowerResults(*power_sampler, exe_time.count());
+                }
+            }
+            status.power = power_sampler ? power_sampler->getAveragePower() : -1.0;
+            status.temperature = temperature_source ? temperature_source->readPower() : -1.0;
+            status.elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - soak_start).count();
+
+            if (!export_file.empty() && !writePrometheusMetrics(export_file, labels, status, derivedMetrics)) {
+                std::cerr << "WARNING: Could not write soak metrics to " << export_file << std::endl;
+            }
+            if (mpi_comm_rank == 0) {
+                std::cout << "Soak iteration " << status.iterations << ": " << status.elapsed << " s elapsed, execution "
+                        << status.executionTime << " s";
+                if (validate) {
+                    std::cout << ", validation " << (validation_success ? "SUCCESS" : "FAILED");
+                }
+                if (status.power >= 0.0) {
+                    std::cout << ", " << status.power << " W";
+                }
+                if (status.temperature >= 0.0) {
+                    std::cout << ", " << status.temperature << " C";
+                }
+                std::cout << std::endl;
+                running = status.elapsed < settings.soakDuration ? 1 : 0;
+            }
+#ifdef _USE_MPI_
+            // All ranks have to execute the same number of iterations, so rank 0 decides when the soak run ends
+            MPI_Bcast(&running, 1, MPI_INT, 0, MPI_COMM_WORLD);
+#endif
+        }
+        if (mpi_comm_rank == 0) {
+            std::cout << "Soak finished after " << status.iterations << " iterations with " << status.failedValidations
+                    << " of " << status.validations << " validations failed" << std::endl;
+        }
+        return status.failedValidations == 0;
+    }
+
+    /**
+     * @brief Run checkInputParameters() on rank 0 and broadcast the result, so all ranks fail the setup together
+     *          instead of the other ranks continuing into collective operations.
+     *
+     * @return true If the check was a success on rank 0
+     * @return false If the check failed
+     */
+    bool
+    checkInputParametersOnAllRanks() {
+        int valid = 1;
+        if (mpi_comm_rank == 0) {
+            valid = checkInputParameters() ? 1 : 0;
+            if (!valid) {
+                std::cerr << "ERROR: Input parameter check failed!" << std::endl;
+            }
+        }
+#ifdef _USE_MPI_
+        MPI_Bcast(&valid, 1, MPI_INT, 0, MPI_COMM_WORLD);
+#endif
+        return valid != 0;
+    }
+
+    /**
+     * @brief Configure the placement of the host buffers allocated by the data classes.
+     *          If no NUMA node is given in the program settings, the node the device is attached to is used.
+     * 
+     */
+    void
+    configureHostMemory() {
+        auto& settings = *executionSettings->programSettings;
+        int numa_node = settings.numaNode;
+        if (numa_node < 0 && executionSettings->device) {
+            numa_node = host_memory::getDeviceNumaNode(*executionSettings->device);
+        }
+        host_memory::configure({numa_node, settings.useHugePages, settings.pinHostMemory});
+    }
+
+    /**
+     * @brief Execute the benchmark a single time with the current program settings.
+     *          This includes the initialization of the input data, exectuon of the kernel,
+     *          validation and printing the result
+     * 
+     * @return true If the validation is a success
+     * @return false If the validation fails or an execution error occured
+     */
+    bool
+    executeSingleBenchmark() {
+        if (executionSettings->programSettings->testOnly) {
+            if (mpi_comm_rank == 0) {
+                std::cout << "TEST MODE ENABLED: SKIP DATA GENERATION, EXECUTION, AND VALIDATION!" << std::endl;
+                std::cout << "SUCCESSFULLY parsed input parameters!" << std::endl;
+            }
+            return benchmark_setup_succeeded;
+        }
+        if (mpi_comm_rank == 0) {
+            std::cout << HLINE << "Start benchmark using the given configuration. Generating data..." << std::endl
+                    << HLINE;
+        }
+       try {
+            rawTimings.clear();
+            derivedMetrics.clear();
+            executionSettings->profiler->clear();
+            std::map<std::string, double> benchmarkTimes{{"setup", setupTime}};
+
+            std::unique_ptr<TData> data;
+            std::chrono::duration<double> gen_time;
+            bool overlapped_generation = static_cast<bool>(pregeneratedData);
+            if (overlapped_generation) {
+                data = std::move(pregeneratedData);
+                gen_time = std::chrono::duration<double>(pregenerationTime);
+            }
+            else {
+                HPCC_TRACE_REGION("generation");
+                auto gen_start = std::chrono::high_resolution_clock::now();
+                data = generateInputData();
+                gen_time = std::chrono::high_resolution_clock::now() - gen_start;
+            }
+            
+#ifdef _USE_MPI_
+            MPI_Barrier(MPI_COMM_WORLD);
+#endif
+
+            if (mpi_comm_rank == 0) {
+                std::cout << "Generation Time: " << gen_time.count() << " s" << (overlapped_generation ? " (overlapped with FPGA setup)" : "") << std::endl;
+                std::cout << HLINE << "Execute benchmark kernel..." << std::endl
+                        << HLINE;
+            }
+
+            bool validateSuccess = false;
+            std::unique_ptr<PowerSampler> power_sampler;
+            if (!executionSettings->programSettings->powerSource.empty()) {
+                power_sampler.reset(new PowerSampler(createPowerSource(executionSettings->programSettings->powerSource),
+                                        std::chrono::milliseconds(executionSettings->programSettings->powerInterval)));
+                power_sampler->start();
+            }
+            auto exe_start = std::chrono::high_resolution_clock::now();
+            std::unique_ptr<TOutput> output;
+            {
+                HPCC_TRACE_REGION("execution");
+                output = executeKernel(*data);
+            }
+            if (power_sampler) {
+                power_sampler->stop();
+            }
+
+#ifdef _USE_MPI_
+        MPI_Barrier(MPI_COMM_WORLD);
+#endif
+
+            std::chrono::duration<double> exe_time = std::chrono::high_resolution_clock::now() - exe_start;
+            benchmarkTimes["generation"] = gen_time.count();
+            benchmarkTimes["execution"] = exe_time.count();
+
+            if (!firstKernelExecuted) {
+                // The end of the first repetition is the completion of the first kernel.
+                // Benchmarks that do not use the repetition policy fall back to the end of the whole execution.
+                auto first_kernel_end = executionSettings->repetitions->isFirstRepetitionFinished() ?
+                                            executionSettings->repetitions->getFirstRepetitionEnd() : std::chrono::high_resolution_clock::now();
+                std::chrono::duration<double> first_kernel_time = first_kernel_end - setupStartTime;
+                benchmarkTimes["time_to_first_kernel"] = first_kernel_time.count();
+                firstKernelExecuted = true;
+                if (mpi_comm_rank == 0) {
+                    std::cout << "Time to first kernel: " << first_kernel_time.count() << " s" << std::endl;
+                }
+            }
+
+            if (executionSettings->profiler->isEnabled()) {
+                writeTrace();
+            }
+
+            if (mpi_comm_rank == 0) {
+                std::cout << "Execution Time: " << exe_time.count() << " s"  << std::endl;
+                std::cout << HLINE << "Validate output..." << std::endl
+                        << HLINE;
+            }
+
+            if (!executionSettings->programSettings->skipValidation) {
+                HPCC_TRACE_REGION("validation");
+                auto eval_start = std::chrono::high_resolution_clock::now();
+                validateSuccess = validateOutputAndPrintError(*data);
+                std::chrono::duration<double> eval_time = std::chrono::high_resolution_clock::now() - eval_start;
+                benchmarkTimes["validation"] = eval_time.count();
+
+                if (mpi_comm_rank == 0) {
+                    std::cout << "Validation Time: " << eval_time.count() << " s" << std::endl;
+                }
+            }
+            {
+                HPCC_TRACE_REGION("collection");
+                collectAndPrintResults(*output);
+            }
+
+            if (power_sampler) {
+                collectAndPrintPowerResults(*power_sampler, exe_time.count());
+            }
+
+            if (executionSettings->programSettings->launchLatencyRepetitions > 0 && mpi_comm_rank == 0) {
+                measureAndPrintLaunchLatency();
+            }
+
+            bool baselinePassed = true;
+            if (!executionSettings->programSettings->baselineFilePath.empty()) {
+                baselinePassed = compareToBaseline();
+            }
+
+            if (!executionSettings->programSettings->dumpFilePath.empty()) {
+                dumpResultsToJson(benchmarkTimes, validateSuccess);
+            }
+
+#ifdef HPCC_TRACING_RING
+            if (!executionSettings->programSettings->traceFilePath.empty()) {
+                writeHostTrace();
+            }
+#endif
 
-};
+            bool soakPassed = true;
+            if (executionSettings->programSettings->soakDuration > 0.0) {
+                soakPassed = executeSoak(data);
+            }
 
+            if (mpi_comm_rank == 0) {
+                if (!validateSuccess) {
+                    std::cerr << "ERROR: VALIDATION OF OUTPUT DATA FAILED!" << std::endl;
+                }
+                else {
+                    std::cout << "Validation: SUCCESS!" << std::endl;
+                }
+                if (!baselinePassed) {
+                    std::cerr << "ERROR: PERFORMANCE REGRESSION COMPARED TO BASELINE!" << std::endl;
+                }
+                if (!soakPassed) {
+                    std::cerr << "ERROR: VALIDATION FAILED DURING SOAK!" << std::endl;
+                }
+            }
 
-/**
- * @brief Settings class that is containing the program settings together with
- *          additional information about the OpenCL runtime
- * 
- * @tparam TSettings The program settings class that should be used (Must derive from BaseSettings)
- */
-template <class TSettings>
-class ExecutionSettings {
-public:
+            return validateSuccess && baselinePassed && soakPassed;
+       }
+       catch (const std::exception& e) {
+            std::cerr << "An error occured while executing the benchmark: " << std::endl;
+            std::cerr << "\t" << e.what() << std::endl;
+            return false;
+       }
+    }
+
+protected:
 
     /**
-     * @brief Pointer to the additional program settings
+     * @brief The used execution settings that will be generated by setupBenchmark().
+     *        It should be laos used by all other methods to read the current benchmark settings.
      * 
      */
-    std::unique_ptr<TSettings> programSettings;
+    std::unique_ptr<ExecutionSettings<TSettings>> executionSettings;
 
     /**
-     * @brief The OpenCL device that should be used for execution
+     * @brief Add additional options to the program parameter parser
      * 
+     * @param options The options object that will be used to parse the input parameters
      */
-    std::unique_ptr<cl::Device> device;
+    virtual void
+    addAdditionalParseOptions(cxxopts::Options &options) = 0;
+
 
     /**
-     * @brief The OpenCL context that should be used for execution
+     * @brief The communication rank of a MPI setup
      * 
      */
-    std::unique_ptr<cl::Context> context;
+    int mpi_comm_rank = 0;
 
     /**
-     * @brief The OpenCL program that contains the benchmark kernel
+     * @brief The size of the MPI communication world
      * 
      */
-    std::unique_ptr<cl::Program> program;
+    int mpi_comm_size = 1;
 
     /**
-     * @brief Construct a new Execution Settings object
+     * @brief This flag indicates if MPI was initialized before the object was constructed.
+     *          In this case, no finalization will be done by the destuctor of the object.
      * 
-     * @param programSettings_ Pointer to an existing program settings object that is derived from BaseSettings
-     * @param device_ Used OpenCL device
-     * @param context_ Used OpenCL context
-     * @param program_ Used OpenCL program
      */
-    ExecutionSettings(std::unique_ptr<TSettings> programSettings_, std::unique_ptr<cl::Device> device_, 
-                        std::unique_ptr<cl::Context> context_, std::unique_ptr<cl::Program> program_): 
-                                    programSettings(std::move(programSettings_)), device(std::move(device_)), 
-                                    context(std::move(context_)), program(std::move(program_)) {}
+    bool mpi_external_init = true;
 
     /**
-     * @brief Destroy the Execution Settings object. Used to specify the order the contained objects are destroyed 
-     *         to prevent segmentation faults during exit.
+     * @brief Raw measurement timings of the current MPI rank for every repetition, e.g. the kernel execution times.
+     *          The map should be filled by the benchmark during collectAndPrintResults() with the timings
+     *          before they are reduced over all MPI ranks. It will be cleared before every benchmark execution.
+     *          The timings of all ranks are written to the file given with the dump-json option.
      * 
      */
-    ~ExecutionSettings() {
-        program = nullptr;
-        context = nullptr;
-        device = nullptr;
-        programSettings = nullptr;
-    }
-
-};
-
-/**
- * @brief Base benchmark class. Every benchmark should be derived from this class and implement its abstract methods.
- * 
- * @tparam TSettings Class used to represent the program settings of the benchmark
- * @tparam TData Class used to represent the benchmark input and output data
- * @tparam TOutput Class representing the measurements like timings etc
- */
-template <class TSettings, class TData, class TOutput>
-class HpccFpgaBenchmark {
-
-private:
+    std::map<std::string, std::vector<double>> rawTimings;
 
     /**
-     * @brief This flag is set by the setupBenchmark() routine after successful setting up the benchmark.
-     *          It is used to prevent undefined behavior in the case executeBenchmark() is called without
-     *          a complete setup.
+     * @brief Metrics derived from the measurements like the achieved bandwidth or FLOPS.
+     *          The map should be filled by the benchmark during collectAndPrintResults() on rank 0.
+     *          The unit of the metric should be part of the key.
      * 
      */
-    bool benchmark_setup_succeeded = false;
-
-protected:
+    std::map<std::string, double> derivedMetrics;
 
     /**
-     * @brief The used execution settings that will be generated by setupBenchmark().
-     *        It should be laos used by all other methods to read the current benchmark settings.
+     * @brief Measure the latencies of kernel launches, user events and tiny transfers on the device of this rank
+     *          and print their statistics. The statistics are added to the derived metrics with the prefix "launch".
      * 
      */
-    std::unique_ptr<ExecutionSettings<TSettings>> executionSettings;
+    void
+    measureAndPrintLaunchLatency() {
+        auto kernel = createEmptyKernel();
+        auto latencies = measureLaunchLatency(*executionSettings->context, *executionSettings->device, kernel.get(),
+                                                executionSettings->programSettings->launchLatencyRepetitions);
+        if (!kernel) {
+            std::cout << "No empty kernel available in the bitstream, so the kernel launch latency is not measured." << std::endl;
+        }
+        std::map<std::string, std::vector<double>> named_latencies;
+        for (auto const& l : latencies) {
+            named_latencies["launch " + l.first] = l.second;
+        }
+        printTimingStatistics(named_latencies);
+    }
 
     /**
-     * @brief Add additional options to the program parameter parser
+     * @brief Print the median, percentiles and standard deviation of the given timings and add them to the derived metrics.
+     *          Should be called by the benchmarks in collectAndPrintResults() on rank 0 with the timings reduced over all ranks.
      * 
-     * @param options The options object that will be used to parse the input parameters
+     * @param timings Map of all timing series that should be printed. The key is used as name of the series.
      */
-    virtual void
-    addAdditionalParseOptions(cxxopts::Options &options) = 0;
+    void
+    printTimingStatistics(std::map<std::string, std::vector<double>> const& timings) {
+        std::cout << std::endl << std::setw(ENTRY_SPACE) << "Statistics" << std::setw(ENTRY_SPACE) << "median [s]"
+                << std::setw(ENTRY_SPACE) << "p5 [s]" << std::setw(ENTRY_SPACE) << "p95 [s]"
+                << std::setw(ENTRY_SPACE) << "stddev [s]" << std::setw(ENTRY_SPACE) << "repetitions" << std::endl;
+        for (auto const& t : timings) {
+            auto stats = calculateStatistics(t.second);
+            derivedMetrics[t.first + " median [s]"] = stats.median;
+            derivedMetrics[t.first + " p5 [s]"] = stats.p5;
+            derivedMetrics[t.first + " p95 [s]"] = stats.p95;
+            derivedMetrics[t.first + " stddev [s]"] = stats.stddev;
+            std::cout << std::setw(ENTRY_SPACE) << t.first << std::setw(ENTRY_SPACE) << stats.median
+                    << std::setw(ENTRY_SPACE) << stats.p5 << std::setw(ENTRY_SPACE) << stats.p95
+                    << std::setw(ENTRY_SPACE) << stats.stddev << std::setw(ENTRY_SPACE) << stats.count << std::endl;
+        }
+    }
 
+    /**
+     * @brief Get the kernel frequency used for the theoretical peak performance.
+     *          The OpenCL runtime does not report the frequency of the programmed bitstream, so if it is not given by
+     *          the user, the maximum clock frequency of the device is used.
+     * 
+     * @return double The kernel frequency in Hz or 0 if it is unknown
+     */
+    double
+    getKernelFrequency() const {
+        double frequency = executionSettings->programSettings->kernelFrequency;
+        if (frequency <= 0.0 && executionSettings->device) {
+            cl_uint max_clock = 0;
+            executionSettings->device->getInfo(CL_DEVICE_MAX_CLOCK_FREQUENCY, &max_clock);
+            frequency = max_clock;
+        }
+        return frequency * 1.0e6;
+    }
 
     /**
-     * @brief The communication rank of a MPI setup
+     * @brief Get the peak bandwidth of the global memory given by the program settings
      * 
+     * @return double The peak bandwidth in B/s or 0 if it is unknown
      */
-    int mpi_comm_rank = 0;
+    double
+    getMemoryPeak() const {
+        auto const& settings = *executionSettings->programSettings;
+        return calculateMemoryPeak(settings.memoryBanks, settings.memoryBankWidth, settings.memoryFrequency);
+    }
 
     /**
-     * @brief The size of the MPI communication world
+     * @brief Print the achieved efficiency compared to the theoretical peak performance and add the peak and efficiency to the derived metrics.
+     *          Should be called by the benchmarks in collectAndPrintResults() on rank 0. Entries with unknown peak performance are skipped.
      * 
+     * @param results Map of the measured performance in the given unit and the roofline of every measurement. The key is used as name of the measurement.
+     * @param unit The unit of the measured performance
+     * @param scale Factor to convert operations per second of the roofline to the unit
      */
-    int mpi_comm_size = 1;
+    void
+    printEfficiency(std::map<std::string, std::pair<double, Roofline>> const& results, std::string const& unit, double scale) {
+        bool header_printed = false;
+        for (auto const& r : results) {
+            double peak = r.second.second.attainable() * scale;
+            if (peak <= 0.0) {
+                continue;
+            }
+            if (!header_printed) {
+                std::cout << std::endl << std::setw(ENTRY_SPACE) << "Roofline" << std::setw(ENTRY_SPACE) << ("peak " + unit)
+                        << std::setw(ENTRY_SPACE) << "efficiency" << std::setw(ENTRY_SPACE) << "bound" << std::endl;
+                header_printed = true;
+            }
+            double efficiency = r.second.first / peak * 100.0;
+            derivedMetrics[r.first + " peak (" + unit + ")"] = peak;
+            derivedMetrics[r.first + " efficiency [%]"] = efficiency;
+            std::cout << std::setw(ENTRY_SPACE) << r.first << std::setw(ENTRY_SPACE) << peak
+                    << std::setw(ENTRY_SPACE - 2) << efficiency << " %" << std::setw(ENTRY_SPACE) << r.second.second.boundToString() << std::endl;
+        }
+    }
 
     /**
-     * @brief This flag indicates if MPI was initialized before the object was constructed.
-     *          In this case, no finalization will be done by the destuctor of the object.
+     * @brief Print the measured time and throughput of every used device and add them to the derived metrics.
+     *          Nothing is printed if only a single device is used. The work is distributed over the devices
+     *          according to the number of kernel replications executed on them.
      * 
+     * @param name Name of the measurement, e.g. the kernel name
+     * @param deviceTimings The timings of every repetition for every device of the rank
+     * @param work The total work done by all devices of the rank with a single repetition, e.g. the number of FLOP
+     * @param unit The unit of the throughput
      */
-    bool mpi_external_init = true;
+    void
+    printDeviceResults(std::string const& name, std::vector<std::vector<double>> const& deviceTimings, double work, std::string const& unit) {
+        if (deviceTimings.size() <= 1) {
+            return;
+        }
+        std::cout << std::endl << std::setw(ENTRY_SPACE) << name << std::setw(ENTRY_SPACE) << "best [s]"
+                << std::setw(ENTRY_SPACE) << unit << std::endl;
+        for (size_t d = 0; d < deviceTimings.size(); d++) {
+            if (deviceTimings[d].empty()) {
+                continue;
+            }
+            double best = *std::min_element(deviceTimings[d].begin(), deviceTimings[d].end());
+            double throughput = work * multi_device::getWorkFraction(d, deviceTimings.size(), executionSettings->programSettings->kernelReplications) / best;
+            derivedMetrics[name + " device " + std::to_string(d) + " best [s]"] = best;
+            derivedMetrics[name + " device " + std::to_string(d) + " " + unit] = throughput;
+            std::cout << std::setw(ENTRY_SPACE) << ("Device " + std::to_string(d)) << std::setw(ENTRY_SPACE) << best
+                    << std::setw(ENTRY_SPACE) << throughput << std::endl;
+        }
+    }
 
 public:
 
@@ -340,6 +1460,68 @@ public:
     virtual bool
     checkInputParameters() { return true;}
 
+    /**
+     * @brief Method that can be overwritten by inheriting classes to select the largest problem size that fits into the device memory.
+     *          It is called on all MPI ranks before checkInputParameters(), if the auto-size option is given.
+     *          The selected size has to fulfill all constraints of the benchmark and should be written to the program settings.
+     * 
+     * @param limits The memory limits of the devices. With MPI, the smallest limits of all ranks are used.
+     * @return true If a size was selected
+     * @return false If the automatic size selection is not supported for the used settings. The given size is used in this case.
+     */
+    virtual bool
+    setAutomaticSize(MemoryLimits const& limits) { return false;}
+
+    /**
+     * @brief Method that can be overwritten by inheriting classes to create a kernel of the bitstream
+     *          that finishes without any work, e.g. by setting its problem size to zero.
+     *          It is used to measure the kernel launch latency with the launch-latency option.
+     * 
+     * @return std::unique_ptr<cl::Kernel> The kernel with all arguments set or nullptr, if the bitstream contains no such kernel
+     */
+    virtual std::unique_ptr<cl::Kernel>
+    createEmptyKernel() { return nullptr;}
+
+    /**
+     * @brief Query the memory limits of the used devices and select the problem size with setAutomaticSize(),
+     *          if requested by the auto-size option. All MPI ranks need to call this method.
+     * 
+     */
+    void
+    applyAutomaticSize() {
+        auto& settings = *executionSettings->programSettings;
+        if (settings.autoSizeFraction <= 0.0) {
+            return;
+        }
+        // In test mode no device is selected, so the memory of the default device would be unknown
+        unsigned long long memory_info[2] = {0, 0};
+        if (executionSettings->device) {
+            memory_info[0] = executionSettings->device->getInfo<CL_DEVICE_GLOBAL_MEM_SIZE>();
+            memory_info[1] = executionSettings->device->getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>();
+        }
+#ifdef _USE_MPI_
+        MPI_Allreduce(MPI_IN_PLACE, memory_info, 2, MPI_UNSIGNED_LONG_LONG, MPI_MIN, MPI_COMM_WORLD);
+#endif
+        if (memory_info[0] == 0) {
+            if (mpi_comm_rank == 0) {
+                std::cerr << "WARNING: The device memory is unknown, so the given problem size is used." << std::endl;
+            }
+            return;
+        }
+        auto limits = calculateMemoryLimits(memory_info[0], memory_info[1], settings.numDevices, settings.memoryBanks,
+                                                !settings.useMemoryInterleaving, settings.autoSizeFraction);
+        bool selected = setAutomaticSize(limits);
+        if (mpi_comm_rank == 0) {
+            if (selected) {
+                std::cout << "Problem size selected for " << settings.autoSizeFraction * 100 << "% of "
+                        << static_cast<double>(memory_info[0]) << " Byte device memory" << std::endl;
+            }
+            else {
+                std::cerr << "WARNING: The problem size can not be selected automatically for the given settings. The given size is used." << std::endl;
+            }
+        }
+    }
+
     /**
     * Parses and returns program options using the cxxopts library.
     * The parsed parameters are depending on the benchmark that is implementing
@@ -367,12 +1549,24 @@ public:
         cxxopts::Options options(argv[0], ss.str());
         options.add_options()
                 ("f,file", "Kernel file name", cxxopts::value<std::string>())
-                ("n", "Number of repetitions",
+                ("n", "Number of repetitions. Minimum number of repetitions if a tolerance is given",
                 cxxopts::value<uint>()->default_value(std::to_string(DEFAULT_REPETITIONS)))
+                ("warmup", "Number of additional kernel executions before the measurement. Their timings are discarded",
+                cxxopts::value<uint>()->default_value("0"))
+                ("tolerance", "Repeat the kernel execution until the 95% confidence interval of the median execution time is within the given "\
+            "relative tolerance, e.g. 0.01 for 1%. Disabled, if 0",
+                cxxopts::value<double>()->default_value("0"))
+                ("max-repetitions", "Maximum number of repetitions if a tolerance is given",
+                cxxopts::value<uint>()->default_value("100"))
 #ifdef INTEL_FPGA
                 ("i", "Use memory Interleaving")
 #endif
                 ("skip-validation", "Skip the validation of the output data. This will speed up execution and helps when working with special data types.")
+                ("validation", "Validation mode: full, sampled or off. The sampled validation checks the result probabilistically, "\
+            "e.g. using random probes or the algorithm of Freivalds",
+                cxxopts::value<std::string>()->default_value("full"))
+                ("validation-error", "Maximum probability that a wrong result passes the sampled validation",
+                cxxopts::value<double>()->default_value("1e-6"))
                 ("device", "Index of the device that has to be used. If not given you "\
             "will be asked which device to use if there are multiple devices "\
             "available.", cxxopts::value<int>()->default_value(std::to_string(DEFAULT_DEVICE)))
@@ -380,6 +1574,10 @@ public:
             "you will be asked which platform to use if there are multiple "\
             "platforms available.",
                 cxxopts::value<int>()->default_value(std::to_string(DEFAULT_PLATFORM)))
+#ifdef MULTI_DEVICE_SUPPORT_ENABLED
+                ("num-devices", "Number of devices used by every MPI rank. The kernel replications are distributed over the devices starting with the given device index",
+                cxxopts::value<uint>()->default_value("1"))
+#endif
 #ifdef NUM_REPLICATIONS
                 ("r", "Number of used kernel replications",
                 cxxopts::value<cl_uint>()->default_value(std::to_string(NUM_REPLICATIONS)))
@@ -389,6 +1587,54 @@ public:
                 cxxopts::value<std::string>()->default_value(DEFAULT_COMM_TYPE))
 #endif
                 ("test", "Only test given configuration and skip execution and validation")
+                ("sweep", "Comma separated list of additional parameter sets. The benchmark is executed once for every set reusing the programmed device, "\
+            "e.g. --sweep=\"-s 1024,-s 2048\"",
+                cxxopts::value<std::vector<std::string>>())
+                ("dump-json", "Dump the settings and all measured timings of every rank to the given file in JSON format",
+                cxxopts::value<std::string>())
+                ("trace", "Enable OpenCL profiling and write the timeline of all enqueued commands to the given file in the Chrome trace format. "\
+            "With MPI, the rank is appended to the file name",
+                cxxopts::value<std::string>())
+                ("overlap-generation", "Generate the input data while the FPGA is programmed to reduce the time until the first kernel execution")
+                ("numa-node", "NUMA node used for the host buffers. If negative, the node the device is attached to is used if it can be determined",
+                cxxopts::value<int>()->default_value("-1"))
+                ("huge-pages", "Allocate the host buffers using huge pages")
+                ("pin-memory", "Lock the host buffers in physical memory")
+                ("power-source", "Sample the board power during the kernel execution and report the energy efficiency. "\
+            "Supported sources: fpgainfo, xbutil, hwmon:<path to power sensor>, cmd:<command printing the power in W>",
+                cxxopts::value<std::string>())
+                ("power-interval", "Time between two power samples in ms",
+                cxxopts::value<uint>()->default_value("100"))
+                ("kernel-frequency", "Kernel frequency in MHz used to calculate the theoretical peak performance, e.g. the fmax of the bitstream. "\
+            "If 0, the maximum clock frequency reported by the device is used",
+                cxxopts::value<double>()->default_value("0"))
+                ("memory-banks", "Number of global memory banks used to calculate the peak memory bandwidth. If 0, the memory bandwidth is not considered",
+                cxxopts::value<uint>()->default_value("0"))
+                ("memory-bank-width", "Number of bytes a single memory bank transfers per cycle",
+                cxxopts::value<double>()->default_value("64"))
+                ("memory-frequency", "Frequency of the memory interface in MHz",
+                cxxopts::value<double>()->default_value("0"))
+                ("baseline", "Compare the timings with the results of a previous execution written with dump-json. "\
+            "The benchmark fails, if the performance dropped significantly by more than the threshold",
+                cxxopts::value<std::string>())
+                ("baseline-threshold", "Maximum allowed relative performance drop compared to the baseline, e.g. 0.05 for 5%",
+                cxxopts::value<double>()->default_value("0.05"))
+                ("baseline-significance", "Maximum p-value of the Mann-Whitney U test for a significant performance drop",
+                cxxopts::value<double>()->default_value("0.05"))
+                ("auto-size", "Select the largest problem size that fits into the given fraction of the device memory, e.g. --auto-size=0.5. "\
+            "The given problem size is ignored in this case",
+                cxxopts::value<double>()->default_value("0")->implicit_value("0.8"))
+                ("launch-latency", "Measure the latency of kernel launches, user events and tiny transfers after the benchmark execution with the given number of repetitions",
+                cxxopts::value<uint>()->default_value("0")->implicit_value("100"))
+                ("soak", "Repeat the kernel execution for the given number of seconds after the benchmark execution without generating new input data",
+                cxxopts::value<double>()->default_value("0"))
+                ("soak-validation", "Generate the input data and validate the output every given number of soak iterations. 0 to skip the validation",
+                cxxopts::value<uint>()->default_value("10"))
+                ("soak-export", "Export the metrics of the soak run after every iteration to the given file in the Prometheus text format",
+                cxxopts::value<std::string>())
+                ("temperature-source", "Report the board temperature during the soak run. "\
+            "Supported sources: hwmon:<path to temperature sensor>, cmd:<command printing the temperature in °C>",
+                cxxopts::value<std::string>())
                 ("h,help", "Print this help");
 
 
@@ -467,31 +1713,74 @@ public:
             strcpy(tmp_argv[i], argv[i]);
         }
         tmp_argv[argc] = nullptr;
+        programArguments = std::vector<std::string>(argv, argv + argc);
+
+        setupStartTime = std::chrono::high_resolution_clock::now();
+        firstKernelExecuted = false;
+        pregeneratedData = nullptr;
 
         try {
+            HPCC_TRACE_REGION("setup");
 
             std::unique_ptr<TSettings> programSettings = parseProgramParameters(tmp_argc, tmp_argv);
 
             std::unique_ptr<cl::Context> context;
-            std::unique_ptr<cl::Program> program;
             std::unique_ptr<cl::Device> usedDevice;
+            std::vector<cl::Device> usedDevices;
 
+            auto setup_start = std::chrono::high_resolution_clock::now();
             if (!programSettings->testOnly) {
-                usedDevice = fpga_setup::selectFPGADevice(programSettings->defaultPlatform,
-                                                                    programSettings->defaultDevice);
-
-                context = std::unique_ptr<cl::Context>(new cl::Context(*usedDevice));
-                program = fpga_setup::fpgaSetup(context.get(), {*usedDevice},
-                                                                    &programSettings->kernelFileName);
+                if (programSettings->numDevices > programSettings->kernelReplications) {
+                    throw std::runtime_error("At least one kernel replication per device is required! Devices: " + std::to_string(programSettings->numDevices) 
+                                                + ", Replications: " + std::to_string(programSettings->kernelReplications));
+                }
+                usedDevices = fpga_setup::selectFPGADevices(programSettings->defaultPlatform,
+                                                                    programSettings->defaultDevice, programSettings->numDevices);
+                usedDevice = std::unique_ptr<cl::Device>(new cl::Device(usedDevices.front()));
+                // A single context is shared by all devices, so buffers can be accessed by all of them
+                context = fpga_setup::createContext(usedDevices);
             }
+            std::chrono::duration<double> setup_duration = std::chrono::high_resolution_clock::now() - setup_start;
 
             executionSettings = std::unique_ptr<ExecutionSettings<TSettings>>(new ExecutionSettings<TSettings>(std::move(programSettings), std::move(usedDevice), 
-                                                                    std::move(context), std::move(program)));
-            if (mpi_comm_rank == 0) {
-                if (!checkInputParameters()) {
-                    std::cerr << "ERROR: Input parameter check failed!" << std::endl;
-                    throw std::runtime_error("Input parameter check failed!");
+                                                                    std::move(context), nullptr));
+            if (!usedDevices.empty()) {
+                executionSettings->devices = usedDevices;
+            }
+            configureHostMemory();
+            applyAutomaticSize();
+            if (!checkInputParametersOnAllRanks()) {
+                throw std::runtime_error("Input parameter check failed!");
+            }
+
+            // The CPU backends do not use the bitstream, so the FPGA is not programmed
+            if (!executionSettings->programSettings->testOnly &&
+                    executionSettings->programSettings->communicationType != CommunicationType::cpu_only) {
+                bool overlap = executionSettings->programSettings->overlapGeneration;
+                std::chrono::duration<double> program_duration;
+                // Program the FPGA in a separate thread if the data generation should be overlapped.
+                // The generation stays on the calling thread, since it may use MPI.
+                // The rank used by the FPGA setup is queried here, so the thread does not make the first MPI call
+                fpga_setup::getWorldRank();
+                auto program_future = std::async(overlap ? std::launch::async : std::launch::deferred, [this, &program_duration]() {
+                    auto program_start = std::chrono::high_resolution_clock::now();
+                    auto program = fpga_setup::fpgaSetup(executionSettings->context.get(), executionSettings->devices,
+                                                                    &executionSettings->programSettings->kernelFileName);
+                    program_duration = std::chrono::high_resolution_clock::now() - program_start;
+                    return program;
+                });
+                if (overlap) {
+                    auto gen_start = std::chrono::high_resolution_clock::now();
+                    pregeneratedData = generateInputData();
+                    std::chrono::duration<double> gen_duration = std::chrono::high_resolution_clock::now() - gen_start;
+                    pregenerationTime = gen_duration.count();
                 }
+                executionSettings->program = program_future.get();
+                setup_duration += program_duration;
+            }
+            setupTime = setup_duration.count();
+
+            if (mpi_comm_rank == 0) {
                 printFinalConfiguration();
             }
         }
@@ -513,88 +1802,104 @@ public:
     }
 
     /**
-     * @brief Execute the benchmark. This includes the initialization of the 
-     *          input data, exectuon of the kernel, validation and printing the result
+     * @brief Create new program settings from the arguments given to setupBenchmark() extended by additional arguments.
+     *          The device, context and program of the current execution settings are kept, so the new settings
+     *          can be used without reprogramming the FPGA. 
+     *          Thus, it is not allowed to change the kernel file, platform or device with this method.
      * 
-     * @return true If the validation is a success
-     * @return false If the validation fails or an execution error occured
+     * @param additionalArguments Arguments that will be appended to the original program arguments.
+     *                              Later arguments overwrite earlier ones, e.g. {"-n", "5"} will change the number of repetitions.
+     * 
+     * @return true if the update was successful, false otherwise. The previous settings are kept in this case.
      */
     bool
-    executeBenchmark() {
-
+    updateProgramSettings(std::vector<std::string> const& additionalArguments) {
         if (!benchmark_setup_succeeded) {
-            std::cerr << "Benchmark execution started without successfully running the benchmark setup!" << std::endl;
+            std::cerr << "Program settings can not be updated without successfully running the benchmark setup!" << std::endl;
             return false;
         }
-        if (executionSettings->programSettings->testOnly) {
-            if (mpi_comm_rank == 0) {
-                std::cout << "TEST MODE ENABLED: SKIP DATA GENERATION, EXECUTION, AND VALIDATION!" << std::endl;
-                std::cout << "SUCCESSFULLY parsed input parameters!" << std::endl;
-            }
-            return benchmark_setup_succeeded;
-        }
-        if (mpi_comm_rank == 0) {
-            std::cout << HLINE << "Start benchmark using the given configuration. Generating data..." << std::endl
-                    << HLINE;
+        std::vector<std::string> arguments(programArguments);
+        arguments.insert(arguments.end(), additionalArguments.begin(), additionalArguments.end());
+        // cxxopts may modify the given arguments, so every call works on its own copy
+        std::vector<char*> tmp_argv;
+        for (auto& a : arguments) {
+            tmp_argv.push_back(&a[0]);
         }
-       try {
-            auto gen_start = std::chrono::high_resolution_clock::now();
-            std::unique_ptr<TData> data = generateInputData();
-            std::chrono::duration<double> gen_time = std::chrono::high_resolution_clock::now() - gen_start;
-            
-#ifdef _USE_MPI_
-            MPI_Barrier(MPI_COMM_WORLD);
-#endif
+        tmp_argv.push_back(nullptr);
 
-            if (mpi_comm_rank == 0) {
-                std::cout << "Generation Time: " << gen_time.count() << " s"  << std::endl;
-                std::cout << HLINE << "Execute benchmark kernel..." << std::endl
-                        << HLINE;
+        try {
+            std::unique_ptr<TSettings> programSettings = parseProgramParameters(static_cast<int>(arguments.size()), tmp_argv.data());
+
+            if (programSettings->kernelFileName != executionSettings->programSettings->kernelFileName ||
+                    programSettings->defaultPlatform != executionSettings->programSettings->defaultPlatform ||
+                    programSettings->defaultDevice != executionSettings->programSettings->defaultDevice ||
+                    programSettings->numDevices != executionSettings->programSettings->numDevices ||
+                    programSettings->testOnly != executionSettings->programSettings->testOnly) {
+                throw std::runtime_error("Kernel file, platform, devices and test mode can not be changed without a new benchmark setup!");
             }
-
-            bool validateSuccess = false;
-            auto exe_start = std::chrono::high_resolution_clock::now();
-            std::unique_ptr<TOutput> output =  executeKernel(*data);
-
-#ifdef _USE_MPI_
-        MPI_Barrier(MPI_COMM_WORLD);
-#endif
-
-            std::chrono::duration<double> exe_time = std::chrono::high_resolution_clock::now() - exe_start;
-
-            if (mpi_comm_rank == 0) {
-                std::cout << "Execution Time: " << exe_time.count() << " s"  << std::endl;
-                std::cout << HLINE << "Validate output..." << std::endl
-                        << HLINE;
+            if (!programSettings->testOnly && programSettings->numDevices > programSettings->kernelReplications) {
+                throw std::runtime_error("At least one kernel replication per device is required!");
             }
 
-            if (!executionSettings->programSettings->skipValidation) {
-                auto eval_start = std::chrono::high_resolution_clock::now();
-                validateSuccess = validateOutputAndPrintError(*data);
-                std::chrono::duration<double> eval_time = std::chrono::high_resolution_clock::now() - eval_start;
-
-                if (mpi_comm_rank == 0) {
-                    std::cout << "Validation Time: " << eval_time.count() << " s" << std::endl;
-                }
+            std::swap(executionSettings->programSettings, programSettings);
+            // Data that was generated in advance does not match the new settings
+            pregeneratedData = nullptr;
+            applyAutomaticSize();
+            if (!checkInputParametersOnAllRanks()) {
+                std::swap(executionSettings->programSettings, programSettings);
+                throw std::runtime_error("Input parameter check failed!");
             }
-            collectAndPrintResults(*output);
-
             if (mpi_comm_rank == 0) {
-                if (!validateSuccess) {
-                    std::cerr << "ERROR: VALIDATION OF OUTPUT DATA FAILED!" << std::endl;
-                }
-                else {
-                    std::cout << "Validation: SUCCESS!" << std::endl;
-                }
+                printFinalConfiguration();
             }
-
-            return validateSuccess;
-       }
-       catch (const std::exception& e) {
-            std::cerr << "An error occured while executing the benchmark: " << std::endl;
+            executionSettings->profiler->setEnabled(!executionSettings->programSettings->traceFilePath.empty());
+            configureHostMemory();
+        }
+        catch (std::exception& e) {
+            std::cerr << "An error occured while updating the program settings: " << std::endl;
             std::cerr << "\t" << e.what() << std::endl;
             return false;
-       }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Execute the benchmark. This includes the initialization of the 
+     *          input data, exectuon of the kernel, validation and printing the result.
+     *          If a parameter sweep is given with the sweep option, the benchmark is executed once for every
+     *          sweep configuration. Device, context and program are reused for all executions.
+     * 
+     * @return true If the validation is a success for all executions
+     * @return false If the validation fails or an execution error occured
+     */
+    bool
+    executeBenchmark() {
+
+        if (!benchmark_setup_succeeded) {
+            std::cerr << "Benchmark execution started without successfully running the benchmark setup!" << std::endl;
+            return false;
+        }
+        // Copy the sweep configurations since the program settings will be replaced during the sweep
+        std::vector<std::string> sweepConfigurations = executionSettings->programSettings->sweepConfigurations;
+        if (sweepConfigurations.empty()) {
+            return executeSingleBenchmark();
+        }
+        bool success = true;
+        for (const auto& config : sweepConfigurations) {
+            if (mpi_comm_rank == 0) {
+                std::cout << HLINE << "Sweep configuration: " << config << std::endl
+                        << HLINE;
+            }
+            std::istringstream config_stream(config);
+            std::vector<std::string> additionalArguments{std::istream_iterator<std::string>(config_stream), 
+                                                            std::istream_iterator<std::string>()};
+            if (!updateProgramSettings(additionalArguments)) {
+                success = false;
+                continue;
+            }
+            success = executeSingleBenchmark() && success;
+        }
+        return success;
     }
 
     /**
@@ -611,7 +1916,7 @@ public:
         int isMpiInitialized;
         MPI_Initialized(&isMpiInitialized);
         if (!isMpiInitialized) {
-            MPI_Init(&argc, &argv);
+            hpcc_base::initializeMPI(&argc, &argv);
             mpi_external_init = isMpiInitialized;
         }
         MPI_Comm_rank(MPI_COMM_WORLD, &mpi_comm_rank);
@@ -671,6 +1976,14 @@ std::ostream& operator<<(std::ostream& os, ExecutionSettings<TSettings> const& p
             os   << std::setw(2 * ENTRY_SPACE) << k.first << k.second << std::endl;
         }
         os  << std::setw(2 * ENTRY_SPACE) << "Device"  << device_name << std::endl;
+        for (size_t d = 1; d < printedExecutionSettings.devices.size(); d++) {
+            printedExecutionSettings.devices[d].getInfo(CL_DEVICE_NAME, &device_name);
+            os  << std::setw(2 * ENTRY_SPACE) << ("Device " + std::to_string(d))  << device_name << std::endl;
+        }
+        auto memory_config = host_memory::getConfiguration();
+        os  << std::setw(2 * ENTRY_SPACE) << "Host Memory" 
+            << (memory_config.numaNode >= 0 ? "NUMA node " + std::to_string(memory_config.numaNode) : std::string("Any NUMA node"))
+            << (memory_config.hugePages ? ", huge pages" : "") << (memory_config.pinned ? ", pinned" : "") << std::endl;
         os << std::right;
         return os;
 }
@@ -0,0 +1,180 @@
+/*
+Copyright (c) 2021 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHARED_HPCC_SUITE_HPP_
+#define SHARED_HPCC_SUITE_HPP_
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * This header must not include the parameters.h of a benchmark, since it is also used
+ * by the suite binary that links the host code of all benchmarks.
+ */
+
+namespace hpcc_base {
+
+namespace suite {
+
+/**
+ * @brief Result of a single benchmark execution within the suite
+ *
+ */
+struct BenchmarkResult {
+
+    /**
+     * @brief True, if the setup, execution and validation of the benchmark succeeded
+     *
+     */
+    bool success;
+
+    /**
+     * @brief Time in seconds from the construction of the benchmark until the end of the execution
+     *
+     */
+    double wallTime;
+};
+
+/**
+ * @brief A benchmark of the suite together with its input parameters
+ *
+ */
+struct SuiteEntry {
+
+    /**
+     * @brief Name of the benchmark, e.g. STREAM
+     *
+     */
+    std::string benchmark;
+
+    /**
+     * @brief Input parameters that are given to the benchmark
+     *
+     */
+    std::vector<std::string> arguments;
+};
+
+/**
+ * @brief Setup and execute a benchmark with the given input parameters.
+ *          MPI has to be initialized before, so it is not finalized by the benchmark.
+ *
+ * @tparam TBenchmark The benchmark class
+ * @param argc Number of input parameters
+ * @param argv The input parameters including the program name
+ * @return BenchmarkResult The result of the execution
+ */
+template<class TBenchmark>
+BenchmarkResult
+runBenchmark(int argc, char* argv[]) {
+    auto start = std::chrono::high_resolution_clock::now();
+    bool success = false;
+    try {
+        TBenchmark bm(argc, argv);
+        success = bm.executeBenchmark();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "An error occured while executing the benchmark: " << e.what() << std::endl;
+    }
+    std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+    return {success, duration.count()};
+}
+
+/**
+ * @brief Parse the configuration of the suite. Every line contains the name of a benchmark followed by its input parameters.
+ *          Empty lines and lines starting with # are ignored. The benchmarks are executed in the given order.
+ *
+ * @param config Stream with the configuration
+ * @return std::vector<SuiteEntry> The benchmarks of the suite
+ */
+inline std::vector<SuiteEntry>
+parseSuiteConfiguration(std::istream& config) {
+    std::vector<SuiteEntry> entries;
+    std::string line;
+    while (std::getline(config, line)) {
+        std::istringstream line_stream(line);
+        std::vector<std::string> tokens{std::istream_iterator<std::string>(line_stream), std::istream_iterator<std::string>()};
+        if (tokens.empty() || tokens.front()[0] == '#') {
+            continue;
+        }
+        entries.push_back({tokens.front(), std::vector<std::string>(tokens.begin() + 1, tokens.end())});
+    }
+    return entries;
+}
+
+/**
+ * @brief Write the combined report of all executed benchmarks in JSON format.
+ *          The results of the benchmarks are read from the files written with the dump-json option of every benchmark.
+ *
+ * @param fileName Name of the report file
+ * @param entries The executed benchmarks
+ * @param results The results of the benchmarks in the same order
+ * @param resultFiles The JSON files of the benchmarks in the same order. Missing files are reported as null.
+ * @return true if the report was written successfully
+ */
+inline bool
+writeSuiteReport(std::string const& fileName, std::vector<SuiteEntry> const& entries, std::vector<BenchmarkResult> const& results,
+                    std::vector<std::string> const& resultFiles) {
+    std::ofstream out(fileName);
+    if (!out.is_open()) {
+        std::cerr << "ERROR: Could not open file " << fileName << " to write the suite report!" << std::endl;
+        return false;
+    }
+    bool success = true;
+    out << "{" << std::endl << "  \"benchmarks\": [";
+    for (size_t i = 0; i < entries.size(); i++) {
+        std::ifstream result_file(resultFiles[i]);
+        std::string result_json((std::istreambuf_iterator<char>(result_file)), std::istreambuf_iterator<char>());
+        out << ((i > 0) ? "," : "") << std::endl << "    {" << std::endl;
+        out << "      \"benchmark\": \"" << entries[i].benchmark << "\"," << std::endl;
+        out << "      \"success\": " << (results[i].success ? "true" : "false") << "," << std::endl;
+        out << "      \"wall_time\": " << results[i].wallTime << "," << std::endl;
+        out << "      \"results\": " << (result_json.empty() ? "null" : result_json) << std::endl;
+        out << "    }";
+        success = success && results[i].success;
+    }
+    out << std::endl << "  ]," << std::endl;
+    out << "  \"success\": " << (success ? "true" : "false") << std::endl << "}" << std::endl;
+    return true;
+}
+
+} // namespace suite
+
+} // namespace hpcc_base
+
+/*
+ * Entry points of the benchmarks that are used by the suite.
+ * They are implemented in the host code of every benchmark.
+ */
+namespace stream { hpcc_base::suite::BenchmarkResult runSuiteBenchmark(int argc, char* argv[]); }
+namespace random_access { hpcc_base::suite::BenchmarkResult runSuiteBenchmark(int argc, char* argv[]); }
+namespace transpose { hpcc_base::suite::BenchmarkResult runSuiteBenchmark(int argc, char* argv[]); }
+namespace linpack { hpcc_base::suite::BenchmarkResult runSuiteBenchmark(int argc, char* argv[]); }
+namespace gemm { hpcc_base::suite::BenchmarkResult runSuiteBenchmark(int argc, char* argv[]); }
+namespace fft { hpcc_base::suite::BenchmarkResult runSuiteBenchmark(int argc, char* argv[]); }
+namespace network { hpcc_base::suite::BenchmarkResult runSuiteBenchmark(int argc, char* argv[]); }
+
+#endif
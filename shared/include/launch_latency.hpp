@@ -0,0 +1,142 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHARED_LAUNCH_LATENCY_HPP_
+#define SHARED_LAUNCH_LATENCY_HPP_
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+/* External library headers */
+#ifdef USE_DEPRECATED_HPP_HEADER
+#include "CL/cl.hpp"
+#else
+#include OPENCL_HPP_HEADER
+#endif
+
+#include "setup/fpga_setup.hpp"
+
+namespace hpcc_base {
+
+/**
+ * @brief Measure the latencies of the OpenCL operations that are used by all benchmarks: single work-item kernel launches,
+ *          the start of commands that wait for a user event and transfers of tiny buffers.
+ *          The kernel is optional, since not every bitstream contains a kernel that can be executed without work.
+ *          All measurements are given in seconds:
+ *
+ *          - kernel enqueue to start: Time between the enqueue of the kernel and its start on the device
+ *          - kernel start to end: Execution time of the kernel on the device
+ *          - kernel round trip: Host time of the enqueue of the kernel and the following finish()
+ *          - user event to completion: Host time from cl::UserEvent::setStatus() until a dependent command is completed.
+ *              The dependent command is the kernel or a tiny write, if no kernel is given.
+ *          - blocking write/read: Host time of a blocking transfer of the tiny buffer
+ *          - non-blocking write/read: Host time of a non-blocking transfer of the tiny buffer and the following finish()
+ *
+ * @param context The context of the device
+ * @param device The device that is used for the measurements
+ * @param kernel Kernel that finishes without work, e.g. because its problem size is set to zero. nullptr, if not available.
+ * @param repetitions Number of measurements for every latency
+ * @param bytes Size of the transferred buffer in bytes
+ * @return std::map<std::string, std::vector<double>> The measurements for every latency
+ */
+inline std::map<std::string, std::vector<double>>
+measureLaunchLatency(cl::Context const& context, cl::Device const& device, cl::Kernel* kernel, unsigned repetitions, size_t bytes = 64) {
+    int err;
+    cl::CommandQueue queue(context, device, CL_QUEUE_PROFILING_ENABLE, &err);
+    ASSERT_CL(err)
+    cl::Buffer buffer(context, CL_MEM_READ_WRITE, bytes, nullptr, &err);
+    ASSERT_CL(err)
+    std::vector<char> host_data(bytes, 0);
+
+    auto host_time = [](std::chrono::high_resolution_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    };
+
+    std::map<std::string, std::vector<double>> timings;
+    // The first execution of every command may include the initialization of the runtime, so it is not measured
+    for (unsigned r = 0; r <= repetitions; r++) {
+        bool measure = r > 0;
+        if (kernel != nullptr) {
+            cl::Event event;
+            auto start = std::chrono::high_resolution_clock::now();
+            ASSERT_CL(queue.enqueueNDRangeKernel(*kernel, cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, &event))
+            ASSERT_CL(queue.finish())
+            double round_trip = host_time(start);
+            if (measure) {
+                cl_ulong queued = event.getProfilingInfo<CL_PROFILING_COMMAND_QUEUED>();
+                cl_ulong kernel_start = event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+                cl_ulong kernel_end = event.getProfilingInfo<CL_PROFILING_COMMAND_END>();
+                timings["kernel enqueue to start"].push_back((kernel_start - queued) * 1.0e-9);
+                timings["kernel start to end"].push_back((kernel_end - kernel_start) * 1.0e-9);
+                timings["kernel round trip"].push_back(round_trip);
+            }
+        }
+
+        cl::UserEvent user_event(context, &err);
+        ASSERT_CL(err)
+        std::vector<cl::Event> wait_list{user_event};
+        cl::Event dependent;
+        if (kernel != nullptr) {
+            ASSERT_CL(queue.enqueueNDRangeKernel(*kernel, cl::NullRange, cl::NDRange(1), cl::NullRange, &wait_list, &dependent))
+        }
+        else {
+            ASSERT_CL(queue.enqueueWriteBuffer(buffer, CL_FALSE, 0, bytes, host_data.data(), &wait_list, &dependent))
+        }
+        ASSERT_CL(queue.flush())
+        auto trigger = std::chrono::high_resolution_clock::now();
+        ASSERT_CL(user_event.setStatus(CL_COMPLETE))
+        ASSERT_CL(dependent.wait())
+        double trigger_time = host_time(trigger);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        ASSERT_CL(queue.enqueueWriteBuffer(buffer, CL_TRUE, 0, bytes, host_data.data()))
+        double blocking_write = host_time(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        ASSERT_CL(queue.enqueueReadBuffer(buffer, CL_TRUE, 0, bytes, host_data.data()))
+        double blocking_read = host_time(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        ASSERT_CL(queue.enqueueWriteBuffer(buffer, CL_FALSE, 0, bytes, host_data.data()))
+        ASSERT_CL(queue.finish())
+        double non_blocking_write = host_time(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        ASSERT_CL(queue.enqueueReadBuffer(buffer, CL_FALSE, 0, bytes, host_data.data()))
+        ASSERT_CL(queue.finish())
+        double non_blocking_read = host_time(start);
+
+        if (measure) {
+            timings["user event to completion"].push_back(trigger_time);
+            timings["blocking write"].push_back(blocking_write);
+            timings["blocking read"].push_back(blocking_read);
+            timings["non-blocking write"].push_back(non_blocking_write);
+            timings["non-blocking read"].push_back(non_blocking_read);
+        }
+    }
+    return timings;
+}
+
+}
+
+#endif
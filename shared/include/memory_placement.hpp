@@ -0,0 +1,151 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHARED_MEMORY_PLACEMENT_HPP_
+#define SHARED_MEMORY_PLACEMENT_HPP_
+
+#include <map>
+#include <stdexcept>
+#include <string>
+
+/* External library headers */
+#ifdef USE_DEPRECATED_HPP_HEADER
+#include "CL/cl.hpp"
+#else
+#include OPENCL_HPP_HEADER
+#endif
+
+namespace hpcc_base {
+
+/**
+ * @brief Placement policies for the device buffers of the kernel replications on boards with multiple memory banks.
+ *          The banks are selected with the memory bank bits of the Intel FPGA SDK for OpenCL, which are only used
+ *          if the bitstream is compiled without memory interleaving. For HBM, the pseudo-channels are selected
+ *          by the kernel attributes instead, and for Xilinx by the bank assignment when the bitstream is linked.
+ *
+ */
+namespace memory_placement {
+
+/**
+ * @brief The available placement policies
+ *
+ */
+typedef enum _Policy {
+
+    /**
+     * @brief Every buffer of a replication is placed in its own bank. The same buffer of all replications shares a bank.
+     *
+     */
+    buffer,
+
+    /**
+     * @brief All buffers of a replication are placed in the same bank and every replication uses a different bank
+     *
+     */
+    replication,
+
+    /**
+     * @brief The buffers of all replications are distributed round-robin over all banks,
+     *          so every replication uses as many banks as it has buffers
+     *
+     */
+    striped,
+
+    /**
+     * @brief No bank is selected, so the runtime decides about the placement.
+     *          With memory interleaving, every buffer is striped over all banks.
+     *
+     */
+    interleaved
+
+} Policy;
+
+static const std::map<const std::string, Policy> policy_to_str_map{
+    {"BUFFER", Policy::buffer},
+    {"REPLICATION", Policy::replication},
+    {"STRIPED", Policy::striped},
+    {"INTERLEAVED", Policy::interleaved}
+    };
+
+/**
+ * @brief Maximum number of banks that can be selected with the three memory bank bits
+ *
+ */
+static constexpr unsigned MAX_BANKS = 7;
+
+/**
+ * @brief Serializes a placement policy into a string that can be converted back with retrievePolicy
+ *
+ * @param p The placement policy
+ * @return std::string String representation of the policy
+ */
+static std::string
+policyToString(Policy p) {
+    for (auto& entry : policy_to_str_map) {
+        if (entry.second == p) {
+            return entry.first;
+        }
+    }
+    throw std::runtime_error("Memory placement policy could not be converted to string!");
+}
+
+/**
+ * @brief Deserializes a string into a placement policy
+ *
+ * @param name String representation of the policy
+ * @return Policy The placement policy. Will throw a runtime error if the string is not a valid policy.
+ */
+static Policy
+retrievePolicy(std::string const& name) {
+    auto result = policy_to_str_map.find(name);
+    if (result != policy_to_str_map.end()) {
+        return result->second;
+    }
+    throw std::runtime_error("Memory placement policy could not be converted from string: " + name);
+}
+
+/**
+ * @brief Get the memory flags that place a buffer of a kernel replication in a memory bank
+ *
+ * @param policy The placement policy
+ * @param replication The kernel replication the buffer belongs to
+ * @param buffer Index of the buffer within the replication
+ * @param buffers Number of buffers of a replication
+ * @param banks Number of available memory banks. Has to be between 1 and MAX_BANKS.
+ * @return cl_mem_flags The memory bank bits that have to be added to the flags of the buffer
+ */
+inline cl_mem_flags
+getBankFlags(Policy policy, unsigned replication, unsigned buffer, unsigned buffers, unsigned banks) {
+    unsigned bank;
+    switch (policy) {
+        case Policy::buffer: bank = buffer; break;
+        case Policy::replication: bank = replication; break;
+        case Policy::striped: bank = replication * buffers + buffer; break;
+        default: return 0;
+    }
+    return static_cast<cl_mem_flags>((bank % banks) + 1) << 16;
+}
+
+} // namespace memory_placement
+
+} // namespace hpcc_base
+
+#endif // SHARED_MEMORY_PLACEMENT_HPP_
@@ -0,0 +1,132 @@
+/*
+Copyright (c) 2021 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHARED_MULTI_DEVICE_HPP_
+#define SHARED_MULTI_DEVICE_HPP_
+
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+/* External library headers */
+#ifdef USE_DEPRECATED_HPP_HEADER
+#include "CL/cl.hpp"
+#else
+#include OPENCL_HPP_HEADER
+#endif
+
+namespace hpcc_base {
+
+/**
+ * @brief Helper functions to wait for kernel replications that are distributed over multiple devices.
+ *          Kernel replication r is always executed on device r % numDevices.
+ *
+ */
+namespace multi_device {
+
+/**
+ * @brief Wait for all devices with one host thread per device and measure the time until every device finished
+ *
+ * @param numDevices Number of used devices
+ * @param start Time the execution was started
+ * @param waitForDevice Function that blocks until all work of the given device index is done
+ * @return std::vector<double> The time in seconds from start until every device finished
+ */
+inline std::vector<double>
+waitForDevices(size_t numDevices, std::chrono::time_point<std::chrono::high_resolution_clock> start,
+                std::function<void(size_t)> const& waitForDevice) {
+    std::vector<double> deviceTimes(numDevices);
+    auto wait = [&](size_t d) {
+        waitForDevice(d);
+        std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+        deviceTimes[d] = duration.count();
+    };
+    if (numDevices == 1) {
+        // No additional thread is required for a single device
+        wait(0);
+        return deviceTimes;
+    }
+    std::vector<std::thread> threads;
+    for (size_t d = 0; d < numDevices; d++) {
+        threads.emplace_back(wait, d);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    return deviceTimes;
+}
+
+/**
+ * @brief Finish the command queues of all kernel replications
+ *
+ * @param queues The command queues. Queue r belongs to kernel replication r.
+ * @param numDevices Number of used devices
+ * @param start Time the execution was started
+ * @return std::vector<double> The time in seconds from start until every device finished
+ */
+inline std::vector<double>
+finishQueues(std::vector<cl::CommandQueue>& queues, size_t numDevices,
+                std::chrono::time_point<std::chrono::high_resolution_clock> start) {
+    return waitForDevices(numDevices, start, [&queues, numDevices](size_t d) {
+        for (size_t r = d; r < queues.size(); r += numDevices) {
+            queues[r].finish();
+        }
+    });
+}
+
+/**
+ * @brief Wait for the events of all kernel replications
+ *
+ * @param events The events of the kernels. Event r belongs to kernel replication r.
+ * @param numDevices Number of used devices
+ * @param start Time the execution was started
+ * @return std::vector<double> The time in seconds from start until every device finished
+ */
+inline std::vector<double>
+waitForEvents(std::vector<cl::Event>& events, size_t numDevices,
+                std::chrono::time_point<std::chrono::high_resolution_clock> start) {
+    return waitForDevices(numDevices, start, [&events, numDevices](size_t d) {
+        for (size_t r = d; r < events.size(); r += numDevices) {
+            events[r].wait();
+        }
+    });
+}
+
+/**
+ * @brief Get the fraction of the total work that is done by a device
+ *
+ * @param device Index of the device
+ * @param numDevices Number of used devices
+ * @param kernelReplications Total number of kernel replications
+ * @return double Fraction of the kernel replications executed on the device
+ */
+inline double
+getWorkFraction(size_t device, size_t numDevices, size_t kernelReplications) {
+    size_t replications = kernelReplications / numDevices + ((device < kernelReplications % numDevices) ? 1 : 0);
+    return static_cast<double>(replications) / kernelReplications;
+}
+
+} // namespace multi_device
+
+}
+
+#endif
@@ -0,0 +1,420 @@
+/*
+Copyright (c) 2021 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHARED_POWER_SAMPLER_HPP_
+#define SHARED_POWER_SAMPLER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace hpcc_base {
+
+/**
+ * @brief Interface for a source of power measurements, e.g. a sensor of the FPGA board
+ *
+ */
+class PowerSource {
+
+public:
+
+    /**
+     * @brief Read the current power
+     *
+     * @return double The current power in W. Negative if the sensor could not be read.
+     */
+    virtual double
+    readPower() = 0;
+
+    /**
+     * @brief Get a name of the source that is printed in the benchmark summary
+     *
+     * @return std::string The name of the source
+     */
+    virtual std::string
+    getName() const = 0;
+
+    virtual ~PowerSource() = default;
+};
+
+/**
+ * @brief Reads the power from a hwmon sensor in sysfs, e.g. /sys/class/hwmon/hwmon2/power1_input.
+ *          The file has to contain the power in µW. Other sensors can be read with a different scale, e.g. temperatures in m°C.
+ *
+ */
+class HwmonPowerSource : public PowerSource {
+
+private:
+
+    std::string sensorPath;
+
+    /**
+     * @brief Factor to convert the value of the sensor file to the reported unit
+     *
+     */
+    double scale;
+
+public:
+
+    explicit HwmonPowerSource(std::string const& path, double scale_ = 1.0e-6) : sensorPath(path), scale(scale_) {}
+
+    double
+    readPower() override {
+        std::ifstream sensor(sensorPath);
+        double value = -1.0;
+        if (!(sensor >> value)) {
+            return -1.0;
+        }
+        return value * scale;
+    }
+
+    std::string
+    getName() const override {
+        return "hwmon " + sensorPath;
+    }
+};
+
+/**
+ * @brief Executes a shell command for every sample and extracts the power from its output
+ *
+ */
+class CommandPowerSource : public PowerSource {
+
+private:
+
+    std::string command;
+
+    /**
+     * @brief Function that calculates the power in W from the output of the command
+     *
+     */
+    std::function<double(std::string const&)> parseOutput;
+
+public:
+
+    CommandPowerSource(std::string const& command_, std::function<double(std::string const&)> parseOutput_)
+                : command(command_), parseOutput(parseOutput_) {}
+
+    double
+    readPower() override {
+        FILE* pipe = popen(command.c_str(), "r");
+        if (pipe == nullptr) {
+            return -1.0;
+        }
+        std::string output;
+        char buffer[256];
+        while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
+            output += buffer;
+        }
+        if (pclose(pipe) != 0) {
+            return -1.0;
+        }
+        return parseOutput(output);
+    }
+
+    std::string
+    getName() const override {
+        return command;
+    }
+};
+
+namespace power_parsers {
+
+/**
+ * @brief Use the first number in the output as power in W
+ *
+ * @param output Output of the command
+ * @return double The power in W or -1 if no number was found
+ */
+inline double
+firstNumber(std::string const& output) {
+    std::smatch match;
+    if (std::regex_search(output, match, std::regex("[-+]?[0-9]*\\.?[0-9]+([eE][-+]?[0-9]+)?"))) {
+        return std::stod(match.str());
+    }
+    return -1.0;
+}
+
+/**
+ * @brief Parse the output of the fpgainfo power command of the Intel OPAE tools.
+ *          The current and voltage of every rail are multiplied and summed up, the same way as it was done
+ *          by scripts/power_measurements/pac_s10_dc.fpgainfo.sh.
+ *
+ * @param output Output of fpgainfo power
+ * @return double The power in W or -1 if no values were found
+ */
+inline double
+fpgainfo(std::string const& output) {
+    std::regex value_regex(":\\s*([0-9]+\\.?[0-9]*)\\s*(Amps|Volts)");
+    double power = 0.0;
+    double amps = -1.0;
+    bool found = false;
+    for (auto it = std::sregex_iterator(output.begin(), output.end(), value_regex); it != std::sregex_iterator(); it++) {
+        double value = std::stod((*it)[1].str());
+        if ((*it)[2].str() == "Amps") {
+            amps = value;
+        }
+        else if (amps >= 0.0) {
+            power += amps * value;
+            amps = -1.0;
+            found = true;
+        }
+    }
+    return found ? power : -1.0;
+}
+
+/**
+ * @brief Parse the electrical report of the xbutil command of XRT
+ *
+ * @param output Output of xbutil examine -r electrical
+ * @return double The power in W or -1 if no value was found
+ */
+inline double
+xbutil(std::string const& output) {
+    std::smatch match;
+    if (std::regex_search(output, match, std::regex("Power\\s*:\\s*([0-9]+\\.?[0-9]*)\\s*Watts"))) {
+        return std::stod(match[1].str());
+    }
+    return -1.0;
+}
+
+} // namespace power_parsers
+
+/**
+ * @brief Create a power source from the given description
+ *
+ * @param spec One of "fpgainfo", "xbutil", "hwmon:<path to sensor file>" or "cmd:<command printing the power in W>"
+ * @return std::unique_ptr<PowerSource> The created source
+ * @throws std::runtime_error if the description is unknown
+ */
+inline std::unique_ptr<PowerSource>
+createPowerSource(std::string const& spec) {
+    if (spec == "fpgainfo") {
+        return std::unique_ptr<PowerSource>(new CommandPowerSource("fpgainfo power 2>/dev/null", power_parsers::fpgainfo));
+    }
+    if (spec == "xbutil") {
+        return std::unique_ptr<PowerSource>(new CommandPowerSource("xbutil examine -r electrical 2>/dev/null", power_parsers::xbutil));
+    }
+    if (spec.compare(0, 6, "hwmon:") == 0) {
+        return std::unique_ptr<PowerSource>(new HwmonPowerSource(spec.substr(6)));
+    }
+    if (spec.compare(0, 4, "cmd:") == 0) {
+        return std::unique_ptr<PowerSource>(new CommandPowerSource(spec.substr(4), power_parsers::firstNumber));
+    }
+    throw std::runtime_error("Unknown power source: " + spec + ". Use fpgainfo, xbutil, hwmon:<path> or cmd:<command>");
+}
+
+/**
+ * @brief Samples a power source in a separate thread while the benchmark kernel is executed
+ *
+ */
+class PowerSampler {
+
+private:
+
+    std::unique_ptr<PowerSource> source;
+
+    std::chrono::milliseconds interval;
+
+    /**
+     * @brief Time of every valid sample in seconds since the start of the sampling and the measured power in W
+     *
+     */
+    std::vector<std::pair<double, double>> samples;
+
+    std::chrono::time_point<std::chrono::high_resolution_clock> startTime;
+
+    double duration = 0.0;
+
+    bool running = false;
+
+    std::mutex samplerMutex;
+
+    std::condition_variable stopCondition;
+
+    std::thread samplerThread;
+
+    void
+    takeSample() {
+        double power = source->readPower();
+        std::chrono::duration<double> time = std::chrono::high_resolution_clock::now() - startTime;
+        if (power >= 0.0) {
+            samples.emplace_back(time.count(), power);
+        }
+    }
+
+public:
+
+    /**
+     * @brief Construct a new Power Sampler object
+     *
+     * @param source_ The used power source
+     * @param interval_ The time between two samples
+     */
+    PowerSampler(std::unique_ptr<PowerSource> source_, std::chrono::milliseconds interval_)
+                : source(std::move(source_)), interval(interval_) {}
+
+    /**
+     * @brief Start sampling. The first sample is taken immediately.
+     *
+     */
+    void
+    start() {
+        samples.clear();
+        startTime = std::chrono::high_resolution_clock::now();
+        running = true;
+        samplerThread = std::thread([this]() {
+            std::unique_lock<std::mutex> lock(samplerMutex);
+            while (running) {
+                takeSample();
+                stopCondition.wait_for(lock, interval, [this]() { return !running; });
+            }
+        });
+    }
+
+    /**
+     * @brief Stop sampling and take a last sample
+     *
+     */
+    void
+    stop() {
+        {
+            std::lock_guard<std::mutex> lock(samplerMutex);
+            running = false;
+        }
+        stopCondition.notify_all();
+        if (samplerThread.joinable()) {
+            samplerThread.join();
+        }
+        std::chrono::duration<double> time = std::chrono::high_resolution_clock::now() - startTime;
+        duration = time.count();
+        takeSample();
+    }
+
+    /**
+     * @brief Get the valid samples of the last sampling period
+     *
+     * @return std::vector<std::pair<double, double>> const& time in s since the start and power in W of every sample
+     */
+    std::vector<std::pair<double, double>> const&
+    getSamples() const {
+        return samples;
+    }
+
+    /**
+     * @brief Get the average power of the last sampling period. The samples are weighted by time using the trapezoidal rule.
+     *
+     * @return double The average power in W or -1 if no valid sample was taken
+     */
+    double
+    getAveragePower() const {
+        if (samples.empty()) {
+            return -1.0;
+        }
+        double total_time = samples.back().first - samples.front().first;
+        if (samples.size() == 1 || total_time <= 0.0) {
+            double sum = 0.0;
+            for (auto const& s : samples) {
+                sum += s.second;
+            }
+            return sum / samples.size();
+        }
+        double energy = 0.0;
+        for (size_t i = 1; i < samples.size(); i++) {
+            energy += 0.5 * (samples[i].second + samples[i - 1].second) * (samples[i].first - samples[i - 1].first);
+        }
+        return energy / total_time;
+    }
+
+    /**
+     * @brief Get the duration of the last sampling period
+     *
+     * @return double the duration in s
+     */
+    double
+    getDuration() const {
+        return duration;
+    }
+
+    std::string
+    getSourceName() const {
+        return source->getName();
+    }
+
+    ~PowerSampler() {
+        if (samplerThread.joinable()) {
+            stop();
+        }
+    }
+};
+
+/**
+ * @brief Calculate the energy efficiency for all throughput metrics of a benchmark.
+ *          The unit of a metric is detected from its name: GFLOPS, GUOPS or a unit in brackets, e.g. [MB/s].
+ *          Bandwidths are converted to GB/s/W. Metrics of single devices are skipped, since the power is measured for all devices of a rank.
+ *
+ * @param derivedMetrics The metrics calculated by the benchmark
+ * @param power The average power of all ranks in W
+ * @return std::map<std::string, double> The efficiency metrics that can be added to the derived metrics
+ */
+inline std::map<std::string, double>
+calculateEnergyEfficiency(std::map<std::string, double> const& derivedMetrics, double power) {
+    // Suffix of the metric name, the new suffix and conversion factor
+    static const std::vector<std::pair<std::string, std::pair<std::string, double>>> conversions = {
+        {"GFLOPS", {"GFLOPS/W", 1.0}},
+        {"GUOPS", {"GUOPS/W", 1.0}},
+        {"[FLOPS]", {"[GFLOPS/W]", 1.0e-9}},
+        {"[MB/s]", {"[GB/s/W]", 1.0e-3}},
+        {"[B/s]", {"[GB/s/W]", 1.0e-9}}
+    };
+    std::map<std::string, double> efficiency;
+    if (power <= 0.0) {
+        return efficiency;
+    }
+    for (auto const& m : derivedMetrics) {
+        if (m.first.find(" device ") != std::string::npos) {
+            continue;
+        }
+        for (auto const& c : conversions) {
+            if (m.first.size() >= c.first.size() &&
+                    m.first.compare(m.first.size() - c.first.size(), c.first.size(), c.first) == 0) {
+                efficiency[m.first.substr(0, m.first.size() - c.first.size()) + c.second.first] = m.second * c.second.second / power;
+                break;
+            }
+        }
+    }
+    return efficiency;
+}
+
+}
+
+#endif
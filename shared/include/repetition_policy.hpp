@@ -0,0 +1,297 @@
+/*
+Copyright (c) 2021 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHARED_REPETITION_POLICY_HPP_
+#define SHARED_REPETITION_POLICY_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#ifdef _USE_MPI_
+#include "mpi.h"
+#endif
+
+namespace hpcc_base {
+
+/**
+ * @brief Summary statistics of a series of measured timings
+ *
+ */
+struct TimingStatistics {
+    double min;
+    double max;
+    double mean;
+    double median;
+    double p5;
+    double p95;
+    double stddev;
+    size_t count;
+};
+
+/**
+ * @brief Calculate a percentile of sorted values using linear interpolation between the closest ranks
+ *
+ * @param sorted Values in ascending order. Must not be empty.
+ * @param p The percentile in the range [0,1]
+ * @return double The interpolated percentile
+ */
+inline double
+percentile(std::vector<double> const& sorted, double p) {
+    double pos = p * static_cast<double>(sorted.size() - 1);
+    size_t lower = static_cast<size_t>(std::floor(pos));
+    size_t upper = std::min(lower + 1, sorted.size() - 1);
+    return sorted[lower] + (pos - static_cast<double>(lower)) * (sorted[upper] - sorted[lower]);
+}
+
+/**
+ * @brief Calculate the summary statistics of the given timings
+ *
+ * @param values The measured timings
+ * @return TimingStatistics The statistics. All values are NaN if no timings are given.
+ */
+inline TimingStatistics
+calculateStatistics(std::vector<double> values) {
+    if (values.empty()) {
+        return {NAN, NAN, NAN, NAN, NAN, NAN, NAN, 0};
+    }
+    std::sort(values.begin(), values.end());
+    double mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+    double square_sum = 0.0;
+    for (double v : values) {
+        square_sum += (v - mean) * (v - mean);
+    }
+    double stddev = values.size() > 1 ? std::sqrt(square_sum / (values.size() - 1)) : 0.0;
+    return {values.front(), values.back(), mean, percentile(values, 0.5), percentile(values, 0.05),
+            percentile(values, 0.95), stddev, values.size()};
+}
+
+/**
+ * @brief Check if the 95% confidence interval of the median of the given timings is within the tolerance.
+ *          The distribution free confidence interval based on order statistics is used, so no assumptions
+ *          on the distribution of the timings are made. At least 6 values are required.
+ *
+ * @param values The measured timings
+ * @param tolerance Maximum allowed distance of the interval bounds from the median relative to the median
+ * @return true if both bounds of the confidence interval are within the tolerance
+ */
+inline bool
+medianConfidenceWithin(std::vector<double> values, double tolerance) {
+    if (values.size() < 6) {
+        return false;
+    }
+    std::sort(values.begin(), values.end());
+    double n = static_cast<double>(values.size());
+    // 1-based ranks of the interval bounds for a confidence level of 95%
+    long lower_rank = std::max(1l, static_cast<long>(std::floor(0.5 * n - 0.98 * std::sqrt(n))));
+    long upper_rank = std::min(static_cast<long>(values.size()), static_cast<long>(std::ceil(1 + 0.5 * n + 0.98 * std::sqrt(n))));
+    double median = percentile(values, 0.5);
+    return (median - values[lower_rank - 1]) <= tolerance * median && (values[upper_rank - 1] - median) <= tolerance * median;
+}
+
+/**
+ * @brief Decides how often the benchmark kernel is executed.
+ *          By default, the number of repetitions given in the program settings is executed.
+ *          Additionally, warmup repetitions can be executed before the measurement. The execution types have to discard their timings
+ *          with discardWarmup().
+ *          If a tolerance is given, the kernel is repeated until the 95% confidence interval of the median
+ *          is within the tolerance or the maximum number of repetitions is reached.
+ *          With MPI, all ranks continue as long as one rank did not reach the tolerance, so they execute the same number of repetitions.
+ *
+ * Usage in the execution types:
+ *
+ *     config.repetitions->start(*config.programSettings);
+ *     for (uint r = 0; config.repetitions->next(timings); r++) {
+ *         ...
+ *         timings.push_back(measured_time);
+ *     }
+ *     config.repetitions->discardWarmup(timings);
+ *
+ */
+class RepetitionPolicy {
+
+private:
+
+    /**
+     * @brief Number of repetitions that are executed before the measurement and discarded
+     *
+     */
+    uint warmupRepetitions = 0;
+
+    /**
+     * @brief Number of measured repetitions that are executed in any case
+     *
+     */
+    uint minRepetitions = 1;
+
+    /**
+     * @brief Maximum number of measured repetitions if a tolerance is given
+     *
+     */
+    uint maxRepetitions = 1;
+
+    /**
+     * @brief Maximum relative half-width of the 95% confidence interval of the median, e.g. 0.01 for 1% of the median.
+     *          0 disables the adaptive repetitions.
+     *
+     */
+    double tolerance = 0.0;
+
+    /**
+     * @brief Number of started repetitions including the warmup
+     *
+     */
+    uint executedRepetitions = 0;
+
+    /**
+     * @brief Point in time when the first repetition was finished, i.e. when next() was called after it.
+     *          Only valid if firstRepetitionFinished is true.
+     *
+     */
+    std::chrono::time_point<std::chrono::high_resolution_clock> firstRepetitionEnd;
+
+    /**
+     * @brief True, if the end of the first repetition was recorded in firstRepetitionEnd since the last call of start()
+     *
+     */
+    bool firstRepetitionFinished = false;
+
+public:
+
+    /**
+     * @brief Start a new measurement with the given settings
+     *
+     * @tparam TSettings Program settings class derived from BaseSettings
+     * @param settings The program settings containing the repetition configuration
+     */
+    template<class TSettings>
+    void
+    start(TSettings const& settings) {
+        warmupRepetitions = settings.warmupRepetitions;
+        minRepetitions = settings.numRepetitions;
+        maxRepetitions = std::max(settings.numRepetitions, settings.maxRepetitions);
+        tolerance = settings.repetitionTolerance;
+        executedRepetitions = 0;
+        firstRepetitionFinished = false;
+    }
+
+    /**
+     * @brief Check if the number of repetitions depends on the measured timings
+     *
+     * @return true if a tolerance is given
+     */
+    bool
+    isAdaptive() const {
+        return tolerance > 0.0 && maxRepetitions > minRepetitions;
+    }
+
+    /**
+     * @brief Decide if another repetition should be executed. Has to be called before every repetition.
+     *
+     * @param timings The timings measured so far including the warmup. They are used to decide if the tolerance is reached.
+     * @return true if another repetition should be executed
+     */
+    bool
+    next(std::vector<double> const& timings) {
+        if (executedRepetitions == 1 && !firstRepetitionFinished) {
+            firstRepetitionEnd = std::chrono::high_resolution_clock::now();
+            firstRepetitionFinished = true;
+        }
+        if (executedRepetitions < warmupRepetitions + minRepetitions) {
+            executedRepetitions++;
+            return true;
+        }
+        if (!isAdaptive() || executedRepetitions >= warmupRepetitions + maxRepetitions) {
+            return false;
+        }
+        auto first_measurement = timings.begin() + std::min(timings.size(), static_cast<size_t>(warmupRepetitions));
+        int repeat = medianConfidenceWithin(std::vector<double>(first_measurement, timings.end()), tolerance) ? 0 : 1;
+#ifdef _USE_MPI_
+        int mpi_initialized;
+        MPI_Initialized(&mpi_initialized);
+        if (mpi_initialized) {
+            MPI_Allreduce(MPI_IN_PLACE, &repeat, 1, MPI_INT, MPI_LOR, MPI_COMM_WORLD);
+        }
+#endif
+        if (repeat) {
+            executedRepetitions++;
+        }
+        return repeat;
+    }
+
+    /**
+     * @brief Check if the current repetition is a warmup repetition
+     *
+     * @return true if the timings of the current repetition will be discarded
+     */
+    bool
+    isWarmup() const {
+        return executedRepetitions <= warmupRepetitions;
+    }
+
+    /**
+     * @brief Remove the timings of the warmup repetitions
+     *
+     * @param timings Timings of all executed repetitions
+     */
+    void
+    discardWarmup(std::vector<double>& timings) const {
+        timings.erase(timings.begin(), timings.begin() + std::min(timings.size(), static_cast<size_t>(warmupRepetitions)));
+    }
+
+    /**
+     * @brief Get the number of executed repetitions including the warmup.
+     *          This is required to validate benchmarks that modify their data in every repetition.
+     *
+     * @return uint number of executed repetitions
+     */
+    uint
+    getExecutedRepetitions() const {
+        return executedRepetitions;
+    }
+
+    /**
+     * @brief Check if the first repetition of the current measurement was finished
+     *
+     */
+    bool
+    isFirstRepetitionFinished() const {
+        return firstRepetitionFinished;
+    }
+
+    /**
+     * @brief Get the point in time when the first repetition was finished.
+     *          The execution types wait for the kernels of a repetition before they measure its time, so this is the completion of the first kernel.
+     *          Only valid if isFirstRepetitionFinished() is true.
+     *
+     */
+    std::chrono::time_point<std::chrono::high_resolution_clock>
+    getFirstRepetitionEnd() const {
+        return firstRepetitionEnd;
+    }
+
+};
+
+}
+
+#endif
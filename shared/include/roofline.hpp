@@ -0,0 +1,119 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHARED_ROOFLINE_HPP_
+#define SHARED_ROOFLINE_HPP_
+
+#include <algorithm>
+#include <string>
+
+namespace hpcc_base {
+
+/**
+ * @brief Roofline model of a bitstream, i.e. the theoretical peak performance of the kernels and the global memory.
+ *          A peak of 0 means, that it is unknown and not considered.
+ *
+ */
+struct Roofline {
+
+    /**
+     * @brief Peak performance of the kernel datapath in operations per second
+     *
+     */
+    double computePeak;
+
+    /**
+     * @brief Peak bandwidth of the global memory in bytes per second
+     *
+     */
+    double memoryPeak;
+
+    /**
+     * @brief Number of bytes that are transferred from or to global memory for a single operation
+     *
+     */
+    double bytesPerOperation;
+
+    /**
+     * @brief Performance that can be achieved by the memory bandwidth in operations per second
+     *
+     * @return double The memory roof or 0 if it is unknown
+     */
+    double
+    memoryRoof() const {
+        return (memoryPeak > 0.0 && bytesPerOperation > 0.0) ? memoryPeak / bytesPerOperation : 0.0;
+    }
+
+    /**
+     * @brief Theoretical peak performance, which is the minimum of the compute and the memory roof
+     *
+     * @return double The attainable performance in operations per second or 0 if both roofs are unknown
+     */
+    double
+    attainable() const {
+        double memory = memoryRoof();
+        if (computePeak <= 0.0 || memory <= 0.0) {
+            return std::max(computePeak, memory);
+        }
+        return std::min(computePeak, memory);
+    }
+
+    /**
+     * @brief Check if the lower roof is given by the memory bandwidth
+     *
+     * @return true if the performance is limited by the global memory
+     */
+    bool
+    isMemoryBound() const {
+        double memory = memoryRoof();
+        return memory > 0.0 && (computePeak <= 0.0 || memory < computePeak);
+    }
+
+    /**
+     * @brief Get the name of the roof that limits the performance
+     *
+     * @return std::string "memory", "compute" or "unknown"
+     */
+    std::string
+    boundToString() const {
+        if (attainable() <= 0.0) {
+            return "unknown";
+        }
+        return isMemoryBound() ? "memory" : "compute";
+    }
+};
+
+/**
+ * @brief Calculate the peak bandwidth of the global memory
+ *
+ * @param banks Number of memory banks
+ * @param width Number of bytes that can be transferred per cycle by a single bank
+ * @param frequency Frequency of the memory interface in MHz
+ * @return double The peak bandwidth in bytes per second
+ */
+inline double
+calculateMemoryPeak(unsigned banks, double width, double frequency) {
+    return static_cast<double>(banks) * width * frequency * 1.0e6;
+}
+
+}
+
+#endif
@@ -29,6 +29,7 @@ SOFTWARE.
 #include <chrono>
 #include <fstream>
 #include <memory>
+#include <ctime>
 
 /* External libraries */
 #ifdef USE_DEPRECATED_HPP_HEADER
@@ -122,8 +123,87 @@ line number.
 */
 #define ASSERT_CL(err) fpga_setup::handleClReturnCode(err, __FILE__, __LINE__);
 
+/**
+Parse a list of CPUs in the format used by sysfs and cpusets, e.g. "0-3,8,10-11"
+
+@param cpuList The list as string
+@return The indices of all CPUs in the list
+*/
+    std::vector<int>
+    parseCpuList(std::string const& cpuList);
+
+/**
+Restrict the calling thread to the CPUs of the given NUMA node.
+Threads that are created afterwards by this thread inherit the affinity.
+
+@param numaNode The NUMA node
+@return true, if the affinity was changed
+*/
+    bool
+    pinThreadToNumaNode(int numaNode);
+
+/**
+Get the rank of the process in MPI_COMM_WORLD. The rank is only queried once, so functions using it
+can also be called from other threads than the main thread without making additional MPI calls.
+The first call has to be done on the main thread, since MPI may be initialized without thread support.
+
+@return The MPI rank or 0 if MPI is not used
+*/
+    int
+    getWorldRank();
+
+/**
+Calculates a hash of the given bitstream that is used to identify the bitstream loaded on a device.
+
+@param binary The content of the kernel file
+@return The hash as hexadecimal string with 16 characters
+*/
+    std::string
+    getBitstreamHash(std::vector<unsigned char> const& binary);
+
+/**
+Creates the entry of the bitstream cache file for the given kernel file.
+
+@param hash The hash of the bitstream calculated with getBitstreamHash()
+@param fileSize The size of the kernel file in bytes
+@param modificationTime The modification time of the kernel file
+@param kernelFile The path to the kernel file
+@return The entry containing the hash, the file size, the modification time and the path in a single line
+*/
+    std::string
+    createBitstreamCacheEntry(std::string const& hash, long fileSize, time_t modificationTime, std::string const& kernelFile);
+
+/**
+Returns the hash that is stored in an entry of the bitstream cache file, if the entry belongs to the given kernel file.
+The hash is only used if the path, the size and the modification time of the file did not change, so the file does not need
+to be hashed again.
+
+@param entry The content of the cache file as created by createBitstreamCacheEntry()
+@param fileSize The current size of the kernel file in bytes
+@param modificationTime The current modification time of the kernel file
+@param kernelFile The path to the kernel file
+@return The stored hash or an empty string, if the entry does not match the kernel file
+*/
+    std::string
+    getCachedBitstreamHash(std::string const& entry, long fileSize, time_t modificationTime, std::string const& kernelFile);
+
+/**
+Returns the path of the file that stores the hash of the last bitstream loaded on the given device.
+The file is placed in the directory given by the environment variable HPCC_FPGA_BITSTREAM_CACHE_DIR
+or /tmp if the variable is not set. The name contains the device name and the platform and device index,
+so identical boards in the same node use separate files.
+
+@param device The device the bitstream is loaded on
+@return Path to the cache file or an empty string, if the cache is disabled by setting HPCC_FPGA_BITSTREAM_CACHE_DIR to an empty string
+*/
+    std::string
+    getBitstreamCacheFileName(cl::Device const& device);
+
 /**
 Sets up the given FPGA with the kernel in the provided file.
+If the same kernel file was already loaded for the given context and device, the existing program is returned
+without reading the file again.
+The hash of the loaded bitstream is stored in a cache file per device, see getBitstreamCacheFileName().
 
 @param context The context used for the program
 @param program The devices used for the program
@@ -142,6 +222,41 @@ granularity using bm_helper::checktick()
     setupEnvironmentAndClocks();
 
 
+/**
+Searches an selects FPGA devices using the CL library functions.
+If multiple platforms or devices are given, the user will be prompted to
+choose the first device. Additional devices are taken in order from the
+device list of the platform.
+If multiple MPI ranks are used and no device is given, the device is chosen
+by the node local rank of the calling process. The devices are ordered by their
+NUMA node and the host thread is pinned to the NUMA node of the chosen device.
+The resulting mapping of all ranks is printed by rank 0.
+
+@param defaultPlatform The index of the platform that has to be used. If a
+                        value < 0 is given, the platform can be chosen
+                        interactively
+@param defaultDevice The index of the first device that has to be used. If a
+                        value < 0 is given, the device can be chosen
+                        interactively
+@param numDevices The number of devices that should be selected
+
+@return A list containing the selected devices
+*/
+    std::vector<cl::Device>
+    selectFPGADevices(int defaultPlatform, int defaultDevice, uint numDevices);
+
+/**
+Creates a context for the given devices.
+The context is shared by all calls with the same devices within the process, so programs loaded by fpgaSetup()
+can be reused by later benchmark setups with the same kernel file.
+
+@param deviceList The devices that are used in the context
+
+@return The context for the devices
+*/
+    std::unique_ptr<cl::Context>
+    createContext(std::vector<cl::Device> const& deviceList);
+
 /**
 Searches an selects an FPGA device using the CL library functions.
 If multiple platforms or devices are given, the user will be prompted to
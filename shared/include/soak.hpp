@@ -0,0 +1,206 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHARED_SOAK_HPP_
+#define SHARED_SOAK_HPP_
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "power_sampler.hpp"
+
+namespace hpcc_base {
+
+/**
+ * @brief State of a soak run that is exported after every iteration
+ *
+ */
+struct SoakStatus {
+
+    /**
+     * @brief Number of finished kernel executions
+     *
+     */
+    unsigned iterations = 0;
+
+    /**
+     * @brief Number of executions that were validated and the number of failed validations
+     *
+     */
+    unsigned validations = 0;
+    unsigned failedValidations = 0;
+
+    /**
+     * @brief Time since the start of the soak run in s
+     *
+     */
+    double elapsed = 0.0;
+
+    /**
+     * @brief Execution time of the last iteration in s
+     *
+     */
+    double executionTime = 0.0;
+
+    /**
+     * @brief Average power of the last iteration in W. Negative, if not measured.
+     *
+     */
+    double power = -1.0;
+
+    /**
+     * @brief Board temperature after the last iteration in °C. Negative, if not measured.
+     *
+     */
+    double temperature = -1.0;
+};
+
+/**
+ * @brief Create a source for the board temperature. The PowerSource interface is reused, so readPower() returns the temperature in °C.
+ *
+ * @param spec Either "hwmon:<path to temperature sensor>" with the temperature in m°C or "cmd:<command printing the temperature in °C>"
+ * @return std::unique_ptr<PowerSource> The created source
+ * @throws std::runtime_error if the description is unknown
+ */
+inline std::unique_ptr<PowerSource>
+createTemperatureSource(std::string const& spec) {
+    if (spec.compare(0, 6, "hwmon:") == 0) {
+        return std::unique_ptr<PowerSource>(new HwmonPowerSource(spec.substr(6), 1.0e-3));
+    }
+    if (spec.compare(0, 4, "cmd:") == 0) {
+        return std::unique_ptr<PowerSource>(new CommandPowerSource(spec.substr(4), power_parsers::firstNumber));
+    }
+    throw std::runtime_error("Unknown temperature source: " + spec + ". Use hwmon:<path> or cmd:<command>");
+}
+
+/**
+ * @brief Escape a label value for the Prometheus text format
+ *
+ */
+inline std::string
+escapePrometheusLabel(std::string const& value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (c == '\n') {
+            escaped += "\\n";
+        }
+        else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+/**
+ * @brief Write the status of a soak run and the derived metrics of the last iteration in the Prometheus text format,
+ *          e.g. for the textfile collector of the node exporter. The file is written to a temporary file first and
+ *          then renamed, so a collector never reads an incomplete file.
+ *          The derived metrics are exported as hpcc_fpga_metric with their name as label.
+ *
+ * @param fileName Name of the metrics file
+ * @param labels Labels that are added to all metrics, e.g. the rank and the device
+ * @param status The status of the soak run
+ * @param metrics The derived metrics of the last iteration
+ * @return true if the file was written successfully
+ */
+inline bool
+writePrometheusMetrics(std::string const& fileName, std::map<std::string, std::string> const& labels, SoakStatus const& status,
+                        std::map<std::string, double> const& metrics) {
+    std::stringstream label_stream;
+    std::string separator = "";
+    for (auto const& l : labels) {
+        label_stream << separator << l.first << "=\"" << escapePrometheusLabel(l.second) << "\"";
+        separator = ",";
+    }
+    std::string common_labels = label_stream.str();
+    std::string tmp_file_name = fileName + ".tmp";
+    {
+        std::ofstream out(tmp_file_name);
+        if (!out.is_open()) {
+            return false;
+        }
+        out << std::setprecision(10);
+        auto gauge = [&out, &common_labels](std::string const& name, std::string const& help, double value) {
+            out << "# HELP " << name << " " << help << std::endl;
+            out << "# TYPE " << name << " gauge" << std::endl;
+            out << name << "{" << common_labels << "} " << value << std::endl;
+        };
+        gauge("hpcc_fpga_soak_iterations", "Number of kernel executions since the start of the soak run", status.iterations);
+        gauge("hpcc_fpga_soak_validations", "Number of validated kernel executions", status.validations);
+        gauge("hpcc_fpga_soak_failed_validations", "Number of failed validations", status.failedValidations);
+        gauge("hpcc_fpga_soak_elapsed_seconds", "Time since the start of the soak run", status.elapsed);
+        gauge("hpcc_fpga_soak_execution_seconds", "Execution time of the last iteration", status.executionTime);
+        if (status.power >= 0.0) {
+            gauge("hpcc_fpga_power_watts", "Average board power during the last iteration", status.power);
+        }
+        if (status.temperature >= 0.0) {
+            gauge("hpcc_fpga_temperature_celsius", "Board temperature after the last iteration", status.temperature);
+        }
+        if (!metrics.empty()) {
+            out << "# HELP hpcc_fpga_metric Derived metrics of the last iteration. The unit is part of the name label" << std::endl;
+            out << "# TYPE hpcc_fpga_metric gauge" << std::endl;
+            for (auto const& m : metrics) {
+                out << "hpcc_fpga_metric{" << common_labels << (common_labels.empty() ? "" : ",")
+                    << "name=\"" << escapePrometheusLabel(m.first) << "\"} " << m.second << std::endl;
+            }
+        }
+        if (!out.good()) {
+            return false;
+        }
+    }
+    return std::rename(tmp_file_name.c_str(), fileName.c_str()) == 0;
+}
+
+/**
+ * @brief Discards everything that is written to std::cout until the end of the scope.
+ *          Used to hide the result tables of the single iterations of a soak run.
+ *
+ */
+class ScopedOutputSuppression {
+
+private:
+
+    std::streambuf* original;
+
+public:
+
+    ScopedOutputSuppression() : original(std::cout.rdbuf(nullptr)) {}
+
+    ~ScopedOutputSuppression() {
+        std::cout.rdbuf(original);
+        std::cout.clear();
+    }
+};
+
+}
+
+#endif
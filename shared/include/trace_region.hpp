@@ -0,0 +1,225 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHARED_TRACE_REGION_HPP_
+#define SHARED_TRACE_REGION_HPP_
+
+/*
+ * Annotation of host code regions for profilers. The backend is selected with the HPCC_FPGA_TRACING CMake option:
+ *
+ * - HPCC_TRACING_ITT: Tasks of the Intel ITT API, e.g. for VTune
+ * - HPCC_TRACING_SCOREP: Score-P user regions. The host code has to be compiled with the Score-P compiler wrapper.
+ * - HPCC_TRACING_RING: Built-in ring buffer that stores the last regions of every process.
+ *                      It is written next to the OpenCL timeline if the trace option is given.
+ *
+ * Without a backend, HPCC_TRACE_REGION() compiles to nothing.
+ * The name has to be a string literal and only one region can be started per line. Usage:
+ *
+ *     {
+ *         HPCC_TRACE_REGION("MPI exchange");
+ *         MPI_Sendrecv(...);
+ *     }
+ */
+
+#if defined(HPCC_TRACING_ITT)
+#include <ittnotify.h>
+#elif defined(HPCC_TRACING_SCOREP)
+#include <scorep/SCOREP_User.h>
+#elif defined(HPCC_TRACING_RING)
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#endif
+
+#define HPCC_TRACE_CONCAT_(a, b) a##b
+#define HPCC_TRACE_CONCAT(a, b) HPCC_TRACE_CONCAT_(a, b)
+
+namespace hpcc_base {
+
+namespace tracing {
+
+#if defined(HPCC_TRACING_ITT)
+
+/**
+ * @brief Get the ITT domain that contains all regions of the benchmarks
+ *
+ */
+inline __itt_domain*
+getDomain() {
+    static __itt_domain* domain = __itt_domain_create("HPCC_FPGA");
+    return domain;
+}
+
+/**
+ * @brief ITT task that lasts until the end of the scope
+ *
+ */
+class ScopedRegion {
+public:
+    explicit ScopedRegion(__itt_string_handle* handle) {
+        __itt_task_begin(getDomain(), __itt_null, __itt_null, handle);
+    }
+
+    ~ScopedRegion() {
+        __itt_task_end(getDomain());
+    }
+};
+
+#elif defined(HPCC_TRACING_RING)
+
+/**
+ * @brief A finished region that is stored in the ring buffer
+ *
+ */
+struct RegionRecord {
+    const char* name;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point end;
+    size_t thread;
+};
+
+/**
+ * @brief Fixed size buffer that keeps the last finished regions of all threads.
+ *          Recording a region only needs an atomic increment and no allocation, so it can also be used in loops.
+ *          Older regions are overwritten, if more regions are recorded than the buffer can hold.
+ *
+ */
+class RingBuffer {
+
+private:
+
+    std::vector<RegionRecord> records;
+
+    std::atomic<size_t> next;
+
+public:
+
+    /**
+     * @brief Number of regions that can be stored in the buffer
+     *
+     */
+    static const size_t capacity = 1 << 16;
+
+    RingBuffer() : records(capacity), next(0) {}
+
+    void
+    record(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+        size_t index = next.fetch_add(1, std::memory_order_relaxed) % capacity;
+        records[index] = {name, start, end, std::hash<std::thread::id>()(std::this_thread::get_id())};
+    }
+
+    /**
+     * @brief Get the number of regions in the buffer
+     *
+     */
+    size_t
+    size() const {
+        size_t recorded = next.load();
+        return (recorded < capacity) ? recorded : capacity;
+    }
+
+    void
+    clear() {
+        next = 0;
+    }
+
+    /**
+     * @brief Write all stored regions as complete events in the Chrome trace event format.
+     *          Should only be called while no region is recorded.
+     *
+     * @param fileName Name of the trace file
+     * @param processId Id of the process in the trace, e.g. the MPI rank
+     * @return true if the file was written successfully
+     */
+    bool
+    writeChromeTrace(std::string const& fileName, int processId) const {
+        std::ofstream out(fileName);
+        if (!out.is_open()) {
+            return false;
+        }
+        size_t count = size();
+        size_t first = (next.load() > capacity) ? next.load() % capacity : 0;
+        out << "{\"traceEvents\": [";
+        for (size_t i = 0; i < count; i++) {
+            RegionRecord const& r = records[(first + i) % capacity];
+            double start = std::chrono::duration<double, std::micro>(r.start.time_since_epoch()).count();
+            double duration = std::chrono::duration<double, std::micro>(r.end - r.start).count();
+            out << ((i > 0) ? "," : "") << std::endl << "  {\"name\": \"" << r.name << "\", \"ph\": \"X\", \"pid\": " << processId
+                << ", \"tid\": " << (r.thread % 1000000) << ", \"ts\": " << std::fixed << start << ", \"dur\": " << duration << "}";
+        }
+        out << std::endl << "]}" << std::endl;
+        return true;
+    }
+};
+
+/**
+ * @brief Get the ring buffer of the process
+ *
+ */
+inline RingBuffer&
+getRingBuffer() {
+    static RingBuffer buffer;
+    return buffer;
+}
+
+/**
+ * @brief Region that is recorded in the ring buffer at the end of the scope
+ *
+ */
+class ScopedRegion {
+
+private:
+
+    const char* name;
+
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedRegion(const char* name) : name(name), start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedRegion() {
+        getRingBuffer().record(name, start, std::chrono::steady_clock::now());
+    }
+};
+
+#endif
+
+} // namespace tracing
+
+} // namespace hpcc_base
+
+#if defined(HPCC_TRACING_ITT)
+#define HPCC_TRACE_REGION(name) \
+    static __itt_string_handle* HPCC_TRACE_CONCAT(hpcc_trace_handle_, __LINE__) = __itt_string_handle_create(name); \
+    hpcc_base::tracing::ScopedRegion HPCC_TRACE_CONCAT(hpcc_trace_region_, __LINE__)(HPCC_TRACE_CONCAT(hpcc_trace_handle_, __LINE__))
+#elif defined(HPCC_TRACING_SCOREP)
+#define HPCC_TRACE_REGION(name) SCOREP_USER_REGION(name, SCOREP_USER_REGION_TYPE_COMMON)
+#elif defined(HPCC_TRACING_RING)
+#define HPCC_TRACE_REGION(name) hpcc_base::tracing::ScopedRegion HPCC_TRACE_CONCAT(hpcc_trace_region_, __LINE__)(name)
+#else
+#define HPCC_TRACE_REGION(name) do {} while (0)
+#endif
+
+#endif
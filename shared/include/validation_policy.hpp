@@ -0,0 +1,183 @@
+/*
+Copyright (c) 2021 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHARED_VALIDATION_POLICY_HPP_
+#define SHARED_VALIDATION_POLICY_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace hpcc_base {
+
+/**
+ * @brief The modes that can be used to validate the output of a benchmark
+ *
+ */
+typedef enum _ValidationMode {
+
+    /**
+     * @brief Validate all output values with the reference implementation of the benchmark
+     *
+     */
+    full,
+
+    /**
+     * @brief Validate the output probabilistically. Every benchmark decides how this is done, e.g. by
+     *          checking randomly selected values or by the algorithm of Freivalds for matrix products.
+     *          Benchmarks without a sampled validation use the full validation.
+     *
+     */
+    sampled,
+
+    /**
+     * @brief Skip the validation. The benchmark will always report a failed validation.
+     *
+     */
+    off
+
+} ValidationMode;
+
+static const std::map<const std::string, ValidationMode> validation_to_str_map{
+    {"full", ValidationMode::full},
+    {"sampled", ValidationMode::sampled},
+    {"off", ValidationMode::off}
+    };
+
+/**
+ * @brief Serializes a enum of type ValidationMode into a string
+ *
+ * @param m the validation mode that should be converted into a string
+ * @return std::string String representation of the validation mode
+ */
+static std::string validationToString(ValidationMode m) {
+    for (auto& entry : validation_to_str_map) {
+        if (entry.second == m) {
+            return entry.first;
+        }
+    }
+    throw std::runtime_error("Validation mode could not be converted to string!");
+}
+
+/**
+ * @brief Deserializes a string into a enum of type ValidationMode
+ *
+ * @param name String serialization of the validation mode
+ * @return ValidationMode the validation mode. Will throw a runtime error if the string does not match a mode.
+ */
+static ValidationMode retrieveValidationMode(std::string name) {
+    auto result = validation_to_str_map.find(name);
+    if (result != validation_to_str_map.end()) {
+        return result->second;
+    }
+    throw std::runtime_error("Validation mode could not be converted from string: " + name + ". Use full, sampled or off");
+}
+
+namespace validation {
+
+/**
+ * @brief Minimum fraction of wrong output values that has to be detected with the probability given by the error bound,
+ *          if randomly selected values are checked
+ *
+ */
+static constexpr double minErrorFraction = 0.01;
+
+/**
+ * @brief Calculate the number of trials of the algorithm of Freivalds for the given error bound.
+ *          Every trial with a random vector of +1 and -1 misses a wrong matrix product with a probability of at most 1/2.
+ *
+ * @param errorBound Maximum probability that a wrong result passes the validation
+ * @return unsigned The number of trials
+ */
+inline unsigned
+freivaldsTrials(double errorBound) {
+    return static_cast<unsigned>(std::max(1.0, std::ceil(-std::log2(errorBound))));
+}
+
+/**
+ * @brief Calculate the number of randomly selected values that have to be checked, so a result with at least
+ *          minErrorFraction wrong values is detected with a probability of 1 - errorBound.
+ *
+ * @param errorBound Maximum probability that a wrong result passes the validation
+ * @param total Total number of values. The result will not be larger.
+ * @return size_t The number of values that have to be checked
+ */
+inline size_t
+probeCount(double errorBound, size_t total) {
+    double probes = std::ceil(std::log(errorBound) / std::log(1.0 - minErrorFraction));
+    return std::min(total, static_cast<size_t>(std::max(1.0, probes)));
+}
+
+/**
+ * @brief Select the indices of the values that are checked by the sampled validation.
+ *          If all values have to be checked, all indices are returned in ascending order.
+ *
+ * @param errorBound Maximum probability that a wrong result passes the validation
+ * @param total Total number of values
+ * @param seed Seed of the random number generator. Should differ between MPI ranks.
+ * @return std::vector<size_t> The indices in the range [0,total)
+ */
+inline std::vector<size_t>
+sampleIndices(double errorBound, size_t total, unsigned seed) {
+    size_t count = probeCount(errorBound, total);
+    std::vector<size_t> indices(count);
+    if (count == total) {
+        for (size_t i = 0; i < total; i++) {
+            indices[i] = i;
+        }
+        return indices;
+    }
+    std::mt19937_64 gen(seed);
+    std::uniform_int_distribution<size_t> dist(0, total - 1);
+    for (auto& i : indices) {
+        i = dist(gen);
+    }
+    return indices;
+}
+
+/**
+ * @brief Create the random vectors for the algorithm of Freivalds. All MPI ranks will get the same vectors for the same seed.
+ *
+ * @param errorBound Maximum probability that a wrong result passes the validation. Used to calculate the number of vectors.
+ * @param n Length of a vector
+ * @param seed Seed of the random number generator
+ * @return std::vector<double> The vectors stored one after another. Every value is either +1 or -1.
+ */
+inline std::vector<double>
+freivaldsVectors(double errorBound, size_t n, unsigned seed) {
+    std::vector<double> vectors(freivaldsTrials(errorBound) * n);
+    std::mt19937 gen(seed);
+    std::bernoulli_distribution dist(0.5);
+    for (auto& v : vectors) {
+        v = dist(gen) ? 1.0 : -1.0;
+    }
+    return vectors;
+}
+
+} // namespace validation
+
+}
+
+#endif
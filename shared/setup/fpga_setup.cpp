@@ -10,9 +10,23 @@
 #include <iomanip>
 #include <chrono>
 #include <fstream>
+#include <cctype>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <tuple>
+#include <algorithm>
+#include <numeric>
+#include <sched.h>
 
 /* External libraries */
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "parameters.h"
+#include "host_memory.hpp"
 
 #ifdef _USE_MPI_
 #include "mpi.h"
@@ -118,6 +132,126 @@ Converts the reveived OpenCL error to a string
         }
     }
 
+    std::string
+    getBitstreamHash(std::vector<unsigned char> const& binary) {
+        // 64 bit FNV-1a hash. This is no cryptographic hash, but sufficient to detect different bitstreams
+        uint64_t hash = 14695981039346656037ull;
+        for (auto b : binary) {
+            hash ^= static_cast<uint64_t>(b);
+            hash *= 1099511628211ull;
+        }
+        std::stringstream ss;
+        ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+        return ss.str();
+    }
+
+    std::string
+    createBitstreamCacheEntry(std::string const& hash, long fileSize, time_t modificationTime, std::string const& kernelFile) {
+        return hash + " " + std::to_string(fileSize) + " " + std::to_string(static_cast<long long>(modificationTime)) + " " + kernelFile + "\n";
+    }
+
+    std::string
+    getCachedBitstreamHash(std::string const& entry, long fileSize, time_t modificationTime, std::string const& kernelFile) {
+        std::stringstream ss(entry);
+        std::string hash;
+        long cached_size;
+        long long cached_time;
+        std::string cached_file;
+        if (!(ss >> hash >> cached_size >> cached_time) || hash.size() != 16) {
+            return "";
+        }
+        // The path may contain spaces, so the remaining line is used
+        std::getline(ss, cached_file);
+        if (cached_file.empty() || cached_file.substr(1) != kernelFile || cached_size != fileSize
+                || cached_time != static_cast<long long>(modificationTime)) {
+            return "";
+        }
+        return hash;
+    }
+
+    std::string
+    getBitstreamCacheFileName(cl::Device const& device) {
+        std::string cache_dir = "/tmp";
+        char* env_cache_dir = std::getenv("HPCC_FPGA_BITSTREAM_CACHE_DIR");
+        if (env_cache_dir != nullptr) {
+            cache_dir = env_cache_dir;
+        }
+        if (cache_dir.empty()) {
+            return "";
+        }
+        std::string device_name = device.getInfo<CL_DEVICE_NAME>();
+        for (auto& c : device_name) {
+            if (!isalnum(c)) {
+                c = '_';
+            }
+        }
+        // Identical boards in the same node have the same name, so the platform and device index are added
+        // to get a separate cache and lock file for every board
+        std::vector<cl::Platform> platforms;
+        cl::Platform::get(&platforms);
+        for (size_t p = 0; p < platforms.size(); p++) {
+            std::vector<cl::Device> devices;
+            platforms[p].getDevices(CL_DEVICE_TYPE_ACCELERATOR, &devices);
+            for (size_t d = 0; d < devices.size(); d++) {
+                if (devices[d]() == device()) {
+                    device_name += "_p" + std::to_string(p) + "_d" + std::to_string(d);
+                }
+            }
+        }
+        return cache_dir + "/hpcc_fpga_" + device_name + ".bitstream";
+    }
+
+namespace {
+
+/**
+ * @brief Program that was already created in this process together with information to 
+ *          detect changes of the used kernel file
+ * 
+ */
+struct LoadedBitstream {
+    long fileSize;
+    time_t modificationTime;
+    cl::Program program;
+};
+
+/**
+ * @brief Programs created in this process. The key consists of the context, the device name and the kernel file.
+ *          The map is intentionally never destroyed to prevent the release of OpenCL objects after the runtime is shut down on exit.
+ * 
+ */
+auto& loadedBitstreams = *new std::map<std::tuple<cl_context, std::string, std::string>, LoadedBitstream>();
+
+std::mutex loadedBitstreamsMutex;
+
+/**
+ * @brief Devices that were already selected in this process. The key consists of the platform index, device index and number of devices.
+ *          Later benchmark setups in the same process reuse the selection without asking again.
+ * 
+ */
+auto& selectedDevicesCache = *new std::map<std::tuple<int, int, uint>, std::vector<cl::Device>>();
+
+/**
+ * @brief Contexts created in this process for a list of devices. Sharing the context allows reusing the programs in loadedBitstreams.
+ * 
+ */
+auto& createdContexts = *new std::map<std::vector<cl_device_id>, cl::Context>();
+
+std::mutex selectedDevicesMutex;
+
+}
+
+    int
+    getWorldRank() {
+        static const int world_rank = []() {
+            int rank = 0;
+#ifdef _USE_MPI_
+            MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+            return rank;
+        }();
+        return world_rank;
+    }
+
 /**
 Sets up the given FPGA with the kernel in the provided file.
 
@@ -130,17 +264,34 @@ Sets up the given FPGA with the kernel in the provided file.
     fpgaSetup(const cl::Context *context, std::vector<cl::Device> deviceList,
               const std::string *usedKernelFile) {
         int err;
-        int world_rank = 0;
-
-#ifdef _USE_MPI_
-        MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
-#endif
+        int world_rank = getWorldRank();
 
         if (world_rank == 0) {
             std::cout << HLINE;
             std::cout << "FPGA Setup:" << usedKernelFile->c_str() << std::endl;
         }
 
+        struct stat file_stat;
+        if (stat(usedKernelFile->c_str(), &file_stat) != 0) {
+            std::cerr << "Not possible to open from given file!" << std::endl;
+            throw FpgaSetupException("Not possible to open from given file: " + *usedKernelFile);
+        }
+
+        // Reuse the program if the same kernel file was already loaded on the device using the same context
+        auto bitstream_key = std::make_tuple((*context)(), deviceList[0].getInfo<CL_DEVICE_NAME>(), *usedKernelFile);
+        {
+            std::lock_guard<std::mutex> lock(loadedBitstreamsMutex);
+            auto loaded = loadedBitstreams.find(bitstream_key);
+            if (loaded != loadedBitstreams.end() && loaded->second.fileSize == static_cast<long>(file_stat.st_size) 
+                    && loaded->second.modificationTime == file_stat.st_mtime) {
+                if (world_rank == 0) {
+                    std::cout << "Bitstream already loaded in this process. Skip programming." << std::endl;
+                    std::cout << HLINE;
+                }
+                return std::unique_ptr<cl::Program>(new cl::Program(loaded->second.program));
+            }
+        }
+
         // Open file stream if possible
         std::ifstream aocxStream(usedKernelFile->c_str(), std::ifstream::binary);
         if (!aocxStream.is_open()) {
@@ -148,34 +299,89 @@ Sets up the given FPGA with the kernel in the provided file.
             throw FpgaSetupException("Not possible to open from given file: " + *usedKernelFile);
         }
 
-        // Read in file contents and create program from binaries
+        // Read in file contents and create program from binaries.
+        // The program has to be created in every process, whether the device is reconfigured is decided by the runtime.
         aocxStream.seekg(0, aocxStream.end);
         long file_size = aocxStream.tellg();
         aocxStream.seekg(0, aocxStream.beg);
         std::vector<unsigned char> buf(file_size);
         aocxStream.read(reinterpret_cast<char *>(buf.data()), file_size);
 
+        // The identity of the last bitstream loaded on the device is stored in a cache file.
+        // The lock on the file prevents multiple processes from programming the same device concurrently.
+        // The stored hash is reused if the kernel file did not change, so it is only calculated for new bitstreams.
+        std::string cache_file_name = getBitstreamCacheFileName(deviceList[0]);
+        int cache_fd = -1;
+        if (!cache_file_name.empty()) {
+            cache_fd = open(cache_file_name.c_str(), O_RDWR | O_CREAT, 0666);
+        }
+        std::string bitstream_hash;
+        if (cache_fd >= 0) {
+            flock(cache_fd, LOCK_EX);
+            std::string cache_entry;
+            char read_buffer[256];
+            ssize_t read_bytes;
+            while ((read_bytes = read(cache_fd, read_buffer, sizeof(read_buffer))) > 0) {
+                cache_entry.append(read_buffer, read_bytes);
+            }
+            bitstream_hash = getCachedBitstreamHash(cache_entry, static_cast<long>(file_stat.st_size), file_stat.st_mtime, *usedKernelFile);
+        }
+        if (bitstream_hash.empty()) {
+            bitstream_hash = getBitstreamHash(buf);
+        }
 
+        // The same bitstream is used for all devices
 #ifdef USE_DEPRECATED_HPP_HEADER
-        cl::Program::Binaries mybinaries;
-        mybinaries.push_back({buf.data(), file_size});
+        cl::Program::Binaries mybinaries(deviceList.size(), {buf.data(), file_size});
 #else
-        cl::Program::Binaries mybinaries{buf};
+        cl::Program::Binaries mybinaries(deviceList.size(), buf);
 #endif
 
-        // Create the Program from the AOCX file.
-        cl::Program program(*context, deviceList, mybinaries, NULL, &err);
-        ASSERT_CL(err)
+        try {
+            // Create the Program from the AOCX file.
+            cl::Program program(*context, deviceList, mybinaries, NULL, &err);
+            ASSERT_CL(err)
 
-        // Build the program (required for fast emulation on Intel)
-        ASSERT_CL(program.build());
-        
-        if (world_rank == 0) {
-            std::cout << "Prepared FPGA successfully for global Execution!" <<
-                      std::endl;
-            std::cout << HLINE;
+            // Build the program (required for fast emulation on Intel)
+            ASSERT_CL(program.build());
+
+            if (cache_fd >= 0) {
+                std::string cache_content = createBitstreamCacheEntry(bitstream_hash, static_cast<long>(file_stat.st_size), file_stat.st_mtime, *usedKernelFile);
+                if (ftruncate(cache_fd, 0) != 0 || pwrite(cache_fd, cache_content.c_str(), cache_content.size(), 0) < 0) {
+                    std::cerr << "WARNING: Bitstream cache file " << cache_file_name << " could not be updated!" << std::endl;
+                }
+                flock(cache_fd, LOCK_UN);
+                close(cache_fd);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(loadedBitstreamsMutex);
+                // Programs of other kernel files are not loaded on the device anymore
+                for (auto it = loadedBitstreams.begin(); it != loadedBitstreams.end();) {
+                    if (std::get<0>(it->first) == std::get<0>(bitstream_key) && std::get<1>(it->first) == std::get<1>(bitstream_key)) {
+                        it = loadedBitstreams.erase(it);
+                    }
+                    else {
+                        it++;
+                    }
+                }
+                loadedBitstreams[bitstream_key] = LoadedBitstream{static_cast<long>(file_stat.st_size), file_stat.st_mtime, program};
+            }
+
+            if (world_rank == 0) {
+                std::cout << "Prepared FPGA successfully for global Execution!" <<
+                        std::endl;
+                std::cout << HLINE;
+            }
+            return std::unique_ptr<cl::Program>(new cl::Program(program));
+        }
+        catch (...) {
+            if (cache_fd >= 0) {
+                flock(cache_fd, LOCK_UN);
+                close(cache_fd);
+            }
+            throw;
         }
-        return std::unique_ptr<cl::Program>(new cl::Program(program));
     }
 
 /**
@@ -186,11 +392,7 @@ granularity using bm_helper::checktick()
     setupEnvironmentAndClocks() {
         std::cout << std::setprecision(5) << std::scientific;
 
-        int world_rank = 0;
-
-#ifdef _USE_MPI_
-        MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
-#endif
+        int world_rank = getWorldRank();
 
         if (world_rank == 0) {
             std::cout << HLINE;
@@ -209,22 +411,118 @@ granularity using bm_helper::checktick()
     }
 
 
+    std::vector<int>
+    parseCpuList(std::string const& cpuList) {
+        std::vector<int> cpus;
+        std::stringstream list(cpuList);
+        std::string range;
+        while (std::getline(list, range, ',')) {
+            if (range.find_first_of("0123456789") == std::string::npos) {
+                continue;
+            }
+            size_t separator = range.find('-');
+            int first = std::stoi(range.substr(0, separator));
+            int last = (separator == std::string::npos) ? first : std::stoi(range.substr(separator + 1));
+            for (int cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    bool
+    pinThreadToNumaNode(int numaNode) {
+        std::ifstream cpulist_file("/sys/devices/system/node/node" + std::to_string(numaNode) + "/cpulist");
+        std::string cpulist;
+        if (numaNode < 0 || !std::getline(cpulist_file, cpulist)) {
+            return false;
+        }
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        for (int cpu : parseCpuList(cpulist)) {
+            if (cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &cpu_set);
+            }
+        }
+        return sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0;
+    }
+
 /**
-Searches an selects an FPGA device using the CL library functions.
+Get the rank and the number of ranks of the calling process on the local node
+
+@param localRank The rank within the node
+@param localSize The number of ranks on the node
+*/
+    static void
+    getNodeLocalRank(int& localRank, int& localSize) {
+        localRank = 0;
+        localSize = 1;
+#ifdef _USE_MPI_
+        int mpi_initialized;
+        MPI_Initialized(&mpi_initialized);
+        if (!mpi_initialized) {
+            return;
+        }
+        int world_rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+        MPI_Comm node_comm;
+        MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, world_rank, MPI_INFO_NULL, &node_comm);
+        MPI_Comm_rank(node_comm, &localRank);
+        MPI_Comm_size(node_comm, &localSize);
+        MPI_Comm_free(&node_comm);
+#endif
+    }
+
+/**
+Print the device mapping of all ranks on rank 0
+
+@param mapping Description of the mapping of the calling rank
+*/
+    static void
+    printDeviceMapping(std::string const& mapping) {
+        int world_rank = 0;
+        int world_size = 1;
+#ifdef _USE_MPI_
+        MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+        constexpr int max_length = 256;
+        std::vector<char> local_mapping(max_length, 0);
+        std::copy_n(mapping.begin(), std::min(mapping.size(), static_cast<size_t>(max_length - 1)), local_mapping.begin());
+        std::vector<char> all_mappings(world_rank == 0 ? max_length * world_size : 0);
+        MPI_Gather(local_mapping.data(), max_length, MPI_CHAR, all_mappings.data(), max_length, MPI_CHAR, 0, MPI_COMM_WORLD);
+        if (world_rank == 0) {
+            std::cout << "Device mapping:" << std::endl;
+            for (int r = 0; r < world_size; r++) {
+                std::cout << "  " << std::string(&all_mappings[r * max_length]) << std::endl;
+            }
+        }
+#else
+        std::cout << "Device mapping:" << std::endl << "  " << mapping << std::endl;
+#endif
+    }
+
+/**
+Searches an selects FPGA devices using the CL library functions.
 If multiple platforms or devices are given, the user will be prompted to
-choose a device.
+choose the first device. Additional devices are taken in order from the
+device list of the platform.
+If multiple MPI ranks are used and no device is given, the device is chosen
+by the node local rank of the calling process. The devices are ordered by their
+NUMA node and the host thread is pinned to the NUMA node of the chosen device.
+The resulting mapping of all ranks is printed by rank 0.
 
 @param defaultPlatform The index of the platform that has to be used. If a
                         value < 0 is given, the platform can be chosen
                         interactively
-@param defaultDevice The index of the device that has to be used. If a
+@param defaultDevice The index of the first device that has to be used. If a
                         value < 0 is given, the device can be chosen
                         interactively
+@param numDevices The number of devices that should be selected
 
-@return A list containing a single selected device
+@return A list containing the selected devices
 */
-    std::unique_ptr<cl::Device>
-    selectFPGADevice(int defaultPlatform, int defaultDevice) {
+    std::vector<cl::Device>
+    selectFPGADevices(int defaultPlatform, int defaultDevice, uint numDevices) {
         // Integer used to store return codes of OpenCL library calls
         int err;
 
@@ -236,6 +534,18 @@ choose a device.
         MPI_Comm_size(MPI_COMM_WORLD, &world_size);
 #endif
 
+        auto selection_key = std::make_tuple(defaultPlatform, defaultDevice, numDevices);
+        {
+            std::lock_guard<std::mutex> lock(selectedDevicesMutex);
+            auto selected = selectedDevicesCache.find(selection_key);
+            if (selected != selectedDevicesCache.end()) {
+                if (world_rank == 0) {
+                    std::cout << "Reuse device selection of this process: " << selected->second.front().getInfo<CL_DEVICE_NAME>() << std::endl;
+                }
+                return selected->second;
+            }
+        }
+
         std::vector<cl::Platform> platformList;
         err = cl::Platform::get(&platformList);
         ASSERT_CL(err)
@@ -276,6 +586,9 @@ choose a device.
 
         // Choose taget device
         long unsigned int chosenDeviceId = 0;
+        // True, if the device was chosen automatically using the node local rank
+        bool autoMapped = false;
+        std::stringstream mapping;
         if (defaultDevice >= 0) {
             if (defaultDevice < static_cast<int>(deviceList.size())) {
                 chosenDeviceId = defaultDevice;
@@ -285,7 +598,7 @@ choose a device.
                           << deviceList.size() << std::endl;
                 throw FpgaSetupException("Invalid device index specified: " + std::to_string(defaultDevice) + "/" + std::to_string(deviceList.size() - 1));
             }
-        } else if (deviceList.size() > 1) {
+        } else if (deviceList.size() > numDevices) {
             if (world_size == 1) {
                     std::cout <<
                               "Multiple devices have been found. Select the device by"\
@@ -300,26 +613,107 @@ choose a device.
                 std::cout << "Enter device id [0-" << deviceList.size() - 1 << "]:";
                 std::cin >> chosenDeviceId;
             } else {
-                chosenDeviceId = static_cast<long unsigned int>(world_rank % deviceList.size());
+                // Every rank of a node uses its own set of devices.
+                // The devices are ordered by their NUMA node, so ranks with consecutive local ranks
+                // use devices that are close to each other.
+                int local_rank, local_size;
+                getNodeLocalRank(local_rank, local_size);
+                if (static_cast<size_t>(local_size) * numDevices > deviceList.size() && world_rank == 0) {
+                    std::cerr << "WARNING: " << local_size << " ranks per node use " << numDevices << " device(s) each, but only "
+                                << deviceList.size() << " devices are available. Devices will be shared between ranks!" << std::endl;
+                }
+                std::vector<int> device_nodes;
+                for (auto const& device : deviceList) {
+                    device_nodes.push_back(hpcc_base::host_memory::getDeviceNumaNode(device));
+                }
+                std::vector<long unsigned int> device_order(deviceList.size());
+                std::iota(device_order.begin(), device_order.end(), 0);
+                std::stable_sort(device_order.begin(), device_order.end(), [&device_nodes](long unsigned int a, long unsigned int b) {
+                    return device_nodes[a] < device_nodes[b];
+                });
+                chosenDeviceId = device_order[(local_rank * numDevices) % deviceList.size()];
+                autoMapped = true;
+                mapping << "Rank " << world_rank << " (local rank " << local_rank << "/" << local_size << ")";
             }
-        } else if (deviceList.size() == 1) {
+        } else if (deviceList.size() > 0) {
             chosenDeviceId = 0;
         } else {
             throw std::runtime_error("No devices found for selected Platform!");
         }
 
+        if (numDevices < 1 || numDevices > deviceList.size()) {
+            throw FpgaSetupException("Number of requested devices " + std::to_string(numDevices) + " can not be used. Available devices: " 
+                                        + std::to_string(deviceList.size()));
+        }
+
+        std::vector<cl::Device> selectedDevices;
+        for (uint d = 0; d < numDevices; d++) {
+            selectedDevices.push_back(deviceList[(chosenDeviceId + d) % deviceList.size()]);
+        }
+
+        if (autoMapped) {
+            // Pin the host thread to the NUMA node of the device to maximize the PCIe bandwidth.
+            // Threads that are created later, e.g. by OpenMP, inherit the affinity.
+            int numa_node = hpcc_base::host_memory::getDeviceNumaNode(selectedDevices.front());
+            mapping << " -> device " << chosenDeviceId << " " << selectedDevices.front().getInfo<CL_DEVICE_NAME>();
+            if (numa_node >= 0) {
+                mapping << ", NUMA node " << numa_node << (pinThreadToNumaNode(numa_node) ? " (pinned)" : " (pinning failed)");
+            }
+            printDeviceMapping(mapping.str());
+        }
+
         if (world_rank == 0) {
             // Give selection summary
             std::cout << HLINE;
             std::cout << "Selection summary:" << std::endl;
             std::cout << "Platform Name: " <<
                       platform.getInfo<CL_PLATFORM_NAME>() << std::endl;
-            std::cout << "Device Name:   " <<
-                      deviceList[chosenDeviceId].getInfo<CL_DEVICE_NAME>() << std::endl;
+            for (auto const& device : selectedDevices) {
+                std::cout << "Device Name:   " <<
+                          device.getInfo<CL_DEVICE_NAME>() << std::endl;
+            }
             std::cout << HLINE;
         }
 
-        return std::unique_ptr<cl::Device>(new cl::Device(deviceList[chosenDeviceId]));
+        {
+            std::lock_guard<std::mutex> lock(selectedDevicesMutex);
+            selectedDevicesCache[selection_key] = selectedDevices;
+        }
+
+        return selectedDevices;
+    }
+
+    std::unique_ptr<cl::Context>
+    createContext(std::vector<cl::Device> const& deviceList) {
+        std::vector<cl_device_id> device_ids;
+        for (auto const& device : deviceList) {
+            device_ids.push_back(device());
+        }
+        std::lock_guard<std::mutex> lock(selectedDevicesMutex);
+        auto context = createdContexts.find(device_ids);
+        if (context == createdContexts.end()) {
+            context = createdContexts.emplace(device_ids, cl::Context(deviceList)).first;
+        }
+        return std::unique_ptr<cl::Context>(new cl::Context(context->second));
+    }
+
+/**
+Searches an selects an FPGA device using the CL library functions.
+If multiple platforms or devices are given, the user will be prompted to
+choose a device.
+
+@param defaultPlatform The index of the platform that has to be used. If a
+                        value < 0 is given, the platform can be chosen
+                        interactively
+@param defaultDevice The index of the device that has to be used. If a
+                        value < 0 is given, the device can be chosen
+                        interactively
+
+@return A list containing a single selected device
+*/
+    std::unique_ptr<cl::Device>
+    selectFPGADevice(int defaultPlatform, int defaultDevice) {
+        return std::unique_ptr<cl::Device>(new cl::Device(selectFPGADevices(defaultPlatform, defaultDevice, 1).front()));
     }
 
 }  // namespace fpga_setup
\ No newline at end of file
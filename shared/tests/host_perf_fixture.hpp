@@ -0,0 +1,117 @@
+/*
+Copyright (c) 2022 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHARED_TESTS_HOST_PERF_FIXTURE_HPP_
+#define SHARED_TESTS_HOST_PERF_FIXTURE_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "benchmark/benchmark.h"
+#include "test_program_settings.h"
+
+namespace hpcc_base {
+
+/**
+ * @brief Fixture for the micro-benchmarks of the host code of a benchmark.
+ *          The benchmark object is only created once, so the device is only programmed once for all micro-benchmarks.
+ *          Every benchmark defines how the range of the state is mapped to the data size of its settings.
+ *
+ * @tparam TBenchmark Class of the benchmark whose host code is measured
+ */
+template <class TBenchmark>
+class HostPerfFixture : public benchmark::Fixture {
+
+public:
+
+    /**
+     * @brief The input data type returned by the benchmark
+     *
+     */
+    typedef decltype(std::declval<TBenchmark&>().generateInputData()) DataPtr;
+
+    /**
+     * @brief Get the benchmark object that is shared by all micro-benchmarks
+     *
+     * @return TBenchmark& The benchmark object
+     */
+    static TBenchmark&
+    getBenchmark() {
+        static std::unique_ptr<TBenchmark> bm(new TBenchmark(global_argc, global_argv));
+        return *bm;
+    }
+
+protected:
+
+    /**
+     * @brief Set the data size in the settings of the benchmark to the size given by the range of the state
+     *
+     * @param state The state of the micro-benchmark
+     */
+    virtual void
+    setDataSize(benchmark::State& state) = 0;
+
+    /**
+     * @brief Get the size of the generated input data in bytes
+     *
+     * @param state The state of the micro-benchmark
+     * @return size_t Size of the input data. If 0, no throughput is reported for the generation.
+     */
+    virtual size_t
+    getInputDataBytes(benchmark::State& /*state*/) {
+        return 0;
+    }
+
+    /**
+     * @brief Set the data size and generate the input data for the range of the state
+     *
+     * @param state The state of the micro-benchmark
+     * @return DataPtr The generated input data
+     */
+    DataPtr
+    generateData(benchmark::State& state) {
+        setDataSize(state);
+        return getBenchmark().generateInputData();
+    }
+
+    /**
+     * @brief Measure the generation of the input data for the data size given by the range of the state
+     *
+     * @param state The state of the micro-benchmark
+     */
+    void
+    measureInputDataGeneration(benchmark::State& state) {
+        setDataSize(state);
+        for (auto _ : state) {
+            auto data = getBenchmark().generateInputData();
+            benchmark::DoNotOptimize(data.get());
+        }
+        size_t bytes = getInputDataBytes(state);
+        if (bytes > 0) {
+            state.SetBytesProcessed(state.iterations() * bytes);
+        }
+    }
+};
+
+}
+
+#endif
@@ -8,6 +8,10 @@
 #include "test_program_settings.h"
 #include "gmock/gmock.h"
 #include "hpcc_benchmark.hpp"
+#include "command_sequence.hpp"
+#include "communication_progress.hpp"
+#include "memory_placement.hpp"
+#include "hpcc_suite.hpp"
 
 
 // Dirty GoogleTest and static library hack
@@ -94,7 +98,10 @@ public:
         return returnValidate;}
 
     void
-    collectAndPrintResults(const int &output) override {}
+    collectAndPrintResults(const int &output) override {
+        rawTimings["test"] = {1.0, 2.0};
+        derivedMetrics["test [1/s]"] = 1.0;
+    }
 
     bool
     checkInputParameters() override {
@@ -187,6 +194,52 @@ TEST_F(BaseHpccBenchmarkTest, FindNonExistingDevice) {
     ASSERT_THROW(fpga_setup::selectFPGADevice(bm->getExecutionSettings().programSettings->defaultPlatform, 100).get(), fpga_setup::FpgaSetupException);
 }
 
+/**
+ * Checks if CPU lists of NUMA nodes are parsed correctly
+ */
+TEST(FpgaSetupTest, CpuListIsParsed) {
+    EXPECT_EQ(fpga_setup::parseCpuList("0-3,8,10-11\n"), std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_TRUE(fpga_setup::parseCpuList("").empty());
+    EXPECT_FALSE(fpga_setup::pinThreadToNumaNode(-1));
+}
+
+/**
+ * Checks if the bitstream hash is able to distinguish different bitstreams
+ */
+TEST(FpgaSetupTest, BitstreamHashDiffersForDifferentBitstreams) {
+    std::vector<unsigned char> bitstream_a{1, 2, 3, 4};
+    std::vector<unsigned char> bitstream_b{1, 2, 3, 5};
+    EXPECT_EQ(fpga_setup::getBitstreamHash(bitstream_a).size(), 16);
+    EXPECT_EQ(fpga_setup::getBitstreamHash(bitstream_a), fpga_setup::getBitstreamHash(bitstream_a));
+    EXPECT_NE(fpga_setup::getBitstreamHash(bitstream_a), fpga_setup::getBitstreamHash(bitstream_b));
+}
+
+/**
+ * Checks if the hash in the bitstream cache file is only reused for the same unchanged kernel file
+ */
+TEST(FpgaSetupTest, CachedBitstreamHashOnlyUsedForUnchangedFile) {
+    std::string entry = fpga_setup::createBitstreamCacheEntry("0123456789abcdef", 1024, 42, "/path/with space/kernel.aocx");
+    EXPECT_EQ(fpga_setup::getCachedBitstreamHash(entry, 1024, 42, "/path/with space/kernel.aocx"), "0123456789abcdef");
+    EXPECT_EQ(fpga_setup::getCachedBitstreamHash(entry, 1025, 42, "/path/with space/kernel.aocx"), "");
+    EXPECT_EQ(fpga_setup::getCachedBitstreamHash(entry, 1024, 43, "/path/with space/kernel.aocx"), "");
+    EXPECT_EQ(fpga_setup::getCachedBitstreamHash(entry, 1024, 42, "/path/kernel.aocx"), "");
+    // Entries of older versions only contain the hash and the path
+    EXPECT_EQ(fpga_setup::getCachedBitstreamHash("0123456789abcdef /path/kernel.aocx\n", 1024, 42, "/path/kernel.aocx"), "");
+    EXPECT_EQ(fpga_setup::getCachedBitstreamHash("", 1024, 42, "/path/kernel.aocx"), "");
+}
+
+/**
+ * Checks if the bitstream cache can be disabled with an empty cache directory
+ */
+TEST_F(BaseHpccBenchmarkTest, BitstreamCacheDisabledWithEmptyDirectory) {
+    setenv("HPCC_FPGA_BITSTREAM_CACHE_DIR", "", 1);
+    EXPECT_EQ(fpga_setup::getBitstreamCacheFileName(*bm->getExecutionSettings().device), "");
+    unsetenv("HPCC_FPGA_BITSTREAM_CACHE_DIR");
+    EXPECT_EQ(fpga_setup::getBitstreamCacheFileName(*bm->getExecutionSettings().device).find("/tmp/hpcc_fpga_"), 0);
+    // The file name is unique for every board
+    EXPECT_NE(fpga_setup::getBitstreamCacheFileName(*bm->getExecutionSettings().device).find("_p"), std::string::npos);
+}
+
 /**
  * Execute kernel and validation is success
  */
@@ -210,6 +263,559 @@ TEST_F(BaseHpccBenchmarkTest, FailedExe) {
     EXPECT_FALSE(bm->executeBenchmark());
 }
 
+/**
+ * Program settings can be updated without changing the OpenCL context and program
+ */
+TEST_F(BaseHpccBenchmarkTest, UpdateProgramSettingsKeepsContextAndProgram) {
+    auto context = bm->getExecutionSettings().context.get();
+    auto program = bm->getExecutionSettings().program.get();
+    EXPECT_TRUE(bm->updateProgramSettings({"-n", "3"}));
+    EXPECT_EQ(bm->getExecutionSettings().programSettings->numRepetitions, 3);
+    EXPECT_EQ(bm->getExecutionSettings().context.get(), context);
+    EXPECT_EQ(bm->getExecutionSettings().program.get(), program);
+}
+
+/**
+ * Program settings update fails if a different kernel file is given
+ */
+TEST_F(BaseHpccBenchmarkTest, UpdateProgramSettingsFailsForDifferentKernelFile) {
+    auto kernelFileName = bm->getExecutionSettings().programSettings->kernelFileName;
+    EXPECT_FALSE(bm->updateProgramSettings({"-f", kernelFileName + "_other"}));
+    EXPECT_EQ(bm->getExecutionSettings().programSettings->kernelFileName, kernelFileName);
+}
+
+/**
+ * Benchmark is executed once for every sweep configuration
+ */
+TEST_F(BaseHpccBenchmarkTest, SweepExecutesAllConfigurations) {
+    bm->getExecutionSettings().programSettings->sweepConfigurations = {"-n 2", "-n 3"};
+    EXPECT_TRUE(bm->executeBenchmark());
+    EXPECT_EQ(bm->executeKernelcalled, 2);
+    EXPECT_EQ(bm->validateOutputcalled, 2);
+    EXPECT_EQ(bm->getExecutionSettings().programSettings->numRepetitions, 3);
+}
+
+/**
+ * Input data is generated during the setup and used for the first execution if generation is overlapped
+ */
+TEST_F(BaseHpccBenchmarkTest, OverlappedGenerationUsedForFirstExecution) {
+    std::vector<char*> argv(global_argv, global_argv + global_argc);
+    std::string overlap_option = "--overlap-generation";
+    argv.push_back(&overlap_option[0]);
+    argv.push_back(nullptr);
+    EXPECT_TRUE(bm->setupBenchmark(global_argc + 1, argv.data()));
+    EXPECT_EQ(bm->generateInputDatacalled, 1);
+    EXPECT_TRUE(bm->executeBenchmark());
+    EXPECT_EQ(bm->generateInputDatacalled, 1);
+    EXPECT_EQ(bm->executeKernelcalled, 1);
+    EXPECT_TRUE(bm->executeBenchmark());
+    EXPECT_EQ(bm->generateInputDatacalled, 2);
+}
+
+/**
+ * Results are dumped to a JSON file if a file name is given
+ */
+TEST_F(BaseHpccBenchmarkTest, ResultsDumpedToJsonFile) {
+    std::string file_name = "hpcc_base_test_dump.json";
+    bm->getExecutionSettings().programSettings->dumpFilePath = file_name;
+    EXPECT_TRUE(bm->executeBenchmark());
+    std::ifstream dump(file_name);
+    ASSERT_TRUE(dump.is_open());
+    std::string content((std::istreambuf_iterator<char>(dump)), std::istreambuf_iterator<char>());
+    EXPECT_NE(content.find("\"test\": [\n      [1, 2]"), std::string::npos);
+    EXPECT_NE(content.find("\"test [1/s]\": 1"), std::string::npos);
+    EXPECT_NE(content.find("\"Repetitions\": "), std::string::npos);
+    EXPECT_NE(content.find("\"validated\": true"), std::string::npos);
+    dump.close();
+    std::remove(file_name.c_str());
+}
+
+/**
+ * The execution fails if the timings are significantly slower than the baseline
+ */
+TEST_F(BaseHpccBenchmarkTest, BaselineRegressionFailsExecution) {
+    std::string file_name = "hpcc_base_test_baseline.json";
+    bm->getExecutionSettings().programSettings->dumpFilePath = file_name;
+    EXPECT_TRUE(bm->executeBenchmark());
+    bm->getExecutionSettings().programSettings->dumpFilePath = "";
+    bm->getExecutionSettings().programSettings->baselineFilePath = file_name;
+    EXPECT_TRUE(bm->executeBenchmark());
+    {
+        std::ofstream baseline(file_name);
+        baseline << "{\"device\": \"None\", \"mpi_size\": 1, \"timings\": {\"test\": [[0.10, 0.11, 0.12], [0.13, 0.14, 0.15]]}}";
+    }
+    EXPECT_FALSE(bm->executeBenchmark());
+    bm->getExecutionSettings().programSettings->baselineFilePath = "hpcc_base_test_missing_baseline.json";
+    EXPECT_FALSE(bm->executeBenchmark());
+    std::remove(file_name.c_str());
+}
+
+/**
+ * The baseline is read from the JSON dump and only significant drops larger than the threshold are regressions
+ */
+TEST(BaselineTest, DumpIsParsedAndCompared) {
+    std::string json = "{\"version\": \"1.0\", \"device\": \"FPGA \\\"A\\\"\", \"mpi_size\": 2, \"settings\": {\"Repetitions\": \"10\"},"
+                        "\"timings\": {\"execution\": [[1, 2], [3]], \"power samples [W]\": [[]]}, \"results\": {\"GFLOPS\": 5.5, \"nan\": null}, \"validated\": true}";
+    auto baseline = hpcc_base::BaselineParser(json).parse();
+    EXPECT_EQ(baseline.device, "FPGA \"A\"");
+    EXPECT_EQ(baseline.mpiSize, 2);
+    EXPECT_EQ(baseline.timings["execution"], std::vector<double>({1.0, 2.0, 3.0}));
+    EXPECT_TRUE(baseline.timings["power samples [W]"].empty());
+    EXPECT_DOUBLE_EQ(baseline.results["GFLOPS"], 5.5);
+    EXPECT_TRUE(std::isnan(baseline.results["nan"]));
+    EXPECT_THROW(hpcc_base::BaselineParser("{\"device\": ").parse(), std::runtime_error);
+
+    std::vector<double> base;
+    std::vector<double> slower;
+    std::vector<double> similar;
+    for (int i = 0; i < 10; i++) {
+        base.push_back(1.0 + 0.01 * i);
+        slower.push_back(1.2 * base.back());
+        similar.push_back(0.02 + base.back());
+    }
+    EXPECT_TRUE(hpcc_base::compareTimings(base, slower, 0.1, 0.05).regression);
+    EXPECT_NEAR(hpcc_base::compareTimings(base, slower, 0.1, 0.05).change, 1.0 / 1.2 - 1.0, 1.0e-12);
+    EXPECT_NEAR(hpcc_base::mannWhitneyPValue({1.0, 2.0}, {3.0, 4.0}), 1.0 / 6.0, 1.0e-12);
+    EXPECT_FALSE(hpcc_base::compareTimings(base, similar, 0.1, 0.05).regression);
+    EXPECT_FALSE(hpcc_base::compareTimings(base, {1.2}, 0.1, 0.05).regression);
+    EXPECT_FALSE(hpcc_base::compareTimings(slower, base, 0.1, 0.05).regression);
+}
+
+/**
+ * Profiler is only enabled if a trace file is given
+ */
+TEST_F(BaseHpccBenchmarkTest, ProfilerEnabledWithTraceOption) {
+    EXPECT_FALSE(bm->getExecutionSettings().profiler->isEnabled());
+    EXPECT_EQ(bm->getExecutionSettings().profiler->getQueueProperties(), 0);
+    EXPECT_TRUE(bm->updateProgramSettings({"--trace", "hpcc_base_test_trace.json"}));
+    EXPECT_TRUE(bm->getExecutionSettings().profiler->isEnabled());
+    EXPECT_EQ(bm->getExecutionSettings().profiler->getQueueProperties(), CL_QUEUE_PROFILING_ENABLE);
+}
+
+/**
+ * Disabled profiler does not record events
+ */
+TEST(EventProfilerTest, DisabledProfilerRecordsNoEvents) {
+    hpcc_base::EventProfiler profiler(false);
+    EXPECT_EQ(profiler.event("test"), nullptr);
+    profiler.addEvent("test", cl::Event());
+    EXPECT_EQ(profiler.size(), 0);
+}
+
+/**
+ * Enabled profiler records events and clears them
+ */
+TEST(EventProfilerTest, EnabledProfilerRecordsEvents) {
+    hpcc_base::EventProfiler profiler(true);
+    EXPECT_NE(profiler.event("test"), nullptr);
+    profiler.addEvent("test", cl::Event());
+    EXPECT_EQ(profiler.size(), 2);
+    profiler.clear();
+    EXPECT_EQ(profiler.size(), 0);
+}
+
+/**
+ * Released host buffers are reused for allocations of the same size
+ */
+TEST(HostMemoryTest, ReleasedBuffersAreReused) {
+    hpcc_base::host_memory::clearPool();
+    auto data = hpcc_base::host_memory::allocate<double>(1000);
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(data) % 4096, 0);
+    data[999] = 1.0;
+    hpcc_base::host_memory::release(data);
+    EXPECT_GT(hpcc_base::host_memory::getPooledBytes(), 0);
+    auto reused = hpcc_base::host_memory::allocate<double>(1000);
+    EXPECT_EQ(reused, data);
+    EXPECT_EQ(hpcc_base::host_memory::getPooledBytes(), 0);
+    hpcc_base::host_memory::release(reused);
+    hpcc_base::host_memory::clearPool();
+    EXPECT_EQ(hpcc_base::host_memory::getPooledBytes(), 0);
+}
+
+/**
+ * Buffers of different sizes stay in the pool and unused buffers are evicted if they exceed the used memory
+ */
+TEST(HostMemoryTest, BuffersOfDifferentSizesAreReused) {
+    hpcc_base::host_memory::clearPool();
+    auto a = hpcc_base::host_memory::allocate<double>(100000);
+    auto b = hpcc_base::host_memory::allocate<double>(200000);
+    hpcc_base::host_memory::release(a);
+    hpcc_base::host_memory::release(b);
+    auto b_reused = hpcc_base::host_memory::allocate<double>(200000);
+    auto a_reused = hpcc_base::host_memory::allocate<double>(100000);
+    EXPECT_EQ(a_reused, a);
+    EXPECT_EQ(b_reused, b);
+    hpcc_base::host_memory::release(a_reused);
+    hpcc_base::host_memory::release(b_reused);
+    // The pooled buffers are too large for the new buffer and exceed the used memory, so they are evicted
+    auto c = hpcc_base::host_memory::allocate<double>(10000);
+    EXPECT_LE(hpcc_base::host_memory::getPooledBytes(), 10000 * sizeof(double));
+    hpcc_base::host_memory::release(c);
+    hpcc_base::host_memory::clearPool();
+}
+
+/**
+ * Host memory configuration is taken from the program settings
+ */
+TEST_F(BaseHpccBenchmarkTest, HostMemoryConfiguredBySettings) {
+    EXPECT_TRUE(bm->updateProgramSettings({"--numa-node", "0", "--huge-pages"}));
+    auto config = hpcc_base::host_memory::getConfiguration();
+    EXPECT_EQ(config.numaNode, 0);
+    EXPECT_TRUE(config.hugePages);
+    EXPECT_FALSE(config.pinned);
+    auto data = hpcc_base::host_memory::allocate<char>(1);
+    ASSERT_NE(data, nullptr);
+    hpcc_base::host_memory::release(data);
+    EXPECT_EQ(hpcc_base::host_memory::getPooledBytes(), hpcc_base::host_memory::HUGE_PAGE_SIZE);
+    EXPECT_TRUE(bm->updateProgramSettings({}));
+    EXPECT_EQ(hpcc_base::host_memory::getPooledBytes(), 0);
+}
+
+/**
+ * Settings that are used to configure the repetition policy in the tests
+ */
+struct RepetitionSettings {
+    uint numRepetitions;
+    uint warmupRepetitions;
+    uint maxRepetitions;
+    double repetitionTolerance;
+};
+
+/**
+ * Fixed number of repetitions is executed and warmup timings are discarded
+ */
+TEST(RepetitionPolicyTest, FixedRepetitionsWithWarmup) {
+    hpcc_base::RepetitionPolicy policy;
+    policy.start(RepetitionSettings{3, 2, 100, 0.0});
+    EXPECT_FALSE(policy.isAdaptive());
+    std::vector<double> timings;
+    while (policy.next(timings)) {
+        timings.push_back(policy.isWarmup() ? 10.0 : 1.0);
+    }
+    EXPECT_EQ(policy.getExecutedRepetitions(), 5);
+    EXPECT_TRUE(policy.isFirstRepetitionFinished());
+    policy.discardWarmup(timings);
+    EXPECT_EQ(timings, std::vector<double>(3, 1.0));
+    policy.start(RepetitionSettings{3, 2, 100, 0.0});
+    EXPECT_FALSE(policy.isFirstRepetitionFinished());
+}
+
+/**
+ * Adaptive repetitions stop as soon as the confidence interval is within the tolerance
+ */
+TEST(RepetitionPolicyTest, AdaptiveRepetitionsStopForStableTimings) {
+    hpcc_base::RepetitionPolicy policy;
+    policy.start(RepetitionSettings{2, 0, 100, 0.01});
+    EXPECT_TRUE(policy.isAdaptive());
+    std::vector<double> timings;
+    while (policy.next(timings)) {
+        timings.push_back(1.0);
+    }
+    EXPECT_EQ(timings.size(), 6);
+}
+
+/**
+ * Adaptive repetitions stop at the maximum for noisy timings
+ */
+TEST(RepetitionPolicyTest, AdaptiveRepetitionsStopAtMaximum) {
+    hpcc_base::RepetitionPolicy policy;
+    policy.start(RepetitionSettings{2, 1, 20, 0.01});
+    std::vector<double> timings;
+    while (policy.next(timings)) {
+        timings.push_back((timings.size() % 2) ? 1.0 : 2.0);
+    }
+    EXPECT_EQ(policy.getExecutedRepetitions(), 21);
+    policy.discardWarmup(timings);
+    EXPECT_EQ(timings.size(), 20);
+}
+
+/**
+ * Timing statistics are calculated correctly
+ */
+TEST(RepetitionPolicyTest, TimingStatisticsAreCorrect) {
+    auto stats = hpcc_base::calculateStatistics({5.0, 1.0, 3.0, 2.0, 4.0});
+    EXPECT_DOUBLE_EQ(stats.min, 1.0);
+    EXPECT_DOUBLE_EQ(stats.max, 5.0);
+    EXPECT_DOUBLE_EQ(stats.mean, 3.0);
+    EXPECT_DOUBLE_EQ(stats.median, 3.0);
+    EXPECT_DOUBLE_EQ(stats.p5, 1.2);
+    EXPECT_DOUBLE_EQ(stats.p95, 4.8);
+    EXPECT_DOUBLE_EQ(stats.stddev, std::sqrt(2.5));
+    EXPECT_EQ(stats.count, 5);
+}
+
+/**
+ * A single device is used by default and executes all kernel replications
+ */
+TEST_F(BaseHpccBenchmarkTest, SingleDeviceExecutesAllReplications) {
+    EXPECT_EQ(bm->getExecutionSettings().programSettings->numDevices, 1);
+    EXPECT_EQ(bm->getExecutionSettings().devices.size(), 1);
+    EXPECT_EQ(&bm->getExecutionSettings().getDevice(3), &bm->getExecutionSettings().devices[0]);
+    EXPECT_DOUBLE_EQ(hpcc_base::multi_device::getWorkFraction(0, 1, 4), 1.0);
+}
+
+/**
+ * The kernel replications are distributed evenly over multiple devices
+ */
+TEST(MultiDeviceTest, WorkIsDistributedOverDevices) {
+    EXPECT_DOUBLE_EQ(hpcc_base::multi_device::getWorkFraction(0, 2, 4), 0.5);
+    EXPECT_DOUBLE_EQ(hpcc_base::multi_device::getWorkFraction(0, 2, 3), 2.0 / 3.0);
+    EXPECT_DOUBLE_EQ(hpcc_base::multi_device::getWorkFraction(1, 2, 3), 1.0 / 3.0);
+    auto times = hpcc_base::multi_device::waitForDevices(3, std::chrono::high_resolution_clock::now(), [](size_t) {});
+    EXPECT_EQ(times.size(), 3);
+}
+
+/**
+ * Recorded command sequences can be replayed and finished without commands on some queues
+ */
+TEST_F(BaseHpccBenchmarkTest, CommandSequenceWithoutCommandsIsReplayed) {
+    std::vector<cl::CommandQueue> queues{cl::CommandQueue(*bm->getExecutionSettings().context, *bm->getExecutionSettings().device)};
+    hpcc_base::EventProfiler profiler(true);
+    hpcc_base::CommandSequence sequence(queues, profiler);
+    sequence.finalize();
+    EXPECT_EQ(sequence.size(), 0);
+    // Command buffers are never used with profiling, so the single commands show up in the timeline
+    EXPECT_FALSE(sequence.usesCommandBuffer(0));
+    sequence.replay();
+    EXPECT_EQ(sequence.finish(1, std::chrono::high_resolution_clock::now()).size(), 1);
+}
+
+/**
+ * The progress thread executes the callback of a task after its events are completed
+ */
+TEST_F(BaseHpccBenchmarkTest, CommunicationProgressExecutesCallbackAfterEvents) {
+    hpcc_base::CommunicationProgress progress;
+    cl::UserEvent event(*bm->getExecutionSettings().context);
+    bool executed = false;
+    auto handle = progress.addEvents({event}, [&executed]() { executed = true; });
+    event.setStatus(CL_COMPLETE);
+    handle.wait();
+    EXPECT_TRUE(executed);
+    progress.waitAll();
+}
+
+/**
+ * The latencies of user events and tiny transfers are measured without a kernel
+ */
+TEST_F(BaseHpccBenchmarkTest, LaunchLatencyIsMeasuredWithoutKernel) {
+    auto latencies = hpcc_base::measureLaunchLatency(*bm->getExecutionSettings().context, *bm->getExecutionSettings().device, nullptr, 3);
+    EXPECT_EQ(latencies.count("kernel round trip"), 0);
+    EXPECT_EQ(latencies.size(), 5);
+    for (auto const& l : latencies) {
+        EXPECT_EQ(l.second.size(), 3);
+        EXPECT_GE(*std::min_element(l.second.begin(), l.second.end()), 0.0);
+    }
+}
+
+/**
+ * The soak run repeats the execution and only generates the data again for the validated iterations
+ */
+TEST_F(BaseHpccBenchmarkTest, SoakRepeatsExecutionAndValidates) {
+    EXPECT_TRUE(bm->updateProgramSettings({"--soak", "0.05", "--soak-validation", "2", "--soak-export", "hpcc_base_test_soak.prom"}));
+    bm->executeKernelcalled = 0;
+    bm->generateInputDatacalled = 0;
+    bm->validateOutputcalled = 0;
+    EXPECT_TRUE(bm->executeBenchmark());
+    uint soak_iterations = bm->executeKernelcalled - 1;
+    EXPECT_GE(soak_iterations, 1);
+    EXPECT_EQ(bm->generateInputDatacalled, 1 + soak_iterations / 2);
+    EXPECT_EQ(bm->validateOutputcalled, 1 + soak_iterations / 2);
+    std::ifstream metrics_file("hpcc_base_test_soak.prom");
+    std::string metrics((std::istreambuf_iterator<char>(metrics_file)), std::istreambuf_iterator<char>());
+    EXPECT_NE(metrics.find("hpcc_fpga_soak_iterations{"), std::string::npos);
+    EXPECT_NE(metrics.find("name=\"test [1/s]\"} 1"), std::string::npos);
+}
+
+/**
+ * The metrics are written in the Prometheus text format with escaped labels
+ */
+TEST(SoakTest, MetricsAreExportedInPrometheusFormat) {
+    hpcc_base::SoakStatus status;
+    status.iterations = 3;
+    status.temperature = 50.0;
+    EXPECT_TRUE(hpcc_base::writePrometheusMetrics("hpcc_base_test_metrics.prom", {{"device", "my \"FPGA\""}}, status, {{"GFLOPS", 2.5}}));
+    std::ifstream metrics_file("hpcc_base_test_metrics.prom");
+    std::string metrics((std::istreambuf_iterator<char>(metrics_file)), std::istreambuf_iterator<char>());
+    EXPECT_NE(metrics.find("hpcc_fpga_soak_iterations{device=\"my \\\"FPGA\\\"\"} 3\n"), std::string::npos);
+    EXPECT_NE(metrics.find("hpcc_fpga_temperature_celsius{device=\"my \\\"FPGA\\\"\"} 50\n"), std::string::npos);
+    EXPECT_EQ(metrics.find("hpcc_fpga_power_watts"), std::string::npos);
+    EXPECT_NE(metrics.find("hpcc_fpga_metric{device=\"my \\\"FPGA\\\"\",name=\"GFLOPS\"} 2.5\n"), std::string::npos);
+    EXPECT_THROW(hpcc_base::createTemperatureSource("fpgainfo"), std::runtime_error);
+}
+
+/**
+ * The placement policies select the memory banks of the buffers of all replications
+ */
+TEST(MemoryPlacementTest, PoliciesSelectBanks) {
+    using namespace hpcc_base::memory_placement;
+    EXPECT_EQ(getBankFlags(Policy::buffer, 1, 2, 4, 4), static_cast<cl_mem_flags>(3) << 16);
+    EXPECT_EQ(getBankFlags(Policy::replication, 1, 2, 4, 4), static_cast<cl_mem_flags>(2) << 16);
+    EXPECT_EQ(getBankFlags(Policy::striped, 1, 2, 2, 4), static_cast<cl_mem_flags>(1) << 16);
+    EXPECT_EQ(getBankFlags(Policy::interleaved, 1, 2, 4, 4), static_cast<cl_mem_flags>(0));
+    EXPECT_EQ(retrievePolicy(policyToString(Policy::striped)), Policy::striped);
+    EXPECT_THROW(retrievePolicy("NONE"), std::runtime_error);
+}
+
+class ConstantPowerSource : public hpcc_base::PowerSource {
+public:
+    double readPower() override { return 25.0; }
+    std::string getName() const override { return "constant"; }
+};
+
+/**
+ * The power sampler takes samples while it is running and calculates the average power
+ */
+TEST(PowerSamplerTest, ConstantPowerIsAveraged) {
+    hpcc_base::PowerSampler sampler(std::unique_ptr<hpcc_base::PowerSource>(new ConstantPowerSource()), std::chrono::milliseconds(1));
+    sampler.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    sampler.stop();
+    EXPECT_GE(sampler.getSamples().size(), 2);
+    EXPECT_DOUBLE_EQ(sampler.getAveragePower(), 25.0);
+    EXPECT_GE(sampler.getDuration(), 0.01);
+}
+
+/**
+ * Power is read from the output of a command and unknown sources are rejected
+ */
+TEST(PowerSamplerTest, CommandSourceIsParsed) {
+    EXPECT_DOUBLE_EQ(hpcc_base::createPowerSource("cmd:echo 42.5 W")->readPower(), 42.5);
+    EXPECT_DOUBLE_EQ(hpcc_base::power_parsers::fpgainfo("12V Current : 2.00 Amps\n12V Voltage : 12.00 Volts\n"), 24.0);
+    EXPECT_THROW(hpcc_base::createPowerSource("unknown"), std::runtime_error);
+}
+
+/**
+ * The energy efficiency is calculated for all throughput metrics
+ */
+TEST(PowerSamplerTest, EnergyEfficiencyOfThroughputMetrics) {
+    auto efficiency = hpcc_base::calculateEnergyEfficiency({{"GFLOPS", 100.0}, {"Copy Best Rate [MB/s]", 20000.0},
+                                    {"best [s]", 1.0}, {"execution device 0 GFLOPS", 50.0}}, 10.0);
+    EXPECT_EQ(efficiency.size(), 2);
+    EXPECT_DOUBLE_EQ(efficiency["GFLOPS/W"], 10.0);
+    EXPECT_DOUBLE_EQ(efficiency["Copy Best Rate [GB/s/W]"], 2.0);
+}
+
+/**
+ * The attainable performance is limited by the lower roof and unknown roofs are ignored
+ */
+TEST(RooflineTest, LowerRoofIsAttainable) {
+    double memory_peak = hpcc_base::calculateMemoryPeak(4, 64, 300.0);
+    EXPECT_DOUBLE_EQ(memory_peak, 76.8e9);
+    hpcc_base::Roofline memory_bound{1.0e12, memory_peak, 8.0};
+    EXPECT_DOUBLE_EQ(memory_bound.attainable(), 9.6e9);
+    EXPECT_TRUE(memory_bound.isMemoryBound());
+    hpcc_base::Roofline compute_bound{1.0e9, memory_peak, 8.0};
+    EXPECT_DOUBLE_EQ(compute_bound.attainable(), 1.0e9);
+    EXPECT_EQ(compute_bound.boundToString(), "compute");
+    hpcc_base::Roofline unknown_memory{1.0e9, 0.0, 8.0};
+    EXPECT_DOUBLE_EQ(unknown_memory.attainable(), 1.0e9);
+    EXPECT_FALSE(unknown_memory.isMemoryBound());
+    EXPECT_EQ(hpcc_base::Roofline({0.0, 0.0, 0.0}).boundToString(), "unknown");
+}
+
+/**
+ * The memory limits consider the used fraction, the number of devices and the memory banks
+ */
+TEST(AutoSizeTest, LimitsAndSizesFitIntoMemory) {
+    auto limits = hpcc_base::calculateMemoryLimits(1024, 512, 2, 4, true, 0.5);
+    EXPECT_DOUBLE_EQ(limits.totalMemory, 1024.0);
+    EXPECT_DOUBLE_EQ(limits.maxBufferSize, 128.0);
+    limits = hpcc_base::calculateMemoryLimits(1024, 512, 1, 4, false, 1.0);
+    EXPECT_DOUBLE_EQ(limits.maxBufferSize, 512.0);
+    EXPECT_EQ(hpcc_base::largestMultiple(100.0, 16), 96);
+    EXPECT_EQ(hpcc_base::largestMultiple(15.0, 16), 0);
+    EXPECT_EQ(hpcc_base::largestPowerOfTwo(100.0), 64);
+    EXPECT_EQ(hpcc_base::largestPowerOfTwo(0.5), 0);
+    EXPECT_EQ(hpcc_base::leastCommonMultiple(4, 6), 12);
+}
+
+/**
+ * The number of checks of the sampled validation grows with the required error bound
+ */
+TEST(ValidationPolicyTest, ChecksDependOnErrorBound) {
+    EXPECT_EQ(hpcc_base::validation::freivaldsTrials(1e-6), 20);
+    EXPECT_EQ(hpcc_base::validation::freivaldsTrials(0.9), 1);
+    EXPECT_EQ(hpcc_base::validation::probeCount(1e-6, 1000000), 1375);
+    EXPECT_EQ(hpcc_base::validation::probeCount(1e-6, 100), 100);
+    auto indices = hpcc_base::validation::sampleIndices(1e-6, 1000000, 0);
+    EXPECT_EQ(indices.size(), 1375);
+    EXPECT_LT(*std::max_element(indices.begin(), indices.end()), 1000000);
+    EXPECT_EQ(hpcc_base::retrieveValidationMode("sampled"), hpcc_base::ValidationMode::sampled);
+    EXPECT_THROW(hpcc_base::retrieveValidationMode("some"), std::runtime_error);
+}
+
+/**
+ * The counter-based generator matches the known answers of Philox4x32-10 and depends on index and seed
+ */
+TEST(CounterRandomTest, PhiloxKnownAnswers) {
+    std::array<uint32_t, 4> zero = hpcc_base::rng::philox4x32({0, 0, 0, 0}, {0, 0});
+    EXPECT_EQ(zero, (std::array<uint32_t, 4>{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u}));
+    std::array<uint32_t, 4> ones = hpcc_base::rng::philox4x32({0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu}, {0xffffffffu, 0xffffffffu});
+    EXPECT_EQ(ones, (std::array<uint32_t, 4>{0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu}));
+    EXPECT_EQ(hpcc_base::rng::randomBits(5, 7), hpcc_base::rng::randomBits(5, 7));
+    EXPECT_NE(hpcc_base::rng::randomBits(5, 7), hpcc_base::rng::randomBits(6, 7));
+    EXPECT_NE(hpcc_base::rng::randomBits(5, 7), hpcc_base::rng::randomBits(5, 8));
+    EXPECT_DOUBLE_EQ(hpcc_base::rng::toUniformSigned(0), -1.0);
+    EXPECT_LT(hpcc_base::rng::toUniformSigned(0xffffffffu), 1.0);
+    EXPECT_GT(static_cast<float>(hpcc_base::rng::toUniformUnsigned(0)), 0.0f);
+    EXPECT_LT(static_cast<float>(hpcc_base::rng::toUniformUnsigned(0xffffffffu)), 1.0f);
+}
+
+/**
+ * Validation is skipped if the validation mode is off
+ */
+TEST_F(BaseHpccBenchmarkTest, ValidationOffSkipsValidation) {
+    std::string validation_option = "--validation=off";
+    std::vector<char*> argv(global_argv, global_argv + global_argc);
+    argv.push_back(&validation_option[0]);
+    argv.push_back(nullptr);
+    EXPECT_TRUE(bm->setupBenchmark(global_argc + 1, argv.data()));
+    EXPECT_TRUE(bm->getExecutionSettings().programSettings->skipValidation);
+    EXPECT_EQ(bm->getExecutionSettings().programSettings->validationMode, hpcc_base::ValidationMode::off);
+}
+
+/**
+ * A second benchmark setup in the same process reuses the context and the program
+ */
+TEST_F(BaseHpccBenchmarkTest, ContextIsSharedBetweenSetups) {
+    std::unique_ptr<SuccessBenchmark> bm2 = std::unique_ptr<SuccessBenchmark>(new SuccessBenchmark());
+    EXPECT_TRUE(bm2->setupBenchmark(global_argc, global_argv));
+    EXPECT_EQ((*bm->getExecutionSettings().context)(), (*bm2->getExecutionSettings().context)());
+    EXPECT_EQ((*bm->getExecutionSettings().program)(), (*bm2->getExecutionSettings().program)());
+}
+
+/**
+ * The suite configuration contains one benchmark per line and ignores comments
+ */
+TEST(SuiteTest, ConfigurationIsParsed) {
+    std::stringstream config("# benchmark and its arguments\nSTREAM -f stream.aocx -n 5\n\n  GEMM   -f gemm.aocx\n");
+    auto entries = hpcc_base::suite::parseSuiteConfiguration(config);
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[0].benchmark, "STREAM");
+    EXPECT_EQ(entries[0].arguments, std::vector<std::string>({"-f", "stream.aocx", "-n", "5"}));
+    EXPECT_EQ(entries[1].benchmark, "GEMM");
+    EXPECT_EQ(entries[1].arguments, std::vector<std::string>({"-f", "gemm.aocx"}));
+}
+
+/**
+ * The suite report contains the results of all benchmarks
+ */
+TEST(SuiteTest, ReportCombinesResults) {
+    std::string result_file = "suite_test_result.json";
+    std::ofstream(result_file) << "{\"validated\": true}";
+    std::string report_file = "suite_test_report.json";
+    EXPECT_TRUE(hpcc_base::suite::writeSuiteReport(report_file, {{"STREAM", {}}, {"GEMM", {}}}, {{true, 1.0}, {false, 2.0}},
+                                                    {result_file, "missing.json"}));
+    std::ifstream report(report_file);
+    std::string content((std::istreambuf_iterator<char>(report)), std::istreambuf_iterator<char>());
+    EXPECT_NE(content.find("\"results\": {\"validated\": true}"), std::string::npos);
+    EXPECT_NE(content.find("\"results\": null"), std::string::npos);
+    EXPECT_NE(content.find("\"success\": false\n}"), std::string::npos);
+    std::remove(result_file.c_str());
+    std::remove(report_file.c_str());
+}
+
 /**
  * Benchmark Setup is successful with default data
  */
@@ -0,0 +1,187 @@
+/*
+Copyright (c) 2021 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* C++ standard library headers */
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+/* External library headers */
+#include "mpi.h"
+#include "cxxopts.hpp"
+
+/* Project's headers */
+#include "hpcc_suite.hpp"
+
+#define HLINE "-------------------------------------------------------------\n"
+#define ENTRY_SPACE 15
+
+namespace {
+
+/**
+ * @brief The entry points of all benchmarks that are linked into the suite binary.
+ *          The entries are enabled with the definitions created by the CMake configuration.
+ *
+ * @return std::map<std::string, hpcc_base::suite::BenchmarkResult (*)(int, char**)> Map from the benchmark name to its entry point
+ */
+std::map<std::string, hpcc_base::suite::BenchmarkResult (*)(int, char**)>
+getSuiteBenchmarks() {
+    std::map<std::string, hpcc_base::suite::BenchmarkResult (*)(int, char**)> benchmarks;
+#ifdef SUITE_STREAM
+    benchmarks["STREAM"] = stream::runSuiteBenchmark;
+#endif
+#ifdef SUITE_RandomAccess
+    benchmarks["RandomAccess"] = random_access::runSuiteBenchmark;
+#endif
+#ifdef SUITE_PTRANS
+    benchmarks["PTRANS"] = transpose::runSuiteBenchmark;
+#endif
+#ifdef SUITE_LINPACK
+    benchmarks["LINPACK"] = linpack::runSuiteBenchmark;
+#endif
+#ifdef SUITE_GEMM
+    benchmarks["GEMM"] = gemm::runSuiteBenchmark;
+#endif
+#ifdef SUITE_FFT
+    benchmarks["FFT"] = fft::runSuiteBenchmark;
+#endif
+#ifdef SUITE_b_eff
+    benchmarks["b_eff"] = network::runSuiteBenchmark;
+#endif
+    return benchmarks;
+}
+
+}
+
+/**
+The program entry point.
+Executes all benchmarks given in the suite configuration in a single process.
+MPI is only initialized once and the device selection and OpenCL context are reused by all benchmarks.
+The FPGA is only reprogrammed if the bitstream changes between two benchmarks.
+*/
+int
+main(int argc, char *argv[]) {
+    // Request the thread support for the communication progress thread of the PCIE communication types
+    hpcc_base::initializeMPI(&argc, &argv);
+    int mpi_comm_rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_comm_rank);
+
+    auto benchmarks = getSuiteBenchmarks();
+    std::string available_benchmarks;
+    for (auto const& b : benchmarks) {
+        available_benchmarks += " " + b.first;
+    }
+
+    cxxopts::Options options("HPCC FPGA Suite", "Executes multiple benchmarks of HPCC FPGA in a single process."\
+                                " Available benchmarks:" + available_benchmarks);
+    options.add_options()
+        ("c,config", "Suite configuration file. Every line contains the name of a benchmark followed by its input parameters",
+            cxxopts::value<std::string>())
+        ("report", "Write a combined report of all benchmarks to the given file in JSON format",
+            cxxopts::value<std::string>())
+        ("h,help", "Print this help");
+
+    std::vector<hpcc_base::suite::SuiteEntry> entries;
+    std::string report_file;
+    try {
+        auto result = options.parse(argc, argv);
+        if (result.count("h") > 0 || result.count("c") == 0) {
+            if (mpi_comm_rank == 0) {
+                std::cout << options.help() << std::endl;
+            }
+            MPI_Finalize();
+            return result.count("h") > 0 ? 0 : 1;
+        }
+        std::ifstream config_file(result["c"].as<std::string>());
+        if (!config_file.is_open()) {
+            throw std::runtime_error("Suite configuration " + result["c"].as<std::string>() + " could not be opened!");
+        }
+        entries = hpcc_base::suite::parseSuiteConfiguration(config_file);
+        for (auto const& entry : entries) {
+            if (benchmarks.find(entry.benchmark) == benchmarks.end()) {
+                throw std::runtime_error("Benchmark " + entry.benchmark + " is not available in this suite binary. Available benchmarks:"
+                                            + available_benchmarks);
+            }
+        }
+        if (result.count("report") > 0) {
+            report_file = result["report"].as<std::string>();
+        }
+    }
+    catch (const std::exception& e) {
+        if (mpi_comm_rank == 0) {
+            std::cerr << "ERROR: " << e.what() << std::endl;
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    std::vector<hpcc_base::suite::BenchmarkResult> results;
+    std::vector<std::string> result_files;
+    for (size_t i = 0; i < entries.size(); i++) {
+        auto const& entry = entries[i];
+        if (mpi_comm_rank == 0) {
+            std::cout << HLINE << "Suite: Execute " << entry.benchmark << " (" << i + 1 << "/" << entries.size() << ")" << std::endl
+                    << HLINE;
+        }
+        std::vector<std::string> arguments{entry.benchmark};
+        arguments.insert(arguments.end(), entry.arguments.begin(), entry.arguments.end());
+        // The results of the benchmarks are collected from their JSON dumps for the combined report
+        result_files.push_back(report_file.empty() ? "" : report_file + "." + std::to_string(i) + "." + entry.benchmark + ".json");
+        if (!report_file.empty()) {
+            arguments.push_back("--dump-json=" + result_files.back());
+        }
+        std::vector<char*> benchmark_argv;
+        for (auto& a : arguments) {
+            benchmark_argv.push_back(&a[0]);
+        }
+        benchmark_argv.push_back(nullptr);
+        results.push_back(benchmarks[entry.benchmark](static_cast<int>(arguments.size()), benchmark_argv.data()));
+        MPI_Barrier(MPI_COMM_WORLD);
+    }
+
+    bool success = true;
+    if (mpi_comm_rank == 0) {
+        std::cout << HLINE << "Suite summary:" << std::endl << HLINE;
+        std::cout << std::left << std::setw(2 * ENTRY_SPACE) << "Benchmark" << std::setw(ENTRY_SPACE) << "Validation"
+                    << std::setw(ENTRY_SPACE) << "Time [s]" << std::endl;
+        for (size_t i = 0; i < entries.size(); i++) {
+            std::cout << std::setw(2 * ENTRY_SPACE) << entries[i].benchmark << std::setw(ENTRY_SPACE) << (results[i].success ? "SUCCESS" : "FAILED")
+                    << std::setw(ENTRY_SPACE) << results[i].wallTime << std::endl;
+            success = success && results[i].success;
+        }
+        if (!report_file.empty()) {
+            if (hpcc_base::suite::writeSuiteReport(report_file, entries, results, result_files)) {
+                std::cout << "Suite report written to " << report_file << std::endl;
+            }
+            for (auto const& f : result_files) {
+                std::remove(f.c_str());
+            }
+        }
+    }
+    MPI_Bcast(&success, 1, MPI_C_BOOL, 0, MPI_COMM_WORLD);
+    MPI_Finalize();
+    return success ? 0 : 1;
+}